@@ -1,17 +1,7 @@
 #version 410
 
-const int MAX_LIGHTS = 1024;
-const int MAX_CASCADE_LAYERS = 8;
-
 layout(location = 0) in vec3 aPosition;
-
-struct Light
-{
-  vec3 Colour;
-  float Intensity;
-  vec3 Position;
-  float Radius;
-};
+layout(location = 6) in mat4 aInstanceModel;
 
 layout(std140) uniform PerObjectBuffer
 {
@@ -21,34 +11,17 @@ layout(std140) uniform PerObjectBuffer
   vec4 DiffuseColour;
   bool DiffuseEnabled;
   bool NormalEnabled;
+  bool MetalnessEnabled;
+  bool RoughnessEnabled;
   bool OcclusionEnabled;
   bool OpacityEnabled;
+  float Metalness;
+  float Roughness;
+  vec4 PositionScale;
+  vec4 PositionOffset;
+  bool CompactVertices;
 } Object;
 
-layout(std140) uniform PerFrameBuffer
-{
-  mat4 CascadeLightTransforms[MAX_CASCADE_LAYERS];
-  mat4 View;
-  mat4 Proj;
-  mat4 ProjInv;
-  mat4 ProjViewInv;
-  vec3 ViewPosition;
-  float FarPlane;
-  vec3 LightDirection;   // ---- Directional Light ----
-  bool SsaoEnabled;
-  vec3 LightColour;      // ---- Directional Light ----
-  float LightIntensity;  // ---- Directional Light ----
-  vec3 AmbientColour;
-  float AmbientIntensity;
-  uint CascadeLayerCount;  
-  bool DrawCascadeLayers;
-  uint ShadowSampleCount;
-  float ShadowSampleSpread;
-  Light Lights[MAX_LIGHTS];
-  float CascadePlaneDistances[MAX_CASCADE_LAYERS];
-  uint LightCount;
-} Constants;
-
 out gl_PerVertex
 {
   vec4 gl_Position;
@@ -58,5 +31,8 @@ out gl_PerVertex
 
 void main()
 {
-  gl_Position = Object.Model * vec4(aPosition, 1.0f);
+  // Only positions are read, which every vertex format supplies through the same attribute. The cascade's light
+  // transform is carried as the object's model view projection.
+  vec3 position = aPosition * Object.PositionScale.xyz + Object.PositionOffset.xyz;
+  gl_Position = Object.ModelViewProjection * aInstanceModel * vec4(position, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 410
+
+void main()
+{
+  gl_FragDepth = 1.0f;
+}
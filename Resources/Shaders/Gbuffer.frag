@@ -14,6 +14,9 @@ layout(std140) uniform PerObjectBuffer
   bool OpacityEnabled;
   float Metalness;
   float Roughness;
+  vec4 PositionScale;
+  vec4 PositionOffset;
+  bool CompactVertices;
 } Object;
 
 struct Input
@@ -38,17 +41,21 @@ layout(location = 0) out vec4 Diffuse;
 layout(location = 1) out vec4 Normal;
 layout(location = 2) out vec4 Material;
 
+// Normal maps may be BC5 compressed, which keeps only X and Y, so Z is always rebuilt from the unit length.
+vec3 UnpackTangentNormal(vec4 normalSample)
+{
+  vec2 xy = normalSample.rg * 2.0f - 1.0f;
+  return vec3(xy, sqrt(max(1.0f - dot(xy, xy), 0.0f)));
+}
+
 vec4 CalculateNormal(vec4 normalSample, vec4 normal)
 {
   if (Object.NormalEnabled)
   {
-    vec3 T = fsIn.Tangent;
-    vec3 N = fsIn.Normal;
-    T = normalize(T - dot(T, N) * N);
-    vec3 B = cross(N, T);
-
-    mat3 tbn = mat3(T, B, N);
-    return vec4(normalize(tbn * (normalSample.rgb * 2.0f - 1.0f)), 0.0f);
+    // The interpolated frame is used as is, as MikkTSpace bakers expect, and the bitangent keeps the handedness of
+    // mirrored texture coordinates.
+    mat3 tbn = mat3(fsIn.Tangent, fsIn.Binormal, fsIn.Normal);
+    return vec4(normalize(tbn * UnpackTangentNormal(normalSample)), 0.0f);
   }
   return normalize(normal);
 }
@@ -3,8 +3,11 @@
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoord;
-layout(location = 3) in vec3 aTangent;
+// Compact vertices hold octahedral encodings in the xy of the normal and tangent, with the bitangent's sign in the
+// tangent's z.
+layout(location = 3) in vec4 aTangent;
 layout(location = 4) in vec3 aBitangent;
+layout(location = 6) in mat4 aInstanceModel;
 
 layout(std140) uniform PerObjectBuffer
 {
@@ -20,6 +23,9 @@ layout(std140) uniform PerObjectBuffer
   bool OpacityEnabled;
   float Metalness;
   float Roughness;
+  vec4 PositionScale;
+  vec4 PositionOffset;
+  bool CompactVertices;
 } Object;
 
 struct Output
@@ -39,15 +45,36 @@ out gl_PerVertex {
   float gl_ClipDistance[];
 };
 
+vec3 decodeOctahedral(vec2 encoded)
+{
+  vec3 v = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+  float fold = max(-v.z, 0.0f);
+  v.xy += vec2(v.x >= 0.0f ? -fold : fold, v.y >= 0.0f ? -fold : fold);
+  return normalize(v);
+}
+
 void main()
 {
-  mat3 normalMatrix = transpose(inverse(mat3(Object.Model)));
+  // Object matrices are shared by every instance in the batch and are combined with the per-instance model matrix.
+  mat4 model = Object.Model * aInstanceModel;
+  mat3 normalMatrix = transpose(inverse(mat3(model)));
+
+  vec3 position = aPosition * Object.PositionScale.xyz + Object.PositionOffset.xyz;
+  vec3 normal = aNormal;
+  vec3 tangent = aTangent.xyz;
+  vec3 bitangent = aBitangent;
+  if (Object.CompactVertices)
+  {
+    normal = decodeOctahedral(aNormal.xy);
+    tangent = decodeOctahedral(aTangent.xy);
+    bitangent = aTangent.z * cross(normal, tangent);
+  }
 
   vsOut.TexCoord = aTexCoord;
-  vsOut.Normal = normalize(normalMatrix * aNormal);
-  vsOut.Tangent = normalize(normalMatrix * aTangent);
-  vsOut.Binormal = normalize(normalMatrix * aBitangent);
-  vsOut.WorldPos = (Object.Model * vec4(aPosition, 1.0f)).xyz;
+  vsOut.Normal = normalize(normalMatrix * normal);
+  vsOut.Tangent = normalize(normalMatrix * tangent);
+  vsOut.Binormal = normalize(normalMatrix * bitangent);
+  vsOut.WorldPos = (model * vec4(position, 1.0f)).xyz;
 
-  gl_Position = Object.ModelViewProjection * vec4(aPosition, 1.0f);
+  gl_Position = Object.ModelViewProjection * aInstanceModel * vec4(position, 1.0f);
 }
\ No newline at end of file
@@ -14,6 +14,9 @@ layout(std140) uniform PerObjectBuffer
   bool OpacityEnabled;
   float Metalness;
   float Roughness;
+  vec4 PositionScale;
+  vec4 PositionOffset;
+  bool CompactVertices;
 } Object;
 
 struct Input
@@ -47,12 +50,19 @@ vec3 CalculateDiffuse(vec4 diffuseSample)
   return Object.DiffuseColour.rgb;
 }
 
+// Normal maps may be BC5 compressed, which keeps only X and Y, so Z is always rebuilt from the unit length.
+vec3 UnpackTangentNormal(vec4 normalSample)
+{
+  vec2 xy = normalSample.rg * 2.0f - 1.0f;
+  return vec3(xy, sqrt(max(1.0f - dot(xy, xy), 0.0f)));
+}
+
 vec4 CalculateNormal(vec4 normalSample, vec4 normal)
 {
   if (Object.NormalEnabled)
   {
     mat3 tbn = mat3(fsIn.Tangent, fsIn.Binormal, fsIn.Normal);
-    return vec4(normalize(tbn * (normalSample.rgb) * 2.0f - 1.0f), 0.0f);
+    return vec4(normalize(tbn * UnpackTangentNormal(normalSample)), 0.0f);
   }
   return normalize(normal);
 }
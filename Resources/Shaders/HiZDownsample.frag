@@ -0,0 +1,28 @@
+#version 410
+
+layout(location = 0) in vec2 TexCoord;
+
+out float Depth;
+
+uniform sampler2D DepthMap;
+
+void main()
+{
+  // Each texel takes the furthest depth of every full resolution pixel it overlaps, so the reduced buffer never reports
+  // a surface nearer than one that was drawn. The texture coordinates step by one texel of this target per pixel.
+  ivec2 depthSize = textureSize(DepthMap, 0);
+  vec2 scale = vec2(depthSize) * abs(vec2(dFdx(TexCoord.x), dFdy(TexCoord.y)));
+  vec2 texel = floor(gl_FragCoord.xy);
+  ivec2 begin = clamp(ivec2(floor(texel * scale)), ivec2(0), depthSize - 1);
+  ivec2 end = clamp(ivec2(ceil((texel + 1.0f) * scale)), begin + 1, depthSize);
+
+  float depth = 0.0f;
+  for (int y = begin.y; y < end.y; y++)
+  {
+    for (int x = begin.x; x < end.x; x++)
+    {
+      depth = max(depth, texelFetch(DepthMap, ivec2(x, y), 0).r);
+    }
+  }
+  Depth = depth;
+}
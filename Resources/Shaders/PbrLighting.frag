@@ -2,8 +2,16 @@
 
 #define M_PI 3.1415926535897932384626433832795
 
-const int MAX_LIGHTS = 1024;
 const int MAX_CASCADE_LAYERS = 8;
+// Must match LightClusters and LIGHT_TEXTURE_WIDTH in the renderer.
+const int CLUSTER_TILES_X = 16;
+const int CLUSTER_TILES_Y = 9;
+const int CLUSTER_SLICES = 24;
+const int LIGHT_TEXTURE_WIDTH = 1024;
+const int LIGHT_DATA_TEXELS = 4;
+const int SHADOW_TILE_TEXELS = 6;
+// Depth bias of local light shadows, on top of offsetting the position along its normal by a texel.
+const float LOCAL_SHADOW_BIAS = 0.00005f;
 
 struct Light
 {
@@ -11,6 +19,13 @@ struct Light
   float Intensity;
   vec3 Position;
   float Radius;
+  vec3 Direction;
+  // Cosines of the spot cone's half angles. Point lights are given a cone which lights every direction.
+  float CosOuter;
+  float CosInner;
+  // The light's first tile in the shadow tile map, or -1 when it has no shadows.
+  int FirstShadowTile;
+  int ShadowTileCount;
 };
 
 layout(std140) uniform PerFrameBuffer
@@ -32,13 +47,14 @@ layout(std140) uniform PerFrameBuffer
   bool DrawCascadeLayers;
   uint ShadowSampleCount;
   float ShadowSampleSpread;
-  Light Lights[MAX_LIGHTS];
   float CascadePlaneDistances[MAX_CASCADE_LAYERS];
   uint LightCount;
   float Exposure;
   bool ToneMappingEnabled;
   float BloomStrength;
   float BloomThreshold;
+  float ClusterSliceScale;
+  float ClusterSliceBias;
 } Constants;
 
 uniform sampler2D AlbedoMap;
@@ -47,6 +63,16 @@ uniform sampler2D NormalMap;
 uniform sampler2D MaterialMap;
 uniform sampler2D ShadowMap;
 uniform sampler2D OcclusionMap;
+// Offset of each cluster's first light index in the upper 24 bits and its light count in the lower 8.
+uniform usampler3D ClusterMap;
+// Colour and intensity, position and radius, direction and spot cone, then shadow tiles, four texels per light.
+uniform sampler2D LightMap;
+uniform usampler2D LightIndexMap;
+// Shadow maps of point and spot lights, one tile per spot light and one per cube face for point lights.
+uniform sampler2D ShadowAtlas;
+// For each tile its view projection, its rectangle in the atlas, then the width of one of its texels at unit distance
+// from the light and of an atlas texel, six texels per tile.
+uniform sampler2D ShadowTileMap;
 
 layout(location = 0) in vec2 TexCoord;
 layout(location = 0) out vec4 FinalColour;
@@ -77,6 +103,7 @@ vec3 calcPointLight(Light light,
                     float roughness, 
                     float metalness, 
                     vec3 F0);
+float calcLocalShadow(Light light, vec3 fragPos, vec3 normal);
 
 
 vec3 drawCascadeLayers(vec3 position)
@@ -98,6 +125,35 @@ vec3 drawCascadeLayers(vec3 position)
   return vec3(0.0);
 }
 
+Light fetchLight(uint lightIndex)
+{
+  // Rows hold a whole number of lights, so a light's texels are always on the same row.
+  int texel = int(lightIndex) * LIGHT_DATA_TEXELS;
+  ivec2 coord = ivec2(texel % LIGHT_TEXTURE_WIDTH, texel / LIGHT_TEXTURE_WIDTH);
+  vec4 colourIntensity = texelFetch(LightMap, coord, 0);
+  vec4 positionRadius = texelFetch(LightMap, coord + ivec2(1, 0), 0);
+  vec4 directionCosOuter = texelFetch(LightMap, coord + ivec2(2, 0), 0);
+  vec4 cosInnerShadows = texelFetch(LightMap, coord + ivec2(3, 0), 0);
+  return Light(colourIntensity.rgb, colourIntensity.a, 
+               positionRadius.xyz, positionRadius.w, 
+               directionCosOuter.xyz, directionCosOuter.w, 
+               cosInnerShadows.x, int(cosInnerShadows.y), int(cosInnerShadows.z));
+}
+
+vec4 fetchShadowTileTexel(int texel)
+{
+  return texelFetch(ShadowTileMap, ivec2(texel % LIGHT_TEXTURE_WIDTH, texel / LIGHT_TEXTURE_WIDTH), 0);
+}
+
+uint fetchCluster(vec3 position)
+{
+  // Slices are spaced exponentially in view depth, tiles evenly across the screen.
+  float depth = max(-(Constants.View * vec4(position, 1.0)).z, 1e-4f);
+  int slice = clamp(int(floor(log(depth) * Constants.ClusterSliceScale + Constants.ClusterSliceBias)), 0, CLUSTER_SLICES - 1);
+  ivec2 tile = clamp(ivec2(TexCoord * vec2(CLUSTER_TILES_X, CLUSTER_TILES_Y)), ivec2(0), ivec2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+  return texelFetch(ClusterMap, ivec3(tile, slice), 0).r;
+}
+
 vec3 calculatePositionWS(vec2 screenCoords)
 {
   vec2 windowDimensions = textureSize(NormalMap, 0);
@@ -151,10 +207,14 @@ void main()
                                 shadowFactor, 
                                 F0);
 
-  // Point light contributions.
-  for (int i = 0; i < Constants.LightCount; i++)
+  // Point and spot light contributions, from only the lights reaching this pixel's cluster.
+  uint cluster = fetchCluster(position);
+  uint lightOffset = cluster >> 8;
+  uint lightCount = cluster & 0xffu;
+  for (uint i = lightOffset; i < lightOffset + lightCount; i++)
   {
-    totalRadiance += calcPointLight(Constants.Lights[i], 
+    ivec2 indexCoord = ivec2(int(i) % LIGHT_TEXTURE_WIDTH, int(i) / LIGHT_TEXTURE_WIDTH);
+    totalRadiance += calcPointLight(fetchLight(texelFetch(LightIndexMap, indexCoord, 0).r), 
                                     normal, 
                                     position, 
                                     viewDir, 
@@ -280,9 +340,10 @@ vec3 calcPointLight(Light light,
 
   float distance = length(lightPosition - fragPos);
   float attenuation = pow(clamp(1 - pow((distance / radius), 4.0f), 0.0f, 1.0f), 2.0f)/(1.0f  + (distance * distance) );
+  attenuation *= smoothstep(light.CosOuter, light.CosInner, dot(-lightDir, light.Direction));
   if (attenuation > 0.0f)
   {
-    vec3 radianceIn = colour * attenuation * intensity;
+    vec3 radianceIn = colour * attenuation * intensity * calcLocalShadow(light, fragPos, normal);
 
     // Calculating Cook-Torrance BRDF terms.
     float NDF = distributionGGX(normal, halfway, roughness);
@@ -303,4 +364,68 @@ vec3 calcPointLight(Light light,
   }
 
   return vec3(0.0f);
+}
+
+float calcLocalShadow(Light light, vec3 fragPos, vec3 normal)
+{
+  if (light.FirstShadowTile < 0)
+  {
+    return 1.0f;
+  }
+
+  // Point lights pick the cube face along the major axis of the direction from the light.
+  vec3 fromLight = fragPos - light.Position;
+  int tile = light.FirstShadowTile;
+  if (light.ShadowTileCount > 1)
+  {
+    vec3 absFromLight = abs(fromLight);
+    if (absFromLight.x >= absFromLight.y && absFromLight.x >= absFromLight.z)
+    {
+      tile += fromLight.x < 0.0f ? 1 : 0;
+    }
+    else if (absFromLight.y >= absFromLight.z)
+    {
+      tile += fromLight.y < 0.0f ? 3 : 2;
+    }
+    else
+    {
+      tile += fromLight.z < 0.0f ? 5 : 4;
+    }
+  }
+
+  int texel = tile * SHADOW_TILE_TEXELS;
+  mat4 transform = mat4(fetchShadowTileTexel(texel), 
+                        fetchShadowTileTexel(texel + 1), 
+                        fetchShadowTileTexel(texel + 2), 
+                        fetchShadowTileTexel(texel + 3));
+  vec4 tileRect = fetchShadowTileTexel(texel + 4);
+  vec4 texelSizes = fetchShadowTileTexel(texel + 5);
+
+  // Offsetting along the normal by a tile texel at this distance hides acne without detaching the shadow.
+  vec3 offsetPosition = fragPos + normal * length(fromLight) * texelSizes.x * 1.5f;
+  vec4 clipPosition = transform * vec4(offsetPosition, 1.0f);
+  if (clipPosition.w <= 0.0f)
+  {
+    return 1.0f;
+  }
+  vec3 projected = (clipPosition.xyz / clipPosition.w) * 0.5f + 0.5f;
+  if (projected.z >= 1.0f)
+  {
+    return 1.0f;
+  }
+
+  // 3x3 PCF, clamped to the tile so that its neighbours never bleed in.
+  vec2 tileMin = tileRect.xy + texelSizes.y * 0.5f;
+  vec2 tileMax = tileRect.xy + tileRect.zw - texelSizes.y * 0.5f;
+  vec2 coord = tileRect.xy + projected.xy * tileRect.zw;
+  float lit = 0.0f;
+  for (int x = -1; x <= 1; x++)
+  {
+    for (int y = -1; y <= 1; y++)
+    {
+      vec2 sampleCoord = clamp(coord + vec2(x, y) * texelSizes.y, tileMin, tileMax);
+      lit += projected.z - LOCAL_SHADOW_BIAS <= texture(ShadowAtlas, sampleCoord).r ? 1.0f : 0.0f;
+    }
+  }
+  return lit / 9.0f;
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 
 #define DEBUG_SHADOW_ARTIFACTS 0
 
-const int MAX_LIGHTS = 1024;
 const int MAX_CASCADE_LAYERS = 8;
 const float Pi2 = 6.283185307f;
 
@@ -96,14 +95,6 @@ const vec2 PoissonSamples[64] = vec2[]
  * 5. Better cascade layer validation and error handling
  */
 
-struct Light
-{
-  vec3 Colour;
-  float Intensity;
-  vec3 Position;
-  float Radius;
-};
-
 layout(std140) uniform PerFrameBuffer
 {
   mat4 CascadeLightTransforms[MAX_CASCADE_LAYERS];
@@ -124,7 +115,6 @@ layout(std140) uniform PerFrameBuffer
   bool DrawCascadeLayers;
   uint ShadowSampleCount;
   float ShadowSampleSpread;
-  Light Lights[MAX_LIGHTS];
   float CascadePlaneDistances[MAX_CASCADE_LAYERS];
   uint LightCount;
 } Constants;
@@ -0,0 +1,40 @@
+#version 410
+
+const int MAX_CASCADE_LAYERS = 8;
+
+layout(std140) uniform PerFrameBuffer
+{
+  mat4 CascadeLightTransforms[MAX_CASCADE_LAYERS];
+  mat4 View;
+  mat4 Proj;
+  mat4 ProjInv;
+  mat4 ProjViewInv;
+} Constants;
+
+layout(location = 0) in vec2 TexCoord;
+
+out float LinearDepth;
+
+uniform sampler2D DepthMap;
+
+float linearizeDepth(float depth)
+{
+  return Constants.Proj[3][2] / ((depth * 2.0f - 1.0f) + Constants.Proj[2][2]);
+}
+
+void main()
+{
+  ivec2 maxCoord = textureSize(DepthMap, 0) - 1;
+  ivec2 coord = ivec2(gl_FragCoord.xy) * 2;
+  float depth0 = texelFetch(DepthMap, min(coord, maxCoord), 0).r;
+  float depth1 = texelFetch(DepthMap, min(coord + ivec2(1, 0), maxCoord), 0).r;
+  float depth2 = texelFetch(DepthMap, min(coord + ivec2(0, 1), maxCoord), 0).r;
+  float depth3 = texelFetch(DepthMap, min(coord + ivec2(1, 1), maxCoord), 0).r;
+
+  // Alternating between the nearest and furthest depth of each 2x2 block in a checkerboard keeps both sides of a
+  // depth edge in the half resolution buffer, so the upsample can find a match for every full resolution pixel.
+  ivec2 halfCoord = ivec2(gl_FragCoord.xy);
+  bool nearest = ((halfCoord.x + halfCoord.y) & 1) == 0;
+  float depth = nearest ? min(min(depth0, depth1), min(depth2, depth3)) : max(max(depth0, depth1), max(depth2, depth3));
+  LinearDepth = linearizeDepth(depth);
+}
@@ -0,0 +1,102 @@
+#version 410
+
+#define M_PI 3.1415926535897932384626433832795
+
+const uint MaxKernelSize = 512;
+const int MAX_CASCADE_LAYERS = 8;
+
+layout(std140) uniform PerFrameBuffer
+{
+  mat4 CascadeLightTransforms[MAX_CASCADE_LAYERS];
+  mat4 View;
+  mat4 Proj;
+  mat4 ProjInv;
+  mat4 ProjViewInv;
+  vec3 ViewPosition;
+  float FarPlane;
+} Constants;
+
+layout(std140) uniform SsaoConstantsBuffer
+{
+  // Unit directions about +Z, with the fraction of the radius each reaches in w.
+  vec4 NoiseSamples[MaxKernelSize];
+  uint KernelSize;
+  float Radius;
+  float Bias;
+  float Intensity;
+} SsaoConstants;
+
+layout(std140) uniform SsaoFrameBuffer
+{
+  mat4 InverseView;
+  mat4 PreviousViewProj;
+  uint FrameIndex;
+  float DepthRejection;
+  float MaxHistory;
+  bool HistoryValid;
+} Frame;
+
+layout(location = 0) in vec2 TexCoord;
+
+out float Occlusion;
+
+// View depth at half resolution, from the downsample.
+uniform sampler2D LinearDepthMap;
+uniform sampler2D NormalMap;
+
+vec3 calculatePositionVS(vec2 uv, float linearDepth)
+{
+  vec2 ndc = uv * 2.0f - 1.0f;
+  return vec3(ndc.x * linearDepth / Constants.Proj[0][0], ndc.y * linearDepth / Constants.Proj[1][1], -linearDepth);
+}
+
+// Noise which is even across neighbouring pixels, offset each frame so the history gathers different rotations.
+float interleavedGradientNoise(vec2 pixel)
+{
+  return fract(52.9829189f * fract(dot(pixel, vec2(0.06711056f, 0.00583715f))));
+}
+
+void main()
+{
+  float depth = texelFetch(LinearDepthMap, ivec2(gl_FragCoord.xy), 0).r;
+  if (depth >= Constants.FarPlane * 0.999f)
+  {
+    Occlusion = 1.0f;
+    return;
+  }
+
+  vec3 positionVS = calculatePositionVS(TexCoord, depth);
+  vec3 normalWS = normalize(texture(NormalMap, TexCoord).xyz * 2.0f - 1.0f);
+  vec3 normalVS = normalize(mat3(Constants.View) * normalWS);
+
+  // Rotate the kernel about the normal by an angle which changes per pixel and per frame.
+  float frameOffset = 5.588238f * float(Frame.FrameIndex % 64u);
+  float angle = interleavedGradientNoise(gl_FragCoord.xy + frameOffset) * 2.0f * M_PI;
+  float lengthOffset = interleavedGradientNoise(gl_FragCoord.yx + frameOffset + 17.0f);
+  vec3 reference = abs(normalVS.z) < 0.999f ? vec3(0.0f, 0.0f, 1.0f) : vec3(1.0f, 0.0f, 0.0f);
+  vec3 tangent = normalize(cross(reference, normalVS));
+  vec3 bitangent = cross(normalVS, tangent);
+  tangent = cos(angle) * tangent + sin(angle) * bitangent;
+  bitangent = cross(normalVS, tangent);
+  mat3 transform = mat3(tangent, bitangent, normalVS);
+
+  float occlusion = 0.0f;
+  for (uint i = 0; i < SsaoConstants.KernelSize; ++i)
+  {
+    // Lengths are shifted per pixel too, still gathered toward the center of the kernel.
+    vec4 kernelSample = SsaoConstants.NoiseSamples[i];
+    float reach = fract(kernelSample.w + lengthOffset);
+    reach = mix(0.1f, 1.0f, reach * reach);
+    vec3 samplePositionVS = positionVS + transform * kernelSample.xyz * reach * SsaoConstants.Radius;
+
+    vec4 offset = Constants.Proj * vec4(samplePositionVS, 1.0f);
+    vec2 sampleUv = (offset.xy / offset.w) * 0.5f + 0.5f;
+    float sceneDepth = texture(LinearDepthMap, sampleUv).r;
+
+    // Occluded when the scene is in front of the sample, fading out occluders well outside the radius.
+    float rangeCheck = smoothstep(0.0f, 1.0f, SsaoConstants.Radius / abs(depth - sceneDepth));
+    occlusion += (sceneDepth <= -samplePositionVS.z - SsaoConstants.Bias ? 1.0f : 0.0f) * rangeCheck;
+  }
+
+  Occlusion = pow(1.0f - (occlusion / float(SsaoConstants.KernelSize)), SsaoConstants.Intensity);
+}
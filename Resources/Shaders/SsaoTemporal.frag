@@ -0,0 +1,64 @@
+#version 410
+
+const int MAX_CASCADE_LAYERS = 8;
+
+layout(std140) uniform PerFrameBuffer
+{
+  mat4 CascadeLightTransforms[MAX_CASCADE_LAYERS];
+  mat4 View;
+  mat4 Proj;
+  mat4 ProjInv;
+  mat4 ProjViewInv;
+} Constants;
+
+layout(std140) uniform SsaoFrameBuffer
+{
+  mat4 InverseView;
+  mat4 PreviousViewProj;
+  uint FrameIndex;
+  float DepthRejection;
+  float MaxHistory;
+  bool HistoryValid;
+} Frame;
+
+layout(location = 0) in vec2 TexCoord;
+
+// Accumulated occlusion and the frames accumulated into it.
+out vec2 Accumulated;
+
+uniform sampler2D OcclusionMap;
+uniform sampler2D LinearDepthMap;
+uniform sampler2D HistoryMap;
+uniform sampler2D HistoryDepthMap;
+
+void main()
+{
+  ivec2 coord = ivec2(gl_FragCoord.xy);
+  float occlusion = texelFetch(OcclusionMap, coord, 0).r;
+  float depth = texelFetch(LinearDepthMap, coord, 0).r;
+
+  // Find where this pixel was last frame.
+  vec2 ndc = TexCoord * 2.0f - 1.0f;
+  vec3 positionVS = vec3(ndc.x * depth / Constants.Proj[0][0], ndc.y * depth / Constants.Proj[1][1], -depth);
+  vec4 previousClip = Frame.PreviousViewProj * (Frame.InverseView * vec4(positionVS, 1.0f));
+  vec2 previousUv = (previousClip.xy / previousClip.w) * 0.5f + 0.5f;
+
+  float history = occlusion;
+  float historyLength = 0.0f;
+  bool onScreen = all(greaterThanEqual(previousUv, vec2(0.0f))) && all(lessThanEqual(previousUv, vec2(1.0f)));
+  if (Frame.HistoryValid && previousClip.w > 0.0f && onScreen)
+  {
+    // History whose depth does not match where the surface was last frame belonged to something else, which was
+    // covering it or has moved away.
+    float historyDepth = texture(HistoryDepthMap, previousUv).r;
+    if (abs(historyDepth - previousClip.w) < Frame.DepthRejection * previousClip.w)
+    {
+      vec2 previous = texture(HistoryMap, previousUv).rg;
+      history = previous.r;
+      historyLength = previous.g;
+    }
+  }
+
+  historyLength = min(historyLength + 1.0f, Frame.MaxHistory);
+  Accumulated = vec2(mix(history, occlusion, 1.0f / historyLength), historyLength);
+}
@@ -0,0 +1,64 @@
+#version 410
+
+const int MAX_CASCADE_LAYERS = 8;
+// Relative difference in depth over which a half resolution texel's weight falls by e.
+const float DEPTH_SIGMA = 0.02f;
+
+layout(std140) uniform PerFrameBuffer
+{
+  mat4 CascadeLightTransforms[MAX_CASCADE_LAYERS];
+  mat4 View;
+  mat4 Proj;
+  mat4 ProjInv;
+  mat4 ProjViewInv;
+} Constants;
+
+layout(location = 0) in vec2 TexCoord;
+
+out float Occlusion;
+
+// Accumulated occlusion and view depth at half resolution.
+uniform sampler2D OcclusionMap;
+uniform sampler2D LinearDepthMap;
+uniform sampler2D DepthMap;
+
+float linearizeDepth(float depth)
+{
+  return Constants.Proj[3][2] / ((depth * 2.0f - 1.0f) + Constants.Proj[2][2]);
+}
+
+void main()
+{
+  float depth = linearizeDepth(texelFetch(DepthMap, ivec2(gl_FragCoord.xy), 0).r);
+
+  // Weighs the 4x4 half resolution texels around the pixel by distance, and by how close their depth is to its own so
+  // occlusion never bleeds across edges. The footprint also smooths what noise the history has not yet averaged out.
+  ivec2 halfSize = textureSize(OcclusionMap, 0);
+  vec2 halfCoord = TexCoord * vec2(halfSize) - 0.5f;
+  ivec2 base = ivec2(floor(halfCoord));
+  float total = 0.0f;
+  float weightSum = 0.0f;
+  float nearestDifference = 1e30f;
+  float nearestOcclusion = 1.0f;
+  for (int y = -1; y <= 2; y++)
+  {
+    for (int x = -1; x <= 2; x++)
+    {
+      ivec2 coord = clamp(base + ivec2(x, y), ivec2(0), halfSize - 1);
+      float sampleOcclusion = texelFetch(OcclusionMap, coord, 0).r;
+      float depthDifference = abs(texelFetch(LinearDepthMap, coord, 0).r - depth);
+      vec2 offset = vec2(coord) - halfCoord;
+      float weight = exp(-0.5f * dot(offset, offset) - depthDifference / (depth * DEPTH_SIGMA));
+      total += sampleOcclusion * weight;
+      weightSum += weight;
+      if (depthDifference < nearestDifference)
+      {
+        nearestDifference = depthDifference;
+        nearestOcclusion = sampleOcclusion;
+      }
+    }
+  }
+
+  // Thin features may match none of the texels around them, in which case the closest in depth is taken.
+  Occlusion = weightSum > 1e-4f ? total / weightSum : nearestOcclusion;
+}
@@ -1,16 +1,7 @@
 #version 410
 
-const int MAX_LIGHTS = 1024;
 const int MAX_CASCADE_LAYERS = 8;
 
-struct Light
-{
-  vec3 Colour;
-  float Intensity;
-  vec3 Position;
-  float Radius;
-};
-
 layout(std140) uniform PerFrameBuffer
 {
   mat4 CascadeLightTransforms[MAX_CASCADE_LAYERS];
@@ -31,7 +22,6 @@ layout(std140) uniform PerFrameBuffer
   bool DrawCascadeLayers;
   uint ShadowSampleCount;
   float ShadowSampleSpread;
-  Light Lights[MAX_LIGHTS];
   float CascadePlaneDistances[MAX_CASCADE_LAYERS];
   uint LightCount;
   float Exposure;
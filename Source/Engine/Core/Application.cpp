@@ -4,6 +4,7 @@
 #include <utility>
 #include "../RenderApi/GL/GLRenderDevice.hpp"
 #include "../RenderApi/Texture.hpp"
+#include "../Utility/HotReload.hpp"
 #include "../Utility/TextureLoader.hpp"
 #include "InputHandler.h"
 
@@ -328,6 +329,8 @@ int32 Application::run()
       _scene.setMouseCoordinates(Vector2I(_windowToFramebufferRatio * static_cast<float32>(_currentMousePos.X),
                                           _windowToFramebufferRatio * static_cast<float32>(_currentMousePos.Y)));
 
+      // Ahead of the scene update, whose upload queue swaps in any models rebuilt since the last frame.
+      HotReload::get().update();
       _scene.update(dtMs);
       _scene.drawFrame();
       _debugUi->update(_scene);
@@ -0,0 +1,391 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "../Maths/Frustrum.hpp"
+#include "../Maths/Ray.hpp"
+
+namespace
+{
+  Vector3 min(const Vector3 &a, const Vector3 &b)
+  {
+    return Vector3(std::fminf(a.X, b.X), std::fminf(a.Y, b.Y), std::fminf(a.Z, b.Z));
+  }
+
+  Vector3 max(const Vector3 &a, const Vector3 &b)
+  {
+    return Vector3(std::fmaxf(a.X, b.X), std::fmaxf(a.Y, b.Y), std::fmaxf(a.Z, b.Z));
+  }
+
+  float32 surfaceArea(const Vector3 &min, const Vector3 &max)
+  {
+    Vector3 d(max - min);
+    return 2.0f * (d.X * d.Y + d.Y * d.Z + d.Z * d.X);
+  }
+
+  bool contains(const Vector3 &outerMin, const Vector3 &outerMax, const Vector3 &innerMin, const Vector3 &innerMax)
+  {
+    return outerMin.X <= innerMin.X && outerMin.Y <= innerMin.Y && outerMin.Z <= innerMin.Z &&
+           innerMax.X <= outerMax.X && innerMax.Y <= outerMax.Y && innerMax.Z <= outerMax.Z;
+  }
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(float32 fatMargin) : _root(NullNode),
+                                                                      _freeList(NullNode),
+                                                                      _proxyCount(0),
+                                                                      _fatMargin(fatMargin)
+{
+}
+
+int32 BoundingVolumeHierarchy::insert(const Aabb &aabb, uint64 userData)
+{
+  int32 leafId = allocateNode();
+  Node &leaf = _nodes[leafId];
+  leaf.TightMin = aabb.getMin();
+  leaf.TightMax = aabb.getMax();
+  leaf.Min = leaf.TightMin - _fatMargin;
+  leaf.Max = leaf.TightMax + _fatMargin;
+  leaf.UserData = userData;
+  leaf.Height = 0;
+
+  insertLeaf(leafId);
+  _proxyCount++;
+  return leafId;
+}
+
+void BoundingVolumeHierarchy::remove(int32 proxyId)
+{
+  if (proxyId < 0 || proxyId >= static_cast<int32>(_nodes.size()) || !_nodes[proxyId].isLeaf() || _nodes[proxyId].Height != 0)
+  {
+    throw std::runtime_error("Invalid BVH proxy id.");
+  }
+
+  removeLeaf(proxyId);
+  freeNode(proxyId);
+  _proxyCount--;
+}
+
+bool BoundingVolumeHierarchy::move(int32 proxyId, const Aabb &aabb)
+{
+  Node &leaf = _nodes[proxyId];
+  leaf.TightMin = aabb.getMin();
+  leaf.TightMax = aabb.getMax();
+  if (contains(leaf.Min, leaf.Max, leaf.TightMin, leaf.TightMax))
+  {
+    return false;
+  }
+
+  removeLeaf(proxyId);
+  Node &movedLeaf = _nodes[proxyId];
+  movedLeaf.Min = movedLeaf.TightMin - _fatMargin;
+  movedLeaf.Max = movedLeaf.TightMax + _fatMargin;
+  insertLeaf(proxyId);
+  return true;
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+  _nodes.clear();
+  _root = NullNode;
+  _freeList = NullNode;
+  _proxyCount = 0;
+}
+
+void BoundingVolumeHierarchy::query(const Frustrum &frustrum, std::vector<uint64> &userData) const
+{
+  if (_root != NullNode)
+  {
+    query(_root, frustrum, FRUSTRUM_ALL_PLANES, userData);
+  }
+}
+
+bool BoundingVolumeHierarchy::raycast(const Ray &ray, uint64 &userData, float32 &distance) const
+{
+  if (_root == NullNode)
+  {
+    return false;
+  }
+
+  bool hit = false;
+  float32 nearest = std::numeric_limits<float32>::max();
+
+  std::vector<int32> stack;
+  stack.reserve(64);
+  stack.push_back(_root);
+  while (!stack.empty())
+  {
+    const Node &node = _nodes[stack.back()];
+    stack.pop_back();
+
+    float32 entry = 0.0f;
+    if (node.isLeaf())
+    {
+      if (ray.Intersects(Aabb(node.TightMax, node.TightMin), entry) && entry < nearest)
+      {
+        nearest = entry;
+        userData = node.UserData;
+        hit = true;
+      }
+    }
+    else if (ray.Intersects(Aabb(node.Max, node.Min), entry) && entry < nearest)
+    {
+      stack.push_back(node.Left);
+      stack.push_back(node.Right);
+    }
+  }
+
+  distance = nearest;
+  return hit;
+}
+
+int32 BoundingVolumeHierarchy::allocateNode()
+{
+  int32 nodeId;
+  if (_freeList == NullNode)
+  {
+    nodeId = static_cast<int32>(_nodes.size());
+    _nodes.emplace_back();
+  }
+  else
+  {
+    nodeId = _freeList;
+    _freeList = _nodes[nodeId].Parent;
+  }
+
+  Node &node = _nodes[nodeId];
+  node.UserData = 0;
+  node.Parent = NullNode;
+  node.Left = NullNode;
+  node.Right = NullNode;
+  node.Height = 0;
+  return nodeId;
+}
+
+void BoundingVolumeHierarchy::freeNode(int32 nodeId)
+{
+  // Free nodes are chained through Parent and marked with a negative height so stale proxy ids are caught.
+  _nodes[nodeId].Parent = _freeList;
+  _nodes[nodeId].Left = NullNode;
+  _nodes[nodeId].Height = -1;
+  _freeList = nodeId;
+}
+
+void BoundingVolumeHierarchy::insertLeaf(int32 leafId)
+{
+  if (_root == NullNode)
+  {
+    _root = leafId;
+    _nodes[_root].Parent = NullNode;
+    return;
+  }
+
+  // Descend towards the sibling which results in the smallest increase of surface area.
+  Vector3 leafMin(_nodes[leafId].Min);
+  Vector3 leafMax(_nodes[leafId].Max);
+  int32 index = _root;
+  while (!_nodes[index].isLeaf())
+  {
+    const Node &node = _nodes[index];
+    float32 area = surfaceArea(node.Min, node.Max);
+    float32 combinedArea = surfaceArea(min(node.Min, leafMin), max(node.Max, leafMax));
+
+    float32 cost = 2.0f * combinedArea;
+    float32 inheritanceCost = 2.0f * (combinedArea - area);
+
+    auto descendCost = [&](int32 childId)
+    {
+      const Node &child = _nodes[childId];
+      float32 childArea = surfaceArea(min(child.Min, leafMin), max(child.Max, leafMax));
+      return child.isLeaf() ? childArea + inheritanceCost : childArea - surfaceArea(child.Min, child.Max) + inheritanceCost;
+    };
+
+    float32 leftCost = descendCost(node.Left);
+    float32 rightCost = descendCost(node.Right);
+    if (cost < leftCost && cost < rightCost)
+    {
+      break;
+    }
+    index = leftCost < rightCost ? node.Left : node.Right;
+  }
+
+  int32 siblingId = index;
+  int32 oldParentId = _nodes[siblingId].Parent;
+  int32 newParentId = allocateNode();
+  Node &newParent = _nodes[newParentId];
+  newParent.Parent = oldParentId;
+  newParent.Min = min(leafMin, _nodes[siblingId].Min);
+  newParent.Max = max(leafMax, _nodes[siblingId].Max);
+  newParent.Height = _nodes[siblingId].Height + 1;
+  newParent.Left = siblingId;
+  newParent.Right = leafId;
+  _nodes[siblingId].Parent = newParentId;
+  _nodes[leafId].Parent = newParentId;
+
+  if (oldParentId == NullNode)
+  {
+    _root = newParentId;
+  }
+  else if (_nodes[oldParentId].Left == siblingId)
+  {
+    _nodes[oldParentId].Left = newParentId;
+  }
+  else
+  {
+    _nodes[oldParentId].Right = newParentId;
+  }
+
+  refit(_nodes[leafId].Parent);
+}
+
+void BoundingVolumeHierarchy::removeLeaf(int32 leafId)
+{
+  if (leafId == _root)
+  {
+    _root = NullNode;
+    return;
+  }
+
+  int32 parentId = _nodes[leafId].Parent;
+  int32 grandParentId = _nodes[parentId].Parent;
+  int32 siblingId = _nodes[parentId].Left == leafId ? _nodes[parentId].Right : _nodes[parentId].Left;
+
+  if (grandParentId == NullNode)
+  {
+    _root = siblingId;
+    _nodes[siblingId].Parent = NullNode;
+    freeNode(parentId);
+    return;
+  }
+
+  if (_nodes[grandParentId].Left == parentId)
+  {
+    _nodes[grandParentId].Left = siblingId;
+  }
+  else
+  {
+    _nodes[grandParentId].Right = siblingId;
+  }
+  _nodes[siblingId].Parent = grandParentId;
+  freeNode(parentId);
+
+  refit(grandParentId);
+}
+
+int32 BoundingVolumeHierarchy::balance(int32 aId)
+{
+  Node &a = _nodes[aId];
+  if (a.isLeaf() || a.Height < 2)
+  {
+    return aId;
+  }
+
+  int32 bId = a.Left;
+  int32 cId = a.Right;
+  int32 difference = _nodes[cId].Height - _nodes[bId].Height;
+  if (difference >= -1 && difference <= 1)
+  {
+    return aId;
+  }
+
+  // Rotate the taller child up into a's place, giving a the shorter of the taller child's children.
+  int32 upId = difference > 1 ? cId : bId;
+  int32 otherId = difference > 1 ? bId : cId;
+  Node &up = _nodes[upId];
+  int32 fId = up.Left;
+  int32 gId = up.Right;
+
+  up.Left = aId;
+  up.Parent = a.Parent;
+  a.Parent = upId;
+  if (up.Parent == NullNode)
+  {
+    _root = upId;
+  }
+  else if (_nodes[up.Parent].Left == aId)
+  {
+    _nodes[up.Parent].Left = upId;
+  }
+  else
+  {
+    _nodes[up.Parent].Right = upId;
+  }
+
+  int32 keepId = _nodes[fId].Height > _nodes[gId].Height ? fId : gId;
+  int32 moveId = keepId == fId ? gId : fId;
+  up.Right = keepId;
+  if (difference > 1)
+  {
+    a.Right = moveId;
+  }
+  else
+  {
+    a.Left = moveId;
+  }
+  _nodes[moveId].Parent = aId;
+
+  a.Min = min(_nodes[otherId].Min, _nodes[moveId].Min);
+  a.Max = max(_nodes[otherId].Max, _nodes[moveId].Max);
+  a.Height = 1 + std::max(_nodes[otherId].Height, _nodes[moveId].Height);
+  up.Min = min(a.Min, _nodes[keepId].Min);
+  up.Max = max(a.Max, _nodes[keepId].Max);
+  up.Height = 1 + std::max(a.Height, _nodes[keepId].Height);
+  return upId;
+}
+
+void BoundingVolumeHierarchy::refit(int32 nodeId)
+{
+  while (nodeId != NullNode)
+  {
+    nodeId = balance(nodeId);
+
+    Node &node = _nodes[nodeId];
+    const Node &left = _nodes[node.Left];
+    const Node &right = _nodes[node.Right];
+    node.Min = min(left.Min, right.Min);
+    node.Max = max(left.Max, right.Max);
+    node.Height = 1 + std::max(left.Height, right.Height);
+
+    nodeId = node.Parent;
+  }
+}
+
+void BoundingVolumeHierarchy::collectLeaves(int32 nodeId, std::vector<uint64> &userData) const
+{
+  const Node &node = _nodes[nodeId];
+  if (node.isLeaf())
+  {
+    userData.push_back(node.UserData);
+    return;
+  }
+  collectLeaves(node.Left, userData);
+  collectLeaves(node.Right, userData);
+}
+
+void BoundingVolumeHierarchy::query(int32 nodeId, const Frustrum &frustrum, uint32 planeMask, std::vector<uint64> &userData) const
+{
+  const Node &node = _nodes[nodeId];
+  if (node.isLeaf())
+  {
+    if (frustrum.intersects(Aabb(node.TightMax, node.TightMin), planeMask) != FrustrumIntersection::Outside)
+    {
+      userData.push_back(node.UserData);
+    }
+    return;
+  }
+
+  switch (frustrum.intersects(Aabb(node.Max, node.Min), planeMask))
+  {
+  case FrustrumIntersection::Outside:
+    return;
+  case FrustrumIntersection::Inside:
+    collectLeaves(nodeId, userData);
+    return;
+  case FrustrumIntersection::Intersecting:
+    query(node.Left, frustrum, planeMask, userData);
+    query(node.Right, frustrum, planeMask, userData);
+    return;
+  }
+}
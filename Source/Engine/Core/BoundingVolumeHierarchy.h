@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+
+#include "../Maths/AABB.hpp"
+#include "../Maths/Vector3.hpp"
+#include "Types.hpp"
+
+class Frustrum;
+class Ray;
+
+/// @brief Dynamic AABB tree used to accelerate frustrum culling and ray picking. Leaves store a fattened copy of
+/// their box so that small movements only refit the leaf instead of reinserting it, and the tree is kept balanced
+/// with AVL style rotations as proxies are inserted and removed.
+class BoundingVolumeHierarchy
+{
+public:
+  static constexpr int32 NullNode = -1;
+
+  /// @brief Constructs an empty tree.
+  /// @param fatMargin Distance each leaf box is grown by on every axis.
+  BoundingVolumeHierarchy(float32 fatMargin = 0.1f);
+
+  /// @brief Inserts a world space box into the tree.
+  /// @return The proxy id used to move or remove the box later.
+  int32 insert(const Aabb &aabb, uint64 userData);
+  void remove(int32 proxyId);
+  /// @brief Updates the box of an existing proxy. The proxy is only reinserted when the box escapes its fat bounds.
+  /// @return True if the proxy was reinserted.
+  bool move(int32 proxyId, const Aabb &aabb);
+  void clear();
+
+  /// @brief Appends the user data of every proxy intersecting the frustrum.
+  void query(const Frustrum &frustrum, std::vector<uint64> &userData) const;
+  /// @brief Finds the proxy nearest to the ray origin which the ray hits.
+  /// @return False if nothing was hit.
+  bool raycast(const Ray &ray, uint64 &userData, float32 &distance) const;
+
+  uint64 getUserData(int32 proxyId) const { return _nodes[proxyId].UserData; }
+  uint32 getProxyCount() const { return _proxyCount; }
+  int32 getHeight() const { return _root == NullNode ? 0 : _nodes[_root].Height; }
+
+private:
+  struct Node
+  {
+    Vector3 Min;
+    Vector3 Max;
+    Vector3 TightMin;
+    Vector3 TightMax;
+    uint64 UserData;
+    int32 Parent;
+    int32 Left;
+    int32 Right;
+    int32 Height;
+
+    bool isLeaf() const { return Left == NullNode; }
+  };
+
+  int32 allocateNode();
+  void freeNode(int32 nodeId);
+  void insertLeaf(int32 leafId);
+  void removeLeaf(int32 leafId);
+  int32 balance(int32 nodeId);
+  void refit(int32 nodeId);
+  void collectLeaves(int32 nodeId, std::vector<uint64> &userData) const;
+  void query(int32 nodeId, const Frustrum &frustrum, uint32 planeMask, std::vector<uint64> &userData) const;
+
+  std::vector<Node> _nodes;
+  int32 _root;
+  int32 _freeList;
+  uint32 _proxyCount;
+  float32 _fatMargin;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <string>
 
 #include "Types.hpp"
@@ -13,7 +14,9 @@ enum class ComponentType
   Camera
 };
 
-class Component
+/// @brief Components are owned by the scene through shared pointers, so anything holding on to one past a frame can
+/// take a weak pointer to it.
+class Component : public std::enable_shared_from_this<Component>
 {
 public:
   void update(float32 dt);
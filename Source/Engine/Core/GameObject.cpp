@@ -5,37 +5,14 @@
 #include "../Rendering/Drawable.h"
 #include "Component.h"
 
-GameObject::GameObject() : _index(0)
+GameObject::GameObject() : _transforms(nullptr), _transformNode(0), _parent(nullptr), _index(0)
 {
 }
 
-GameObject::GameObject(const std::string &name, uint64 index) : _name(name), _index(index), _parent(nullptr)
+GameObject::GameObject(const std::string &name, uint64 index, TransformHierarchy &transforms) : _transforms(&transforms), _transformNode(transforms.add()), _parent(nullptr), _name(name), _index(index)
 {
 }
 
-void GameObject::update(float32 dt)
-{
-	if (_localTransform.modified())
-	{
-		_localTransform.update(dt);
-		if (_parent == nullptr)
-		{
-			_globalTransform = _localTransform;
-		}
-		else
-		{
-			_globalTransform = _parent->getGlobalTransform() * _localTransform;
-		}
-		updateChildNodeTransforms(dt);
-	}
-
-	if (_globalTransform.modified())
-	{
-		_globalTransform.update(dt);
-		notifyComponents();
-	}
-}
-
 void GameObject::drawInspector()
 {
 	ImGui::Separator();
@@ -44,21 +21,22 @@ void GameObject::drawInspector()
 
 	if (ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen))
 	{
-		Vector3 position = _globalTransform.getPosition();
+		Transform globalTransform(getGlobalTransform());
+		Vector3 position = globalTransform.getPosition();
 		float32 pos[]{position.X, position.Y, position.Z};
 		if (ImGui::DragFloat3("Position", pos, 0.1f))
 		{
-			_localTransform.translate(Vector3(position.X - pos[0], position.Y - pos[1], position.Z - pos[2]));
+			transform().translate(Vector3(position.X - pos[0], position.Y - pos[1], position.Z - pos[2]));
 		}
 
-		Vector3 scale = _globalTransform.getScale();
+		Vector3 scale = globalTransform.getScale();
 		float32 scl[]{scale.X, scale.Y, scale.Z};
 		if (ImGui::DragFloat3("Scale", scl, 0.001f))
 		{
-			_localTransform.scale(Vector3(scale.X - scl[0], scale.Y - scl[1], scale.Z - scl[2]));
+			transform().scale(Vector3(scale.X - scl[0], scale.Y - scl[1], scale.Z - scl[2]));
 		}
 
-		auto euler = _globalTransform.getRotation().ToEuler();
+		auto euler = globalTransform.getRotation().ToEuler();
 		float32 angles[3] = {euler[0].InDegrees(), euler[1].InDegrees(), euler[2].InDegrees()};
 		if (ImGui::DragFloat3("Orientation", angles, 1.0f, -180.0f, 180.0f))
 		{
@@ -67,7 +45,7 @@ void GameObject::drawInspector()
 			Quaternion zRot(Vector3(0.0f, 0.0f, 1.0f), (euler[2] - Degree(angles[2])).InRadians());
 			Quaternion totalRot = yRot * xRot * zRot;
 
-			_localTransform.rotate(totalRot);
+			transform().rotate(totalRot);
 		}
 	}
 
@@ -87,17 +65,10 @@ GameObject &GameObject::addChildNode(GameObject &gameObject)
 {
 	gameObject._parent = this;
 	_childNodes.push_back(&gameObject);
+	_transforms->setParent(gameObject._transformNode, _transformNode);
 	return *this;
 }
 
-void GameObject::updateChildNodeTransforms(float32 dt)
-{
-	for (auto childNode : _childNodes)
-	{
-		childNode->_globalTransform = _localTransform * childNode->_localTransform;
-	}
-}
-
 void GameObject::notifyComponents() const
 {
 	for (auto component : _components)
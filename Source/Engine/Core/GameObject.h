@@ -7,16 +7,18 @@
 
 #include "Component.h"
 #include "Transform.h"
+#include "TransformHierarchy.h"
 #include "Types.hpp"
 
 class GameObject
 {
 public:
   GameObject();
-  GameObject(const std::string &name, uint64 index);
+  GameObject(const std::string &name, uint64 index, TransformHierarchy &transforms);
 
-  void update(float32 dt);
   void drawInspector();
+  /// @brief Called by the scene after the object's world matrix has been recomputed.
+  void notifyComponents() const;
 
   GameObject &addComponent(Component &component);
   GameObject &addChildNode(GameObject &gameObject);
@@ -25,24 +27,27 @@ public:
   template <typename T>
   bool hasComponent();
 
-  Transform &transform() { return _localTransform; }
-  const Transform &getLocalTransform() const { return _localTransform; }
-  const Transform &getGlobalTransform() const { return _globalTransform; }
+  /// @brief Handle to the local transform within the scene's transform hierarchy. Calling this marks the transform
+  /// dirty, so the reference should not be held across frames.
+  Transform &transform() { return _transforms->getLocalTransform(_transformNode); }
+  const Transform &getLocalTransform() const { return _transforms->getLocalTransform(_transformNode); }
+  const Matrix4 &getWorldMatrix() const { return _transforms->getWorldMatrix(_transformNode); }
+  /// @brief Decomposes the world matrix, prefer getWorldMatrix outside of tooling.
+  Transform getGlobalTransform() const { return Transform(getWorldMatrix()); }
+  uint32 getTransformNode() const { return _transformNode; }
 
   std::string getName() const { return _name; }
 
   uint64 getIndex() const { return _index; }
 
 protected:
-  Transform _localTransform, _globalTransform;
+  TransformHierarchy *_transforms;
+  uint32 _transformNode;
   GameObject *_parent;
   std::string _name;
   uint64 _index;
 
 private:
-  void updateChildNodeTransforms(float32 dt);
-  void notifyComponents() const;
-
   std::list<Component *> _components;
   std::list<GameObject *> _childNodes;
 };
@@ -0,0 +1,211 @@
+#include "JobSystem.h"
+
+namespace
+{
+  // Identifies the pool and queue of the current thread so that jobs scheduled from inside a job land on the
+  // scheduling worker's own queue.
+  thread_local JobSystem *CurrentJobSystem = nullptr;
+  thread_local uint32 CurrentWorkerIndex = 0;
+}
+
+JobSystem::JobSystem(uint32 workerCount) : _running(true),
+                                           _queuedJobs(0)
+{
+  for (uint32 i = 0; i < workerCount + 1; i++)
+  {
+    _queues.emplace_back(new WorkQueue());
+  }
+
+  for (uint32 i = 0; i < workerCount; i++)
+  {
+    _workers.emplace_back(&JobSystem::workerLoop, this, i);
+  }
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(_sleepMutex);
+    _running = false;
+  }
+  _sleepCondition.notify_all();
+
+  for (auto &worker : _workers)
+  {
+    worker.join();
+  }
+}
+
+uint32 JobSystem::defaultWorkerCount()
+{
+  uint32 hardwareThreads = std::thread::hardware_concurrency();
+  return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+JobHandle JobSystem::schedule(std::function<void()> function, const std::vector<JobHandle> &dependencies)
+{
+  JobHandle job(new Job());
+  job->_function = std::move(function);
+
+  for (const auto &dependency : dependencies)
+  {
+    std::lock_guard<std::mutex> lock(dependency->_mutex);
+    if (!dependency->_finished.load(std::memory_order_relaxed))
+    {
+      job->_pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+      dependency->_dependents.push_back(job);
+    }
+  }
+
+  // Releases the reference taken at construction, which stops the job being queued while dependencies are added.
+  if (job->_pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    enqueue(job);
+  }
+  return job;
+}
+
+void JobSystem::wait(const JobHandle &job)
+{
+  while (!job->isFinished())
+  {
+    if (!runPendingJob())
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void JobSystem::wait(const std::vector<JobHandle> &jobs)
+{
+  for (const auto &job : jobs)
+  {
+    wait(job);
+  }
+}
+
+void JobSystem::parallelFor(uint32 count, uint32 grainSize, const std::function<void(uint32 begin, uint32 end)> &function)
+{
+  grainSize = std::max(grainSize, 1u);
+  if (count <= grainSize || _workers.empty())
+  {
+    if (count > 0)
+    {
+      function(0, count);
+    }
+    return;
+  }
+
+  std::vector<JobHandle> jobs;
+  jobs.reserve(count / grainSize + 1);
+  for (uint32 begin = grainSize; begin < count; begin += grainSize)
+  {
+    uint32 end = std::min(begin + grainSize, count);
+    jobs.push_back(schedule([&function, begin, end]()
+                            { function(begin, end); }));
+  }
+
+  function(0, grainSize);
+  wait(jobs);
+}
+
+void JobSystem::enqueue(const JobHandle &job)
+{
+  uint32 queueIndex = CurrentJobSystem == this ? CurrentWorkerIndex : static_cast<uint32>(_queues.size() - 1);
+  {
+    std::lock_guard<std::mutex> lock(_queues[queueIndex]->Mutex);
+    _queues[queueIndex]->Jobs.push_back(job);
+  }
+
+  _queuedJobs.fetch_add(1, std::memory_order_release);
+  {
+    // Taking the lock orders this notify after a worker's check of _queuedJobs, so the wake up cannot be lost.
+    std::lock_guard<std::mutex> lock(_sleepMutex);
+  }
+  _sleepCondition.notify_one();
+}
+
+bool JobSystem::runPendingJob()
+{
+  if (_queuedJobs.load(std::memory_order_acquire) <= 0)
+  {
+    return false;
+  }
+
+  uint32 queueCount = static_cast<uint32>(_queues.size());
+  uint32 ownIndex = CurrentJobSystem == this ? CurrentWorkerIndex : queueCount - 1;
+
+  JobHandle job;
+  {
+    WorkQueue &queue = *_queues[ownIndex];
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+    if (!queue.Jobs.empty())
+    {
+      job = std::move(queue.Jobs.back());
+      queue.Jobs.pop_back();
+    }
+  }
+
+  for (uint32 i = 1; job == nullptr && i < queueCount; i++)
+  {
+    WorkQueue &queue = *_queues[(ownIndex + i) % queueCount];
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+    if (!queue.Jobs.empty())
+    {
+      job = std::move(queue.Jobs.front());
+      queue.Jobs.pop_front();
+    }
+  }
+
+  if (job == nullptr)
+  {
+    return false;
+  }
+
+  _queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+  execute(job);
+  return true;
+}
+
+void JobSystem::execute(const JobHandle &job)
+{
+  job->_function();
+  job->_function = nullptr;
+
+  std::vector<JobHandle> dependents;
+  {
+    std::lock_guard<std::mutex> lock(job->_mutex);
+    job->_finished.store(true, std::memory_order_release);
+    dependents.swap(job->_dependents);
+  }
+
+  for (const auto &dependent : dependents)
+  {
+    if (dependent->_pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      enqueue(dependent);
+    }
+  }
+}
+
+void JobSystem::workerLoop(uint32 workerIndex)
+{
+  CurrentJobSystem = this;
+  CurrentWorkerIndex = workerIndex;
+
+  while (true)
+  {
+    if (runPendingJob())
+    {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(_sleepMutex);
+    _sleepCondition.wait(lock, [this]()
+                         { return !_running || _queuedJobs.load(std::memory_order_acquire) > 0; });
+    if (!_running)
+    {
+      return;
+    }
+  }
+}
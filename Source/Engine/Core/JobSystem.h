@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Types.hpp"
+
+/// @brief A single unit of work. Jobs only become runnable once every job they depend on has finished.
+class Job
+{
+public:
+  bool isFinished() const { return _finished.load(std::memory_order_acquire); }
+
+private:
+  friend class JobSystem;
+
+  std::function<void()> _function;
+  std::atomic<int32> _pendingDependencies{1};
+  std::atomic<bool> _finished{false};
+  std::mutex _mutex;
+  std::vector<std::shared_ptr<Job>> _dependents;
+};
+
+typedef std::shared_ptr<Job> JobHandle;
+
+/// @brief Work stealing thread pool. Each worker owns a queue which it pops from the back of, while idle workers
+/// steal from the front of the others. Threads that wait on a job run other queued jobs in the meantime, so waiting
+/// from inside a job cannot deadlock the pool.
+class JobSystem
+{
+public:
+  /// @brief Starts the worker threads.
+  /// @param workerCount Threads to start in addition to the calling thread. Zero runs every job on whichever thread
+  /// waits on it.
+  JobSystem(uint32 workerCount = defaultWorkerCount());
+  ~JobSystem();
+
+  static uint32 defaultWorkerCount();
+
+  JobHandle schedule(std::function<void()> function, const std::vector<JobHandle> &dependencies = {});
+  void wait(const JobHandle &job);
+  void wait(const std::vector<JobHandle> &jobs);
+
+  /// @brief Splits [0, count) into ranges of at most grainSize and runs them across the pool, returning once every
+  /// range has completed. The calling thread runs the first range itself.
+  void parallelFor(uint32 count, uint32 grainSize, const std::function<void(uint32 begin, uint32 end)> &function);
+
+  /// @brief Sorts chunks of the range in parallel and then merges neighbouring chunks in parallel rounds.
+  template <typename T, typename Compare>
+  void parallelSort(std::vector<T> &values, uint32 grainSize, Compare compare);
+
+  uint32 getWorkerCount() const { return static_cast<uint32>(_workers.size()); }
+
+private:
+  struct WorkQueue
+  {
+    std::mutex Mutex;
+    std::deque<JobHandle> Jobs;
+  };
+
+  void enqueue(const JobHandle &job);
+  bool runPendingJob();
+  void execute(const JobHandle &job);
+  void workerLoop(uint32 workerIndex);
+
+  std::vector<std::thread> _workers;
+  // One queue per worker plus a shared queue, at the back, for threads outside the pool.
+  std::vector<std::unique_ptr<WorkQueue>> _queues;
+  std::atomic<bool> _running;
+  std::atomic<int32> _queuedJobs;
+  std::mutex _sleepMutex;
+  std::condition_variable _sleepCondition;
+};
+
+template <typename T, typename Compare>
+void JobSystem::parallelSort(std::vector<T> &values, uint32 grainSize, Compare compare)
+{
+  uint32 count = static_cast<uint32>(values.size());
+  if (count <= grainSize || _workers.empty())
+  {
+    std::sort(values.begin(), values.end(), compare);
+    return;
+  }
+
+  parallelFor(count, grainSize, [&](uint32 begin, uint32 end)
+              { std::sort(values.begin() + begin, values.begin() + end, compare); });
+
+  for (uint64 width = grainSize; width < count; width *= 2)
+  {
+    uint32 mergeCount = static_cast<uint32>((count + 2 * width - 1) / (2 * width));
+    parallelFor(mergeCount, 1, [&](uint32 begin, uint32 end)
+                {
+                  for (uint32 i = begin; i < end; i++)
+                  {
+                    uint64 first = i * 2 * width;
+                    uint64 middle = std::min<uint64>(first + width, count);
+                    uint64 last = std::min<uint64>(first + 2 * width, count);
+                    std::inplace_merge(values.begin() + first, values.begin() + middle, values.begin() + last, compare);
+                  }
+                });
+  }
+}
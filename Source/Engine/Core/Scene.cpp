@@ -9,6 +9,8 @@
 #include <vector>
 
 #include "../UI/ImGui/imgui.h"
+#include "../Utility/DerivedDataCache.hpp"
+#include "../Utility/HotReload.hpp"
 #include "../Utility/ModelLoader.hpp"
 #include "../Rendering/Camera.h"
 #include "../Rendering/Renderer.h"
@@ -18,9 +20,13 @@
 #include "../RenderApi/RenderDevice.hpp"
 #include "GameObject.h"
 #include "InputHandler.h"
+#include "JobSystem.h"
 #include "SceneGraph.h"
 
 static int64 SELECTED_GAME_OBJECT_INDEX = -1;
+static const uint32 SCENE_PREP_GRAIN_SIZE = 1024;
+static const uint64 DEFAULT_UPLOAD_BYTE_BUDGET = 16 * 1024 * 1024;
+static const float32 DEFAULT_UPLOAD_TIME_BUDGET_MS = 2.0f;
 
 /// @brief Builds a projected ray in world space from the a set of mouse coordinates in screen space.
 /// @param mouseCoords The current mouse coordinates in screen space.
@@ -46,7 +52,16 @@ Ray buildRayFromMouseCoords(const Vector2I &mouseCoords, const Vector2I &windowD
 }
 
 Scene::Scene(const std::shared_ptr<InputHandler> &inputHandler) : _objectAddedToScene(false),
+                                                                  _nextGameObjectIndex(0),
                                                                   _scenePrepDuration(0),
+                                                                  _bvhCulling(false),
+                                                                  _occlusionTestIndex(0),
+                                                                  _occlusionTestedCount(0),
+                                                                  _occlusionCulledCount(0),
+                                                                  _jobSystem(new JobSystem()),
+                                                                  _uploadByteBudget(DEFAULT_UPLOAD_BYTE_BUDGET),
+                                                                  _uploadTimeBudgetMs(DEFAULT_UPLOAD_TIME_BUDGET_MS),
+                                                                  _loadingJobSystem(new JobSystem(std::max<uint32>(1, JobSystem::defaultWorkerCount() / 2))),
                                                                   _inputHandler(inputHandler)
 {
 }
@@ -66,12 +81,17 @@ bool Scene::init(const Vector2I &windowDims, std::shared_ptr<RenderDevice> rende
 
 GameObject &Scene::createGameObject(const std::string &name)
 {
-  static uint64 index = 0;
+  // Indices are per scene so that the root of every scene is always at index zero.
+  uint64 index = _nextGameObjectIndex;
 
   _sceneGraph->addNode(index);
-  _gameObjects.insert(std::pair<uint64, std::shared_ptr<GameObject>>(index, new GameObject(name, index)));
+  auto gameObject = std::make_shared<GameObject>(name, index, _transforms);
+  _gameObjects.insert(std::pair<uint64, std::shared_ptr<GameObject>>(index, gameObject));
+  _transformOwners.resize(_transforms.size());
+  _transformOwners[gameObject->getTransformNode()] = gameObject.get();
   _objectAddedToScene = true;
-  return *_gameObjects[index++].get();
+  _nextGameObjectIndex++;
+  return *_gameObjects[index].get();
 }
 
 void Scene::addChildToNode(GameObject &parent, GameObject &child)
@@ -80,18 +100,60 @@ void Scene::addChildToNode(GameObject &parent, GameObject &child)
   parent.addChildNode(child);
 }
 
+void Scene::setWorkerCount(uint32 workerCount)
+{
+  _jobSystem.reset(new JobSystem(workerCount));
+}
+
+void Scene::setUploadBudget(uint64 bytesPerFrame, float32 millisecondsPerFrame)
+{
+  _uploadByteBudget = bytesPerFrame;
+  _uploadTimeBudgetMs = millisecondsPerFrame;
+}
+
+uint64 Scene::getComponentCount(ComponentType type) const
+{
+  auto iter = _components.find(type);
+  return iter == _components.end() ? 0 : iter->second.size();
+}
+
 void Scene::update(float32 dt)
 {
-  for (const auto &gameObject : _gameObjects)
+  if (_renderDevice != nullptr)
   {
-    gameObject.second->update(dt);
+    _uploadQueue.process(_uploadByteBudget, _uploadTimeBudgetMs);
   }
 
-  for (const auto &componentType : _components)
+  // A single sweep over the flat hierarchy, after which only objects whose world matrix changed notify components.
+  _transforms.update();
+  const auto &updatedNodes = _transforms.getUpdatedNodes();
+  _jobSystem->parallelFor(updatedNodes.size(), SCENE_PREP_GRAIN_SIZE, [&](uint32 begin, uint32 end)
+                          {
+                            for (uint32 i = begin; i < end; i++)
+                            {
+                              _transformOwners[updatedNodes[i]]->notifyComponents();
+                            }
+                          });
+
+  // Components only touch their own state when updating, so every component of a type can update at once.
+  for (auto &componentType : _components)
   {
-    for (auto &component : _components[componentType.first])
+    auto &components = componentType.second;
+    _jobSystem->parallelFor(components.size(), SCENE_PREP_GRAIN_SIZE, [&](uint32 begin, uint32 end)
+                            {
+                              for (uint32 i = begin; i < end; i++)
+                              {
+                                components[i]->update(dt);
+                              }
+                            });
+  }
+
+  // The BVH is not thread safe, so drawables only flag that their bounds changed and the refit happens here.
+  for (const auto &entry : _bvhEntries)
+  {
+    if (entry.DrawablePtr->clearBvhDirty())
     {
-      component->update(dt);
+      _bvh.move(entry.DrawablePtr->getBvhProxy(), entry.DrawablePtr->getWorldAabb());
     }
   }
 }
@@ -117,36 +179,70 @@ void Scene::drawFrame()
     return;
   }
 
+  if (_objectAddedToScene)
+  {
+    syncBoundingVolumeHierarchy();
+  }
+
   std::shared_ptr<Camera> camera(std::static_pointer_cast<Camera>(cameraFindIter->second[0]));
   performObjectPicker(*camera.get());
 
-  std::vector<std::shared_ptr<Drawable>>
-      aabbDrawables, allDrawables, opaqueDrawables, transparentDrawables, mousePickedDrawables;
-  for (auto component : drawableFindIter->second)
+  // Both paths produce entries in creation order, which transparent drawables rely on as they are not depth sorted.
+  const Frustrum &frustrum = camera->getCullingFrustrum();
+  _visibleEntries.clear();
+  if (_bvhCulling)
   {
-    auto drawable = std::dynamic_pointer_cast<Drawable>(component);
-    if (camera->contains(drawable->getAabb(), Transform(drawable->getMatrix())))
+    _bvhQueryResults.clear();
+    _bvh.query(frustrum, _bvhQueryResults);
+    std::sort(_bvhQueryResults.begin(), _bvhQueryResults.end());
+    _visibleEntries.assign(_bvhQueryResults.begin(), _bvhQueryResults.end());
+  }
+  else
+  {
+    uint32 entryCount = _cullingBounds.size();
+    uint32 chunkCount = (entryCount + SCENE_PREP_GRAIN_SIZE - 1) / SCENE_PREP_GRAIN_SIZE;
+    if (_chunkVisibleEntries.size() < chunkCount)
     {
-      if (drawable->getMaterial()->hasOpacityTexture())
-      {
-        transparentDrawables.push_back(drawable);
-      }
-      else
-      {
-        opaqueDrawables.push_back(drawable);
-      }
+      _chunkVisibleEntries.resize(chunkCount);
     }
-
-    if (drawable->shouldDrawAabb())
+    _jobSystem->parallelFor(chunkCount, 1, [&](uint32 begin, uint32 end)
+                            {
+                              for (uint32 chunk = begin; chunk < end; chunk++)
+                              {
+                                _chunkVisibleEntries[chunk].clear();
+                                frustrum.cull(_cullingBounds, chunk * SCENE_PREP_GRAIN_SIZE, std::min((chunk + 1) * SCENE_PREP_GRAIN_SIZE, entryCount), _chunkVisibleEntries[chunk]);
+                              }
+                            });
+    for (uint32 chunk = 0; chunk < chunkCount; chunk++)
     {
-      aabbDrawables.push_back(drawable);
+      _visibleEntries.insert(_visibleEntries.end(), _chunkVisibleEntries[chunk].begin(), _chunkVisibleEntries[chunk].end());
     }
+  }
+  cullOccludedEntries(*camera.get());
 
-    allDrawables.push_back(drawable);
+  // Opaque drawables are left unsorted, the renderer orders them by state and then depth as it batches them.
+  std::vector<std::shared_ptr<Drawable>> aabbDrawables, opaqueDrawables, transparentDrawables;
+  opaqueDrawables.reserve(_visibleEntries.size());
+  for (uint32 entryIndex : _visibleEntries)
+  {
+    const auto &drawable = _bvhEntries[entryIndex].DrawablePtr;
+    if (drawable->getMaterial()->hasOpacityTexture())
+    {
+      transparentDrawables.push_back(drawable);
+    }
+    else
+    {
+      opaqueDrawables.push_back(drawable);
+    }
   }
 
-  std::sort(opaqueDrawables.begin(), opaqueDrawables.end(), [&](const std::shared_ptr<Drawable> &a, const std::shared_ptr<Drawable> &b) -> bool
-            { return camera->distanceFrom(a->getPosition()) < camera->distanceFrom(b->getPosition()); });
+  for (const auto &entry : _bvhEntries)
+  {
+    if (entry.DrawablePtr->shouldDrawAabb())
+    {
+      aabbDrawables.push_back(entry.DrawablePtr);
+    }
+  }
 
   std::vector<std::shared_ptr<Light>> lights;
   for (auto component : _components.find(ComponentType::Light)->second)
@@ -157,13 +253,15 @@ void Scene::drawFrame()
 
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _scenePrepDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  _scenePrepHistory.push(_scenePrepDuration * 1e-6f);
   _renderer->drawFrame(_renderDevice,
                        aabbDrawables,
                        opaqueDrawables,
                        transparentDrawables,
-                       allDrawables,
+                       _allDrawables,
                        lights,
-                       camera);
+                       camera,
+                       _jobSystem.get());
 }
 
 void Scene::drawDebugUi()
@@ -179,50 +277,231 @@ void Scene::drawDebugUi()
   {
     if (ImGui::CollapsingHeader("Frame Profiler"))
     {
-      float32 scenePrepDuration = static_cast<float32>(_scenePrepDuration) * 1e-6f;
-      ImGui::Text("Scene Prep: (%.3f ms)", scenePrepDuration);
-      float32 totalDuration = scenePrepDuration;
-      for (auto &timings : _renderer->getRenderPassTimings())
+      const TimingHistory &cpuFrameHistory = _renderer->getCpuFrameHistory();
+      const TimingHistory &gpuFrameHistory = _renderer->getGpuFrameHistory();
+      ImGui::PlotLines("CPU (ms)", cpuFrameHistory.getSamples(), cpuFrameHistory.getCount(), cpuFrameHistory.getOffset(),
+                       nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+      ImGui::PlotLines("GPU (ms)", gpuFrameHistory.getSamples(), gpuFrameHistory.getCount(), gpuFrameHistory.getOffset(),
+                       nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+
+      if (ImGui::BeginTable("RenderPassTimings", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+      {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("CPU (ms)");
+        ImGui::TableSetupColumn("GPU (ms)");
+        ImGui::TableSetupColumn("GPU min/avg/max");
+        ImGui::TableHeadersRow();
+
+        float32 scenePrepDuration = static_cast<float32>(_scenePrepDuration) * 1e-6f;
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("Scene Prep");
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", scenePrepDuration);
+        ImGui::TableNextColumn();
+        ImGui::Text("-");
+        ImGui::TableNextColumn();
+        ImGui::Text("-");
+
+        float32 totalCpuDuration = scenePrepDuration;
+        for (auto &timings : _renderer->getRenderPassTimings())
+        {
+          float32 cpuDuration = static_cast<float32>(timings.Duration) * 1e-6f;
+          totalCpuDuration += cpuDuration;
+
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::Text("%s", timings.Name.c_str());
+          ImGui::TableNextColumn();
+          ImGui::Text("%.3f", cpuDuration);
+          ImGui::TableNextColumn();
+          if (timings.GpuHistory.getCount() > 0)
+          {
+            ImGui::Text("%.3f", static_cast<float32>(timings.GpuDuration) * 1e-6f);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f / %.3f / %.3f", timings.GpuHistory.getMin(), timings.GpuHistory.getAverage(), timings.GpuHistory.getMax());
+          }
+          else
+          {
+            ImGui::Text("n/a");
+            ImGui::TableNextColumn();
+            ImGui::Text("n/a");
+          }
+        }
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("All");
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", totalCpuDuration);
+        ImGui::TableNextColumn();
+        if (_renderer->hasGpuTimings())
+        {
+          ImGui::Text("%.3f", gpuFrameHistory.getLatest());
+          ImGui::TableNextColumn();
+          ImGui::Text("%.3f / %.3f / %.3f", gpuFrameHistory.getMin(), gpuFrameHistory.getAverage(), gpuFrameHistory.getMax());
+        }
+        else
+        {
+          ImGui::Text("n/a");
+          ImGui::TableNextColumn();
+          ImGui::Text("n/a");
+        }
+        ImGui::EndTable();
+      }
+      ImGui::Checkbox("BVH Culling", &_bvhCulling);
+
+      bool stateSorting = _renderer->isStateSortingEnabled();
+      if (ImGui::Checkbox("Sort Draws By State", &stateSorting))
       {
-        float32 duration = static_cast<float32>(timings.Duration) * 1e-6f;
-        ImGui::Text("%s: (%.3f ms)", timings.Name.c_str(), duration);
-        totalDuration += duration;
+        _renderer->setStateSortingEnabled(stateSorting);
+      }
+      const RenderStateStats &stateStats = _renderer->getStateStats();
+      ImGui::Text("Draws: %u  Material changes: %u  Mesh changes: %u", stateStats.DrawCalls, stateStats.MaterialChanges, stateStats.MeshChanges);
+      ImGui::Text("Occlusion tested: %u  Culled: %u  Visible: %u", _occlusionTestedCount, _occlusionCulledCount,
+                  _occlusionTestedCount - _occlusionCulledCount);
+      ImGui::Text("Texture binds: %u  Sampler binds: %u  Skipped: %u", stateStats.TextureBinds, stateStats.SamplerBinds, stateStats.RedundantBindsSkipped);
+      ImGui::Text("LOD triangles: %u / %u / %u / %u", stateStats.LodTriangles[0], stateStats.LodTriangles[1], stateStats.LodTriangles[2],
+                  stateStats.LodTriangles[3]);
+      ImGui::Text("Shadow LOD triangles: %u / %u / %u / %u", stateStats.ShadowLodTriangles[0], stateStats.ShadowLodTriangles[1],
+                  stateStats.ShadowLodTriangles[2], stateStats.ShadowLodTriangles[3]);
+      ImGui::Text("Scene Prep min/avg/max: %.3f / %.3f / %.3f ms", _scenePrepHistory.getMin(), _scenePrepHistory.getAverage(), _scenePrepHistory.getMax());
+      ImGui::Text("Pending uploads: %u (%.2f MB)", _uploadQueue.getPendingCount(), _uploadQueue.getPendingBytes() / (1024.0f * 1024.0f));
+      DerivedDataCacheStats cacheStats = DerivedDataCache::get().getStats();
+      ImGui::Text("Asset cache hits: %llu  Misses: %llu  Evictions: %llu", static_cast<unsigned long long>(cacheStats.Hits),
+                  static_cast<unsigned long long>(cacheStats.Misses), static_cast<unsigned long long>(cacheStats.Evictions));
+      ImGui::Text("Asset cache saved: %.2f MB  Written: %.2f MB", cacheStats.BytesSaved / (1024.0f * 1024.0f), cacheStats.BytesWritten / (1024.0f * 1024.0f));
+    }
+
+    if (ImGui::CollapsingHeader("Hot Reload"))
+    {
+      HotReload &hotReload = HotReload::get();
+      bool enabled = hotReload.isEnabled();
+      if (ImGui::Checkbox("Watch Asset Files", &enabled))
+      {
+        hotReload.setEnabled(enabled);
+      }
+      ImGui::Text("Tracked assets: %llu  Reloads: %llu", static_cast<unsigned long long>(hotReload.getTrackedCount()),
+                  static_cast<unsigned long long>(hotReload.getReloadCount()));
+      std::vector<std::string> errors = hotReload.getErrors();
+      for (const auto &error : errors)
+      {
+        ImGui::TextWrapped("%s", error.c_str());
+      }
+      if (!errors.empty() && ImGui::Button("Clear Errors"))
+      {
+        hotReload.clearErrors();
       }
-      ImGui::Text("All: (%.3f ms)", totalDuration);
     }
   }
 }
 
-void Scene::performObjectPicker(const Camera &camera)
+/// @brief Inserts drawables created since the last frame into the BVH and culling bounds, and maps every entry back
+/// to the game object which owns it so that picking can select it.
+void Scene::syncBoundingVolumeHierarchy()
 {
-  Ray ray = buildRayFromMouseCoords(_mouseCoordinates, _windowDims, camera);
-
-  std::vector<std::shared_ptr<GameObject>> rayCastedObjects;
+  std::unordered_map<const Drawable *, int64> owners;
   for (const auto &gameObject : _gameObjects)
   {
     if (gameObject.second->hasComponent<Drawable>())
     {
-      Drawable &drawable = gameObject.second->getComponent<Drawable>();
+      owners[&gameObject.second->getComponent<Drawable>()] = static_cast<int64>(gameObject.first);
+    }
+  }
 
-      Vector3 extents(drawable.getAabb().getExtents());
-      if (ray.Intersects(Aabb(drawable.getPosition(), extents.X, extents.Y, extents.Z)) &&
-          _inputHandler->isButtonPressed(Button::Button_LMouse))
+  auto drawableFindIter = _components.find(ComponentType::Drawable);
+  if (drawableFindIter != _components.end())
+  {
+    for (const auto &component : drawableFindIter->second)
+    {
+      auto drawable = std::static_pointer_cast<Drawable>(component);
+      if (drawable->getBvhProxy() == BoundingVolumeHierarchy::NullNode)
       {
-        rayCastedObjects.push_back(gameObject.second);
+        Aabb worldAabb(drawable->getWorldAabb());
+        int32 proxyId = _bvh.insert(worldAabb, _bvhEntries.size());
+        drawable->setBvhProxy(proxyId);
+        drawable->setCullingBounds(&_cullingBounds, _cullingBounds.add(worldAabb));
+        _bvhEntries.push_back({drawable, -1});
+        _allDrawables.push_back(drawable);
       }
     }
   }
 
-  if (rayCastedObjects.empty())
+  for (auto &entry : _bvhEntries)
+  {
+    auto iter = owners.find(entry.DrawablePtr.get());
+    entry.GameObjectIndex = iter == owners.end() ? -1 : iter->second;
+  }
+  _objectAddedToScene = false;
+}
+
+void Scene::cullOccludedEntries(const Camera &camera)
+{
+  _occlusionTestedCount = 0;
+  _occlusionCulledCount = 0;
+  const HiZBuffer *occlusionDepth = _renderer->updateOcclusionDepth();
+  if (occlusionDepth == nullptr || _visibleEntries.empty())
   {
     return;
   }
 
-  std::sort(rayCastedObjects.begin(), rayCastedObjects.end(), [&](const std::shared_ptr<GameObject> &a, const std::shared_ptr<GameObject> &b) -> bool
-            { return camera.distanceFrom(a->getGlobalTransform().getPosition()) < camera.distanceFrom(b->getGlobalTransform().getPosition()); });
+  // The depth is a few frames old by the time it comes back, so it is first moved into this frame's view.
+  _occlusionDepth.reproject(*occlusionDepth, camera.getProj() * camera.getView());
+  if (_entryOccludedTests.size() < _bvhEntries.size())
+  {
+    _entryOccludedTests.resize(_bvhEntries.size(), 0);
+  }
+
+  // An entry is only skipped once it has been found hidden by two tests running, so a single test thrown off by the
+  // reprojection, as on a sharp turn, cannot hide it. Skipped entries are tested again every frame, and are drawn as
+  // soon as the depth they are tested against shows them.
+  uint64 testIndex = ++_occlusionTestIndex;
+  _visibleEntryHidden.resize(_visibleEntries.size());
+  _jobSystem->parallelFor(_visibleEntries.size(), SCENE_PREP_GRAIN_SIZE, [&](uint32 begin, uint32 end)
+                          {
+                            for (uint32 i = begin; i < end; i++)
+                            {
+                              uint32 entryIndex = _visibleEntries[i];
+                              bool occluded = _occlusionDepth.isOccluded(_cullingBounds, entryIndex);
+                              _visibleEntryHidden[i] = occluded && _entryOccludedTests[entryIndex] == testIndex - 1;
+                              if (occluded)
+                              {
+                                _entryOccludedTests[entryIndex] = testIndex;
+                              }
+                            }
+                          });
+
+  _occlusionTestedCount = static_cast<uint32>(_visibleEntries.size());
+  uint32 keptCount = 0;
+  for (uint32 i = 0; i < _visibleEntries.size(); i++)
+  {
+    if (!_visibleEntryHidden[i])
+    {
+      _visibleEntries[keptCount++] = _visibleEntries[i];
+    }
+  }
+  _visibleEntries.resize(keptCount);
+  _occlusionCulledCount = _occlusionTestedCount - keptCount;
+}
+
+void Scene::performObjectPicker(const Camera &camera)
+{
+  if (!_inputHandler->isButtonPressed(Button::Button_LMouse))
+  {
+    return;
+  }
+
+  Ray ray = buildRayFromMouseCoords(_mouseCoordinates, _windowDims, camera);
+
+  uint64 entryIndex = 0;
+  float32 distance = 0.0f;
+  if (!_bvh.raycast(ray, entryIndex, distance) || _bvhEntries[entryIndex].GameObjectIndex == -1)
+  {
+    return;
+  }
 
   setAabbDrawOnGameObject(SELECTED_GAME_OBJECT_INDEX, false);
-  SELECTED_GAME_OBJECT_INDEX = rayCastedObjects.front()->getIndex();
+  SELECTED_GAME_OBJECT_INDEX = _bvhEntries[entryIndex].GameObjectIndex;
   setAabbDrawOnGameObject(SELECTED_GAME_OBJECT_INDEX, true);
 }
 
@@ -6,14 +6,21 @@
 #include <unordered_map>
 #include <vector>
 
+#include "BoundingVolumeHierarchy.h"
 #include "Component.h"
 #include "Maths.h"
+#include "TransformHierarchy.h"
 #include "Types.hpp"
+#include "UploadQueue.h"
+#include "../Maths/AabbArray.hpp"
+#include "../Rendering/HiZBuffer.h"
+#include "../Utility/TimingHistory.hpp"
 
 class Camera;
 class Drawable;
 class GameObject;
 class InputHandler;
+class JobSystem;
 class Renderer;
 class RenderDevice;
 class SceneGraph;
@@ -42,35 +49,79 @@ public:
 
   GameObject &getRoot() { return *_gameObjects[0].get(); }
 
+  uint64 getComponentCount(ComponentType type) const;
+  uint64 getScenePrepDuration() const { return _scenePrepDuration; }
+  /// @brief Drawables inside the view tested against the last frame's depth, and those of them skipped, this frame.
+  uint32 getOcclusionTestedCount() const { return _occlusionTestedCount; }
+  uint32 getOcclusionCulledCount() const { return _occlusionCulledCount; }
+  const std::shared_ptr<Renderer> &getRenderer() const { return _renderer; }
+
+  /// @brief Replaces the job system used for scene prep. Zero workers runs everything on the calling thread.
+  void setWorkerCount(uint32 workerCount);
+  JobSystem &getJobSystem() { return *_jobSystem; }
+  /// @brief Pool for long running work such as model imports, kept apart from scene prep so that a frame never waits
+  /// behind a file being decoded.
+  JobSystem &getLoadingJobSystem() { return *_loadingJobSystem; }
+
+  /// @brief GPU uploads queued by loading jobs, a budgeted amount of which is processed at the start of each update.
+  UploadQueue &getUploadQueue() { return _uploadQueue; }
+  void setUploadBudget(uint64 bytesPerFrame, float32 millisecondsPerFrame);
+
   // TODO Remove this and better abstract dependenciexc
   std::shared_ptr<RenderDevice> getRenderDevice() { return _renderDevice; }
 
 private:
+  void syncBoundingVolumeHierarchy();
+  void cullOccludedEntries(const Camera &camera);
   void performObjectPicker(const Camera &camera);
   void drawSceneGraphUi(int64 nodeIndex);
   void drawGameObjectInspector(int64 selectedGameObjectIndex);
   void setAabbDrawOnGameObject(int64 gameObjectIndex, bool enableAabbDraw);
 
-  struct DrawableSortMap
+  struct BvhEntry
   {
-    float32 DistanceToCamera;
-    std::shared_ptr<Drawable> ComponentPtr;
-
-    DrawableSortMap(float32 distance, std::shared_ptr<Drawable> component) : DistanceToCamera(distance),
-                                                                             ComponentPtr(component)
-    {
-    }
+    std::shared_ptr<Drawable> DrawablePtr;
+    int64 GameObjectIndex;
   };
 
   bool _objectAddedToScene;
+  uint64 _nextGameObjectIndex;
   uint64 _scenePrepDuration;
+  TimingHistory _scenePrepHistory;
   Vector2I _mouseCoordinates;
   Vector2I _windowDims;
 
   std::unique_ptr<SceneGraph> _sceneGraph;
   std::unordered_map<ComponentType, std::vector<std::shared_ptr<Component>>> _components;
   std::map<uint64, std::shared_ptr<GameObject>> _gameObjects;
-
+  TransformHierarchy _transforms;
+  // Indexed by transform node.
+  std::vector<GameObject *> _transformOwners;
+
+  BoundingVolumeHierarchy _bvh;
+  std::vector<BvhEntry> _bvhEntries;
+  AabbArray _cullingBounds;
+  std::vector<uint32> _visibleEntries;
+  std::vector<uint64> _bvhQueryResults;
+  std::vector<std::vector<uint32>> _chunkVisibleEntries;
+  std::vector<std::shared_ptr<Drawable>> _allDrawables;
+  bool _bvhCulling;
+
+  /// @brief Depth read back from the GPU, moved into this frame's view.
+  HiZBuffer _occlusionDepth;
+  /// @brief The last occlusion test each entry was found hidden in, zero if never.
+  std::vector<uint64> _entryOccludedTests;
+  std::vector<uint8> _visibleEntryHidden;
+  uint64 _occlusionTestIndex;
+  uint32 _occlusionTestedCount;
+  uint32 _occlusionCulledCount;
+
+  std::unique_ptr<JobSystem> _jobSystem;
+  // Declared ahead of the loading jobs so that it outlives any job still pushing to it while they shut down.
+  UploadQueue _uploadQueue;
+  uint64 _uploadByteBudget;
+  float32 _uploadTimeBudgetMs;
+  std::unique_ptr<JobSystem> _loadingJobSystem;
   std::shared_ptr<Renderer> _renderer;
   std::shared_ptr<RenderDevice> _renderDevice;
   std::shared_ptr<InputHandler> _inputHandler;
@@ -83,6 +134,7 @@ T &Scene::createComponent()
 
   auto component = std::shared_ptr<T>(new T());
   _components[component->getType()].push_back(component);
+  _objectAddedToScene = true;
 
   auto componentOfT = std::static_pointer_cast<T>(_components[component->getType()].back());
   return *(componentOfT.get());
@@ -95,6 +147,7 @@ T &Scene::createComponent(Args... args)
 
   auto component = std::shared_ptr<T>(new T(args...));
   _components[component->getType()].push_back(component);
+  _objectAddedToScene = true;
 
   auto componentOfT = std::static_pointer_cast<T>(_components[component->getType()].back());
   return *(componentOfT.get());
@@ -0,0 +1,151 @@
+#include "TransformHierarchy.h"
+
+TransformHierarchy::TransformHierarchy() : _anyDirty(false),
+                                           _orderDirty(false)
+{
+}
+
+uint32 TransformHierarchy::add()
+{
+  uint32 node = size();
+  _locals.emplace_back();
+  _parents.push_back(NoParent);
+  _slots.push_back(static_cast<uint32>(_nodes.size()));
+
+  _nodes.push_back(node);
+  _parentSlots.push_back(NoParent);
+  _localMatrices.push_back(Matrix4::Identity);
+  _worldMatrices.push_back(Matrix4::Identity);
+  _dirty.push_back(LocalDirty);
+  _anyDirty = true;
+  return node;
+}
+
+void TransformHierarchy::setParent(uint32 node, uint32 parent)
+{
+  _parents[node] = parent;
+
+  uint32 slot = _slots[node];
+  uint32 parentSlot = parent == NoParent ? NoParent : _slots[parent];
+  _parentSlots[slot] = parentSlot;
+  _dirty[slot] |= WorldDirty;
+  _anyDirty = true;
+
+  // Parents must be swept before their children, anything else needs a new order.
+  if (parentSlot != NoParent && parentSlot > slot)
+  {
+    _orderDirty = true;
+  }
+}
+
+Transform &TransformHierarchy::getLocalTransform(uint32 node)
+{
+  markDirty(node);
+  return _locals[node];
+}
+
+void TransformHierarchy::markDirty(uint32 node)
+{
+  _dirty[_slots[node]] |= LocalDirty;
+  _anyDirty = true;
+}
+
+void TransformHierarchy::update()
+{
+  _updatedNodes.clear();
+  if (_orderDirty)
+  {
+    rebuildOrder();
+  }
+  if (!_anyDirty)
+  {
+    return;
+  }
+
+  uint32 slotCount = static_cast<uint32>(_nodes.size());
+  for (uint32 slot = 0; slot < slotCount; slot++)
+  {
+    uint32 parentSlot = _parentSlots[slot];
+    uint8 dirty = _dirty[slot];
+    if (parentSlot != NoParent && (_dirty[parentSlot] & WorldDirty))
+    {
+      dirty |= WorldDirty;
+    }
+    if (dirty == 0)
+    {
+      continue;
+    }
+
+    uint32 node = _nodes[slot];
+    if (dirty & LocalDirty)
+    {
+      _locals[node].update(0.0f);
+      _localMatrices[slot] = _locals[node].getMatrix();
+    }
+
+    _worldMatrices[slot] = parentSlot == NoParent ? _localMatrices[slot] : _worldMatrices[parentSlot] * _localMatrices[slot];
+    // Left set until the sweep ends so that children further along see their parent changed.
+    _dirty[slot] = WorldDirty;
+    _updatedNodes.push_back(node);
+  }
+
+  for (uint32 node : _updatedNodes)
+  {
+    _dirty[_slots[node]] = 0;
+  }
+  _anyDirty = false;
+}
+
+void TransformHierarchy::rebuildOrder()
+{
+  uint32 nodeCount = size();
+  std::vector<std::vector<uint32>> children(nodeCount);
+  std::vector<uint32> order;
+  order.reserve(nodeCount);
+  for (uint32 node = 0; node < nodeCount; node++)
+  {
+    if (_parents[node] == NoParent)
+    {
+      order.push_back(node);
+    }
+    else
+    {
+      children[_parents[node]].push_back(node);
+    }
+  }
+
+  // Breadth first from the roots, which places every parent ahead of its children.
+  for (uint32 i = 0; i < order.size(); i++)
+  {
+    order.insert(order.end(), children[order[i]].begin(), children[order[i]].end());
+  }
+
+  std::vector<Matrix4> localMatrices(nodeCount);
+  std::vector<uint8> dirty(nodeCount);
+  for (uint32 slot = 0; slot < nodeCount; slot++)
+  {
+    localMatrices[slot] = _localMatrices[_slots[order[slot]]];
+    dirty[slot] = _dirty[_slots[order[slot]]];
+  }
+
+  _nodes = order;
+  for (uint32 slot = 0; slot < nodeCount; slot++)
+  {
+    _slots[_nodes[slot]] = slot;
+  }
+  for (uint32 slot = 0; slot < nodeCount; slot++)
+  {
+    uint32 parent = _parents[_nodes[slot]];
+    _parentSlots[slot] = parent == NoParent ? NoParent : _slots[parent];
+  }
+
+  _localMatrices.swap(localMatrices);
+  _dirty.swap(dirty);
+  // Only the roots need flagging, the sweep carries the change down to everything below them.
+  for (uint32 slot = 0; slot < nodeCount && _parentSlots[slot] == NoParent; slot++)
+  {
+    _dirty[slot] |= WorldDirty;
+  }
+  _anyDirty = true;
+  _orderDirty = false;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <limits>
+#include <vector>
+
+#include "../Maths/Matrix4.hpp"
+#include "Transform.h"
+#include "Types.hpp"
+
+/// @brief Flat storage for every transform in a scene. Nodes are kept in topological order, parents before their
+/// children, with their local and world matrices in contiguous arrays, so that a single linear sweep propagates
+/// world matrices to any depth while only recomputing the subtrees below modified nodes.
+class TransformHierarchy
+{
+public:
+  static constexpr uint32 NoParent = std::numeric_limits<uint32>::max();
+
+  TransformHierarchy();
+
+  /// @brief Adds a root node.
+  /// @return Handle of the node, which stays valid as the hierarchy is reordered.
+  uint32 add();
+  void setParent(uint32 node, uint32 parent);
+  uint32 getParent(uint32 node) const { return _parents[node]; }
+
+  /// @brief Mutable access to a node's local transform. Marks the node dirty so that it is recomputed by the next update.
+  Transform &getLocalTransform(uint32 node);
+  const Transform &getLocalTransform(uint32 node) const { return _locals[node]; }
+  const Matrix4 &getWorldMatrix(uint32 node) const { return _worldMatrices[_slots[node]]; }
+
+  void markDirty(uint32 node);
+
+  /// @brief Recomputes the world matrix of every dirty node and of everything below it.
+  void update();
+  /// @brief Nodes whose world matrix changed during the last update, in topological order.
+  const std::vector<uint32> &getUpdatedNodes() const { return _updatedNodes; }
+
+  uint32 size() const { return static_cast<uint32>(_locals.size()); }
+
+private:
+  enum DirtyFlags : uint8
+  {
+    LocalDirty = 1 << 0,
+    WorldDirty = 1 << 1
+  };
+
+  void rebuildOrder();
+
+  // Indexed by node handle.
+  std::vector<Transform> _locals;
+  std::vector<uint32> _parents;
+  std::vector<uint32> _slots;
+
+  // Indexed by topological slot.
+  std::vector<uint32> _nodes;
+  std::vector<uint32> _parentSlots;
+  std::vector<Matrix4> _localMatrices;
+  std::vector<Matrix4> _worldMatrices;
+  std::vector<uint8> _dirty;
+
+  std::vector<uint32> _updatedNodes;
+  bool _anyDirty;
+  bool _orderDirty;
+};
@@ -0,0 +1,63 @@
+#include "UploadQueue.h"
+
+#include <chrono>
+
+UploadQueue::UploadQueue() : _pendingBytes(0)
+{
+}
+
+void UploadQueue::push(uint64 byteCount, Upload upload)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _entries.push_back({byteCount, std::move(upload)});
+  _pendingBytes += byteCount;
+}
+
+uint32 UploadQueue::process(uint64 byteBudget, float32 timeBudgetMs)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  uint64 bytesUploaded = 0;
+  uint32 uploadCount = 0;
+  while (true)
+  {
+    Entry entry;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_entries.empty())
+      {
+        break;
+      }
+      if (uploadCount > 0 && bytesUploaded + _entries.front().ByteCount > byteBudget)
+      {
+        break;
+      }
+      entry = std::move(_entries.front());
+      _entries.pop_front();
+      _pendingBytes -= entry.ByteCount;
+    }
+
+    // Run without the lock held so uploads may queue follow up work.
+    entry.Function();
+    bytesUploaded += entry.ByteCount;
+    uploadCount++;
+
+    std::chrono::duration<float32, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    if (elapsed.count() >= timeBudgetMs)
+    {
+      break;
+    }
+  }
+  return uploadCount;
+}
+
+uint32 UploadQueue::getPendingCount() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return static_cast<uint32>(_entries.size());
+}
+
+uint64 UploadQueue::getPendingBytes() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _pendingBytes;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "Types.hpp"
+
+/// @brief Work which has to run on the thread owning the render device, such as creating buffers and textures. Uploads
+/// are pushed from any thread and run in order by process, which stops once the frame's budget is used up.
+class UploadQueue
+{
+public:
+  typedef std::function<void()> Upload;
+
+  UploadQueue();
+
+  /// @param byteCount Approximate bytes the upload sends to the GPU, charged against the byte budget.
+  void push(uint64 byteCount, Upload upload);
+
+  /// @brief Runs queued uploads until either budget is exhausted. The first upload always runs so that uploads larger
+  /// than the budget still make progress.
+  /// @return The number of uploads which ran.
+  uint32 process(uint64 byteBudget, float32 timeBudgetMs);
+
+  uint32 getPendingCount() const;
+  uint64 getPendingBytes() const;
+
+private:
+  struct Entry
+  {
+    uint64 ByteCount;
+    Upload Function;
+  };
+
+  mutable std::mutex _mutex;
+  std::deque<Entry> _entries;
+  uint64 _pendingBytes;
+};
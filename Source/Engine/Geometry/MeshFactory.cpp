@@ -87,6 +87,7 @@ std::shared_ptr<StaticMesh> MeshFactory::createUvSphere(uint32 verticals, uint32
   mesh->setIndexData(usSphere.getIndices());
   mesh->generateNormals();
   mesh->generateTangents();
+  mesh->generateLods();
   return mesh;
 }
 
@@ -99,5 +100,6 @@ std::shared_ptr<StaticMesh> MeshFactory::createIcosphere(uint32 recursionCount)
   mesh->setIndexData(icosphere.getIndices());
   mesh->generateNormals();
   mesh->generateTangents();
+  mesh->generateLods();
   return mesh;
 }
@@ -0,0 +1,443 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../Utility/Hash.hpp"
+
+namespace
+{
+  constexpr uint32 INVALID_VERTEX = 0xffffffff;
+
+  /// @brief Triangles using each vertex, stored contiguously with each vertex's run starting at Offsets[vertex].
+  struct VertexAdjacency
+  {
+    std::vector<uint32> Offsets;
+    std::vector<uint32> Triangles;
+  };
+
+  VertexAdjacency buildAdjacency(const std::vector<uint32> &indices, uint32 vertexCount)
+  {
+    VertexAdjacency adjacency;
+    adjacency.Offsets.assign(vertexCount + 1, 0);
+    for (uint32 index : indices)
+    {
+      adjacency.Offsets[index + 1]++;
+    }
+    for (uint32 i = 0; i < vertexCount; i++)
+    {
+      adjacency.Offsets[i + 1] += adjacency.Offsets[i];
+    }
+
+    std::vector<uint32> cursors(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+    adjacency.Triangles.resize(indices.size());
+    for (uint32 i = 0; i < indices.size(); i++)
+    {
+      adjacency.Triangles[cursors[indices[i]]++] = i / 3;
+    }
+    return adjacency;
+  }
+
+  /// @brief Simulates a FIFO cache, returning how many of a triangle's vertices missed it.
+  class FifoCache
+  {
+  public:
+    FifoCache(uint32 vertexCount, uint32 cacheSize) : _timestamps(vertexCount, 0), _time(cacheSize + 1), _cacheSize(cacheSize) {}
+
+    uint32 addTriangle(const uint32 *triangle)
+    {
+      uint32 misses = 0;
+      for (uint32 i = 0; i < 3; i++)
+      {
+        if (_time - _timestamps[triangle[i]] > _cacheSize)
+        {
+          _timestamps[triangle[i]] = _time++;
+          misses++;
+        }
+      }
+      return misses;
+    }
+
+    void clear() { _time += _cacheSize + 1; }
+
+  private:
+    std::vector<uint32> _timestamps;
+    uint32 _time;
+    uint32 _cacheSize;
+  };
+}
+
+MeshOptimizationStats MeshOptimizer::optimize(MeshOptimizerData &mesh)
+{
+  MeshOptimizationStats stats;
+  stats.VertexCountBefore = static_cast<uint32>(mesh.Positions.size());
+  stats.TriangleCount = static_cast<uint32>(mesh.Indices.size() / 3);
+  stats.Before = analyzeVertexCache(mesh.Indices, stats.VertexCountBefore);
+
+  uint32 vertexCount = weldVertices(mesh);
+  std::vector<uint32> clusters;
+  optimizeVertexCache(mesh.Indices, vertexCount, &clusters);
+  optimizeOverdraw(mesh.Indices, mesh.Positions, clusters);
+  optimizeVertexFetch(mesh);
+
+  stats.VertexCountAfter = static_cast<uint32>(mesh.Positions.size());
+  stats.After = analyzeVertexCache(mesh.Indices, stats.VertexCountAfter);
+  return stats;
+}
+
+uint32 MeshOptimizer::weldVertices(MeshOptimizerData &mesh)
+{
+  uint32 vertexCount = static_cast<uint32>(mesh.Positions.size());
+  bool hasNormals = mesh.Normals.size() == vertexCount;
+  bool hasTexCoords = mesh.TexCoords.size() == vertexCount;
+
+  // Every attribute of a vertex packed together so vertices are compared and hashed as a single run of bytes.
+  uint32 stride = 3 + (hasNormals ? 3 : 0) + (hasTexCoords ? 2 : 0);
+  std::vector<float32> packed(static_cast<uint64>(vertexCount) * stride);
+  for (uint32 i = 0; i < vertexCount; i++)
+  {
+    float32 *vertex = packed.data() + static_cast<uint64>(i) * stride;
+    std::memcpy(vertex, &mesh.Positions[i], sizeof(Vector3));
+    vertex += 3;
+    if (hasNormals)
+    {
+      std::memcpy(vertex, &mesh.Normals[i], sizeof(Vector3));
+      vertex += 3;
+    }
+    if (hasTexCoords)
+    {
+      std::memcpy(vertex, &mesh.TexCoords[i], sizeof(Vector2));
+    }
+  }
+
+  uint32 tableSize = 1;
+  while (tableSize < vertexCount * 2)
+  {
+    tableSize *= 2;
+  }
+  std::vector<uint32> table(tableSize, INVALID_VERTEX);
+  std::vector<uint32> remap(vertexCount);
+  uint32 uniqueCount = 0;
+  uint64 vertexBytes = stride * sizeof(float32);
+  for (uint32 i = 0; i < vertexCount; i++)
+  {
+    const float32 *vertex = packed.data() + static_cast<uint64>(i) * stride;
+    uint32 slot = static_cast<uint32>(Hash::fnv1a(vertex, vertexBytes)) & (tableSize - 1);
+    while (table[slot] != INVALID_VERTEX && std::memcmp(packed.data() + static_cast<uint64>(table[slot]) * stride, vertex, vertexBytes) != 0)
+    {
+      slot = (slot + 1) & (tableSize - 1);
+    }
+    if (table[slot] == INVALID_VERTEX)
+    {
+      // Unique vertices are compacted to the front in place, which never overwrites one still to be read.
+      std::memmove(packed.data() + static_cast<uint64>(uniqueCount) * stride, vertex, vertexBytes);
+      table[slot] = uniqueCount++;
+    }
+    remap[i] = table[slot];
+  }
+
+  for (uint32 i = 0; i < vertexCount; i++)
+  {
+    uint32 target = remap[i];
+    mesh.Positions[target] = mesh.Positions[i];
+    if (hasNormals)
+    {
+      mesh.Normals[target] = mesh.Normals[i];
+    }
+    if (hasTexCoords)
+    {
+      mesh.TexCoords[target] = mesh.TexCoords[i];
+    }
+  }
+  mesh.Positions.resize(uniqueCount);
+  if (hasNormals)
+  {
+    mesh.Normals.resize(uniqueCount);
+  }
+  if (hasTexCoords)
+  {
+    mesh.TexCoords.resize(uniqueCount);
+  }
+  for (auto &index : mesh.Indices)
+  {
+    index = remap[index];
+  }
+  return uniqueCount;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32> &indices, uint32 vertexCount, std::vector<uint32> *clusters)
+{
+  uint32 triangleCount = static_cast<uint32>(indices.size() / 3);
+  VertexAdjacency adjacency = buildAdjacency(indices, vertexCount);
+  std::vector<uint32> liveTriangles(vertexCount);
+  for (uint32 i = 0; i < vertexCount; i++)
+  {
+    liveTriangles[i] = adjacency.Offsets[i + 1] - adjacency.Offsets[i];
+  }
+
+  const uint32 cacheSize = MESH_OPTIMIZER_CACHE_SIZE;
+  std::vector<uint32> cacheTimes(vertexCount, 0);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32> deadEnds;
+  std::vector<uint32> candidates;
+  std::vector<uint32> output;
+  output.reserve(indices.size());
+  uint32 time = cacheSize + 1;
+  uint32 cursor = 0;
+
+  // Falls back to the most recently used vertex with triangles left, then to the next one in index order.
+  auto skipDeadEnd = [&]()
+  {
+    while (!deadEnds.empty())
+    {
+      uint32 vertex = deadEnds.back();
+      deadEnds.pop_back();
+      if (liveTriangles[vertex] > 0)
+      {
+        return vertex;
+      }
+    }
+    while (cursor < vertexCount)
+    {
+      if (liveTriangles[cursor] > 0)
+      {
+        return cursor;
+      }
+      cursor++;
+    }
+    return INVALID_VERTEX;
+  };
+
+  if (clusters)
+  {
+    clusters->clear();
+  }
+  uint32 fanVertex = skipDeadEnd();
+  bool startsCluster = true;
+  while (fanVertex != INVALID_VERTEX)
+  {
+    if (startsCluster && clusters && output.size() < indices.size())
+    {
+      clusters->push_back(static_cast<uint32>(output.size() / 3));
+    }
+
+    candidates.clear();
+    for (uint32 i = adjacency.Offsets[fanVertex]; i < adjacency.Offsets[fanVertex + 1]; i++)
+    {
+      uint32 triangle = adjacency.Triangles[i];
+      if (emitted[triangle])
+      {
+        continue;
+      }
+      emitted[triangle] = true;
+      for (uint32 corner = 0; corner < 3; corner++)
+      {
+        uint32 vertex = indices[triangle * 3 + corner];
+        output.push_back(vertex);
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        liveTriangles[vertex]--;
+        if (time - cacheTimes[vertex] > cacheSize)
+        {
+          cacheTimes[vertex] = time++;
+        }
+      }
+    }
+
+    // Prefers the candidate longest in the cache which will still be in it once all of its own triangles are emitted.
+    uint32 nextVertex = INVALID_VERTEX;
+    int32 bestPriority = -1;
+    for (uint32 vertex : candidates)
+    {
+      if (liveTriangles[vertex] == 0)
+      {
+        continue;
+      }
+      int32 priority = 0;
+      if (time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+      {
+        priority = static_cast<int32>(time - cacheTimes[vertex]);
+      }
+      if (priority > bestPriority)
+      {
+        bestPriority = priority;
+        nextVertex = vertex;
+      }
+    }
+
+    startsCluster = nextVertex == INVALID_VERTEX;
+    fanVertex = startsCluster ? skipDeadEnd() : nextVertex;
+  }
+
+  indices.swap(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<uint32> &indices, const std::vector<Vector3> &positions, const std::vector<uint32> &clusters,
+                                     float32 threshold)
+{
+  uint32 triangleCount = static_cast<uint32>(indices.size() / 3);
+  if (triangleCount == 0 || clusters.empty())
+  {
+    return;
+  }
+
+  // Soft boundaries: a new cluster may start wherever the cache misses so far, paid for as if the cache were empty at the
+  // start of the cluster, stay within the threshold of the whole list's.
+  uint32 vertexCount = static_cast<uint32>(positions.size());
+  float32 targetAcmr = analyzeVertexCache(indices, vertexCount).Acmr * threshold;
+  std::vector<uint32> boundaries;
+  FifoCache cache(vertexCount, MESH_OPTIMIZER_CACHE_SIZE);
+  for (uint32 c = 0; c < clusters.size(); c++)
+  {
+    uint32 end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+    uint32 start = clusters[c];
+    uint32 misses = 0;
+    cache.clear();
+    boundaries.push_back(start);
+    for (uint32 triangle = start; triangle < end; triangle++)
+    {
+      misses += cache.addTriangle(&indices[triangle * 3]);
+      uint32 length = triangle + 1 - start;
+      if (triangle + 1 < end && misses <= targetAcmr * length)
+      {
+        boundaries.push_back(triangle + 1);
+        start = triangle + 1;
+        misses = 0;
+        cache.clear();
+      }
+    }
+  }
+
+  Vector3 meshCentroid = Vector3::Zero;
+  for (const auto &position : positions)
+  {
+    meshCentroid += position;
+  }
+  meshCentroid /= static_cast<float32>(std::max<size_t>(positions.size(), 1));
+
+  struct Cluster
+  {
+    uint32 Start;
+    uint32 End;
+    float32 SortKey;
+  };
+  std::vector<Cluster> sortedClusters(boundaries.size());
+  for (uint32 c = 0; c < boundaries.size(); c++)
+  {
+    Cluster &cluster = sortedClusters[c];
+    cluster.Start = boundaries[c];
+    cluster.End = c + 1 < boundaries.size() ? boundaries[c + 1] : triangleCount;
+
+    // Area weighted, as the cross products are twice each triangle's area.
+    Vector3 centroid = Vector3::Zero;
+    Vector3 normal = Vector3::Zero;
+    float32 area = 0.0f;
+    for (uint32 triangle = cluster.Start; triangle < cluster.End; triangle++)
+    {
+      const Vector3 &p0 = positions[indices[triangle * 3]];
+      const Vector3 &p1 = positions[indices[triangle * 3 + 1]];
+      const Vector3 &p2 = positions[indices[triangle * 3 + 2]];
+      Vector3 cross = Vector3::Cross(p1 - p0, p2 - p0);
+      float32 triangleArea = Vector3::Length(cross);
+      centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+      normal += cross;
+      area += triangleArea;
+    }
+    float32 normalLength = Vector3::Length(normal);
+    if (area > 0.0f && normalLength > 0.0f)
+    {
+      cluster.SortKey = Vector3::Dot(centroid / area - meshCentroid, normal / normalLength);
+    }
+    else
+    {
+      cluster.SortKey = 0.0f;
+    }
+  }
+
+  // Clusters facing out from the centre are likely to be in front of the rest.
+  std::stable_sort(sortedClusters.begin(), sortedClusters.end(), [](const Cluster &a, const Cluster &b)
+                   { return a.SortKey > b.SortKey; });
+
+  std::vector<uint32> output;
+  output.reserve(indices.size());
+  for (const auto &cluster : sortedClusters)
+  {
+    output.insert(output.end(), indices.begin() + cluster.Start * 3, indices.begin() + cluster.End * 3);
+  }
+  indices.swap(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(MeshOptimizerData &mesh)
+{
+  uint32 vertexCount = static_cast<uint32>(mesh.Positions.size());
+  bool hasNormals = mesh.Normals.size() == vertexCount;
+  bool hasTexCoords = mesh.TexCoords.size() == vertexCount;
+
+  std::vector<uint32> remap(vertexCount, INVALID_VERTEX);
+  uint32 nextVertex = 0;
+  for (auto &index : mesh.Indices)
+  {
+    if (remap[index] == INVALID_VERTEX)
+    {
+      remap[index] = nextVertex++;
+    }
+    index = remap[index];
+  }
+
+  MeshOptimizerData reordered;
+  reordered.Positions.resize(nextVertex);
+  reordered.Normals.resize(hasNormals ? nextVertex : 0);
+  reordered.TexCoords.resize(hasTexCoords ? nextVertex : 0);
+  for (uint32 i = 0; i < vertexCount; i++)
+  {
+    uint32 target = remap[i];
+    if (target == INVALID_VERTEX)
+    {
+      continue;
+    }
+    reordered.Positions[target] = mesh.Positions[i];
+    if (hasNormals)
+    {
+      reordered.Normals[target] = mesh.Normals[i];
+    }
+    if (hasTexCoords)
+    {
+      reordered.TexCoords[target] = mesh.TexCoords[i];
+    }
+  }
+  mesh.Positions.swap(reordered.Positions);
+  mesh.Normals.swap(reordered.Normals);
+  mesh.TexCoords.swap(reordered.TexCoords);
+}
+
+VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32> &indices, uint32 vertexCount, uint32 cacheSize)
+{
+  VertexCacheStats stats;
+  uint32 triangleCount = static_cast<uint32>(indices.size() / 3);
+  if (triangleCount == 0)
+  {
+    return stats;
+  }
+
+  FifoCache cache(vertexCount, cacheSize);
+  std::vector<bool> referenced(vertexCount, false);
+  uint32 referencedCount = 0;
+  uint32 misses = 0;
+  for (uint32 triangle = 0; triangle < triangleCount; triangle++)
+  {
+    misses += cache.addTriangle(&indices[triangle * 3]);
+    for (uint32 corner = 0; corner < 3; corner++)
+    {
+      uint32 vertex = indices[triangle * 3 + corner];
+      if (!referenced[vertex])
+      {
+        referenced[vertex] = true;
+        referencedCount++;
+      }
+    }
+  }
+
+  stats.Acmr = static_cast<float32>(misses) / triangleCount;
+  stats.Atvr = static_cast<float32>(misses) / referencedCount;
+  return stats;
+}
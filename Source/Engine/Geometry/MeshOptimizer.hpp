@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Maths.h"
+#include "../Core/Types.hpp"
+
+/// @brief Bumped whenever the optimizer's output changes, so that cached bakes of the old output are not reused.
+constexpr uint32 MESH_OPTIMIZER_VERSION = 1;
+/// @brief Entries in the simulated FIFO post-transform cache, a conservative fit for desktop GPUs.
+constexpr uint32 MESH_OPTIMIZER_CACHE_SIZE = 16;
+
+/// @brief Vertex attributes of a triangle list. Normals and texture coordinates may be left empty.
+struct MeshOptimizerData
+{
+  std::vector<Vector3> Positions;
+  std::vector<Vector3> Normals;
+  std::vector<Vector2> TexCoords;
+  std::vector<uint32> Indices;
+};
+
+struct VertexCacheStats
+{
+  /// @brief Average cache miss ratio, vertices transformed per triangle. 0.5 is the best case for a regular grid, 3 the worst.
+  float32 Acmr = 0.0f;
+  /// @brief Average transform to vertex ratio, vertices transformed per referenced vertex. 1 is ideal.
+  float32 Atvr = 0.0f;
+};
+
+struct MeshOptimizationStats
+{
+  uint32 VertexCountBefore = 0;
+  uint32 VertexCountAfter = 0;
+  uint32 TriangleCount = 0;
+  VertexCacheStats Before;
+  VertexCacheStats After;
+};
+
+/// @brief Reorders triangle lists so the GPU transforms as few vertices as possible.
+class MeshOptimizer
+{
+public:
+  /// @brief Runs every stage below in order: weld, vertex cache, overdraw, vertex fetch.
+  static MeshOptimizationStats optimize(MeshOptimizerData &mesh);
+
+  /// @brief Merges vertices whose attributes are bitwise identical, returning the new vertex count.
+  static uint32 weldVertices(MeshOptimizerData &mesh);
+
+  /// @brief Orders triangles for the post-transform cache with Tipsify (Sander et al. 2007).
+  /// @param clusters If given, receives the first triangle of each run started after reaching a dead end. Triangles
+  /// within a run share vertices, so runs can later be reordered without hurting the cache much.
+  static void optimizeVertexCache(std::vector<uint32> &indices, uint32 vertexCount, std::vector<uint32> *clusters = nullptr);
+
+  /// @brief Splits the clusters of a cache optimized list further wherever the cache has already paid for itself, then
+  /// draws the clusters facing furthest out from the mesh centre first so that they occlude the rest.
+  /// @param threshold How far the cache miss ratio may rise over that of the incoming order, 1.05 allowing 5%.
+  static void optimizeOverdraw(std::vector<uint32> &indices, const std::vector<Vector3> &positions, const std::vector<uint32> &clusters,
+                               float32 threshold = 1.05f);
+
+  /// @brief Renumbers vertices in the order the indices first use them, dropping any that are never used, so that
+  /// vertex fetches walk the buffer forwards.
+  static void optimizeVertexFetch(MeshOptimizerData &mesh);
+
+  static VertexCacheStats analyzeVertexCache(const std::vector<uint32> &indices, uint32 vertexCount, uint32 cacheSize = MESH_OPTIMIZER_CACHE_SIZE);
+};
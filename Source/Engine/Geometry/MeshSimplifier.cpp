@@ -0,0 +1,525 @@
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include "../Utility/Hash.hpp"
+
+namespace
+{
+  constexpr uint32 INVALID_VERTEX = 0xffffffff;
+  /// @brief Weight of the planes holding open borders in place, relative to those of the triangles.
+  constexpr float64 BORDER_WEIGHT = 10.0;
+  /// @brief Weights of the squared attribute differences across a collapsed edge, scaled by its squared length.
+  constexpr float32 NORMAL_WEIGHT = 0.25f;
+  constexpr float32 TEXCOORD_WEIGHT = 1.0f;
+  /// @brief A collapse may not turn any triangle it moves further than this cosine from where it faced before.
+  constexpr float32 MIN_FLIP_COSINE = 0.25f;
+  /// @brief Share of the candidate edges a pass may collapse before the costs of the rest are brought up to date.
+  constexpr uint32 PASS_COLLAPSE_DIVISOR = 6;
+  constexpr float32 LOD_REDUCTION = 0.5f;
+  /// @brief A level keeping more than this share of the previous level's triangles ends the chain.
+  constexpr float32 MAX_LOD_RATIO = 0.8f;
+  constexpr uint32 MIN_LOD_TRIANGLES = 8;
+
+  enum class VertexKind : uint8
+  {
+    Interior,
+    /// @brief On an open border, may only collapse along it.
+    Border,
+    /// @brief On a seam or a non-manifold edge, never moves.
+    Locked
+  };
+
+  /// @brief Sum of weighted squared distances to a set of planes, kept as a symmetric 4x4 matrix.
+  struct Quadric
+  {
+    float64 A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+    float64 B0 = 0.0, B1 = 0.0, B2 = 0.0;
+    float64 C = 0.0;
+    float64 Weight = 0.0;
+
+    /// @brief Adds the plane dot(normal, p) + distance = 0, where normal is unit length.
+    void addPlane(const Vector3 &normal, float64 distance, float64 weight)
+    {
+      float64 x = normal.X, y = normal.Y, z = normal.Z;
+      A00 += weight * x * x;
+      A01 += weight * x * y;
+      A02 += weight * x * z;
+      A11 += weight * y * y;
+      A12 += weight * y * z;
+      A22 += weight * z * z;
+      B0 += weight * x * distance;
+      B1 += weight * y * distance;
+      B2 += weight * z * distance;
+      C += weight * distance * distance;
+      Weight += weight;
+    }
+
+    void add(const Quadric &other)
+    {
+      A00 += other.A00;
+      A01 += other.A01;
+      A02 += other.A02;
+      A11 += other.A11;
+      A12 += other.A12;
+      A22 += other.A22;
+      B0 += other.B0;
+      B1 += other.B1;
+      B2 += other.B2;
+      C += other.C;
+      Weight += other.Weight;
+    }
+
+    /// @brief The weighted mean squared distance from position to the planes.
+    float64 evaluate(const Vector3 &position) const
+    {
+      if (Weight <= 0.0)
+      {
+        return 0.0;
+      }
+      float64 x = position.X, y = position.Y, z = position.Z;
+      float64 error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) +
+                      2.0 * (B0 * x + B1 * y + B2 * z) + C;
+      return std::max(error / Weight, 0.0);
+    }
+  };
+
+  struct Collapse
+  {
+    uint32 From;
+    uint32 To;
+    /// @brief Squared distance the surface moves, which orders collapses once attribute changes are added to it.
+    float32 Error;
+    float32 Cost;
+  };
+
+  uint64 getEdgeKey(uint32 a, uint32 b)
+  {
+    return (static_cast<uint64>(a) << 32) | b;
+  }
+
+  /// @brief Maps each vertex to the first vertex with a bitwise identical position.
+  std::vector<uint32> buildPositionRemap(const std::vector<Vector3> &positions)
+  {
+    uint32 vertexCount = static_cast<uint32>(positions.size());
+    uint32 tableSize = 1;
+    while (tableSize < vertexCount * 2)
+    {
+      tableSize *= 2;
+    }
+    std::vector<uint32> table(tableSize, INVALID_VERTEX);
+    std::vector<uint32> remap(vertexCount);
+    for (uint32 i = 0; i < vertexCount; i++)
+    {
+      uint32 slot = static_cast<uint32>(Hash::fnv1a(&positions[i], sizeof(Vector3))) & (tableSize - 1);
+      while (table[slot] != INVALID_VERTEX && std::memcmp(&positions[table[slot]], &positions[i], sizeof(Vector3)) != 0)
+      {
+        slot = (slot + 1) & (tableSize - 1);
+      }
+      if (table[slot] == INVALID_VERTEX)
+      {
+        table[slot] = i;
+      }
+      remap[i] = table[slot];
+    }
+    return remap;
+  }
+
+  /// @brief Counts every directed edge between positions, so that an edge without its reverse is on an open border
+  /// and one seen twice in the same direction is non-manifold.
+  std::unordered_map<uint64, uint32> countEdges(const std::vector<uint32> &indices, const std::vector<uint32> &positionRemap)
+  {
+    std::unordered_map<uint64, uint32> edges;
+    edges.reserve(indices.size());
+    for (uint64 i = 0; i < indices.size(); i += 3)
+    {
+      for (uint32 c = 0; c < 3; c++)
+      {
+        edges[getEdgeKey(positionRemap[indices[i + c]], positionRemap[indices[i + (c + 1) % 3]])]++;
+      }
+    }
+    return edges;
+  }
+
+  std::vector<VertexKind> classifyVertices(const std::vector<uint32> &indices, const std::vector<uint32> &positionRemap)
+  {
+    uint32 vertexCount = static_cast<uint32>(positionRemap.size());
+    std::vector<VertexKind> positionKinds(vertexCount, VertexKind::Interior);
+    for (uint32 i = 0; i < vertexCount; i++)
+    {
+      // Several vertices at one position differ in their attributes, moving any of them would tear the seam open.
+      if (positionRemap[i] != i)
+      {
+        positionKinds[i] = VertexKind::Locked;
+        positionKinds[positionRemap[i]] = VertexKind::Locked;
+      }
+    }
+
+    std::unordered_map<uint64, uint32> edges = countEdges(indices, positionRemap);
+    for (const auto &edge : edges)
+    {
+      uint32 a = static_cast<uint32>(edge.first >> 32);
+      uint32 b = static_cast<uint32>(edge.first & 0xffffffff);
+      if (edge.second > 1)
+      {
+        positionKinds[a] = VertexKind::Locked;
+        positionKinds[b] = VertexKind::Locked;
+      }
+      else if (edges.find(getEdgeKey(b, a)) == edges.end())
+      {
+        for (uint32 position : {a, b})
+        {
+          if (positionKinds[position] == VertexKind::Interior)
+          {
+            positionKinds[position] = VertexKind::Border;
+          }
+        }
+      }
+    }
+
+    std::vector<VertexKind> kinds(vertexCount);
+    for (uint32 i = 0; i < vertexCount; i++)
+    {
+      kinds[i] = positionKinds[positionRemap[i]];
+    }
+    return kinds;
+  }
+
+  Vector3 getTriangleNormal(const Vector3 &a, const Vector3 &b, const Vector3 &c)
+  {
+    return Vector3::Cross(b - a, c - a);
+  }
+}
+
+std::vector<uint32> MeshSimplifier::simplify(const MeshOptimizerData &mesh, uint32 targetIndexCount, float32 targetError, float32 *resultError)
+{
+  if (resultError)
+  {
+    *resultError = 0.0f;
+  }
+
+  std::vector<uint32> indices = mesh.Indices;
+  uint32 vertexCount = static_cast<uint32>(mesh.Positions.size());
+  if (indices.size() <= targetIndexCount || vertexCount == 0)
+  {
+    return indices;
+  }
+
+  // Positions are moved into the unit sphere around their bounds, so that every error is relative to the radius.
+  Vector3 min(std::numeric_limits<float32>::max());
+  Vector3 max(std::numeric_limits<float32>::lowest());
+  for (const Vector3 &position : mesh.Positions)
+  {
+    for (uint32 c = 0; c < 3; c++)
+    {
+      min[c] = std::min(min[c], position[c]);
+      max[c] = std::max(max[c], position[c]);
+    }
+  }
+  float32 radius = (max - min).Length() * 0.5f;
+  if (radius <= 0.0f)
+  {
+    return indices;
+  }
+  Vector3 centre = (min + max) * 0.5f;
+  std::vector<Vector3> positions(vertexCount);
+  for (uint32 i = 0; i < vertexCount; i++)
+  {
+    positions[i] = (mesh.Positions[i] - centre) / radius;
+  }
+
+  bool hasNormals = mesh.Normals.size() == vertexCount;
+  bool hasTexCoords = mesh.TexCoords.size() == vertexCount;
+  std::vector<uint32> positionRemap = buildPositionRemap(mesh.Positions);
+  std::vector<VertexKind> kinds = classifyVertices(indices, positionRemap);
+
+  std::vector<Quadric> quadrics(vertexCount);
+  {
+    std::unordered_map<uint64, uint32> edges = countEdges(indices, positionRemap);
+    for (uint64 i = 0; i < indices.size(); i += 3)
+    {
+      const uint32 *triangle = &indices[i];
+      Vector3 normal = getTriangleNormal(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+      float32 doubleArea = normal.Length();
+      if (doubleArea <= 0.0f)
+      {
+        continue;
+      }
+      normal /= doubleArea;
+
+      Quadric quadric;
+      quadric.addPlane(normal, -Vector3::Dot(normal, positions[triangle[0]]), doubleArea * 0.5f);
+      for (uint32 c = 0; c < 3; c++)
+      {
+        quadrics[triangle[c]].add(quadric);
+      }
+
+      // Planes through each open border edge, standing upright on the triangle, resist pulling the border inwards.
+      for (uint32 c = 0; c < 3; c++)
+      {
+        uint32 a = triangle[c];
+        uint32 b = triangle[(c + 1) % 3];
+        if (edges.find(getEdgeKey(positionRemap[b], positionRemap[a])) != edges.end())
+        {
+          continue;
+        }
+        Vector3 edge = positions[b] - positions[a];
+        Vector3 borderNormal = Vector3::Cross(edge, normal);
+        float32 length = borderNormal.Length();
+        if (length <= 0.0f)
+        {
+          continue;
+        }
+        borderNormal /= length;
+
+        Quadric border;
+        border.addPlane(borderNormal, -Vector3::Dot(borderNormal, positions[a]), BORDER_WEIGHT * length * length);
+        quadrics[a].add(border);
+        quadrics[b].add(border);
+      }
+    }
+  }
+
+  auto getCollapse = [&](uint32 from, uint32 to)
+  {
+    Quadric quadric = quadrics[from];
+    quadric.add(quadrics[to]);
+    float32 error = static_cast<float32>(quadric.evaluate(positions[to]));
+
+    // The collapsed vertex's attributes are replaced by those of the vertex it lands on, which matters more the
+    // further it moves.
+    float32 attributeCost = 0.0f;
+    if (hasNormals)
+    {
+      Vector3 difference = mesh.Normals[from] - mesh.Normals[to];
+      attributeCost += Vector3::Dot(difference, difference) * NORMAL_WEIGHT;
+    }
+    if (hasTexCoords)
+    {
+      Vector2 difference = mesh.TexCoords[from] - mesh.TexCoords[to];
+      attributeCost += Vector2::Dot(difference, difference) * TEXCOORD_WEIGHT;
+    }
+    Vector3 edge = positions[to] - positions[from];
+    return Collapse{from, to, error, error + attributeCost * Vector3::Dot(edge, edge)};
+  };
+
+  float32 maxError = 0.0f;
+  float32 maxTargetError = targetError * targetError;
+  std::vector<Collapse> collapses;
+  std::vector<uint32> remap(vertexCount);
+  std::vector<uint8> touched(vertexCount);
+  while (indices.size() > targetIndexCount)
+  {
+    // Triangles around each position, with the run of position p starting at offsets[p]. Only locked vertices share
+    // their position, so for every vertex that may move this is also the run of triangles around the vertex.
+    std::vector<uint32> offsets(vertexCount + 1, 0);
+    for (uint32 index : indices)
+    {
+      offsets[positionRemap[index] + 1]++;
+    }
+    for (uint32 i = 0; i < vertexCount; i++)
+    {
+      offsets[i + 1] += offsets[i];
+    }
+    std::vector<uint32> adjacency(indices.size());
+    {
+      std::vector<uint32> cursors(offsets.begin(), offsets.end() - 1);
+      for (uint32 i = 0; i < indices.size(); i++)
+      {
+        adjacency[cursors[positionRemap[indices[i]]]++] = i / 3;
+      }
+    }
+    auto hasEdge = [&](uint32 a, uint32 b)
+    {
+      for (uint32 t = offsets[a]; t < offsets[a + 1]; t++)
+      {
+        const uint32 *triangle = &indices[static_cast<uint64>(adjacency[t]) * 3];
+        for (uint32 c = 0; c < 3; c++)
+        {
+          if (positionRemap[triangle[c]] == a && positionRemap[triangle[(c + 1) % 3]] == b)
+          {
+            return true;
+          }
+        }
+      }
+      return false;
+    };
+
+    collapses.clear();
+    for (uint64 i = 0; i < indices.size(); i += 3)
+    {
+      for (uint32 c = 0; c < 3; c++)
+      {
+        uint32 a = indices[i + c];
+        uint32 b = indices[i + (c + 1) % 3];
+        if (kinds[a] == VertexKind::Locked && kinds[b] == VertexKind::Locked)
+        {
+          continue;
+        }
+        bool border = !hasEdge(positionRemap[b], positionRemap[a]);
+        // Interior edges are shared by two triangles, only one of which needs to consider them.
+        if (!border && a > b)
+        {
+          continue;
+        }
+
+        Collapse best{INVALID_VERTEX, INVALID_VERTEX, 0.0f, std::numeric_limits<float32>::max()};
+        for (uint32 direction = 0; direction < 2; direction++)
+        {
+          uint32 from = direction == 0 ? a : b;
+          uint32 to = direction == 0 ? b : a;
+          if (kinds[from] == VertexKind::Locked || (kinds[from] == VertexKind::Border && !border))
+          {
+            continue;
+          }
+          Collapse collapse = getCollapse(from, to);
+          if (collapse.Cost < best.Cost)
+          {
+            best = collapse;
+          }
+        }
+        if (best.From != INVALID_VERTEX)
+        {
+          collapses.push_back(best);
+        }
+      }
+    }
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b)
+              { return a.Cost < b.Cost; });
+
+    uint64 trianglesToRemove = (indices.size() - targetIndexCount + 2) / 3;
+    uint64 maxCollapses = std::max<uint64>(collapses.size() / PASS_COLLAPSE_DIVISOR, 1);
+    uint64 trianglesRemoved = 0;
+    uint64 collapseCount = 0;
+    for (uint32 i = 0; i < vertexCount; i++)
+    {
+      remap[i] = i;
+    }
+    std::fill(touched.begin(), touched.end(), 0);
+    for (const Collapse &collapse : collapses)
+    {
+      if (collapseCount >= maxCollapses || trianglesRemoved >= trianglesToRemove)
+      {
+        break;
+      }
+      if (collapse.Error > maxTargetError)
+      {
+        continue;
+      }
+
+      // Every triangle around the collapsed vertex must still be as the adjacency describes it, so none of their
+      // vertices may have been touched by an earlier collapse of this pass.
+      bool valid = true;
+      uint32 degenerateCount = 0;
+      for (uint32 t = offsets[collapse.From]; t < offsets[collapse.From + 1] && valid; t++)
+      {
+        const uint32 *triangle = &indices[static_cast<uint64>(adjacency[t]) * 3];
+        bool hasTo = false;
+        for (uint32 c = 0; c < 3; c++)
+        {
+          valid &= touched[triangle[c]] == 0;
+          hasTo |= triangle[c] == collapse.To;
+        }
+        if (hasTo)
+        {
+          degenerateCount++;
+          continue;
+        }
+
+        Vector3 corners[3];
+        for (uint32 c = 0; c < 3; c++)
+        {
+          corners[c] = positions[triangle[c]];
+        }
+        Vector3 before = getTriangleNormal(corners[0], corners[1], corners[2]);
+        for (uint32 c = 0; c < 3; c++)
+        {
+          if (triangle[c] == collapse.From)
+          {
+            corners[c] = positions[collapse.To];
+          }
+        }
+        Vector3 after = getTriangleNormal(corners[0], corners[1], corners[2]);
+        valid &= Vector3::Dot(before, after) > MIN_FLIP_COSINE * before.Length() * after.Length();
+      }
+      if (!valid)
+      {
+        continue;
+      }
+
+      for (uint32 t = offsets[collapse.From]; t < offsets[collapse.From + 1]; t++)
+      {
+        const uint32 *triangle = &indices[static_cast<uint64>(adjacency[t]) * 3];
+        touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+      }
+      remap[collapse.From] = collapse.To;
+      quadrics[collapse.To].add(quadrics[collapse.From]);
+      maxError = std::max(maxError, collapse.Error);
+      trianglesRemoved += degenerateCount;
+      collapseCount++;
+    }
+
+    if (collapseCount == 0)
+    {
+      break;
+    }
+
+    uint64 writeIndex = 0;
+    for (uint64 i = 0; i < indices.size(); i += 3)
+    {
+      uint32 a = remap[indices[i]];
+      uint32 b = remap[indices[i + 1]];
+      uint32 c = remap[indices[i + 2]];
+      if (a != b && b != c && a != c)
+      {
+        indices[writeIndex++] = a;
+        indices[writeIndex++] = b;
+        indices[writeIndex++] = c;
+      }
+    }
+    indices.resize(writeIndex);
+  }
+
+  if (resultError)
+  {
+    *resultError = std::sqrt(maxError);
+  }
+  return indices;
+}
+
+std::vector<MeshLod> MeshSimplifier::generateLods(const MeshOptimizerData &mesh, std::vector<uint32> &indices)
+{
+  indices = mesh.Indices;
+  std::vector<MeshLod> lods = {{0, static_cast<uint32>(indices.size()), 0.0f}};
+
+  uint32 vertexCount = static_cast<uint32>(mesh.Positions.size());
+  float32 targetIndexCount = static_cast<float32>(mesh.Indices.size());
+  for (uint32 lod = 1; lod < MAX_MESH_LODS; lod++)
+  {
+    targetIndexCount *= LOD_REDUCTION;
+    uint32 targetTriangleCount = static_cast<uint32>(targetIndexCount) / 3;
+    if (targetTriangleCount < MIN_LOD_TRIANGLES)
+    {
+      break;
+    }
+
+    // Each level starts over from the full mesh rather than the previous level, so errors do not compound.
+    float32 error;
+    std::vector<uint32> lodIndices = simplify(mesh, targetTriangleCount * 3, 1.0f, &error);
+    const MeshLod &previous = lods.back();
+    if (lodIndices.size() > previous.IndexCount * MAX_LOD_RATIO)
+    {
+      break;
+    }
+    MeshOptimizer::optimizeVertexCache(lodIndices, vertexCount);
+
+    // Errors only grow along the chain, so selection can stop at the first level over its threshold.
+    lods.push_back({static_cast<uint32>(indices.size()), static_cast<uint32>(lodIndices.size()), std::max(error, previous.Error)});
+    indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+  }
+  return lods;
+}
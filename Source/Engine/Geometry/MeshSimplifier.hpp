@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Types.hpp"
+#include "MeshOptimizer.hpp"
+
+/// @brief Bumped whenever the simplifier's output changes, so that cached bakes of the old output are not reused.
+constexpr uint32 MESH_SIMPLIFIER_VERSION = 1;
+/// @brief Levels of detail a mesh may have, counting the full resolution one.
+constexpr uint32 MAX_MESH_LODS = 4;
+
+/// @brief A level of detail, drawn as a range of the mesh's index buffer over the vertices every level shares.
+struct MeshLod
+{
+  uint32 IndexOffset = 0;
+  uint32 IndexCount = 0;
+  /// @brief How far the level strays from the full resolution surface, relative to the radius of the mesh's bounds.
+  float32 Error = 0.0f;
+};
+
+/// @brief Reduces triangle lists with quadric error edge collapses (Garland & Heckbert 1997).
+class MeshSimplifier
+{
+public:
+  /// @brief Collapses edges of mesh.Indices until no more than targetIndexCount indices remain, or until every
+  /// remaining collapse would move the surface further than targetError. Edges collapse onto one of their vertices,
+  /// so the result indexes the mesh's vertices unchanged. Vertices on normal or texture seams stay put and vertices on
+  /// open borders only slide along the border, which keeps texturing and silhouettes intact.
+  /// @param targetError Relative to the radius of the mesh's bounds.
+  /// @param resultError If given, receives the furthest any collapse made moved the surface, relative to the same radius.
+  static std::vector<uint32> simplify(const MeshOptimizerData &mesh, uint32 targetIndexCount, float32 targetError = 1.0f,
+                                      float32 *resultError = nullptr);
+
+  /// @brief Builds a chain of up to MAX_MESH_LODS levels, each simplified from the full mesh to half the triangles of
+  /// the one before and cache optimized. The chain ends early once a level saves too little to be worth drawing.
+  /// @param indices Receives every level's indices one after another, the first being mesh.Indices unchanged.
+  static std::vector<MeshLod> generateLods(const MeshOptimizerData &mesh, std::vector<uint32> &indices);
+};
@@ -0,0 +1,329 @@
+#include "TangentSpace.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+
+#include "../Core/JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FIDELITY_TANGENT_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+  // Triangles or vertices per job when a pass is split across a JobSystem.
+  constexpr uint32 TANGENT_GRAIN_SIZE = 4096;
+
+  enum TriangleFlags : uint8
+  {
+    TF_Valid = 1 << 0,
+    // The texture coordinates wind the same way as the positions, so the triangle is not mirrored.
+    TF_OrientationPreserving = 1 << 1,
+  };
+
+  /// @brief Vertices referencing each triangle, grouped by vertex in ascending triangle order.
+  struct VertexTriangles
+  {
+    std::vector<uint32> Offsets;
+    std::vector<uint32> Triangles;
+  };
+
+  void runParallel(JobSystem *jobs, uint32 count, const std::function<void(uint32, uint32)> &function)
+  {
+    if (jobs)
+    {
+      jobs->parallelFor(count, TANGENT_GRAIN_SIZE, function);
+    }
+    else if (count > 0)
+    {
+      function(0, count);
+    }
+  }
+
+  VertexTriangles buildVertexTriangles(const uint32 *indices, uint32 indexCount, uint32 vertexCount)
+  {
+    VertexTriangles adjacency;
+    adjacency.Offsets.assign(vertexCount + 1, 0);
+    for (uint32 i = 0; i < indexCount; i++)
+    {
+      adjacency.Offsets[indices[i] + 1]++;
+    }
+    for (uint32 v = 0; v < vertexCount; v++)
+    {
+      adjacency.Offsets[v + 1] += adjacency.Offsets[v];
+    }
+
+    std::vector<uint32> cursor(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+    adjacency.Triangles.resize(indexCount);
+    for (uint32 i = 0; i < indexCount; i++)
+    {
+      adjacency.Triangles[cursor[indices[i]]++] = i / 3;
+    }
+    return adjacency;
+  }
+
+  /// @brief Normalises vec, or returns false and leaves it alone if it is too short to have a direction.
+  bool tryNormalize(Vector3 &vec)
+  {
+    float32 length = std::sqrt(Vector3::Dot(vec, vec));
+    if (!(length > FLT_MIN))
+    {
+      return false;
+    }
+    vec = vec * (1.0f / length);
+    return true;
+  }
+
+  Vector3 projectOnPlane(const Vector3 &vec, const Vector3 &normal)
+  {
+    return vec - normal * Vector3::Dot(normal, vec);
+  }
+
+  /// @brief The tangent of a triangle, dP/du, normalised. Any length is lost once vertices average the tangents
+  /// around them, so only the direction is kept.
+  void computeTriangleTangent(const Vector3 &p0, const Vector3 &p1, const Vector3 &p2, const Vector2 &uv0, const Vector2 &uv1,
+                              const Vector2 &uv2, Vector3 &tangent, uint8 &flags)
+  {
+    Vector3 d1 = p1 - p0;
+    Vector3 d2 = p2 - p0;
+    Vector2 t21 = uv1 - uv0;
+    Vector2 t31 = uv2 - uv0;
+
+    float32 signedArea = t21.X * t31.Y - t21.Y * t31.X;
+    tangent = d1 * t31.Y - d2 * t21.Y;
+    flags = signedArea > 0.0f ? TF_OrientationPreserving : 0;
+    if (std::fabs(signedArea) > FLT_MIN && tryNormalize(tangent))
+    {
+      // Dividing by the signed area rather than its magnitude turns mirrored triangles' tangents back along +u.
+      tangent = signedArea > 0.0f ? tangent : -tangent;
+      flags |= TF_Valid;
+    }
+  }
+
+#if defined(FIDELITY_TANGENT_SSE)
+  struct Vector3x4
+  {
+    __m128 X;
+    __m128 Y;
+    __m128 Z;
+  };
+
+  struct Vector2x4
+  {
+    __m128 X;
+    __m128 Y;
+  };
+
+  /// @brief Loads one corner of four consecutive triangles, one triangle per lane.
+  Vector3x4 loadCorners(const Vector3 *vertices, const uint32 *indices, uint32 triangle, uint32 corner)
+  {
+    const Vector3 &a = vertices[indices[triangle * 3 + corner]];
+    const Vector3 &b = vertices[indices[triangle * 3 + 3 + corner]];
+    const Vector3 &c = vertices[indices[triangle * 3 + 6 + corner]];
+    const Vector3 &d = vertices[indices[triangle * 3 + 9 + corner]];
+    return {_mm_setr_ps(a.X, b.X, c.X, d.X), _mm_setr_ps(a.Y, b.Y, c.Y, d.Y), _mm_setr_ps(a.Z, b.Z, c.Z, d.Z)};
+  }
+
+  Vector2x4 loadCorners(const Vector2 *vertices, const uint32 *indices, uint32 triangle, uint32 corner)
+  {
+    const Vector2 &a = vertices[indices[triangle * 3 + corner]];
+    const Vector2 &b = vertices[indices[triangle * 3 + 3 + corner]];
+    const Vector2 &c = vertices[indices[triangle * 3 + 6 + corner]];
+    const Vector2 &d = vertices[indices[triangle * 3 + 9 + corner]];
+    return {_mm_setr_ps(a.X, b.X, c.X, d.X), _mm_setr_ps(a.Y, b.Y, c.Y, d.Y)};
+  }
+
+  Vector3x4 subtract(const Vector3x4 &a, const Vector3x4 &b)
+  {
+    return {_mm_sub_ps(a.X, b.X), _mm_sub_ps(a.Y, b.Y), _mm_sub_ps(a.Z, b.Z)};
+  }
+
+  void store(const Vector3x4 &vec, Vector3 *destination)
+  {
+    alignas(16) float32 x[4], y[4], z[4];
+    _mm_store_ps(x, vec.X);
+    _mm_store_ps(y, vec.Y);
+    _mm_store_ps(z, vec.Z);
+    for (uint32 i = 0; i < 4; i++)
+    {
+      destination[i] = Vector3(x[i], y[i], z[i]);
+    }
+  }
+#endif
+
+  /// @brief Unnormalised face normals, whose length is twice the triangle's area.
+  void computeFaceNormals(const Vector3 *positions, const uint32 *indices, uint32 begin, uint32 end, Vector3 *faceNormals)
+  {
+    uint32 triangle = begin;
+#if defined(FIDELITY_TANGENT_SSE)
+    for (; triangle + 4 <= end; triangle += 4)
+    {
+      Vector3x4 p0 = loadCorners(positions, indices, triangle, 0);
+      Vector3x4 e1 = subtract(loadCorners(positions, indices, triangle, 1), p0);
+      Vector3x4 e2 = subtract(loadCorners(positions, indices, triangle, 2), p0);
+
+      Vector3x4 normal;
+      normal.X = _mm_sub_ps(_mm_mul_ps(e1.Y, e2.Z), _mm_mul_ps(e1.Z, e2.Y));
+      normal.Y = _mm_sub_ps(_mm_mul_ps(e1.Z, e2.X), _mm_mul_ps(e1.X, e2.Z));
+      normal.Z = _mm_sub_ps(_mm_mul_ps(e1.X, e2.Y), _mm_mul_ps(e1.Y, e2.X));
+      store(normal, faceNormals + triangle);
+    }
+#endif
+    for (; triangle < end; triangle++)
+    {
+      const Vector3 &p0 = positions[indices[triangle * 3]];
+      faceNormals[triangle] = Vector3::Cross(positions[indices[triangle * 3 + 1]] - p0, positions[indices[triangle * 3 + 2]] - p0);
+    }
+  }
+
+  void computeTriangleTangents(const Vector3 *positions, const Vector2 *texCoords, const uint32 *indices, uint32 begin, uint32 end,
+                               Vector3 *tangents, uint8 *flags)
+  {
+    uint32 triangle = begin;
+#if defined(FIDELITY_TANGENT_SSE)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minimum = _mm_set1_ps(FLT_MIN);
+    for (; triangle + 4 <= end; triangle += 4)
+    {
+      Vector3x4 p0 = loadCorners(positions, indices, triangle, 0);
+      Vector3x4 d1 = subtract(loadCorners(positions, indices, triangle, 1), p0);
+      Vector3x4 d2 = subtract(loadCorners(positions, indices, triangle, 2), p0);
+      Vector2x4 uv0 = loadCorners(texCoords, indices, triangle, 0);
+      Vector2x4 uv1 = loadCorners(texCoords, indices, triangle, 1);
+      Vector2x4 uv2 = loadCorners(texCoords, indices, triangle, 2);
+      __m128 t21x = _mm_sub_ps(uv1.X, uv0.X);
+      __m128 t21y = _mm_sub_ps(uv1.Y, uv0.Y);
+      __m128 t31x = _mm_sub_ps(uv2.X, uv0.X);
+      __m128 t31y = _mm_sub_ps(uv2.Y, uv0.Y);
+
+      __m128 signedArea = _mm_sub_ps(_mm_mul_ps(t21x, t31y), _mm_mul_ps(t21y, t31x));
+      Vector3x4 tangent;
+      tangent.X = _mm_sub_ps(_mm_mul_ps(d1.X, t31y), _mm_mul_ps(d2.X, t21y));
+      tangent.Y = _mm_sub_ps(_mm_mul_ps(d1.Y, t31y), _mm_mul_ps(d2.Y, t21y));
+      tangent.Z = _mm_sub_ps(_mm_mul_ps(d1.Z, t31y), _mm_mul_ps(d2.Z, t21y));
+      __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tangent.X, tangent.X), _mm_mul_ps(tangent.Y, tangent.Y)), _mm_mul_ps(tangent.Z, tangent.Z));
+      __m128 length = _mm_sqrt_ps(lengthSq);
+
+      // Scale by sign(area) / length, with lanes too short to normalise flagged invalid below.
+      __m128 sign = _mm_or_ps(_mm_and_ps(signedArea, signMask), one);
+      __m128 scale = _mm_div_ps(sign, _mm_max_ps(length, minimum));
+      tangent.X = _mm_mul_ps(tangent.X, scale);
+      tangent.Y = _mm_mul_ps(tangent.Y, scale);
+      tangent.Z = _mm_mul_ps(tangent.Z, scale);
+      store(tangent, tangents + triangle);
+
+      int32 valid = _mm_movemask_ps(_mm_and_ps(_mm_cmpgt_ps(_mm_andnot_ps(signMask, signedArea), minimum), _mm_cmpgt_ps(length, minimum)));
+      int32 preserving = _mm_movemask_ps(_mm_cmpgt_ps(signedArea, _mm_setzero_ps()));
+      for (uint32 i = 0; i < 4; i++)
+      {
+        flags[triangle + i] = ((valid >> i) & 1 ? TF_Valid : 0) | ((preserving >> i) & 1 ? TF_OrientationPreserving : 0);
+      }
+    }
+#endif
+    for (; triangle < end; triangle++)
+    {
+      const uint32 *corners = indices + triangle * 3;
+      computeTriangleTangent(positions[corners[0]], positions[corners[1]], positions[corners[2]], texCoords[corners[0]], texCoords[corners[1]],
+                             texCoords[corners[2]], tangents[triangle], flags[triangle]);
+    }
+  }
+
+  /// @brief Any unit vector perpendicular to normal, for vertices without a usable tangent of their own.
+  Vector3 getPerpendicular(const Vector3 &normal)
+  {
+    Vector3 axis = std::fabs(normal.X) < 0.9f ? Vector3(1.0f, 0.0f, 0.0f) : Vector3(0.0f, 1.0f, 0.0f);
+    Vector3 tangent = projectOnPlane(axis, normal);
+    return tryNormalize(tangent) ? tangent : axis;
+  }
+}
+
+std::vector<Vector3> TangentSpace::generateNormals(const std::vector<Vector3> &positions, const uint32 *indices, uint32 indexCount,
+                                                   JobSystem *jobs)
+{
+  uint32 vertexCount = static_cast<uint32>(positions.size());
+  uint32 triangleCount = indexCount / 3;
+  std::vector<Vector3> faceNormals(triangleCount);
+  runParallel(jobs, triangleCount, [&](uint32 begin, uint32 end)
+              { computeFaceNormals(positions.data(), indices, begin, end, faceNormals.data()); });
+
+  // Gathering rather than scattering lets each vertex be written by one job alone.
+  VertexTriangles adjacency = buildVertexTriangles(indices, triangleCount * 3, vertexCount);
+  std::vector<Vector3> normals(vertexCount);
+  runParallel(jobs, vertexCount, [&](uint32 begin, uint32 end)
+              {
+                for (uint32 v = begin; v < end; v++)
+                {
+                  Vector3 normal;
+                  for (uint32 i = adjacency.Offsets[v]; i < adjacency.Offsets[v + 1]; i++)
+                  {
+                    normal += faceNormals[adjacency.Triangles[i]];
+                  }
+                  tryNormalize(normal);
+                  normals[v] = normal;
+                } });
+  return normals;
+}
+
+std::vector<Vector4> TangentSpace::generateTangents(const std::vector<Vector3> &positions, const std::vector<Vector3> &normals,
+                                                    const std::vector<Vector2> &texCoords, const uint32 *indices, uint32 indexCount,
+                                                    JobSystem *jobs)
+{
+  uint32 vertexCount = static_cast<uint32>(positions.size());
+  uint32 triangleCount = indexCount / 3;
+  std::vector<Vector3> triangleTangents(triangleCount);
+  std::vector<uint8> triangleFlags(triangleCount);
+  runParallel(jobs, triangleCount, [&](uint32 begin, uint32 end)
+              { computeTriangleTangents(positions.data(), texCoords.data(), indices, begin, end, triangleTangents.data(), triangleFlags.data()); });
+
+  VertexTriangles adjacency = buildVertexTriangles(indices, triangleCount * 3, vertexCount);
+  std::vector<Vector4> tangents(vertexCount);
+  runParallel(jobs, vertexCount, [&](uint32 begin, uint32 end)
+              {
+                for (uint32 v = begin; v < end; v++)
+                {
+                  const Vector3 &normal = normals[v];
+                  // Mirrored and unmirrored triangles are summed apart, a vertex only taking the side covering the
+                  // larger angle. Shared vertices on a mirror seam would otherwise average to nothing.
+                  Vector3 sums[2];
+                  float32 angles[2] = {0.0f, 0.0f};
+                  for (uint32 i = adjacency.Offsets[v]; i < adjacency.Offsets[v + 1]; i++)
+                  {
+                    uint32 triangle = adjacency.Triangles[i];
+                    uint8 flags = triangleFlags[triangle];
+                    Vector3 tangent = projectOnPlane(triangleTangents[triangle], normal);
+                    if (!(flags & TF_Valid) || !tryNormalize(tangent))
+                    {
+                      continue;
+                    }
+
+                    const uint32 *corners = indices + triangle * 3;
+                    uint32 corner = corners[0] == v ? 0 : (corners[1] == v ? 1 : 2);
+                    const Vector3 &position = positions[v];
+                    Vector3 toPrevious = projectOnPlane(positions[corners[(corner + 2) % 3]] - position, normal);
+                    Vector3 toNext = projectOnPlane(positions[corners[(corner + 1) % 3]] - position, normal);
+                    float32 angle = 0.0f;
+                    if (tryNormalize(toPrevious) && tryNormalize(toNext))
+                    {
+                      angle = std::acos(std::min(std::max(Vector3::Dot(toPrevious, toNext), -1.0f), 1.0f));
+                    }
+
+                    uint32 side = flags & TF_OrientationPreserving ? 1 : 0;
+                    sums[side] += tangent * angle;
+                    angles[side] += angle;
+                  }
+
+                  uint32 side = angles[1] >= angles[0] ? 1 : 0;
+                  Vector3 tangent = sums[side];
+                  if (!tryNormalize(tangent))
+                  {
+                    tangent = getPerpendicular(normal);
+                    side = 1;
+                  }
+                  tangents[v] = Vector4(tangent, side ? 1.0f : -1.0f);
+                } });
+  return tangents;
+}
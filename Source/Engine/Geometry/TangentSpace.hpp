@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Maths.h"
+#include "../Core/Types.hpp"
+
+class JobSystem;
+
+/// @brief Bumped whenever generated normals or tangents change, so that cached bakes of the old output are not reused.
+constexpr uint32 TANGENT_SPACE_VERSION = 1;
+
+/// @brief Builds per vertex normals and tangent frames for indexed triangle lists. Triangles are set up in parallel
+/// chunks, after which each vertex gathers the triangles around it in index order, so the result is the same however
+/// the work was split.
+class TangentSpace
+{
+public:
+  /// @brief Area weighted vertex normals. Vertices no triangle references get a zero normal.
+  /// @param jobs If given, both passes are split across its workers.
+  static std::vector<Vector3> generateNormals(const std::vector<Vector3> &positions, const uint32 *indices, uint32 indexCount,
+                                              JobSystem *jobs = nullptr);
+
+  /// @brief Tangents following MikkTSpace (Mikkelsen 2008), so that normal maps baked against it shade without seams.
+  /// Each triangle's tangent is projected onto the vertex normal and weighted by the angle of its corner, with mirrored
+  /// triangles kept apart from the rest. W holds the handedness, the bitangent being W * cross(normal, tangent).
+  /// Triangles with degenerate texture coordinates are skipped, and vertices only they reference get any tangent
+  /// perpendicular to their normal.
+  static std::vector<Vector4> generateTangents(const std::vector<Vector3> &positions, const std::vector<Vector3> &normals,
+                                               const std::vector<Vector2> &texCoords, const uint32 *indices, uint32 indexCount,
+                                               JobSystem *jobs = nullptr);
+};
@@ -0,0 +1,449 @@
+#include "BlockCompression.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+  // Weight of the first endpoint for each BC1 index, in four colour mode.
+  const float32 BC1_ENDPOINT_WEIGHTS[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+  const uint32 BC1_REFINE_ITERATIONS = 2;
+
+  uint16 packColour565(const float32 *colour)
+  {
+    auto quantize = [](float32 value, float32 maximum)
+    {
+      return static_cast<uint16>(std::round(std::min(std::max(value, 0.0f), 255.0f) * maximum / 255.0f));
+    };
+    return static_cast<uint16>((quantize(colour[0], 31.0f) << 11) | (quantize(colour[1], 63.0f) << 5) | quantize(colour[2], 31.0f));
+  }
+
+  void unpackColour565(uint16 packed, int32 *colour)
+  {
+    int32 r = (packed >> 11) & 31;
+    int32 g = (packed >> 5) & 63;
+    int32 b = packed & 31;
+    colour[0] = (r << 3) | (r >> 2);
+    colour[1] = (g << 2) | (g >> 4);
+    colour[2] = (b << 3) | (b >> 2);
+  }
+
+  void buildBC1Palette(uint16 colour0, uint16 colour1, int32 palette[4][3])
+  {
+    unpackColour565(colour0, palette[0]);
+    unpackColour565(colour1, palette[1]);
+    for (uint32 c = 0; c < 3; c++)
+    {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+  }
+
+  /// @brief Picks the closest palette entry for each pixel, returning the packed indices and the summed squared error.
+  uint32 chooseBC1Indices(const ubyte *rgba, uint16 colour0, uint16 colour1, uint32 &error)
+  {
+    int32 palette[4][3];
+    buildBC1Palette(colour0, colour1, palette);
+
+    uint32 indices = 0;
+    error = 0;
+    for (uint32 i = 0; i < 16; i++)
+    {
+      uint32 bestIndex = 0;
+      uint32 bestError = UINT32_MAX;
+      for (uint32 p = 0; p < 4; p++)
+      {
+        int32 dr = rgba[i * 4] - palette[p][0];
+        int32 dg = rgba[i * 4 + 1] - palette[p][1];
+        int32 db = rgba[i * 4 + 2] - palette[p][2];
+        uint32 distance = static_cast<uint32>(dr * dr + dg * dg + db * db);
+        if (distance < bestError)
+        {
+          bestError = distance;
+          bestIndex = p;
+        }
+      }
+      indices |= bestIndex << (i * 2);
+      error += bestError;
+    }
+    return indices;
+  }
+
+  /// @brief Solves for the endpoints which best reproduce the block given a fixed set of indices.
+  bool refineBC1Endpoints(const ubyte *rgba, uint32 indices, uint16 &colour0, uint16 &colour1)
+  {
+    float32 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float32 ap[3] = {0.0f, 0.0f, 0.0f};
+    float32 bp[3] = {0.0f, 0.0f, 0.0f};
+    for (uint32 i = 0; i < 16; i++)
+    {
+      float32 a = BC1_ENDPOINT_WEIGHTS[(indices >> (i * 2)) & 3];
+      float32 b = 1.0f - a;
+      aa += a * a;
+      ab += a * b;
+      bb += b * b;
+      for (uint32 c = 0; c < 3; c++)
+      {
+        ap[c] += a * rgba[i * 4 + c];
+        bp[c] += b * rgba[i * 4 + c];
+      }
+    }
+
+    float32 determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f)
+    {
+      return false;
+    }
+
+    float32 endpoint0[3];
+    float32 endpoint1[3];
+    for (uint32 c = 0; c < 3; c++)
+    {
+      endpoint0[c] = (ap[c] * bb - bp[c] * ab) / determinant;
+      endpoint1[c] = (bp[c] * aa - ap[c] * ab) / determinant;
+    }
+    colour0 = packColour565(endpoint0);
+    colour1 = packColour565(endpoint1);
+    return true;
+  }
+
+  void writeBC1Block(uint16 colour0, uint16 colour1, uint32 indices, ubyte *block)
+  {
+    // Four colour mode requires colour0 > colour1, swapping the endpoints swaps index 0 with 1 and 2 with 3.
+    if (colour0 < colour1)
+    {
+      std::swap(colour0, colour1);
+      indices ^= 0x55555555;
+    }
+    else if (colour0 == colour1)
+    {
+      indices = 0;
+    }
+
+    block[0] = static_cast<ubyte>(colour0 & 0xff);
+    block[1] = static_cast<ubyte>(colour0 >> 8);
+    block[2] = static_cast<ubyte>(colour1 & 0xff);
+    block[3] = static_cast<ubyte>(colour1 >> 8);
+    for (uint32 i = 0; i < 4; i++)
+    {
+      block[4 + i] = static_cast<ubyte>((indices >> (i * 8)) & 0xff);
+    }
+  }
+
+  void buildBC4Palette(uint32 red0, uint32 red1, uint32 palette[8])
+  {
+    palette[0] = red0;
+    palette[1] = red1;
+    if (red0 > red1)
+    {
+      for (uint32 i = 2; i < 8; i++)
+      {
+        palette[i] = ((8 - i) * red0 + (i - 1) * red1 + 3) / 7;
+      }
+    }
+    else
+    {
+      for (uint32 i = 2; i < 6; i++)
+      {
+        palette[i] = ((6 - i) * red0 + (i - 1) * red1 + 2) / 5;
+      }
+      palette[6] = 0;
+      palette[7] = 255;
+    }
+  }
+
+  void gatherBlock(const ImageData &image, uint32 blockX, uint32 blockY, ubyte *rgba)
+  {
+    uint32 width = image.getWidth();
+    uint32 height = image.getHeight();
+    uint32 bytesPerPixel = image.getBytesPerPixel();
+    const ubyte *pixels = image.getPixelData().data();
+    for (uint32 y = 0; y < 4; y++)
+    {
+      uint32 sourceY = std::min(blockY * 4 + y, height - 1);
+      for (uint32 x = 0; x < 4; x++)
+      {
+        uint32 sourceX = std::min(blockX * 4 + x, width - 1);
+        const ubyte *pixel = pixels + (static_cast<uint64>(sourceY) * width + sourceX) * bytesPerPixel;
+        ubyte *destination = rgba + (y * 4 + x) * 4;
+        for (uint32 c = 0; c < 4; c++)
+        {
+          destination[c] = c < bytesPerPixel ? pixel[c] : (c == 3 ? 255 : 0);
+        }
+      }
+    }
+  }
+
+  void extractChannel(const ubyte *rgba, uint32 channel, ubyte *values)
+  {
+    for (uint32 i = 0; i < 16; i++)
+    {
+      values[i] = rgba[i * 4 + channel];
+    }
+  }
+}
+
+std::vector<ubyte> BlockCompression::compress(const ImageData &image, TextureFormat format)
+{
+  if (format != TextureFormat::BC1 && format != TextureFormat::BC3 && format != TextureFormat::BC4 && format != TextureFormat::BC5)
+  {
+    throw std::runtime_error("Only BC1, BC3, BC4 and BC5 can be encoded");
+  }
+
+  uint32 blocksWide = (image.getWidth() + 3) / 4;
+  uint32 blocksHigh = (image.getHeight() + 3) / 4;
+  uint32 blockBytes = Texture::getBlockBytes(format);
+  std::vector<ubyte> output(static_cast<uint64>(blocksWide) * blocksHigh * blockBytes);
+
+  ubyte rgba[64];
+  ubyte red[16];
+  ubyte green[16];
+  for (uint32 blockY = 0; blockY < blocksHigh; blockY++)
+  {
+    for (uint32 blockX = 0; blockX < blocksWide; blockX++)
+    {
+      gatherBlock(image, blockX, blockY, rgba);
+      ubyte *block = output.data() + (static_cast<uint64>(blockY) * blocksWide + blockX) * blockBytes;
+      switch (format)
+      {
+      case TextureFormat::BC1:
+        encodeBC1(rgba, block);
+        break;
+      case TextureFormat::BC3:
+        encodeBC3(rgba, block);
+        break;
+      case TextureFormat::BC4:
+        extractChannel(rgba, 0, red);
+        encodeBC4(red, block);
+        break;
+      default:
+        extractChannel(rgba, 0, red);
+        extractChannel(rgba, 1, green);
+        encodeBC5(red, green, block);
+        break;
+      }
+    }
+  }
+  return output;
+}
+
+void BlockCompression::encodeBC1(const ubyte *rgba, ubyte *block)
+{
+  float32 mean[3] = {0.0f, 0.0f, 0.0f};
+  float32 minimum[3] = {255.0f, 255.0f, 255.0f};
+  float32 maximum[3] = {0.0f, 0.0f, 0.0f};
+  for (uint32 i = 0; i < 16; i++)
+  {
+    for (uint32 c = 0; c < 3; c++)
+    {
+      float32 value = rgba[i * 4 + c];
+      mean[c] += value / 16.0f;
+      minimum[c] = std::min(minimum[c], value);
+      maximum[c] = std::max(maximum[c], value);
+    }
+  }
+
+  if (minimum[0] == maximum[0] && minimum[1] == maximum[1] && minimum[2] == maximum[2])
+  {
+    uint16 colour = packColour565(mean);
+    writeBC1Block(colour, colour, 0, block);
+    return;
+  }
+
+  float32 covariance[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  for (uint32 i = 0; i < 16; i++)
+  {
+    float32 r = rgba[i * 4] - mean[0];
+    float32 g = rgba[i * 4 + 1] - mean[1];
+    float32 b = rgba[i * 4 + 2] - mean[2];
+    covariance[0] += r * r;
+    covariance[1] += r * g;
+    covariance[2] += r * b;
+    covariance[3] += g * g;
+    covariance[4] += g * b;
+    covariance[5] += b * b;
+  }
+
+  // Power iteration for the principal axis. Seeded with the covariance row of the widest channel, which unlike the
+  // bounding box diagonal keeps the sign of anti correlated channels.
+  float32 axis[3] = {covariance[0], covariance[1], covariance[2]};
+  if (covariance[3] >= covariance[0] && covariance[3] >= covariance[5])
+  {
+    axis[0] = covariance[1];
+    axis[1] = covariance[3];
+    axis[2] = covariance[4];
+  }
+  else if (covariance[5] >= covariance[0])
+  {
+    axis[0] = covariance[2];
+    axis[1] = covariance[4];
+    axis[2] = covariance[5];
+  }
+  for (uint32 iteration = 0; iteration < 4; iteration++)
+  {
+    float32 next[3] = {covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+                       covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+                       covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2]};
+    float32 length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+    if (length < 1e-6f)
+    {
+      break;
+    }
+    for (uint32 c = 0; c < 3; c++)
+    {
+      axis[c] = next[c] / length;
+    }
+  }
+  float32 axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+  float32 minProjection = FLT_MAX;
+  float32 maxProjection = -FLT_MAX;
+  for (uint32 i = 0; i < 16; i++)
+  {
+    float32 projection = ((rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] + (rgba[i * 4 + 2] - mean[2]) * axis[2]) / axisLengthSquared;
+    minProjection = std::min(minProjection, projection);
+    maxProjection = std::max(maxProjection, projection);
+  }
+
+  float32 endpoint0[3];
+  float32 endpoint1[3];
+  for (uint32 c = 0; c < 3; c++)
+  {
+    endpoint0[c] = mean[c] + axis[c] * maxProjection;
+    endpoint1[c] = mean[c] + axis[c] * minProjection;
+  }
+
+  uint16 colour0 = packColour565(endpoint0);
+  uint16 colour1 = packColour565(endpoint1);
+  uint32 error = 0;
+  uint32 indices = chooseBC1Indices(rgba, colour0, colour1, error);
+
+  for (uint32 iteration = 0; iteration < BC1_REFINE_ITERATIONS && error > 0; iteration++)
+  {
+    uint16 refined0 = colour0;
+    uint16 refined1 = colour1;
+    if (!refineBC1Endpoints(rgba, indices, refined0, refined1))
+    {
+      break;
+    }
+
+    uint32 refinedError = 0;
+    uint32 refinedIndices = chooseBC1Indices(rgba, refined0, refined1, refinedError);
+    if (refinedError >= error)
+    {
+      break;
+    }
+    colour0 = refined0;
+    colour1 = refined1;
+    indices = refinedIndices;
+    error = refinedError;
+  }
+
+  writeBC1Block(colour0, colour1, indices, block);
+}
+
+void BlockCompression::encodeBC3(const ubyte *rgba, ubyte *block)
+{
+  ubyte alpha[16];
+  extractChannel(rgba, 3, alpha);
+  encodeBC4(alpha, block);
+  encodeBC1(rgba, block + 8);
+}
+
+void BlockCompression::encodeBC4(const ubyte *values, ubyte *block)
+{
+  uint32 minimum = 255;
+  uint32 maximum = 0;
+  for (uint32 i = 0; i < 16; i++)
+  {
+    minimum = std::min<uint32>(minimum, values[i]);
+    maximum = std::max<uint32>(maximum, values[i]);
+  }
+
+  // Eight value mode, which interpolates across the full range of the block.
+  uint32 palette[8];
+  buildBC4Palette(maximum, minimum, palette);
+
+  uint64 indices = 0;
+  if (maximum != minimum)
+  {
+    for (uint32 i = 0; i < 16; i++)
+    {
+      uint32 bestIndex = 0;
+      uint32 bestError = UINT32_MAX;
+      for (uint32 p = 0; p < 8; p++)
+      {
+        uint32 distance = static_cast<uint32>(std::abs(static_cast<int32>(values[i]) - static_cast<int32>(palette[p])));
+        if (distance < bestError)
+        {
+          bestError = distance;
+          bestIndex = p;
+        }
+      }
+      indices |= static_cast<uint64>(bestIndex) << (i * 3);
+    }
+  }
+
+  block[0] = static_cast<ubyte>(maximum);
+  block[1] = static_cast<ubyte>(minimum);
+  for (uint32 i = 0; i < 6; i++)
+  {
+    block[2 + i] = static_cast<ubyte>((indices >> (i * 8)) & 0xff);
+  }
+}
+
+void BlockCompression::encodeBC5(const ubyte *red, const ubyte *green, ubyte *block)
+{
+  encodeBC4(red, block);
+  encodeBC4(green, block + 8);
+}
+
+void BlockCompression::decodeBC1(const ubyte *block, ubyte *rgba)
+{
+  uint16 colour0 = static_cast<uint16>(block[0] | (block[1] << 8));
+  uint16 colour1 = static_cast<uint16>(block[2] | (block[3] << 8));
+  int32 palette[4][3];
+  buildBC1Palette(colour0, colour1, palette);
+  if (colour0 <= colour1)
+  {
+    // Three colour mode, index 3 is transparent black.
+    int32 colours[2][3];
+    unpackColour565(colour0, colours[0]);
+    unpackColour565(colour1, colours[1]);
+    for (uint32 c = 0; c < 3; c++)
+    {
+      palette[2][c] = (colours[0][c] + colours[1][c]) / 2;
+      palette[3][c] = 0;
+    }
+  }
+
+  uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32>(block[7]) << 24);
+  for (uint32 i = 0; i < 16; i++)
+  {
+    uint32 index = (indices >> (i * 2)) & 3;
+    for (uint32 c = 0; c < 3; c++)
+    {
+      rgba[i * 4 + c] = static_cast<ubyte>(palette[index][c]);
+    }
+    rgba[i * 4 + 3] = colour0 <= colour1 && index == 3 ? 0 : 255;
+  }
+}
+
+void BlockCompression::decodeBC4(const ubyte *block, ubyte *values)
+{
+  uint32 palette[8];
+  buildBC4Palette(block[0], block[1], palette);
+
+  uint64 indices = 0;
+  for (uint32 i = 0; i < 6; i++)
+  {
+    indices |= static_cast<uint64>(block[2 + i]) << (i * 8);
+  }
+  for (uint32 i = 0; i < 16; i++)
+  {
+    values[i] = static_cast<ubyte>(palette[(indices >> (i * 3)) & 7]);
+  }
+}
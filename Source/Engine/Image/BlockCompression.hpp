@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Types.hpp"
+#include "../RenderApi/Texture.hpp"
+#include "ImageData.hpp"
+
+/// @brief CPU encoders for the BCn formats. Colour endpoints are fitted along the principal axis of each block and then
+/// refined by least squares against the chosen indices.
+class BlockCompression
+{
+public:
+  /// @brief Encodes an image as rows of 4x4 blocks. Supports BC1, BC3, BC4 and BC5, blocks overhanging the edge of the
+  /// image repeat its last row and column.
+  static std::vector<ubyte> compress(const ImageData &image, TextureFormat format);
+
+  /// @param rgba 16 pixels of 4 bytes each, in rows. Alpha is ignored.
+  static void encodeBC1(const ubyte *rgba, ubyte *block);
+  static void encodeBC3(const ubyte *rgba, ubyte *block);
+  /// @param values 16 single channel pixels, in rows.
+  static void encodeBC4(const ubyte *values, ubyte *block);
+  static void encodeBC5(const ubyte *red, const ubyte *green, ubyte *block);
+
+  /// @brief Writes 16 RGBA pixels, with alpha set to 255.
+  static void decodeBC1(const ubyte *block, ubyte *rgba);
+  static void decodeBC4(const ubyte *block, ubyte *values);
+};
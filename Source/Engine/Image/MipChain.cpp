@@ -0,0 +1,250 @@
+#include "MipChain.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../Core/JobSystem.h"
+#include "../Maths/Math.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FIDELITY_MIP_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+  // Output rows per job when a level is split across a JobSystem.
+  constexpr uint32 MIP_ROW_GRAIN_SIZE = 16;
+  constexpr float64 KAISER_ALPHA = 4.0;
+  // Half width of the Kaiser window in pixels of the level above.
+  constexpr float64 KAISER_RADIUS = 3.0;
+
+  /// @brief Taps shared by every destination pixel along one axis. Destination pixel x reads source pixels from
+  /// 2 * x + FirstOffset onwards.
+  struct MipKernel
+  {
+    int32 FirstOffset;
+    std::vector<float32> Weights;
+  };
+
+  struct TransferTables
+  {
+    // Both tables work in 0 to 255 so linear channels skip any scaling.
+    float32 Identity[256];
+    float32 SRgbToLinear[256];
+    // Linear value at which each sRGB byte rounds up to the next, so encoding is a binary search that rounds exactly.
+    float32 SRgbThresholds[255];
+  };
+
+  float64 besselI0(float64 x)
+  {
+    float64 sum = 1.0;
+    float64 term = 1.0;
+    for (uint32 k = 1; k < 20; k++)
+    {
+      float64 factor = x / (2.0 * k);
+      term *= factor * factor;
+      sum += term;
+    }
+    return sum;
+  }
+
+  float64 decodeSRgb(float64 value)
+  {
+    return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+  }
+
+  MipKernel createKaiserKernel()
+  {
+    MipKernel kernel{-2, std::vector<float32>(6)};
+    std::vector<float64> weights(kernel.Weights.size());
+    float64 total = 0.0;
+    for (uint32 i = 0; i < weights.size(); i++)
+    {
+      // Distance from the destination pixel centre, in source pixels.
+      float64 distance = kernel.FirstOffset + static_cast<int32>(i) - 0.5;
+      float64 x = distance * 0.5 * Math::Pi;
+      float64 sinc = x == 0.0 ? 1.0 : std::sin(x) / x;
+      float64 t = distance / KAISER_RADIUS;
+      float64 window = besselI0(KAISER_ALPHA * std::sqrt(std::max(1.0 - t * t, 0.0))) / besselI0(KAISER_ALPHA);
+      weights[i] = sinc * window;
+      total += weights[i];
+    }
+    for (uint32 i = 0; i < weights.size(); i++)
+    {
+      kernel.Weights[i] = static_cast<float32>(weights[i] / total);
+    }
+    return kernel;
+  }
+
+  const MipKernel &getKernel(MipFilter filter)
+  {
+    static const MipKernel box{0, {0.5f, 0.5f}};
+    static const MipKernel kaiser = createKaiserKernel();
+    return filter == MipFilter::Kaiser ? kaiser : box;
+  }
+
+  TransferTables createTransferTables()
+  {
+    TransferTables tables;
+    for (uint32 i = 0; i < 256; i++)
+    {
+      tables.Identity[i] = static_cast<float32>(i);
+      tables.SRgbToLinear[i] = static_cast<float32>(decodeSRgb(i / 255.0) * 255.0);
+    }
+    for (uint32 i = 0; i < 255; i++)
+    {
+      tables.SRgbThresholds[i] = static_cast<float32>(decodeSRgb((i + 0.5) / 255.0) * 255.0);
+    }
+    return tables;
+  }
+
+  const TransferTables &getTransferTables()
+  {
+    static const TransferTables tables = createTransferTables();
+    return tables;
+  }
+
+  ubyte encodeLinear(float32 value)
+  {
+    return static_cast<ubyte>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+  }
+
+  ubyte encodeSRgb(const TransferTables &tables, float32 value)
+  {
+    return static_cast<ubyte>(std::upper_bound(tables.SRgbThresholds, tables.SRgbThresholds + 255, value) - tables.SRgbThresholds);
+  }
+
+  /// @brief destination += source * weight, over count floats.
+  void accumulate(float32 *destination, const float32 *source, float32 weight, uint32 count)
+  {
+    uint32 i = 0;
+#if defined(FIDELITY_MIP_SSE)
+    __m128 weights = _mm_set1_ps(weight);
+    for (; i + 4 <= count; i += 4)
+    {
+      _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(_mm_loadu_ps(source + i), weights)));
+    }
+#endif
+    for (; i < count; i++)
+    {
+      destination[i] += source[i] * weight;
+    }
+  }
+
+  /// @brief Filters one decoded row of the level above down to the width of the level below.
+  void filterRow(const MipKernel &kernel, const float32 *row, uint32 width, uint32 channels, float32 *destination, uint32 mipWidth)
+  {
+    uint32 tapCount = static_cast<uint32>(kernel.Weights.size());
+    for (uint32 x = 0; x < mipWidth; x++)
+    {
+      int32 first = static_cast<int32>(x * 2) + kernel.FirstOffset;
+      float32 *pixel = destination + x * channels;
+#if defined(FIDELITY_MIP_SSE)
+      if (channels == 4)
+      {
+        __m128 sum = _mm_setzero_ps();
+        for (uint32 t = 0; t < tapCount; t++)
+        {
+          uint32 sourceX = static_cast<uint32>(std::min(std::max(first + static_cast<int32>(t), 0), static_cast<int32>(width) - 1));
+          sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(row + sourceX * 4), _mm_set1_ps(kernel.Weights[t])));
+        }
+        _mm_storeu_ps(pixel, sum);
+        continue;
+      }
+#endif
+      std::fill(pixel, pixel + channels, 0.0f);
+      for (uint32 t = 0; t < tapCount; t++)
+      {
+        uint32 sourceX = static_cast<uint32>(std::min(std::max(first + static_cast<int32>(t), 0), static_cast<int32>(width) - 1));
+        for (uint32 c = 0; c < channels; c++)
+        {
+          pixel[c] += row[sourceX * channels + c] * kernel.Weights[t];
+        }
+      }
+    }
+  }
+}
+
+std::vector<std::shared_ptr<ImageData>> MipChain::generate(const std::shared_ptr<ImageData> &image, const MipChainDesc &desc)
+{
+  std::vector<std::shared_ptr<ImageData>> levels{image};
+  while (levels.back()->getWidth() > 1 || levels.back()->getHeight() > 1)
+  {
+    levels.push_back(downsample(*levels.back(), desc));
+  }
+  return levels;
+}
+
+std::shared_ptr<ImageData> MipChain::downsample(const ImageData &image, const MipChainDesc &desc)
+{
+  uint32 width = image.getWidth();
+  uint32 height = image.getHeight();
+  uint32 mipWidth = std::max(width / 2, 1u);
+  uint32 mipHeight = std::max(height / 2, 1u);
+  uint32 channels = image.getBytesPerPixel();
+  uint32 mipRowSize = mipWidth * channels;
+
+  const MipKernel &kernel = getKernel(desc.Filter);
+  const TransferTables &tables = getTransferTables();
+  // Every channel is colour apart from the alpha of RGBA images.
+  bool sRgbChannel[4];
+  const float32 *decodeTables[4];
+  for (uint32 c = 0; c < channels; c++)
+  {
+    sRgbChannel[c] = desc.SRgb && c < 3;
+    decodeTables[c] = sRgbChannel[c] ? tables.SRgbToLinear : tables.Identity;
+  }
+
+  const auto &source = image.getPixelData();
+  std::vector<ubyte> pixels(static_cast<uint64>(mipRowSize) * mipHeight);
+  auto downsampleRows = [&](uint32 begin, uint32 end)
+  {
+    // Horizontally filtered copies of every source row read by this range of destination rows, so rows shared by
+    // neighbouring destination rows are only filtered once.
+    int32 firstRow = static_cast<int32>(begin * 2) + kernel.FirstOffset;
+    int32 lastRow = static_cast<int32>((end - 1) * 2) + kernel.FirstOffset + static_cast<int32>(kernel.Weights.size()) - 1;
+    std::vector<float32> filteredRows(static_cast<uint64>(lastRow - firstRow + 1) * mipRowSize);
+    std::vector<float32> decodedRow(static_cast<uint64>(width) * channels);
+    for (int32 row = firstRow; row <= lastRow; row++)
+    {
+      uint32 sourceY = static_cast<uint32>(std::min(std::max(row, 0), static_cast<int32>(height) - 1));
+      const ubyte *sourceRow = source.data() + static_cast<uint64>(sourceY) * width * channels;
+      for (uint32 i = 0; i < width * channels; i++)
+      {
+        decodedRow[i] = decodeTables[i % channels][sourceRow[i]];
+      }
+      filterRow(kernel, decodedRow.data(), width, channels, filteredRows.data() + static_cast<uint64>(row - firstRow) * mipRowSize, mipWidth);
+    }
+
+    std::vector<float32> mipRow(mipRowSize);
+    for (uint32 y = begin; y < end; y++)
+    {
+      std::fill(mipRow.begin(), mipRow.end(), 0.0f);
+      int32 rowOffset = static_cast<int32>(y * 2) + kernel.FirstOffset - firstRow;
+      for (uint32 t = 0; t < kernel.Weights.size(); t++)
+      {
+        accumulate(mipRow.data(), filteredRows.data() + static_cast<uint64>(rowOffset + t) * mipRowSize, kernel.Weights[t], mipRowSize);
+      }
+
+      ubyte *destination = pixels.data() + static_cast<uint64>(y) * mipRowSize;
+      for (uint32 i = 0; i < mipRowSize; i++)
+      {
+        destination[i] = sRgbChannel[i % channels] ? encodeSRgb(tables, mipRow[i]) : encodeLinear(mipRow[i]);
+      }
+    }
+  };
+
+  if (desc.Jobs)
+  {
+    desc.Jobs->parallelFor(mipHeight, MIP_ROW_GRAIN_SIZE, downsampleRows);
+  }
+  else
+  {
+    downsampleRows(0, mipHeight);
+  }
+
+  std::shared_ptr<ImageData> mip(new ImageData(mipWidth, mipHeight, 1, image.getFormat()));
+  mip->writeData(pixels);
+  return mip;
+}
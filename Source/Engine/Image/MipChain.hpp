@@ -0,0 +1,36 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "ImageData.hpp"
+
+class JobSystem;
+
+enum class MipFilter
+{
+  /// Average of each 2x2 quad of the level above.
+  Box,
+  /// Kaiser windowed sinc over 6x6 pixels of the level above. Keeps smaller levels sharper than Box at the cost of
+  /// slight ringing around hard edges.
+  Kaiser
+};
+
+struct MipChainDesc
+{
+  MipFilter Filter = MipFilter::Box;
+  /// @brief Filters colour channels in linear space, decoding them from sRGB first and encoding the result again.
+  /// Alpha is always filtered as stored.
+  bool SRgb = false;
+  /// @brief When set, the rows of each level are split across the pool. Otherwise the calling thread does all of the work.
+  JobSystem *Jobs = nullptr;
+};
+
+class MipChain
+{
+public:
+  /// @brief Builds every mip level of a 2D image down to 1x1 on the CPU, starting with the image itself.
+  static std::vector<std::shared_ptr<ImageData>> generate(const std::shared_ptr<ImageData> &image, const MipChainDesc &desc = MipChainDesc());
+
+  /// @brief Halves each dimension, rounding down. Filter taps past the edge of the image repeat its last row or column.
+  static std::shared_ptr<ImageData> downsample(const ImageData &image, const MipChainDesc &desc = MipChainDesc());
+};
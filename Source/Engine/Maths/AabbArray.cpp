@@ -0,0 +1,42 @@
+#include "AabbArray.hpp"
+
+#include "AABB.hpp"
+
+AabbArray::AabbArray()
+{
+}
+
+uint32 AabbArray::add(const Aabb &aabb)
+{
+	uint32 index = size();
+	_centerX.push_back(0.0f);
+	_centerY.push_back(0.0f);
+	_centerZ.push_back(0.0f);
+	_extentX.push_back(0.0f);
+	_extentY.push_back(0.0f);
+	_extentZ.push_back(0.0f);
+	set(index, aabb);
+	return index;
+}
+
+void AabbArray::set(uint32 index, const Aabb &aabb)
+{
+	Vector3 center(aabb.getCenter());
+	Vector3 extents(aabb.getExtents());
+	_centerX[index] = center.X;
+	_centerY[index] = center.Y;
+	_centerZ[index] = center.Z;
+	_extentX[index] = extents.X;
+	_extentY[index] = extents.Y;
+	_extentZ[index] = extents.Z;
+}
+
+void AabbArray::clear()
+{
+	_centerX.clear();
+	_centerY.clear();
+	_centerZ.clear();
+	_extentX.clear();
+	_extentY.clear();
+	_extentZ.clear();
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Types.hpp"
+
+class Aabb;
+
+/// @brief Stores world space AABBs as separate center and extent arrays so that several boxes can be tested at once
+/// with SIMD instructions.
+class AabbArray
+{
+public:
+	AabbArray();
+
+	/// @brief Appends a box.
+	/// @return The index of the box within the array.
+	uint32 add(const Aabb &aabb);
+	void set(uint32 index, const Aabb &aabb);
+	void clear();
+
+	uint32 size() const { return static_cast<uint32>(_centerX.size()); }
+
+	const float32 *getCenterX() const { return _centerX.data(); }
+	const float32 *getCenterY() const { return _centerY.data(); }
+	const float32 *getCenterZ() const { return _centerZ.data(); }
+	const float32 *getExtentX() const { return _extentX.data(); }
+	const float32 *getExtentY() const { return _extentY.data(); }
+	const float32 *getExtentZ() const { return _extentZ.data(); }
+
+private:
+	std::vector<float32> _centerX;
+	std::vector<float32> _centerY;
+	std::vector<float32> _centerZ;
+	std::vector<float32> _extentX;
+	std::vector<float32> _extentY;
+	std::vector<float32> _extentZ;
+};
@@ -2,8 +2,18 @@
 
 #include "../Core/Transform.h"
 #include "../Rendering/Camera.h"
+#include "AabbArray.hpp"
 #include "Math.hpp"
 
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FIDELITY_FRUSTRUM_SSE
+#include <emmintrin.h>
+#endif
+
 Frustrum::Frustrum()
 {
 }
@@ -53,6 +63,11 @@ Frustrum::Frustrum(const Camera &camera)
 	_right = Plane(normal, position);
 }
 
+Frustrum::Frustrum(const Plane &nearPlane, const Plane &farPlane, const Plane &left, const Plane &right, const Plane &top, const Plane &bottom)
+		: _left(left), _right(right), _top(top), _bottom(bottom), _far(farPlane), _near(nearPlane)
+{
+}
+
 bool Frustrum::contains(const Aabb &aabb, const Transform &transform) const
 {
 	Vector3 extents(aabb.getExtents());
@@ -80,4 +95,156 @@ bool Frustrum::contains(const Aabb &aabb, const Transform &transform) const
 				 globalAabb.isOnOrForwardPlane(_left) &&
 				 globalAabb.isOnOrForwardPlane(_top) &&
 				 globalAabb.isOnOrForwardPlane(_bottom);
-}
\ No newline at end of file
+}
+
+FrustrumIntersection Frustrum::intersects(const Aabb &globalAabb, uint32 &planeMask) const
+{
+	const Plane *planes[6]{&_near, &_far, &_right, &_left, &_top, &_bottom};
+
+	Vector3 center(globalAabb.getCenter());
+	Vector3 extents(globalAabb.getExtents());
+	for (uint32 i = 0; i < 6; i++)
+	{
+		uint32 planeBit = 1 << i;
+		if ((planeMask & planeBit) == 0)
+		{
+			continue;
+		}
+
+		Vector3 normal(planes[i]->getNormal());
+		float32 distance = planes[i]->getSignedDistance(center);
+		float32 radius = std::abs(normal.X) * extents.X + std::abs(normal.Y) * extents.Y + std::abs(normal.Z) * extents.Z;
+
+		// Matches Aabb::isOnOrForwardPlane, a box only touching the plane is outside.
+		if (distance + radius <= 0.0f)
+		{
+			return FrustrumIntersection::Outside;
+		}
+		if (distance - radius > 0.0f)
+		{
+			planeMask &= ~planeBit;
+		}
+	}
+	return planeMask == 0 ? FrustrumIntersection::Inside : FrustrumIntersection::Intersecting;
+}
+
+void Frustrum::cull(const AabbArray &bounds, std::vector<uint32> &visibleIndices) const
+{
+	cull(bounds, 0, bounds.size(), visibleIndices);
+}
+
+void Frustrum::cull(const AabbArray &bounds, uint32 begin, uint32 end, std::vector<uint32> &visibleIndices) const
+{
+	const Plane *planes[6]{&_near, &_far, &_right, &_left, &_top, &_bottom};
+	float32 normalX[6], normalY[6], normalZ[6], absNormalX[6], absNormalY[6], absNormalZ[6], d[6];
+	for (uint32 i = 0; i < 6; i++)
+	{
+		Vector3 normal(planes[i]->getNormal());
+		normalX[i] = normal.X;
+		normalY[i] = normal.Y;
+		normalZ[i] = normal.Z;
+		absNormalX[i] = std::abs(normal.X);
+		absNormalY[i] = std::abs(normal.Y);
+		absNormalZ[i] = std::abs(normal.Z);
+		d[i] = planes[i]->getD();
+	}
+
+	const float32 *centerX = bounds.getCenterX();
+	const float32 *centerY = bounds.getCenterY();
+	const float32 *centerZ = bounds.getCenterZ();
+	const float32 *extentX = bounds.getExtentX();
+	const float32 *extentY = bounds.getExtentY();
+	const float32 *extentZ = bounds.getExtentZ();
+
+	// Indices are written unconditionally and the cursor only advances for visible boxes, so the output needs room
+	// for every box up front. It is shrunk to fit at the end.
+	size_t first = visibleIndices.size();
+	visibleIndices.resize(first + (end - begin));
+	uint32 *out = visibleIndices.data() + first;
+	uint32 visibleCount = 0;
+	uint32 i = begin;
+
+#if defined(__AVX2__)
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(centerX + i);
+		__m256 cy = _mm256_loadu_ps(centerY + i);
+		__m256 cz = _mm256_loadu_ps(centerZ + i);
+		__m256 ex = _mm256_loadu_ps(extentX + i);
+		__m256 ey = _mm256_loadu_ps(extentY + i);
+		__m256 ez = _mm256_loadu_ps(extentZ + i);
+
+		__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (uint32 p = 0; p < 6; p++)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(normalX[p])),
+																										_mm256_mul_ps(cy, _mm256_set1_ps(normalY[p]))),
+																			_mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(normalZ[p])), _mm256_set1_ps(d[p])));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(absNormalX[p])),
+																									_mm256_mul_ps(ey, _mm256_set1_ps(absNormalY[p]))),
+																		_mm256_mul_ps(ez, _mm256_set1_ps(absNormalZ[p])));
+			visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GT_OQ));
+		}
+
+		uint32 mask = static_cast<uint32>(_mm256_movemask_ps(visible));
+		if (mask == 0)
+		{
+			continue;
+		}
+		for (uint32 lane = 0; lane < 8; lane++)
+		{
+			out[visibleCount] = i + lane;
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+#elif defined(FIDELITY_FRUSTRUM_SSE)
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(centerX + i);
+		__m128 cy = _mm_loadu_ps(centerY + i);
+		__m128 cz = _mm_loadu_ps(centerZ + i);
+		__m128 ex = _mm_loadu_ps(extentX + i);
+		__m128 ey = _mm_loadu_ps(extentY + i);
+		__m128 ez = _mm_loadu_ps(extentZ + i);
+
+		__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (uint32 p = 0; p < 6; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(normalX[p])),
+																							_mm_mul_ps(cy, _mm_set1_ps(normalY[p]))),
+																	 _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(normalZ[p])), _mm_set1_ps(d[p])));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(absNormalX[p])),
+																						_mm_mul_ps(ey, _mm_set1_ps(absNormalY[p]))),
+																 _mm_mul_ps(ez, _mm_set1_ps(absNormalZ[p])));
+			visible = _mm_and_ps(visible, _mm_cmpgt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		uint32 mask = static_cast<uint32>(_mm_movemask_ps(visible));
+		if (mask == 0)
+		{
+			continue;
+		}
+		for (uint32 lane = 0; lane < 4; lane++)
+		{
+			out[visibleCount] = i + lane;
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+#endif
+
+	// Scalar fallback, also used for the boxes left over after the last full SIMD batch.
+	for (; i < end; i++)
+	{
+		bool visible = true;
+		for (uint32 p = 0; p < 6; p++)
+		{
+			float32 distance = centerX[i] * normalX[p] + centerY[i] * normalY[p] + centerZ[i] * normalZ[p] + d[p];
+			float32 radius = extentX[i] * absNormalX[p] + extentY[i] * absNormalY[p] + extentZ[i] * absNormalZ[p];
+			visible &= distance + radius > 0.0f;
+		}
+		out[visibleCount] = i;
+		visibleCount += visible ? 1 : 0;
+	}
+
+	visibleIndices.resize(first + visibleCount);
+}
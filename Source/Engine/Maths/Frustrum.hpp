@@ -1,21 +1,44 @@
 #pragma once
+#include <vector>
+
 #include <array>
 #include "AABB.hpp"
 #include "Matrix4.hpp"
 #include "Plane.hpp"
 #include "Vector4.hpp"
 
+class AabbArray;
 class Camera;
 class Transform;
 
+enum class FrustrumIntersection
+{
+	Outside,
+	Intersecting,
+	Inside
+};
+
+static const uint32 FRUSTRUM_ALL_PLANES = 0x3f;
+
 class Frustrum
 {
 public:
 	Frustrum();
 	Frustrum(const Camera &camera);
+	Frustrum(const Plane &nearPlane, const Plane &farPlane, const Plane &left, const Plane &right, const Plane &top, const Plane &bottom);
 
 	bool contains(const Aabb &box, const Transform &transform) const;
 
+	/// @brief Tests a world space box against the planes whose bits are set in planeMask. Planes the box lies entirely
+	/// inside of are cleared from the mask so that boxes nested within it can skip them.
+	FrustrumIntersection intersects(const Aabb &globalAabb, uint32 &planeMask) const;
+
+	/// @brief Tests every box in the array against the frustrum, eight or four at a time when AVX2 or SSE is available.
+	/// @param visibleIndices Indices of the boxes which are not outside are appended in ascending order.
+	void cull(const AabbArray &bounds, std::vector<uint32> &visibleIndices) const;
+	/// @brief As above, limited to the boxes in [begin, end) so that the array can be culled in parallel chunks.
+	void cull(const AabbArray &bounds, uint32 begin, uint32 end, std::vector<uint32> &visibleIndices) const;
+
 private:
 	Plane _left;
 	Plane _right;
@@ -14,6 +14,12 @@ Ray::Ray(const Vector3 &position, const Vector3 &direction) : _position(position
 }
 
 bool Ray::Intersects(const Aabb &aabb) const
+{
+  float32 distance = 0.0f;
+  return Intersects(aabb, distance);
+}
+
+bool Ray::Intersects(const Aabb &aabb, float32 &distance) const
 {
   float32 tmin = 0.0f, tmax = std::numeric_limits<float32>::max();
   Vector3 min = aabb.getMin(), max = aabb.getMax();
@@ -35,5 +41,6 @@ bool Ray::Intersects(const Aabb &aabb) const
     tmax = std::fminf(tmax, std::fmaxf(t1, t2));
   }
 
+  distance = tmin;
   return tmin < tmax;
 }
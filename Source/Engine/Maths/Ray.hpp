@@ -9,6 +9,8 @@ public:
   Ray(const Vector3& position, const Vector3& direction);
   
   bool Intersects(const Aabb& aabb) const;
+  /// @brief As above, also returning the distance along the ray to the entry point.
+  bool Intersects(const Aabb& aabb, float32& distance) const;
   
 private:
   Vector3 _position;
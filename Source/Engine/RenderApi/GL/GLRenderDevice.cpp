@@ -1,6 +1,7 @@
 #include "GLRenderDevice.hpp"
 
 #include "../../Utility/Assert.hpp"
+#include "../../Utility/HotReload.hpp"
 #include "GL.hpp"
 #include "GLGpuBuffer.hpp"
 #include "GLIndexBuffer.hpp"
@@ -10,6 +11,9 @@
 #include "GLShaderPipeline.hpp"
 #include "GLShaderPipelineCollection.hpp"
 #include "GLTexture.hpp"
+#include "GLTextureReadback.hpp"
+#include "GLTimerQuery.hpp"
+#include "GLUploadArena.hpp"
 #include "GLVertexBuffer.hpp"
 #include "GLVertexArrayCollection.hpp"
 
@@ -157,6 +161,7 @@ GLRenderDevice::GLRenderDevice(const RenderDeviceDesc &desc) : RenderDevice(desc
                                                                _stencilReadMask(0),
                                                                _stencilRefValue(0),
                                                                _stencilWriteMask(0),
+                                                               _boundInstanceOffset(0),
                                                                _shaderPipelineCollection(new GLShaderPipelineCollection)
 {
   setViewport(ViewportDesc{0.0f, 0.0f, static_cast<float32>(desc.RenderWidth), static_cast<float32>(desc.RenderHeight), 0.0f, 0.0f});
@@ -167,6 +172,30 @@ std::shared_ptr<Shader> GLRenderDevice::createShader(const ShaderDesc &desc)
 {
   std::shared_ptr<GLShader> glShader(new GLShader(desc));
   glShader->compile();
+  if (!desc.FilePath.empty())
+  {
+    // Pipelines hold the shader itself, so swapping its program and dropping the program pipelines linking the old
+    // one is all a reload needs for every pipeline state using it to pick up the change.
+    std::weak_ptr<GLShader> weakShader = glShader;
+    std::weak_ptr<GLShaderPipelineCollection> weakPipelines = _shaderPipelineCollection;
+    glShader->setHotReloadId(HotReload::get().track(glShader->getDependencies(), [weakShader, weakPipelines]()
+                                                    {
+                                                      auto shader = weakShader.lock();
+                                                      if (!shader)
+                                                      {
+                                                        return false;
+                                                      }
+                                                      uint32 previousId = shader->GetId();
+                                                      shader->reload();
+                                                      // The shader may include different headers now.
+                                                      HotReload::get().setFiles(shader->getHotReloadId(), shader->getDependencies());
+                                                      if (auto pipelines = weakPipelines.lock())
+                                                      {
+                                                        pipelines->evict(previousId);
+                                                      }
+                                                      return true;
+                                                    }));
+  }
   return glShader;
 }
 
@@ -200,6 +229,35 @@ std::shared_ptr<SamplerState> GLRenderDevice::createSamplerState(const SamplerSt
   return std::shared_ptr<GLSamplerState>(new GLSamplerState(desc));
 }
 
+std::shared_ptr<TimerQuery> GLRenderDevice::createTimerQuery()
+{
+  return std::shared_ptr<GLTimerQuery>(new GLTimerQuery(_desc.FrameCount));
+}
+
+std::shared_ptr<TextureReadback> GLRenderDevice::createTextureReadback()
+{
+  return std::shared_ptr<GLTextureReadback>(new GLTextureReadback(_desc.FrameCount));
+}
+
+std::shared_ptr<UploadArena> GLRenderDevice::createUploadArena(const UploadArenaDesc &desc)
+{
+  GLint alignment = 16;
+  if (desc.BufferType == BufferType::Constant)
+  {
+    glCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+  }
+
+  // Slices must start on an aligned boundary for offsets within them to be bindable.
+  UploadArenaDesc arenaDesc(desc);
+  arenaDesc.ByteCount = (desc.ByteCount + alignment - 1) & ~static_cast<uint64>(alignment - 1);
+
+  GpuBufferDesc bufferDesc;
+  bufferDesc.BufferType = desc.BufferType;
+  bufferDesc.BufferUsage = BufferUsage::Stream;
+  bufferDesc.ByteCount = arenaDesc.ByteCount * _desc.FrameCount;
+  return std::shared_ptr<GLUploadArena>(new GLUploadArena(arenaDesc, createGpuBuffer(bufferDesc), _desc.FrameCount, alignment));
+}
+
 void GLRenderDevice::setPrimitiveTopology(PrimitiveTopology primitiveTopology)
 {
   _primitiveTopology = primitiveTopology;
@@ -307,16 +365,34 @@ void GLRenderDevice::setIndexBuffer(const std::shared_ptr<IndexBuffer> &indexBuf
   _boundIndexBuffer = glIndexBuffer;
 }
 
+void GLRenderDevice::setInstanceBuffer(const std::shared_ptr<GpuBuffer> &instanceBuffer, uint64 byteOffset)
+{
+  ASSERT_TRUE(instanceBuffer->getType() == BufferType::Vertex, "GPU buffer is not a vertex buffer");
+  _boundInstanceBuffer = std::static_pointer_cast<GLGpuBuffer>(instanceBuffer);
+  _boundInstanceOffset = byteOffset;
+}
+
 void GLRenderDevice::setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer)
 {
   ASSERT_TRUE(constantBuffer->getType() == BufferType::Constant, "GPU buffer is not a constant buffer");
-  ASSERT_FALSE(slot > MAX_CONSTANT_BUFFERS, "Constant buffer binding slot exceeds maximum supported");
+  ASSERT_FALSE(slot >= MAX_CONSTANT_BUFFERS, "Constant buffer binding slot exceeds maximum supported");
 
   auto glConstantBuffer = std::static_pointer_cast<GLGpuBuffer>(constantBuffer);
   glCall(glBindBufferBase(GL_UNIFORM_BUFFER, slot, glConstantBuffer->GetId()));
   _boundConstantBuffers[slot] = glConstantBuffer;
 }
 
+void GLRenderDevice::setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer, uint64 byteOffset, uint64 byteCount)
+{
+  ASSERT_TRUE(constantBuffer->getType() == BufferType::Constant, "GPU buffer is not a constant buffer");
+  ASSERT_FALSE(slot >= MAX_CONSTANT_BUFFERS, "Constant buffer binding slot exceeds maximum supported");
+  ASSERT_FALSE(byteOffset + byteCount > constantBuffer->getSizeBytes(), "Constant buffer range exceeds the size of the buffer");
+
+  auto glConstantBuffer = std::static_pointer_cast<GLGpuBuffer>(constantBuffer);
+  glCall(glBindBufferRange(GL_UNIFORM_BUFFER, slot, glConstantBuffer->GetId(), byteOffset, byteCount));
+  _boundConstantBuffers[slot] = glConstantBuffer;
+}
+
 void GLRenderDevice::setTexture(uint32 slot, const std::shared_ptr<Texture> &texture)
 {
   ASSERT_FALSE(slot >= MAX_TEXTURE_SLOTS, "Texture slot exceeds maximum supported");
@@ -383,6 +459,25 @@ void GLRenderDevice::drawIndexed(uint32 indexCount, uint32 indexOffset, uint32 v
   endDraw();
 }
 
+void GLRenderDevice::drawInstanced(uint32 vertexCount, uint32 vertexOffset, uint32 instanceCount)
+{
+  beginDraw();
+  glCall(glDrawArraysInstanced(getPrimitiveTopology(_primitiveTopology), vertexOffset, vertexCount, instanceCount));
+  endDraw();
+}
+
+void GLRenderDevice::drawIndexedInstanced(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset, uint32 instanceCount)
+{
+  beginDraw();
+  ASSERT_FALSE(_boundIndexBuffer == nullptr, "No index buffer has been bound");
+  glCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _boundIndexBuffer->getId()));
+
+  GLenum idxType = _boundIndexBuffer->getIndexType() == IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  uint32 idxTypeByteCount = IndexBuffer::getBytesPerIndex(_boundIndexBuffer->getIndexType());
+  glCall(glDrawElementsInstancedBaseVertex(getPrimitiveTopology(_primitiveTopology), indexCount, idxType, reinterpret_cast<GLvoid *>(idxTypeByteCount * indexOffset), instanceCount, vertexOffset));
+  endDraw();
+}
+
 void GLRenderDevice::clearBuffers(uint32 buffers, const Colour &colour, float32 depth, int32 stencil)
 {
   if (!_pipelineState)
@@ -451,6 +546,12 @@ void GLRenderDevice::beginDraw()
 
   auto vao = GLVertexArrayObjectCollection::getVao(_pipelineState->getVertexLayout(), _boundVertexBuffer);
   glCall(glBindVertexArray(vao->getId()));
+
+  if (_pipelineState->getVertexLayout()->hasInstanceAttributes())
+  {
+    ASSERT_FALSE(_boundInstanceBuffer == nullptr, "No instance buffer has been set");
+    GLVertexArrayObjectCollection::bindInstanceAttributes(_pipelineState->getVertexLayout(), _boundInstanceBuffer, _boundInstanceOffset);
+  }
 }
 
 void GLRenderDevice::endDraw()
@@ -27,6 +27,9 @@ public:
   std::shared_ptr<GpuBuffer> createGpuBuffer(const GpuBufferDesc &desc) override;
   std::shared_ptr<Texture> createTexture(const TextureDesc &desc, bool gammaCorrected = false) override;
   std::shared_ptr<SamplerState> createSamplerState(const SamplerStateDesc &desc) override;
+  std::shared_ptr<TimerQuery> createTimerQuery() override;
+  std::shared_ptr<TextureReadback> createTextureReadback() override;
+  std::shared_ptr<UploadArena> createUploadArena(const UploadArenaDesc &desc) override;
 
   void setPrimitiveTopology(PrimitiveTopology primitiveTopology) override;
   void setViewport(const ViewportDesc &viewport) override;
@@ -34,7 +37,9 @@ public:
   void setRenderTarget(const std::shared_ptr<RenderTarget> &renderTarget) override;
   void setVertexBuffer(const std::shared_ptr<VertexBuffer> vertexBuffer) override;
   void setIndexBuffer(const std::shared_ptr<IndexBuffer> &indexBuffer) override;
+  void setInstanceBuffer(const std::shared_ptr<GpuBuffer> &instanceBuffer, uint64 byteOffset = 0) override;
   void setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer) override;
+  void setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer, uint64 byteOffset, uint64 byteCount) override;
   void setTexture(uint32 slot, const std::shared_ptr<Texture> &texture) override;
   void setSamplerState(uint32 slot, const std::shared_ptr<SamplerState> &samplerState) override;
   void setScissorDimensions(const ScissorDesc &desc) override;
@@ -44,6 +49,8 @@ public:
 
   void draw(uint32 vertexCount, uint32 vertexOffset) override;
   void drawIndexed(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset) override;
+  void drawInstanced(uint32 vertexCount, uint32 vertexOffset, uint32 instanceCount) override;
+  void drawIndexedInstanced(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset, uint32 instanceCount) override;
 
   void clearBuffers(uint32 buffers, const Colour &colour = Colour(115, 140, 153, 255), float32 depth = 1.0f, int32 stencil = 0) override;
 
@@ -88,6 +95,8 @@ private:
   ViewportDesc _viewportDesc;
 
   std::shared_ptr<GLIndexBuffer> _boundIndexBuffer;
+  std::shared_ptr<GLGpuBuffer> _boundInstanceBuffer;
+  uint64 _boundInstanceOffset;
   std::shared_ptr<GLRenderTarget> _boundRenderTarget;
   std::shared_ptr<GLShaderPipeline> _shaderPipeline;
   std::shared_ptr<GLVertexBuffer> _boundVertexBuffer;
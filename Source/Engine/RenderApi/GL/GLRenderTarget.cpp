@@ -4,17 +4,31 @@
 #include "GL.hpp"
 #include "GLTexture.hpp"
 
-void attachDepthStencilTexture(const std::shared_ptr<Texture> &texture)
+void attachDepthStencilTexture(const std::shared_ptr<Texture> &texture, int32 layer)
 {
   auto glTexture = std::dynamic_pointer_cast<GLTexture>(texture);
   const auto &textureDesc = glTexture->getDesc();
+  GLenum attachment = 0;
   if (textureDesc.Usage == TextureUsage::Depth)
   {
-    glCall(glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, glTexture->getId(), 0));
+    attachment = GL_DEPTH_ATTACHMENT;
   }
   else if (textureDesc.Usage == TextureUsage::DepthStencil)
   {
-    glCall(glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, glTexture->getId(), 0));
+    attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+  }
+  else
+  {
+    return;
+  }
+
+  if (layer >= 0)
+  {
+    glCall(glFramebufferTextureLayer(GL_FRAMEBUFFER, attachment, glTexture->getId(), 0, layer));
+  }
+  else
+  {
+    glCall(glFramebufferTexture(GL_FRAMEBUFFER, attachment, glTexture->getId(), 0));
   }
 }
 
@@ -92,7 +106,7 @@ void GLRenderTarget::initialize()
 
   if (_desc.DepthStencilTarget != nullptr)
   {
-    attachDepthStencilTexture(_desc.DepthStencilTarget);
+    attachDepthStencilTexture(_desc.DepthStencilTarget, _desc.DepthStencilLayer);
   }
 
   if (attachments.size() > 0)
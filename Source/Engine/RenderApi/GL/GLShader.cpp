@@ -2,6 +2,7 @@
 
 #include "../../Utility/Assert.hpp"
 #include "../../Utility/Hash.hpp"
+#include "../../Utility/HotReload.hpp"
 #include "../../Utility/String.hpp"
 #include "GL.hpp"
 
@@ -25,6 +26,10 @@ GLenum getShaderType(ShaderType shaderType)
 
 GLShader::~GLShader()
 {
+	if (_hotReloadId != 0)
+	{
+		HotReload::get().untrack(_hotReloadId);
+	}
 	if (_id != 0)
 	{
 		glCall(glDeleteProgram(_id));
@@ -39,23 +44,32 @@ void GLShader::compile()
 		return;
 	}
 
-	attachHeaderFiles();
-	const byte *ptr = _desc.Source.c_str();
-	glCall2(glCreateShaderProgramv(getShaderType(_desc.ShaderType), 1, &ptr), _id);
+	attachHeaderFiles(_desc.Source, _dependencies);
+	_id = createProgram(_desc.Source);
+	_isCompiled = true;
 
-	ASSERT_FALSE(_id == 0, "Unable to generate shader object");
-	glCall(glUseProgram(0));
+	buildUniformDefinitions();
+	buildUniformBlockDefinitions();
+}
 
-	GLint linkStatus = -1;
-	glCall(glGetProgramiv(_id, GL_LINK_STATUS, &linkStatus));
+void GLShader::reload()
+{
+	std::string source = String::foadFromFile(_desc.FilePath);
+	std::vector<std::string> dependencies{_desc.FilePath};
+	attachHeaderFiles(source, dependencies);
+	uint32 id = createProgram(source);
 
-	if (linkStatus == GL_FALSE)
+	if (_id != 0)
 	{
-		std::string errorMessage = "Unable to compile shader:\n" + getShaderLog();
-		throw std::runtime_error(errorMessage);
+		glCall(glDeleteProgram(_id));
 	}
-	_isCompiled = true;
-
+	_id = id;
+	_desc.Source = source;
+	_dependencies = dependencies;
+	// Locations and bindings belong to the old program.
+	_uniforms.clear();
+	_assignedBindingPoints.clear();
+	_assignedTextureSlots.clear();
 	buildUniformDefinitions();
 	buildUniformBlockDefinitions();
 }
@@ -87,43 +101,72 @@ void GLShader::bindTextureUnit(const std::string &name, uint32 textureUnit)
 	}
 }
 
-GLShader::GLShader(const ShaderDesc &desc) : Shader(desc), _id(0)
+GLShader::GLShader(const ShaderDesc &desc) : Shader(desc), _id(0), _hotReloadId(0)
 {
+	if (!_desc.FilePath.empty())
+	{
+		_dependencies.push_back(_desc.FilePath);
+		if (_desc.Source.empty())
+		{
+			_desc.Source = String::foadFromFile(_desc.FilePath);
+		}
+	}
+
 	ASSERT_FALSE(desc.ShaderLang != ShaderLang::Glsl, "Shaders must be written in GLSL when using OpenGL backend");
-	ASSERT_FALSE(desc.Source.empty(), "Shader source is empty");
+	ASSERT_FALSE(_desc.Source.empty(), "Shader source is empty");
 	ASSERT_FALSE(desc.EntryPoint.empty(), "Shader entry point not defined");
 	ASSERT_TRUE(desc.EntryPoint == "main", "GLSL shaders must have a 'main' entry point");
 }
 
-void GLShader::attachHeaderFiles()
+void GLShader::attachHeaderFiles(std::string &source, std::vector<std::string> &dependencies) const
 {
-	for (auto iterPos = 0; iterPos != std::string::npos;)
+	// Inserted headers are scanned in turn, so nested includes are expanded too.
+	for (std::size_t iterPos = source.find("#include"); iterPos != std::string::npos; iterPos = source.find("#include", iterPos))
 	{
-		iterPos = _desc.Source.find("#include", iterPos);
-		if (iterPos != std::string::npos)
-		{
-			auto newLinePos = _desc.Source.find("\n", iterPos);
-			auto line = _desc.Source.substr(iterPos, newLinePos - iterPos);
-			auto splitLine = String::split(line, '\"');
-			ASSERT_TRUE(splitLine.size() == 3, "#include syntax error");
+		auto newLinePos = source.find("\n", iterPos);
+		auto line = source.substr(iterPos, newLinePos - iterPos);
+		auto splitLine = String::split(line, '\"');
+		ASSERT_TRUE(splitLine.size() == 3, "#include syntax error");
 
-			auto headerSource = String::foadFromFile("./Shaders/" + splitLine[1]);
+		std::string headerPath = "./Shaders/" + splitLine[1];
+		auto headerSource = String::foadFromFile(headerPath);
+		dependencies.push_back(headerPath);
 
-			_desc.Source.erase(iterPos, newLinePos - iterPos);
-			_desc.Source.insert(iterPos, headerSource.c_str());
-		}
+		source.erase(iterPos, newLinePos - iterPos);
+		source.insert(iterPos, headerSource.c_str());
+	}
+}
+
+uint32 GLShader::createProgram(const std::string &source) const
+{
+	const byte *ptr = source.c_str();
+	uint32 id = 0;
+	glCall2(glCreateShaderProgramv(getShaderType(_desc.ShaderType), 1, &ptr), id);
+
+	ASSERT_FALSE(id == 0, "Unable to generate shader object");
+	glCall(glUseProgram(0));
+
+	GLint linkStatus = -1;
+	glCall(glGetProgramiv(id, GL_LINK_STATUS, &linkStatus));
+
+	if (linkStatus == GL_FALSE)
+	{
+		std::string errorMessage = "Unable to compile shader " + _desc.FilePath + ":\n" + getShaderLog(id);
+		glCall(glDeleteProgram(id));
+		throw std::runtime_error(errorMessage);
 	}
+	return id;
 }
 
-std::string GLShader::getShaderLog()
+std::string GLShader::getShaderLog(uint32 id) const
 {
 	int32 logLength = -1;
-	glCall(glGetProgramiv(_id, GL_INFO_LOG_LENGTH, &logLength));
+	glCall(glGetProgramiv(id, GL_INFO_LOG_LENGTH, &logLength));
 
 	if (logLength > 0)
 	{
 		std::vector<byte> buffer(logLength);
-		glCall(glGetProgramInfoLog(_id, logLength, 0, &buffer[0]));
+		glCall(glGetProgramInfoLog(id, logLength, 0, &buffer[0]));
 		return std::string(buffer.begin(), buffer.end());
 	}
 	return std::string();
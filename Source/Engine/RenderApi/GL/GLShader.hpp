@@ -1,6 +1,7 @@
 #pragma once
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "../Shader.hpp"
 
 class GLShader : public Shader
@@ -13,6 +14,13 @@ public:
 	uint32 GetId() const { return _id; }
 
 	void compile() override;
+	/// @brief Reads FilePath again and swaps in the new program, leaving the current one in place if it fails to compile.
+	void reload();
+
+	/// @brief FilePath followed by every header it includes, nested ones included.
+	const std::vector<std::string> &getDependencies() const { return _dependencies; }
+	void setHotReloadId(uint64 id) { _hotReloadId = id; }
+	uint64 getHotReloadId() const { return _hotReloadId; }
 
 	bool hasUniform(const std::string &name) const;
 
@@ -22,8 +30,9 @@ public:
 private:
 	GLShader(const ShaderDesc &desc);
 
-	void attachHeaderFiles();
-	std::string getShaderLog();
+	void attachHeaderFiles(std::string &source, std::vector<std::string> &dependencies) const;
+	uint32 createProgram(const std::string &source) const;
+	std::string getShaderLog(uint32 id) const;
 
 	uint32 getUniformLocation(const std::string &name);
 
@@ -47,6 +56,8 @@ private:
 	};
 
 	uint32 _id;
+	uint64 _hotReloadId;
+	std::vector<std::string> _dependencies;
 	std::unordered_map<std::string, Uniform> _uniforms;
 	std::unordered_map<uint32, uint32> _assignedBindingPoints;
 	std::unordered_map<uint32, uint32> _assignedTextureSlots;
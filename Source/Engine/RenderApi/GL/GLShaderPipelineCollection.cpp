@@ -41,6 +41,16 @@ const std::shared_ptr<GLShaderPipeline> &GLShaderPipelineCollection::getShaderPi
   return iter->second;
 }
 
+void GLShaderPipelineCollection::evict(uint32 programId)
+{
+  for (auto iter = _shaderPipelines.begin(); iter != _shaderPipelines.end();)
+  {
+    const PipelineKey &key = iter->first;
+    bool linksProgram = key.vsId == programId || key.fsId == programId || key.gsId == programId || key.hsId == programId || key.dsId == programId;
+    iter = linksProgram ? _shaderPipelines.erase(iter) : std::next(iter);
+  }
+}
+
 std::size_t GLShaderPipelineCollection::PipelineKeyHasher::operator()(const PipelineKey &key) const
 {
   std::size_t seed = 0;
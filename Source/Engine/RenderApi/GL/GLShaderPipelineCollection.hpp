@@ -14,6 +14,8 @@ public:
                                                              const std::shared_ptr<Shader> &gs,
                                                              const std::shared_ptr<Shader> &hs,
                                                              const std::shared_ptr<Shader> &ds);
+  /// @brief Releases every pipeline linking the program, such as once a reloaded shader has replaced it.
+  void evict(uint32 programId);
 
 private:
   struct PipelineKey
@@ -1,8 +1,25 @@
 #include "GLTexture.hpp"
 
+#include <algorithm>
+
 #include "../../Utility/Assert.hpp"
 #include "GL.hpp"
 
+// Block compressed formats outside of the GL 4.1 core profile which glad was generated for. Every desktop driver exposes
+// them through EXT_texture_compression_s3tc, EXT_texture_sRGB and ARB_texture_compression_bptc.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
 void getInternalPixelFormat(TextureFormat textureFormat, GLenum &internalFormat, GLenum &format, GLenum &type, bool gammaCorrected)
 {
   switch (textureFormat)
@@ -54,6 +71,41 @@ void getInternalPixelFormat(TextureFormat textureFormat, GLenum &internalFormat,
     type = GL_FLOAT;
     break;
   }
+  case TextureFormat::RGBA32F:
+  {
+    internalFormat = GL_RGBA32F;
+    format = GL_RGBA;
+    type = GL_FLOAT;
+    break;
+  }
+  case TextureFormat::R16F:
+  {
+    internalFormat = GL_R16F;
+    format = GL_RED;
+    type = GL_FLOAT;
+    break;
+  }
+  case TextureFormat::RG16F:
+  {
+    internalFormat = GL_RG16F;
+    format = GL_RG;
+    type = GL_FLOAT;
+    break;
+  }
+  case TextureFormat::R32F:
+  {
+    internalFormat = GL_R32F;
+    format = GL_RED;
+    type = GL_FLOAT;
+    break;
+  }
+  case TextureFormat::R32UI:
+  {
+    internalFormat = GL_R32UI;
+    format = GL_RED_INTEGER;
+    type = GL_UNSIGNED_INT;
+    break;
+  }
   case TextureFormat::D32:
   {
     internalFormat = GL_DEPTH_COMPONENT32;
@@ -82,6 +134,41 @@ void getInternalPixelFormat(TextureFormat textureFormat, GLenum &internalFormat,
     type = GL_UNSIGNED_INT_24_8;
     break;
   }
+  case TextureFormat::BC1:
+  {
+    internalFormat = gammaCorrected ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    format = GL_RGB;
+    type = GL_UNSIGNED_BYTE;
+    break;
+  }
+  case TextureFormat::BC3:
+  {
+    internalFormat = gammaCorrected ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    format = GL_RGBA;
+    type = GL_UNSIGNED_BYTE;
+    break;
+  }
+  case TextureFormat::BC4:
+  {
+    internalFormat = GL_COMPRESSED_RED_RGTC1;
+    format = GL_RED;
+    type = GL_UNSIGNED_BYTE;
+    break;
+  }
+  case TextureFormat::BC5:
+  {
+    internalFormat = GL_COMPRESSED_RG_RGTC2;
+    format = GL_RG;
+    type = GL_UNSIGNED_BYTE;
+    break;
+  }
+  case TextureFormat::BC7:
+  {
+    internalFormat = gammaCorrected ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    format = GL_RGBA;
+    type = GL_UNSIGNED_BYTE;
+    break;
+  }
   default:
     throw std::runtime_error("Unsupported TextureFormat");
   }
@@ -139,8 +226,8 @@ GLTexture::~GLTexture()
 
 void GLTexture::writeData(uint32 mipLevel, uint32 face, const std::shared_ptr<ImageData> &data)
 {
-  ASSERT_TRUE(_desc.Width == data->getWidth(), "Image width must be consistent with Texture");
-  ASSERT_TRUE(_desc.Height == data->getHeight(), "Image height must be consistent with Texture");
+  ASSERT_TRUE(std::max(_desc.Width >> mipLevel, 1u) == data->getWidth(), "Image width must be consistent with Texture");
+  ASSERT_TRUE(std::max(_desc.Height >> mipLevel, 1u) == data->getHeight(), "Image height must be consistent with Texture");
   ASSERT_TRUE(_desc.Depth == data->getDepth(), "Image depth must be consistent with Texture");
 
   GLenum internalFormat;
@@ -153,6 +240,11 @@ void GLTexture::writeData(uint32 mipLevel, uint32 face, const std::shared_ptr<Im
   GLint previouslyBoundTexture = 0;
   glCall(glGetIntegerv(getTextureBindingTarget(_desc.Type), &previouslyBoundTexture));
 
+  // Rows of small RGB mips are not a multiple of the default 4 byte alignment.
+  GLint previousUnpackAlignment = 4;
+  glCall(glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousUnpackAlignment));
+  glCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+
   glCall(glBindTexture(target, _id));
   switch (_desc.Type)
   {
@@ -178,12 +270,13 @@ void GLTexture::writeData(uint32 mipLevel, uint32 face, const std::shared_ptr<Im
     throw std::runtime_error("Unsupported TextureType");
   }
   glCall(glBindTexture(target, previouslyBoundTexture));
+  glCall(glPixelStorei(GL_UNPACK_ALIGNMENT, previousUnpackAlignment));
 }
 
 void GLTexture::writeData(uint32 mipLevel, uint32 face, uint32 xStart, uint32 xCount, uint32 yStart, uint32 yCount, uint32 zStart, uint32 zCount, void *data)
 {
-  ASSERT_TRUE(_desc.Width <= xCount - xStart, "Width pixel data count exceeds texture width.");
-  ASSERT_TRUE(_desc.Height <= yCount - yStart, "Height pixel data count exceeds texture width.");
+  ASSERT_TRUE(xStart + xCount <= _desc.Width, "Width pixel data count exceeds texture width.");
+  ASSERT_TRUE(yStart + yCount <= _desc.Height, "Height pixel data count exceeds texture height.");
 
   GLenum internalFormat;
   GLenum format;
@@ -221,8 +314,39 @@ void GLTexture::writeData(uint32 mipLevel, uint32 face, uint32 xStart, uint32 xC
   glCall(glBindTexture(target, previouslyBoundTexture));
 }
 
+void GLTexture::writeCompressedData(uint32 mipLevel, const void *data, uint64 byteCount)
+{
+  if (!isBlockCompressed(_desc.Format) || _desc.Type != TextureType::Texture2D)
+  {
+    throw std::runtime_error("Compressed data can only be written to block compressed 2D textures");
+  }
+
+  uint32 width = std::max(_desc.Width >> mipLevel, 1u);
+  uint32 height = std::max(_desc.Height >> mipLevel, 1u);
+  if (byteCount != getCompressedSize(_desc.Format, width, height))
+  {
+    throw std::runtime_error("Compressed data size does not match the mip level");
+  }
+
+  GLenum internalFormat;
+  GLenum format;
+  GLenum type;
+  getInternalPixelFormat(_desc.Format, internalFormat, format, type, _gammaCorrected);
+
+  GLint previouslyBoundTexture = 0;
+  glCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previouslyBoundTexture));
+  glCall(glBindTexture(GL_TEXTURE_2D, _id));
+  glCall(glCompressedTexSubImage2D(GL_TEXTURE_2D, mipLevel, 0, 0, width, height, internalFormat, static_cast<GLsizei>(byteCount), data));
+  glCall(glBindTexture(GL_TEXTURE_2D, previouslyBoundTexture));
+}
+
 void GLTexture::generateMips()
 {
+  if (isBlockCompressed(_desc.Format))
+  {
+    throw std::runtime_error("Mips of block compressed textures must be uploaded rather than generated");
+  }
+
   GLint previouslyBoundTexture = 0;
   glCall(glGetIntegerv(getTextureBindingTarget(_desc.Type), &previouslyBoundTexture));
 
@@ -233,6 +357,80 @@ void GLTexture::generateMips()
   glCall(glBindTexture(target, previouslyBoundTexture));
 }
 
+uint64 GLTexture::getPackedByteCount(uint32 mipLevel) const
+{
+  if (_desc.Type != TextureType::Texture2D || isBlockCompressed(_desc.Format))
+  {
+    throw std::runtime_error("Only uncompressed 2D textures can be read back");
+  }
+
+  GLenum internalFormat;
+  GLenum format;
+  GLenum type;
+  getInternalPixelFormat(_desc.Format, internalFormat, format, type, _gammaCorrected);
+
+  uint64 componentCount = 1;
+  switch (format)
+  {
+  case GL_RG:
+  case GL_RG_INTEGER:
+    componentCount = 2;
+    break;
+  case GL_RGB:
+    componentCount = 3;
+    break;
+  case GL_RGBA:
+    componentCount = 4;
+    break;
+  default:
+    break;
+  }
+
+  uint64 componentBytes = 1;
+  switch (type)
+  {
+  case GL_HALF_FLOAT:
+    componentBytes = 2;
+    break;
+  case GL_FLOAT:
+  case GL_UNSIGNED_INT:
+  case GL_UNSIGNED_INT_24_8:
+    componentBytes = 4;
+    break;
+  default:
+    break;
+  }
+
+  uint64 width = std::max(_desc.Width >> mipLevel, 1u);
+  uint64 height = std::max(_desc.Height >> mipLevel, 1u);
+  return width * height * componentCount * componentBytes;
+}
+
+void GLTexture::copyToPixelPackBuffer(uint32 mipLevel)
+{
+  if (_desc.Type != TextureType::Texture2D || isBlockCompressed(_desc.Format))
+  {
+    throw std::runtime_error("Only uncompressed 2D textures can be read back");
+  }
+
+  GLenum internalFormat;
+  GLenum format;
+  GLenum type;
+  getInternalPixelFormat(_desc.Format, internalFormat, format, type, _gammaCorrected);
+
+  GLint previouslyBoundTexture = 0;
+  glCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previouslyBoundTexture));
+  GLint previousPackAlignment = 4;
+  glCall(glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment));
+
+  glCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+  glCall(glBindTexture(GL_TEXTURE_2D, _id));
+  glCall(glGetTexImage(GL_TEXTURE_2D, mipLevel, format, type, nullptr));
+
+  glCall(glBindTexture(GL_TEXTURE_2D, previouslyBoundTexture));
+  glCall(glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment));
+}
+
 GLTexture::GLTexture(const TextureDesc &desc, bool gammaCorrected) : Texture(desc, gammaCorrected), _id(0)
 {
   Initialize();
@@ -265,6 +463,23 @@ void GLTexture::Allocate()
   GLenum format;
   GLenum type;
   getInternalPixelFormat(_desc.Format, internalFormat, format, type, _gammaCorrected);
+  if (isBlockCompressed(_desc.Format))
+  {
+    if (_desc.Type != TextureType::Texture2D)
+    {
+      throw std::runtime_error("Block compressed textures must be 2D");
+    }
+    for (uint32 i = 0; i < _desc.MipLevels; i++)
+    {
+      uint32 width = std::max(_desc.Width >> i, 1u);
+      uint32 height = std::max(_desc.Height >> i, 1u);
+      glCall(glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, width, height, 0, static_cast<GLsizei>(getCompressedSize(_desc.Format, width, height)), nullptr));
+    }
+    // The chain may stop short of 1x1, so limit sampling to the levels which exist.
+    glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(_desc.MipLevels) - 1));
+    return;
+  }
+
   switch (_desc.Type)
   {
   case TextureType::Texture1D:
@@ -282,7 +497,12 @@ void GLTexture::Allocate()
   case TextureType::Texture2D:
     for (uint32 i = 0; i < _desc.MipLevels; i++)
     {
-      glCall(glTexImage2D(GL_TEXTURE_2D, i, internalFormat, _desc.Width, _desc.Height, 0, format, type, nullptr));
+      glCall(glTexImage2D(GL_TEXTURE_2D, i, internalFormat, std::max(_desc.Width >> i, 1u), std::max(_desc.Height >> i, 1u), 0, format, type, nullptr));
+    }
+    if (_desc.MipLevels > 1)
+    {
+      // Mips were supplied rather than generated, so sampling stops at the last one allocated.
+      glCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(_desc.MipLevels) - 1));
     }
     break;
   case TextureType::Texture2DArray:
@@ -305,6 +525,7 @@ void GLTexture::Allocate()
     {
       glCall(glTexImage3D(GL_TEXTURE_3D, i, internalFormat, _desc.Width, _desc.Height, _desc.Depth, 0, format, type, nullptr));
     }
+    break;
   default:
     throw std::runtime_error("Unsupported TextureType");
   }
@@ -11,10 +11,16 @@ public:
 
   void writeData(uint32 mipLevel, uint32 face, const std::shared_ptr<ImageData> &data) override;
   void writeData(uint32 mipLevel, uint32 face, uint32 xStart, uint32 xCount, uint32 yStart, uint32 yCount, uint32 zStart, uint32 zCount, void *data) override;
+  void writeCompressedData(uint32 mipLevel, const void *data, uint64 byteCount) override;
   void generateMips() override;
 
   uint32 getId() const { return _id; }
 
+  /// @brief Bytes a mip level of an uncompressed 2D texture takes once read back with tightly packed rows.
+  uint64 getPackedByteCount(uint32 mipLevel) const;
+  /// @brief Reads a mip level of an uncompressed 2D texture into the bound pixel pack buffer, from its start.
+  void copyToPixelPackBuffer(uint32 mipLevel);
+
 protected:
   GLTexture(const TextureDesc &desc, bool gammaCorrected);
 
@@ -0,0 +1,103 @@
+#include "GLTextureReadback.hpp"
+
+#include <cstring>
+
+#include "GL.hpp"
+#include "GLTexture.hpp"
+
+GLTextureReadback::~GLTextureReadback()
+{
+  for (auto &slot : _slots)
+  {
+    if (slot.Fence)
+    {
+      glCall(glDeleteSync(slot.Fence));
+    }
+    glCall(glDeleteBuffers(1, &slot.BufferId));
+  }
+}
+
+uint64 GLTextureReadback::copy(const std::shared_ptr<Texture> &texture)
+{
+  resolve();
+
+  // If the GPU is further behind than the ring allows the oldest copy is dropped rather than waited on.
+  auto &slot = _slots[_writeIndex];
+  if (slot.Fence)
+  {
+    glCall(glDeleteSync(slot.Fence));
+    slot.Fence = nullptr;
+  }
+
+  auto glTexture = std::static_pointer_cast<GLTexture>(texture);
+  uint64 byteCount = glTexture->getPackedByteCount(0);
+  glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.BufferId));
+  if (slot.ByteCount != byteCount)
+  {
+    glCall(glBufferData(GL_PIXEL_PACK_BUFFER, byteCount, nullptr, GL_STREAM_READ));
+    slot.ByteCount = byteCount;
+  }
+  glTexture->copyToPixelPackBuffer(0);
+  glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+  GLsync fence = nullptr;
+  glCall2(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), fence);
+  slot.Fence = fence;
+  slot.Id = _nextId++;
+  slot.Width = texture->getDesc().Width;
+  slot.Height = texture->getDesc().Height;
+  _writeIndex = (_writeIndex + 1) % _slots.size();
+  return slot.Id;
+}
+
+void GLTextureReadback::resolve()
+{
+  // Walk from the oldest slot so the most recent finished copy wins.
+  for (uint32 i = 0; i < _slots.size(); i++)
+  {
+    auto &slot = _slots[(_writeIndex + i) % _slots.size()];
+    if (!slot.Fence)
+    {
+      continue;
+    }
+
+    GLenum result = GL_TIMEOUT_EXPIRED;
+    glCall2(glClientWaitSync(slot.Fence, 0, 0), result);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+      // Fences signal in order, so nothing newer can be ready either.
+      break;
+    }
+    glCall(glDeleteSync(slot.Fence));
+    slot.Fence = nullptr;
+
+    _data.resize(slot.ByteCount);
+    glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.BufferId));
+    const void *mapped = nullptr;
+    glCall2(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.ByteCount, GL_MAP_READ_BIT), mapped);
+    if (mapped)
+    {
+      std::memcpy(_data.data(), mapped, slot.ByteCount);
+      glCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+      _resultId = slot.Id;
+      _resultWidth = slot.Width;
+      _resultHeight = slot.Height;
+      _hasResult = true;
+    }
+    glCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  }
+}
+
+GLTextureReadback::GLTextureReadback(uint32 latency) : _writeIndex(0)
+{
+  _slots.resize(latency + 1);
+  for (auto &slot : _slots)
+  {
+    glCall(glGenBuffers(1, &slot.BufferId));
+    slot.ByteCount = 0;
+    slot.Fence = nullptr;
+    slot.Id = 0;
+    slot.Width = 0;
+    slot.Height = 0;
+  }
+}
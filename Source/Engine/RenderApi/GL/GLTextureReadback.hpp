@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include "../TextureReadback.hpp"
+
+struct __GLsync;
+
+/// @brief Pixel pack buffers kept in a ring of latency + 1 slots, each guarded by a fence. Each copy harvests whichever
+/// older slots the GPU has finished with, so results arrive a couple of frames late but the CPU never waits on them.
+class GLTextureReadback : public TextureReadback
+{
+  friend class GLRenderDevice;
+
+public:
+  ~GLTextureReadback();
+
+  uint64 copy(const std::shared_ptr<Texture> &texture) override;
+  void resolve() override;
+
+protected:
+  GLTextureReadback(uint32 latency);
+
+private:
+  struct ReadbackSlot
+  {
+    uint32 BufferId;
+    uint64 ByteCount;
+    __GLsync *Fence;
+    uint64 Id;
+    uint32 Width;
+    uint32 Height;
+  };
+
+  std::vector<ReadbackSlot> _slots;
+  uint32 _writeIndex;
+};
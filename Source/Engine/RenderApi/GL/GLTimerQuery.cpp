@@ -0,0 +1,77 @@
+#include "GLTimerQuery.hpp"
+
+#include "../../Utility/Assert.hpp"
+#include "GL.hpp"
+
+GLTimerQuery::~GLTimerQuery()
+{
+  for (auto &slot : _slots)
+  {
+    glCall(glDeleteQueries(1, &slot.StartId));
+    glCall(glDeleteQueries(1, &slot.EndId));
+  }
+}
+
+void GLTimerQuery::begin()
+{
+  ASSERT_FALSE(_inScope, "Timer query scope has already begun");
+  resolve();
+
+  // If the GPU is further behind than the ring allows the oldest result is dropped rather than waited on.
+  auto &slot = _slots[_writeIndex];
+  slot.Pending = false;
+  glCall(glQueryCounter(slot.StartId, GL_TIMESTAMP));
+  _inScope = true;
+}
+
+void GLTimerQuery::end()
+{
+  ASSERT_TRUE(_inScope, "Timer query scope has not begun");
+
+  auto &slot = _slots[_writeIndex];
+  glCall(glQueryCounter(slot.EndId, GL_TIMESTAMP));
+  slot.Pending = true;
+  _writeIndex = (_writeIndex + 1) % _slots.size();
+  _inScope = false;
+}
+
+GLTimerQuery::GLTimerQuery(uint32 latency) : _writeIndex(0),
+                                             _inScope(false)
+{
+  _slots.resize(latency + 1);
+  for (auto &slot : _slots)
+  {
+    glCall(glGenQueries(1, &slot.StartId));
+    glCall(glGenQueries(1, &slot.EndId));
+    slot.Pending = false;
+  }
+}
+
+void GLTimerQuery::resolve()
+{
+  // Walk from the oldest slot so the most recent finished scope wins.
+  for (uint32 i = 0; i < _slots.size(); i++)
+  {
+    auto &slot = _slots[(_writeIndex + i) % _slots.size()];
+    if (!slot.Pending)
+    {
+      continue;
+    }
+
+    GLint available = GL_FALSE;
+    glCall(glGetQueryObjectiv(slot.EndId, GL_QUERY_RESULT_AVAILABLE, &available));
+    if (available == GL_FALSE)
+    {
+      // Queries complete in order, so nothing newer can be ready either.
+      break;
+    }
+
+    GLuint64 startTime = 0;
+    GLuint64 endTime = 0;
+    glCall(glGetQueryObjectui64v(slot.StartId, GL_QUERY_RESULT, &startTime));
+    glCall(glGetQueryObjectui64v(slot.EndId, GL_QUERY_RESULT, &endTime));
+    _lastDuration = endTime > startTime ? endTime - startTime : 0;
+    _resultCount++;
+    slot.Pending = false;
+  }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include "../TimerQuery.hpp"
+
+/// @brief Timestamp query pairs kept in a ring of latency + 1 slots. Each begin() harvests whichever older slots the
+/// GPU has finished with, so results arrive a couple of frames late but the CPU never waits on them.
+class GLTimerQuery : public TimerQuery
+{
+  friend class GLRenderDevice;
+
+public:
+  ~GLTimerQuery();
+
+  void begin() override;
+  void end() override;
+
+protected:
+  GLTimerQuery(uint32 latency);
+
+private:
+  void resolve();
+
+private:
+  struct QuerySlot
+  {
+    uint32 StartId;
+    uint32 EndId;
+    bool Pending;
+  };
+
+  std::vector<QuerySlot> _slots;
+  uint32 _writeIndex;
+  bool _inScope;
+};
@@ -0,0 +1,51 @@
+#include "GLUploadArena.hpp"
+
+#include "GL.hpp"
+
+static const GLuint64 FENCE_TIMEOUT_NS = 1000000;
+
+GLUploadArena::~GLUploadArena()
+{
+  for (auto fence : _fences)
+  {
+    if (fence)
+    {
+      glCall(glDeleteSync(fence));
+    }
+  }
+}
+
+void GLUploadArena::beginFrame()
+{
+  if (_frameStarted)
+  {
+    GLsync fence = nullptr;
+    glCall2(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), fence);
+    _fences[_frameIndex] = fence;
+  }
+  advanceFrame();
+
+  GLsync fence = _fences[_frameIndex];
+  if (!fence)
+  {
+    return;
+  }
+
+  GLenum result = GL_TIMEOUT_EXPIRED;
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  while (result == GL_TIMEOUT_EXPIRED)
+  {
+    glCall2(glClientWaitSync(fence, flags, FENCE_TIMEOUT_NS), result);
+    flags = 0;
+  }
+  glCall(glDeleteSync(fence));
+  _fences[_frameIndex] = nullptr;
+}
+
+GLUploadArena::GLUploadArena(const UploadArenaDesc &desc,
+                             const std::shared_ptr<GpuBuffer> &buffer,
+                             uint32 frameCount,
+                             uint64 alignment) : UploadArena(desc, buffer, frameCount, alignment),
+                                                 _fences(frameCount, nullptr)
+{
+}
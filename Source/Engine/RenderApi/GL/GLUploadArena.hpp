@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include "../UploadArena.hpp"
+
+struct __GLsync;
+
+/// @brief Guards each slice with a fence inserted when the frame that used it ends. The fence is only waited on when the
+/// ring wraps back around to that slice, which only blocks if the CPU is more than the frames in flight ahead of the GPU.
+class GLUploadArena : public UploadArena
+{
+  friend class GLRenderDevice;
+
+public:
+  ~GLUploadArena();
+
+  void beginFrame() override;
+
+protected:
+  GLUploadArena(const UploadArenaDesc &desc, const std::shared_ptr<GpuBuffer> &buffer, uint32 frameCount, uint64 alignment);
+
+private:
+  std::vector<__GLsync *> _fences;
+};
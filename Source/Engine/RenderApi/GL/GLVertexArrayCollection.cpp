@@ -3,6 +3,7 @@
 #include "../../Utility/Assert.hpp"
 #include "../../Utility/Hash.hpp"
 #include "../VertexLayout.hpp"
+#include "GLGpuBuffer.hpp"
 #include "GLVertexBuffer.hpp"
 #include "GL.hpp"
 
@@ -20,6 +21,13 @@ GLenum getComponentType(SemanticFormat format)
   case SemanticFormat::Ubyte3:
   case SemanticFormat::Ubyte4:
     return GL_UNSIGNED_BYTE;
+  case SemanticFormat::Short2:
+  case SemanticFormat::Short4:
+    return GL_SHORT;
+  case SemanticFormat::Ushort4:
+    return GL_UNSIGNED_SHORT;
+  case SemanticFormat::Half2:
+    return GL_HALF_FLOAT;
   case SemanticFormat::Float:
   case SemanticFormat::Float2:
   case SemanticFormat::Float3:
@@ -54,6 +62,8 @@ GLint getComponentCount(SemanticFormat format)
   case SemanticFormat::Float2:
   case SemanticFormat::Uint2:
   case SemanticFormat::Int2:
+  case SemanticFormat::Short2:
+  case SemanticFormat::Half2:
     return 2;
   case SemanticFormat::Byte3:
   case SemanticFormat::Ubyte3:
@@ -66,6 +76,8 @@ GLint getComponentCount(SemanticFormat format)
   case SemanticFormat::Float4:
   case SemanticFormat::Uint4:
   case SemanticFormat::Int4:
+  case SemanticFormat::Short4:
+  case SemanticFormat::Ushort4:
   default:
     return 4;
   }
@@ -84,6 +96,11 @@ GLint getComponentByteCount(SemanticFormat format)
   case SemanticFormat::Ubyte3:
   case SemanticFormat::Ubyte4:
     return 1;
+  case SemanticFormat::Short2:
+  case SemanticFormat::Short4:
+  case SemanticFormat::Ushort4:
+  case SemanticFormat::Half2:
+    return 2;
   case SemanticFormat::Uint:
   case SemanticFormat::Uint2:
   case SemanticFormat::Uint3:
@@ -126,7 +143,10 @@ std::shared_ptr<GLVertexArrayObject> GLVertexArrayObjectCollection::getVao(const
   auto layouts = vertexLayout->getDesc();
   for (uint32 i = 0; i < layouts.size(); i++)
   {
-    stride += getComponentByteCount(layouts[i].Format) * getComponentCount(layouts[i].Format);
+    if (layouts[i].InputRate == VertexInputRate::PerVertex)
+    {
+      stride += getComponentByteCount(layouts[i].Format) * getComponentCount(layouts[i].Format);
+    }
   }
 
   glCall(glBindBuffer(GL_ARRAY_BUFFER, boundBuffer->GetId()));
@@ -134,6 +154,11 @@ std::shared_ptr<GLVertexArrayObject> GLVertexArrayObjectCollection::getVao(const
   GLuint offset = 0;
   for (uint32 i = 0; i < layouts.size(); i++)
   {
+    if (layouts[i].InputRate != VertexInputRate::PerVertex)
+    {
+      continue;
+    }
+
     GLuint inputSlot = static_cast<GLuint>(layouts[i].Type);
     GLint compSize = getComponentCount(layouts[i].Format);
     GLenum compType = getComponentType(layouts[i].Format);
@@ -151,3 +176,39 @@ std::shared_ptr<GLVertexArrayObject> GLVertexArrayObjectCollection::getVao(const
   boundBuffer->_vao = vao;
   return vao;
 }
+
+void GLVertexArrayObjectCollection::bindInstanceAttributes(const std::shared_ptr<VertexLayout> &vertexLayout, const std::shared_ptr<GLGpuBuffer> &instanceBuffer, uint64 byteOffset)
+{
+  GLsizei stride = 0;
+  auto layouts = vertexLayout->getDesc();
+  for (uint32 i = 0; i < layouts.size(); i++)
+  {
+    if (layouts[i].InputRate == VertexInputRate::PerInstance)
+    {
+      stride += getComponentByteCount(layouts[i].Format) * getComponentCount(layouts[i].Format);
+    }
+  }
+
+  glCall(glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer->GetId()));
+
+  uint64 offset = byteOffset;
+  for (uint32 i = 0; i < layouts.size(); i++)
+  {
+    if (layouts[i].InputRate != VertexInputRate::PerInstance)
+    {
+      continue;
+    }
+
+    GLuint inputSlot = static_cast<GLuint>(layouts[i].Type);
+    GLint compSize = getComponentCount(layouts[i].Format);
+    GLenum compType = getComponentType(layouts[i].Format);
+    GLboolean normalized = layouts[i].Normalised ? GL_TRUE : GL_FALSE;
+
+    glCall(glVertexAttribPointer(inputSlot, compSize, compType, normalized, stride, reinterpret_cast<GLvoid *>(offset)));
+    glCall(glVertexAttribDivisor(inputSlot, 1));
+    glCall(glEnableVertexAttribArray(inputSlot));
+
+    offset += compSize * getComponentByteCount(layouts[i].Format);
+  }
+  glCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include "../../Core/Types.hpp"
 
+class GLGpuBuffer;
 class GLVertexBuffer;
 class VertexLayout;
 
@@ -26,4 +27,7 @@ class GLVertexArrayObjectCollection
 {
 public:
   static std::shared_ptr<GLVertexArrayObject> getVao(const std::shared_ptr<VertexLayout> &vertexLayout, const std::shared_ptr<GLVertexBuffer> &boundBuffer);
+  /// @brief Points the per-instance attributes of the currently bound VAO at instanceBuffer. GL 4.1 has no separate
+  /// vertex buffer bindings so this is re-specified whenever the instance buffer or offset changes.
+  static void bindInstanceAttributes(const std::shared_ptr<VertexLayout> &vertexLayout, const std::shared_ptr<GLGpuBuffer> &instanceBuffer, uint64 byteOffset);
 };
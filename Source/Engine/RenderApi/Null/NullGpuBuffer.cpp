@@ -0,0 +1,48 @@
+#include "NullGpuBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+void NullGpuBuffer::writeData(uint64 byteOffset, uint64 byteCount, const void *src, AccessType accessType)
+{
+  if (byteOffset + byteCount > _desc.ByteCount)
+  {
+    throw std::runtime_error("Write range cannot exceed the internal size of the buffer");
+  }
+
+  if (accessType == AccessType::WriteOnlyDiscard)
+  {
+    std::fill(_data.begin(), _data.end(), 0);
+  }
+  std::memcpy(_data.data() + byteOffset, src, byteCount);
+
+  _bytesWritten += byteCount;
+  _writeCount++;
+}
+
+void NullGpuBuffer::readData(uint64 byteOffset, uint64 byteCount, void *dst)
+{
+  if (byteOffset + byteCount > _desc.ByteCount)
+  {
+    throw std::runtime_error("Read range cannot exceed the internal size of the buffer");
+  }
+  std::memcpy(dst, _data.data() + byteOffset, byteCount);
+}
+
+void NullGpuBuffer::copyData(GpuBuffer *dst, uint64 srcByteOffset, uint64 dstByteOffset, uint64 byteCount)
+{
+  if (srcByteOffset + byteCount > _desc.ByteCount)
+  {
+    throw std::runtime_error("Copy range cannot exceed the internal size of the buffer");
+  }
+  dst->writeData(dstByteOffset, byteCount, _data.data() + srcByteOffset);
+}
+
+NullGpuBuffer::NullGpuBuffer(const GpuBufferDesc &desc) : GpuBuffer(desc),
+                                                          _data(desc.ByteCount, 0),
+                                                          _bytesWritten(0),
+                                                          _writeCount(0)
+{
+  _initialized = true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include "../GpuBuffer.hpp"
+
+/// @brief GPU buffer backed by host memory. Used by the null render device so buffer uploads can be profiled without a GL context.
+class NullGpuBuffer : public GpuBuffer
+{
+  friend class NullIndexBuffer;
+  friend class NullRenderDevice;
+  friend class NullVertexBuffer;
+
+public:
+  void writeData(uint64 byteOffset, uint64 byteCount, const void *src, AccessType accessType = AccessType::WriteOnly) override;
+  void readData(uint64 byteOffset, uint64 byteCount, void *dst) override;
+  void copyData(GpuBuffer *dst, uint64 srcByteOffset, uint64 dstByteOffset, uint64 byteCount) override;
+
+  const std::vector<ubyte> &getHostData() const { return _data; }
+  uint64 getBytesWritten() const { return _bytesWritten; }
+  uint64 getWriteCount() const { return _writeCount; }
+
+protected:
+  NullGpuBuffer(const GpuBufferDesc &desc);
+
+private:
+  std::vector<ubyte> _data;
+  uint64 _bytesWritten;
+  uint64 _writeCount;
+};
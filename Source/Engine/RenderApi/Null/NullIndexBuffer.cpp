@@ -0,0 +1,24 @@
+#include "NullIndexBuffer.hpp"
+
+#include "NullGpuBuffer.hpp"
+
+void NullIndexBuffer::writeData(uint64 byteOffset, uint64 byteCount, const void *src, AccessType accessType)
+{
+  _buffer->writeData(byteOffset, byteCount, src, accessType);
+}
+
+void NullIndexBuffer::readData(uint64 byteOffset, uint64 byteCount, void *dst)
+{
+  _buffer->readData(byteOffset, byteCount, dst);
+}
+
+void NullIndexBuffer::copyData(GpuBuffer *dst, uint64 srcByteOffset, uint64 dstByteOffset, uint64 byteCount)
+{
+  _buffer->copyData(dst, srcByteOffset, dstByteOffset, byteCount);
+}
+
+NullIndexBuffer::NullIndexBuffer(const IndexBufferDesc &desc) : IndexBuffer(desc),
+                                                                _buffer(new NullGpuBuffer(getDesc()))
+{
+  _initialized = true;
+}
@@ -0,0 +1,379 @@
+#include "NullRenderDevice.hpp"
+
+#include <stdexcept>
+
+#include "NullGpuBuffer.hpp"
+#include "NullIndexBuffer.hpp"
+#include "NullRenderTarget.hpp"
+#include "NullSamplerState.hpp"
+#include "NullShader.hpp"
+#include "NullTexture.hpp"
+#include "NullTextureReadback.hpp"
+#include "NullTimerQuery.hpp"
+#include "NullUploadArena.hpp"
+#include "NullVertexBuffer.hpp"
+
+static const uint32 MAX_NULL_CONSTANT_BUFFERS = 32;
+static const uint32 MAX_NULL_TEXTURE_SLOTS = 16;
+static const uint64 NULL_CONSTANT_BUFFER_ALIGNMENT = 256;
+static const uint64 NULL_VERTEX_BUFFER_ALIGNMENT = 16;
+
+NullRenderDevice::NullRenderDevice(const RenderDeviceDesc &desc) : RenderDevice(desc),
+                                                                   _recordingEnabled(true),
+                                                                   _primitiveTopology(PrimitiveTopology::TriangleList),
+                                                                   _scissorDesc{0, 0, desc.RenderWidth, desc.RenderHeight},
+                                                                   _commandCounts{},
+                                                                   _totalCommandCount(0),
+                                                                   _indexCount(0),
+                                                                   _vertexCount(0),
+                                                                   _instanceCount(0)
+{
+  _viewportDesc.Width = static_cast<float32>(desc.RenderWidth);
+  _viewportDesc.Height = static_cast<float32>(desc.RenderHeight);
+}
+
+std::shared_ptr<Shader> NullRenderDevice::createShader(const ShaderDesc &desc)
+{
+  std::shared_ptr<NullShader> shader(new NullShader(desc));
+  shader->compile();
+  return shader;
+}
+
+std::shared_ptr<VertexBuffer> NullRenderDevice::createVertexBuffer(const VertexBufferDesc &desc)
+{
+  return std::shared_ptr<NullVertexBuffer>(new NullVertexBuffer(desc));
+}
+
+std::shared_ptr<RenderTarget> NullRenderDevice::createRenderTarget(const RenderTargetDesc &desc)
+{
+  return std::shared_ptr<NullRenderTarget>(new NullRenderTarget(desc));
+}
+
+std::shared_ptr<IndexBuffer> NullRenderDevice::createIndexBuffer(const IndexBufferDesc &desc)
+{
+  return std::shared_ptr<NullIndexBuffer>(new NullIndexBuffer(desc));
+}
+
+std::shared_ptr<GpuBuffer> NullRenderDevice::createGpuBuffer(const GpuBufferDesc &desc)
+{
+  return std::shared_ptr<NullGpuBuffer>(new NullGpuBuffer(desc));
+}
+
+std::shared_ptr<Texture> NullRenderDevice::createTexture(const TextureDesc &desc, bool gammaCorrected)
+{
+  return std::shared_ptr<NullTexture>(new NullTexture(desc, gammaCorrected));
+}
+
+std::shared_ptr<SamplerState> NullRenderDevice::createSamplerState(const SamplerStateDesc &desc)
+{
+  return std::shared_ptr<NullSamplerState>(new NullSamplerState(desc));
+}
+
+std::shared_ptr<TimerQuery> NullRenderDevice::createTimerQuery()
+{
+  return std::shared_ptr<NullTimerQuery>(new NullTimerQuery());
+}
+
+std::shared_ptr<TextureReadback> NullRenderDevice::createTextureReadback()
+{
+  return std::shared_ptr<NullTextureReadback>(new NullTextureReadback());
+}
+
+std::shared_ptr<UploadArena> NullRenderDevice::createUploadArena(const UploadArenaDesc &desc)
+{
+  // Use the strictest alignment common GL drivers report so offsets match what a real device would produce.
+  uint64 alignment = desc.BufferType == BufferType::Constant ? NULL_CONSTANT_BUFFER_ALIGNMENT : NULL_VERTEX_BUFFER_ALIGNMENT;
+  UploadArenaDesc arenaDesc(desc);
+  arenaDesc.ByteCount = (desc.ByteCount + alignment - 1) & ~(alignment - 1);
+
+  GpuBufferDesc bufferDesc;
+  bufferDesc.BufferType = desc.BufferType;
+  bufferDesc.BufferUsage = BufferUsage::Stream;
+  bufferDesc.ByteCount = arenaDesc.ByteCount * _desc.FrameCount;
+  return std::shared_ptr<NullUploadArena>(new NullUploadArena(arenaDesc, createGpuBuffer(bufferDesc), _desc.FrameCount, alignment));
+}
+
+void NullRenderDevice::setPrimitiveTopology(PrimitiveTopology primitiveTopology)
+{
+  _primitiveTopology = primitiveTopology;
+
+  NullCommand command{NullCommandType::SetPrimitiveTopology};
+  command.Count = static_cast<uint32>(primitiveTopology);
+  record(command);
+}
+
+void NullRenderDevice::setViewport(const ViewportDesc &viewport)
+{
+  _viewportDesc = viewport;
+
+  NullCommand command{NullCommandType::SetViewport};
+  command.Count = static_cast<uint32>(viewport.Width);
+  command.Offset = static_cast<uint32>(viewport.Height);
+  record(command);
+}
+
+void NullRenderDevice::setPipelineState(const std::shared_ptr<PipelineState> &pipelineState)
+{
+  if (!pipelineState)
+  {
+    throw std::runtime_error("Pipeline state cannot be null");
+  }
+  _pipelineState = pipelineState;
+  _primitiveTopology = pipelineState->getPrimitiveTopology();
+
+  NullCommand command{NullCommandType::SetPipelineState};
+  command.Resource = pipelineState.get();
+  record(command);
+}
+
+void NullRenderDevice::setRenderTarget(const std::shared_ptr<RenderTarget> &renderTarget)
+{
+  _boundRenderTarget = renderTarget;
+
+  NullCommand command{NullCommandType::SetRenderTarget};
+  command.Resource = renderTarget.get();
+  record(command);
+}
+
+void NullRenderDevice::setVertexBuffer(const std::shared_ptr<VertexBuffer> vertexBuffer)
+{
+  _boundVertexBuffer = vertexBuffer;
+
+  NullCommand command{NullCommandType::SetVertexBuffer};
+  command.Resource = vertexBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::setIndexBuffer(const std::shared_ptr<IndexBuffer> &indexBuffer)
+{
+  _boundIndexBuffer = indexBuffer;
+
+  NullCommand command{NullCommandType::SetIndexBuffer};
+  command.Resource = indexBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::setInstanceBuffer(const std::shared_ptr<GpuBuffer> &instanceBuffer, uint64 byteOffset)
+{
+  if (instanceBuffer->getType() != BufferType::Vertex)
+  {
+    throw std::runtime_error("GPU buffer is not a vertex buffer");
+  }
+  if (byteOffset >= instanceBuffer->getSizeBytes())
+  {
+    throw std::runtime_error("Instance buffer offset exceeds the size of the buffer");
+  }
+  _boundInstanceBuffer = instanceBuffer;
+
+  NullCommand command{NullCommandType::SetInstanceBuffer};
+  command.Offset = static_cast<uint32>(byteOffset);
+  command.Resource = instanceBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer)
+{
+  if (slot >= MAX_NULL_CONSTANT_BUFFERS)
+  {
+    throw std::runtime_error("Constant buffer binding slot exceeds maximum supported");
+  }
+  if (constantBuffer->getType() != BufferType::Constant)
+  {
+    throw std::runtime_error("GPU buffer is not a constant buffer");
+  }
+
+  NullCommand command{NullCommandType::SetConstantBuffer};
+  command.Slot = slot;
+  command.Resource = constantBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer, uint64 byteOffset, uint64 byteCount)
+{
+  if (slot >= MAX_NULL_CONSTANT_BUFFERS)
+  {
+    throw std::runtime_error("Constant buffer binding slot exceeds maximum supported");
+  }
+  if (constantBuffer->getType() != BufferType::Constant)
+  {
+    throw std::runtime_error("GPU buffer is not a constant buffer");
+  }
+  if (byteOffset % NULL_CONSTANT_BUFFER_ALIGNMENT != 0)
+  {
+    throw std::runtime_error("Constant buffer offset is not aligned");
+  }
+  if (byteOffset + byteCount > constantBuffer->getSizeBytes())
+  {
+    throw std::runtime_error("Constant buffer range exceeds the size of the buffer");
+  }
+
+  NullCommand command{NullCommandType::SetConstantBuffer};
+  command.Slot = slot;
+  command.Count = static_cast<uint32>(byteCount);
+  command.Offset = static_cast<uint32>(byteOffset);
+  command.Resource = constantBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::setTexture(uint32 slot, const std::shared_ptr<Texture> &texture)
+{
+  if (slot >= MAX_NULL_TEXTURE_SLOTS)
+  {
+    throw std::runtime_error("Texture slot exceeds maximum supported");
+  }
+
+  NullCommand command{NullCommandType::SetTexture};
+  command.Slot = slot;
+  command.Resource = texture.get();
+  record(command);
+}
+
+void NullRenderDevice::setSamplerState(uint32 slot, const std::shared_ptr<SamplerState> &samplerState)
+{
+  if (slot >= MAX_NULL_TEXTURE_SLOTS)
+  {
+    throw std::runtime_error("Sampler slot exceeds maximum supported");
+  }
+
+  NullCommand command{NullCommandType::SetSamplerState};
+  command.Slot = slot;
+  command.Resource = samplerState.get();
+  record(command);
+}
+
+void NullRenderDevice::setScissorDimensions(const ScissorDesc &desc)
+{
+  _scissorDesc = desc;
+
+  NullCommand command{NullCommandType::SetScissorDimensions};
+  command.Count = desc.W;
+  command.Offset = desc.H;
+  record(command);
+}
+
+const ViewportDesc &NullRenderDevice::getViewport() const
+{
+  return _viewportDesc;
+}
+
+ScissorDesc NullRenderDevice::getScissorDimensions() const
+{
+  return _scissorDesc;
+}
+
+void NullRenderDevice::draw(uint32 vertexCount, uint32 vertexOffset)
+{
+  validateDraw();
+  _vertexCount += vertexCount;
+
+  NullCommand command{NullCommandType::Draw};
+  command.Count = vertexCount;
+  command.Offset = vertexOffset;
+  command.Resource = _boundVertexBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::drawIndexed(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset)
+{
+  validateIndexedDraw(indexCount, indexOffset);
+  _indexCount += indexCount;
+
+  NullCommand command{NullCommandType::DrawIndexed};
+  command.Count = indexCount;
+  command.Offset = indexOffset;
+  command.BaseVertex = vertexOffset;
+  command.Resource = _boundIndexBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::drawInstanced(uint32 vertexCount, uint32 vertexOffset, uint32 instanceCount)
+{
+  validateDraw();
+  _vertexCount += static_cast<uint64>(vertexCount) * instanceCount;
+  _instanceCount += instanceCount;
+
+  NullCommand command{NullCommandType::DrawInstanced};
+  command.Count = vertexCount;
+  command.Offset = vertexOffset;
+  command.InstanceCount = instanceCount;
+  command.Resource = _boundVertexBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::drawIndexedInstanced(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset, uint32 instanceCount)
+{
+  validateIndexedDraw(indexCount, indexOffset);
+  _indexCount += static_cast<uint64>(indexCount) * instanceCount;
+  _instanceCount += instanceCount;
+
+  NullCommand command{NullCommandType::DrawIndexedInstanced};
+  command.Count = indexCount;
+  command.Offset = indexOffset;
+  command.BaseVertex = vertexOffset;
+  command.InstanceCount = instanceCount;
+  command.Resource = _boundIndexBuffer.get();
+  record(command);
+}
+
+void NullRenderDevice::clearBuffers(uint32 buffers, const Colour &colour, float32 depth, int32 stencil)
+{
+  NullCommand command{NullCommandType::ClearBuffers};
+  command.Slot = buffers;
+  command.ClearColour = colour;
+  command.ClearDepth = depth;
+  command.ClearStencil = stencil;
+  record(command);
+}
+
+void NullRenderDevice::resetCommandLog()
+{
+  _commandLog.clear();
+  _commandCounts.fill(0);
+  _totalCommandCount = 0;
+  _indexCount = 0;
+  _vertexCount = 0;
+  _instanceCount = 0;
+}
+
+void NullRenderDevice::record(const NullCommand &command)
+{
+  _commandCounts[static_cast<uint32>(command.Type)]++;
+  _totalCommandCount++;
+  if (_recordingEnabled)
+  {
+    _commandLog.push_back(command);
+  }
+}
+
+void NullRenderDevice::validateDraw() const
+{
+  if (!_pipelineState)
+  {
+    throw std::runtime_error("No pipeline state has been set");
+  }
+  if (!_pipelineState->getVS() || !_pipelineState->getFS())
+  {
+    throw std::runtime_error("Pipeline state is missing a vertex or fragment shader");
+  }
+  if (!_boundVertexBuffer)
+  {
+    throw std::runtime_error("No vertex buffer has been set");
+  }
+  if (_pipelineState->getVertexLayout() && _pipelineState->getVertexLayout()->hasInstanceAttributes() && !_boundInstanceBuffer)
+  {
+    throw std::runtime_error("No instance buffer has been set");
+  }
+}
+
+void NullRenderDevice::validateIndexedDraw(uint32 indexCount, uint32 indexOffset) const
+{
+  validateDraw();
+  if (!_boundIndexBuffer)
+  {
+    throw std::runtime_error("No index buffer has been bound");
+  }
+  if (indexOffset + indexCount > _boundIndexBuffer->getIndexCount())
+  {
+    throw std::runtime_error("Indexed draw exceeds the bound index buffer");
+  }
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "../RenderDevice.hpp"
+
+enum class NullCommandType : uint8
+{
+  SetPipelineState,
+  SetPrimitiveTopology,
+  SetTexture,
+  SetRenderTarget,
+  SetViewport,
+  SetVertexBuffer,
+  SetIndexBuffer,
+  SetInstanceBuffer,
+  SetConstantBuffer,
+  SetSamplerState,
+  SetScissorDimensions,
+  Draw,
+  DrawIndexed,
+  DrawInstanced,
+  DrawIndexedInstanced,
+  ClearBuffers,
+  Count
+};
+
+/// @brief A single recorded device call. Resource is only used as an identity and must never be dereferenced.
+struct NullCommand
+{
+  NullCommandType Type;
+  uint32 Slot = 0;
+  uint32 Count = 0;
+  uint32 Offset = 0;
+  uint32 BaseVertex = 0;
+  uint32 InstanceCount = 0;
+  const void *Resource = nullptr;
+  /// @brief The values a ClearBuffers command clears to.
+  Colour ClearColour = Colour::Black;
+  float32 ClearDepth = 1.0f;
+  int32 ClearStencil = 0;
+};
+
+/// @brief Render device that keeps all resources in host memory and records every state change and draw into a command log.
+/// Requires no GL context so the CPU side of a frame can be profiled and regression tested headlessly.
+class NullRenderDevice : public RenderDevice
+{
+public:
+  NullRenderDevice(const RenderDeviceDesc &desc);
+
+  std::shared_ptr<Shader> createShader(const ShaderDesc &desc) override;
+  std::shared_ptr<VertexBuffer> createVertexBuffer(const VertexBufferDesc &desc) override;
+  std::shared_ptr<RenderTarget> createRenderTarget(const RenderTargetDesc &desc) override;
+  std::shared_ptr<IndexBuffer> createIndexBuffer(const IndexBufferDesc &desc) override;
+  std::shared_ptr<GpuBuffer> createGpuBuffer(const GpuBufferDesc &desc) override;
+  std::shared_ptr<Texture> createTexture(const TextureDesc &desc, bool gammaCorrected = false) override;
+  std::shared_ptr<SamplerState> createSamplerState(const SamplerStateDesc &desc) override;
+  std::shared_ptr<TimerQuery> createTimerQuery() override;
+  std::shared_ptr<TextureReadback> createTextureReadback() override;
+  std::shared_ptr<UploadArena> createUploadArena(const UploadArenaDesc &desc) override;
+
+  void setPrimitiveTopology(PrimitiveTopology primitiveTopology) override;
+  void setViewport(const ViewportDesc &viewport) override;
+  void setPipelineState(const std::shared_ptr<PipelineState> &pipelineState) override;
+  void setRenderTarget(const std::shared_ptr<RenderTarget> &renderTarget) override;
+  void setVertexBuffer(const std::shared_ptr<VertexBuffer> vertexBuffer) override;
+  void setIndexBuffer(const std::shared_ptr<IndexBuffer> &indexBuffer) override;
+  void setInstanceBuffer(const std::shared_ptr<GpuBuffer> &instanceBuffer, uint64 byteOffset = 0) override;
+  void setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer) override;
+  void setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer, uint64 byteOffset, uint64 byteCount) override;
+  void setTexture(uint32 slot, const std::shared_ptr<Texture> &texture) override;
+  void setSamplerState(uint32 slot, const std::shared_ptr<SamplerState> &samplerState) override;
+  void setScissorDimensions(const ScissorDesc &desc) override;
+
+  const ViewportDesc &getViewport() const override;
+  ScissorDesc getScissorDimensions() const override;
+
+  void draw(uint32 vertexCount, uint32 vertexOffset) override;
+  void drawIndexed(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset) override;
+  void drawInstanced(uint32 vertexCount, uint32 vertexOffset, uint32 instanceCount) override;
+  void drawIndexedInstanced(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset, uint32 instanceCount) override;
+
+  void clearBuffers(uint32 buffers, const Colour &colour = Colour::Black, float32 depth = 1.0f, int32 stencil = 0) override;
+
+  /// @brief Disabling recording keeps state tracking and validation but skips the log, so the device itself adds no allocation cost.
+  void setRecordingEnabled(bool enabled) { _recordingEnabled = enabled; }
+  bool isRecordingEnabled() const { return _recordingEnabled; }
+
+  const std::vector<NullCommand> &getCommandLog() const { return _commandLog; }
+  uint64 getCommandCount(NullCommandType type) const { return _commandCounts[static_cast<uint32>(type)]; }
+  uint64 getTotalCommandCount() const { return _totalCommandCount; }
+  uint64 getIndexCount() const { return _indexCount; }
+  uint64 getVertexCount() const { return _vertexCount; }
+  uint64 getInstanceCount() const { return _instanceCount; }
+
+  /// @brief Clears the command log and all counters. Typically called once at the start of each frame.
+  void resetCommandLog();
+
+private:
+  void record(const NullCommand &command);
+  void validateDraw() const;
+  void validateIndexedDraw(uint32 indexCount, uint32 indexOffset) const;
+
+private:
+  bool _recordingEnabled;
+
+  PrimitiveTopology _primitiveTopology;
+  ScissorDesc _scissorDesc;
+  ViewportDesc _viewportDesc;
+
+  std::shared_ptr<PipelineState> _pipelineState;
+  std::shared_ptr<VertexBuffer> _boundVertexBuffer;
+  std::shared_ptr<IndexBuffer> _boundIndexBuffer;
+  std::shared_ptr<GpuBuffer> _boundInstanceBuffer;
+  std::shared_ptr<RenderTarget> _boundRenderTarget;
+
+  std::vector<NullCommand> _commandLog;
+  std::array<uint64, static_cast<uint32>(NullCommandType::Count)> _commandCounts;
+  uint64 _totalCommandCount;
+  uint64 _indexCount;
+  uint64 _vertexCount;
+  uint64 _instanceCount;
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include "../RenderTarget.hpp"
+
+class NullRenderTarget : public RenderTarget
+{
+  friend class NullRenderDevice;
+
+public:
+  void copy(const std::shared_ptr<RenderTarget> &) override {}
+
+protected:
+  NullRenderTarget(const RenderTargetDesc &desc) : RenderTarget(desc) { _isInitialized = true; }
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include "../SamplerState.hpp"
+
+class NullSamplerState : public SamplerState
+{
+  friend class NullRenderDevice;
+
+protected:
+  NullSamplerState(const SamplerStateDesc &desc) : SamplerState(desc) {}
+};
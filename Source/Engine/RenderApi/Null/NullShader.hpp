@@ -0,0 +1,13 @@
+#pragma once
+#include "../Shader.hpp"
+
+class NullShader : public Shader
+{
+  friend class NullRenderDevice;
+
+public:
+  void compile() override { _isCompiled = true; }
+
+private:
+  NullShader(const ShaderDesc &desc) : Shader(desc) {}
+};
@@ -0,0 +1,175 @@
+#include "NullTexture.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "../../Image/ImageData.hpp"
+
+uint32 NullTexture::getBytesPerPixel(TextureFormat format)
+{
+  switch (format)
+  {
+  case TextureFormat::R8:
+    return 1;
+  case TextureFormat::RG8:
+    return 2;
+  case TextureFormat::RGB8:
+    return 3;
+  case TextureFormat::RGBA8:
+    return 4;
+  case TextureFormat::RGB16F:
+    return 6;
+  case TextureFormat::RGB32F:
+    return 12;
+  case TextureFormat::RGBA16F:
+    return 8;
+  case TextureFormat::RGBA32F:
+    return 16;
+  case TextureFormat::R16F:
+    return 2;
+  case TextureFormat::RG16F:
+  case TextureFormat::R32F:
+  case TextureFormat::R32UI:
+    return 4;
+  case TextureFormat::D32:
+  case TextureFormat::D32F:
+  case TextureFormat::D24S8:
+  case TextureFormat::D24:
+    return 4;
+  case TextureFormat::BC1:
+  case TextureFormat::BC3:
+  case TextureFormat::BC4:
+  case TextureFormat::BC5:
+  case TextureFormat::BC7:
+    throw std::runtime_error("Block compressed formats are addressed in blocks rather than pixels");
+  }
+  throw std::runtime_error("Unsupported TextureFormat");
+}
+
+void NullTexture::writeData(uint32 mipLevel, uint32 face, const std::shared_ptr<ImageData> &data)
+{
+  const auto &pixelData = data->getPixelData();
+  if (data->getBytesPerPixel() != getBytesPerPixel(_desc.Format))
+  {
+    // The GL driver would convert between formats on upload; only the upload volume matters here.
+    _bytesWritten += pixelData.size();
+    return;
+  }
+  writeData(mipLevel, face, data->getLeft(), data->getWidth(), data->getBottom(), data->getHeight(), data->getBack(), data->getDepth(), const_cast<ubyte *>(pixelData.data()));
+}
+
+void NullTexture::writeData(uint32 mipLevel, uint32 face, uint32 xStart, uint32 xCount, uint32 yStart, uint32 yCount, uint32 zStart, uint32 zCount, void *data)
+{
+  auto &surface = getSurface(mipLevel, face);
+  uint32 bytesPerPixel = getBytesPerPixel(_desc.Format);
+  uint32 width = getMipWidth(mipLevel);
+  uint32 height = getMipHeight(mipLevel);
+  uint32 depth = getMipDepth(mipLevel);
+  if (xStart + xCount > width || yStart + yCount > height || zStart + std::max(zCount, 1u) > depth)
+  {
+    throw std::runtime_error("Write region exceeds texture dimensions");
+  }
+
+  const ubyte *src = static_cast<const ubyte *>(data);
+  uint64 rowBytes = static_cast<uint64>(xCount) * bytesPerPixel;
+  for (uint32 z = 0; z < std::max(zCount, 1u); z++)
+  {
+    for (uint32 y = 0; y < yCount; y++)
+    {
+      uint64 dstOffset = ((static_cast<uint64>(zStart + z) * height + (yStart + y)) * width + xStart) * bytesPerPixel;
+      std::memcpy(surface.data() + dstOffset, src, rowBytes);
+      src += rowBytes;
+    }
+  }
+  _bytesWritten += rowBytes * yCount * std::max(zCount, 1u);
+}
+
+void NullTexture::writeCompressedData(uint32 mipLevel, const void *data, uint64 byteCount)
+{
+  if (!isBlockCompressed(_desc.Format) || _desc.Type != TextureType::Texture2D)
+  {
+    throw std::runtime_error("Compressed data can only be written to block compressed 2D textures");
+  }
+
+  auto &surface = getSurface(mipLevel, 0);
+  if (byteCount != surface.size())
+  {
+    throw std::runtime_error("Compressed data size does not match the mip level");
+  }
+  std::memcpy(surface.data(), data, byteCount);
+  _bytesWritten += byteCount;
+}
+
+void NullTexture::generateMips()
+{
+  // Mip contents are never sampled without a GPU so the chain is left as allocated.
+}
+
+const std::vector<ubyte> &NullTexture::getHostData(uint32 mipLevel, uint32 face) const
+{
+  return const_cast<NullTexture *>(this)->getSurface(mipLevel, face);
+}
+
+NullTexture::NullTexture(const TextureDesc &desc, bool gammaCorrected) : Texture(desc, gammaCorrected),
+                                                                         _bytesWritten(0)
+{
+  // Surfaces are allocated on first access, render targets are never written from the CPU so they cost no host memory.
+  _surfaces.resize(static_cast<size_t>(std::max(_desc.MipLevels, 1u)) * getFaceCount());
+  _isInitialized = true;
+}
+
+uint32 NullTexture::getFaceCount() const
+{
+  return _desc.Type == TextureType::TextureCube ? 6 : 1;
+}
+
+uint32 NullTexture::getMipWidth(uint32 mipLevel) const
+{
+  return std::max(_desc.Width >> mipLevel, 1u);
+}
+
+// Array layers are laid out along the next free dimension, matching how GLTexture addresses them.
+uint32 NullTexture::getMipHeight(uint32 mipLevel) const
+{
+  switch (_desc.Type)
+  {
+  case TextureType::Texture1D:
+    return 1;
+  case TextureType::Texture1DArray:
+    return std::max(_desc.Count, 1u);
+  default:
+    return std::max(_desc.Height >> mipLevel, 1u);
+  }
+}
+
+uint32 NullTexture::getMipDepth(uint32 mipLevel) const
+{
+  switch (_desc.Type)
+  {
+  case TextureType::Texture2DArray:
+    return std::max(_desc.Count, 1u);
+  case TextureType::Texture3D:
+    return std::max(_desc.Depth >> mipLevel, 1u);
+  default:
+    return 1;
+  }
+}
+
+std::vector<ubyte> &NullTexture::getSurface(uint32 mipLevel, uint32 face)
+{
+  uint64 index = static_cast<uint64>(mipLevel) * getFaceCount() + face;
+  if (index >= _surfaces.size())
+  {
+    throw std::runtime_error("Texture mip level or face out of range");
+  }
+
+  auto &surface = _surfaces[index];
+  if (surface.empty())
+  {
+    uint64 sliceBytes = isBlockCompressed(_desc.Format) ? getCompressedSize(_desc.Format, getMipWidth(mipLevel), getMipHeight(mipLevel))
+                                                        : static_cast<uint64>(getMipWidth(mipLevel)) * getMipHeight(mipLevel) * getBytesPerPixel(_desc.Format);
+    surface.resize(sliceBytes * getMipDepth(mipLevel), 0);
+  }
+  return surface;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include "../../Core/Types.hpp"
+#include "../Texture.hpp"
+
+/// @brief Texture backed by host memory. Each mip level of each face is kept as a tightly packed byte array, allocated on first access.
+class NullTexture : public Texture
+{
+  friend class NullRenderDevice;
+
+public:
+  static uint32 getBytesPerPixel(TextureFormat format);
+
+  void writeData(uint32 mipLevel, uint32 face, const std::shared_ptr<ImageData> &data) override;
+  void writeData(uint32 mipLevel, uint32 face, uint32 xStart, uint32 xCount, uint32 yStart, uint32 yCount, uint32 zStart, uint32 zCount, void *data) override;
+  void writeCompressedData(uint32 mipLevel, const void *data, uint64 byteCount) override;
+  void generateMips() override;
+
+  const std::vector<ubyte> &getHostData(uint32 mipLevel, uint32 face = 0) const;
+  uint64 getBytesWritten() const { return _bytesWritten; }
+
+protected:
+  NullTexture(const TextureDesc &desc, bool gammaCorrected);
+
+private:
+  uint32 getFaceCount() const;
+  uint32 getMipWidth(uint32 mipLevel) const;
+  uint32 getMipHeight(uint32 mipLevel) const;
+  uint32 getMipDepth(uint32 mipLevel) const;
+  std::vector<ubyte> &getSurface(uint32 mipLevel, uint32 face);
+
+private:
+  std::vector<std::vector<ubyte>> _surfaces;
+  uint64 _bytesWritten;
+};
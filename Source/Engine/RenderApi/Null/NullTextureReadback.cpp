@@ -0,0 +1,19 @@
+#include "NullTextureReadback.hpp"
+
+#include "NullTexture.hpp"
+
+uint64 NullTextureReadback::copy(const std::shared_ptr<Texture> &texture)
+{
+  if (texture->getDesc().Usage == TextureUsage::RenderTarget)
+  {
+    return _nextId++;
+  }
+
+  auto nullTexture = std::static_pointer_cast<NullTexture>(texture);
+  _data = nullTexture->getHostData(0);
+  _resultId = _nextId++;
+  _resultWidth = texture->getDesc().Width;
+  _resultHeight = texture->getDesc().Height;
+  _hasResult = true;
+  return _resultId;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "../TextureReadback.hpp"
+
+/// @brief The null device has no GPU timeline, so copies of its host memory textures are available straight away.
+/// Render targets are never drawn into, so copies of them never arrive.
+class NullTextureReadback : public TextureReadback
+{
+  friend class NullRenderDevice;
+
+public:
+  uint64 copy(const std::shared_ptr<Texture> &texture) override;
+  void resolve() override {}
+
+protected:
+  NullTextureReadback() {}
+};
@@ -0,0 +1,15 @@
+#pragma once
+#include "../TimerQuery.hpp"
+
+/// @brief There is no GPU behind the null device so scopes never produce a result.
+class NullTimerQuery : public TimerQuery
+{
+  friend class NullRenderDevice;
+
+public:
+  void begin() override {}
+  void end() override {}
+
+protected:
+  NullTimerQuery() {}
+};
@@ -0,0 +1,17 @@
+#pragma once
+#include "../UploadArena.hpp"
+
+/// @brief The null device has no GPU timeline, so slices are always free to reuse.
+class NullUploadArena : public UploadArena
+{
+  friend class NullRenderDevice;
+
+public:
+  void beginFrame() override { advanceFrame(); }
+
+protected:
+  NullUploadArena(const UploadArenaDesc &desc, const std::shared_ptr<GpuBuffer> &buffer, uint32 frameCount, uint64 alignment)
+      : UploadArena(desc, buffer, frameCount, alignment)
+  {
+  }
+};
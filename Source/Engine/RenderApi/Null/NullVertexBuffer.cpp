@@ -0,0 +1,24 @@
+#include "NullVertexBuffer.hpp"
+
+#include "NullGpuBuffer.hpp"
+
+void NullVertexBuffer::writeData(uint64 byteOffset, uint64 byteCount, const void *src, AccessType accessType)
+{
+  _buffer->writeData(byteOffset, byteCount, src, accessType);
+}
+
+void NullVertexBuffer::readData(uint64 byteOffset, uint64 byteCount, void *dst)
+{
+  _buffer->readData(byteOffset, byteCount, dst);
+}
+
+void NullVertexBuffer::copyData(GpuBuffer *dst, uint64 srcByteOffset, uint64 dstByteOffset, uint64 byteCount)
+{
+  _buffer->copyData(dst, srcByteOffset, dstByteOffset, byteCount);
+}
+
+NullVertexBuffer::NullVertexBuffer(const VertexBufferDesc &desc) : VertexBuffer(desc),
+                                                                   _buffer(new NullGpuBuffer(getDesc()))
+{
+  _initialized = true;
+}
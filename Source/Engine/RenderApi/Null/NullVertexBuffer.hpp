@@ -0,0 +1,23 @@
+#pragma once
+#include <memory>
+#include "../VertexBuffer.hpp"
+
+class NullGpuBuffer;
+
+class NullVertexBuffer : public VertexBuffer
+{
+  friend class NullRenderDevice;
+
+public:
+  const NullGpuBuffer &getBuffer() const { return *_buffer; }
+
+  void writeData(uint64 byteOffset, uint64 byteCount, const void *src, AccessType accessType = AccessType::WriteOnly) override;
+  void readData(uint64 byteOffset, uint64 byteCount, void *dst) override;
+  void copyData(GpuBuffer *dst, uint64 srcByteOffset, uint64 dstByteOffset, uint64 byteCount) override;
+
+protected:
+  NullVertexBuffer(const VertexBufferDesc &desc);
+
+private:
+  std::unique_ptr<NullGpuBuffer> _buffer;
+};
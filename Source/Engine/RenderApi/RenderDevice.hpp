@@ -9,6 +9,9 @@
 #include "SamplerState.hpp"
 #include "Shader.hpp"
 #include "Texture.hpp"
+#include "TextureReadback.hpp"
+#include "TimerQuery.hpp"
+#include "UploadArena.hpp"
 #include "VertexBuffer.hpp"
 #include "VertexLayout.hpp"
 
@@ -58,6 +61,9 @@ public:
   virtual std::shared_ptr<RenderTarget> createRenderTarget(const RenderTargetDesc &desc) = 0;
   virtual std::shared_ptr<GpuBuffer> createGpuBuffer(const GpuBufferDesc &desc) = 0;
   virtual std::shared_ptr<SamplerState> createSamplerState(const SamplerStateDesc &desc) = 0;
+  virtual std::shared_ptr<TimerQuery> createTimerQuery() = 0;
+  virtual std::shared_ptr<TextureReadback> createTextureReadback() = 0;
+  virtual std::shared_ptr<UploadArena> createUploadArena(const UploadArenaDesc &desc) = 0;
 
   virtual void setPipelineState(const std::shared_ptr<PipelineState> &pipelineState) = 0;
   virtual void setPrimitiveTopology(PrimitiveTopology primitiveTopology) = 0;
@@ -66,7 +72,11 @@ public:
   virtual void setViewport(const ViewportDesc &viewport) = 0;
   virtual void setVertexBuffer(const std::shared_ptr<VertexBuffer> vertexBuffer) = 0;
   virtual void setIndexBuffer(const std::shared_ptr<IndexBuffer> &indexBuffer) = 0;
+  /// @brief Source of the pipeline's per-instance vertex attributes, starting at byteOffset.
+  virtual void setInstanceBuffer(const std::shared_ptr<GpuBuffer> &instanceBuffer, uint64 byteOffset = 0) = 0;
   virtual void setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer) = 0;
+  /// @brief Binds byteCount bytes of constantBuffer starting at byteOffset, which must respect the upload arena alignment.
+  virtual void setConstantBuffer(uint32 slot, const std::shared_ptr<GpuBuffer> &constantBuffer, uint64 byteOffset, uint64 byteCount) = 0;
   virtual void setSamplerState(uint32 slot, const std::shared_ptr<SamplerState> &samplerState) = 0;
   virtual void setScissorDimensions(const ScissorDesc &desc) = 0;
 
@@ -75,6 +85,8 @@ public:
 
   virtual void draw(uint32 vertexCount, uint32 vertexOffset) = 0;
   virtual void drawIndexed(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset) = 0;
+  virtual void drawInstanced(uint32 vertexCount, uint32 vertexOffset, uint32 instanceCount) = 0;
+  virtual void drawIndexedInstanced(uint32 indexCount, uint32 indexOffset, uint32 vertexOffset, uint32 instanceCount) = 0;
 
   virtual void clearBuffers(uint32 buffers, const Colour &colour = Colour::Black, float32 depth = 1.0f, int32 stencil = 0) = 0;
 
@@ -99,6 +111,7 @@ public:
     return std::shared_ptr<VertexLayout>(new VertexLayout(desc));
   }
 
+  uint32 getFrameCount() const { return _desc.FrameCount; }
   uint32 getRenderWidth() const { return _desc.RenderWidth; }
   uint32 getRenderHeight() const { return _desc.RenderHeight; }
 
@@ -10,6 +10,8 @@ struct RenderTargetDesc
   uint32 Height;
   std::shared_ptr<Texture> ColourTargets[MaxColourTargets];
   std::shared_ptr<Texture> DepthStencilTarget;
+  /// @brief The single layer of an array depth target to render to, or every layer when negative.
+  int32 DepthStencilLayer = -1;
 };
 
 class RenderTarget
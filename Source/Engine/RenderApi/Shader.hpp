@@ -15,7 +15,11 @@ enum class ShaderType
 struct ShaderDesc
 {
   ShaderType ShaderType;
+  /// @brief Read from FilePath when left empty.
   std::string Source;
+  /// @brief File the source comes from, if any. Shaders built from a file are rebuilt whenever it or a header it
+  /// includes changes on disk.
+  std::string FilePath;
 };
 
 class Shader
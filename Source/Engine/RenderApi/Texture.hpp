@@ -18,6 +18,10 @@ enum class TextureFormat
   RGB32F,
   /// 32-bit red, green, blue and alpha channels stored as a signed floats.
   RGBA16F,
+  /// 32-bit red, green, blue and alpha channels stored as floats, for data read back exactly with texelFetch.
+  RGBA32F,
+  /// 32-bit red channel stored as an unsigned integer, sampled through a usampler.
+  R32UI,
   /// 32-bit depth channel stored as unsigned bytes.
   D32,
   /// 32-bit depth channel stored as floats.
@@ -25,7 +29,23 @@ enum class TextureFormat
   /// 24-bit depth channel with an 8 bit stencil channel stored as unsigned bytes.
   D24S8,
   /// 24-bit depth channel stored as unsigned bytes.
-  D24
+  D24,
+  /// Block compressed red, green and blue at 4 bits per pixel.
+  BC1,
+  /// Block compressed red, green and blue with interpolated alpha at 8 bits per pixel.
+  BC3,
+  /// Block compressed red channel at 4 bits per pixel.
+  BC4,
+  /// Block compressed red and green channels at 8 bits per pixel, used for tangent space normals.
+  BC5,
+  /// Block compressed red, green, blue and alpha at 8 bits per pixel.
+  BC7,
+  /// 16-bit red channel stored as a signed float.
+  R16F,
+  /// 16-bit red and green channels stored as signed floats.
+  RG16F,
+  /// 32-bit red channel stored as a float.
+  R32F
 };
 
 enum class TextureUsage
@@ -73,8 +93,29 @@ public:
 
   virtual void writeData(uint32 mipLevel, uint32 face, const std::shared_ptr<ImageData> &data) = 0;
   virtual void writeData(uint32 mipLevel, uint32 face, uint32 xStart, uint32 xCount, uint32 yStart, uint32 yCount, uint32 zStart, uint32 zCount, void *data) = 0;
+  /// @brief Writes a whole mip level of a block compressed 2D texture, laid out as rows of 4x4 blocks.
+  virtual void writeCompressedData(uint32 mipLevel, const void *data, uint64 byteCount) = 0;
+  /// @brief Not supported by block compressed textures, whose mip chains are uploaded with writeCompressedData.
   virtual void generateMips() = 0;
 
+  static bool isBlockCompressed(TextureFormat format)
+  {
+    return format == TextureFormat::BC1 || format == TextureFormat::BC3 || format == TextureFormat::BC4 ||
+           format == TextureFormat::BC5 || format == TextureFormat::BC7;
+  }
+
+  /// @brief Bytes per 4x4 block of a block compressed format.
+  static uint32 getBlockBytes(TextureFormat format)
+  {
+    return format == TextureFormat::BC1 || format == TextureFormat::BC4 ? 8 : 16;
+  }
+
+  /// @brief Bytes taken by a width x height surface of a block compressed format. Partial blocks are padded out.
+  static uint64 getCompressedSize(TextureFormat format, uint32 width, uint32 height)
+  {
+    return static_cast<uint64>((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes(format);
+  }
+
 protected:
   TextureDesc _desc;
   bool _gammaCorrected;
@@ -0,0 +1,41 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "../Core/Types.hpp"
+
+class Texture;
+
+/// @brief Copies the top mip of a 2D texture back to host memory. Copies are queued behind the GPU's work and collected
+/// a few frames later so that reading them never stalls the pipeline.
+class TextureReadback
+{
+public:
+  virtual ~TextureReadback() = default;
+
+  /// @brief Queues a copy of the texture as it will be once the GPU reaches this point.
+  /// @return Identifies the copy among those made by this readback, counting up from zero.
+  virtual uint64 copy(const std::shared_ptr<Texture> &texture) = 0;
+
+  /// @brief Collects whichever queued copies the GPU has finished, keeping the most recent.
+  virtual void resolve() = 0;
+
+  /// @brief True once at least one copy has been collected.
+  bool hasResult() const { return _hasResult; }
+  /// @brief The id copy() returned for the copy held in the data.
+  uint64 getResultId() const { return _resultId; }
+  uint32 getResultWidth() const { return _resultWidth; }
+  uint32 getResultHeight() const { return _resultHeight; }
+  /// @brief Tightly packed rows of the collected copy, from the bottom row up.
+  const std::vector<ubyte> &getData() const { return _data; }
+
+protected:
+  TextureReadback() : _nextId(0), _resultId(0), _resultWidth(0), _resultHeight(0), _hasResult(false) {}
+
+protected:
+  uint64 _nextId;
+  uint64 _resultId;
+  uint32 _resultWidth;
+  uint32 _resultHeight;
+  bool _hasResult;
+  std::vector<ubyte> _data;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include "../Core/Types.hpp"
+
+/// @brief Measures GPU execution time between a begin() and end() scope. Results are read back a few frames late so
+/// that retrieving them never stalls the pipeline.
+class TimerQuery
+{
+public:
+  virtual ~TimerQuery() = default;
+
+  virtual void begin() = 0;
+  virtual void end() = 0;
+
+  /// @brief True once at least one scope has been resolved.
+  bool hasResult() const { return _resultCount > 0; }
+  /// @brief Duration in nanoseconds of the most recently resolved scope.
+  uint64 getLastDuration() const { return _lastDuration; }
+  /// @brief Number of scopes resolved so far. A new result has arrived whenever this differs from an earlier read.
+  uint64 getResultCount() const { return _resultCount; }
+
+protected:
+  TimerQuery() : _lastDuration(0), _resultCount(0) {}
+
+protected:
+  uint64 _lastDuration;
+  uint64 _resultCount;
+};
@@ -0,0 +1,62 @@
+#include "UploadArena.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+UploadArena::UploadArena(const UploadArenaDesc &desc,
+                         const std::shared_ptr<GpuBuffer> &buffer,
+                         uint32 frameCount,
+                         uint64 alignment) : _desc(desc),
+                                             _buffer(buffer),
+                                             _staging(desc.ByteCount),
+                                             _frameCount(frameCount),
+                                             _frameIndex(0),
+                                             _alignment(alignment),
+                                             _head(0),
+                                             _flushedHead(0),
+                                             _frameStarted(false)
+{
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+  {
+    throw std::runtime_error("Upload arena alignment must be a power of two");
+  }
+}
+
+uint64 UploadArena::write(const void *src, uint64 byteCount)
+{
+  uint64 offset = getAlignedSize(_head);
+  if (offset + byteCount > _desc.ByteCount)
+  {
+    throw std::runtime_error("Upload arena frame capacity exceeded");
+  }
+
+  std::memcpy(_staging.data() + offset, src, byteCount);
+  _head = offset + byteCount;
+  return getSliceOffset() + offset;
+}
+
+void UploadArena::flush()
+{
+  if (_head == _flushedHead)
+  {
+    return;
+  }
+
+  // Nothing the GPU is reading overlaps this slice, so the upload does not need to synchronise.
+  _buffer->writeData(getSliceOffset() + _flushedHead,
+                     _head - _flushedHead,
+                     _staging.data() + _flushedHead,
+                     AccessType::WriteOnlyUnsynchronized);
+  _flushedHead = _head;
+}
+
+void UploadArena::advanceFrame()
+{
+  if (_frameStarted)
+  {
+    _frameIndex = (_frameIndex + 1) % _frameCount;
+  }
+  _frameStarted = true;
+  _head = 0;
+  _flushedHead = 0;
+}
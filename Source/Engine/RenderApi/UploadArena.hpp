@@ -0,0 +1,53 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "GpuBuffer.hpp"
+
+struct UploadArenaDesc
+{
+  /// @brief Capacity of a single frame's slice. The backing buffer holds one slice per frame in flight.
+  uint64 ByteCount;
+  BufferType BufferType = BufferType::Constant;
+};
+
+/// @brief Linear per-frame allocator over a single GPU buffer split into one slice per frame in flight. Data written
+/// during a frame is staged and uploaded to that frame's slice with a single flush, and each allocation is later bound
+/// by offset with a ranged bind.
+class UploadArena
+{
+public:
+  virtual ~UploadArena() = default;
+
+  const UploadArenaDesc &getDesc() const { return _desc; }
+  const std::shared_ptr<GpuBuffer> &getBuffer() const { return _buffer; }
+  uint64 getAlignment() const { return _alignment; }
+  uint64 getBytesUsed() const { return _head; }
+  uint64 getAlignedSize(uint64 byteCount) const { return (byteCount + _alignment - 1) & ~(_alignment - 1); }
+
+  /// @brief Moves on to the next slice, waiting for the GPU to release it if it is still in use.
+  virtual void beginFrame() = 0;
+
+  /// @brief Stages byteCount bytes and returns their offset into the backing buffer.
+  uint64 write(const void *src, uint64 byteCount);
+
+  /// @brief Uploads everything staged since beginFrame(). Offsets returned by write() are only valid to bind after this.
+  void flush();
+
+protected:
+  UploadArena(const UploadArenaDesc &desc, const std::shared_ptr<GpuBuffer> &buffer, uint32 frameCount, uint64 alignment);
+
+  uint64 getSliceOffset() const { return _frameIndex * _desc.ByteCount; }
+  /// @brief Resets the allocator onto the next slice. The very first frame stays on slice zero.
+  void advanceFrame();
+
+protected:
+  UploadArenaDesc _desc;
+  std::shared_ptr<GpuBuffer> _buffer;
+  std::vector<ubyte> _staging;
+  uint32 _frameCount;
+  uint32 _frameIndex;
+  uint64 _alignment;
+  uint64 _head;
+  uint64 _flushedHead;
+  bool _frameStarted;
+};
@@ -10,7 +10,17 @@ enum class SemanticType
   TexCoord = 2,
   Tangent = 3,
   Bitangent = 4,
-  Colour = 5
+  Colour = 5,
+  Instance0 = 6,
+  Instance1 = 7,
+  Instance2 = 8,
+  Instance3 = 9
+};
+
+enum class VertexInputRate
+{
+  PerVertex,
+  PerInstance
 };
 
 enum class SemanticFormat
@@ -34,20 +44,31 @@ enum class SemanticFormat
   Ubyte4,
   Ubyte3,
   Ubyte2,
-  Ubyte
+  Ubyte,
+  Short2,
+  Short4,
+  Ushort4,
+  /// @brief Two 16-bit floats.
+  Half2
 };
 
 struct VertexLayoutDesc
 {
-  VertexLayoutDesc(SemanticType type, SemanticFormat format, bool normalized = false) : Type(type),
-                                                                                        Format(format),
-                                                                                        Normalised(normalized)
+  VertexLayoutDesc(SemanticType type,
+                   SemanticFormat format,
+                   bool normalized = false,
+                   VertexInputRate inputRate = VertexInputRate::PerVertex) : Type(type),
+                                                                            Format(format),
+                                                                            Normalised(normalized),
+                                                                            InputRate(inputRate)
   {
   }
 
   SemanticType Type;
   SemanticFormat Format;
   bool Normalised;
+  /// @brief Per-instance attributes are sourced from the buffer set with RenderDevice::setInstanceBuffer.
+  VertexInputRate InputRate;
 };
 
 class VertexLayout
@@ -56,10 +77,18 @@ class VertexLayout
 
 public:
   const std::vector<VertexLayoutDesc> &getDesc() const { return _desc; }
+  bool hasInstanceAttributes() const { return _hasInstanceAttributes; }
 
 protected:
-  VertexLayout(const std::vector<VertexLayoutDesc> &desc) : _desc(desc) {}
+  VertexLayout(const std::vector<VertexLayoutDesc> &desc) : _desc(desc), _hasInstanceAttributes(false)
+  {
+    for (const auto &layout : _desc)
+    {
+      _hasInstanceAttributes |= layout.InputRate == VertexInputRate::PerInstance;
+    }
+  }
 
 protected:
   std::vector<VertexLayoutDesc> _desc;
+  bool _hasInstanceAttributes;
 };
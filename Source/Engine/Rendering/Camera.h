@@ -33,6 +33,8 @@ public:
   const Transform &getParentTransform() const { return _transform; }
 
   const Frustrum &getFustrum() const { return _frustrum; }
+  /// @brief The frustrum used for culling, which stays put while "Fix Frustrum" is enabled.
+  const Frustrum &getCullingFrustrum() const { return _fixFrustrum ? _fixedFrustrum : _frustrum; }
 
   bool contains(const Aabb &aabb, const Transform &transform) const;
   float32 distanceFrom(const Vector3 &position) const;
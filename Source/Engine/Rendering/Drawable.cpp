@@ -2,6 +2,8 @@
 
 #include <cmath>
 
+#include "../Core/BoundingVolumeHierarchy.h"
+#include "../Maths/AabbArray.hpp"
 #include "../Core/Maths.h"
 #include "../UI/ImGui/imgui.h"
 #include "../UI/UiManager.hpp"
@@ -12,9 +14,13 @@ Drawable::Drawable() : Component(ComponentType::Drawable),
 											 _currentScale(Vector3::Identity),
 											 _drawAabb(false),
 											 _modified(true),
-											 _scale(Vector3::Identity),
 											 _position(Vector3::Zero),
-											 _rotation(Quaternion::Zero)
+											 _transform(Matrix4::Identity),
+											 _bvhProxy(BoundingVolumeHierarchy::NullNode),
+											 _bvhDirty(false),
+											 _cullingBounds(nullptr),
+											 _cullingBoundsIndex(0),
+											 _lod(0)
 {
 	_currentRotationEuler[0] = Radian(0.0f);
 	_currentRotationEuler[1] = Radian(0.0f);
@@ -31,6 +37,22 @@ void Drawable::drawInspector()
 		ImGui::ColorEdit3("Diffuse", rawCol);
 		material->setDiffuseColour(Colour(rawCol[0] * 255, rawCol[1] * 255, rawCol[2] * 255));
 
+		// Shared by every drawable using the mesh, so switching it here compares the encodings wherever it appears.
+		if (_mesh && _mesh->supportsCompactVertices())
+		{
+			const char *vertexFormats[] = {"Full", "Compact", "Compact, Quantized Positions"};
+			int vertexFormat = static_cast<int>(_mesh->getVertexFormat());
+			if (ImGui::Combo("Vertex Format", &vertexFormat, vertexFormats, static_cast<int>(VertexFormat::Count)))
+			{
+				_mesh->setVertexFormat(static_cast<VertexFormat>(vertexFormat));
+			}
+			ImGui::Text("Vertex data: %.1f KB", _mesh->getVertexCount() * VertexCompression::getStride(_mesh->getVertexFormat()) / 1024.0f);
+		}
+		if (_mesh && _mesh->getLodCount() > 1)
+		{
+			ImGui::Text("Level of detail: %u of %u, %u triangles", _lod, _mesh->getLodCount() - 1, _mesh->getLod(_lod).IndexCount / 3);
+		}
+
 		ImGui::Separator();
 		ImGui::Text("PBR Material");
 		if (_material->hasDiffuseTexture())
@@ -196,11 +218,31 @@ void Drawable::drawInspector()
 	}
 }
 
+Aabb Drawable::getWorldAabb() const
+{
+	Vector3 extents(_currAabb.getExtents());
+	return Aabb(_position + _currAabb.getCenter(), extents.X, extents.Y, extents.Z);
+}
+
+bool Drawable::clearBvhDirty()
+{
+	bool dirty = _bvhDirty;
+	_bvhDirty = false;
+	return dirty;
+}
+
+void Drawable::setCullingBounds(AabbArray *bounds, uint32 index)
+{
+	_cullingBounds = bounds;
+	_cullingBoundsIndex = index;
+}
+
 Drawable &Drawable::setMesh(std::shared_ptr<StaticMesh> mesh)
 {
 	_mesh = mesh;
 	_initAabb = mesh->getAabb();
 	_currAabb = _initAabb;
+	_lod = 0;
 	_modified = true;
 	return *this;
 }
@@ -215,27 +257,25 @@ void Drawable::onUpdate(float32 dt)
 {
 	if (_modified)
 	{
-		updateAabb(_scale, _rotation);
-
-		Matrix4 translation = Matrix4::Translation(_position);
-		Matrix4 scale = Matrix4::Scaling(_scale);
-		Matrix4 rotation = Matrix4::Rotation(_rotation);
-		_transform = translation * scale * rotation;
+		updateAabb();
 
+		_bvhDirty = _bvhProxy != BoundingVolumeHierarchy::NullNode;
+		if (_cullingBounds != nullptr)
+		{
+			_cullingBounds->set(_cullingBoundsIndex, getWorldAabb());
+		}
 		_modified = false;
 	}
 }
 
 void Drawable::onNotify(const GameObject &gameObject)
 {
-	Transform transform(gameObject.getGlobalTransform());
-	_scale = transform.getScale();
-	_rotation = transform.getRotation();
-	_position = transform.getPosition();
+	_transform = gameObject.getWorldMatrix();
+	_position = Vector3(_transform[3][0], _transform[3][1], _transform[3][2]);
 	_modified = true;
 }
 
-void Drawable::updateAabb(Vector3 scalingDelta, Quaternion rotationDelta)
+void Drawable::updateAabb()
 {
 	Vector3 min(_initAabb.getMin());
 	Vector3 max(_initAabb.getMax());
@@ -243,9 +283,8 @@ void Drawable::updateAabb(Vector3 scalingDelta, Quaternion rotationDelta)
 	Vector3 newMax(0);
 
 	float32 a, b;
-	Matrix4 rotation = Matrix4::Rotation(rotationDelta);
-	Matrix4 scaling = Matrix4::Scaling(scalingDelta);
-	Matrix3 transform(Matrix4::ToMatrix3(scaling * rotation));
+	// The upper 3x3 of the world matrix holds the combined rotation and scale of the whole parent chain.
+	Matrix3 transform(Matrix4::ToMatrix3(_transform));
 
 	for (int i = 0; i < 3; i++)
 	{
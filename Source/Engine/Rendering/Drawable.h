@@ -8,6 +8,7 @@
 #include "../Core/Maths.h"
 #include "../Maths/Radian.hpp"
 
+class AabbArray;
 class StaticMesh;
 class Material;
 
@@ -27,16 +28,29 @@ public:
   void enableDrawAabb(bool enable) { _drawAabb = enable; }
 
   const Aabb &getAabb() const { return _currAabb; }
+  /// @brief The current AABB translated into world space.
+  Aabb getWorldAabb() const;
   bool shouldDrawAabb() const { return _drawAabb; }
 
   Vector3 getPosition() const { return _position; }
   Matrix4 getMatrix() const { return _transform; }
 
+  void setBvhProxy(int32 proxyId) { _bvhProxy = proxyId; }
+  int32 getBvhProxy() const { return _bvhProxy; }
+  /// @brief Returns whether the bounds changed since the last call, so that the owner can refit the BVH proxy.
+  bool clearBvhDirty();
+  /// @brief Registers the slot in the scene's culling bounds which is kept in sync with this drawable's bounds.
+  void setCullingBounds(AabbArray *bounds, uint32 index);
+
+  /// @brief The mesh's level of detail chosen for the camera last frame, which selection starts from next frame.
+  void setLod(uint32 lod) { _lod = lod; }
+  uint32 getLod() const { return _lod; }
+
 private:
   void onUpdate(float32 dt) override;
   void onNotify(const GameObject &gameObject) override;
 
-  void updateAabb(Vector3 scalingDelta, Quaternion rotationDelta);
+  void updateAabb();
 
   std::shared_ptr<StaticMesh> _mesh;
   std::shared_ptr<Material> _material;
@@ -45,12 +59,15 @@ private:
   std::array<Radian, 3> _currentRotationEuler;
   Vector3 _currentScale;
 
-  Vector3 _scale;
   Vector3 _position;
-  Quaternion _rotation;
-
   Matrix4 _transform;
 
+  int32 _bvhProxy;
+  bool _bvhDirty;
+  AabbArray *_cullingBounds;
+  uint32 _cullingBoundsIndex;
+  uint32 _lod;
+
   bool _drawAabb;
   bool _modified;
 };
\ No newline at end of file
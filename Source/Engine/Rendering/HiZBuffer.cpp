@@ -0,0 +1,212 @@
+#include "HiZBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../Maths/AabbArray.hpp"
+
+namespace
+{
+  /// @brief Marks texels of a reprojection which no depth landed in.
+  const float32 NO_DEPTH = -1.0f;
+  /// @brief Clip space w below which a corner is treated as behind the camera.
+  const float32 MIN_CLIP_W = 1e-5f;
+}
+
+HiZBuffer::HiZBuffer() : _viewProjection(Matrix4::Identity)
+{
+}
+
+void HiZBuffer::setDepth(const float32 *depths, uint32 width, uint32 height, const Matrix4 &viewProjection)
+{
+  resize(width, height);
+  std::copy(depths, depths + static_cast<uint64>(width) * height, _levels[0].begin());
+  _viewProjection = viewProjection;
+  buildPyramid();
+}
+
+void HiZBuffer::reproject(const HiZBuffer &source, const Matrix4 &viewProjection)
+{
+  uint32 width = source.getWidth();
+  uint32 height = source.getHeight();
+  resize(width, height);
+  _viewProjection = viewProjection;
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+
+  // Each source texel's center is carried back to world space and into the new view, where the furthest of the depths
+  // landing in a texel is kept.
+  _scratch.assign(static_cast<uint64>(width) * height, NO_DEPTH);
+  Matrix4 reprojection = viewProjection * source.getViewProjection().Inverse();
+  const std::vector<float32> &sourceDepths = source._levels[0];
+  for (uint32 y = 0; y < height; y++)
+  {
+    float32 ndcY = (y + 0.5f) / height * 2.0f - 1.0f;
+    for (uint32 x = 0; x < width; x++)
+    {
+      float32 depth = sourceDepths[y * width + x];
+      if (depth >= 1.0f)
+      {
+        continue;
+      }
+
+      float32 ndcX = (x + 0.5f) / width * 2.0f - 1.0f;
+      Vector4 clip = reprojection * Vector4(ndcX, ndcY, depth * 2.0f - 1.0f, 1.0f);
+      if (clip.W < MIN_CLIP_W)
+      {
+        continue;
+      }
+      float32 targetX = (clip.X / clip.W * 0.5f + 0.5f) * width;
+      float32 targetY = (clip.Y / clip.W * 0.5f + 0.5f) * height;
+      float32 targetDepth = clip.Z / clip.W * 0.5f + 0.5f;
+      if (targetX < 0.0f || targetY < 0.0f || targetX >= width || targetY >= height || targetDepth < 0.0f)
+      {
+        continue;
+      }
+
+      float32 &target = _scratch[static_cast<uint32>(targetY) * width + static_cast<uint32>(targetX)];
+      target = std::max(target, std::min(targetDepth, 1.0f));
+    }
+  }
+
+  // Texels beside a hole may be only partly covered by the depth that landed in them, so the furthest depth around
+  // each texel is taken with holes counting as the far plane.
+  std::vector<float32> &level = _levels[0];
+  for (uint32 y = 0; y < height; y++)
+  {
+    for (uint32 x = 0; x < width; x++)
+    {
+      float32 furthest = 0.0f;
+      for (uint32 sy = (y > 0 ? y - 1 : 0); sy <= std::min(y + 1, height - 1); sy++)
+      {
+        for (uint32 sx = (x > 0 ? x - 1 : 0); sx <= std::min(x + 1, width - 1); sx++)
+        {
+          float32 depth = _scratch[sy * width + sx];
+          furthest = std::max(furthest, depth == NO_DEPTH ? 1.0f : depth);
+        }
+      }
+      level[y * width + x] = furthest;
+    }
+  }
+  buildPyramid();
+}
+
+bool HiZBuffer::isOccluded(const Vector3 &center, const Vector3 &extents) const
+{
+  if (_levels.empty())
+  {
+    return false;
+  }
+
+  float32 minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+  float32 nearestDepth = 1.0f;
+  for (uint32 i = 0; i < 8; i++)
+  {
+    Vector3 corner(center.X + ((i & 1) ? extents.X : -extents.X),
+                   center.Y + ((i & 2) ? extents.Y : -extents.Y),
+                   center.Z + ((i & 4) ? extents.Z : -extents.Z));
+    Vector4 clip = _viewProjection * Vector4(corner, 1.0f);
+    if (clip.W < MIN_CLIP_W)
+    {
+      return false;
+    }
+    float32 inverseW = 1.0f / clip.W;
+    minX = std::min(minX, clip.X * inverseW);
+    minY = std::min(minY, clip.Y * inverseW);
+    maxX = std::max(maxX, clip.X * inverseW);
+    maxY = std::max(maxY, clip.Y * inverseW);
+    nearestDepth = std::min(nearestDepth, clip.Z * inverseW * 0.5f + 0.5f);
+  }
+  if (nearestDepth <= 0.0f || maxX < -1.0f || maxY < -1.0f || minX > 1.0f || minY > 1.0f)
+  {
+    return false;
+  }
+
+  // The level at which the box covers at most two texels across gives at most four texels to compare against.
+  int32 width = static_cast<int32>(_widths[0]);
+  int32 height = static_cast<int32>(_heights[0]);
+  int32 x0 = std::max(static_cast<int32>(std::floor((minX * 0.5f + 0.5f) * width)), 0);
+  int32 y0 = std::max(static_cast<int32>(std::floor((minY * 0.5f + 0.5f) * height)), 0);
+  int32 x1 = std::min(static_cast<int32>(std::floor((maxX * 0.5f + 0.5f) * width)), width - 1);
+  int32 y1 = std::min(static_cast<int32>(std::floor((maxY * 0.5f + 0.5f) * height)), height - 1);
+  uint32 level = 0;
+  while (level + 1 < _levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+  {
+    level++;
+  }
+
+  float32 furthestDepth = 0.0f;
+  for (int32 y = y0 >> level; y <= (y1 >> level); y++)
+  {
+    for (int32 x = x0 >> level; x <= (x1 >> level); x++)
+    {
+      furthestDepth = std::max(furthestDepth, getDepth(level, x, y));
+    }
+  }
+  return nearestDepth > furthestDepth;
+}
+
+bool HiZBuffer::isOccluded(const Aabb &aabb) const
+{
+  return isOccluded(aabb.getCenter(), aabb.getExtents());
+}
+
+bool HiZBuffer::isOccluded(const AabbArray &bounds, uint32 index) const
+{
+  return isOccluded(Vector3(bounds.getCenterX()[index], bounds.getCenterY()[index], bounds.getCenterZ()[index]),
+                    Vector3(bounds.getExtentX()[index], bounds.getExtentY()[index], bounds.getExtentZ()[index]));
+}
+
+void HiZBuffer::resize(uint32 width, uint32 height)
+{
+  if (getWidth() == width && getHeight() == height && !_levels.empty())
+  {
+    return;
+  }
+
+  _levels.clear();
+  _widths.clear();
+  _heights.clear();
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+
+  // Odd sizes round up, so every texel of a level has at least one texel beneath it.
+  while (true)
+  {
+    _widths.push_back(width);
+    _heights.push_back(height);
+    _levels.emplace_back(static_cast<uint64>(width) * height, 1.0f);
+    if (width == 1 && height == 1)
+    {
+      break;
+    }
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+  }
+}
+
+void HiZBuffer::buildPyramid()
+{
+  for (uint32 level = 1; level < _levels.size(); level++)
+  {
+    const std::vector<float32> &below = _levels[level - 1];
+    uint32 belowWidth = _widths[level - 1];
+    uint32 belowHeight = _heights[level - 1];
+    for (uint32 y = 0; y < _heights[level]; y++)
+    {
+      uint32 y0 = y * 2;
+      uint32 y1 = std::min(y0 + 1, belowHeight - 1);
+      for (uint32 x = 0; x < _widths[level]; x++)
+      {
+        uint32 x0 = x * 2;
+        uint32 x1 = std::min(x0 + 1, belowWidth - 1);
+        _levels[level][y * _widths[level] + x] = std::max(std::max(below[y0 * belowWidth + x0], below[y0 * belowWidth + x1]),
+                                                          std::max(below[y1 * belowWidth + x0], below[y1 * belowWidth + x1]));
+      }
+    }
+  }
+}
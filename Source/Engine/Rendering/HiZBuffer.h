@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Maths.h"
+#include "../Core/Types.hpp"
+
+class Aabb;
+class AabbArray;
+
+/// @brief A depth pyramid on the CPU for occlusion culling. Depths are in window space, zero at the near plane and one
+/// at the far plane, with rows from the bottom up. Each texel of a level holds the furthest depth of the texels beneath
+/// it, so a box whose nearest point is beyond every texel it covers is hidden by what was drawn.
+class HiZBuffer
+{
+public:
+  HiZBuffer();
+
+  /// @brief Takes width by height depths drawn with viewProjection and builds the pyramid over them.
+  void setDepth(const float32 *depths, uint32 width, uint32 height, const Matrix4 &viewProjection);
+
+  /// @brief Moves the depths of another buffer, drawn from another view, into viewProjection at the same size. Texels no
+  /// depth lands in, and their neighbours, are left at the far plane, so nothing is culled where surfaces hidden from
+  /// the other view come into sight.
+  void reproject(const HiZBuffer &source, const Matrix4 &viewProjection);
+
+  /// @brief True when the box lies entirely beyond the depths it covers. Boxes crossing the near plane never are.
+  bool isOccluded(const Vector3 &center, const Vector3 &extents) const;
+  bool isOccluded(const Aabb &aabb) const;
+  bool isOccluded(const AabbArray &bounds, uint32 index) const;
+
+  bool isEmpty() const { return _levels.empty(); }
+  uint32 getWidth() const { return _widths.empty() ? 0 : _widths[0]; }
+  uint32 getHeight() const { return _heights.empty() ? 0 : _heights[0]; }
+  uint32 getLevelCount() const { return static_cast<uint32>(_levels.size()); }
+  float32 getDepth(uint32 level, uint32 x, uint32 y) const { return _levels[level][y * _widths[level] + x]; }
+  const Matrix4 &getViewProjection() const { return _viewProjection; }
+
+private:
+  void resize(uint32 width, uint32 height);
+  void buildPyramid();
+
+  std::vector<std::vector<float32>> _levels;
+  std::vector<uint32> _widths;
+  std::vector<uint32> _heights;
+  Matrix4 _viewProjection;
+  /// @brief Reprojected depths before they are filtered into the first level.
+  std::vector<float32> _scratch;
+};
@@ -3,13 +3,19 @@
 #include "../UI/ImGui/imgui.h"
 #include "../Core/GameObject.h"
 
+static uint32 ID_COUNTER = 0;
+
 Light::Light() : Component(ComponentType::Light),
+								 _id(ID_COUNTER++),
 								 _colour(Colour::White),
 								 _radius(10.0f),
 								 _lightType(LightType::Point),
 								 _modified(true),
 								 _direction(Vector3::Identity),
-								 _intensity(100.0f)
+								 _intensity(100.0f),
+								 _spotInnerAngle(20.0f),
+								 _spotOuterAngle(30.0f),
+								 _castShadows(false)
 {
 }
 
@@ -22,12 +28,30 @@ void Light::drawInspector()
 		setColour(Colour(rawCol[0] * 255, rawCol[1] * 255, rawCol[2] * 255));
 
 		float32 radius = _radius;
-		if (_lightType == LightType::Point)
+		if (_lightType == LightType::Point || _lightType == LightType::Spot)
 		{
 			if (ImGui::SliderFloat("Radius", &radius, 0.0f, 200.0f))
 			{
 				setRadius(radius);
 			}
+
+			bool castShadows = _castShadows;
+			if (ImGui::Checkbox("Cast Shadows", &castShadows))
+			{
+				setCastShadows(castShadows);
+			}
+		}
+
+		if (_lightType == LightType::Spot)
+		{
+			float32 innerAngle = _spotInnerAngle.InDegrees();
+			float32 outerAngle = _spotOuterAngle.InDegrees();
+			bool innerChanged = ImGui::SliderFloat("Inner Angle", &innerAngle, 0.0f, 89.0f);
+			bool outerChanged = ImGui::SliderFloat("Outer Angle", &outerAngle, 0.0f, 89.0f);
+			if (innerChanged || outerChanged)
+			{
+				setSpotAngles(Degree(innerAngle), Degree(outerAngle));
+			}
 		}
 
 		float32 intensity = _intensity;
@@ -66,6 +90,20 @@ Light &Light::setIntensity(float32 intensity)
 	return *this;
 }
 
+Light &Light::setSpotAngles(const Degree &innerAngle, const Degree &outerAngle)
+{
+	_spotOuterAngle = outerAngle;
+	_spotInnerAngle = innerAngle.InDegrees() < outerAngle.InDegrees() ? innerAngle : outerAngle;
+	_modified = true;
+	return *this;
+}
+
+Light &Light::setCastShadows(bool castShadows)
+{
+	_castShadows = castShadows;
+	return *this;
+}
+
 void Light::onUpdate(float32 dt)
 {
 	if (_modified)
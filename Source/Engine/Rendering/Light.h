@@ -21,6 +21,12 @@ public:
 	Light &setRadius(float32 radius);
 	Light &setLightType(LightType lightType);
 	Light &setIntensity(float32 intensity);
+	/// @brief Half angles of a spot light's cone, fully lit inside the inner and fading to nothing at the outer.
+	Light &setSpotAngles(const Degree &innerAngle, const Degree &outerAngle);
+	/// @brief Point and spot lights casting shadows are given space in the renderer's shadow atlas.
+	Light &setCastShadows(bool castShadows);
+
+	uint32 getId() const { return _id; }
 
 	Matrix4 getMatrix() const { return _matrix; }
 	Vector3 getPosition() const { return _position; }
@@ -30,11 +36,15 @@ public:
 	LightType getLightType() const { return _lightType; }
 	Vector3 getDirection() const { return _direction; }
 	float32 getIntensity() const { return _intensity; }
+	Degree getSpotInnerAngle() const { return _spotInnerAngle; }
+	Degree getSpotOuterAngle() const { return _spotOuterAngle; }
+	bool castsShadows() const { return _castShadows; }
 
 private:
 	void onUpdate(float32 dt) override;
 	void onNotify(const GameObject &gameObject) override;
 
+	uint32 _id;
 	Colour _colour;
 	float32 _radius;
 	LightType _lightType;
@@ -43,6 +53,9 @@ private:
 	Matrix4 _matrix;
 	Vector3 _direction;
 	float32 _intensity;
+	Degree _spotInnerAngle;
+	Degree _spotOuterAngle;
+	bool _castShadows;
 
 	bool _modified;
 };
@@ -0,0 +1,196 @@
+#include "LightClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "../Core/JobSystem.h"
+
+namespace
+{
+  const uint32 LIGHT_BOUNDS_GRAIN_SIZE = 256;
+
+  void runParallel(JobSystem *jobs, uint32 count, uint32 grainSize, const std::function<void(uint32, uint32)> &function)
+  {
+    if (jobs)
+    {
+      jobs->parallelFor(count, grainSize, function);
+    }
+    else if (count > 0)
+    {
+      function(0, count);
+    }
+  }
+
+  uint32 getTile(float32 ndc, uint32 tileCount)
+  {
+    float32 tile = std::floor((ndc + 1.0f) * 0.5f * tileCount);
+    return static_cast<uint32>(std::min(std::max(tile, 0.0f), static_cast<float32>(tileCount - 1)));
+  }
+
+  /// @brief Bounds in normalised device coordinates of the extent [minimum, maximum] along one axis, seen anywhere
+  /// between the view depths nearDepth and farDepth. Negative extents project widest at the near depth and positive
+  /// ones at the far depth, or the other way around for the upper bound.
+  void projectExtent(float32 minimum, float32 maximum, float32 nearDepth, float32 farDepth, float32 tanHalfFov, float32 &ndcMin, float32 &ndcMax)
+  {
+    ndcMin = minimum / ((minimum < 0.0f ? nearDepth : farDepth) * tanHalfFov);
+    ndcMax = maximum / ((maximum > 0.0f ? nearDepth : farDepth) * tanHalfFov);
+  }
+}
+
+LightClusters::LightClusters() : _clusters(CLUSTER_COUNT, 0),
+                                 _slices(SLICES),
+                                 _visibleLightCount(0),
+                                 _droppedCount(0),
+                                 _maxClusterLightCount(0)
+{
+}
+
+Vector2 LightClusters::getSliceScaleBias(float32 nearClip, float32 farClip)
+{
+  float32 scale = SLICES / std::log(farClip / nearClip);
+  return Vector2(scale, -std::log(nearClip) * scale);
+}
+
+uint32 LightClusters::getSlice(float32 depth, float32 nearClip, float32 farClip)
+{
+  Vector2 scaleBias = getSliceScaleBias(nearClip, farClip);
+  float32 slice = std::floor(std::log(std::max(depth, nearClip)) * scaleBias.X + scaleBias.Y);
+  return static_cast<uint32>(std::min(std::max(slice, 0.0f), static_cast<float32>(SLICES - 1)));
+}
+
+void LightClusters::build(const std::vector<ClusterLight> &lights, const Radian &fovY, float32 aspect, float32 nearClip, float32 farClip, JobSystem *jobs)
+{
+  float32 tanHalfFovY = std::tan(fovY.InRadians() * 0.5f);
+  float32 tanHalfFovX = tanHalfFovY * aspect;
+  uint32 lightCount = static_cast<uint32>(lights.size());
+
+  _lightBounds.resize(lightCount);
+  runParallel(jobs, lightCount, LIGHT_BOUNDS_GRAIN_SIZE, [&](uint32 begin, uint32 end)
+              {
+                for (uint32 i = begin; i < end; i++)
+                {
+                  const ClusterLight &light = lights[i];
+                  LightBounds &bounds = _lightBounds[i];
+                  float32 depth = -light.Position.Z;
+                  float32 nearDepth = std::max(depth - light.Radius, nearClip);
+                  float32 farDepth = std::min(depth + light.Radius, farClip);
+                  bounds.Visible = light.Radius > 0.0f && nearDepth <= farDepth;
+                  if (!bounds.Visible)
+                  {
+                    continue;
+                  }
+
+                  float32 minX, maxX, minY, maxY;
+                  projectExtent(light.Position.X - light.Radius, light.Position.X + light.Radius, nearDepth, farDepth, tanHalfFovX, minX, maxX);
+                  projectExtent(light.Position.Y - light.Radius, light.Position.Y + light.Radius, nearDepth, farDepth, tanHalfFovY, minY, maxY);
+                  bounds.Visible = maxX >= -1.0f && minX <= 1.0f && maxY >= -1.0f && minY <= 1.0f;
+                  bounds.MinX = getTile(minX, TILES_X);
+                  bounds.MaxX = getTile(maxX, TILES_X);
+                  bounds.MinY = getTile(minY, TILES_Y);
+                  bounds.MaxY = getTile(maxY, TILES_Y);
+                  bounds.MinSlice = getSlice(nearDepth, nearClip, farClip);
+                  bounds.MaxSlice = getSlice(farDepth, nearClip, farClip);
+                }
+              });
+
+  // Slices are independent, each gathering the lights overlapping its clusters in ascending order.
+  float32 depthRatio = farClip / nearClip;
+  runParallel(jobs, SLICES, 1, [&](uint32 begin, uint32 end)
+              {
+                for (uint32 slice = begin; slice < end; slice++)
+                {
+                  SliceAssignment &assignment = _slices[slice];
+                  assignment.Tiles.clear();
+                  assignment.Lights.clear();
+                  assignment.DroppedCount = 0;
+
+                  float32 sliceNear = nearClip * std::pow(depthRatio, slice / static_cast<float32>(SLICES));
+                  float32 sliceFar = nearClip * std::pow(depthRatio, (slice + 1) / static_cast<float32>(SLICES));
+                  for (uint32 i = 0; i < lightCount; i++)
+                  {
+                    const LightBounds &bounds = _lightBounds[i];
+                    if (!bounds.Visible || slice < bounds.MinSlice || slice > bounds.MaxSlice)
+                    {
+                      continue;
+                    }
+
+                    const ClusterLight &light = lights[i];
+                    float32 radiusSquared = light.Radius * light.Radius;
+                    float32 dz = std::max(std::max(sliceNear + light.Position.Z, -sliceFar - light.Position.Z), 0.0f);
+                    for (uint32 y = bounds.MinY; y <= bounds.MaxY; y++)
+                    {
+                      // A cluster is bounded by its tile's edges at both its near and far depths.
+                      float32 bottom = (-1.0f + 2.0f * y / TILES_Y) * tanHalfFovY;
+                      float32 top = (-1.0f + 2.0f * (y + 1) / TILES_Y) * tanHalfFovY;
+                      float32 minY = std::min(bottom * sliceNear, bottom * sliceFar);
+                      float32 maxY = std::max(top * sliceNear, top * sliceFar);
+                      float32 dy = std::max(std::max(minY - light.Position.Y, light.Position.Y - maxY), 0.0f);
+                      for (uint32 x = bounds.MinX; x <= bounds.MaxX; x++)
+                      {
+                        float32 left = (-1.0f + 2.0f * x / TILES_X) * tanHalfFovX;
+                        float32 right = (-1.0f + 2.0f * (x + 1) / TILES_X) * tanHalfFovX;
+                        float32 minX = std::min(left * sliceNear, left * sliceFar);
+                        float32 maxX = std::max(right * sliceNear, right * sliceFar);
+                        float32 dx = std::max(std::max(minX - light.Position.X, light.Position.X - maxX), 0.0f);
+                        if (dx * dx + dy * dy + dz * dz <= radiusSquared)
+                        {
+                          assignment.Tiles.push_back(x + TILES_X * y);
+                          assignment.Lights.push_back(i);
+                        }
+                      }
+                    }
+                  }
+
+                  // Counting sort by tile, which keeps each tile's lights in ascending order.
+                  assignment.TileCounts.assign(TILES_X * TILES_Y, 0);
+                  for (uint32 tile : assignment.Tiles)
+                  {
+                    assignment.TileCounts[tile]++;
+                  }
+                  std::vector<uint32> starts(TILES_X * TILES_Y);
+                  uint32 sortedCount = 0;
+                  for (uint32 tile = 0; tile < TILES_X * TILES_Y; tile++)
+                  {
+                    starts[tile] = sortedCount;
+                    if (assignment.TileCounts[tile] > MAX_LIGHTS_PER_CLUSTER)
+                    {
+                      assignment.DroppedCount += assignment.TileCounts[tile] - MAX_LIGHTS_PER_CLUSTER;
+                      assignment.TileCounts[tile] = MAX_LIGHTS_PER_CLUSTER;
+                    }
+                    sortedCount += assignment.TileCounts[tile];
+                  }
+                  assignment.SortedLights.resize(sortedCount);
+                  std::vector<uint32> cursors(starts);
+                  for (uint32 i = 0; i < assignment.Tiles.size(); i++)
+                  {
+                    uint32 tile = assignment.Tiles[i];
+                    if (cursors[tile] < starts[tile] + assignment.TileCounts[tile])
+                    {
+                      assignment.SortedLights[cursors[tile]++] = assignment.Lights[i];
+                    }
+                  }
+                }
+              });
+
+  _lightIndices.clear();
+  _droppedCount = 0;
+  _maxClusterLightCount = 0;
+  for (uint32 slice = 0; slice < SLICES; slice++)
+  {
+    const SliceAssignment &assignment = _slices[slice];
+    uint32 offset = static_cast<uint32>(_lightIndices.size());
+    for (uint32 tile = 0; tile < TILES_X * TILES_Y; tile++)
+    {
+      uint32 count = assignment.TileCounts[tile];
+      _clusters[tile + TILES_X * TILES_Y * slice] = (offset << 8) | count;
+      _maxClusterLightCount = std::max(_maxClusterLightCount, count);
+      offset += count;
+    }
+    _lightIndices.insert(_lightIndices.end(), assignment.SortedLights.begin(), assignment.SortedLights.end());
+    _droppedCount += assignment.DroppedCount;
+  }
+
+  _visibleLightCount = static_cast<uint32>(std::count_if(_lightBounds.begin(), _lightBounds.end(), [](const LightBounds &bounds)
+                                                         { return bounds.Visible; }));
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Maths.h"
+#include "../Core/Types.hpp"
+
+class JobSystem;
+
+/// @brief A point light in view space, looking down negative Z.
+struct ClusterLight
+{
+  Vector3 Position;
+  float32 Radius;
+};
+
+/// @brief Splits the view frustum into a grid of clusters, tiles across the screen by slices along depth, and lists the
+/// point lights reaching each so that shading a pixel only visits the lights of its cluster. Slices grow exponentially
+/// with depth, so clusters stay roughly cubic from the near to the far plane.
+class LightClusters
+{
+public:
+  static constexpr uint32 TILES_X = 16;
+  static constexpr uint32 TILES_Y = 9;
+  static constexpr uint32 SLICES = 24;
+  static constexpr uint32 CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+  /// @brief Lights past this many in one cluster are dropped, as the count is packed into the cluster's low 8 bits.
+  static constexpr uint32 MAX_LIGHTS_PER_CLUSTER = 255;
+
+  LightClusters();
+
+  /// @brief Assigns every light to the clusters its sphere overlaps, spreading slices across jobs when given.
+  void build(const std::vector<ClusterLight> &lights, const Radian &fovY, float32 aspect, float32 nearClip, float32 farClip, JobSystem *jobs = nullptr);
+
+  /// @brief One entry per cluster, indexed by x + TILES_X * (y + TILES_Y * slice) with tile y counted up from the bottom
+  /// of the screen. Holds the offset of the cluster's first light in getLightIndices in the upper 24 bits and its light
+  /// count in the lower 8.
+  const std::vector<uint32> &getClusters() const { return _clusters; }
+  /// @brief Lights of each cluster in ascending order, one cluster after another.
+  const std::vector<uint32> &getLightIndices() const { return _lightIndices; }
+
+  static uint32 getClusterIndex(uint32 x, uint32 y, uint32 slice) { return x + TILES_X * (y + TILES_Y * slice); }
+  static uint32 getClusterOffset(uint32 cluster) { return cluster >> 8; }
+  static uint32 getClusterLightCount(uint32 cluster) { return cluster & 0xff; }
+
+  /// @brief The slice of a positive view depth is floor(log(depth) * scale + bias), which the lighting shader evaluates
+  /// per pixel.
+  static Vector2 getSliceScaleBias(float32 nearClip, float32 farClip);
+  static uint32 getSlice(float32 depth, float32 nearClip, float32 farClip);
+
+  /// @brief Lights within the frustum during the last build.
+  uint32 getVisibleLightCount() const { return _visibleLightCount; }
+  /// @brief Cluster entries dropped during the last build because their cluster was full.
+  uint32 getDroppedCount() const { return _droppedCount; }
+  uint32 getMaxClusterLightCount() const { return _maxClusterLightCount; }
+
+private:
+  /// @brief The inclusive range of clusters a light's bounding box overlaps.
+  struct LightBounds
+  {
+    uint8 MinX, MaxX, MinY, MaxY, MinSlice, MaxSlice;
+    bool Visible;
+  };
+
+  /// @brief Each slice's lights, before they are packed into one list.
+  struct SliceAssignment
+  {
+    std::vector<uint32> Tiles;
+    std::vector<uint32> Lights;
+    std::vector<uint32> TileCounts;
+    std::vector<uint32> SortedLights;
+    uint32 DroppedCount = 0;
+  };
+
+  std::vector<uint32> _clusters;
+  std::vector<uint32> _lightIndices;
+  std::vector<LightBounds> _lightBounds;
+  std::vector<SliceAssignment> _slices;
+  uint32 _visibleLightCount;
+  uint32 _droppedCount;
+  uint32 _maxClusterLightCount;
+};
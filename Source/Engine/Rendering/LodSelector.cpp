@@ -0,0 +1,42 @@
+#include "LodSelector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+float32 LodSelector::getProjectedSize(float32 length, float32 distance, const Radian &fovY, int32 screenHeight)
+{
+  if (distance <= 0.0f)
+  {
+    return std::numeric_limits<float32>::max();
+  }
+  return length * static_cast<float32>(screenHeight) / (2.0f * distance * std::tan(fovY.InRadians() * 0.5f));
+}
+
+uint32 LodSelector::selectLod(const std::vector<MeshLod> &lods, uint32 currentLod, float32 radiusPixels, float32 threshold, float32 hysteresis)
+{
+  if (lods.size() <= 1)
+  {
+    return 0;
+  }
+
+  // Errors only grow along the chain, so the search stops at the first level over the limit.
+  uint32 lastLod = static_cast<uint32>(lods.size()) - 1;
+  auto findCoarsest = [&](float32 maxPixels)
+  {
+    uint32 lod = 0;
+    while (lod < lastLod && lods[lod + 1].Error * radiusPixels <= maxPixels)
+    {
+      lod++;
+    }
+    return lod;
+  };
+
+  currentLod = std::min(currentLod, lastLod);
+  uint32 coarsest = findCoarsest(threshold);
+  if (coarsest <= currentLod)
+  {
+    return coarsest;
+  }
+  return std::max(currentLod, findCoarsest(threshold * (1.0f - hysteresis)));
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Maths.h"
+#include "../Core/Types.hpp"
+#include "../Geometry/MeshSimplifier.hpp"
+
+/// @brief Picks a mesh's level of detail from how many pixels its simplification error would cover on screen.
+class LodSelector
+{
+public:
+  /// @brief Height in pixels of a world space length seen from distance by a camera with a vertical field of view of
+  /// fovY. Unbounded once the camera reaches it.
+  static float32 getProjectedSize(float32 length, float32 distance, const Radian &fovY, int32 screenHeight);
+
+  /// @brief The coarsest level whose error projects to no more than threshold pixels. Going coarser than currentLod
+  /// also needs the error to be under threshold * (1 - hysteresis), so that drawables resting near a switching
+  /// distance do not flicker between two levels.
+  /// @param radiusPixels Projected radius of the drawable's bounds, which each level's relative error is scaled by.
+  static uint32 selectLod(const std::vector<MeshLod> &lods, uint32 currentLod, float32 radiusPixels, float32 threshold, float32 hysteresis);
+};
@@ -0,0 +1,81 @@
+#include "RenderQueue.h"
+
+#include <array>
+
+namespace
+{
+  constexpr uint32 RADIX_BITS = 8;
+  constexpr uint32 RADIX_BUCKETS = 1 << RADIX_BITS;
+  constexpr uint32 RADIX_PASSES = 64 / RADIX_BITS;
+}
+
+uint64 RenderQueue::makeKey(uint32 pipeline, uint32 materialId, uint32 meshId, float32 depth)
+{
+  uint64 key = static_cast<uint64>(pipeline & ((1u << PipelineBits) - 1));
+  key = (key << MaterialBits) | (materialId & ((1u << MaterialBits) - 1));
+  key = (key << MeshBits) | (meshId & ((1u << MeshBits) - 1));
+  key = (key << DepthBits) | quantizeDepth(depth);
+  return key;
+}
+
+uint64 RenderQueue::makeDepthKey(float32 depth)
+{
+  return static_cast<uint64>(quantizeDepth(depth)) << (64 - DepthBits);
+}
+
+uint32 RenderQueue::quantizeDepth(float32 depth)
+{
+  constexpr uint32 maxDepth = (1u << DepthBits) - 1;
+  // Also catches NaN, which fails every comparison.
+  if (!(depth > 0.0f))
+  {
+    return 0;
+  }
+  return depth >= 1.0f ? maxDepth : static_cast<uint32>(depth * static_cast<float32>(maxDepth));
+}
+
+void RenderQueue::sort()
+{
+  uint32 count = size();
+  if (count < 2)
+  {
+    return;
+  }
+
+  // Every digit is counted in a single read of the keys.
+  std::array<std::array<uint32, RADIX_BUCKETS>, RADIX_PASSES> histograms{};
+  for (const auto &entry : _entries)
+  {
+    for (uint32 pass = 0; pass < RADIX_PASSES; pass++)
+    {
+      histograms[pass][(entry.Key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+    }
+  }
+
+  _scratch.resize(count);
+  for (uint32 pass = 0; pass < RADIX_PASSES; pass++)
+  {
+    auto &histogram = histograms[pass];
+    uint32 shift = pass * RADIX_BITS;
+
+    // Fields that are the same for every draw, such as the pipeline within a single pass, need no reordering.
+    if (histogram[(_entries[0].Key >> shift) & (RADIX_BUCKETS - 1)] == count)
+    {
+      continue;
+    }
+
+    uint32 offset = 0;
+    for (uint32 &bucket : histogram)
+    {
+      uint32 bucketCount = bucket;
+      bucket = offset;
+      offset += bucketCount;
+    }
+
+    for (const auto &entry : _entries)
+    {
+      _scratch[histogram[(entry.Key >> shift) & (RADIX_BUCKETS - 1)]++] = entry;
+    }
+    _entries.swap(_scratch);
+  }
+}
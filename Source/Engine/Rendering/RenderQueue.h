@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Types.hpp"
+
+struct RenderQueueEntry
+{
+  uint64 Key;
+  /// @brief Index of the draw within whatever list the queue was built from.
+  uint32 Index;
+};
+
+/// @brief Orders draws by a 64 bit key so that draws sharing state are submitted together. From the most significant
+/// bits down the key holds the pipeline, material id, mesh id and quantized depth, which leaves front to back order as
+/// a tiebreaker between draws that share all of their state.
+class RenderQueue
+{
+public:
+  static constexpr uint32 PipelineBits = 4;
+  static constexpr uint32 MaterialBits = 20;
+  static constexpr uint32 MeshBits = 20;
+  static constexpr uint32 DepthBits = 20;
+
+  /// @brief Builds a state sorted key. Ids wider than their field wrap, which can only split draws that would
+  /// otherwise have been grouped.
+  /// @param depth Distance to the camera normalised to [0, 1], clamped if outside.
+  static uint64 makeKey(uint32 pipeline, uint32 materialId, uint32 meshId, float32 depth);
+  /// @brief Builds a key which orders purely front to back.
+  static uint64 makeDepthKey(float32 depth);
+  static uint32 quantizeDepth(float32 depth);
+
+  void clear() { _entries.clear(); }
+  void reserve(uint32 count) { _entries.reserve(count); }
+  void push(uint64 key, uint32 index) { _entries.push_back({key, index}); }
+
+  /// @brief Stable least significant digit radix sort on the keys, so entries with equal keys keep the order they
+  /// were pushed in.
+  void sort();
+
+  const std::vector<RenderQueueEntry> &getEntries() const { return _entries; }
+  uint32 size() const { return static_cast<uint32>(_entries.size()); }
+
+private:
+  std::vector<RenderQueueEntry> _entries;
+  std::vector<RenderQueueEntry> _scratch;
+};
@@ -1,8 +1,12 @@
 // Core headers
 #include "Renderer.h"
 #include <random>  // for mt19937 and uniform distributions
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <tuple>
 
 // Global deterministic RNG for SSAO noise and kernel
 static std::mt19937 g_ssaoGenerator(0);
@@ -18,22 +22,50 @@ static std::mt19937 g_ssaoGenerator(0);
 #include "../RenderApi/SamplerState.hpp"
 #include "../RenderApi/ShaderParams.hpp"
 #include "../RenderApi/Texture.hpp"
+#include "../RenderApi/TextureReadback.hpp"
+#include "../RenderApi/TimerQuery.hpp"
+#include "../RenderApi/UploadArena.hpp"
 #include "../RenderApi/VertexBuffer.hpp"
 #include "../RenderApi/VertexLayout.hpp"
 #include "../UI/ImGui/imgui.h"
 #include "../Utility/Assert.hpp"
-#include "../Utility/String.hpp"
+#include "../Utility/Hash.hpp"
 #include "Camera.h"
 #include "Drawable.h"
 #include "Material.h"
 #include "Light.h"
+#include "LightClusters.h"
+#include "LodSelector.h"
+#include "ShadowAtlas.h"
+#include "ShadowCascades.h"
 #include "StaticMesh.h"
+#include "VertexCompression.h"
 
 const static uint32 RANDOM_ROTATION_TEXTURE_SIZE = 64;
 const static uint32 SSAO_NOISE_TEXTURE_SIZE = 4;
 const static uint32 SSAO_MAX_KERNAL_SIZE = 512;
-const static uint32 MAX_LIGHTS = 1024;
+// Point lights shaded per frame, any past this are ignored.
+const static uint32 MAX_LIGHTS = 16384;
+// Texels per row of the light and light index textures, which grow a row at a time as the lists outgrow them.
+const static uint32 LIGHT_TEXTURE_WIDTH = 1024;
+// Texels each light and each shadow atlas tile take in their textures.
+const static uint32 LIGHT_DATA_TEXELS = 4;
+const static uint32 SHADOW_TILE_TEXELS = 6;
+// Near plane of a local light's shadow tiles, as a fraction of its radius.
+const static float32 LOCAL_SHADOW_NEAR_FRACTION = 0.01f;
 const static uint32 MAX_CASCADE_LAYERS = 8;
+// Width of the depth buffer read back for occlusion culling, its height follows the window's aspect.
+const static uint32 HI_Z_WIDTH = 256;
+// Readbacks whose view projections are remembered, more than can be in flight at once.
+const static uint32 MAX_HI_Z_READBACK_VIEWS = 8;
+const static uint32 INITIAL_PER_OBJECT_ARENA_OBJECTS = 1024;
+const static uint32 INITIAL_INSTANCE_ARENA_INSTANCES = 4096;
+// Most significant field of each pass's draw keys, combined with the mesh's vertex format as each format has its own
+// pipeline. Every pass submits from its own queue, so these only need to differ once a queue holds draws for more than
+// one pass.
+const static uint32 SHADOW_PIPELINE_KEY = 0;
+const static uint32 GBUFFER_PIPELINE_KEY = 1;
+const static uint32 TRANSPARENCY_PIPELINE_KEY = 2;
 
 struct SsaoConstantsData
 {
@@ -44,6 +76,16 @@ struct SsaoConstantsData
   float32 Intensity;
 };
 
+struct SsaoFrameBufferData
+{
+  Matrix4 InverseView;
+  Matrix4 PreviousViewProj;
+  uint32 FrameIndex;
+  float32 DepthRejection;
+  float32 MaxHistory;
+  int32 HistoryValid;
+};
+
 struct PerObjectBufferData
 {
   Matrix4 Model;
@@ -58,14 +100,11 @@ struct PerObjectBufferData
   int32 OpacityEnabled = 0;
   float32 Metalness = 0.0f;
   float32 Roughness = 0.0f;
-};
-
-struct LightData
-{
-  Vector3 Colour = Vector3::Zero;
-  float32 Intensity = 0.0f;
-  Vector3 Position = Vector3::Zero;
-  float32 Radius = 0.0f;
+  /// @brief Maps the mesh's stored positions back to model space, which only differs from the identity for quantized
+  /// positions.
+  Vector4 PositionScale = Vector4(1.0f);
+  Vector4 PositionOffset = Vector4(0.0f);
+  int32 CompactVertices = 0;
 };
 
 struct PerFrameBufferData
@@ -93,8 +132,6 @@ struct PerFrameBufferData
   uint32 ShadowSampleCount;
   float32 ShadowSampleSpread;
   // --------- Alignment ----------
-  LightData Lights[MAX_LIGHTS];
-  // --------- Alignment ----------
   Vector4 CascadePlaneDistances[MAX_CASCADE_LAYERS];  
   // --------- Alignment ----------
   uint32 LightCount;
@@ -103,6 +140,9 @@ struct PerFrameBufferData
   float32 BloomStrength;
   // --------- Alignment ----------
   float32 BloomThreshold;
+  float32 ClusterSliceScale;
+  float32 ClusterSliceBias;
+  float32 __Padding;
 };
 
 struct BloomBuffer
@@ -160,6 +200,17 @@ std::vector<FullscreenQuadVertex> FullscreenQuadVertices{
     FullscreenQuadVertex(Vector2(1.0f, 1.0f), Vector2(1.0f, 1.0f)),
     FullscreenQuadVertex(Vector2(-1.0f, 1.0f), Vector2(0.0f, 1.0f))};
 
+/// @brief The per vertex attributes of format followed by the per instance model matrix.
+std::vector<VertexLayoutDesc> createMeshVertexLayout(VertexFormat format)
+{
+  std::vector<VertexLayoutDesc> vertexLayoutDesc = VertexCompression::getVertexLayout(format);
+  vertexLayoutDesc.push_back(VertexLayoutDesc(SemanticType::Instance0, SemanticFormat::Float4, false, VertexInputRate::PerInstance));
+  vertexLayoutDesc.push_back(VertexLayoutDesc(SemanticType::Instance1, SemanticFormat::Float4, false, VertexInputRate::PerInstance));
+  vertexLayoutDesc.push_back(VertexLayoutDesc(SemanticType::Instance2, SemanticFormat::Float4, false, VertexInputRate::PerInstance));
+  vertexLayoutDesc.push_back(VertexLayoutDesc(SemanticType::Instance3, SemanticFormat::Float4, false, VertexInputRate::PerInstance));
+  return vertexLayoutDesc;
+}
+
 float32 calculateCascadeRadius(const std::vector<Vector3> &frustrumCorners, const Vector3 &frustrumCenter)
 {
   Assert::throwIfFalse(frustrumCorners.size() == 8, "Invalid size of supplied frustrum corners.");
@@ -185,6 +236,35 @@ Vector3 calculateFrustrumCenter(const std::vector<Vector3> &frustrumCorners)
   return center * (1.0f / 8.0f);
 }
 
+// Directions and up vectors of a point light's shadow tiles, in the order the lighting pass picks them by the major
+// axis of the direction from the light.
+const static std::array<Vector3, 6> CUBE_FACE_DIRECTIONS = {
+    Vector3(1.0f, 0.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f),
+    Vector3(0.0f, 1.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f),
+    Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f)};
+const static std::array<Vector3, 6> CUBE_FACE_UPS = {
+    Vector3(0.0f, -1.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f),
+    Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f),
+    Vector3(0.0f, -1.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f)};
+
+/// @brief The frustrum of a view projection, with its planes taken from the sums and differences of the matrix's rows.
+Frustrum calculateFrustrum(const Matrix4 &viewProjection)
+{
+  std::array<Plane, 6> planes;
+  for (uint32 i = 0; i < 6; i++)
+  {
+    uint32 row = i / 2;
+    float32 sign = (i % 2 == 0) ? 1.0f : -1.0f;
+    Vector3 normal(viewProjection[0][3] + sign * viewProjection[0][row],
+                   viewProjection[1][3] + sign * viewProjection[1][row],
+                   viewProjection[2][3] + sign * viewProjection[2][row]);
+    float32 d = viewProjection[3][3] + sign * viewProjection[3][row];
+    planes[i] = Plane(normal, normal * (-d / Vector3::Dot(normal, normal)));
+  }
+  // Rows are ordered left, right, bottom, top, near, far.
+  return Frustrum(planes[4], planes[5], planes[0], planes[1], planes[3], planes[2]);
+}
+
 std::vector<Vector3> calculateFrustrumCorners(const Matrix4 &view, const Matrix4 &projection)
 {
   std::vector<Vector4> frustrumCornersVS = {
@@ -220,6 +300,12 @@ Renderer::Renderer(const Vector2I &windowDims) : _windowDims(windowDims),
                                                  _ssaoRadius(0.75f),
                                                  _ssaoIntensity(2.0f),
                                                  _ssaoEnabled(true),
+                                                 _ssaoHalfResolution(true),
+                                                 _ssaoHalfResolutionSamples(8),
+                                                 _ssaoMaxHistory(16),
+                                                 _ssaoDepthRejection(0.05f),
+                                                 _ssaoHistoryValid(false),
+                                                 _ssaoFrameIndex(0),
                                                  _drawCascadeLayers(false),
                                                  _shadowResolutionChanged(true),                                                 
                                                  _shadowMapResolution(2048),
@@ -229,6 +315,16 @@ Renderer::Renderer(const Vector2I &windowDims) : _windowDims(windowDims),
                                                  _minCascadeDistance(0.0f),
                                                  _maxCascadeDistance(1.0f),
                                                  _cascadeLambda(0.4f),                                                 
+                                                 _shadowAtlasSizeChanged(true),
+                                                 _shadowAtlasSize(4096),
+                                                 _shadowAtlasMaxTileSize(1024),
+                                                 _shadowAtlasTileBudget(12),
+                                                 _shadowAtlasTexelScale(1.0f),
+                                                 _lodEnabled(true),
+                                                 _lodErrorThreshold(1.0f),
+                                                 _lodHysteresis(0.25f),
+                                                 _shadowLodBias(1),
+                                                 _occlusionCullingEnabled(true),
                                                  _toneMappingEnabled(true),
                                                  _bloomEnabled(true),
                                                  _exposure(1.0f),
@@ -237,17 +333,27 @@ Renderer::Renderer(const Vector2I &windowDims) : _windowDims(windowDims),
                                                  _bloomThreshold(1.0f),
                                                  _debugDisplayType(DebugDisplayType::Disabled),
                                                  _shadowMapLayerToDraw(0),
-                                                 _ssaoSettingsModified(true)
+                                                 _ssaoSettingsModified(true),
+                                                 _gpuFrameResultCount(0),
+                                                 _hasGpuTimings(false),
+                                                 _hiZBufferId(0),
+                                                 _hiZBufferValid(false),
+                                                 _stateSortingEnabled(true),
+                                                 _boundMesh(nullptr),
+                                                 _boundMaterial(nullptr)
 
 {
-  _renderPassTimings.push_back({0, "Shadow Depth"});
-  _renderPassTimings.push_back({0, "G-Buffer"});
-  _renderPassTimings.push_back({0, "Transparency"});
-  _renderPassTimings.push_back({0, "Shadow Merge"});
-  _renderPassTimings.push_back({0, "SSAO"});
-  _renderPassTimings.push_back({0, "Lighting"});
-  _renderPassTimings.push_back({0, "Bloom Blur"});
-  _renderPassTimings.push_back({0, "Tone Mapping"});
+  resetBoundDrawState();
+  _renderPassTimings.emplace_back("Shadow Depth");
+  _renderPassTimings.emplace_back("G-Buffer");
+  _renderPassTimings.emplace_back("Transparency");
+  _renderPassTimings.emplace_back("Shadow Merge");
+  _renderPassTimings.emplace_back("SSAO");
+  _renderPassTimings.emplace_back("Lighting");
+  _renderPassTimings.emplace_back("Bloom Blur");
+  _renderPassTimings.emplace_back("Tone Mapping");
+  _renderPassTimings.emplace_back("Local Shadows");
+  _renderPassTimings.emplace_back("Hi-Z");
 }
 
 bool Renderer::init(const std::shared_ptr<RenderDevice> &renderDevice)
@@ -271,8 +377,10 @@ bool Renderer::init(const std::shared_ptr<RenderDevice> &renderDevice)
     initSamplers(renderDevice);
     initTextures(renderDevice);
     initConstantBuffers(renderDevice);
+    initTimerQueries(renderDevice);
 
     initDirectionalLightDepthPass(renderDevice);
+    initLocalLightShadowPass(renderDevice);
     initGbufferPass(renderDevice);
     initTransparencyPass(renderDevice);
     initShadowPass(renderDevice);
@@ -282,6 +390,7 @@ bool Renderer::init(const std::shared_ptr<RenderDevice> &renderDevice)
     initBloomUpSamplePass(renderDevice);
     initToneMappingPass(renderDevice);
     initDebugPass(renderDevice);
+    initHiZPass(renderDevice);
   }
   catch (const std::exception &e)
   {
@@ -333,13 +442,45 @@ void Renderer::drawDebugUi()
       _ssaoSettingsModified = true;
     }
 
-    int32 sampleCount = _ssaoSamples;
-    if (ImGui::SliderInt("Sample Count", &sampleCount, 8, 512))
+    bool aoHalfResolution = _ssaoHalfResolution;
+    if (ImGui::Checkbox("Half Resolution AO", &aoHalfResolution))
     {
-      _ssaoSamples = sampleCount;
+      _ssaoHalfResolution = aoHalfResolution;
+      _ssaoHistoryValid = false;
       _ssaoSettingsModified = true;
     }
 
+    if (_ssaoHalfResolution)
+    {
+      int32 sampleCount = _ssaoHalfResolutionSamples;
+      if (ImGui::SliderInt("Samples Per Frame", &sampleCount, 4, 32))
+      {
+        _ssaoHalfResolutionSamples = sampleCount;
+        _ssaoSettingsModified = true;
+      }
+
+      int32 maxHistory = _ssaoMaxHistory;
+      if (ImGui::SliderInt("AO History Frames", &maxHistory, 1, 32))
+      {
+        _ssaoMaxHistory = maxHistory;
+      }
+
+      float32 depthRejection = _ssaoDepthRejection;
+      if (ImGui::SliderFloat("AO History Rejection", &depthRejection, 0.005f, 0.2f))
+      {
+        _ssaoDepthRejection = depthRejection;
+      }
+    }
+    else
+    {
+      int32 sampleCount = _ssaoSamples;
+      if (ImGui::SliderInt("Sample Count", &sampleCount, 8, 512))
+      {
+        _ssaoSamples = sampleCount;
+        _ssaoSettingsModified = true;
+      }
+    }
+
     bool aoEnabled = _ssaoEnabled;
     if (ImGui::Checkbox("AO On", &aoEnabled))
     {
@@ -349,11 +490,11 @@ void Renderer::drawDebugUi()
     // AO Quality Presets
     ImGui::Spacing();
     ImGui::Text("AO Presets:"); ImGui::SameLine();
-    if (ImGui::Button("Low")) { _ssaoSamples = 16; _ssaoIntensity = 1.0f; _ssaoSettingsModified = true; }
+    if (ImGui::Button("Low")) { _ssaoSamples = 16; _ssaoHalfResolutionSamples = 4; _ssaoIntensity = 1.0f; _ssaoSettingsModified = true; }
     ImGui::SameLine();
-    if (ImGui::Button("Medium")) { _ssaoSamples = 64; _ssaoIntensity = 2.0f; _ssaoSettingsModified = true; }
+    if (ImGui::Button("Medium")) { _ssaoSamples = 64; _ssaoHalfResolutionSamples = 8; _ssaoIntensity = 2.0f; _ssaoSettingsModified = true; }
     ImGui::SameLine();
-    if (ImGui::Button("High")) { _ssaoSamples = 128; _ssaoIntensity = 3.0f; _ssaoSettingsModified = true; }
+    if (ImGui::Button("High")) { _ssaoSamples = 128; _ssaoHalfResolutionSamples = 12; _ssaoIntensity = 3.0f; _ssaoSettingsModified = true; }
 
     ImGui::Separator();
     ImGui::Text("Shadow Quality");
@@ -437,6 +578,108 @@ void Renderer::drawDebugUi()
     {
       _drawCascadeLayers = shouldDrawCascadeLayers;
     }
+
+    // Cascades past the last disable caching.
+    int firstCachedCascade = _shadowCascades.getFirstCachedCascade();
+    if (ImGui::SliderInt("First Cached Cascade", &firstCachedCascade, 1, MAX_CASCADE_LAYERS))
+    {
+      _shadowCascades.setFirstCachedCascade(firstCachedCascade);
+    }
+    int cascadeRefreshInterval = _shadowCascades.getRefreshInterval();
+    if (ImGui::SliderInt("Cached Refresh Interval", &cascadeRefreshInterval, 1, 16))
+    {
+      _shadowCascades.setRefreshInterval(cascadeRefreshInterval);
+    }
+    float32 cascadeTexelThreshold = _shadowCascades.getTexelThreshold();
+    if (ImGui::SliderFloat("Cached Texel Threshold", &cascadeTexelThreshold, 0.0f, 16.0f))
+    {
+      _shadowCascades.setTexelThreshold(cascadeTexelThreshold);
+    }
+    for (uint32 i = 0; i < _shadowCascades.getCascadeCount(); i++)
+    {
+      if (_shadowCascades.isRendered(i))
+      {
+        ImGui::Text("Cascade %u: %u casters", i, static_cast<uint32>(_shadowCascades.getCasters(i).size()));
+      }
+      else
+      {
+        ImGui::Text("Cascade %u: cached", i);
+      }
+    }
+    ImGui::Separator();
+    ImGui::Text("Local Light Shadows");
+
+    std::vector<const char *> atlasSizeItems = {"1024", "2048", "4096", "8192"};
+    int atlasSizeItem = 0;
+    while ((1024 << atlasSizeItem) < _shadowAtlasSize && atlasSizeItem < 3)
+    {
+      atlasSizeItem++;
+    }
+    if (ImGui::Combo("Atlas Size", &atlasSizeItem, atlasSizeItems.data(), atlasSizeItems.size()))
+    {
+      _shadowAtlasSize = 1024 << atlasSizeItem;
+      _shadowAtlasSizeChanged = true;
+    }
+    std::vector<const char *> maxTileSizeItems = {"256", "512", "1024", "2048"};
+    int maxTileSizeItem = 0;
+    while ((256 << maxTileSizeItem) < _shadowAtlasMaxTileSize && maxTileSizeItem < 3)
+    {
+      maxTileSizeItem++;
+    }
+    if (ImGui::Combo("Max Tile Size", &maxTileSizeItem, maxTileSizeItems.data(), maxTileSizeItems.size()))
+    {
+      _shadowAtlasMaxTileSize = 256 << maxTileSizeItem;
+      _shadowAtlasSizeChanged = true;
+    }
+    int tileBudget = _shadowAtlasTileBudget;
+    if (ImGui::SliderInt("Tiles Per Frame", &tileBudget, 1, 48))
+    {
+      _shadowAtlasTileBudget = tileBudget;
+    }
+    ImGui::SliderFloat("Tile Texel Scale", &_shadowAtlasTexelScale, 0.1f, 4.0f);
+    ImGui::Text("Shadowed Lights: %u", static_cast<uint32>(_shadowAtlasRequests.size()));
+    ImGui::Text("Tiles Drawn: %u (%u casters)", _stateStats.LocalShadowTiles, _stateStats.LocalShadowCasters);
+    ImGui::Text("Tiles Cached: %u", _shadowAtlas.getCachedTileCount());
+    ImGui::Text("Atlas Occupancy: %.1f%%", _shadowAtlas.getOccupancy() * 100.0f);
+    if (_shadowAtlas.getDeferredTileCount() > 0)
+    {
+      ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "Tiles Deferred Past Budget: %u", _shadowAtlas.getDeferredTileCount());
+    }
+    if (_shadowAtlas.getUnplacedCount() > 0)
+    {
+      ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "Lights Without Space: %u", _shadowAtlas.getUnplacedCount());
+    }
+    ImGui::Separator();
+    ImGui::Text("Clustered Lighting");
+    ImGui::Text("Visible Lights: %u", _lightClusters.getVisibleLightCount());
+    ImGui::Text("Light List Entries: %u", static_cast<uint32>(_lightClusters.getLightIndices().size()));
+    ImGui::Text("Most Lights in a Cluster: %u", _lightClusters.getMaxClusterLightCount());
+    if (_lightClusters.getDroppedCount() > 0)
+    {
+      ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "Dropped From Full Clusters: %u", _lightClusters.getDroppedCount());
+    }
+    ImGui::Separator();
+    ImGui::Text("Level of Detail");
+
+    ImGui::Checkbox("LOD Enabled", &_lodEnabled);
+    ImGui::SliderFloat("LOD Error (px)", &_lodErrorThreshold, 0.25f, 8.0f);
+    ImGui::SliderFloat("LOD Hysteresis", &_lodHysteresis, 0.0f, 0.75f);
+    int32 shadowLodBias = _shadowLodBias;
+    if (ImGui::SliderInt("Shadow LOD Bias", &shadowLodBias, 0, MAX_MESH_LODS - 1))
+    {
+      _shadowLodBias = shadowLodBias;
+    }
+    ImGui::Separator();
+    ImGui::Text("Occlusion Culling");
+
+    bool occlusionCullingEnabled = _occlusionCullingEnabled;
+    if (ImGui::Checkbox("Occlusion Culling Enabled", &occlusionCullingEnabled))
+    {
+      _occlusionCullingEnabled = occlusionCullingEnabled;
+      // Depth still to come back from before it was disabled may be from a view long since left.
+      _hiZReadbackViews.clear();
+      _hiZBufferValid = false;
+    }
     ImGui::Separator();
     ImGui::Text("HDR");
 
@@ -475,7 +718,7 @@ void Renderer::drawDebugUi()
     if (_debugDisplayType == DebugDisplayType::ShadowDepth)
     {
       int shadowMapLayerToDraw = _shadowMapLayerToDraw;
-      if (ImGui::SliderInt("Layer", &shadowMapLayerToDraw, 0, 3))
+      if (ImGui::SliderInt("Layer", &shadowMapLayerToDraw, 0, _cascadeCount - 1))
       {
         _shadowMapLayerToDraw = shadowMapLayerToDraw;
       }
@@ -485,11 +728,15 @@ void Renderer::drawDebugUi()
 
 void Renderer::initConstantBuffers(const std::shared_ptr<RenderDevice> &renderDevice)
 {
-  GpuBufferDesc perObjectBufferDesc;
-  perObjectBufferDesc.BufferType = BufferType::Constant;
-  perObjectBufferDesc.BufferUsage = BufferUsage::Dynamic;
-  perObjectBufferDesc.ByteCount = sizeof(PerObjectBufferData);
-  _perObjectBuffer = renderDevice->createGpuBuffer(perObjectBufferDesc);
+  UploadArenaDesc perObjectArenaDesc;
+  perObjectArenaDesc.BufferType = BufferType::Constant;
+  perObjectArenaDesc.ByteCount = INITIAL_PER_OBJECT_ARENA_OBJECTS * sizeof(PerObjectBufferData);
+  _perObjectArena = renderDevice->createUploadArena(perObjectArenaDesc);
+
+  UploadArenaDesc instanceArenaDesc;
+  instanceArenaDesc.BufferType = BufferType::Vertex;
+  instanceArenaDesc.ByteCount = INITIAL_INSTANCE_ARENA_INSTANCES * sizeof(Matrix4);
+  _instanceArena = renderDevice->createUploadArena(instanceArenaDesc);
 
   GpuBufferDesc perFrameBufferDesc;
   perFrameBufferDesc.BufferType = BufferType::Constant;
@@ -503,6 +750,12 @@ void Renderer::initConstantBuffers(const std::shared_ptr<RenderDevice> &renderDe
   ssaoConstantsDataDesc.ByteCount = sizeof(SsaoConstantsData);
   _ssaoConstantsBuffer = renderDevice->createGpuBuffer(ssaoConstantsDataDesc);
 
+  GpuBufferDesc ssaoFrameBufferDesc;
+  ssaoFrameBufferDesc.BufferType = BufferType::Constant;
+  ssaoFrameBufferDesc.BufferUsage = BufferUsage::Dynamic;
+  ssaoFrameBufferDesc.ByteCount = sizeof(SsaoFrameBufferData);
+  _ssaoFrameBuffer = renderDevice->createGpuBuffer(ssaoFrameBufferDesc);
+
   GpuBufferDesc fullscreenQuadDataDesc;
   fullscreenQuadDataDesc.BufferType = BufferType::Constant;
   fullscreenQuadDataDesc.BufferUsage = BufferUsage::Dynamic;
@@ -516,13 +769,23 @@ void Renderer::initConstantBuffers(const std::shared_ptr<RenderDevice> &renderDe
   _bloomBuffer = renderDevice->createGpuBuffer(bloomBufferDesc);
 }
 
+void Renderer::initTimerQueries(const std::shared_ptr<RenderDevice> &renderDevice)
+{
+  _renderPassTimers.clear();
+  for (uint32 i = 0; i < _renderPassTimings.size(); i++)
+  {
+    _renderPassTimers.push_back(renderDevice->createTimerQuery());
+  }
+}
+
 void Renderer::drawFrame(const std::shared_ptr<RenderDevice> &renderDevice,
                          const std::vector<std::shared_ptr<Drawable>> &aabbDrawables,
                          const std::vector<std::shared_ptr<Drawable>> &opaqueDrawables,
                          const std::vector<std::shared_ptr<Drawable>> &transparentDrawables,
                          const std::vector<std::shared_ptr<Drawable>> &allDrawables,
                          const std::vector<std::shared_ptr<Light>> &lights,
-                         const std::shared_ptr<Camera> &camera)
+                         const std::shared_ptr<Camera> &camera,
+                         JobSystem *jobs)
 {
   // TODO: Need to improve this as we only support one direction light.
   std::shared_ptr<Light> directionalLight;
@@ -535,17 +798,26 @@ void Renderer::drawFrame(const std::shared_ptr<RenderDevice> &renderDevice,
     }
   }
 
+  _stateStats = RenderStateStats();
+  updateShadowCascades(camera, directionalLight, allDrawables, jobs);
+  updateShadowAtlas(camera, lights, allDrawables);
   writePerFrameConstantData(camera, directionalLight, lights);
-
-  directionalLightDepthPass(renderDevice, allDrawables, directionalLight, camera);
-  gbufferPass(renderDevice, opaqueDrawables, camera);
-  transparencyPass(renderDevice, transparentDrawables, camera);
+  writeLightClusterData(renderDevice, camera, lights, jobs);
+  writePerObjectConstantData(renderDevice, opaqueDrawables, transparentDrawables, allDrawables, aabbDrawables, camera);
+
+  directionalLightDepthPass(renderDevice, directionalLight, camera);
+  localLightShadowPass(renderDevice);
+  gbufferPass(renderDevice, camera);
+  transparencyPass(renderDevice, camera);
+  hiZPass(renderDevice, camera);
   shadowPass(renderDevice);
   ssaoPass(renderDevice, camera);
   lightingPass(renderDevice, lights, camera);
   bloomPass(renderDevice);
   toneMappingPass(renderDevice);
   debugPass(renderDevice, aabbDrawables, camera);
+
+  updateRenderPassTimings();
 }
 
 void Renderer::initSamplers(const std::shared_ptr<RenderDevice> &renderDevice)
@@ -632,82 +904,97 @@ void Renderer::initTextures(const std::shared_ptr<RenderDevice> &renderDevice)
 
   _ssaoNoiseTexture->writeData(0, 0, 0, SSAO_NOISE_TEXTURE_SIZE, 0, SSAO_NOISE_TEXTURE_SIZE, 0, 0, ssaoNoise.data());
 
+  TextureDesc clusterMapDesc;
+  clusterMapDesc.Width = LightClusters::TILES_X;
+  clusterMapDesc.Height = LightClusters::TILES_Y;
+  clusterMapDesc.Depth = LightClusters::SLICES;
+  clusterMapDesc.Usage = TextureUsage::Default;
+  clusterMapDesc.Type = TextureType::Texture3D;
+  clusterMapDesc.Format = TextureFormat::R32UI;
+  _clusterMap = renderDevice->createTexture(clusterMapDesc);
+  reserveLightTexture(renderDevice, _lightMap, TextureFormat::RGBA32F, 0);
+  reserveLightTexture(renderDevice, _lightIndexMap, TextureFormat::R32UI, 0);
+  reserveLightTexture(renderDevice, _shadowTileMap, TextureFormat::RGBA32F, 0);
+
   createDirectionalLightShadowDepthMap(renderDevice);
+  createShadowAtlas(renderDevice);
 }
 
 void Renderer::initDirectionalLightDepthPass(const std::shared_ptr<RenderDevice> &renderDevice)
 {
-  TextureDesc shadowMapDesc;
-  shadowMapDesc.Width = _shadowMapResolution;
-  shadowMapDesc.Height = _shadowMapResolution;
-  shadowMapDesc.Usage = TextureUsage::Depth;
-  shadowMapDesc.Type = TextureType::Texture2DArray;
-  shadowMapDesc.Format = TextureFormat::D32F;
-  shadowMapDesc.Count = _cascadeCount;
-
-  RenderTargetDesc rtDesc;
-  rtDesc.DepthStencilTarget = renderDevice->createTexture(shadowMapDesc);
-  rtDesc.Height = _shadowMapResolution;
-  rtDesc.Width = _shadowMapResolution;
-
-  _shadowMapRto = renderDevice->createRenderTarget(rtDesc);
-
+  // Each cascade is drawn into its layer separately with only its own casters, so no geometry shader is needed to
+  // copy every triangle to every layer.
   ShaderDesc vsDesc;
   vsDesc.ShaderType = ShaderType::Vertex;
-  vsDesc.Source = String::foadFromFile("./Shaders/CascadeShadowMap.vert");
-
-  // TODO: Change to only use Pixel shaders as it allows for a dynamic cascade count - apparently doesn't affect performance that much
-  ShaderDesc gsDesc;
-  gsDesc.ShaderType = ShaderType::Geometry;
-  gsDesc.Source = String::foadFromFile("./Shaders/CascadeShadowMap.geom");
+  vsDesc.FilePath = "./Shaders/CascadeShadowMap.vert";
 
   ShaderDesc psDesc;
   psDesc.ShaderType = ShaderType::Fragment;
-  psDesc.Source = String::foadFromFile("./Shaders/Empty.frag");
-
-  std::vector<VertexLayoutDesc> vertexLayoutDesc{
-      VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float3),
-      VertexLayoutDesc(SemanticType::Normal, SemanticFormat::Float3),
-      VertexLayoutDesc(SemanticType::TexCoord, SemanticFormat::Float2),
-      VertexLayoutDesc(SemanticType::Tangent, SemanticFormat::Float3),
-      VertexLayoutDesc(SemanticType::Bitangent, SemanticFormat::Float3)};
+  psDesc.FilePath = "./Shaders/Empty.frag";
 
   std::shared_ptr<ShaderParams> shaderParams(new ShaderParams());
   shaderParams->addParam(ShaderParam("PerObjectBuffer", ShaderParamType::ConstBuffer, 0));
-  shaderParams->addParam(ShaderParam("PerFrameBuffer", ShaderParamType::ConstBuffer, 1));
 
   RasterizerStateDesc rasterizerStateDesc;
   rasterizerStateDesc.CullMode = CullMode::Clockwise;
 
   PipelineStateDesc pipelineDesc;
   pipelineDesc.VS = renderDevice->createShader(vsDesc);
-  pipelineDesc.GS = renderDevice->createShader(gsDesc);
   pipelineDesc.FS = renderDevice->createShader(psDesc);
   pipelineDesc.BlendState = renderDevice->createBlendState(BlendStateDesc{});
   pipelineDesc.RasterizerState = renderDevice->createRasterizerState(RasterizerStateDesc{});
   pipelineDesc.DepthStencilState = renderDevice->createDepthStencilState(DepthStencilStateDesc());
-  pipelineDesc.VertexLayout = renderDevice->createVertexLayout(vertexLayoutDesc);
   pipelineDesc.ShaderParams = shaderParams;
 
-  _shadowMapPso = renderDevice->createPipelineState(pipelineDesc);
+  // The pipelines share their shaders, which decode whichever layout they are given.
+  for (uint32 format = 0; format < static_cast<uint32>(VertexFormat::Count); format++)
+  {
+    pipelineDesc.VertexLayout = renderDevice->createVertexLayout(createMeshVertexLayout(static_cast<VertexFormat>(format)));
+    _shadowMapPsos[format] = renderDevice->createPipelineState(pipelineDesc);
+  }
 }
 
-void Renderer::initGbufferPass(const std::shared_ptr<RenderDevice> &renderDevice)
+void Renderer::initLocalLightShadowPass(const std::shared_ptr<RenderDevice> &renderDevice)
 {
+  // Tiles are drawn with the directional light's pipelines. Clearing the depth buffer always clears the whole atlas,
+  // so each tile is cleared by drawing a quad over it which writes the far plane instead.
   ShaderDesc vsDesc;
   vsDesc.ShaderType = ShaderType::Vertex;
-  vsDesc.Source = String::foadFromFile("./Shaders/Gbuffer.vert");
+  vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
   ShaderDesc psDesc;
   psDesc.ShaderType = ShaderType::Fragment;
-  psDesc.Source = String::foadFromFile("./Shaders/Gbuffer.frag");
+  psDesc.FilePath = "./Shaders/ClearDepth.frag";
 
   std::vector<VertexLayoutDesc> vertexLayoutDesc{
-      VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float3),
-      VertexLayoutDesc(SemanticType::Normal, SemanticFormat::Float3),
+      VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
       VertexLayoutDesc(SemanticType::TexCoord, SemanticFormat::Float2),
-      VertexLayoutDesc(SemanticType::Tangent, SemanticFormat::Float3),
-      VertexLayoutDesc(SemanticType::Bitangent, SemanticFormat::Float3)};
+  };
+
+  DepthStencilStateDesc depthStencilStateDesc{};
+  depthStencilStateDesc.DepthFunc = ComparisonFunction::Always;
+
+  PipelineStateDesc pipelineDesc;
+  pipelineDesc.VS = renderDevice->createShader(vsDesc);
+  pipelineDesc.FS = renderDevice->createShader(psDesc);
+  pipelineDesc.BlendState = renderDevice->createBlendState(BlendStateDesc{});
+  pipelineDesc.RasterizerState = renderDevice->createRasterizerState(RasterizerStateDesc{});
+  pipelineDesc.DepthStencilState = renderDevice->createDepthStencilState(depthStencilStateDesc);
+  pipelineDesc.VertexLayout = renderDevice->createVertexLayout(vertexLayoutDesc);
+  pipelineDesc.ShaderParams = std::make_shared<ShaderParams>();
+
+  _clearDepthPso = renderDevice->createPipelineState(pipelineDesc);
+}
+
+void Renderer::initGbufferPass(const std::shared_ptr<RenderDevice> &renderDevice)
+{
+  ShaderDesc vsDesc;
+  vsDesc.ShaderType = ShaderType::Vertex;
+  vsDesc.FilePath = "./Shaders/Gbuffer.vert";
+
+  ShaderDesc psDesc;
+  psDesc.ShaderType = ShaderType::Fragment;
+  psDesc.FilePath = "./Shaders/Gbuffer.frag";
 
   std::shared_ptr<ShaderParams> shaderParams(new ShaderParams());
   shaderParams->addParam(ShaderParam("PerObjectBuffer", ShaderParamType::ConstBuffer, 0));
@@ -729,10 +1016,14 @@ void Renderer::initGbufferPass(const std::shared_ptr<RenderDevice> &renderDevice
   pipelineDesc.BlendState = renderDevice->createBlendState(blendStateDesc);
   pipelineDesc.RasterizerState = renderDevice->createRasterizerState(rasterizerStateDesc);
   pipelineDesc.DepthStencilState = renderDevice->createDepthStencilState(DepthStencilStateDesc());
-  pipelineDesc.VertexLayout = renderDevice->createVertexLayout(vertexLayoutDesc);
   pipelineDesc.ShaderParams = shaderParams;
 
-  _gBufferPso = renderDevice->createPipelineState(pipelineDesc);
+  // The pipelines share their shaders, which decode whichever layout they are given.
+  for (uint32 format = 0; format < static_cast<uint32>(VertexFormat::Count); format++)
+  {
+    pipelineDesc.VertexLayout = renderDevice->createVertexLayout(createMeshVertexLayout(static_cast<VertexFormat>(format)));
+    _gBufferPsos[format] = renderDevice->createPipelineState(pipelineDesc);
+  }
 
   TextureDesc colourTexDesc;
   colourTexDesc.Width = _windowDims.X;
@@ -763,18 +1054,11 @@ void Renderer::initTransparencyPass(const std::shared_ptr<RenderDevice> &renderD
 {
   ShaderDesc vsDesc;
   vsDesc.ShaderType = ShaderType::Vertex;
-  vsDesc.Source = String::foadFromFile("./Shaders/Gbuffer.vert");
+  vsDesc.FilePath = "./Shaders/Gbuffer.vert";
 
   ShaderDesc psDesc;
   psDesc.ShaderType = ShaderType::Fragment;
-  psDesc.Source = String::foadFromFile("./Shaders/GbufferTransparency.frag");
-
-  std::vector<VertexLayoutDesc> vertexLayoutDesc{
-      VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float3),
-      VertexLayoutDesc(SemanticType::Normal, SemanticFormat::Float3),
-      VertexLayoutDesc(SemanticType::TexCoord, SemanticFormat::Float2),
-      VertexLayoutDesc(SemanticType::Tangent, SemanticFormat::Float3),
-      VertexLayoutDesc(SemanticType::Bitangent, SemanticFormat::Float3)};
+  psDesc.FilePath = "./Shaders/GbufferTransparency.frag";
 
   std::shared_ptr<ShaderParams> shaderParams(new ShaderParams());
   shaderParams->addParam(ShaderParam("PerObjectBuffer", ShaderParamType::ConstBuffer, 0));
@@ -798,21 +1082,25 @@ void Renderer::initTransparencyPass(const std::shared_ptr<RenderDevice> &renderD
   pipelineDesc.BlendState = renderDevice->createBlendState(blendStateDesc);
   pipelineDesc.RasterizerState = renderDevice->createRasterizerState(rasterizerStateDesc);
   pipelineDesc.DepthStencilState = renderDevice->createDepthStencilState(DepthStencilStateDesc());
-  pipelineDesc.VertexLayout = renderDevice->createVertexLayout(vertexLayoutDesc);
   pipelineDesc.ShaderParams = shaderParams;
 
-  _transparencyPso = renderDevice->createPipelineState(pipelineDesc);
+  // The pipelines share their shaders, which decode whichever layout they are given.
+  for (uint32 format = 0; format < static_cast<uint32>(VertexFormat::Count); format++)
+  {
+    pipelineDesc.VertexLayout = renderDevice->createVertexLayout(createMeshVertexLayout(static_cast<VertexFormat>(format)));
+    _transparencyPsos[format] = renderDevice->createPipelineState(pipelineDesc);
+  }
 }
 
 void Renderer::initShadowPass(const std::shared_ptr<RenderDevice> &renderDevice)
 {
   ShaderDesc vsDesc;
   vsDesc.ShaderType = ShaderType::Vertex;
-  vsDesc.Source = String::foadFromFile("./Shaders/FSPassThrough.vert");
+  vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
   ShaderDesc psDesc;
   psDesc.ShaderType = ShaderType::Fragment;
-  psDesc.Source = String::foadFromFile("./Shaders/Shadows.frag");
+  psDesc.FilePath = "./Shaders/Shadows.frag";
 
   std::vector<VertexLayoutDesc> vertexLayoutDesc{
       VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
@@ -864,11 +1152,11 @@ void Renderer::initSsaoPass(const std::shared_ptr<RenderDevice> &renderDevice)
   {
     ShaderDesc vsDesc;
     vsDesc.ShaderType = ShaderType::Vertex;
-    vsDesc.Source = String::foadFromFile("./Shaders/FSPassThrough.vert");
+    vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
     ShaderDesc psDesc;
     psDesc.ShaderType = ShaderType::Fragment;
-    psDesc.Source = String::foadFromFile("./Shaders/Ssao.frag");
+    psDesc.FilePath = "./Shaders/Ssao.frag";
 
     std::vector<VertexLayoutDesc> vertexLayoutDesc{
         VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
@@ -902,11 +1190,11 @@ void Renderer::initSsaoPass(const std::shared_ptr<RenderDevice> &renderDevice)
   {
     ShaderDesc vsDesc;
     vsDesc.ShaderType = ShaderType::Vertex;
-    vsDesc.Source = String::foadFromFile("./Shaders/FSPassThrough.vert");
+    vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
     ShaderDesc psDesc;
     psDesc.ShaderType = ShaderType::Fragment;
-    psDesc.Source = String::foadFromFile("./Shaders/SsaoBlur.frag");
+    psDesc.FilePath = "./Shaders/SsaoBlur.frag";
 
     std::vector<VertexLayoutDesc> vertexLayoutDesc{
         VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
@@ -948,17 +1236,110 @@ void Renderer::initSsaoPass(const std::shared_ptr<RenderDevice> &renderDevice)
 
   _ssaoRto = renderDevice->createRenderTarget(rtDesc);
   _ssaoBlurRto = renderDevice->createRenderTarget(rtDesc);
+
+  // The half resolution passes are all fullscreen triangles with no depth test, differing only in shader and inputs.
+  auto createHalfResolutionPso = [&](const std::string &filePath, const std::shared_ptr<ShaderParams> &shaderParams)
+  {
+    ShaderDesc vsDesc;
+    vsDesc.ShaderType = ShaderType::Vertex;
+    vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
+
+    ShaderDesc psDesc;
+    psDesc.ShaderType = ShaderType::Fragment;
+    psDesc.FilePath = filePath;
+
+    std::vector<VertexLayoutDesc> vertexLayoutDesc{
+        VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
+        VertexLayoutDesc(SemanticType::TexCoord, SemanticFormat::Float2),
+    };
+
+    RasterizerStateDesc rasterizerStateDesc{};
+    BlendStateDesc blendStateDesc{};
+
+    DepthStencilStateDesc depthStencilStateDesc{};
+    depthStencilStateDesc.DepthReadEnabled = false;
+    depthStencilStateDesc.DepthWriteEnabled = false;
+
+    PipelineStateDesc pipelineDesc;
+    pipelineDesc.VS = renderDevice->createShader(vsDesc);
+    pipelineDesc.FS = renderDevice->createShader(psDesc);
+    pipelineDesc.BlendState = renderDevice->createBlendState(blendStateDesc);
+    pipelineDesc.RasterizerState = renderDevice->createRasterizerState(rasterizerStateDesc);
+    pipelineDesc.DepthStencilState = renderDevice->createDepthStencilState(depthStencilStateDesc);
+    pipelineDesc.VertexLayout = renderDevice->createVertexLayout(vertexLayoutDesc);
+    pipelineDesc.ShaderParams = shaderParams;
+    return renderDevice->createPipelineState(pipelineDesc);
+  };
+  {
+    std::shared_ptr<ShaderParams> shaderParams(new ShaderParams());
+    shaderParams->addParam(ShaderParam("PerFrameBuffer", ShaderParamType::ConstBuffer, 1));
+    shaderParams->addParam(ShaderParam("DepthMap", ShaderParamType::Texture, 0));
+    _ssaoDownsamplePso = createHalfResolutionPso("./Shaders/SsaoDownsample.frag", shaderParams);
+  }
+  {
+    std::shared_ptr<ShaderParams> shaderParams(new ShaderParams());
+    shaderParams->addParam(ShaderParam("SsaoConstantsBuffer", ShaderParamType::ConstBuffer, 0));
+    shaderParams->addParam(ShaderParam("PerFrameBuffer", ShaderParamType::ConstBuffer, 1));
+    shaderParams->addParam(ShaderParam("SsaoFrameBuffer", ShaderParamType::ConstBuffer, 2));
+    shaderParams->addParam(ShaderParam("LinearDepthMap", ShaderParamType::Texture, 0));
+    shaderParams->addParam(ShaderParam("NormalMap", ShaderParamType::Texture, 1));
+    _ssaoHalfResolutionPso = createHalfResolutionPso("./Shaders/SsaoHalfResolution.frag", shaderParams);
+  }
+  {
+    std::shared_ptr<ShaderParams> shaderParams(new ShaderParams());
+    shaderParams->addParam(ShaderParam("PerFrameBuffer", ShaderParamType::ConstBuffer, 1));
+    shaderParams->addParam(ShaderParam("SsaoFrameBuffer", ShaderParamType::ConstBuffer, 2));
+    shaderParams->addParam(ShaderParam("OcclusionMap", ShaderParamType::Texture, 0));
+    shaderParams->addParam(ShaderParam("LinearDepthMap", ShaderParamType::Texture, 1));
+    shaderParams->addParam(ShaderParam("HistoryMap", ShaderParamType::Texture, 2));
+    shaderParams->addParam(ShaderParam("HistoryDepthMap", ShaderParamType::Texture, 3));
+    _ssaoTemporalPso = createHalfResolutionPso("./Shaders/SsaoTemporal.frag", shaderParams);
+  }
+  {
+    std::shared_ptr<ShaderParams> shaderParams(new ShaderParams());
+    shaderParams->addParam(ShaderParam("PerFrameBuffer", ShaderParamType::ConstBuffer, 1));
+    shaderParams->addParam(ShaderParam("OcclusionMap", ShaderParamType::Texture, 0));
+    shaderParams->addParam(ShaderParam("LinearDepthMap", ShaderParamType::Texture, 1));
+    shaderParams->addParam(ShaderParam("DepthMap", ShaderParamType::Texture, 2));
+    _ssaoUpsamplePso = createHalfResolutionPso("./Shaders/SsaoUpsample.frag", shaderParams);
+  }
+
+  // Rounding up keeps every full resolution pixel inside a half resolution texel.
+  uint32 halfWidth = (_windowDims.X + 1) / 2;
+  uint32 halfHeight = (_windowDims.Y + 1) / 2;
+  auto createHalfResolutionRto = [&](TextureFormat format)
+  {
+    TextureDesc halfTexDesc;
+    halfTexDesc.Width = halfWidth;
+    halfTexDesc.Height = halfHeight;
+    halfTexDesc.Usage = TextureUsage::RenderTarget;
+    halfTexDesc.Type = TextureType::Texture2D;
+    halfTexDesc.Format = format;
+
+    RenderTargetDesc halfRtDesc;
+    halfRtDesc.ColourTargets[0] = renderDevice->createTexture(halfTexDesc);
+    halfRtDesc.Width = halfWidth;
+    halfRtDesc.Height = halfHeight;
+    return renderDevice->createRenderTarget(halfRtDesc);
+  };
+  _ssaoHalfResolutionRto = createHalfResolutionRto(TextureFormat::R8);
+  for (uint32 i = 0; i < 2; i++)
+  {
+    _ssaoDepthRtos[i] = createHalfResolutionRto(TextureFormat::R32F);
+    _ssaoHistoryRtos[i] = createHalfResolutionRto(TextureFormat::RG16F);
+  }
+  _ssaoHistoryValid = false;
 }
 
 void Renderer::initLightingPass(const std::shared_ptr<RenderDevice> &renderDevice)
 {
   ShaderDesc vsDesc;
   vsDesc.ShaderType = ShaderType::Vertex;
-  vsDesc.Source = String::foadFromFile("./Shaders/FSPassThrough.vert");
+  vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
   ShaderDesc psDesc;
   psDesc.ShaderType = ShaderType::Fragment;
-  psDesc.Source = String::foadFromFile("./Shaders/PbrLighting.frag");
+  psDesc.FilePath = "./Shaders/PbrLighting.frag";
 
   std::vector<VertexLayoutDesc> vertexLayoutDesc{
       VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
@@ -975,6 +1356,11 @@ void Renderer::initLightingPass(const std::shared_ptr<RenderDevice> &renderDevic
   shaderParams->addParam(ShaderParam("MaterialMap", ShaderParamType::Texture, 3));
   shaderParams->addParam(ShaderParam("ShadowMap", ShaderParamType::Texture, 4));
   shaderParams->addParam(ShaderParam("OcclusionMap", ShaderParamType::Texture, 5));
+  shaderParams->addParam(ShaderParam("ClusterMap", ShaderParamType::Texture, 6));
+  shaderParams->addParam(ShaderParam("LightMap", ShaderParamType::Texture, 7));
+  shaderParams->addParam(ShaderParam("LightIndexMap", ShaderParamType::Texture, 8));
+  shaderParams->addParam(ShaderParam("ShadowAtlas", ShaderParamType::Texture, 9));
+  shaderParams->addParam(ShaderParam("ShadowTileMap", ShaderParamType::Texture, 10));
 
   RasterizerStateDesc rasterizerStateDesc{};
 
@@ -1021,11 +1407,11 @@ void Renderer::initBloomDownSamplePass(const std::shared_ptr<RenderDevice> &rend
 {
   ShaderDesc vsDesc;
   vsDesc.ShaderType = ShaderType::Vertex;
-  vsDesc.Source = String::foadFromFile("./Shaders/FSPassThrough.vert");
+  vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
   ShaderDesc psDesc;
   psDesc.ShaderType = ShaderType::Fragment;
-  psDesc.Source = String::foadFromFile("./Shaders/BlurDownSample.frag");
+  psDesc.FilePath = "./Shaders/BlurDownSample.frag";
 
   std::vector<VertexLayoutDesc> vertexLayoutDesc{
       VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
@@ -1080,11 +1466,11 @@ void Renderer::initBloomUpSamplePass(const std::shared_ptr<RenderDevice> &render
 {
   ShaderDesc vsDesc;
   vsDesc.ShaderType = ShaderType::Vertex;
-  vsDesc.Source = String::foadFromFile("./Shaders/FSPassThrough.vert");
+  vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
   ShaderDesc psDesc;
   psDesc.ShaderType = ShaderType::Fragment;
-  psDesc.Source = String::foadFromFile("./Shaders/BlurUpSample.frag");
+  psDesc.FilePath = "./Shaders/BlurUpSample.frag";
 
   std::vector<VertexLayoutDesc> vertexLayoutDesc{
       VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
@@ -1121,11 +1507,11 @@ void Renderer::initToneMappingPass(const std::shared_ptr<RenderDevice> &renderDe
 {
   ShaderDesc vsDesc;
   vsDesc.ShaderType = ShaderType::Vertex;
-  vsDesc.Source = String::foadFromFile("./Shaders/FSPassThrough.vert");
+  vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
   ShaderDesc psDesc;
   psDesc.ShaderType = ShaderType::Fragment;
-  psDesc.Source = String::foadFromFile("./Shaders/ToneMapping.frag");
+  psDesc.FilePath = "./Shaders/ToneMapping.frag";
 
   std::vector<VertexLayoutDesc> vertexLayoutDesc{
       VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
@@ -1170,16 +1556,73 @@ void Renderer::initToneMappingPass(const std::shared_ptr<RenderDevice> &renderDe
   _toneMappingRto = renderDevice->createRenderTarget(rtDesc);
 }
 
+void Renderer::initHiZPass(const std::shared_ptr<RenderDevice> &renderDevice)
+{
+  ShaderDesc vsDesc;
+  vsDesc.ShaderType = ShaderType::Vertex;
+  vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
+
+  ShaderDesc psDesc;
+  psDesc.ShaderType = ShaderType::Fragment;
+  psDesc.FilePath = "./Shaders/HiZDownsample.frag";
+
+  std::vector<VertexLayoutDesc> vertexLayoutDesc{
+      VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
+      VertexLayoutDesc(SemanticType::TexCoord, SemanticFormat::Float2),
+  };
+
+  std::shared_ptr<ShaderParams> shaderParams(new ShaderParams());
+  shaderParams->addParam(ShaderParam("DepthMap", ShaderParamType::Texture, 0));
+
+  RasterizerStateDesc rasterizerStateDesc{};
+  BlendStateDesc blendStateDesc{};
+
+  DepthStencilStateDesc depthStencilStateDesc{};
+  depthStencilStateDesc.DepthReadEnabled = false;
+  depthStencilStateDesc.DepthWriteEnabled = false;
+
+  PipelineStateDesc pipelineDesc;
+  pipelineDesc.VS = renderDevice->createShader(vsDesc);
+  pipelineDesc.FS = renderDevice->createShader(psDesc);
+  pipelineDesc.BlendState = renderDevice->createBlendState(blendStateDesc);
+  pipelineDesc.RasterizerState = renderDevice->createRasterizerState(rasterizerStateDesc);
+  pipelineDesc.DepthStencilState = renderDevice->createDepthStencilState(depthStencilStateDesc);
+  pipelineDesc.VertexLayout = renderDevice->createVertexLayout(vertexLayoutDesc);
+  pipelineDesc.ShaderParams = shaderParams;
+
+  _hiZPso = renderDevice->createPipelineState(pipelineDesc);
+
+  uint32 width = std::min(HI_Z_WIDTH, static_cast<uint32>(_windowDims.X));
+  uint32 height = std::max(static_cast<uint32>(static_cast<uint64>(width) * _windowDims.Y / _windowDims.X), 1u);
+
+  TextureDesc depthTexDesc;
+  depthTexDesc.Width = width;
+  depthTexDesc.Height = height;
+  depthTexDesc.Usage = TextureUsage::RenderTarget;
+  depthTexDesc.Type = TextureType::Texture2D;
+  depthTexDesc.Format = TextureFormat::R32F;
+
+  RenderTargetDesc rtDesc;
+  rtDesc.ColourTargets[0] = renderDevice->createTexture(depthTexDesc);
+  rtDesc.Width = width;
+  rtDesc.Height = height;
+
+  _hiZRto = renderDevice->createRenderTarget(rtDesc);
+  _hiZReadback = renderDevice->createTextureReadback();
+  _hiZReadbackViews.clear();
+  _hiZBufferValid = false;
+}
+
 void Renderer::initDebugPass(const std::shared_ptr<RenderDevice> &renderDevice)
 {
   {
     ShaderDesc vsDesc;
     vsDesc.ShaderType = ShaderType::Vertex;
-    vsDesc.Source = String::foadFromFile("./Shaders/FSPassThrough.vert");
+    vsDesc.FilePath = "./Shaders/FSPassThrough.vert";
 
     ShaderDesc psDesc;
     psDesc.ShaderType = ShaderType::Fragment;
-    psDesc.Source = String::foadFromFile("./Shaders/Editor/DrawTexturedQuad.frag");
+    psDesc.FilePath = "./Shaders/Editor/DrawTexturedQuad.frag";
 
     std::vector<VertexLayoutDesc> vertexLayoutDesc{
         VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float2),
@@ -1208,11 +1651,11 @@ void Renderer::initDebugPass(const std::shared_ptr<RenderDevice> &renderDevice)
   {
     ShaderDesc vsDesc;
     vsDesc.ShaderType = ShaderType::Vertex;
-    vsDesc.Source = String::foadFromFile("./Shaders/Basic.vert");
+    vsDesc.FilePath = "./Shaders/Basic.vert";
 
     ShaderDesc psDesc;
     psDesc.ShaderType = ShaderType::Fragment;
-    psDesc.Source = String::foadFromFile("./Shaders/Basic.frag");
+    psDesc.FilePath = "./Shaders/Basic.frag";
 
     std::vector<VertexLayoutDesc> vertexLayoutDesc{
         VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float3)};
@@ -1245,7 +1688,6 @@ void Renderer::initDebugPass(const std::shared_ptr<RenderDevice> &renderDevice)
 }
 
 void Renderer::directionalLightDepthPass(const std::shared_ptr<RenderDevice> &renderDevice,
-                                         const std::vector<std::shared_ptr<Drawable>> &drawables,
                                          const std::shared_ptr<Light> &directionalLight,
                                          const std::shared_ptr<Camera> &camera)
 {
@@ -1255,134 +1697,181 @@ void Renderer::directionalLightDepthPass(const std::shared_ptr<RenderDevice> &re
   }
 
   std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[0]->begin();
 
-  renderDevice->setPipelineState(_shadowMapPso);
+  renderDevice->setPipelineState(_shadowMapPsos[static_cast<uint32>(VertexFormat::Full)]);
 
   ViewportDesc viewportDesc;
   viewportDesc.Height = _shadowMapResolution;
   viewportDesc.Width = _shadowMapResolution;
   renderDevice->setViewport(viewportDesc);
-  renderDevice->setRenderTarget(_shadowMapRto);
-  renderDevice->clearBuffers(RTT_Depth);
-  renderDevice->setConstantBuffer(0, _perObjectBuffer);
-  renderDevice->setConstantBuffer(1, _perFrameBuffer);
 
-  for (const auto &drawable : drawables)
+  resetBoundDrawState();
+  for (uint32 i = 0; i < _cascadeCount; i++)
   {
-    std::shared_ptr<Material> material(drawable->getMaterial());
-    drawDrawable(renderDevice, drawable, material, camera);
+    // Cached cascades keep their layer from the frame it was last drawn.
+    if (!_shadowCascades.isRendered(i))
+    {
+      continue;
+    }
+
+    renderDevice->setRenderTarget(_cascadeRtos[i]);
+    renderDevice->clearBuffers(RTT_Depth);
+    for (const auto &batch : _cascadeBatches[i])
+    {
+      drawBatch(renderDevice, batch, _shadowMapPsos);
+    }
   }
 
+  _renderPassTimers[0]->end();
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _renderPassTimings[0].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
 
+void Renderer::localLightShadowPass(const std::shared_ptr<RenderDevice> &renderDevice)
+{
+  if (_shadowAtlasSizeChanged)
+  {
+    createShadowAtlas(renderDevice);
+  }
+
+  std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[8]->begin();
+
+  renderDevice->setRenderTarget(_shadowAtlasRto);
+
+  // Tiles which are not rendered keep what an earlier frame drew into them.
+  const std::vector<ShadowAtlasAllocation> &allocations = _shadowAtlas.getAllocations();
+  uint32 tileIndex = 0;
+  for (uint32 i = 0; i < allocations.size(); i++)
+  {
+    const ShadowAtlasAllocation &allocation = allocations[i];
+    if (!allocation.Rendered)
+    {
+      continue;
+    }
+
+    for (uint32 tile = 0; tile < _shadowAtlasRequests[i].TileCount; tile++)
+    {
+      ViewportDesc viewportDesc;
+      viewportDesc.TopLeftX = allocation.Tiles[tile].X;
+      viewportDesc.TopLeftY = allocation.Tiles[tile].Y;
+      viewportDesc.Width = allocation.TileSize;
+      viewportDesc.Height = allocation.TileSize;
+      renderDevice->setViewport(viewportDesc);
+
+      renderDevice->setPipelineState(_clearDepthPso);
+      renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
+      renderDevice->draw(6, 0);
+
+      resetBoundDrawState();
+      for (const auto &batch : _localShadowBatches[tileIndex++])
+      {
+        drawBatch(renderDevice, batch, _shadowMapPsos);
+      }
+    }
+  }
+
+  _renderPassTimers[8]->end();
+  std::chrono::time_point end = std::chrono::high_resolution_clock::now();
+  _renderPassTimings[8].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
 void Renderer::gbufferPass(std::shared_ptr<RenderDevice> renderDevice,
-                           const std::vector<std::shared_ptr<Drawable>> &drawables,
                            const std::shared_ptr<Camera> &camera)
 {
   std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[1]->begin();
 
   ViewportDesc viewportDesc;
   viewportDesc.Width = _windowDims.X;
   viewportDesc.Height = _windowDims.Y;
   renderDevice->setViewport(viewportDesc);
 
-  renderDevice->setPipelineState(_gBufferPso);
+  renderDevice->setPipelineState(_gBufferPsos[static_cast<uint32>(VertexFormat::Full)]);
   renderDevice->setRenderTarget(_gBufferRto);
   renderDevice->clearBuffers(RTT_Colour | RTT_Depth | RTT_Stencil);
-  renderDevice->setConstantBuffer(0, _perObjectBuffer);
 
-  for (const auto &drawable : drawables)
+  resetBoundDrawState();
+  for (const auto &batch : _opaqueBatches)
   {
-    std::shared_ptr<Material> material(drawable->getMaterial());
-    if (material->hasDiffuseTexture())
-    {
-      renderDevice->setTexture(0, material->getDiffuseTexture());
-      renderDevice->setSamplerState(0, _basicSamplerState);
-    }
-    if (material->hasNormalTexture())
-    {
-      renderDevice->setTexture(1, material->getNormalTexture());
-      renderDevice->setSamplerState(1, _basicSamplerState);
-    }
-    if (material->hasMetallicTexture())
-    {
-      renderDevice->setTexture(2, material->getMetallicTexture());
-      renderDevice->setSamplerState(2, _basicSamplerState);
-    }
-    if (material->hasRoughnessTexture())
-    {
-      renderDevice->setTexture(3, material->getRoughnessTexture());
-      renderDevice->setSamplerState(3, _basicSamplerState);
-    }
-    if (material->hasOcclusionTexture())
-    {
-      renderDevice->setTexture(4, material->getOcclusionTexture());
-      renderDevice->setSamplerState(4, _basicSamplerState);
-    }
-
-    drawDrawable(renderDevice, drawable, material, camera);
+    bindMaterialTextures(renderDevice, batch.MaterialPtr, false);
+    drawBatch(renderDevice, batch, _gBufferPsos);
   }
 
+  _renderPassTimers[1]->end();
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _renderPassTimings[1].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
 
 void Renderer::transparencyPass(const std::shared_ptr<RenderDevice> &renderDevice,
-                                const std::vector<std::shared_ptr<Drawable>> &transparentDrawables,
                                 const std::shared_ptr<Camera> &camera)
 {
   std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[2]->begin();
 
-  renderDevice->setPipelineState(_transparencyPso);
+  renderDevice->setPipelineState(_transparencyPsos[static_cast<uint32>(VertexFormat::Full)]);
   renderDevice->setRenderTarget(_gBufferRto);
-  renderDevice->setConstantBuffer(0, _perObjectBuffer);
 
-  for (const auto &drawable : transparentDrawables)
+  resetBoundDrawState();
+  for (const auto &batch : _transparentBatches)
   {
-    std::shared_ptr<Material> material(drawable->getMaterial());
-    if (material->hasDiffuseTexture())
-    {
-      renderDevice->setTexture(0, material->getDiffuseTexture());
-      renderDevice->setSamplerState(0, _basicSamplerState);
-    }
-    if (material->hasNormalTexture())
-    {
-      renderDevice->setTexture(1, material->getNormalTexture());
-      renderDevice->setSamplerState(1, _basicSamplerState);
-    }
-    if (material->hasMetallicTexture())
-    {
-      renderDevice->setTexture(2, material->getMetallicTexture());
-      renderDevice->setSamplerState(2, _basicSamplerState);
-    }
-    if (material->hasRoughnessTexture())
-    {
-      renderDevice->setTexture(3, material->getRoughnessTexture());
-      renderDevice->setSamplerState(3, _basicSamplerState);
-    }
-    if (material->hasOcclusionTexture())
-    {
-      renderDevice->setTexture(4, material->getOcclusionTexture());
-      renderDevice->setSamplerState(4, _basicSamplerState);
-    }
-    if (material->hasOpacityTexture())
-    {
-      renderDevice->setTexture(5, material->getOpacityTexture());
-      renderDevice->setSamplerState(5, _noMipSamplerState);
-    }
-
-    drawDrawable(renderDevice, drawable, material, camera);
+    bindMaterialTextures(renderDevice, batch.MaterialPtr, true);
+    drawBatch(renderDevice, batch, _transparencyPsos);
   }
 
+  _renderPassTimers[2]->end();
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _renderPassTimings[2].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
 
+void Renderer::hiZPass(const std::shared_ptr<RenderDevice> &renderDevice,
+                       const std::shared_ptr<Camera> &camera)
+{
+  std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[9]->begin();
+
+  // The timer still runs while disabled, as the frame's GPU time is only reported once every pass has a result.
+  if (!_occlusionCullingEnabled)
+  {
+    _renderPassTimers[9]->end();
+    _renderPassTimings[9].Duration = 0;
+    return;
+  }
+
+  ViewportDesc viewportDesc;
+  viewportDesc.Width = _hiZRto->getDesc().Width;
+  viewportDesc.Height = _hiZRto->getDesc().Height;
+  renderDevice->setViewport(viewportDesc);
+
+  renderDevice->setPipelineState(_hiZPso);
+  renderDevice->setRenderTarget(_hiZRto);
+  renderDevice->setTexture(0, _gBufferRto->getDepthStencilTarget());
+  renderDevice->setSamplerState(0, _noMipSamplerState);
+  renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
+  renderDevice->draw(6, 0);
+
+  // The copy arrives a few frames later, along with the view it was drawn from.
+  uint64 id = _hiZReadback->copy(_hiZRto->getColourTarget(0));
+  if (_hiZReadbackViews.size() == MAX_HI_Z_READBACK_VIEWS)
+  {
+    _hiZReadbackViews.erase(_hiZReadbackViews.begin());
+  }
+  _hiZReadbackViews.push_back({id, camera->getProj() * camera->getView()});
+
+  viewportDesc.Width = _windowDims.X;
+  viewportDesc.Height = _windowDims.Y;
+  renderDevice->setViewport(viewportDesc);
+
+  _renderPassTimers[9]->end();
+  std::chrono::time_point end = std::chrono::high_resolution_clock::now();
+  _renderPassTimings[9].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
 void Renderer::shadowPass(const std::shared_ptr<RenderDevice> &renderDevice)
 {
   std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[3]->begin();
 
   renderDevice->setPipelineState(_shadowsPso);
   renderDevice->setRenderTarget(_shadowsRto);
@@ -1398,6 +1887,7 @@ void Renderer::shadowPass(const std::shared_ptr<RenderDevice> &renderDevice)
   renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
   renderDevice->draw(6, 0);
 
+  _renderPassTimers[3]->end();
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _renderPassTimings[3].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
@@ -1406,6 +1896,7 @@ void Renderer::ssaoPass(const std::shared_ptr<RenderDevice> &renderDevice,
                         const std::shared_ptr<Camera> &camera)
 {
   std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[4]->begin();
 
   if (_ssaoSettingsModified)
   {
@@ -1413,6 +1904,15 @@ void Renderer::ssaoPass(const std::shared_ptr<RenderDevice> &renderDevice,
     _ssaoSettingsModified = false;
   }
 
+  if (_ssaoHalfResolution)
+  {
+    halfResolutionSsaoPass(renderDevice, camera);
+    _renderPassTimers[4]->end();
+    std::chrono::time_point end = std::chrono::high_resolution_clock::now();
+    _renderPassTimings[4].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return;
+  }
+
   renderDevice->setPipelineState(_ssaoPso);
   renderDevice->setRenderTarget(_ssaoRto);
   renderDevice->setTexture(0, _gBufferRto->getDepthStencilTarget());
@@ -1432,15 +1932,98 @@ void Renderer::ssaoPass(const std::shared_ptr<RenderDevice> &renderDevice,
   renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
   renderDevice->draw(6, 0);
 
+  _renderPassTimers[4]->end();
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _renderPassTimings[4].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
 
+void Renderer::halfResolutionSsaoPass(const std::shared_ptr<RenderDevice> &renderDevice,
+                                      const std::shared_ptr<Camera> &camera)
+{
+  uint32 current = _ssaoFrameIndex % 2;
+  uint32 previous = 1 - current;
+  Matrix4 view = camera->getView();
+  Matrix4 viewProj = camera->getProj() * view;
+
+  SsaoFrameBufferData ssaoFrameBufferData{};
+  ssaoFrameBufferData.InverseView = view.Inverse();
+  ssaoFrameBufferData.PreviousViewProj = _ssaoPreviousViewProj;
+  ssaoFrameBufferData.FrameIndex = _ssaoFrameIndex;
+  ssaoFrameBufferData.DepthRejection = _ssaoDepthRejection;
+  ssaoFrameBufferData.MaxHistory = static_cast<float32>(_ssaoMaxHistory);
+  ssaoFrameBufferData.HistoryValid = _ssaoHistoryValid;
+  _ssaoFrameBuffer->writeData(0, sizeof(SsaoFrameBufferData), &ssaoFrameBufferData, AccessType::WriteOnlyDiscard);
+
+  ViewportDesc viewportDesc;
+  viewportDesc.Width = _ssaoHalfResolutionRto->getDesc().Width;
+  viewportDesc.Height = _ssaoHalfResolutionRto->getDesc().Height;
+  renderDevice->setViewport(viewportDesc);
+
+  // Linear depth at half resolution, kept a frame for the next frame's history to be tested against.
+  renderDevice->setPipelineState(_ssaoDownsamplePso);
+  renderDevice->setRenderTarget(_ssaoDepthRtos[current]);
+  renderDevice->setTexture(0, _gBufferRto->getDepthStencilTarget());
+  renderDevice->setSamplerState(0, _noMipSamplerState);
+  renderDevice->setConstantBuffer(1, _perFrameBuffer);
+  renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
+  renderDevice->draw(6, 0);
+
+  renderDevice->setPipelineState(_ssaoHalfResolutionPso);
+  renderDevice->setRenderTarget(_ssaoHalfResolutionRto);
+  renderDevice->setTexture(0, _ssaoDepthRtos[current]->getColourTarget(0));
+  renderDevice->setTexture(1, _gBufferRto->getColourTarget(1));
+  renderDevice->setSamplerState(0, _noMipSamplerState);
+  renderDevice->setSamplerState(1, _noMipSamplerState);
+  renderDevice->setConstantBuffer(0, _ssaoConstantsBuffer);
+  renderDevice->setConstantBuffer(1, _perFrameBuffer);
+  renderDevice->setConstantBuffer(2, _ssaoFrameBuffer);
+  renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
+  renderDevice->draw(6, 0);
+
+  renderDevice->setPipelineState(_ssaoTemporalPso);
+  renderDevice->setRenderTarget(_ssaoHistoryRtos[current]);
+  renderDevice->setTexture(0, _ssaoHalfResolutionRto->getColourTarget(0));
+  renderDevice->setTexture(1, _ssaoDepthRtos[current]->getColourTarget(0));
+  renderDevice->setTexture(2, _ssaoHistoryRtos[previous]->getColourTarget(0));
+  renderDevice->setTexture(3, _ssaoDepthRtos[previous]->getColourTarget(0));
+  for (uint32 i = 0; i < 4; i++)
+  {
+    renderDevice->setSamplerState(i, _noMipSamplerState);
+  }
+  renderDevice->setConstantBuffer(1, _perFrameBuffer);
+  renderDevice->setConstantBuffer(2, _ssaoFrameBuffer);
+  renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
+  renderDevice->draw(6, 0);
+
+  // Upsampled into the target the lighting pass reads either way.
+  viewportDesc.Width = _windowDims.X;
+  viewportDesc.Height = _windowDims.Y;
+  renderDevice->setViewport(viewportDesc);
+
+  renderDevice->setPipelineState(_ssaoUpsamplePso);
+  renderDevice->setRenderTarget(_ssaoBlurRto);
+  renderDevice->setTexture(0, _ssaoHistoryRtos[current]->getColourTarget(0));
+  renderDevice->setTexture(1, _ssaoDepthRtos[current]->getColourTarget(0));
+  renderDevice->setTexture(2, _gBufferRto->getDepthStencilTarget());
+  for (uint32 i = 0; i < 3; i++)
+  {
+    renderDevice->setSamplerState(i, _noMipSamplerState);
+  }
+  renderDevice->setConstantBuffer(1, _perFrameBuffer);
+  renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
+  renderDevice->draw(6, 0);
+
+  _ssaoPreviousViewProj = viewProj;
+  _ssaoHistoryValid = true;
+  _ssaoFrameIndex++;
+}
+
 void Renderer::lightingPass(const std::shared_ptr<RenderDevice> &renderDevice,
                             const std::vector<std::shared_ptr<Light>> &lights,
                             const std::shared_ptr<Camera> &camera)
 {
   std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[5]->begin();
 
   renderDevice->setPipelineState(_lightingPso);
   renderDevice->setRenderTarget(_lightingPassRto);
@@ -1450,17 +2033,29 @@ void Renderer::lightingPass(const std::shared_ptr<RenderDevice> &renderDevice,
   renderDevice->setTexture(3, _gBufferRto->getColourTarget(2));
   renderDevice->setTexture(4, _shadowsRto->getColourTarget(0));
   renderDevice->setTexture(5, _ssaoBlurRto->getColourTarget(0));
+  renderDevice->setTexture(6, _clusterMap);
+  renderDevice->setTexture(7, _lightMap);
+  renderDevice->setTexture(8, _lightIndexMap);
+  renderDevice->setTexture(9, _shadowAtlasRto->getDepthStencilTarget());
+  renderDevice->setTexture(10, _shadowTileMap);
   renderDevice->setSamplerState(0, _noMipSamplerState);
   renderDevice->setSamplerState(1, _noMipSamplerState);
   renderDevice->setSamplerState(2, _noMipSamplerState);
   renderDevice->setSamplerState(3, _noMipSamplerState);
   renderDevice->setSamplerState(4, _noMipSamplerState);
   renderDevice->setSamplerState(5, _noMipSamplerState);
+  // Integer textures are only complete with nearest filtering.
+  renderDevice->setSamplerState(6, _noMipSamplerState);
+  renderDevice->setSamplerState(7, _noMipSamplerState);
+  renderDevice->setSamplerState(8, _noMipSamplerState);
+  renderDevice->setSamplerState(9, _shadowMapSamplerState);
+  renderDevice->setSamplerState(10, _noMipSamplerState);
   renderDevice->setConstantBuffer(1, _perFrameBuffer);
 
   renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
   renderDevice->draw(6, 0);
 
+  _renderPassTimers[5]->end();
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _renderPassTimings[5].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
@@ -1468,6 +2063,7 @@ void Renderer::lightingPass(const std::shared_ptr<RenderDevice> &renderDevice,
 void Renderer::bloomPass(const std::shared_ptr<RenderDevice> &renderDevice)
 {
   std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[6]->begin();
 
   renderDevice->setTexture(0, _lightingPassRto->getColourTarget(1)); // Use bloom output
   renderDevice->setSamplerState(0, _bloomSamplerState);
@@ -1522,6 +2118,7 @@ void Renderer::bloomPass(const std::shared_ptr<RenderDevice> &renderDevice)
   viewportDesc.Height = _windowDims.Y;
   renderDevice->setViewport(viewportDesc);
 
+  _renderPassTimers[6]->end();
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _renderPassTimings[6].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
@@ -1529,6 +2126,7 @@ void Renderer::bloomPass(const std::shared_ptr<RenderDevice> &renderDevice)
 void Renderer::toneMappingPass(const std::shared_ptr<RenderDevice> &renderDevice)
 {
   std::chrono::time_point start = std::chrono::high_resolution_clock::now();
+  _renderPassTimers[7]->begin();
 
   renderDevice->setPipelineState(_toneMappingPso);
   renderDevice->setRenderTarget(_toneMappingRto);
@@ -1541,6 +2139,7 @@ void Renderer::toneMappingPass(const std::shared_ptr<RenderDevice> &renderDevice
   renderDevice->setVertexBuffer(_fsQuadVertexBuffer);
   renderDevice->draw(6, 0);
 
+  _renderPassTimers[7]->end();
   std::chrono::time_point end = std::chrono::high_resolution_clock::now();
   _renderPassTimings[7].Duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
@@ -1602,29 +2201,119 @@ void Renderer::debugPass(const std::shared_ptr<RenderDevice> &renderDevice,
   drawAabb(renderDevice, aabbDrawables, camera);
 }
 
-void Renderer::drawDrawable(const std::shared_ptr<RenderDevice> &renderDevice,
-                            const std::shared_ptr<Drawable> &drawable,
-                            const std::shared_ptr<Material> &material,
-                            const std::shared_ptr<Camera> &camera)
+void Renderer::drawBatch(const std::shared_ptr<RenderDevice> &renderDevice,
+                         const DrawBatch &batch,
+                         const MeshPipelineStates &pipelineStates)
 {
-  writePerObjectConstantData(drawable, material, camera);
+  const std::shared_ptr<StaticMesh> &mesh = batch.MeshPtr;
+  const std::shared_ptr<PipelineState> &pipelineState = pipelineStates[static_cast<uint32>(mesh->getVertexFormat())];
+  if (pipelineState.get() != _boundPipelineState)
+  {
+    renderDevice->setPipelineState(pipelineState);
+    _boundPipelineState = pipelineState.get();
+  }
 
-  std::shared_ptr<StaticMesh> mesh = drawable->getMesh();
-  renderDevice->setVertexBuffer(mesh->getVertexData(renderDevice));
+  renderDevice->setConstantBuffer(0, _perObjectArena->getBuffer(), batch.ConstantsOffset, sizeof(PerObjectBufferData));
+  renderDevice->setInstanceBuffer(_instanceArena->getBuffer(), batch.InstanceOffset);
+
+  if (mesh.get() != _boundMesh)
+  {
+    renderDevice->setVertexBuffer(mesh->getVertexData(renderDevice));
+    if (mesh->isIndexed())
+    {
+      renderDevice->setIndexBuffer(mesh->getIndexData(renderDevice));
+    }
+    _boundMesh = mesh.get();
+    _stateStats.MeshChanges++;
+  }
 
   if (mesh->isIndexed())
   {
-    auto indexCount = mesh->getIndexCount();
-    renderDevice->setIndexBuffer(mesh->getIndexData(renderDevice));
-    renderDevice->drawIndexed(indexCount, 0, 0);
+    MeshLod lod = mesh->getLod(batch.Lod);
+    renderDevice->drawIndexedInstanced(lod.IndexCount, lod.IndexOffset, 0, batch.InstanceCount);
   }
   else
   {
-    auto vertexCount = mesh->getVertexCount();
-    renderDevice->draw(vertexCount, 0);
+    renderDevice->drawInstanced(mesh->getVertexCount(), 0, batch.InstanceCount);
+  }
+  _stateStats.DrawCalls++;
+}
+
+void Renderer::bindMaterialTextures(const std::shared_ptr<RenderDevice> &renderDevice,
+                                    const std::shared_ptr<Material> &material,
+                                    bool opacityEnabled)
+{
+  // Batches are sorted by material, so runs of batches that only differ by mesh leave the textures untouched.
+  if (material.get() == _boundMaterial)
+  {
+    return;
+  }
+  _boundMaterial = material.get();
+  _stateStats.MaterialChanges++;
+
+  if (material->hasDiffuseTexture())
+  {
+    bindTexture(renderDevice, 0, material->getDiffuseTexture(), _basicSamplerState);
+  }
+  if (material->hasNormalTexture())
+  {
+    bindTexture(renderDevice, 1, material->getNormalTexture(), _basicSamplerState);
+  }
+  if (material->hasMetallicTexture())
+  {
+    bindTexture(renderDevice, 2, material->getMetallicTexture(), _basicSamplerState);
+  }
+  if (material->hasRoughnessTexture())
+  {
+    bindTexture(renderDevice, 3, material->getRoughnessTexture(), _basicSamplerState);
+  }
+  if (material->hasOcclusionTexture())
+  {
+    bindTexture(renderDevice, 4, material->getOcclusionTexture(), _basicSamplerState);
+  }
+  if (opacityEnabled && material->hasOpacityTexture())
+  {
+    bindTexture(renderDevice, 5, material->getOpacityTexture(), _noMipSamplerState);
   }
 }
 
+void Renderer::bindTexture(const std::shared_ptr<RenderDevice> &renderDevice,
+                           uint32 slot,
+                           const std::shared_ptr<Texture> &texture,
+                           const std::shared_ptr<SamplerState> &samplerState)
+{
+  if (_boundTextures[slot] != texture.get())
+  {
+    renderDevice->setTexture(slot, texture);
+    _boundTextures[slot] = texture.get();
+    _stateStats.TextureBinds++;
+  }
+  else
+  {
+    _stateStats.RedundantBindsSkipped++;
+  }
+
+  if (_boundSamplers[slot] != samplerState.get())
+  {
+    renderDevice->setSamplerState(slot, samplerState);
+    _boundSamplers[slot] = samplerState.get();
+    _stateStats.SamplerBinds++;
+  }
+  else
+  {
+    _stateStats.RedundantBindsSkipped++;
+  }
+}
+
+void Renderer::resetBoundDrawState()
+{
+  _boundPipelineState = nullptr;
+  _boundMesh = nullptr;
+  _boundMaterial = nullptr;
+  _boundTextures.fill(nullptr);
+  _boundSamplers.fill(nullptr);
+}
+
 void Renderer::drawAabb(const std::shared_ptr<RenderDevice> &renderDevice,
                         const std::vector<std::shared_ptr<Drawable>> &aabbDrawables,
                         const std::shared_ptr<Camera> &camera)
@@ -1632,17 +2321,9 @@ void Renderer::drawAabb(const std::shared_ptr<RenderDevice> &renderDevice,
   _gBufferRto->copy(nullptr);
 
   renderDevice->setPipelineState(_drawAabbPso);
-  for (auto drawable : aabbDrawables)
+  for (uint32 i = 0; i < aabbDrawables.size(); i++)
   {
-    auto &aabb = drawable->getAabb();
-
-    PerObjectBufferData objectBufferData;
-    objectBufferData.Model = Matrix4::Translation(drawable->getPosition()) * Matrix4::Scaling(aabb.getExtents());
-    objectBufferData.ModelView = camera->getView() * objectBufferData.Model;
-    objectBufferData.ModelViewProjection = camera->getProj() * objectBufferData.ModelView;
-    _perObjectBuffer->writeData(0, sizeof(PerObjectBufferData), &objectBufferData, AccessType::WriteOnlyDiscard);
-
-    renderDevice->setConstantBuffer(0, _perObjectBuffer);
+    renderDevice->setConstantBuffer(0, _perObjectArena->getBuffer(), _aabbObjectOffsets[i], sizeof(PerObjectBufferData));
     renderDevice->setVertexBuffer(_aabbVertexBuffer);
     renderDevice->draw(AabbCoords.size(), 0);
   }
@@ -1716,10 +2397,12 @@ std::vector<Matrix4> Renderer::calculateCameraCascadeProjections(const std::shar
   std::vector<float32> cascadeLevels(calculateCascadeLevels(nearPlane, farPlane));
 
   std::vector<Matrix4> projections;
-  projections.push_back(Matrix4::Perspective(fov, aspect, nearPlane, cascadeLevels[0]));
-  projections.push_back(Matrix4::Perspective(fov, aspect, cascadeLevels[0], cascadeLevels[1]));
-  projections.push_back(Matrix4::Perspective(fov, aspect, cascadeLevels[1], cascadeLevels[2]));
-  projections.push_back(Matrix4::Perspective(fov, aspect, cascadeLevels[2], farPlane));
+  for (uint32 i = 0; i < _cascadeCount; i++)
+  {
+    float32 cascadeNear = i == 0 ? nearPlane : cascadeLevels[i - 1];
+    float32 cascadeFar = i == _cascadeCount - 1 ? farPlane : cascadeLevels[i];
+    projections.push_back(Matrix4::Perspective(fov, aspect, cascadeNear, cascadeFar));
+  }
   return projections;
 }
 
@@ -1746,41 +2429,121 @@ std::vector<float32> Renderer::calculateCascadeLevels(float32 nearClip, float32
   return cascadeSplits;
 }
 
-std::vector<Matrix4> Renderer::calculateCascadeLightTransforms(const std::shared_ptr<Camera> &camera, const std::shared_ptr<Light> &directionalLight) const
+std::vector<CascadeBounds> Renderer::calculateCascadeBounds(const std::shared_ptr<Camera> &camera) const
 {
-  std::vector<Matrix4> results;
+  std::vector<CascadeBounds> results;
   std::vector<Matrix4> projections = calculateCameraCascadeProjections(camera);
   for (uint32 i = 0; i < _cascadeCount; i++)
   {
     auto frustrumCorners = calculateFrustrumCorners(camera->getView(), projections[i]);
     Vector3 frustrumCenter = calculateFrustrumCenter(frustrumCorners);
-    const float32 radius = calculateCascadeRadius(frustrumCorners, frustrumCenter);
+    results.push_back({frustrumCenter, calculateCascadeRadius(frustrumCorners, frustrumCenter)});
+  }
+  return results;
+}
 
-    Vector3 maxExtents(radius, radius, radius);
-    Vector3 minExtents = -maxExtents;
-    Vector3 cascadeExtents = maxExtents - minExtents;
+void Renderer::updateShadowCascades(const std::shared_ptr<Camera> &camera,
+                                    const std::shared_ptr<Light> &directionalLight,
+                                    const std::vector<std::shared_ptr<Drawable>> &allDrawables,
+                                    JobSystem *jobs)
+{
+  // The shadow map itself is recreated by the depth pass later in the frame, so every cascade is drawn into it.
+  if (_shadowResolutionChanged || _shadowCascades.getCascadeCount() != _cascadeCount)
+  {
+    _shadowCascades.reset(_cascadeCount, _shadowMapResolution);
+  }
+
+  _casterBounds.clear();
+  for (const auto &drawable : allDrawables)
+  {
+    _casterBounds.add(drawable->getWorldAabb());
+  }
+  _shadowCascades.update(calculateCascadeBounds(camera), directionalLight->getDirection(), _casterBounds, jobs);
+}
 
-    Vector3 lightDirection = -directionalLight->getDirection();
-    Vector3 shadowCameraPos = frustrumCenter + lightDirection * -minExtents.Z;
-    Matrix4 shadowCameraView = Matrix4::LookAt(shadowCameraPos, frustrumCenter, Vector3::Up);
+void Renderer::updateShadowAtlas(const std::shared_ptr<Camera> &camera,
+                                 const std::vector<std::shared_ptr<Light>> &lights,
+                                 const std::vector<std::shared_ptr<Drawable>> &allDrawables)
+{
+  // The atlas texture itself is recreated by the local shadow pass later in the frame.
+  if (_shadowAtlasSizeChanged)
+  {
+    _shadowAtlas.reset(_shadowAtlasSize, _shadowAtlasMaxTileSize);
+  }
 
-    Matrix4 shadowCameraProj = Matrix4::Orthographic(-radius, radius, -radius, radius, -cascadeExtents.Z, cascadeExtents.Z);
-    Matrix4 shadowMatrix = shadowCameraProj * shadowCameraView;
-    Vector4 shadowOrigin(0.0f, 0.0f, 0.0f, 1.0f);
-    shadowOrigin = shadowMatrix * shadowOrigin;
-    shadowOrigin = shadowOrigin * _shadowMapResolution / 2.0f;
+  Frustrum cameraFrustrum(*camera);
+  _shadowAtlasRequests.clear();
+  _shadowAtlasLights.clear();
+  for (const auto &light : lights)
+  {
+    LightType lightType = light->getLightType();
+    if (!light->castsShadows() || (lightType != LightType::Point && lightType != LightType::Spot))
+    {
+      continue;
+    }
 
-    Vector4 roundedOrigin = Math::RoundToEven(shadowOrigin);
-    Vector4 roundedOffset = roundedOrigin - shadowOrigin;
-    roundedOffset = roundedOffset * (2.0f / _shadowMapResolution);
-    roundedOffset.Z = 0.0f;
-    roundedOffset.W = 0.0f;
+    // A light only shades what lies within its radius, so its shadows cannot be seen while that is off screen.
+    Vector3 position = light->getPosition();
+    float32 radius = light->getRadius();
+    uint32 planeMask = FRUSTRUM_ALL_PLANES;
+    if (cameraFrustrum.intersects(Aabb(position, radius, radius, radius), planeMask) == FrustrumIntersection::Outside)
+    {
+      continue;
+    }
 
-    shadowCameraProj[3] += roundedOffset;
+    ShadowAtlasRequest request;
+    request.Id = light->getId();
+    float32 distance = std::max(camera->distanceFrom(position) - radius, 0.0f);
+    float32 radiusPixels = LodSelector::getProjectedSize(radius, distance, camera->getFov(), camera->getHeight());
+    request.Size = std::min(2.0f * radiusPixels, static_cast<float32>(_shadowAtlasSize)) * _shadowAtlasTexelScale;
 
-    results.push_back(shadowCameraProj * shadowCameraView);
+    float32 nearClip = radius * LOCAL_SHADOW_NEAR_FRACTION;
+    if (lightType == LightType::Point)
+    {
+      request.TileCount = 6;
+      Matrix4 projection = Matrix4::Perspective(Degree(90.0f), 1.0f, nearClip, radius);
+      for (uint32 i = 0; i < 6; i++)
+      {
+        request.Transforms[i] = projection * Matrix4::LookAt(position, position + CUBE_FACE_DIRECTIONS[i], CUBE_FACE_UPS[i]);
+      }
+    }
+    else
+    {
+      request.TileCount = 1;
+      Vector3 direction = light->getDirection();
+      Vector3 up = std::abs(direction.Y) > 0.99f ? Vector3(1.0f, 0.0f, 0.0f) : Vector3::Up;
+      Matrix4 projection = Matrix4::Perspective(Degree(2.0f * light->getSpotOuterAngle().InDegrees()), 1.0f, nearClip, radius);
+      request.Transforms[0] = projection * Matrix4::LookAt(position, position + direction, up);
+    }
+
+    // The transforms cover the light's position, direction, radius and cone. Each caster within its radius adds its
+    // index and matrix, so the tiles go stale when any of them moves, appears or disappears.
+    uint64 signature = Hash::fnv1a(request.Transforms.data(), request.TileCount * sizeof(Matrix4));
+    const float32 *centerX = _casterBounds.getCenterX();
+    const float32 *centerY = _casterBounds.getCenterY();
+    const float32 *centerZ = _casterBounds.getCenterZ();
+    const float32 *extentX = _casterBounds.getExtentX();
+    const float32 *extentY = _casterBounds.getExtentY();
+    const float32 *extentZ = _casterBounds.getExtentZ();
+    for (uint32 i = 0; i < _casterBounds.size(); i++)
+    {
+      Vector3 offset(std::max(std::abs(position.X - centerX[i]) - extentX[i], 0.0f),
+                     std::max(std::abs(position.Y - centerY[i]) - extentY[i], 0.0f),
+                     std::max(std::abs(position.Z - centerZ[i]) - extentZ[i], 0.0f));
+      if (Vector3::Dot(offset, offset) > radius * radius)
+      {
+        continue;
+      }
+      Matrix4 matrix = allDrawables[i]->getMatrix();
+      signature = Hash::fnv1a(&i, sizeof(uint32), signature);
+      signature = Hash::fnv1a(&matrix, sizeof(Matrix4), signature);
+    }
+    request.Signature = signature;
+
+    _shadowAtlasRequests.push_back(request);
+    _shadowAtlasLights.push_back(light);
   }
-  return results;
+  _shadowAtlas.update(_shadowAtlasRequests, _shadowAtlasTileBudget);
 }
 
 void Renderer::createDirectionalLightShadowDepthMap(const std::shared_ptr<RenderDevice> &renderDevice)
@@ -1799,89 +2562,527 @@ void Renderer::createDirectionalLightShadowDepthMap(const std::shared_ptr<Render
   rtDesc.Width = _shadowMapResolution;
 
   _shadowMapRto = renderDevice->createRenderTarget(rtDesc);
+
+  _cascadeRtos.clear();
+  for (uint32 i = 0; i < _cascadeCount; i++)
+  {
+    rtDesc.DepthStencilLayer = i;
+    _cascadeRtos.push_back(renderDevice->createRenderTarget(rtDesc));
+  }
   _shadowResolutionChanged = false;
 }
 
-void Renderer::writePerObjectConstantData(const std::shared_ptr<Drawable> &drawable,
-                                          const std::shared_ptr<Material> &material,
-                                          const std::shared_ptr<Camera> &camera) const
-{
-  PerObjectBufferData perObjectBufferData{};
-  perObjectBufferData.Model = drawable->getMatrix();
-  perObjectBufferData.ModelView = camera->getView() * perObjectBufferData.Model;
-  perObjectBufferData.ModelViewProjection = camera->getProj() * perObjectBufferData.ModelView;
-  perObjectBufferData.DiffuseColour = material->getDiffuseColour();
-  perObjectBufferData.DiffuseEnabled = material->diffuseTextureEnabled();
-  perObjectBufferData.NormalEnabled = material->normalTextureEnabled();
-  perObjectBufferData.MetalnessEnabled = material->metallicTextureEnabled();
-  perObjectBufferData.RoughnessEnabled = material->roughnessTextureEnabled();
-  perObjectBufferData.OcclusionEnabled = material->occlusionTextureEnabled();
-  perObjectBufferData.OpacityEnabled = material->opacityTextureEnabled();
-  perObjectBufferData.Metalness = material->getMetalness();
-  perObjectBufferData.Roughness = material->getRoughness();
-
-  _perObjectBuffer->writeData(0, sizeof(PerObjectBufferData), &perObjectBufferData, AccessType::WriteOnlyDiscard);
+void Renderer::createShadowAtlas(const std::shared_ptr<RenderDevice> &renderDevice)
+{
+  TextureDesc shadowAtlasDesc;
+  shadowAtlasDesc.Width = _shadowAtlasSize;
+  shadowAtlasDesc.Height = _shadowAtlasSize;
+  shadowAtlasDesc.Usage = TextureUsage::Depth;
+  shadowAtlasDesc.Type = TextureType::Texture2D;
+  shadowAtlasDesc.Format = TextureFormat::D32F;
+
+  RenderTargetDesc rtDesc;
+  rtDesc.DepthStencilTarget = renderDevice->createTexture(shadowAtlasDesc);
+  rtDesc.Height = _shadowAtlasSize;
+  rtDesc.Width = _shadowAtlasSize;
+
+  _shadowAtlasRto = renderDevice->createRenderTarget(rtDesc);
+  _shadowAtlasSizeChanged = false;
+}
+
+void Renderer::writePerObjectConstantData(const std::shared_ptr<RenderDevice> &renderDevice,
+                                          const std::vector<std::shared_ptr<Drawable>> &opaqueDrawables,
+                                          const std::vector<std::shared_ptr<Drawable>> &transparentDrawables,
+                                          const std::vector<std::shared_ptr<Drawable>> &allDrawables,
+                                          const std::vector<std::shared_ptr<Drawable>> &aabbDrawables,
+                                          const std::shared_ptr<Camera> &camera)
+{
+  // Worst case every drawable is its own batch in every cascade, every atlas tile and in its colour pass.
+  uint32 shadowPassCount = _cascadeCount + _shadowAtlas.getRenderedTileCount();
+  uint64 instanceCount = opaqueDrawables.size() + transparentDrawables.size() + allDrawables.size() * shadowPassCount;
+  uint64 requiredBytes = (instanceCount + aabbDrawables.size()) * _perObjectArena->getAlignedSize(sizeof(PerObjectBufferData));
+  if (requiredBytes > _perObjectArena->getDesc().ByteCount)
+  {
+    UploadArenaDesc perObjectArenaDesc(_perObjectArena->getDesc());
+    perObjectArenaDesc.ByteCount = std::max(requiredBytes, perObjectArenaDesc.ByteCount * 2);
+    _perObjectArena = renderDevice->createUploadArena(perObjectArenaDesc);
+  }
+
+  // Each pass's instances are written with a single aligned allocation.
+  uint64 requiredInstanceBytes = (2 + shadowPassCount) * _instanceArena->getAlignment() + instanceCount * sizeof(Matrix4);
+  if (requiredInstanceBytes > _instanceArena->getDesc().ByteCount)
+  {
+    UploadArenaDesc instanceArenaDesc(_instanceArena->getDesc());
+    instanceArenaDesc.ByteCount = std::max(requiredInstanceBytes, instanceArenaDesc.ByteCount * 2);
+    _instanceArena = renderDevice->createUploadArena(instanceArenaDesc);
+  }
+
+  // Every pass that draws an object reads the same data, so it is uploaded once here and bound by offset per draw.
+  _perObjectArena->beginFrame();
+  _instanceArena->beginFrame();
+
+  // Levels are chosen once for the camera and shared by every pass. The shadow pass biases them coarser, as shadow
+  // map texels are rarely fine enough to show the difference.
+  selectLods(allDrawables, camera);
+  _cascadeBatches.resize(_cascadeCount);
+  for (uint32 i = 0; i < _cascadeCount; i++)
+  {
+    _cascadeBatches[i].clear();
+    if (!_shadowCascades.isRendered(i))
+    {
+      continue;
+    }
+
+    _casterScratch.clear();
+    for (uint32 caster : _shadowCascades.getCasters(i))
+    {
+      _casterScratch.push_back(allDrawables[caster]);
+    }
+    // The cascade's transform takes world space straight to its layer.
+    writeDrawBatches(_casterScratch, false, SHADOW_PIPELINE_KEY, _shadowLodBias, camera, Matrix4::Identity, _shadowCascades.getTransform(i), _cascadeBatches[i]);
+  }
+
+  // Each atlas tile drawn this frame gets the casters within its own frustrum.
+  const std::vector<ShadowAtlasAllocation> &allocations = _shadowAtlas.getAllocations();
+  _localShadowBatches.resize(_shadowAtlas.getRenderedTileCount());
+  uint32 tileIndex = 0;
+  for (uint32 i = 0; i < allocations.size(); i++)
+  {
+    if (!allocations[i].Rendered)
+    {
+      continue;
+    }
+
+    for (uint32 tile = 0; tile < _shadowAtlasRequests[i].TileCount; tile++)
+    {
+      _casterIndexScratch.clear();
+      calculateFrustrum(allocations[i].Transforms[tile]).cull(_casterBounds, _casterIndexScratch);
+      _casterScratch.clear();
+      for (uint32 caster : _casterIndexScratch)
+      {
+        _casterScratch.push_back(allDrawables[caster]);
+      }
+      writeDrawBatches(_casterScratch, false, SHADOW_PIPELINE_KEY, _shadowLodBias, camera, Matrix4::Identity, allocations[i].Transforms[tile], _localShadowBatches[tileIndex++]);
+      _stateStats.LocalShadowCasters += static_cast<uint32>(_casterScratch.size());
+    }
+  }
+  _stateStats.LocalShadowTiles = tileIndex;
+  writeDrawBatches(opaqueDrawables, false, GBUFFER_PIPELINE_KEY, 0, camera, camera->getView(), camera->getProj(), _opaqueBatches);
+  // Transparent drawables are sorted back to front, so only neighbours may be merged.
+  writeDrawBatches(transparentDrawables, true, TRANSPARENCY_PIPELINE_KEY, 0, camera, camera->getView(), camera->getProj(), _transparentBatches);
+
+  _aabbObjectOffsets.clear();
+  for (const auto &drawable : aabbDrawables)
+  {
+    auto &aabb = drawable->getAabb();
+
+    PerObjectBufferData objectBufferData{};
+    objectBufferData.Model = Matrix4::Translation(drawable->getPosition()) * Matrix4::Scaling(aabb.getExtents());
+    objectBufferData.ModelView = camera->getView() * objectBufferData.Model;
+    objectBufferData.ModelViewProjection = camera->getProj() * objectBufferData.ModelView;
+    _aabbObjectOffsets.push_back(_perObjectArena->write(&objectBufferData, sizeof(PerObjectBufferData)));
+  }
+
+  _perObjectArena->flush();
+  _instanceArena->flush();
+}
+
+void Renderer::selectLods(const std::vector<std::shared_ptr<Drawable>> &drawables, const std::shared_ptr<Camera> &camera) const
+{
+  for (const auto &drawable : drawables)
+  {
+    const std::vector<MeshLod> &lods = drawable->getMesh()->getLods();
+    if (!_lodEnabled || lods.size() <= 1)
+    {
+      drawable->setLod(0);
+      continue;
+    }
+
+    // Levels store their error relative to the mesh's radius, which the drawable's bounds scale into the world.
+    Aabb bounds = drawable->getWorldAabb();
+    float32 radius = bounds.getRadius();
+    float32 distance = std::max(camera->distanceFrom(bounds.getCenter()) - radius, 0.0f);
+    float32 radiusPixels = LodSelector::getProjectedSize(radius, distance, camera->getFov(), camera->getHeight());
+    drawable->setLod(LodSelector::selectLod(lods, drawable->getLod(), radiusPixels, _lodErrorThreshold, _lodHysteresis));
+  }
+}
+
+void Renderer::writeDrawBatches(const std::vector<std::shared_ptr<Drawable>> &drawables,
+                                bool preserveOrder,
+                                uint32 pipelineKey,
+                                uint32 lodBias,
+                                const std::shared_ptr<Camera> &camera,
+                                const Matrix4 &view,
+                                const Matrix4 &projection,
+                                std::vector<DrawBatch> &batches)
+{
+  batches.clear();
+  if (drawables.empty())
+  {
+    return;
+  }
+
+  _renderQueue.clear();
+  if (!preserveOrder)
+  {
+    _renderQueue.reserve(static_cast<uint32>(drawables.size()));
+    float32 farClip = camera->getFar();
+    for (uint32 i = 0; i < drawables.size(); i++)
+    {
+      const auto &drawable = drawables[i];
+      float32 depth = camera->distanceFrom(drawable->getPosition()) / farClip;
+      const std::shared_ptr<StaticMesh> &mesh = drawable->getMesh();
+      uint32 pipeline = pipelineKey * static_cast<uint32>(VertexFormat::Count) + static_cast<uint32>(mesh->getVertexFormat());
+      uint32 lod = std::min(drawable->getLod() + lodBias, mesh->getLodCount() - 1);
+      uint64 key = _stateSortingEnabled ? RenderQueue::makeKey(pipeline, drawable->getMaterial()->getId(), mesh->getId() * MAX_MESH_LODS + lod, depth)
+                                        : RenderQueue::makeDepthKey(depth);
+      _renderQueue.push(key, i);
+    }
+    _renderQueue.sort();
+  }
+  const std::vector<RenderQueueEntry> &queueEntries = _renderQueue.getEntries();
+
+  // With state sorting every draw sharing a mesh and material is adjacent. Otherwise batches keep the order in which
+  // their first drawable appears so front to back sorting is mostly preserved.
+  bool mergeNeighboursOnly = preserveOrder || _stateSortingEnabled;
+  std::map<std::tuple<const StaticMesh *, const Material *, uint32>, uint32> batchLookup;
+  _batchIndexScratch.resize(drawables.size());
+  for (uint32 i = 0; i < drawables.size(); i++)
+  {
+    const auto &drawable = drawables[preserveOrder ? i : queueEntries[i].Index];
+    std::shared_ptr<StaticMesh> mesh = drawable->getMesh();
+    std::shared_ptr<Material> material = drawable->getMaterial();
+    uint32 lod = std::min(drawable->getLod() + lodBias, mesh->getLodCount() - 1);
+
+    uint32 batchIndex = static_cast<uint32>(batches.size());
+    if (mergeNeighboursOnly)
+    {
+      if (!batches.empty() && batches.back().MeshPtr == mesh && batches.back().MaterialPtr == material && batches.back().Lod == lod)
+      {
+        batchIndex = batchIndex - 1;
+      }
+    }
+    else
+    {
+      auto result = batchLookup.insert({{mesh.get(), material.get(), lod}, batchIndex});
+      batchIndex = result.first->second;
+    }
+
+    if (batchIndex == batches.size())
+    {
+      batches.push_back({mesh, material, 0, 0, 0, lod});
+    }
+    batches[batchIndex].InstanceCount++;
+    _batchIndexScratch[i] = batchIndex;
+  }
+
+  std::array<uint32, MAX_MESH_LODS> &lodTriangles = pipelineKey == SHADOW_PIPELINE_KEY ? _stateStats.ShadowLodTriangles : _stateStats.LodTriangles;
+  uint32 firstInstance = 0;
+  for (auto &batch : batches)
+  {
+    const std::shared_ptr<StaticMesh> &mesh = batch.MeshPtr;
+    uint32 triangleCount = (mesh->isIndexed() ? mesh->getLod(batch.Lod).IndexCount : mesh->getVertexCount()) / 3;
+    lodTriangles[batch.Lod] += triangleCount * batch.InstanceCount;
+
+    batch.InstanceOffset = firstInstance;
+    firstInstance += batch.InstanceCount;
+    batch.InstanceCount = 0;
+  }
+
+  _instanceScratch.resize(drawables.size());
+  for (uint32 i = 0; i < drawables.size(); i++)
+  {
+    DrawBatch &batch = batches[_batchIndexScratch[i]];
+    _instanceScratch[batch.InstanceOffset + batch.InstanceCount++] = drawables[preserveOrder ? i : queueEntries[i].Index]->getMatrix();
+  }
+
+  uint64 instanceBufferOffset = _instanceArena->write(_instanceScratch.data(), drawables.size() * sizeof(Matrix4));
+  for (auto &batch : batches)
+  {
+    const std::shared_ptr<Material> &material = batch.MaterialPtr;
+
+    // The model matrix comes from the instance buffer, so the object matrices only carry the view transforms.
+    PerObjectBufferData perObjectBufferData{};
+    perObjectBufferData.Model = Matrix4::Identity;
+    perObjectBufferData.ModelView = view;
+    perObjectBufferData.ModelViewProjection = projection * view;
+    perObjectBufferData.DiffuseColour = material->getDiffuseColour();
+    perObjectBufferData.DiffuseEnabled = material->diffuseTextureEnabled();
+    perObjectBufferData.NormalEnabled = material->normalTextureEnabled();
+    perObjectBufferData.MetalnessEnabled = material->metallicTextureEnabled();
+    perObjectBufferData.RoughnessEnabled = material->roughnessTextureEnabled();
+    perObjectBufferData.OcclusionEnabled = material->occlusionTextureEnabled();
+    perObjectBufferData.OpacityEnabled = material->opacityTextureEnabled();
+    perObjectBufferData.Metalness = material->getMetalness();
+    perObjectBufferData.Roughness = material->getRoughness();
+
+    VertexFormat vertexFormat = batch.MeshPtr->getVertexFormat();
+    Vector3 positionScale, positionOffset;
+    VertexCompression::getPositionTransform(vertexFormat, batch.MeshPtr->getAabb(), positionScale, positionOffset);
+    perObjectBufferData.PositionScale = Vector4(positionScale);
+    perObjectBufferData.PositionOffset = Vector4(positionOffset);
+    perObjectBufferData.CompactVertices = vertexFormat != VertexFormat::Full;
+
+    batch.ConstantsOffset = _perObjectArena->write(&perObjectBufferData, sizeof(PerObjectBufferData));
+    batch.InstanceOffset = instanceBufferOffset + batch.InstanceOffset * sizeof(Matrix4);
+  }
 }
 
 void Renderer::writePerFrameConstantData(const std::shared_ptr<Camera> &camera,
                                          const std::shared_ptr<Light> &directionalLight,
                                          const std::vector<std::shared_ptr<Light>> &lights) const
 {
-  // Creating this on the heap as I was exceeding stack size.
-  PerFrameBufferData *perFrameBufferData = new PerFrameBufferData();
-  perFrameBufferData->AmbientColour = _ambientColour.ToVec3();
-  perFrameBufferData->AmbientIntensity = _ambientIntensity;
-  perFrameBufferData->CascadeLayerCount = _cascadeCount;
+  PerFrameBufferData perFrameBufferData;
+  perFrameBufferData.AmbientColour = _ambientColour.ToVec3();
+  perFrameBufferData.AmbientIntensity = _ambientIntensity;
+  perFrameBufferData.CascadeLayerCount = _cascadeCount;
 
-  std::vector<Matrix4> cascadeLightTransforms(calculateCascadeLightTransforms(camera, directionalLight));
   std::vector<float32> cascadeLevels(calculateCascadeLevels(camera->getNear(), camera->getFar()));
   for (uint32 i = 0; i < _cascadeCount; i++)
   {
-    perFrameBufferData->CascadeLightTransforms[i] = cascadeLightTransforms[i];
-    perFrameBufferData->CascadePlaneDistances[i].X = cascadeLevels[i];
-  }
-  perFrameBufferData->DrawCascadeLayers = _drawCascadeLayers;
-  perFrameBufferData->FarPlane = camera->getFar();
-  perFrameBufferData->LightColour = directionalLight->getColour().ToVec3();
-  perFrameBufferData->LightDirection = directionalLight->getDirection();
-  perFrameBufferData->LightIntensity = directionalLight->getIntensity();
-  perFrameBufferData->ShadowSampleCount = _shadowSampleCount;
-  perFrameBufferData->ShadowSampleSpread = _shadowSampleSpread;
-  perFrameBufferData->SsaoEnabled = _ssaoEnabled;
-  perFrameBufferData->View = camera->getView();
-  perFrameBufferData->Proj = camera->getProj();
-  perFrameBufferData->ProjInv = perFrameBufferData->Proj.Inverse();
-  perFrameBufferData->ProjViewInv = (perFrameBufferData->Proj * perFrameBufferData->View).Inverse();
-  perFrameBufferData->ViewPosition = camera->getParentTransform().getPosition();  perFrameBufferData->Exposure = _exposure;
-  perFrameBufferData->ToneMappingEnabled = _toneMappingEnabled;
-  perFrameBufferData->BloomStrength = _bloomStrength;
-  perFrameBufferData->BloomThreshold = _bloomThreshold;
-
-  std::vector<LightData> lightDataArray;
-  for (uint32 i = 0; i < lights.size(); i++)
-  {
-    const auto &light = lights[i];
+    // Cached layers are looked up with the transform they were drawn with rather than this frame's fit.
+    perFrameBufferData.CascadeLightTransforms[i] = _shadowCascades.getTransform(i);
+    perFrameBufferData.CascadePlaneDistances[i].X = cascadeLevels[i];
+  }
+  perFrameBufferData.DrawCascadeLayers = _drawCascadeLayers;
+  perFrameBufferData.FarPlane = camera->getFar();
+  perFrameBufferData.LightColour = directionalLight->getColour().ToVec3();
+  perFrameBufferData.LightDirection = directionalLight->getDirection();
+  perFrameBufferData.LightIntensity = directionalLight->getIntensity();
+  perFrameBufferData.ShadowSampleCount = _shadowSampleCount;
+  perFrameBufferData.ShadowSampleSpread = _shadowSampleSpread;
+  perFrameBufferData.SsaoEnabled = _ssaoEnabled;
+  perFrameBufferData.View = camera->getView();
+  perFrameBufferData.Proj = camera->getProj();
+  perFrameBufferData.ProjInv = perFrameBufferData.Proj.Inverse();
+  perFrameBufferData.ProjViewInv = (perFrameBufferData.Proj * perFrameBufferData.View).Inverse();
+  perFrameBufferData.ViewPosition = camera->getParentTransform().getPosition();
+  perFrameBufferData.Exposure = _exposure;
+  perFrameBufferData.ToneMappingEnabled = _toneMappingEnabled;
+  perFrameBufferData.BloomStrength = _bloomStrength;
+  perFrameBufferData.BloomThreshold = _bloomThreshold;
+
+  uint32 lightCount = std::count_if(lights.begin(), lights.end(), [](const std::shared_ptr<Light> &light)
+                                    { return light->getLightType() != LightType::Directional; });
+  perFrameBufferData.LightCount = std::min(lightCount, MAX_LIGHTS);
+  Vector2 sliceScaleBias = LightClusters::getSliceScaleBias(camera->getNear(), camera->getFar());
+  perFrameBufferData.ClusterSliceScale = sliceScaleBias.X;
+  perFrameBufferData.ClusterSliceBias = sliceScaleBias.Y;
+
+  _perFrameBuffer->writeData(0, sizeof(PerFrameBufferData), &perFrameBufferData, AccessType::WriteOnlyDiscard);
+}
+
+void Renderer::writeLightClusterData(const std::shared_ptr<RenderDevice> &renderDevice,
+                                     const std::shared_ptr<Camera> &camera,
+                                     const std::vector<std::shared_ptr<Light>> &lights,
+                                     JobSystem *jobs)
+{
+  Matrix4 view = camera->getView();
+  _lightDataScratch.clear();
+  _clusterLightScratch.clear();
+  _shadowTileDataScratch.clear();
+  const std::vector<ShadowAtlasAllocation> &allocations = _shadowAtlas.getAllocations();
+  float32 atlasSize = static_cast<float32>(_shadowAtlas.getSize());
+  uint32 requestIndex = 0;
+  for (const auto &light : lights)
+  {
     // TODO: Need to improve this as we only support one direction light.
-    if (light->getLightType() != LightType::Directional)
+    if (light->getLightType() == LightType::Directional || _clusterLightScratch.size() == MAX_LIGHTS)
+    {
+      continue;
+    }
+
+    // Requests were made in the order of the lights, so the next one is this light's when it made one. Its tiles are
+    // only looked up once they hold a rendering.
+    int32 firstShadowTile = -1;
+    uint32 shadowTileCount = 0;
+    if (requestIndex < _shadowAtlasLights.size() && _shadowAtlasLights[requestIndex] == light)
     {
-      LightData lightData;
-      lightData.Colour = light->getColour().ToVec3();
-      lightData.Intensity = light->getIntensity();
-      lightData.Position = light->getPosition();
-      lightData.Radius = light->getRadius();
-      lightDataArray.push_back(lightData);
+      const ShadowAtlasAllocation &allocation = allocations[requestIndex];
+      if (allocation.Valid)
+      {
+        firstShadowTile = static_cast<int32>(_shadowTileDataScratch.size() / SHADOW_TILE_TEXELS);
+        shadowTileCount = _shadowAtlasRequests[requestIndex].TileCount;
+        float32 tileScale = allocation.TileSize / atlasSize;
+        for (uint32 tile = 0; tile < shadowTileCount; tile++)
+        {
+          const Matrix4 &transform = allocation.Transforms[tile];
+          for (uint32 column = 0; column < 4; column++)
+          {
+            _shadowTileDataScratch.push_back(transform[column]);
+          }
+          _shadowTileDataScratch.push_back(Vector4(allocation.Tiles[tile].X / atlasSize, allocation.Tiles[tile].Y / atlasSize, tileScale, tileScale));
+          // Both the width of a texel at unit distance from the light, and the texel itself.
+          float32 tanHalfFov = 1.0f / transform[1][1];
+          _shadowTileDataScratch.push_back(Vector4(2.0f * tanHalfFov / allocation.TileSize, 1.0f / atlasSize, 0.0f, 0.0f));
+        }
+      }
+      requestIndex++;
     }
+
+    // Point lights are given a cone wider than any direction so that every direction is fully lit.
+    bool spot = light->getLightType() == LightType::Spot;
+    float32 cosOuter = spot ? std::cos(Radian(light->getSpotOuterAngle()).InRadians()) : -2.0f;
+    // The inner cone is kept narrower than the outer so the shader's smoothstep between them is well defined.
+    float32 cosInner = spot ? std::max(std::cos(Radian(light->getSpotInnerAngle()).InRadians()), cosOuter + 1e-4f) : -1.0f;
+    _lightDataScratch.push_back(Vector4(light->getColour().ToVec3(), light->getIntensity()));
+    _lightDataScratch.push_back(Vector4(light->getPosition(), light->getRadius()));
+    _lightDataScratch.push_back(Vector4(light->getDirection(), cosOuter));
+    _lightDataScratch.push_back(Vector4(cosInner, static_cast<float32>(firstShadowTile), static_cast<float32>(shadowTileCount), 0.0f));
+
+    Vector4 viewPosition = view * Vector4(light->getPosition(), 1.0f);
+    _clusterLightScratch.push_back({Vector3(viewPosition.X, viewPosition.Y, viewPosition.Z), light->getRadius()});
   }
-  std::copy(lightDataArray.begin(), lightDataArray.end(), perFrameBufferData->Lights);
-  perFrameBufferData->LightCount = lightDataArray.size();
+  _lightClusters.build(_clusterLightScratch, camera->getFov(), camera->getAspectRatio(), camera->getNear(), camera->getFar(), jobs);
+
+  _clusterMap->writeData(0, 0, 0, LightClusters::TILES_X, 0, LightClusters::TILES_Y, 0, LightClusters::SLICES,
+                         const_cast<uint32 *>(_lightClusters.getClusters().data()));
 
-  _perFrameBuffer->writeData(0, sizeof(PerFrameBufferData), perFrameBufferData, AccessType::WriteOnlyDiscard);
-  delete perFrameBufferData;
+  // Only the rows in use are uploaded, the rest keep whatever an earlier frame left there.
+  uint32 lightRows = reserveLightTexture(renderDevice, _lightMap, TextureFormat::RGBA32F, _lightDataScratch.size());
+  if (lightRows > 0)
+  {
+    _lightDataScratch.resize(lightRows * LIGHT_TEXTURE_WIDTH);
+    _lightMap->writeData(0, 0, 0, LIGHT_TEXTURE_WIDTH, 0, lightRows, 0, 0, _lightDataScratch.data());
+  }
+
+  uint32 shadowTileRows = reserveLightTexture(renderDevice, _shadowTileMap, TextureFormat::RGBA32F, _shadowTileDataScratch.size());
+  if (shadowTileRows > 0)
+  {
+    _shadowTileDataScratch.resize(shadowTileRows * LIGHT_TEXTURE_WIDTH);
+    _shadowTileMap->writeData(0, 0, 0, LIGHT_TEXTURE_WIDTH, 0, shadowTileRows, 0, 0, _shadowTileDataScratch.data());
+  }
+
+  _lightIndexScratch.assign(_lightClusters.getLightIndices().begin(), _lightClusters.getLightIndices().end());
+  uint32 indexRows = reserveLightTexture(renderDevice, _lightIndexMap, TextureFormat::R32UI, _lightIndexScratch.size());
+  if (indexRows > 0)
+  {
+    _lightIndexScratch.resize(indexRows * LIGHT_TEXTURE_WIDTH);
+    _lightIndexMap->writeData(0, 0, 0, LIGHT_TEXTURE_WIDTH, 0, indexRows, 0, 0, _lightIndexScratch.data());
+  }
+}
+
+uint32 Renderer::reserveLightTexture(const std::shared_ptr<RenderDevice> &renderDevice,
+                                   std::shared_ptr<Texture> &texture,
+                                   TextureFormat format,
+                                   uint64 texelCount)
+{
+  uint32 rows = static_cast<uint32>((texelCount + LIGHT_TEXTURE_WIDTH - 1) / LIGHT_TEXTURE_WIDTH);
+  if (!texture || texture->getHeight() < rows)
+  {
+    // Doubling keeps reallocations rare as the scene's lights grow.
+    uint32 height = texture ? texture->getHeight() : 1;
+    while (height < rows)
+    {
+      height *= 2;
+    }
+
+    TextureDesc textureDesc;
+    textureDesc.Width = LIGHT_TEXTURE_WIDTH;
+    textureDesc.Height = height;
+    textureDesc.Usage = TextureUsage::Default;
+    textureDesc.Type = TextureType::Texture2D;
+    textureDesc.Format = format;
+    texture = renderDevice->createTexture(textureDesc);
+  }
+  return rows;
+}
+
+const HiZBuffer *Renderer::updateOcclusionDepth()
+{
+  if (!_occlusionCullingEnabled || !_hiZReadback)
+  {
+    return nullptr;
+  }
+
+  _hiZReadback->resolve();
+  if (_hiZReadback->hasResult() && (!_hiZBufferValid || _hiZReadback->getResultId() != _hiZBufferId))
+  {
+    for (const auto &view : _hiZReadbackViews)
+    {
+      if (view.Id == _hiZReadback->getResultId())
+      {
+        const auto *depths = reinterpret_cast<const float32 *>(_hiZReadback->getData().data());
+        _hiZBuffer.setDepth(depths, _hiZReadback->getResultWidth(), _hiZReadback->getResultHeight(), view.ViewProjection);
+        _hiZBufferId = view.Id;
+        _hiZBufferValid = true;
+        break;
+      }
+    }
+  }
+  return _hiZBufferValid ? &_hiZBuffer : nullptr;
+}
+
+void Renderer::updateRenderPassTimings()
+{
+  float32 cpuFrameMs = 0.0f;
+  float32 gpuFrameMs = 0.0f;
+  uint64 gpuFrameResultCount = std::numeric_limits<uint64>::max();
+  for (uint32 i = 0; i < _renderPassTimings.size(); i++)
+  {
+    RenderPassTimings &timings = _renderPassTimings[i];
+    float32 cpuMs = timings.Duration * 1e-6f;
+    timings.CpuHistory.push(cpuMs);
+    cpuFrameMs += cpuMs;
+
+    // GPU results arrive a few frames late and not necessarily every frame, so only new ones are sampled.
+    const std::shared_ptr<TimerQuery> &timer = _renderPassTimers[i];
+    uint64 resultCount = timer->getResultCount();
+    if (resultCount != timings.GpuResultCount)
+    {
+      timings.GpuResultCount = resultCount;
+      timings.GpuDuration = timer->getLastDuration();
+      timings.GpuHistory.push(timings.GpuDuration * 1e-6f);
+    }
+    gpuFrameMs += timings.GpuDuration * 1e-6f;
+    gpuFrameResultCount = std::min(gpuFrameResultCount, resultCount);
+  }
+
+  _cpuFrameHistory.push(cpuFrameMs);
+
+  // The frame's GPU time is taken once every pass has a result newer than the last one it was taken from.
+  _hasGpuTimings = gpuFrameResultCount > 0;
+  if (_hasGpuTimings && gpuFrameResultCount != _gpuFrameResultCount)
+  {
+    _gpuFrameResultCount = gpuFrameResultCount;
+    _gpuFrameHistory.push(gpuFrameMs);
+  }
 }
 
 void Renderer::writeSsaoConstantData(const std::shared_ptr<RenderDevice> &renderDevice,
                                      const std::shared_ptr<Camera> &camera) const
 {
+  SsaoConstantsData ssaoConstantsData{};
+  ssaoConstantsData.Bias = _ssaoBias;
+  ssaoConstantsData.Radius = _ssaoRadius;
+  ssaoConstantsData.Intensity = _ssaoIntensity;
+
+  if (_ssaoHalfResolution)
+  {
+    // Few samples are taken each frame, so they are spread evenly rather than randomly: cosine weighted directions
+    // about the normal on a golden angle spiral, with lengths from a van der Corput sequence. The shader rotates
+    // them and offsets the lengths per pixel and per frame.
+    const float32 goldenAngle = Math::Pi * (3.0f - std::sqrt(5.0f));
+    ssaoConstantsData.KernelSize = _ssaoHalfResolutionSamples;
+    for (uint32 i = 0; i < _ssaoHalfResolutionSamples; ++i)
+    {
+      float32 radius = std::sqrt((i + 0.5f) / _ssaoHalfResolutionSamples);
+      float32 angle = i * goldenAngle;
+      float32 length = 0.0f;
+      float32 digit = 0.5f;
+      for (uint32 bits = i + 1; bits > 0; bits >>= 1, digit *= 0.5f)
+      {
+        length += (bits & 1) * digit;
+      }
+      ssaoConstantsData.NoiseSamples[i] = Vector4(radius * std::cos(angle),
+                                                  radius * std::sin(angle),
+                                                  std::sqrt(std::max(1.0f - radius * radius, 0.0f)),
+                                                  length);
+    }
+    _ssaoConstantsBuffer->writeData(0, sizeof(SsaoConstantsData), &ssaoConstantsData, AccessType::WriteOnlyDiscard);
+    return;
+  }
+
   // reset RNG to ensure identical sample kernel each update
   g_ssaoGenerator.seed(0);
   std::uniform_real_distribution<float32> randomFloats(0.0f, 1.0f);
@@ -1906,12 +3107,8 @@ void Renderer::writeSsaoConstantData(const std::shared_ptr<RenderDevice> &render
     ssaoKernel.push_back(sample);
   }
 
-  // initialize struct and set only the used samples
-  SsaoConstantsData ssaoConstantsData{};
-  ssaoConstantsData.Bias = _ssaoBias;
-  ssaoConstantsData.Radius = _ssaoRadius;
+  // set only the used samples
   ssaoConstantsData.KernelSize = _ssaoSamples;
-  ssaoConstantsData.Intensity = _ssaoIntensity;
   for (uint32 i = 0; i < _ssaoSamples; ++i)
   {
     ssaoConstantsData.NoiseSamples[i] = ssaoKernel[i];
@@ -1,26 +1,68 @@
 #pragma once
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "../Core/Maths.h"
 #include "../Core/Types.hpp"
+#include "../Geometry/MeshSimplifier.hpp"
+#include "../Maths/AabbArray.hpp"
+#include "../RenderApi/Texture.hpp"
+#include "../Utility/TimingHistory.hpp"
+#include "HiZBuffer.h"
+#include "LightClusters.h"
+#include "RenderQueue.h"
+#include "ShadowAtlas.h"
+#include "ShadowCascades.h"
+#include "VertexCompression.h"
 
 class Drawable;
 class GpuBuffer;
+class JobSystem;
 class Light;
 class Material;
 class PipelineState;
 class RenderDevice;
 class RenderTarget;
 class SamplerState;
-class Texture;
+class StaticMesh;
+class TextureReadback;
+class TimerQuery;
+class UploadArena;
 class VertexBuffer;
 
 struct RenderPassTimings
 {
-  uint64 Duration;
+  RenderPassTimings(const std::string &name) : Name(name) {}
+
+  /// @brief CPU time in nanoseconds spent submitting the pass.
+  uint64 Duration = 0;
+  /// @brief GPU time in nanoseconds spent executing the pass. Lags the CPU time by a few frames.
+  uint64 GpuDuration = 0;
+  /// @brief Results of the pass's timer already taken into GpuHistory.
+  uint64 GpuResultCount = 0;
   std::string Name;
+  TimingHistory CpuHistory;
+  TimingHistory GpuHistory;
+};
+
+/// @brief State changes made while drawing the scene's geometry during the last frame.
+struct RenderStateStats
+{
+  uint32 DrawCalls = 0;
+  uint32 MaterialChanges = 0;
+  uint32 MeshChanges = 0;
+  uint32 TextureBinds = 0;
+  /// @brief Texture and sampler binds dropped because the slot already held the same object.
+  uint32 RedundantBindsSkipped = 0;
+  uint32 SamplerBinds = 0;
+  /// @brief Triangles submitted at each level of detail by the camera's passes and by the shadow pass.
+  std::array<uint32, MAX_MESH_LODS> LodTriangles{};
+  std::array<uint32, MAX_MESH_LODS> ShadowLodTriangles{};
+  /// @brief Tiles of the local light shadow atlas drawn, and the casters drawn into them, during the last frame.
+  uint32 LocalShadowTiles = 0;
+  uint32 LocalShadowCasters = 0;
 };
 
 enum class DebugDisplayType
@@ -50,12 +92,42 @@ public:
                  const std::vector<std::shared_ptr<Drawable>> &transparentDrawables,
                  const std::vector<std::shared_ptr<Drawable>> &allDrawables,
                  const std::vector<std::shared_ptr<Light>> &lights,
-                 const std::shared_ptr<Camera> &camera);
+                 const std::shared_ptr<Camera> &camera,
+                 JobSystem *jobs = nullptr);
 
   const std::vector<RenderPassTimings> &getRenderPassTimings() const { return _renderPassTimings; }
+  const TimingHistory &getCpuFrameHistory() const { return _cpuFrameHistory; }
+  const TimingHistory &getGpuFrameHistory() const { return _gpuFrameHistory; }
+  bool hasGpuTimings() const { return _hasGpuTimings; }
+  const RenderStateStats &getStateStats() const { return _stateStats; }
+
+  /// @brief When disabled opaque and shadow draws are submitted purely front to back, as they were before draws
+  /// were sorted by state. Kept so that the state change counts of both orders can be compared.
+  void setStateSortingEnabled(bool enabled) { _stateSortingEnabled = enabled; }
+  bool isStateSortingEnabled() const { return _stateSortingEnabled; }
+
+  /// @brief Collects the depth of the latest frame to have come back from the GPU, reduced to a depth pyramid, for
+  /// culling the next frame's drawables against.
+  /// @return Null while occlusion culling is disabled or until the first frame's depth has come back.
+  const HiZBuffer *updateOcclusionDepth();
 
 private:
+  /// @brief Drawables sharing a mesh and material, drawn with a single instanced draw.
+  struct DrawBatch
+  {
+    std::shared_ptr<StaticMesh> MeshPtr;
+    std::shared_ptr<Material> MaterialPtr;
+    uint64 ConstantsOffset;
+    uint64 InstanceOffset;
+    uint32 InstanceCount;
+    uint32 Lod;
+  };
+
+  /// @brief One pipeline per vertex format for passes that draw meshes, as the vertex layout is part of the pipeline.
+  typedef std::array<std::shared_ptr<PipelineState>, static_cast<uint32>(VertexFormat::Count)> MeshPipelineStates;
+
   void initConstantBuffers(const std::shared_ptr<RenderDevice> &renderDevice);
+  void initTimerQueries(const std::shared_ptr<RenderDevice> &renderDevice);
   void initSamplers(const std::shared_ptr<RenderDevice> &renderDevice);
   void initTextures(const std::shared_ptr<RenderDevice> &renderDevice);
 
@@ -63,26 +135,30 @@ private:
   void initGbufferPass(const std::shared_ptr<RenderDevice> &renderDevice);
   void initTransparencyPass(const std::shared_ptr<RenderDevice> &renderDevice);
   void initShadowPass(const std::shared_ptr<RenderDevice> &renderDevice);
+  void initLocalLightShadowPass(const std::shared_ptr<RenderDevice> &renderDevice);
   void initSsaoPass(const std::shared_ptr<RenderDevice> &renderDevice);
   void initLightingPass(const std::shared_ptr<RenderDevice> &renderDevice);
   void initBloomDownSamplePass(const std::shared_ptr<RenderDevice> &renderDevice);
   void initBloomUpSamplePass(const std::shared_ptr<RenderDevice> &renderDevice);
   void initToneMappingPass(const std::shared_ptr<RenderDevice> &renderDevice);
   void initDebugPass(const std::shared_ptr<RenderDevice> &renderDevice);
+  void initHiZPass(const std::shared_ptr<RenderDevice> &renderDevice);
 
   void directionalLightDepthPass(const std::shared_ptr<RenderDevice> &renderDevice,
-                                 const std::vector<std::shared_ptr<Drawable>> &drawables,
                                  const std::shared_ptr<Light> &directionalLight,
                                  const std::shared_ptr<Camera> &camera);
   void gbufferPass(std::shared_ptr<RenderDevice> renderDevice,
-                   const std::vector<std::shared_ptr<Drawable>> &drawables,
                    const std::shared_ptr<Camera> &camera);
   void transparencyPass(const std::shared_ptr<RenderDevice> &renderDevice,
-                        const std::vector<std::shared_ptr<Drawable>> &transparentDrawables,
                         const std::shared_ptr<Camera> &camera);
+  void hiZPass(const std::shared_ptr<RenderDevice> &renderDevice,
+               const std::shared_ptr<Camera> &camera);
   void shadowPass(const std::shared_ptr<RenderDevice> &renderDevice);
+  void localLightShadowPass(const std::shared_ptr<RenderDevice> &renderDevice);
   void ssaoPass(const std::shared_ptr<RenderDevice> &renderDevice,
                 const std::shared_ptr<Camera> &camera);
+  void halfResolutionSsaoPass(const std::shared_ptr<RenderDevice> &renderDevice,
+                              const std::shared_ptr<Camera> &camera);
   void lightingPass(const std::shared_ptr<RenderDevice> &renderDevice,
                     const std::vector<std::shared_ptr<Light>> &lights,
                     const std::shared_ptr<Camera> &camera);
@@ -92,10 +168,19 @@ private:
                  const std::vector<std::shared_ptr<Drawable>> &aabbDrawables,
                  const std::shared_ptr<Camera> &camera);
 
-  void drawDrawable(const std::shared_ptr<RenderDevice> &renderDevice,
-                    const std::shared_ptr<Drawable> &drawable,
-                    const std::shared_ptr<Material> &material,
-                    const std::shared_ptr<Camera> &camera);
+  void drawBatch(const std::shared_ptr<RenderDevice> &renderDevice,
+                 const DrawBatch &batch,
+                 const MeshPipelineStates &pipelineStates);
+  void bindMaterialTextures(const std::shared_ptr<RenderDevice> &renderDevice,
+                            const std::shared_ptr<Material> &material,
+                            bool opacityEnabled);
+  void bindTexture(const std::shared_ptr<RenderDevice> &renderDevice,
+                   uint32 slot,
+                   const std::shared_ptr<Texture> &texture,
+                   const std::shared_ptr<SamplerState> &samplerState);
+  /// @brief Forgets the mesh and material textures bound by earlier draws. Called at the start of every pass which
+  /// draws batches, as the passes in between bind their own textures directly.
+  void resetBoundDrawState();
 
   void drawAabb(const std::shared_ptr<RenderDevice> &renderDevice,
                 const std::vector<std::shared_ptr<Drawable>> &aabbDrawables,
@@ -109,16 +194,57 @@ private:
 
   std::vector<Matrix4> calculateCameraCascadeProjections(const std::shared_ptr<Camera> &camera) const;
   std::vector<float32> calculateCascadeLevels(float32 nearClip, float32 farClip) const;
-  std::vector<Matrix4> calculateCascadeLightTransforms(const std::shared_ptr<Camera> &camera, const std::shared_ptr<Light> &directionalLight) const;
+  std::vector<CascadeBounds> calculateCascadeBounds(const std::shared_ptr<Camera> &camera) const;
+  /// @brief Fits the cascades around the camera's frustum and culls the shadow casters of those drawn this frame.
+  void updateShadowCascades(const std::shared_ptr<Camera> &camera,
+                            const std::shared_ptr<Light> &directionalLight,
+                            const std::vector<std::shared_ptr<Drawable>> &allDrawables,
+                            JobSystem *jobs);
+
+  /// @brief Asks the atlas for space for every point and spot light casting shadows, sized by how much of the screen
+  /// it covers, and signed by the light and the casters within its radius so that unchanged tiles are kept.
+  void updateShadowAtlas(const std::shared_ptr<Camera> &camera,
+                         const std::vector<std::shared_ptr<Light>> &lights,
+                         const std::vector<std::shared_ptr<Drawable>> &allDrawables);
 
   void createDirectionalLightShadowDepthMap(const std::shared_ptr<RenderDevice> &renderDevice);
+  void createShadowAtlas(const std::shared_ptr<RenderDevice> &renderDevice);
 
-  void writePerObjectConstantData(const std::shared_ptr<Drawable> &drawable,
-                                  const std::shared_ptr<Material> &material,
-                                  const std::shared_ptr<Camera> &camera) const;
+  void writePerObjectConstantData(const std::shared_ptr<RenderDevice> &renderDevice,
+                                  const std::vector<std::shared_ptr<Drawable>> &opaqueDrawables,
+                                  const std::vector<std::shared_ptr<Drawable>> &transparentDrawables,
+                                  const std::vector<std::shared_ptr<Drawable>> &allDrawables,
+                                  const std::vector<std::shared_ptr<Drawable>> &aabbDrawables,
+                                  const std::shared_ptr<Camera> &camera);
+  /// @brief Moves each drawable to the level of detail whose error covers the fewest pixels over the threshold.
+  void selectLods(const std::vector<std::shared_ptr<Drawable>> &drawables, const std::shared_ptr<Camera> &camera) const;
+  /// @param lodBias Added to each drawable's selected level of detail, clamped to its mesh's coarsest level.
+  /// @param view, projection Written to the batches' constants. The camera's own for its passes.
+  void writeDrawBatches(const std::vector<std::shared_ptr<Drawable>> &drawables,
+                        bool preserveOrder,
+                        uint32 pipelineKey,
+                        uint32 lodBias,
+                        const std::shared_ptr<Camera> &camera,
+                        const Matrix4 &view,
+                        const Matrix4 &projection,
+                        std::vector<DrawBatch> &batches);
   void writePerFrameConstantData(const std::shared_ptr<Camera> &camera,
                                  const std::shared_ptr<Light> &directionalLight,
                                  const std::vector<std::shared_ptr<Light>> &lights) const;
+  /// @brief Assigns the point and spot lights to the camera's clusters and uploads the lights, their shadow tiles and
+  /// each cluster's light list.
+  void writeLightClusterData(const std::shared_ptr<RenderDevice> &renderDevice,
+                             const std::shared_ptr<Camera> &camera,
+                             const std::vector<std::shared_ptr<Light>> &lights,
+                             JobSystem *jobs);
+  /// @brief Grows texture until it has the rows of LIGHT_TEXTURE_WIDTH texels needed for texelCount.
+  /// @return Rows holding texelCount.
+  uint32 reserveLightTexture(const std::shared_ptr<RenderDevice> &renderDevice,
+                             std::shared_ptr<Texture> &texture,
+                             TextureFormat format,
+                             uint64 texelCount);
+  void updateRenderPassTimings();
+
   void writeSsaoConstantData(const std::shared_ptr<RenderDevice> &renderDevice, const std::shared_ptr<Camera> &camera) const;
 
   Vector2I _windowDims;
@@ -131,6 +257,17 @@ private:
   float32 _ssaoIntensity;
   bool _ssaoEnabled;
   bool _ssaoSettingsModified;
+  /// @brief Computes occlusion at half resolution with a few samples per frame, accumulating them over frames and
+  /// upsampling with the depth buffer, rather than with every sample at full resolution.
+  bool _ssaoHalfResolution;
+  uint32 _ssaoHalfResolutionSamples;
+  /// @brief Frames a pixel's occlusion is averaged over at most.
+  uint32 _ssaoMaxHistory;
+  /// @brief Relative difference between reprojected and stored depth past which history is discarded.
+  float32 _ssaoDepthRejection;
+  bool _ssaoHistoryValid;
+  uint32 _ssaoFrameIndex;
+  Matrix4 _ssaoPreviousViewProj;
   bool _settingsModified;
 
   // ----- Shadow settings -----
@@ -142,6 +279,22 @@ private:
   float32 _shadowSampleSpread;
   float32 _minCascadeDistance, _maxCascadeDistance;
   float32 _cascadeLambda;
+  // ----- Local light shadow settings -----
+  bool _shadowAtlasSizeChanged;
+  int32 _shadowAtlasSize;
+  int32 _shadowAtlasMaxTileSize;
+  /// @brief Tiles of the atlas which may be drawn each frame, any other stale tiles wait for a later one.
+  uint32 _shadowAtlasTileBudget;
+  /// @brief Scales the texels a light's tiles are given for the pixels it covers on screen.
+  float32 _shadowAtlasTexelScale;
+  // ----- Level of detail settings -----
+  bool _lodEnabled;
+  /// @brief Pixels a level's error may cover on screen before a finer level is drawn.
+  float32 _lodErrorThreshold;
+  float32 _lodHysteresis;
+  uint32 _shadowLodBias;
+  // ----- Occlusion culling settings -----
+  bool _occlusionCullingEnabled;
   // ----- HDR settings -----
   bool _toneMappingEnabled;
   bool _bloomEnabled;
@@ -155,33 +308,111 @@ private:
   int32 _shadowMapLayerToDraw;
 
   std::vector<RenderPassTimings> _renderPassTimings;
+  std::vector<std::shared_ptr<TimerQuery>> _renderPassTimers;
+  TimingHistory _cpuFrameHistory;
+  TimingHistory _gpuFrameHistory;
+  /// @brief Results every pass's timer had when the GPU frame time was last taken.
+  uint64 _gpuFrameResultCount;
+  bool _hasGpuTimings;
+
+  /// @brief The view projection each depth readback was drawn with, by the id of the copy.
+  struct HiZReadbackView
+  {
+    uint64 Id;
+    Matrix4 ViewProjection;
+  };
+  std::shared_ptr<TextureReadback> _hiZReadback;
+  std::vector<HiZReadbackView> _hiZReadbackViews;
+  HiZBuffer _hiZBuffer;
+  uint64 _hiZBufferId;
+  bool _hiZBufferValid;
+
+  std::shared_ptr<UploadArena> _perObjectArena;
+  std::shared_ptr<UploadArena> _instanceArena;
+  /// @brief The batches of each cascade rendered this frame.
+  std::vector<std::vector<DrawBatch>> _cascadeBatches;
+  /// @brief The batches of each atlas tile rendered this frame, in the order of the atlas's allocations.
+  std::vector<std::vector<DrawBatch>> _localShadowBatches;
+  std::vector<DrawBatch> _opaqueBatches;
+  std::vector<DrawBatch> _transparentBatches;
+  std::vector<uint64> _aabbObjectOffsets;
+  std::vector<Matrix4> _instanceScratch;
+  std::vector<uint32> _batchIndexScratch;
+
+  // ----- Shadow cascades -----
+  ShadowCascades _shadowCascades;
+  /// @brief World bounds of every drawable, indexed as allDrawables, which the cascades cull.
+  AabbArray _casterBounds;
+  std::vector<std::shared_ptr<Drawable>> _casterScratch;
+  std::vector<uint32> _casterIndexScratch;
+
+  // ----- Local light shadows -----
+  ShadowAtlas _shadowAtlas;
+  std::vector<ShadowAtlasRequest> _shadowAtlasRequests;
+  /// @brief The light making each request.
+  std::vector<std::shared_ptr<Light>> _shadowAtlasLights;
+  /// @brief The view projection, atlas rectangle and texel size of each tile holding a rendering, six texels per tile.
+  std::vector<Vector4> _shadowTileDataScratch;
+
+  // ----- Clustered lighting -----
+  LightClusters _lightClusters;
+  std::vector<ClusterLight> _clusterLightScratch;
+  /// @brief Colour and intensity, world space position and radius, direction and spot cone, then shadow tiles, four
+  /// texels per light.
+  std::vector<Vector4> _lightDataScratch;
+  std::vector<uint32> _lightIndexScratch;
+
+  // ----- Draw submission -----
+  bool _stateSortingEnabled;
+  RenderQueue _renderQueue;
+  RenderStateStats _stateStats;
+  const PipelineState *_boundPipelineState;
+  const StaticMesh *_boundMesh;
+  const Material *_boundMaterial;
+  std::array<const Texture *, 6> _boundTextures;
+  std::array<const SamplerState *, 6> _boundSamplers;
 
-  std::shared_ptr<GpuBuffer> _perObjectBuffer,
-      _perFrameBuffer,
+  std::shared_ptr<GpuBuffer> _perFrameBuffer,
       _ssaoConstantsBuffer,
+      _ssaoFrameBuffer,
       _fullscreenQuadBuffer,
       _bloomBuffer;
   std::shared_ptr<RenderTarget> _shadowMapRto,
+      _shadowAtlasRto,
       _gBufferRto,
       _transparencyRto,
       _shadowsRto,
       _ssaoRto,
       _ssaoBlurRto,
+      _ssaoHalfResolutionRto,
+      _hiZRto,
       _lightingPassRto,
       _toneMappingRto;
+  /// @brief Each renders to one layer of the shadow map, so cascades can be drawn and kept independently.
+  std::vector<std::shared_ptr<RenderTarget>> _cascadeRtos;
   std::vector<std::shared_ptr<RenderTarget>> _bloomDownSampleRtos;
-  std::shared_ptr<PipelineState> _shadowMapPso,
-      _gBufferPso,
-      _transparencyPso,
-      _shadowsPso,
+  /// @brief Half resolution linear depth and accumulated occlusion, swapping each frame between this frame's and the
+  /// last.
+  std::array<std::shared_ptr<RenderTarget>, 2> _ssaoDepthRtos;
+  std::array<std::shared_ptr<RenderTarget>, 2> _ssaoHistoryRtos;
+  MeshPipelineStates _shadowMapPsos,
+      _gBufferPsos,
+      _transparencyPsos;
+  std::shared_ptr<PipelineState> _shadowsPso,
       _ssaoPso,
       _ssaoBlurPso,
+      _ssaoDownsamplePso,
+      _ssaoHalfResolutionPso,
+      _ssaoTemporalPso,
+      _ssaoUpsamplePso,
+      _hiZPso,
       _lightingPso,
       _bloomDownSamplePso,
       _bloomUpSamplePso,
       _toneMappingPso,
       _drawAabbPso,
-      _editorDrawTexturedQuadPso;
+      _editorDrawTexturedQuadPso,
+      _clearDepthPso;
   std::shared_ptr<SamplerState> _basicSamplerState,
       _noMipSamplerState,
       _shadowMapSamplerState,
@@ -191,5 +422,9 @@ private:
   std::shared_ptr<VertexBuffer> _fsQuadVertexBuffer,
       _aabbVertexBuffer;
   std::shared_ptr<Texture> _randomRotationsMap,
-      _ssaoNoiseTexture;
+      _ssaoNoiseTexture,
+      _clusterMap,
+      _lightMap,
+      _lightIndexMap,
+      _shadowTileMap;
 };
\ No newline at end of file
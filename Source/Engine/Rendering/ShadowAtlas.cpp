@@ -0,0 +1,255 @@
+#include "ShadowAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  /// @brief A light keeps its tiles until the size it wants falls below this fraction of them.
+  const float32 SHRINK_FRACTION = 0.35f;
+
+  uint32 roundUpToPowerOfTwo(float32 value)
+  {
+    uint32 result = 1;
+    while (result < value && result < (1u << 30))
+    {
+      result <<= 1;
+    }
+    return result;
+  }
+}
+
+ShadowAtlas::ShadowAtlas() : _size(0),
+                             _maxTileSize(0),
+                             _renderedTileCount(0),
+                             _cachedTileCount(0),
+                             _deferredTileCount(0),
+                             _unplacedCount(0)
+{
+}
+
+void ShadowAtlas::reset(uint32 size, uint32 maxTileSize)
+{
+  _size = size;
+  _maxTileSize = std::min(std::max(maxTileSize, MIN_TILE_SIZE), size);
+  _freeTiles.assign(getLevel(MIN_TILE_SIZE) + 1, {});
+  _freeTiles[0].push_back({0, 0});
+  _entries.clear();
+  _allocations.clear();
+}
+
+void ShadowAtlas::update(const std::vector<ShadowAtlasRequest> &requests, uint32 tileBudget)
+{
+  _renderedTileCount = 0;
+  _cachedTileCount = 0;
+  _deferredTileCount = 0;
+  _unplacedCount = 0;
+  for (auto &entry : _entries)
+  {
+    entry.second.Requested = false;
+    entry.second.Allocation.Rendered = false;
+  }
+
+  // Lights keep their tiles while the size they want holds, every other light gives its tiles back to be placed again.
+  _order.clear();
+  for (uint32 i = 0; i < requests.size(); i++)
+  {
+    const ShadowAtlasRequest &request = requests[i];
+    Entry &entry = _entries[request.Id];
+    entry.Requested = true;
+
+    uint32 current = entry.Allocation.TileSize;
+    uint32 target = std::min(std::max(roundUpToPowerOfTwo(request.Size), MIN_TILE_SIZE), _maxTileSize);
+    bool keep = current > 0 &&
+                entry.TileCount == request.TileCount &&
+                (target == current || (target < current && request.Size > current * SHRINK_FRACTION));
+    if (!keep)
+    {
+      freeTiles(entry);
+      entry.TileCount = request.TileCount;
+      _order.push_back(i);
+    }
+  }
+
+  for (auto entry = _entries.begin(); entry != _entries.end();)
+  {
+    if (entry->second.Requested)
+    {
+      ++entry;
+      continue;
+    }
+    freeTiles(entry->second);
+    entry = _entries.erase(entry);
+  }
+
+  std::stable_sort(_order.begin(), _order.end(), [&](uint32 a, uint32 b)
+                   { return requests[a].Size > requests[b].Size; });
+  for (uint32 i : _order)
+  {
+    const ShadowAtlasRequest &request = requests[i];
+    Entry &entry = _entries[request.Id];
+    uint32 target = std::min(std::max(roundUpToPowerOfTwo(request.Size), MIN_TILE_SIZE), _maxTileSize);
+    for (uint32 tileSize = target; tileSize >= MIN_TILE_SIZE && entry.Allocation.TileSize == 0; tileSize /= 2)
+    {
+      uint32 level = getLevel(tileSize);
+      uint32 placed = 0;
+      while (placed < entry.TileCount && allocateTile(level, entry.Allocation.Tiles[placed]))
+      {
+        placed++;
+      }
+      if (placed == entry.TileCount)
+      {
+        entry.Allocation.TileSize = tileSize;
+        break;
+      }
+      while (placed > 0)
+      {
+        freeTile(level, entry.Allocation.Tiles[--placed]);
+      }
+    }
+    _unplacedCount += entry.Allocation.TileSize == 0 ? 1 : 0;
+  }
+
+  // Lights which have never been rendered into their tiles are drawn first, then the largest of the stale ones.
+  _order.clear();
+  for (uint32 i = 0; i < requests.size(); i++)
+  {
+    const Entry &entry = _entries[requests[i].Id];
+    if (entry.Allocation.TileSize > 0 && (!entry.Allocation.Valid || entry.Signature != requests[i].Signature))
+    {
+      _order.push_back(i);
+    }
+  }
+  std::stable_sort(_order.begin(), _order.end(), [&](uint32 a, uint32 b)
+                   {
+                     bool validA = _entries[requests[a].Id].Allocation.Valid;
+                     bool validB = _entries[requests[b].Id].Allocation.Valid;
+                     return validA != validB ? !validA : requests[a].Size > requests[b].Size; });
+  uint32 remainingTiles = tileBudget;
+  for (uint32 i : _order)
+  {
+    const ShadowAtlasRequest &request = requests[i];
+    Entry &entry = _entries[request.Id];
+    if (entry.TileCount > remainingTiles)
+    {
+      _deferredTileCount += entry.TileCount;
+      continue;
+    }
+    remainingTiles -= entry.TileCount;
+    _renderedTileCount += entry.TileCount;
+    entry.Signature = request.Signature;
+    entry.Allocation.Transforms = request.Transforms;
+    entry.Allocation.Rendered = true;
+    entry.Allocation.Valid = true;
+  }
+
+  _allocations.resize(requests.size());
+  for (uint32 i = 0; i < requests.size(); i++)
+  {
+    const Entry &entry = _entries[requests[i].Id];
+    _allocations[i] = entry.Allocation;
+    if (entry.Allocation.Valid && !entry.Allocation.Rendered)
+    {
+      _cachedTileCount += entry.TileCount;
+    }
+  }
+}
+
+float32 ShadowAtlas::getOccupancy() const
+{
+  if (_size == 0)
+  {
+    return 0.0f;
+  }
+
+  uint64 usedTexels = 0;
+  for (const auto &entry : _entries)
+  {
+    uint64 tileSize = entry.second.Allocation.TileSize;
+    usedTexels += tileSize * tileSize * entry.second.TileCount;
+  }
+  return static_cast<float32>(usedTexels) / (static_cast<float32>(_size) * _size);
+}
+
+uint32 ShadowAtlas::getLevel(uint32 tileSize) const
+{
+  uint32 level = 0;
+  while ((_size >> level) > tileSize)
+  {
+    level++;
+  }
+  return level;
+}
+
+bool ShadowAtlas::allocateTile(uint32 level, ShadowAtlasTile &tile)
+{
+  std::vector<ShadowAtlasTile> &freeTiles = _freeTiles[level];
+  if (!freeTiles.empty())
+  {
+    tile = freeTiles.back();
+    freeTiles.pop_back();
+    return true;
+  }
+
+  // Quarter a tile from the level above, keeping one quarter and freeing the rest.
+  ShadowAtlasTile parent;
+  if (level == 0 || !allocateTile(level - 1, parent))
+  {
+    return false;
+  }
+  uint32 tileSize = _size >> level;
+  freeTiles.push_back({parent.X + tileSize, parent.Y + tileSize});
+  freeTiles.push_back({parent.X, parent.Y + tileSize});
+  freeTiles.push_back({parent.X + tileSize, parent.Y});
+  tile = parent;
+  return true;
+}
+
+void ShadowAtlas::freeTile(uint32 level, const ShadowAtlasTile &tile)
+{
+  std::vector<ShadowAtlasTile> &freeTiles = _freeTiles[level];
+  if (level > 0)
+  {
+    // When the other three quarters of the tile above are free too, they merge back into it.
+    uint32 tileSize = _size >> level;
+    ShadowAtlasTile parent{tile.X - tile.X % (tileSize * 2), tile.Y - tile.Y % (tileSize * 2)};
+    std::array<uint32, 3> siblings{};
+    uint32 siblingCount = 0;
+    for (uint32 i = 0; i < freeTiles.size() && siblingCount < 3; i++)
+    {
+      const ShadowAtlasTile &other = freeTiles[i];
+      if (other.X - other.X % (tileSize * 2) == parent.X && other.Y - other.Y % (tileSize * 2) == parent.Y)
+      {
+        siblings[siblingCount++] = i;
+      }
+    }
+
+    if (siblingCount == 3)
+    {
+      // Erasing from the back first keeps the remaining indices valid.
+      for (int32 i = 2; i >= 0; i--)
+      {
+        freeTiles[siblings[i]] = freeTiles.back();
+        freeTiles.pop_back();
+      }
+      freeTile(level - 1, parent);
+      return;
+    }
+  }
+  freeTiles.push_back(tile);
+}
+
+void ShadowAtlas::freeTiles(Entry &entry)
+{
+  if (entry.Allocation.TileSize > 0)
+  {
+    uint32 level = getLevel(entry.Allocation.TileSize);
+    for (uint32 i = 0; i < entry.TileCount; i++)
+    {
+      freeTile(level, entry.Allocation.Tiles[i]);
+    }
+  }
+  entry.Allocation.TileSize = 0;
+  entry.Allocation.Valid = false;
+  entry.Allocation.Rendered = false;
+}
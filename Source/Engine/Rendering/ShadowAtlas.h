@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+#include "../Core/Maths.h"
+#include "../Core/Types.hpp"
+
+/// @brief A square region of the atlas, by the texel of its lower left corner.
+struct ShadowAtlasTile
+{
+  uint32 X;
+  uint32 Y;
+};
+
+/// @brief A light asking for space in the atlas this frame.
+struct ShadowAtlasRequest
+{
+  /// @brief Identifies the light from one frame to the next.
+  uint64 Id;
+  /// @brief One tile for a spot light, one per cube face for a point light.
+  uint32 TileCount;
+  /// @brief Texels wanted along each side of the light's tiles, from how much of the screen it covers.
+  float32 Size;
+  /// @brief Changes whenever the light or a caster within its reach does, at which point its tiles are stale.
+  uint64 Signature;
+  /// @brief The view projection of each of the light's tiles this frame.
+  std::array<Matrix4, 6> Transforms;
+};
+
+/// @brief Where a request's tiles are this frame.
+struct ShadowAtlasAllocation
+{
+  /// @brief Texels along each side of the light's tiles, or zero when the atlas had no room for it.
+  uint32 TileSize = 0;
+  std::array<ShadowAtlasTile, 6> Tiles{};
+  /// @brief The view projections the tiles were last rendered with, which lookups into them must use.
+  std::array<Matrix4, 6> Transforms;
+  /// @brief Set when the tiles are to be rendered this frame.
+  bool Rendered = false;
+  /// @brief Set when the tiles hold a rendering of the light, from this frame or an earlier one.
+  bool Valid = false;
+};
+
+/// @brief Packs the shadow maps of point and spot lights into one square depth texture. Tiles are powers of two, cut
+/// from the atlas by repeated quartering so freed tiles merge back into larger ones. A light keeps its tiles while its
+/// size holds, and they are only rendered again once its signature changes, a limited number of tiles per frame.
+class ShadowAtlas
+{
+public:
+  static constexpr uint32 MAX_TILES_PER_LIGHT = 6;
+  static constexpr uint32 MIN_TILE_SIZE = 64;
+
+  ShadowAtlas();
+
+  /// @brief Empties an atlas of size texels square, whose tiles are at most maxTileSize.
+  void reset(uint32 size, uint32 maxTileSize);
+
+  /// @brief Places every request, the largest first, shrinking those that do not fit until they do or reach the
+  /// smallest tile size. Then picks the stale lights to render, those never rendered first, up to tileBudget tiles.
+  void update(const std::vector<ShadowAtlasRequest> &requests, uint32 tileBudget);
+
+  /// @brief One per request of the last update, in the same order.
+  const std::vector<ShadowAtlasAllocation> &getAllocations() const { return _allocations; }
+
+  uint32 getSize() const { return _size; }
+  uint32 getMaxTileSize() const { return _maxTileSize; }
+  /// @brief Tiles rendered during the last update.
+  uint32 getRenderedTileCount() const { return _renderedTileCount; }
+  /// @brief Tiles reused from earlier frames during the last update.
+  uint32 getCachedTileCount() const { return _cachedTileCount; }
+  /// @brief Tiles left stale during the last update as the budget ran out.
+  uint32 getDeferredTileCount() const { return _deferredTileCount; }
+  /// @brief Requests of the last update which were given no space.
+  uint32 getUnplacedCount() const { return _unplacedCount; }
+  /// @brief Fraction of the atlas's texels held by tiles.
+  float32 getOccupancy() const;
+
+private:
+  struct Entry
+  {
+    ShadowAtlasAllocation Allocation;
+    uint32 TileCount = 0;
+    uint64 Signature = 0;
+    bool Requested = false;
+  };
+
+  uint32 getLevel(uint32 tileSize) const;
+  bool allocateTile(uint32 level, ShadowAtlasTile &tile);
+  void freeTile(uint32 level, const ShadowAtlasTile &tile);
+  void freeTiles(Entry &entry);
+
+  uint32 _size;
+  uint32 _maxTileSize;
+  /// @brief Free tiles of each size, the whole atlas at level zero and a quarter of the tiles above at each level after.
+  std::vector<std::vector<ShadowAtlasTile>> _freeTiles;
+  std::unordered_map<uint64, Entry> _entries;
+  std::vector<ShadowAtlasAllocation> _allocations;
+  std::vector<uint32> _order;
+  uint32 _renderedTileCount;
+  uint32 _cachedTileCount;
+  uint32 _deferredTileCount;
+  uint32 _unplacedCount;
+};
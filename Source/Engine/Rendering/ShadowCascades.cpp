@@ -0,0 +1,131 @@
+#include "ShadowCascades.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "../Core/JobSystem.h"
+#include "../Maths/AabbArray.hpp"
+#include "../Maths/Plane.hpp"
+
+namespace
+{
+  void runParallel(JobSystem *jobs, uint32 count, uint32 grainSize, const std::function<void(uint32, uint32)> &function)
+  {
+    if (jobs)
+    {
+      jobs->parallelFor(count, grainSize, function);
+    }
+    else if (count > 0)
+    {
+      function(0, count);
+    }
+  }
+}
+
+ShadowCascades::ShadowCascades() : _resolution(1),
+                                   _firstCachedCascade(2),
+                                   _refreshInterval(4),
+                                   _texelThreshold(4.0f)
+{
+}
+
+void ShadowCascades::reset(uint32 cascadeCount, uint32 resolution)
+{
+  _cascades.assign(cascadeCount, Cascade());
+  _resolution = resolution;
+}
+
+void ShadowCascades::update(const std::vector<CascadeBounds> &bounds, const Vector3 &lightDirection, const AabbArray &casterBounds, JobSystem *jobs)
+{
+  Vector3 toLight = -Vector3::Normalize(lightDirection);
+  runParallel(jobs, getCascadeCount(), 1, [&](uint32 begin, uint32 end)
+              {
+                for (uint32 i = begin; i < end; i++)
+                {
+                  Cascade &cascade = _cascades[i];
+                  const Vector3 &center = bounds[i].Center;
+                  float32 radius = bounds[i].Radius;
+
+                  // The light looks at the center from the edge of the bounds, which span [-2 * radius, 0] along its
+                  // view's z axis.
+                  Matrix4 view = Matrix4::LookAt(center + toLight * radius, center, Vector3::Up);
+                  Matrix4 projection = Matrix4::Orthographic(-radius, radius, -radius, radius, -2.0f * radius, 2.0f * radius);
+
+                  // Snapping the origin to a whole texel keeps the layer's texels fixed in the world as the camera moves,
+                  // which stops the edges of shadows shimmering.
+                  Vector4 shadowOrigin = (projection * view) * Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+                  shadowOrigin = shadowOrigin * (_resolution / 2.0f);
+                  Vector4 roundedOffset = Math::RoundToEven(shadowOrigin) - shadowOrigin;
+                  roundedOffset = roundedOffset * (2.0f / _resolution);
+                  roundedOffset.Z = 0.0f;
+                  roundedOffset.W = 0.0f;
+                  projection[3] += roundedOffset;
+
+                  bool cached = cascade.Valid &&
+                                i >= _firstCachedCascade &&
+                                cascade.FramesSinceRendered + 1 < _refreshInterval &&
+                                getTexelMovement(bounds[i], cascade.Transform, projection * view) <= _texelThreshold;
+                  cascade.Rendered = !cached;
+                  if (cached)
+                  {
+                    cascade.FramesSinceRendered++;
+                    continue;
+                  }
+
+                  // Casters may lie anywhere toward the light, so the volume has no near plane and its far plane is
+                  // repeated in its place. The sides are widened by the texel the origin may have been snapped across.
+                  Vector3 right(view[0][0], view[1][0], view[2][0]);
+                  Vector3 up(view[0][1], view[1][1], view[2][1]);
+                  float32 halfWidth = radius * (1.0f + 2.0f / _resolution);
+                  Plane farPlane(toLight, center - toLight * radius);
+                  Frustrum volume(farPlane, farPlane,
+                                  Plane(-right, center + right * halfWidth),
+                                  Plane(right, center - right * halfWidth),
+                                  Plane(-up, center + up * halfWidth),
+                                  Plane(up, center - up * halfWidth));
+                  cascade.Casters.clear();
+                  volume.cull(casterBounds, cascade.Casters);
+
+                  // Pull the near plane back to the caster nearest the light so that none of them are clipped.
+                  Vector3 absToLight = Math::Abs(toLight);
+                  float32 nearDistance = 2.0f * radius;
+                  for (uint32 caster : cascade.Casters)
+                  {
+                    Vector3 casterCenter(casterBounds.getCenterX()[caster], casterBounds.getCenterY()[caster], casterBounds.getCenterZ()[caster]);
+                    Vector3 casterExtents(casterBounds.getExtentX()[caster], casterBounds.getExtentY()[caster], casterBounds.getExtentZ()[caster]);
+                    float32 towardLight = Vector3::Dot(casterCenter - center, toLight) + Vector3::Dot(casterExtents, absToLight);
+                    nearDistance = std::max(nearDistance, towardLight - radius);
+                  }
+
+                  Matrix4 fittedProjection = Matrix4::Orthographic(-radius, radius, -radius, radius, -nearDistance, 2.0f * radius);
+                  fittedProjection[3] += roundedOffset;
+                  cascade.Transform = fittedProjection * view;
+                  cascade.FramesSinceRendered = 0;
+                  cascade.Valid = true;
+                }
+              });
+}
+
+uint32 ShadowCascades::getRenderedCount() const
+{
+  return static_cast<uint32>(std::count_if(_cascades.begin(), _cascades.end(), [](const Cascade &cascade)
+                                           { return cascade.Rendered; }));
+}
+
+float32 ShadowCascades::getTexelMovement(const CascadeBounds &bounds, const Matrix4 &previous, const Matrix4 &current) const
+{
+  float32 movement = 0.0f;
+  for (uint32 corner = 0; corner < 8; corner++)
+  {
+    Vector3 offset((corner & 1) ? bounds.Radius : -bounds.Radius,
+                   (corner & 2) ? bounds.Radius : -bounds.Radius,
+                   (corner & 4) ? bounds.Radius : -bounds.Radius);
+    Vector4 point(bounds.Center + offset, 1.0f);
+    Vector4 previousPoint = previous * point;
+    Vector4 currentPoint = current * point;
+    movement = std::max(movement, std::max(std::abs(previousPoint.X - currentPoint.X), std::abs(previousPoint.Y - currentPoint.Y)));
+  }
+  // Normalised device coordinates span two units across the layer.
+  return movement * _resolution / 2.0f;
+}
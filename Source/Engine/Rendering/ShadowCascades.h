@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Maths.h"
+#include "../Core/Types.hpp"
+
+class AabbArray;
+class JobSystem;
+
+/// @brief The bounding sphere of a cascade's slice of the camera's frustum, in world space.
+struct CascadeBounds
+{
+  Vector3 Center;
+  float32 Radius;
+};
+
+/// @brief Fits each cascade of a directional light's shadow map around its slice of the camera's frustum, and picks the
+/// casters each one draws. A caster is kept when it overlaps the cascade's volume extruded toward the light, as
+/// anything between the light and the volume may shadow it. Cascades from the first cached one on keep their last
+/// rendered layer while they move less than a threshold, so distant cascades are only drawn every few frames.
+class ShadowCascades
+{
+public:
+  ShadowCascades();
+
+  /// @brief Resizes to cascadeCount cascades with layers of resolution texels square, forgetting every cached layer.
+  void reset(uint32 cascadeCount, uint32 resolution);
+
+  /// @brief Fits every cascade around its bounds and decides which are rendered this frame, culling casterBounds
+  /// for those that are. Cascades are culled across jobs when given.
+  void update(const std::vector<CascadeBounds> &bounds, const Vector3 &lightDirection, const AabbArray &casterBounds, JobSystem *jobs = nullptr);
+
+  uint32 getCascadeCount() const { return static_cast<uint32>(_cascades.size()); }
+  /// @brief The transform the cascade's layer was last rendered with, which lookups into the layer must use.
+  const Matrix4 &getTransform(uint32 cascade) const { return _cascades[cascade].Transform; }
+  /// @brief Whether the cascade's layer is to be rendered this frame, rather than reused from an earlier one.
+  bool isRendered(uint32 cascade) const { return _cascades[cascade].Rendered; }
+  /// @brief Indices into the caster bounds of the boxes which may shadow the cascade. Only updated when it is rendered.
+  const std::vector<uint32> &getCasters(uint32 cascade) const { return _cascades[cascade].Casters; }
+  /// @brief Cascades rendered during the last update.
+  uint32 getRenderedCount() const;
+
+  /// @brief Cascades from this one on may be cached. Caching is disabled when it is at least the cascade count.
+  void setFirstCachedCascade(uint32 cascade) { _firstCachedCascade = cascade; }
+  uint32 getFirstCachedCascade() const { return _firstCachedCascade; }
+  /// @brief A cached cascade is still rendered at least once every this many frames.
+  void setRefreshInterval(uint32 frames) { _refreshInterval = frames; }
+  uint32 getRefreshInterval() const { return _refreshInterval; }
+  /// @brief Texels any part of a cascade's bounds may move across its layer before the layer is rendered again.
+  void setTexelThreshold(float32 texels) { _texelThreshold = texels; }
+  float32 getTexelThreshold() const { return _texelThreshold; }
+
+private:
+  struct Cascade
+  {
+    Matrix4 Transform;
+    std::vector<uint32> Casters;
+    uint32 FramesSinceRendered = 0;
+    bool Valid = false;
+    bool Rendered = false;
+  };
+
+  /// @brief Largest distance in texels any corner of the box around bounds moves between two transforms.
+  float32 getTexelMovement(const CascadeBounds &bounds, const Matrix4 &previous, const Matrix4 &current) const;
+
+  std::vector<Cascade> _cascades;
+  uint32 _resolution;
+  uint32 _firstCachedCascade;
+  uint32 _refreshInterval;
+  float32 _texelThreshold;
+};
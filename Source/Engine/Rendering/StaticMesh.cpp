@@ -1,10 +1,20 @@
 #include "StaticMesh.h"
 
+#include <algorithm>
+
+#include "../Geometry/TangentSpace.hpp"
 #include "../RenderApi/IndexBuffer.hpp"
 #include "../RenderApi/RenderDevice.hpp"
 #include "../RenderApi/VertexBuffer.hpp"
 
-StaticMesh::StaticMesh() : _vertexDataFormat(0),
+static uint32 ID_COUNTER = 0;
+
+std::atomic<VertexFormat> StaticMesh::_defaultVertexFormat(VertexFormat::Full);
+
+StaticMesh::StaticMesh() : _id(ID_COUNTER++),
+                           _interleavedVertexStride(0),
+                           _vertexFormat(_defaultVertexFormat),
+                           _vertexDataFormat(0),
                            _vertexCount(0),
                            _verticesNeedUpdate(true),
                            _indicesNeedUpdate(true),
@@ -97,70 +107,101 @@ void StaticMesh::setIndexData(const std::vector<uint32> &indexData)
   }
   _indexCount = indexCount;
   _indexData = indexData;
+  _lods.clear();
   _indicesNeedUpdate = true;
   _indexed = true;
 }
 
-void StaticMesh::generateTangents()
+void StaticMesh::setInterleavedData(std::shared_ptr<const void> vertexData, uint32 vertexCount, uint32 vertexStride,
+                                    std::shared_ptr<const uint32> indexData, uint32 indexCount, const Aabb &aabb)
+{
+  _interleavedVertexData = std::move(vertexData);
+  _interleavedVertexStride = vertexStride;
+  _vertexCount = static_cast<int32>(vertexCount);
+  _verticesNeedUpdate = true;
+
+  _interleavedIndexData = std::move(indexData);
+  _indexCount = static_cast<int32>(indexCount);
+  _indexed = indexCount > 0;
+  _indicesNeedUpdate = _indexed;
+  _lods.clear();
+
+  _aabb = aabb;
+}
+
+void StaticMesh::generateLods()
 {
-  if (_positionData.empty() && _textureData.empty())
+  if (!_indexed || _interleavedIndexData || !(_vertexDataFormat & VertexDataFormat::Position))
   {
     return;
   }
 
-  if (_indexed)
+  MeshOptimizerData mesh;
+  mesh.Positions = _positionData;
+  mesh.Normals = _normalData;
+  mesh.TexCoords = _textureData;
+  MeshLod fullLod = getLod(0);
+  mesh.Indices.assign(_indexData.begin() + fullLod.IndexOffset, _indexData.begin() + fullLod.IndexOffset + fullLod.IndexCount);
+
+  _lods = MeshSimplifier::generateLods(mesh, _indexData);
+  _indexCount = static_cast<int32>(_indexData.size());
+  _indicesNeedUpdate = true;
+}
+
+MeshLod StaticMesh::getLod(uint32 lod) const
+{
+  if (_lods.empty())
   {
-    std::vector<Vector3> tangents(_positionData.size());
-    std::vector<Vector3> bitangents(_positionData.size());
+    MeshLod fullLod;
+    fullLod.IndexCount = _indexed ? static_cast<uint32>(_indexCount) : 0;
+    return fullLod;
+  }
+  return _lods[std::min(lod, static_cast<uint32>(_lods.size()) - 1)];
+}
 
-    // TODO: improve this using vectors instead of floats
-    for (size_t i = 0; i < _indexData.size(); i += 3)
-    {
-      Vector3 p0 = _positionData[_indexData[i]];
-      Vector3 p1 = _positionData[_indexData[i + 1]];
-      Vector3 p2 = _positionData[_indexData[i + 2]];
-
-      Vector2 uv0 = _textureData[_indexData[i]];
-      Vector2 uv1 = _textureData[_indexData[i + 1]];
-      Vector2 uv2 = _textureData[_indexData[i + 2]];
-
-      Vector3 q0 = p1 - p0;
-      Vector3 q1 = p2 - p0;
-
-      Vector3 s = uv1 - uv0;
-      Vector3 t = uv2 - uv0;
-
-      Vector3 tangent;
-      Vector3 bitangent;
-      float32 demon = (s[0] * t[1] - t[0] * s[1]);
-      if (std::fabsf(demon) >= 0e8f)
-      {
-        float32 f = 1.0f / demon;
-        s *= f;
-        t *= f;
-
-        tangent = t[1] * q0 - s[1] * q1;
-        bitangent = s[0] * q1 - t[0] * q0;
-      }
-
-      tangents[_indexData[i]] += tangent;
-      tangents[_indexData[i + 1]] += tangent;
-      tangents[_indexData[i + 2]] += tangent;
-
-      bitangents[_indexData[i]] += bitangent;
-      bitangents[_indexData[i + 1]] += bitangent;
-      bitangents[_indexData[i + 2]] += bitangent;
-    }
+void StaticMesh::setVertexFormat(VertexFormat format)
+{
+  if (format == _vertexFormat)
+  {
+    return;
+  }
+  _vertexFormat = format;
+  _verticesNeedUpdate = true;
+}
 
-    for (size_t i = 0; i < _positionData.size(); i++)
-    {
-      tangents[i] = Vector3::Normalize(tangents[i]);
-      bitangents[i] = Vector3::Normalize(bitangents[i]);
-    }
+bool StaticMesh::supportsCompactVertices() const
+{
+  if (_interleavedVertexData)
+  {
+    return _interleavedVertexStride == FULL_VERTEX_FLOATS * sizeof(float32);
+  }
+  int32 fullFormat = VertexDataFormat::Position | VertexDataFormat::Normal | VertexDataFormat::Uv | VertexDataFormat::Tangent | VertexDataFormat::Bitanget;
+  return _vertexDataFormat == fullFormat;
+}
+
+void StaticMesh::generateTangents(JobSystem *jobs)
+{
+  if (!_indexed || _positionData.empty() || _textureData.size() != _positionData.size())
+  {
+    return;
+  }
+  if (_normalData.size() != _positionData.size())
+  {
+    generateNormals(jobs);
+  }
 
-    setTangentVertexData(tangents);
-    setBitangentVertexData(bitangents);
+  // Levels of detail after the first reuse its vertices, so only the first contributes.
+  std::vector<Vector4> tangents = TangentSpace::generateTangents(_positionData, _normalData, _textureData, _indexData.data(), getLod(0).IndexCount, jobs);
+  std::vector<Vector3> tangentData(tangents.size());
+  std::vector<Vector3> bitangentData(tangents.size());
+  for (size_t i = 0; i < tangents.size(); i++)
+  {
+    tangentData[i] = Vector3(tangents[i]);
+    bitangentData[i] = Vector3::Cross(_normalData[i], tangentData[i]) * tangents[i].W;
   }
+
+  setTangentVertexData(tangentData);
+  setBitangentVertexData(bitangentData);
 }
 
 void StaticMesh::calculateTangents(const std::vector<Vector3> &positionData, const std::vector<Vector2> &textureData)
@@ -200,14 +241,15 @@ void StaticMesh::calculateTangents(const std::vector<Vector3> &positionData, con
 
 Aabb StaticMesh::getAabb()
 {
-  if (_verticesNeedUpdate)
+  // Interleaved data arrives with its bounds as there are no separate positions to compute them from.
+  if (_verticesNeedUpdate && !_interleavedVertexData)
   {
     calculateAabb();
   }
   return _aabb;
 }
 
-void StaticMesh::generateNormals()
+void StaticMesh::generateNormals(JobSystem *jobs)
 {
   if (_positionData.empty())
   {
@@ -217,23 +259,7 @@ void StaticMesh::generateNormals()
   std::vector<Vector3> normals(_positionData.size());
   if (_indexed)
   {
-    for (size_t i = 0; i < _indexData.size(); i += 3)
-    {
-      Vector3 vecA = _positionData[_indexData[i]];
-      Vector3 vecB = _positionData[_indexData[i + 1]];
-      Vector3 vecC = _positionData[_indexData[i + 2]];
-      Vector3 vecAB = vecB - vecA;
-      Vector3 vecAC = vecC - vecA;
-      Vector3 normal = Vector3::Cross(vecAB, vecAC);
-      normals[_indexData[i]] += normal;
-      normals[_indexData[i + 1]] += normal;
-      normals[_indexData[i + 2]] += normal;
-    }
-
-    for (size_t i = 0; i < normals.size(); i++)
-    {
-      normals[i] = Vector3::Normalize(normals[i]);
-    }
+    normals = TangentSpace::generateNormals(_positionData, _indexData.data(), getLod(0).IndexCount, jobs);
   }
   else
   {
@@ -273,7 +299,7 @@ std::shared_ptr<IndexBuffer> StaticMesh::getIndexData(std::shared_ptr<RenderDevi
 void StaticMesh::calculateAabb()
 {
   Vector3 min(std::numeric_limits<float32>::max());
-  Vector3 max(std::numeric_limits<float32>::min());
+  Vector3 max(std::numeric_limits<float32>::lowest());
   for (auto position : _positionData)
   {
     max = Math::Max(max, position);
@@ -373,23 +399,51 @@ std::vector<float32> StaticMesh::createVertexDataArray() const
 
 void StaticMesh::uploadVertexData(std::shared_ptr<RenderDevice> renderDevice)
 {
-  int32 stride = 0;
-  auto dataToUpload = createRestructuredVertexDataArray(stride);
+  const void *vertexData = _interleavedVertexData.get();
+  uint32 stride = _interleavedVertexStride;
+  std::vector<float32> restructuredData;
+  if (!_interleavedVertexData)
+  {
+    int32 restructuredStride = 0;
+    restructuredData = createRestructuredVertexDataArray(restructuredStride);
+    vertexData = restructuredData.data();
+    stride = static_cast<uint32>(restructuredStride);
+  }
+
+  VertexFormat format = getVertexFormat();
+  std::vector<uint8> compressedData;
+  if (format != VertexFormat::Full)
+  {
+    compressedData = VertexCompression::compress(static_cast<const float32 *>(vertexData), _vertexCount, format, getAabb());
+    vertexData = compressedData.data();
+    stride = VertexCompression::getStride(format);
+  }
 
+  // A new buffer rather than a rewrite, as vertex array objects are cached against the buffer with its layout.
   VertexBufferDesc desc;
   desc.BufferUsage = BufferUsage::Default;
   desc.VertexCount = _vertexCount;
   desc.VertexSizeBytes = stride;
   _vertexBuffer = renderDevice->createVertexBuffer(desc);
-  _vertexBuffer->writeData(0, dataToUpload.size() * sizeof(float32), dataToUpload.data(), AccessType::WriteOnlyDiscard);
+  _vertexBuffer->writeData(0, static_cast<uint64>(_vertexCount) * stride, vertexData, AccessType::WriteOnlyDiscard);
 }
 
 void StaticMesh::uploadIndexData(std::shared_ptr<RenderDevice> renderDevice)
 {
+  const uint32 *indices = _interleavedIndexData ? _interleavedIndexData.get() : _indexData.data();
   IndexBufferDesc desc;
   desc.BufferUsage = BufferUsage::Default;
-  desc.IndexCount = static_cast<uint32>(_indexData.size());
-  desc.IndexType = IndexType::UInt32;
+  desc.IndexCount = static_cast<uint32>(_indexCount);
+  desc.IndexType = getIndexType();
   _indexBuffer = renderDevice->createIndexBuffer(desc);
-  _indexBuffer->writeData(0, _indexData.size() * IndexBuffer::getBytesPerIndex(desc.IndexType), _indexData.data(), AccessType::WriteOnlyDiscard);
+  if (desc.IndexType == IndexType::UInt16)
+  {
+    std::vector<uint16> shortIndices(indices, indices + desc.IndexCount);
+    _indexBuffer->writeData(0, desc.IndexCount * IndexBuffer::getBytesPerIndex(desc.IndexType), shortIndices.data(), AccessType::WriteOnlyDiscard);
+  }
+  else
+  {
+    _indexBuffer->writeData(0, desc.IndexCount * IndexBuffer::getBytesPerIndex(desc.IndexType), indices, AccessType::WriteOnlyDiscard);
+  }
+  _interleavedIndexData.reset();
 }
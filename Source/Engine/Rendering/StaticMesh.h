@@ -1,11 +1,16 @@
 #pragma once
+#include <atomic>
 #include <memory>
 #include <vector>
 
 #include "../Core/Maths.h"
 #include "../Core/Types.hpp"
+#include "../Geometry/MeshSimplifier.hpp"
+#include "../RenderApi/IndexBuffer.hpp"
+#include "VertexCompression.h"
 
 class IndexBuffer;
+class JobSystem;
 class Material;
 class VertexBuffer;
 class RenderDevice;
@@ -20,16 +25,56 @@ public:
   void setTextureVertexData(const std::vector<Vector2> &textureData);
   void setTangentVertexData(const std::vector<Vector3> &tangentData);
   void setBitangentVertexData(const std::vector<Vector3> &bitangentData);
+  /// @brief Replaces the indices, along with any levels of detail made from the previous ones.
   void setIndexData(const std::vector<uint32> &indexData);
+  /// @brief Uses an already interleaved vertex stream and index stream, such as those of a baked model, as they are.
+  /// Neither stream is copied on the CPU. The index stream is released once uploaded, while the vertex stream is held
+  /// so that it can be encoded again if the vertex format changes. Baked streams are views of the mapped file, so
+  /// holding them costs address space rather than memory.
+  void setInterleavedData(std::shared_ptr<const void> vertexData, uint32 vertexCount, uint32 vertexStride,
+                          std::shared_ptr<const uint32> indexData, uint32 indexCount, const Aabb &aabb);
 
   Aabb getAabb();
 
+  uint32 getId() const { return _id; }
   uint32 getVertexCount() const { return _vertexCount; }
   uint32 getIndexCount() const { return _indexCount; }
 
+  /// @brief Selects the layout the vertices are uploaded in, re-uploading them on the next draw if it changed. Only
+  /// meshes with every attribute of the Full layout can be compacted, the rest stay Full whatever is requested.
+  void setVertexFormat(VertexFormat format);
+  /// @brief The layout the vertices are, or will next be, uploaded in.
+  VertexFormat getVertexFormat() const { return supportsCompactVertices() ? _vertexFormat : VertexFormat::Full; }
+  bool supportsCompactVertices() const;
+
+  /// @brief The format requested by meshes as they are created.
+  static void setDefaultVertexFormat(VertexFormat format) { _defaultVertexFormat = format; }
+  static VertexFormat getDefaultVertexFormat() { return _defaultVertexFormat; }
+
+  /// @brief Simplifies the mesh into a chain of levels of detail appended to its index data. Call once the indices,
+  /// positions, normals and texture coordinates are final, normals and tangents are only generated from the first level.
+  void generateLods();
+  /// @brief Levels of detail as ranges of the index data, the first being the full mesh, such as those of a baked model.
+  void setLods(const std::vector<MeshLod> &lods) { _lods = lods; }
+  const std::vector<MeshLod> &getLods() const { return _lods; }
+  uint32 getLodCount() const { return _lods.empty() ? 1 : static_cast<uint32>(_lods.size()); }
+  /// @brief The range of the index data drawn for a level of detail, clamped to the coarsest level.
+  MeshLod getLod(uint32 lod) const;
+
   void calculateTangents(const std::vector<Vector3> &positionData, const std::vector<Vector2> &textureData);
-  void generateTangents();
-  void generateNormals();
+  /// @brief MikkTSpace tangents and signed bitangents for the first level of detail, generating normals first if the
+  /// mesh has none. Only indexed meshes with texture coordinates get tangents.
+  /// @param jobs If given, the work is split across its workers.
+  void generateTangents(JobSystem *jobs = nullptr);
+  /// @brief Area weighted normals for indexed meshes, or flat face normals for unindexed ones.
+  void generateNormals(JobSystem *jobs = nullptr);
+
+  /// @brief Interleaves the vertex attributes into the layout that is uploaded to the vertex buffer.
+  /// @param stride Incremented by the size in bytes of a single vertex.
+  std::vector<float32> createRestructuredVertexDataArray(int32 &stride) const;
+  const std::vector<uint32> &getIndices() const { return _indexData; }
+  /// @brief 16-bit whenever every vertex can be addressed by one, halving the index buffer.
+  IndexType getIndexType() const { return _vertexCount <= 0xffff ? IndexType::UInt16 : IndexType::UInt32; }
 
   std::shared_ptr<VertexBuffer> getVertexData(std::shared_ptr<RenderDevice> renderDevice);
   std::shared_ptr<IndexBuffer> getIndexData(std::shared_ptr<RenderDevice> renderDevice);
@@ -49,13 +94,17 @@ private:
 
   void calculateAabb();
 
-  std::vector<float32> createRestructuredVertexDataArray(int32 &stride) const;
   std::vector<float32> createVertexDataArray() const;
   void uploadVertexData(std::shared_ptr<RenderDevice> renderDevice);
   void uploadIndexData(std::shared_ptr<RenderDevice> renderDevice);
 
+  uint32 _id;
   std::shared_ptr<IndexBuffer> _indexBuffer;
   std::shared_ptr<VertexBuffer> _vertexBuffer;
+  std::shared_ptr<const void> _interleavedVertexData;
+  std::shared_ptr<const uint32> _interleavedIndexData;
+  uint32 _interleavedVertexStride;
+  VertexFormat _vertexFormat;
 
   std::vector<Vector3> _positionData;
   std::vector<Vector3> _normalData;
@@ -63,6 +112,7 @@ private:
   std::vector<Vector3> _bitangentData;
   std::vector<Vector2> _textureData;
   std::vector<uint32> _indexData;
+  std::vector<MeshLod> _lods;
 
   int32 _vertexDataFormat;
   int32 _vertexCount;
@@ -73,4 +123,6 @@ private:
   bool _indexed;
 
   Aabb _aabb;
+
+  static std::atomic<VertexFormat> _defaultVertexFormat;
 };
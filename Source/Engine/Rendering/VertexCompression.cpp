@@ -0,0 +1,261 @@
+#include "VertexCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  constexpr float32 SNORM16_MAX = 32767.0f;
+  constexpr float32 UNORM16_MAX = 65535.0f;
+
+  float32 signNotZero(float32 value)
+  {
+    return value >= 0.0f ? 1.0f : -1.0f;
+  }
+
+  /// @brief Matches the GL 4.2 snorm conversion, which is what shaders see.
+  float32 fromSnorm16(int16 value)
+  {
+    return std::max(static_cast<float32>(value) / SNORM16_MAX, -1.0f);
+  }
+
+  int16 toSnorm16(float32 value)
+  {
+    return static_cast<int16>(std::round(std::clamp(value, -1.0f, 1.0f) * SNORM16_MAX));
+  }
+
+  uint16 toUnorm16(float32 value, float32 min, float32 extent)
+  {
+    if (extent <= 0.0f)
+    {
+      return 0;
+    }
+    return static_cast<uint16>(std::round(std::clamp((value - min) / extent, 0.0f, 1.0f) * UNORM16_MAX));
+  }
+
+  template <typename T>
+  uint8 *write(uint8 *out, const T &value)
+  {
+    std::memcpy(out, &value, sizeof(T));
+    return out + sizeof(T);
+  }
+}
+
+uint32 VertexCompression::getStride(VertexFormat format)
+{
+  switch (format)
+  {
+  case VertexFormat::Compact:
+    return 3 * sizeof(float32) + 2 * sizeof(int16) + 2 * sizeof(uint16) + 4 * sizeof(int16);
+  case VertexFormat::CompactQuantized:
+    return 4 * sizeof(uint16) + 2 * sizeof(int16) + 2 * sizeof(uint16) + 4 * sizeof(int16);
+  case VertexFormat::Full:
+  default:
+    return FULL_VERTEX_FLOATS * sizeof(float32);
+  }
+}
+
+std::vector<VertexLayoutDesc> VertexCompression::getVertexLayout(VertexFormat format)
+{
+  switch (format)
+  {
+  case VertexFormat::Compact:
+  case VertexFormat::CompactQuantized:
+    // The tangent's third component holds the bitangent sign, its fourth is padding to keep attributes 4 byte aligned.
+    return {VertexLayoutDesc(SemanticType::Position, format == VertexFormat::Compact ? SemanticFormat::Float3 : SemanticFormat::Ushort4,
+                             format == VertexFormat::CompactQuantized),
+            VertexLayoutDesc(SemanticType::Normal, SemanticFormat::Short2, true),
+            VertexLayoutDesc(SemanticType::TexCoord, SemanticFormat::Half2),
+            VertexLayoutDesc(SemanticType::Tangent, SemanticFormat::Short4, true)};
+  case VertexFormat::Full:
+  default:
+    return {VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float3),
+            VertexLayoutDesc(SemanticType::Normal, SemanticFormat::Float3),
+            VertexLayoutDesc(SemanticType::TexCoord, SemanticFormat::Float2),
+            VertexLayoutDesc(SemanticType::Tangent, SemanticFormat::Float3),
+            VertexLayoutDesc(SemanticType::Bitangent, SemanticFormat::Float3)};
+  }
+}
+
+void VertexCompression::getPositionTransform(VertexFormat format, const Aabb &bounds, Vector3 &scale, Vector3 &offset)
+{
+  if (format == VertexFormat::CompactQuantized)
+  {
+    offset = bounds.getMin();
+    scale = bounds.getMax() - offset;
+    return;
+  }
+  scale = Vector3(1.0f);
+  offset = Vector3::Zero;
+}
+
+std::vector<uint8> VertexCompression::compress(const float32 *vertices, uint32 vertexCount, VertexFormat format, const Aabb &bounds)
+{
+  uint32 stride = getStride(format);
+  std::vector<uint8> compressed(static_cast<uint64>(vertexCount) * stride);
+  if (format == VertexFormat::Full)
+  {
+    std::memcpy(compressed.data(), vertices, compressed.size());
+    return compressed;
+  }
+
+  Vector3 scale, offset;
+  getPositionTransform(format, bounds, scale, offset);
+  for (uint32 i = 0; i < vertexCount; i++)
+  {
+    const float32 *vertex = vertices + static_cast<uint64>(i) * FULL_VERTEX_FLOATS;
+    Vector3 normal(vertex[3], vertex[4], vertex[5]);
+    Vector3 tangent(vertex[8], vertex[9], vertex[10]);
+    Vector3 bitangent(vertex[11], vertex[12], vertex[13]);
+
+    uint8 *out = compressed.data() + static_cast<uint64>(i) * stride;
+    if (format == VertexFormat::CompactQuantized)
+    {
+      for (uint32 c = 0; c < 3; c++)
+      {
+        out = write(out, toUnorm16(vertex[c], offset[c], scale[c]));
+      }
+      out = write(out, uint16(0));
+    }
+    else
+    {
+      for (uint32 c = 0; c < 3; c++)
+      {
+        out = write(out, vertex[c]);
+      }
+    }
+
+    int16 x, y;
+    encodeOctahedral(normal, x, y);
+    out = write(out, x);
+    out = write(out, y);
+    out = write(out, toHalf(vertex[6]));
+    out = write(out, toHalf(vertex[7]));
+
+    // Only the handedness of the bitangent is kept, shaders rebuild it from the normal and tangent.
+    encodeOctahedral(tangent, x, y);
+    out = write(out, x);
+    out = write(out, y);
+    out = write(out, Vector3::Dot(Vector3::Cross(normal, tangent), bitangent) < 0.0f ? int16(-32767) : int16(32767));
+    write(out, int16(0));
+  }
+  return compressed;
+}
+
+void VertexCompression::encodeOctahedral(const Vector3 &vector, int16 &x, int16 &y)
+{
+  float32 length = std::fabs(vector.X) + std::fabs(vector.Y) + std::fabs(vector.Z);
+  if (length <= 0.0f)
+  {
+    x = 0;
+    y = 0;
+    return;
+  }
+
+  float32 u = vector.X / length;
+  float32 v = vector.Y / length;
+  if (vector.Z < 0.0f)
+  {
+    float32 foldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+    v = (1.0f - std::fabs(u)) * signNotZero(v);
+    u = foldedU;
+  }
+
+  Vector3 target = Vector3::Normalize(vector);
+  float32 floorU = std::floor(std::clamp(u, -1.0f, 1.0f) * SNORM16_MAX);
+  float32 floorV = std::floor(std::clamp(v, -1.0f, 1.0f) * SNORM16_MAX);
+  float32 bestError = std::numeric_limits<float32>::max();
+  for (uint32 i = 0; i < 4; i++)
+  {
+    int16 candidateX = toSnorm16((floorU + (i & 1)) / SNORM16_MAX);
+    int16 candidateY = toSnorm16((floorV + (i >> 1)) / SNORM16_MAX);
+    // Squared distance rather than 1 - cos, which rounds to zero in float for every candidate.
+    Vector3 difference = decodeOctahedral(candidateX, candidateY) - target;
+    float32 error = Vector3::Dot(difference, difference);
+    if (error < bestError)
+    {
+      bestError = error;
+      x = candidateX;
+      y = candidateY;
+    }
+  }
+}
+
+Vector3 VertexCompression::decodeOctahedral(int16 x, int16 y)
+{
+  float32 u = fromSnorm16(x);
+  float32 v = fromSnorm16(y);
+  float32 z = 1.0f - std::fabs(u) - std::fabs(v);
+  float32 fold = std::max(-z, 0.0f);
+  u += u >= 0.0f ? -fold : fold;
+  v += v >= 0.0f ? -fold : fold;
+  return Vector3::Normalize(Vector3(u, v, z));
+}
+
+uint16 VertexCompression::toHalf(float32 value)
+{
+  uint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  uint32 sign = (bits >> 16) & 0x8000;
+  int32 exponent = static_cast<int32>((bits >> 23) & 0xff);
+  uint32 mantissa = bits & 0x7fffff;
+
+  if (exponent == 0xff)
+  {
+    return static_cast<uint16>(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+  }
+
+  int32 halfExponent = exponent - 127 + 15;
+  if (halfExponent >= 31)
+  {
+    return static_cast<uint16>(sign | 0x7c00);
+  }
+
+  uint32 half;
+  uint32 remainder;
+  uint32 halfway;
+  if (halfExponent <= 0)
+  {
+    // Subnormal, the implicit leading bit becomes part of the mantissa.
+    if (halfExponent < -10)
+    {
+      return static_cast<uint16>(sign);
+    }
+    mantissa |= 0x800000;
+    uint32 shift = static_cast<uint32>(14 - halfExponent);
+    half = mantissa >> shift;
+    remainder = mantissa & ((1u << shift) - 1);
+    halfway = 1u << (shift - 1);
+  }
+  else
+  {
+    half = (static_cast<uint32>(halfExponent) << 10) | (mantissa >> 13);
+    remainder = mantissa & 0x1fff;
+    halfway = 0x1000;
+  }
+
+  // A carry out of the mantissa correctly bumps the exponent, up to infinity.
+  if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+  {
+    half++;
+  }
+  return static_cast<uint16>(sign | half);
+}
+
+float32 VertexCompression::fromHalf(uint16 value)
+{
+  float32 sign = (value & 0x8000) != 0 ? -1.0f : 1.0f;
+  int32 exponent = (value >> 10) & 0x1f;
+  int32 mantissa = value & 0x3ff;
+  if (exponent == 0)
+  {
+    return sign * std::ldexp(static_cast<float32>(mantissa), -24);
+  }
+  if (exponent == 31)
+  {
+    return mantissa == 0 ? sign * std::numeric_limits<float32>::infinity() : std::numeric_limits<float32>::quiet_NaN();
+  }
+  return sign * std::ldexp(static_cast<float32>(mantissa | 0x400), exponent - 25);
+}
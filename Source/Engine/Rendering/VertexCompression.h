@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+
+#include "../Core/Maths.h"
+#include "../Core/Types.hpp"
+#include "../RenderApi/VertexLayout.hpp"
+
+/// @brief Layouts a StaticMesh can upload its vertices in.
+enum class VertexFormat : uint32
+{
+  /// @brief 32-bit floats for position, normal, texture coordinate, tangent and bitangent. 56 bytes.
+  Full,
+  /// @brief Octahedral snorm16 normal and tangent with the bitangent reduced to a sign, half float texture
+  /// coordinates and 32-bit float positions. 28 bytes. Half floats resolve texture coordinates in [0, 1] to a texel of
+  /// a 2048 texture, and lose precision the further a tiled coordinate is from zero.
+  Compact,
+  /// @brief As Compact with positions quantized to unorm16 across the mesh's bounds. 24 bytes.
+  CompactQuantized,
+  Count
+};
+
+/// @brief Number of floats per vertex in the Full layout, the layout every other format is encoded from.
+constexpr uint32 FULL_VERTEX_FLOATS = 14;
+
+/// @brief Encodes vertices in the Full layout into the compact layouts, and describes those layouts to the pipeline.
+class VertexCompression
+{
+public:
+  static uint32 getStride(VertexFormat format);
+  /// @brief The per vertex attributes of format, in the order they are interleaved.
+  static std::vector<VertexLayoutDesc> getVertexLayout(VertexFormat format);
+  /// @brief Shaders reconstruct positions as position * scale + offset, which is the identity unless positions are
+  /// quantized.
+  static void getPositionTransform(VertexFormat format, const Aabb &bounds, Vector3 &scale, Vector3 &offset);
+
+  /// @brief Encodes vertexCount vertices in the Full layout into format.
+  /// @param bounds Bounds of every position, used to quantize them for CompactQuantized.
+  static std::vector<uint8> compress(const float32 *vertices, uint32 vertexCount, VertexFormat format, const Aabb &bounds);
+
+  /// @brief Maps a unit vector onto the octahedron unfolded over [-1, 1]^2, then picks whichever of the neighbouring
+  /// snorm16 values decodes closest to it rather than simply the nearest one.
+  static void encodeOctahedral(const Vector3 &vector, int16 &x, int16 &y);
+  static Vector3 decodeOctahedral(int16 x, int16 y);
+
+  /// @brief Rounds to the nearest half float, ties to even. Values out of range become infinities.
+  static uint16 toHalf(float32 value);
+  static float32 fromHalf(uint16 value);
+};
@@ -12,7 +12,6 @@
 #include "../Maths/Radian.hpp"
 #include "../RenderApi/GL/GLTexture.hpp"
 #include "../RenderApi/RenderDevice.hpp"
-#include "../Utility/String.hpp"
 #include "ImGui/imgui.h"
 #include "ImGui/imgui_impl_glfw.h"
 #include "ImGui/imgui_impl_opengl3.h"
@@ -224,11 +223,11 @@ void UiManager::setupRenderer()
 
 	ShaderDesc vsShaderDesc;
 	vsShaderDesc.ShaderType = ShaderType::Vertex;
-	vsShaderDesc.Source = String::foadFromFile("./Shaders/Editor/UiElements.vert");
+	vsShaderDesc.FilePath = "./Shaders/Editor/UiElements.vert";
 
 	ShaderDesc psShaderDesc;
 	psShaderDesc.ShaderType = ShaderType::Fragment;
-	psShaderDesc.Source = String::foadFromFile("./Shaders/Editor/UiElements.frag");
+	psShaderDesc.FilePath = "./Shaders/Editor/UiElements.frag";
 
 	BlendStateDesc blendStateDesc;
 	blendStateDesc.RTBlendState[0].BlendEnabled = true;
@@ -0,0 +1,282 @@
+#include "BakedModel.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "MappedFile.hpp"
+
+namespace
+{
+  uint64 alignOffset(uint64 offset)
+  {
+    return (offset + BAKED_MODEL_ALIGNMENT - 1) & ~static_cast<uint64>(BAKED_MODEL_ALIGNMENT - 1);
+  }
+
+  /// @brief Builds the file contents in memory so that every offset is known before anything is written.
+  class BakedModelBuffer
+  {
+  public:
+    template <typename T>
+    uint64 append(const T *data, uint64 count)
+    {
+      uint64 offset = alignOffset(_bytes.size());
+      _bytes.resize(offset + count * sizeof(T));
+      if (count > 0)
+      {
+        std::memcpy(_bytes.data() + offset, data, count * sizeof(T));
+      }
+      return offset;
+    }
+
+    template <typename T>
+    T &at(uint64 offset) { return *reinterpret_cast<T *>(_bytes.data() + offset); }
+
+    void pad() { _bytes.resize(alignOffset(_bytes.size())); }
+    uint64 size() const { return _bytes.size(); }
+    const byte *data() const { return _bytes.data(); }
+
+  private:
+    std::vector<byte> _bytes;
+  };
+
+  class StringTable
+  {
+  public:
+    uint32 add(const std::string &value)
+    {
+      if (value.empty())
+      {
+        return BAKED_MODEL_NONE;
+      }
+      auto result = _offsets.insert({value, static_cast<uint32>(_chars.size())});
+      if (result.second)
+      {
+        _chars.insert(_chars.end(), value.begin(), value.end());
+        _chars.push_back('\0');
+      }
+      return result.first->second;
+    }
+
+    const std::vector<byte> &getChars() const { return _chars; }
+
+  private:
+    std::unordered_map<std::string, uint32> _offsets;
+    std::vector<byte> _chars;
+  };
+
+  void copyVector3(const Vector3 &source, float32 *destination)
+  {
+    destination[0] = source.X;
+    destination[1] = source.Y;
+    destination[2] = source.Z;
+  }
+}
+
+void BakedModel::write(const std::string &path, const BakedModelSource &source)
+{
+  StringTable strings;
+  BakedModelBuffer buffer;
+
+  BakedModelHeader header{};
+  header.Magic = BAKED_MODEL_MAGIC;
+  header.Version = BAKED_MODEL_VERSION;
+  header.Flags = source.Flags;
+  header.MeshCount = static_cast<uint32>(source.Meshes.size());
+  header.MaterialCount = static_cast<uint32>(source.Materials.size());
+  header.NodeCount = static_cast<uint32>(source.Nodes.size());
+  buffer.append(&header, 1);
+
+  std::vector<BakedMeshRecord> meshes(source.Meshes.size());
+  header.MeshTableOffset = buffer.append(meshes.data(), meshes.size());
+  for (uint32 i = 0; i < source.Meshes.size(); i++)
+  {
+    const auto &mesh = source.Meshes[i];
+    if (mesh.VertexStride == 0 || mesh.VertexStride % sizeof(float32) != 0 || mesh.Vertices.size() * sizeof(float32) % mesh.VertexStride != 0)
+    {
+      throw std::runtime_error("Mesh '" + mesh.Name + "' has a vertex stream which is not a whole number of vertices");
+    }
+    if (mesh.Lods.size() > MAX_MESH_LODS)
+    {
+      throw std::runtime_error("Mesh '" + mesh.Name + "' has more than " + std::to_string(MAX_MESH_LODS) + " levels of detail");
+    }
+
+    auto &record = meshes[i];
+    record.VertexOffset = buffer.append(mesh.Vertices.data(), mesh.Vertices.size());
+    record.IndexOffset = buffer.append(mesh.Indices.data(), mesh.Indices.size());
+    record.VertexCount = static_cast<uint32>(mesh.Vertices.size() * sizeof(float32) / mesh.VertexStride);
+    record.VertexStride = mesh.VertexStride;
+    record.IndexCount = static_cast<uint32>(mesh.Indices.size());
+    record.MaterialIndex = mesh.MaterialIndex;
+    record.NameOffset = strings.add(mesh.Name);
+    copyVector3(mesh.Bounds.getMin(), record.AabbMin);
+    copyVector3(mesh.Bounds.getMax(), record.AabbMax);
+    record.LodCount = static_cast<uint32>(mesh.Lods.size());
+    for (uint32 lod = 0; lod < record.LodCount; lod++)
+    {
+      record.LodIndexOffsets[lod] = mesh.Lods[lod].IndexOffset;
+      record.LodIndexCounts[lod] = mesh.Lods[lod].IndexCount;
+      record.LodErrors[lod] = mesh.Lods[lod].Error;
+    }
+  }
+
+  std::vector<BakedMaterialRecord> materials(source.Materials.size());
+  for (uint32 i = 0; i < source.Materials.size(); i++)
+  {
+    const auto &material = source.Materials[i];
+    copyVector3(material.DiffuseColour, materials[i].DiffuseColour);
+    for (uint32 slot = 0; slot < static_cast<uint32>(BakedTextureSlot::Count); slot++)
+    {
+      materials[i].TexturePathOffsets[slot] = strings.add(material.TexturePaths[slot]);
+    }
+  }
+  header.MaterialTableOffset = buffer.append(materials.data(), materials.size());
+
+  std::vector<BakedNodeRecord> nodes(source.Nodes.size());
+  for (uint32 i = 0; i < source.Nodes.size(); i++)
+  {
+    const auto &node = source.Nodes[i];
+    auto &record = nodes[i];
+    record.NameOffset = strings.add(node.Name);
+    record.Parent = node.Parent;
+    record.MeshIndex = node.MeshIndex;
+    copyVector3(node.Position, record.Position);
+    record.Rotation[0] = node.Rotation.X;
+    record.Rotation[1] = node.Rotation.Y;
+    record.Rotation[2] = node.Rotation.Z;
+    record.Rotation[3] = node.Rotation.W;
+    copyVector3(node.Scale, record.Scale);
+  }
+  header.NodeTableOffset = buffer.append(nodes.data(), nodes.size());
+
+  header.StringTableOffset = buffer.append(strings.getChars().data(), strings.getChars().size());
+  header.StringTableSize = strings.getChars().size();
+  buffer.pad();
+  header.FileSize = buffer.size();
+
+  buffer.at<BakedModelHeader>(0) = header;
+  for (uint32 i = 0; i < meshes.size(); i++)
+  {
+    buffer.at<BakedMeshRecord>(header.MeshTableOffset + i * sizeof(BakedMeshRecord)) = meshes[i];
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out)
+  {
+    throw std::runtime_error("Could not open '" + path + "' for writing");
+  }
+  out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  if (!out)
+  {
+    throw std::runtime_error("Failed to write baked model " + path);
+  }
+}
+
+BakedModel::BakedModel(const std::string &path) : _file(new MappedFile(path))
+{
+  if (_file->getSize() < sizeof(BakedModelHeader))
+  {
+    throw std::runtime_error("'" + path + "' is too small to be a baked model");
+  }
+
+  const byte *data = _file->getData();
+  _header = reinterpret_cast<const BakedModelHeader *>(data);
+  validate(path);
+
+  _meshes = reinterpret_cast<const BakedMeshRecord *>(data + _header->MeshTableOffset);
+  _materials = reinterpret_cast<const BakedMaterialRecord *>(data + _header->MaterialTableOffset);
+  _nodes = reinterpret_cast<const BakedNodeRecord *>(data + _header->NodeTableOffset);
+  _strings = data + _header->StringTableOffset;
+
+  for (uint32 i = 0; i < _header->MeshCount; i++)
+  {
+    const auto &mesh = _meshes[i];
+    uint64 vertexBytes = static_cast<uint64>(mesh.VertexCount) * mesh.VertexStride;
+    uint64 indexBytes = static_cast<uint64>(mesh.IndexCount) * sizeof(uint32);
+    if (mesh.VertexOffset % BAKED_MODEL_ALIGNMENT != 0 || mesh.VertexOffset + vertexBytes > _header->FileSize ||
+        mesh.IndexOffset % BAKED_MODEL_ALIGNMENT != 0 || mesh.IndexOffset + indexBytes > _header->FileSize)
+    {
+      throw std::runtime_error("'" + path + "' has a mesh stream outside of the file");
+    }
+    if (mesh.MaterialIndex >= _header->MaterialCount)
+    {
+      throw std::runtime_error("'" + path + "' has a mesh referencing a missing material");
+    }
+    if (mesh.LodCount > MAX_MESH_LODS)
+    {
+      throw std::runtime_error("'" + path + "' has a mesh with too many levels of detail");
+    }
+    for (uint32 lod = 0; lod < mesh.LodCount; lod++)
+    {
+      if (static_cast<uint64>(mesh.LodIndexOffsets[lod]) + mesh.LodIndexCounts[lod] > mesh.IndexCount || mesh.LodIndexCounts[lod] % 3 != 0)
+      {
+        throw std::runtime_error("'" + path + "' has a level of detail outside of its mesh's indices");
+      }
+    }
+  }
+
+  for (uint32 i = 0; i < _header->NodeCount; i++)
+  {
+    const auto &node = _nodes[i];
+    if ((node.Parent != BAKED_MODEL_NONE && node.Parent >= i) ||
+        (node.MeshIndex != BAKED_MODEL_NONE && node.MeshIndex >= _header->MeshCount))
+    {
+      throw std::runtime_error("'" + path + "' has an invalid node hierarchy");
+    }
+  }
+
+  if (_header->StringTableSize > 0 && _strings[_header->StringTableSize - 1] != '\0')
+  {
+    throw std::runtime_error("'" + path + "' has an unterminated string table");
+  }
+}
+
+void BakedModel::validate(const std::string &path) const
+{
+  if (_header->Magic != BAKED_MODEL_MAGIC)
+  {
+    throw std::runtime_error("'" + path + "' is not a baked model");
+  }
+  if (_header->Version != BAKED_MODEL_VERSION)
+  {
+    throw std::runtime_error("'" + path + "' was baked with version " + std::to_string(_header->Version) +
+                             " but version " + std::to_string(BAKED_MODEL_VERSION) + " is required, it needs to be baked again");
+  }
+  if (_header->FileSize != _file->getSize())
+  {
+    throw std::runtime_error("'" + path + "' is truncated");
+  }
+
+  auto tableFits = [this](uint64 offset, uint64 count, uint64 recordSize)
+  {
+    return offset % BAKED_MODEL_ALIGNMENT == 0 && offset <= _header->FileSize && count * recordSize <= _header->FileSize - offset;
+  };
+  if (!tableFits(_header->MeshTableOffset, _header->MeshCount, sizeof(BakedMeshRecord)) ||
+      !tableFits(_header->MaterialTableOffset, _header->MaterialCount, sizeof(BakedMaterialRecord)) ||
+      !tableFits(_header->NodeTableOffset, _header->NodeCount, sizeof(BakedNodeRecord)) ||
+      !tableFits(_header->StringTableOffset, _header->StringTableSize, 1))
+  {
+    throw std::runtime_error("'" + path + "' has a table outside of the file");
+  }
+}
+
+std::shared_ptr<const void> BakedModel::getVertexData(uint32 meshIndex) const
+{
+  // Aliasing constructor, the returned pointer shares ownership of the mapping.
+  return std::shared_ptr<const void>(_file, _file->getData() + _meshes[meshIndex].VertexOffset);
+}
+
+std::shared_ptr<const uint32> BakedModel::getIndexData(uint32 meshIndex) const
+{
+  return std::shared_ptr<const uint32>(_file, reinterpret_cast<const uint32 *>(_file->getData() + _meshes[meshIndex].IndexOffset));
+}
+
+const char *BakedModel::getString(uint32 offset) const
+{
+  if (offset == BAKED_MODEL_NONE || offset >= _header->StringTableSize)
+  {
+    return "";
+  }
+  return _strings + offset;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Core/Types.hpp"
+#include "../Geometry/MeshSimplifier.hpp"
+#include "../Maths/AABB.hpp"
+#include "../Maths/Quaternion.hpp"
+#include "../Maths/Vector3.hpp"
+
+class MappedFile;
+
+// The container is little endian and every table and stream starts on a BAKED_MODEL_ALIGNMENT boundary, so records
+// and streams are read in place from the mapped file.
+constexpr uint32 BAKED_MODEL_MAGIC = 0x4c444d46; // "FMDL"
+constexpr uint32 BAKED_MODEL_VERSION = 2;
+constexpr uint32 BAKED_MODEL_ALIGNMENT = 16;
+constexpr uint32 BAKED_MODEL_NONE = 0xffffffff;
+
+enum BakedModelFlags : uint32
+{
+  /// @brief Mesh vertices were recentred on their centroid, with the offset moved into the owning node.
+  BMF_ReconstructedWorldTransforms = 1 << 0
+};
+
+enum class BakedTextureSlot : uint32
+{
+  Diffuse,
+  Normal,
+  Metallic,
+  Roughness,
+  Opacity,
+  Count
+};
+
+struct BakedModelHeader
+{
+  uint32 Magic;
+  uint32 Version;
+  uint32 Flags;
+  uint32 MeshCount;
+  uint32 MaterialCount;
+  uint32 NodeCount;
+  uint64 MeshTableOffset;
+  uint64 MaterialTableOffset;
+  uint64 NodeTableOffset;
+  uint64 StringTableOffset;
+  uint64 StringTableSize;
+  uint64 FileSize;
+  uint64 Reserved;
+};
+
+struct BakedMeshRecord
+{
+  uint64 VertexOffset;
+  uint64 IndexOffset;
+  uint32 VertexCount;
+  /// @brief Bytes per vertex of the interleaved stream, laid out as StaticMesh uploads it.
+  uint32 VertexStride;
+  uint32 IndexCount;
+  uint32 MaterialIndex;
+  uint32 NameOffset;
+  float32 AabbMin[3];
+  float32 AabbMax[3];
+  /// @brief Levels of detail as ranges of the index stream, the first being the whole mesh. 0 when it has none.
+  uint32 LodCount;
+  uint32 LodIndexOffsets[MAX_MESH_LODS];
+  uint32 LodIndexCounts[MAX_MESH_LODS];
+  float32 LodErrors[MAX_MESH_LODS];
+};
+
+struct BakedMaterialRecord
+{
+  float32 DiffuseColour[3];
+  /// @brief String table offsets of texture paths relative to the source model's folder, BAKED_MODEL_NONE if unset.
+  uint32 TexturePathOffsets[static_cast<uint32>(BakedTextureSlot::Count)];
+};
+
+struct BakedNodeRecord
+{
+  uint32 NameOffset;
+  /// @brief Index of the parent node, which always precedes its children. BAKED_MODEL_NONE for the root.
+  uint32 Parent;
+  uint32 MeshIndex;
+  float32 Position[3];
+  float32 Rotation[4];
+  float32 Scale[3];
+};
+
+static_assert(sizeof(BakedModelHeader) % BAKED_MODEL_ALIGNMENT == 0, "Baked model header must keep the tables aligned");
+static_assert(sizeof(BakedMeshRecord) % 8 == 0, "Baked mesh records must keep 64 bit offsets aligned");
+
+/// @brief In memory description of a model, written out by BakedModel::write.
+struct BakedModelSource
+{
+  struct Mesh
+  {
+    std::string Name;
+    std::vector<float32> Vertices;
+    uint32 VertexStride = 0;
+    std::vector<uint32> Indices;
+    std::vector<MeshLod> Lods;
+    Aabb Bounds;
+    uint32 MaterialIndex = 0;
+  };
+
+  struct Material
+  {
+    Vector3 DiffuseColour;
+    std::string TexturePaths[static_cast<uint32>(BakedTextureSlot::Count)];
+  };
+
+  struct Node
+  {
+    std::string Name;
+    uint32 Parent = BAKED_MODEL_NONE;
+    uint32 MeshIndex = BAKED_MODEL_NONE;
+    Vector3 Position = Vector3::Zero;
+    Quaternion Rotation = Quaternion::Identity;
+    Vector3 Scale = Vector3(1.0f);
+  };
+
+  uint32 Flags = 0;
+  std::vector<Mesh> Meshes;
+  std::vector<Material> Materials;
+  std::vector<Node> Nodes;
+};
+
+/// @brief A baked model file mapped into memory. Every table is validated on open, after which records and streams
+/// are returned as pointers into the mapping with no further copies.
+class BakedModel
+{
+public:
+  static void write(const std::string &path, const BakedModelSource &source);
+
+  /// @brief Maps and validates the file at path, throwing if it is not a baked model of the current version.
+  BakedModel(const std::string &path);
+
+  const BakedModelHeader &getHeader() const { return *_header; }
+  const BakedMeshRecord &getMesh(uint32 index) const { return _meshes[index]; }
+  const BakedMaterialRecord &getMaterial(uint32 index) const { return _materials[index]; }
+  const BakedNodeRecord &getNode(uint32 index) const { return _nodes[index]; }
+
+  /// @brief The vertex stream of a mesh. The pointer keeps the file mapped for as long as it is held.
+  std::shared_ptr<const void> getVertexData(uint32 meshIndex) const;
+  std::shared_ptr<const uint32> getIndexData(uint32 meshIndex) const;
+  /// @brief Returns an empty string for BAKED_MODEL_NONE.
+  const char *getString(uint32 offset) const;
+
+private:
+  void validate(const std::string &path) const;
+
+  std::shared_ptr<MappedFile> _file;
+  const BakedModelHeader *_header;
+  const BakedMeshRecord *_meshes;
+  const BakedMaterialRecord *_materials;
+  const BakedNodeRecord *_nodes;
+  const char *_strings;
+};
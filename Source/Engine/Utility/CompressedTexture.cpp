@@ -0,0 +1,144 @@
+#include "CompressedTexture.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include "MappedFile.hpp"
+
+namespace
+{
+  uint64 alignOffset(uint64 offset)
+  {
+    return (offset + COMPRESSED_TEXTURE_ALIGNMENT - 1) & ~static_cast<uint64>(COMPRESSED_TEXTURE_ALIGNMENT - 1);
+  }
+}
+
+void CompressedTexture::write(const std::string &path, const CompressedTextureSource &source)
+{
+  if (!Texture::isBlockCompressed(source.Format) || source.Mips.empty())
+  {
+    throw std::runtime_error("Compressed textures need a block compressed format and at least one mip level");
+  }
+
+  CompressedTextureHeader header{};
+  header.Magic = COMPRESSED_TEXTURE_MAGIC;
+  header.Version = COMPRESSED_TEXTURE_VERSION;
+  header.Format = static_cast<uint32>(source.Format);
+  header.Flags = source.Flags;
+  header.Width = source.Width;
+  header.Height = source.Height;
+  header.MipCount = static_cast<uint32>(source.Mips.size());
+  header.SourceHash = source.SourceHash;
+
+  std::vector<CompressedMipRecord> mips(source.Mips.size());
+  uint64 offset = alignOffset(sizeof(CompressedTextureHeader) + mips.size() * sizeof(CompressedMipRecord));
+  for (uint32 i = 0; i < mips.size(); i++)
+  {
+    uint32 width = std::max(source.Width >> i, 1u);
+    uint32 height = std::max(source.Height >> i, 1u);
+    if (source.Mips[i].size() != Texture::getCompressedSize(source.Format, width, height))
+    {
+      throw std::runtime_error("Mip " + std::to_string(i) + " does not match the size of its level");
+    }
+    mips[i].Offset = offset;
+    mips[i].Size = source.Mips[i].size();
+    offset = alignOffset(offset + mips[i].Size);
+  }
+  header.FileSize = offset;
+
+  // Unique per thread so that concurrent loaders encoding the same texture never write into each other's file.
+  std::string temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+  {
+    std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+      throw std::runtime_error("Could not open '" + temporaryPath + "' for writing");
+    }
+    out.write(reinterpret_cast<const byte *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const byte *>(mips.data()), static_cast<std::streamsize>(mips.size() * sizeof(CompressedMipRecord)));
+    for (uint32 i = 0; i < mips.size(); i++)
+    {
+      out.seekp(static_cast<std::streamoff>(mips[i].Offset));
+      out.write(reinterpret_cast<const byte *>(source.Mips[i].data()), static_cast<std::streamsize>(mips[i].Size));
+    }
+    // Pads the file out to its recorded size.
+    if (header.FileSize > mips.back().Offset + mips.back().Size)
+    {
+      out.seekp(static_cast<std::streamoff>(header.FileSize - 1));
+      out.put('\0');
+    }
+    if (!out)
+    {
+      throw std::runtime_error("Failed to write compressed texture " + temporaryPath);
+    }
+  }
+
+#ifdef _WIN32
+  // Unlike POSIX, rename will not replace an existing file on Windows.
+  std::remove(path.c_str());
+#endif
+  if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+  {
+    std::remove(temporaryPath.c_str());
+    throw std::runtime_error("Could not move compressed texture into place at " + path);
+  }
+}
+
+CompressedTexture::CompressedTexture(const std::string &path) : _file(new MappedFile(path))
+{
+  if (_file->getSize() < sizeof(CompressedTextureHeader))
+  {
+    throw std::runtime_error("'" + path + "' is too small to be a compressed texture");
+  }
+
+  _header = reinterpret_cast<const CompressedTextureHeader *>(_file->getData());
+  if (_header->Magic != COMPRESSED_TEXTURE_MAGIC)
+  {
+    throw std::runtime_error("'" + path + "' is not a compressed texture");
+  }
+  if (_header->Version != COMPRESSED_TEXTURE_VERSION)
+  {
+    throw std::runtime_error("'" + path + "' was encoded with version " + std::to_string(_header->Version) +
+                             " but version " + std::to_string(COMPRESSED_TEXTURE_VERSION) + " is required");
+  }
+  if (_header->FileSize != _file->getSize() || _header->MipCount == 0 ||
+      sizeof(CompressedTextureHeader) + static_cast<uint64>(_header->MipCount) * sizeof(CompressedMipRecord) > _header->FileSize)
+  {
+    throw std::runtime_error("'" + path + "' is truncated");
+  }
+  if (!Texture::isBlockCompressed(getFormat()))
+  {
+    throw std::runtime_error("'" + path + "' does not hold a block compressed format");
+  }
+
+  _mips = reinterpret_cast<const CompressedMipRecord *>(_file->getData() + sizeof(CompressedTextureHeader));
+  for (uint32 i = 0; i < _header->MipCount; i++)
+  {
+    uint32 width = std::max(_header->Width >> i, 1u);
+    uint32 height = std::max(_header->Height >> i, 1u);
+    if (_mips[i].Offset % COMPRESSED_TEXTURE_ALIGNMENT != 0 || _mips[i].Offset > _header->FileSize ||
+        _mips[i].Size > _header->FileSize - _mips[i].Offset ||
+        _mips[i].Size != Texture::getCompressedSize(getFormat(), width, height))
+    {
+      throw std::runtime_error("'" + path + "' has a mip level outside of the file");
+    }
+  }
+}
+
+const ubyte *CompressedTexture::getMipData(uint32 mipLevel) const
+{
+  return reinterpret_cast<const ubyte *>(_file->getData() + _mips[mipLevel].Offset);
+}
+
+uint64 CompressedTexture::getDataSize() const
+{
+  uint64 size = 0;
+  for (uint32 i = 0; i < _header->MipCount; i++)
+  {
+    size += _mips[i].Size;
+  }
+  return size;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Core/Types.hpp"
+#include "../RenderApi/Texture.hpp"
+
+class MappedFile;
+
+// Laid out like the baked model container: little endian, with every mip starting on a
+// COMPRESSED_TEXTURE_ALIGNMENT boundary so it is uploaded straight from the mapping.
+constexpr uint32 COMPRESSED_TEXTURE_MAGIC = 0x58455446; // "FTEX"
+constexpr uint32 COMPRESSED_TEXTURE_VERSION = 1;
+constexpr uint32 COMPRESSED_TEXTURE_ALIGNMENT = 16;
+constexpr const char *COMPRESSED_TEXTURE_EXTENSION = ".ftex";
+
+enum CompressedTextureFlags : uint32
+{
+  CTF_SRgb = 1 << 0
+};
+
+struct CompressedTextureHeader
+{
+  uint32 Magic;
+  uint32 Version;
+  /// @brief A block compressed TextureFormat.
+  uint32 Format;
+  uint32 Flags;
+  uint32 Width;
+  uint32 Height;
+  uint32 MipCount;
+  uint32 Reserved;
+  /// @brief Hash of the source image file the texture was encoded from.
+  uint64 SourceHash;
+  uint64 FileSize;
+};
+
+struct CompressedMipRecord
+{
+  uint64 Offset;
+  uint64 Size;
+};
+
+static_assert(sizeof(CompressedTextureHeader) % COMPRESSED_TEXTURE_ALIGNMENT == 0, "Compressed texture header must keep the mip table aligned");
+
+struct CompressedTextureSource
+{
+  TextureFormat Format = TextureFormat::BC1;
+  uint32 Flags = 0;
+  uint32 Width = 0;
+  uint32 Height = 0;
+  uint64 SourceHash = 0;
+  /// @brief Encoded blocks of each mip level, largest first.
+  std::vector<std::vector<ubyte>> Mips;
+};
+
+/// @brief A block compressed mip chain mapped from disk, validated on open.
+class CompressedTexture
+{
+public:
+  /// @brief Writes to a temporary file which is then renamed over path, so readers never see a partial file.
+  static void write(const std::string &path, const CompressedTextureSource &source);
+
+  CompressedTexture(const std::string &path);
+
+  const CompressedTextureHeader &getHeader() const { return *_header; }
+  TextureFormat getFormat() const { return static_cast<TextureFormat>(_header->Format); }
+  uint32 getMipCount() const { return _header->MipCount; }
+  bool isSRgb() const { return (_header->Flags & CTF_SRgb) != 0; }
+
+  const ubyte *getMipData(uint32 mipLevel) const;
+  uint64 getMipSize(uint32 mipLevel) const { return _mips[mipLevel].Size; }
+  /// @brief Bytes of every mip level together.
+  uint64 getDataSize() const;
+
+private:
+  std::shared_ptr<MappedFile> _file;
+  const CompressedTextureHeader *_header;
+  const CompressedMipRecord *_mips;
+};
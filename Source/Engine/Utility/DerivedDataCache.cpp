@@ -0,0 +1,201 @@
+#include "DerivedDataCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+
+namespace
+{
+  const std::string DERIVED_DATA_CACHE_DIRECTORY = "./Cache/DerivedData";
+  constexpr uint64 DERIVED_DATA_CACHE_CAPACITY = 2ull * 1024 * 1024 * 1024;
+  // Trimming goes a little below capacity so that a cache sitting at its limit is not trimmed on every write.
+  constexpr float64 DERIVED_DATA_CACHE_TRIM_RATIO = 0.9;
+  const std::string TEMPORARY_EXTENSION = ".tmp";
+
+  uint64 getProcessId()
+  {
+#ifdef _WIN32
+    return static_cast<uint64>(_getpid());
+#else
+    return static_cast<uint64>(getpid());
+#endif
+  }
+}
+
+DerivedDataCache &DerivedDataCache::get()
+{
+  static DerivedDataCache cache(DERIVED_DATA_CACHE_DIRECTORY, DERIVED_DATA_CACHE_CAPACITY);
+  return cache;
+}
+
+uint64 DerivedDataCache::hashFile(const std::string &path)
+{
+  MappedFile file(path);
+  return Hash::fnv1a(file.getData(), file.getSize());
+}
+
+uint64 DerivedDataCache::createKey(uint64 sourceHash, const void *settings, uint64 settingsSize)
+{
+  return Hash::fnv1a(settings, settingsSize, sourceHash);
+}
+
+DerivedDataCache::DerivedDataCache(const std::string &directory, uint64 capacity) : _directory(directory), _capacity(capacity)
+{
+}
+
+void DerivedDataCache::setDirectory(const std::string &directory)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _directory = directory;
+}
+
+void DerivedDataCache::setCapacity(uint64 capacity)
+{
+  _capacity = capacity;
+}
+
+std::string DerivedDataCache::getDirectory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _directory;
+}
+
+std::string DerivedDataCache::getEntryPath(uint64 key, const std::string &extension) const
+{
+  char name[17];
+  std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+  return getDirectory() + "/" + name + extension;
+}
+
+std::string DerivedDataCache::store(uint64 key, const std::string &extension, const std::function<void(const std::string &temporaryPath)> &write)
+{
+  std::string path = getEntryPath(key, extension);
+  // Unique across processes as well as threads, since several applications may derive the same entry at once.
+  std::string temporaryPath = path + "." + std::to_string(getProcessId()) + "." +
+                              std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + TEMPORARY_EXTENSION;
+
+  std::error_code error;
+  std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+  try
+  {
+    write(temporaryPath);
+  }
+  catch (...)
+  {
+    std::remove(temporaryPath.c_str());
+    throw;
+  }
+
+#ifdef _WIN32
+  // Unlike POSIX, rename will not replace an existing file on Windows.
+  std::remove(path.c_str());
+#endif
+  if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+  {
+    std::remove(temporaryPath.c_str());
+    throw std::runtime_error("Could not move cache entry into place at " + path);
+  }
+
+  _bytesWritten.fetch_add(std::filesystem::file_size(path, error), std::memory_order_relaxed);
+  trim();
+  return path;
+}
+
+DerivedDataCacheStats DerivedDataCache::getStats() const
+{
+  DerivedDataCacheStats stats;
+  stats.Hits = _hits.load(std::memory_order_relaxed);
+  stats.Misses = _misses.load(std::memory_order_relaxed);
+  stats.BytesSaved = _bytesSaved.load(std::memory_order_relaxed);
+  stats.BytesWritten = _bytesWritten.load(std::memory_order_relaxed);
+  stats.Evictions = _evictions.load(std::memory_order_relaxed);
+  return stats;
+}
+
+bool DerivedDataCache::exists(const std::string &path) const
+{
+  std::error_code error;
+  return std::filesystem::is_regular_file(path, error);
+}
+
+void DerivedDataCache::recordHit(const std::string &path)
+{
+  std::error_code error;
+  // The write time doubles as the last use time, so that trimming in any process sees which entries are still used.
+  std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+  uint64 size = std::filesystem::file_size(path, error);
+  _hits.fetch_add(1, std::memory_order_relaxed);
+  _bytesSaved.fetch_add(error ? 0 : size, std::memory_order_relaxed);
+}
+
+void DerivedDataCache::remove(const std::string &path)
+{
+  std::error_code error;
+  std::filesystem::remove(path, error);
+}
+
+void DerivedDataCache::trim()
+{
+  struct Entry
+  {
+    std::filesystem::path Path;
+    std::filesystem::file_time_type LastUse;
+    uint64 Size;
+  };
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::error_code error;
+  std::vector<Entry> entries;
+  uint64 totalSize = 0;
+  for (std::filesystem::directory_iterator iter(_directory, error), end; !error && iter != end; iter.increment(error))
+  {
+    // Temporary files belong to writes still in progress.
+    if (!iter->is_regular_file(error) || iter->path().extension() == TEMPORARY_EXTENSION)
+    {
+      continue;
+    }
+    Entry entry{iter->path(), iter->last_write_time(error), iter->file_size(error)};
+    if (!error)
+    {
+      totalSize += entry.Size;
+      entries.push_back(entry);
+    }
+    error.clear();
+  }
+
+  uint64 capacity = _capacity;
+  if (totalSize <= capacity)
+  {
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+            { return a.LastUse < b.LastUse; });
+  uint64 targetSize = static_cast<uint64>(capacity * DERIVED_DATA_CACHE_TRIM_RATIO);
+  for (const auto &entry : entries)
+  {
+    if (totalSize <= targetSize)
+    {
+      break;
+    }
+    // Fails on Windows while another process has the entry mapped, in which case it is left for a later trim.
+    if (std::filesystem::remove(entry.Path, error))
+    {
+      totalSize -= entry.Size;
+      _evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    error.clear();
+  }
+}
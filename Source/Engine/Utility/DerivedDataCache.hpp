@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "../Core/Types.hpp"
+
+struct DerivedDataCacheStats
+{
+  uint64 Hits = 0;
+  uint64 Misses = 0;
+  /// @brief Bytes of entries reused rather than derived again.
+  uint64 BytesSaved = 0;
+  uint64 BytesWritten = 0;
+  uint64 Evictions = 0;
+};
+
+/// @brief On disk store of data derived from source assets, such as encoded textures and baked models. Entries are
+/// named by a hash of the source file's contents and the settings used to derive them, so every process pointed at the
+/// same directory shares them. Entries are written to a temporary file and renamed into place, so readers only ever
+/// see whole entries, and are read through memory mapping by the caller. Once the directory grows past its capacity
+/// the least recently used entries are removed.
+class DerivedDataCache
+{
+public:
+  /// @brief The cache used by the asset loaders, in ./Cache/DerivedData with a 2 GB capacity by default.
+  static DerivedDataCache &get();
+
+  static uint64 hashFile(const std::string &path);
+  /// @brief Combines a source hash with every setting that changes the derived result.
+  static uint64 createKey(uint64 sourceHash, const void *settings, uint64 settingsSize);
+
+  DerivedDataCache(const std::string &directory, uint64 capacity);
+
+  /// @brief Both only affect lookups and writes made afterwards.
+  void setDirectory(const std::string &directory);
+  void setCapacity(uint64 capacity);
+  std::string getDirectory() const;
+  uint64 getCapacity() const { return _capacity; }
+
+  std::string getEntryPath(uint64 key, const std::string &extension) const;
+
+  /// @brief Opens the entry through open, returning null if there is none. Entries which open throws on are removed
+  /// and counted as misses, so damaged or outdated entries are derived again.
+  template <typename T>
+  std::shared_ptr<T> load(uint64 key, const std::string &extension, const std::function<std::shared_ptr<T>(const std::string &path)> &open);
+
+  /// @brief Calls write with a temporary path to fill, then moves the result into place and trims the cache back
+  /// under its capacity. Returns the entry's path.
+  std::string store(uint64 key, const std::string &extension, const std::function<void(const std::string &temporaryPath)> &write);
+
+  DerivedDataCacheStats getStats() const;
+
+private:
+  bool exists(const std::string &path) const;
+  void recordHit(const std::string &path);
+  void recordMiss() { _misses.fetch_add(1, std::memory_order_relaxed); }
+  void remove(const std::string &path);
+  void trim();
+
+  mutable std::mutex _mutex;
+  std::string _directory;
+  std::atomic<uint64> _capacity;
+  std::atomic<uint64> _hits{0};
+  std::atomic<uint64> _misses{0};
+  std::atomic<uint64> _bytesSaved{0};
+  std::atomic<uint64> _bytesWritten{0};
+  std::atomic<uint64> _evictions{0};
+};
+
+template <typename T>
+std::shared_ptr<T> DerivedDataCache::load(uint64 key, const std::string &extension, const std::function<std::shared_ptr<T>(const std::string &path)> &open)
+{
+  std::string path = getEntryPath(key, extension);
+  if (exists(path))
+  {
+    try
+    {
+      std::shared_ptr<T> entry = open(path);
+      recordHit(path);
+      return entry;
+    }
+    catch (const std::exception &)
+    {
+      remove(path);
+    }
+  }
+  recordMiss();
+  return nullptr;
+}
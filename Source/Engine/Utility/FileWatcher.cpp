@@ -0,0 +1,172 @@
+#include "FileWatcher.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+const std::chrono::milliseconds FileWatcher::POLL_INTERVAL(250);
+
+namespace
+{
+  std::string getDirectory(const std::string &normalizedPath)
+  {
+    return std::filesystem::path(normalizedPath).parent_path().string();
+  }
+
+  std::filesystem::file_time_type getWriteTime(const std::string &path)
+  {
+    std::error_code error;
+    auto writeTime = std::filesystem::last_write_time(path, error);
+    return error ? std::filesystem::file_time_type::min() : writeTime;
+  }
+}
+
+FileWatcher::FileWatcher() : _lastPoll(std::chrono::steady_clock::now()), _inotify(-1)
+{
+#ifdef __linux__
+  _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+  if (_inotify >= 0)
+  {
+    close(_inotify);
+  }
+#endif
+}
+
+std::string FileWatcher::normalize(const std::string &path)
+{
+  std::error_code error;
+  std::filesystem::path normalized = std::filesystem::weakly_canonical(path, error);
+  if (error)
+  {
+    normalized = std::filesystem::absolute(path, error).lexically_normal();
+  }
+  return normalized.string();
+}
+
+void FileWatcher::watch(const std::string &path)
+{
+  std::string normalized = normalize(path);
+  if (_files.count(normalized) != 0)
+  {
+    return;
+  }
+  addDirectory(getDirectory(normalized));
+  _files[normalized] = getWriteTime(normalized);
+}
+
+void FileWatcher::unwatch(const std::string &path)
+{
+  std::string normalized = normalize(path);
+  if (_files.erase(normalized) != 0)
+  {
+    removeDirectory(getDirectory(normalized));
+  }
+}
+
+bool FileWatcher::isWatching(const std::string &path) const
+{
+  return _files.count(normalize(path)) != 0;
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+  std::vector<std::string> changes;
+#ifdef __linux__
+  if (_inotify >= 0)
+  {
+    alignas(inotify_event) byte buffer[4096];
+    for (;;)
+    {
+      ssize_t length = read(_inotify, buffer, sizeof(buffer));
+      if (length <= 0)
+      {
+        break;
+      }
+      for (ssize_t offset = 0; offset < length;)
+      {
+        const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+        offset += sizeof(inotify_event) + event->len;
+
+        auto directory = _descriptorDirectories.find(event->wd);
+        if (directory == _descriptorDirectories.end() || event->len == 0)
+        {
+          continue;
+        }
+        std::string path = (std::filesystem::path(directory->second) / event->name).string();
+        if (_files.count(path) != 0 && std::find(changes.begin(), changes.end(), path) == changes.end())
+        {
+          changes.push_back(path);
+        }
+      }
+    }
+    return changes;
+  }
+#endif
+
+  auto now = std::chrono::steady_clock::now();
+  if (now - _lastPoll < POLL_INTERVAL)
+  {
+    return changes;
+  }
+  _lastPoll = now;
+  for (auto &file : _files)
+  {
+    auto writeTime = getWriteTime(file.first);
+    if (writeTime != file.second)
+    {
+      file.second = writeTime;
+      changes.push_back(file.first);
+    }
+  }
+  return changes;
+}
+
+void FileWatcher::addDirectory(const std::string &directory)
+{
+  WatchedDirectory &watched = _directories[directory];
+  if (watched.FileCount++ > 0)
+  {
+    return;
+  }
+#ifdef __linux__
+  if (_inotify >= 0)
+  {
+    // Close write covers files saved in place, moved to covers files saved elsewhere and renamed over the original.
+    watched.Descriptor = inotify_add_watch(_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watched.Descriptor < 0)
+    {
+      _directories.erase(directory);
+      throw std::runtime_error("Could not watch directory " + directory);
+    }
+    _descriptorDirectories[watched.Descriptor] = directory;
+  }
+#endif
+}
+
+void FileWatcher::removeDirectory(const std::string &directory)
+{
+  auto iter = _directories.find(directory);
+  if (iter == _directories.end() || --iter->second.FileCount > 0)
+  {
+    return;
+  }
+#ifdef __linux__
+  if (iter->second.Descriptor >= 0)
+  {
+    inotify_rm_watch(_inotify, iter->second.Descriptor);
+    _descriptorDirectories.erase(iter->second.Descriptor);
+  }
+#endif
+  _directories.erase(iter);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../Core/Types.hpp"
+
+/// @brief Reports files which changed on disk. On Linux the directories holding watched files are registered with
+/// inotify, so polling is a single non-blocking read. Elsewhere the files' write times are compared, at most every
+/// POLL_INTERVAL. Files may be replaced by a rename, as editors which save atomically do, and still be reported.
+class FileWatcher
+{
+public:
+  FileWatcher();
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  /// @brief The absolute form of path that changes are reported under, so that differently spelled paths to the same
+  /// file compare equal.
+  static std::string normalize(const std::string &path);
+
+  /// @brief Starts reporting changes to the file at path. The file need not exist yet, but its directory must.
+  void watch(const std::string &path);
+  void unwatch(const std::string &path);
+  bool isWatching(const std::string &path) const;
+
+  /// @brief Normalised paths of watched files written, created or renamed into place since the last call, each once.
+  std::vector<std::string> poll();
+
+private:
+  static const std::chrono::milliseconds POLL_INTERVAL;
+
+  struct WatchedDirectory
+  {
+    int32 Descriptor = -1;
+    uint32 FileCount = 0;
+  };
+
+  void addDirectory(const std::string &directory);
+  void removeDirectory(const std::string &directory);
+
+  // Last write time of each watched file, only compared when inotify is unavailable.
+  std::unordered_map<std::string, std::filesystem::file_time_type> _files;
+  std::unordered_map<std::string, WatchedDirectory> _directories;
+  std::unordered_map<int32, std::string> _descriptorDirectories;
+  std::chrono::steady_clock::time_point _lastPoll;
+  int32 _inotify;
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include <functional>
 
+#include "../Core/Types.hpp"
+
 class Hash
 {
 public:
@@ -10,4 +12,17 @@ public:
     std::hash<T> hasher;
     seed ^= hasher(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
   }
+
+  /// @brief 64 bit FNV-1a, stable across platforms and runs so it can key data written to disk.
+  static inline uint64 fnv1a(const void *data, uint64 size, uint64 seed = 0xcbf29ce484222325ull)
+  {
+    const ubyte *bytes = static_cast<const ubyte *>(data);
+    uint64 hash = seed;
+    for (uint64 i = 0; i < size; i++)
+    {
+      hash ^= bytes[i];
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
 };
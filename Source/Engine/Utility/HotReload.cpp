@@ -0,0 +1,162 @@
+#include "HotReload.hpp"
+
+#include <algorithm>
+#include <exception>
+
+HotReload &HotReload::get()
+{
+  static HotReload hotReload;
+  return hotReload;
+}
+
+HotReload::HotReload() : _nextId(1), _reloadCount(0), _enabled(true)
+{
+}
+
+uint64 HotReload::track(const std::vector<std::string> &files, const std::function<bool()> &reload)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  uint64 id = _nextId++;
+  _entries[id].Reload = reload;
+  addFiles(id, files);
+  return id;
+}
+
+void HotReload::setFiles(uint64 id, const std::vector<std::string> &files)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_entries.count(id) != 0)
+  {
+    removeFiles(id);
+    addFiles(id, files);
+  }
+}
+
+void HotReload::untrack(uint64 id)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_entries.count(id) != 0)
+  {
+    removeFiles(id);
+    _entries.erase(id);
+  }
+}
+
+void HotReload::update()
+{
+  // Reloads run unlocked, as they may track or retarget assets of their own.
+  std::vector<std::pair<uint64, std::function<bool()>>> reloads;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<std::string> changes = _watcher.poll();
+    if (!_enabled)
+    {
+      return;
+    }
+
+    std::vector<uint64> ids;
+    for (const auto &path : changes)
+    {
+      auto dependents = _dependents.find(path);
+      if (dependents != _dependents.end())
+      {
+        ids.insert(ids.end(), dependents->second.begin(), dependents->second.end());
+      }
+    }
+    // In the order the assets were tracked, so that an asset built from another reloads after it.
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    for (uint64 id : ids)
+    {
+      reloads.push_back({id, _entries[id].Reload});
+    }
+  }
+
+  for (const auto &reload : reloads)
+  {
+    try
+    {
+      if (!reload.second())
+      {
+        untrack(reload.first);
+        continue;
+      }
+      _reloadCount++;
+    }
+    catch (const std::exception &exception)
+    {
+      reportError(exception.what());
+    }
+  }
+}
+
+uint64 HotReload::getTrackedCount() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+void HotReload::reportError(const std::string &error)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _errors.push_back(error);
+  if (_errors.size() > MAX_ERRORS)
+  {
+    _errors.pop_front();
+  }
+}
+
+std::vector<std::string> HotReload::getErrors() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return std::vector<std::string>(_errors.begin(), _errors.end());
+}
+
+void HotReload::clearErrors()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _errors.clear();
+}
+
+void HotReload::addFiles(uint64 id, const std::vector<std::string> &files)
+{
+  Entry &entry = _entries[id];
+  for (const auto &file : files)
+  {
+    std::string path = FileWatcher::normalize(file);
+    if (std::find(entry.Files.begin(), entry.Files.end(), path) != entry.Files.end())
+    {
+      continue;
+    }
+    if (_dependents.count(path) == 0)
+    {
+      // Assets load the same whether or not their files can be watched.
+      try
+      {
+        _watcher.watch(path);
+      }
+      catch (const std::exception &)
+      {
+        continue;
+      }
+    }
+    _dependents[path].push_back(id);
+    entry.Files.push_back(path);
+  }
+}
+
+void HotReload::removeFiles(uint64 id)
+{
+  Entry &entry = _entries[id];
+  for (const auto &path : entry.Files)
+  {
+    auto dependents = _dependents.find(path);
+    dependents->second.erase(std::remove(dependents->second.begin(), dependents->second.end(), id), dependents->second.end());
+    if (dependents->second.empty())
+    {
+      _watcher.unwatch(path);
+      _dependents.erase(dependents);
+    }
+  }
+  entry.Files.clear();
+}
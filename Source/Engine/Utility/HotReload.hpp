@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../Core/Types.hpp"
+#include "FileWatcher.hpp"
+
+/// @brief Rebuilds assets whose source files change on disk while the application runs. Each tracked asset names the
+/// files it is built from, such as a shader and every header it includes, and a change to any of them reloads every
+/// asset depending on it once. Assets are rebuilt in place so that whatever uses them keeps its state.
+class HotReload
+{
+public:
+  /// @brief Errors kept for display, oldest first.
+  static constexpr uint32 MAX_ERRORS = 8;
+
+  /// @brief The instance the asset loaders track their assets with.
+  static HotReload &get();
+
+  HotReload();
+
+  /// @brief Calls reload from update whenever one of files changes, until reload returns false to say that the asset
+  /// no longer exists. Safe to call from any thread.
+  /// @return Identifies the asset to setFiles and untrack.
+  uint64 track(const std::vector<std::string> &files, const std::function<bool()> &reload);
+  /// @brief Replaces the files an asset depends on, for assets whose dependencies change as they reload.
+  void setFiles(uint64 id, const std::vector<std::string> &files);
+  void untrack(uint64 id);
+
+  /// @brief Reloads every asset depending on a file changed since the last call, on the calling thread. An asset whose
+  /// reload throws is left as it was and its error is kept, so that a typo in a shader does not end the session.
+  void update();
+
+  /// @brief While disabled, changes are ignored rather than queued.
+  void setEnabled(bool enabled) { _enabled = enabled; }
+  bool isEnabled() const { return _enabled; }
+
+  uint64 getTrackedCount() const;
+  uint64 getReloadCount() const { return _reloadCount; }
+  /// @brief Keeps an error from a reload finished elsewhere, such as on a loading job, alongside those update caught.
+  void reportError(const std::string &error);
+  std::vector<std::string> getErrors() const;
+  void clearErrors();
+
+private:
+  struct Entry
+  {
+    std::vector<std::string> Files;
+    std::function<bool()> Reload;
+  };
+
+  void addFiles(uint64 id, const std::vector<std::string> &files);
+  void removeFiles(uint64 id);
+
+  mutable std::mutex _mutex;
+  FileWatcher _watcher;
+  std::unordered_map<uint64, Entry> _entries;
+  // Ids of the assets depending on each normalised file path.
+  std::unordered_map<std::string, std::vector<uint64>> _dependents;
+  std::deque<std::string> _errors;
+  uint64 _nextId;
+  std::atomic<uint64> _reloadCount;
+  std::atomic<bool> _enabled;
+};
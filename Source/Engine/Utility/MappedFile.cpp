@@ -0,0 +1,112 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path) : _data(nullptr),
+                                                  _size(0),
+                                                  _fileHandle(INVALID_HANDLE_VALUE),
+                                                  _mappingHandle(nullptr)
+{
+  _fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (_fileHandle == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error("Failed to open file " + path);
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(_fileHandle, &fileSize))
+  {
+    CloseHandle(_fileHandle);
+    throw std::runtime_error("Failed to read the size of file " + path);
+  }
+  _size = static_cast<uint64>(fileSize.QuadPart);
+  if (_size == 0)
+  {
+    return;
+  }
+
+  _mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (_mappingHandle != nullptr)
+  {
+    _data = static_cast<const byte *>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  }
+  if (_data == nullptr)
+  {
+    if (_mappingHandle != nullptr)
+    {
+      CloseHandle(_mappingHandle);
+    }
+    CloseHandle(_fileHandle);
+    throw std::runtime_error("Failed to map file " + path);
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  if (_data != nullptr)
+  {
+    UnmapViewOfFile(_data);
+  }
+  if (_mappingHandle != nullptr)
+  {
+    CloseHandle(_mappingHandle);
+  }
+  CloseHandle(_fileHandle);
+}
+#else
+MappedFile::MappedFile(const std::string &path) : _data(nullptr),
+                                                  _size(0),
+                                                  _fileDescriptor(-1)
+{
+  _fileDescriptor = open(path.c_str(), O_RDONLY);
+  if (_fileDescriptor < 0)
+  {
+    throw std::runtime_error("Failed to open file " + path);
+  }
+
+  struct stat fileStatus;
+  if (fstat(_fileDescriptor, &fileStatus) != 0)
+  {
+    close(_fileDescriptor);
+    throw std::runtime_error("Failed to read the size of file " + path);
+  }
+  _size = static_cast<uint64>(fileStatus.st_size);
+  if (_size == 0)
+  {
+    return;
+  }
+
+  void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+  if (data == MAP_FAILED)
+  {
+    close(_fileDescriptor);
+    throw std::runtime_error("Failed to map file " + path);
+  }
+  _data = static_cast<const byte *>(data);
+}
+
+MappedFile::~MappedFile()
+{
+  if (_data != nullptr)
+  {
+    munmap(const_cast<byte *>(_data), _size);
+  }
+  close(_fileDescriptor);
+}
+#endif
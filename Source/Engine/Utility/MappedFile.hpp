@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+
+#include "../Core/Types.hpp"
+
+/// @brief Read only view of a whole file mapped into the address space. Pages are only read from disk as they are
+/// touched, so large files can be handed to the GPU without first being copied into heap memory.
+class MappedFile
+{
+public:
+  /// @brief Maps the file at path, throwing if it cannot be opened or mapped.
+  MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const byte *getData() const { return _data; }
+  uint64 getSize() const { return _size; }
+
+private:
+  const byte *_data;
+  uint64 _size;
+#ifdef _WIN32
+  void *_fileHandle;
+  void *_mappingHandle;
+#else
+  int32 _fileDescriptor;
+#endif
+};
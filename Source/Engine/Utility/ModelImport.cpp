@@ -0,0 +1,56 @@
+#include "ModelImport.hpp"
+
+ModelImport::ModelImport(GameObject &root, const std::string &filePath) : _root(root),
+                                                                         _filePath(filePath),
+                                                                         _state(ModelImportState::Parsing),
+                                                                         _pendingCount(0)
+{
+}
+
+bool ModelImport::isFinished() const
+{
+  ModelImportState state = getState();
+  return state == ModelImportState::Complete || state == ModelImportState::Failed;
+}
+
+std::string ModelImport::getError() const
+{
+  std::lock_guard<std::mutex> lock(_errorMutex);
+  return _error;
+}
+
+void ModelImport::fail(const std::string &error)
+{
+  {
+    std::lock_guard<std::mutex> lock(_errorMutex);
+    if (!_error.empty())
+    {
+      return;
+    }
+    _error = error;
+  }
+  _state.store(ModelImportState::Failed, std::memory_order_release);
+}
+
+void ModelImport::setState(ModelImportState state)
+{
+  // Once failed the import stays failed, even though uploads queued before the failure still land.
+  ModelImportState expected = getState();
+  while (expected != ModelImportState::Failed &&
+         !_state.compare_exchange_weak(expected, state, std::memory_order_acq_rel))
+  {
+  }
+}
+
+void ModelImport::addPending(uint32 count)
+{
+  _pendingCount.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ModelImport::completePending()
+{
+  if (_pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    setState(ModelImportState::Complete);
+  }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "../Core/Types.hpp"
+
+class GameObject;
+
+enum class ModelImportState : uint32
+{
+  /// @brief The file is being read on a worker, only the root game object exists.
+  Parsing,
+  /// @brief Every game object exists. Meshes and textures are replacing their placeholders as uploads are processed.
+  Streaming,
+  Complete,
+  Failed
+};
+
+/// @brief Handle to a model loading through ModelLoader::fromFileAsync. The root game object exists from the start and
+/// the rest of the model appears beneath it as the scene processes its upload queue.
+class ModelImport
+{
+public:
+  ModelImport(GameObject &root, const std::string &filePath);
+
+  ModelImportState getState() const { return _state.load(std::memory_order_acquire); }
+  bool isFinished() const;
+  GameObject &getRoot() const { return _root; }
+  const std::string &getFilePath() const { return _filePath; }
+  /// @brief Meshes and textures which are still to replace a placeholder.
+  uint32 getPendingCount() const { return _pendingCount.load(std::memory_order_relaxed); }
+  /// @brief The reason the import failed, empty unless the state is Failed.
+  std::string getError() const;
+
+private:
+  friend class ModelLoader;
+
+  void fail(const std::string &error);
+  void setState(ModelImportState state);
+  void addPending(uint32 count);
+  void completePending();
+
+  GameObject &_root;
+  std::string _filePath;
+  std::atomic<ModelImportState> _state;
+  std::atomic<uint32> _pendingCount;
+  mutable std::mutex _errorMutex;
+  std::string _error;
+};
@@ -1,269 +1,934 @@
-#include "ModelLoader.hpp"
-
-#include <stdexcept>
-
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
-#include "../Maths/Math.hpp"
-#include "../Core/Component.h"
-#include "../Core/Transform.h"
-#include "../Core/GameObject.h"
-#include "../RenderApi/RenderDevice.hpp"
-#include "../Rendering/Drawable.h"
-#include "../Rendering/Material.h"
-#include "../Rendering/StaticMesh.h"
-#include "Assert.hpp"
-#include "String.hpp"
-#include "TextureLoader.hpp"
-
-Vector3 toVector3(aiVector3D input)
-{
-  return Vector3(input.x, input.y, input.z);
-}
-
-void offsetVertices(std::vector<Vector3> &vertices, const Vector3 &midPoint)
-{
-  for (uint32 i = 0; i < vertices.size(); i++)
-  {
-    vertices[i] = vertices[i] - midPoint;
-  }
-}
-
-void buildIndexData(const aiFace *faces, uint32 indexCount, std::vector<uint32> &indicesOut)
-{
-  indicesOut.reserve(indexCount);
-  for (uint32 i = 0; i < indexCount; i++)
-  {
-    auto face = faces + i;
-    if (face->mNumIndices != 3)
-    {
-      throw std::runtime_error("Non-triangle face read");
-    }
-    indicesOut.push_back(face->mIndices[0]);
-    indicesOut.push_back(face->mIndices[1]);
-    indicesOut.push_back(face->mIndices[2]);
-  }
-}
-
-void buildTexCoordData(const aiVector3D *texCoords, uint32 texCoordCount, std::vector<Vector2> &texCoordsOut)
-{
-  texCoordsOut.reserve(texCoordCount);
-  for (uint32 i = 0; i < texCoordCount; i++)
-  {
-    texCoordsOut.emplace_back(texCoords[i].x, texCoords[i].y);
-  }
-}
-
-Vector3 buildVertexData(const aiVector3D *vertices, uint32 verexCount, std::vector<Vector3> &verticesOut)
-{
-  Vector3 avg(0);
-
-  verticesOut.reserve(verexCount);
-  for (uint32 i = 0; i < verexCount; i++)
-  {
-    Vector3 vertex(vertices[i].x, vertices[i].y, vertices[i].z);
-
-    avg.X = (avg.X + vertices[i].x) / 2.0f;
-    avg.Y = (avg.Y + vertices[i].y) / 2.0f;
-    avg.Z = (avg.Z + vertices[i].z) / 2.0f;
-
-    verticesOut.push_back(vertex);
-  }
-
-  return avg;
-}
-
-void buildNormalData(const aiVector3D *normals, uint32 normalCount, std::vector<Vector3> &normalsOut)
-{
-  normalsOut.reserve(normalCount);
-  for (uint32 i = 0; i < normalCount; i++)
-  {
-    normalsOut.emplace_back(normals[i].x, normals[i].y, normals[i].z);
-  }
-}
-
-std::shared_ptr<Material> buildMaterial(std::shared_ptr<RenderDevice> renderDevice, const std::string &filePath, const aiMaterial *aiMaterial)
-{
-  std::shared_ptr<Material> material(new Material());
-
-  aiColor3D diffuseColour;
-  aiMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, diffuseColour);
-  material->setDiffuseColour(Vector3(diffuseColour.r, diffuseColour.g, diffuseColour.b));
-
-  if (aiMaterial->GetTextureCount(aiTextureType_DIFFUSE) > 0)
-  {
-    aiString diffuseTexturePath;
-    aiMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &diffuseTexturePath);
-    if (diffuseTexturePath.length != 0)
-    {
-      auto diffuseTexture = TextureLoader::loadFromFile2D(renderDevice, filePath + diffuseTexturePath.C_Str(), true);
-      diffuseTexture->generateMips();
-      material->setDiffuseTexture(diffuseTexture);
-    }
-  }
-
-  if (aiMaterial->GetTextureCount(aiTextureType_NORMALS) > 0)
-  {
-    aiString normalTexturePath;
-    aiMaterial->GetTexture(aiTextureType_NORMALS, 0, &normalTexturePath);
-    if (normalTexturePath.length != 0)
-    {
-      auto normalTexture = TextureLoader::loadFromFile2D(renderDevice, filePath + normalTexturePath.C_Str());
-      normalTexture->generateMips();
-      material->setNormalTexture(normalTexture);
-    }
-  }
-
-  if (aiMaterial->GetTextureCount(aiTextureType_SPECULAR) > 0)
-  {
-    aiString specularTexturePath;
-    aiMaterial->GetTexture(aiTextureType_SPECULAR, 0, &specularTexturePath);
-    if (specularTexturePath.length != 0)
-    {
-      auto specularTexture = TextureLoader::loadFromFile2D(renderDevice, filePath + specularTexturePath.C_Str());
-      specularTexture->generateMips();
-      material->setMetallicTexture(specularTexture);
-    }
-  }
-
-  if (aiMaterial->GetTextureCount(aiTextureType_SHININESS) > 0)
-  {
-    aiString texturePath;
-    aiMaterial->GetTexture(aiTextureType_SHININESS, 0, &texturePath);
-    if (texturePath.length != 0)
-    {
-      auto texture = TextureLoader::loadFromFile2D(renderDevice, filePath + texturePath.C_Str());
-      texture->generateMips();
-      material->setRoughnessTexture(texture);
-    }
-  }
-
-  if (aiMaterial->GetTextureCount(aiTextureType_OPACITY) > 0)
-  {
-    aiString opacityTexturePath;
-    aiMaterial->GetTexture(aiTextureType_OPACITY, 0, &opacityTexturePath);
-    if (opacityTexturePath.length != 0)
-    {
-      auto opacityTexture = TextureLoader::loadFromFile2D(renderDevice, filePath + opacityTexturePath.C_Str());
-      material->setOpacityTexture(opacityTexture);
-    }
-  }
-  return material;
-}
-
-Vector3 calculateCentroid(const aiMesh *mesh)
-{
-  float32 areaSum = 0.0f;
-  Vector3 centroid = Vector3::Zero;
-  for (int i = 0; i < mesh->mNumFaces; i++)
-  {
-    auto face = mesh->mFaces[i];
-    auto p0 = toVector3(mesh->mVertices[face.mIndices[0]]);
-    auto p1 = toVector3(mesh->mVertices[face.mIndices[1]]);
-    auto p2 = toVector3(mesh->mVertices[face.mIndices[2]]);
-
-    Vector3 center = (p0 + p1 + p2) / 3.0f;
-    float32 area = 0.5f * Vector3::Cross(p1 - p0, p2 - p0).Length();
-    centroid += area * center;
-    areaSum += area;
-  }
-  return centroid / areaSum;
-}
-
-std::shared_ptr<StaticMesh> buildMesh(const std::string &filePath, const aiMesh *aiMesh, bool reconstructWorldTransforms, Vector3 &offset)
-{
-  if (!aiMesh->HasPositions() || !aiMesh->HasNormals())
-  {
-    return nullptr;
-  }
-
-  Vector3 centroid = calculateCentroid(aiMesh);
-
-  std::shared_ptr<StaticMesh> mesh(new StaticMesh());
-
-  std::vector<Vector3> vertices;
-  buildVertexData(aiMesh->mVertices, aiMesh->mNumVertices, vertices);
-  if (reconstructWorldTransforms)
-  {
-    offset = centroid;
-    offsetVertices(vertices, centroid);
-  }
-  mesh->setPositionVertexData(vertices);
-
-  if (aiMesh->HasNormals())
-  {
-    std::vector<Vector3> normals;
-    buildNormalData(aiMesh->mNormals, aiMesh->mNumVertices, normals);
-    mesh->setNormalVertexData(normals);
-  }
-  else
-  {
-    mesh->generateNormals();
-  }
-
-  // Assume that mesh contains a single set of texture coordinate data.
-  if (aiMesh->HasTextureCoords(0))
-  {
-    std::vector<Vector2> texCoords;
-    buildTexCoordData(aiMesh->mTextureCoords[0], aiMesh->mNumVertices, texCoords);
-    mesh->setTextureVertexData(texCoords);
-  }
-  else
-  {
-    std::vector<Vector2> texCoords(aiMesh->mNumVertices);
-    mesh->setTextureVertexData(texCoords);
-  }
-
-  if (aiMesh->HasFaces())
-  {
-    std::vector<uint32> indices;
-    buildIndexData(aiMesh->mFaces, aiMesh->mNumFaces, indices);
-    mesh->setIndexData(indices);
-  }
-
-  mesh->generateTangents();
-  return mesh;
-}
-
-GameObject &buildModel(Scene &scene, const std::string &fileFolder, const aiScene *aiScene, bool reconstructWorldTransforms)
-{
-  GameObject &root = scene.createGameObject(aiScene->mRootNode->mName.C_Str());
-
-  std::vector<std::shared_ptr<Material>> materials(aiScene->mNumMaterials);
-  for (uint32 i = 0; i < aiScene->mNumMaterials; i++)
-  {
-    materials[i] = buildMaterial(scene.getRenderDevice(), fileFolder, aiScene->mMaterials[i]);
-  }
-
-  for (uint32 i = 0; i < aiScene->mNumMeshes; i++)
-  {
-    auto aiMesh = aiScene->mMeshes[i];
-
-    GameObject &currentObject = scene.createGameObject(aiMesh->mName.C_Str());
-    Drawable &drawable = scene.createComponent<Drawable>();
-
-    currentObject.addComponent(drawable);
-    scene.addChildToNode(root, currentObject);
-
-    Vector3 offset;
-    drawable.setMaterial(materials[aiMesh->mMaterialIndex]);
-    drawable.setMesh(buildMesh(fileFolder, aiMesh, reconstructWorldTransforms, offset));
-    currentObject.transform().setPosition(offset);
-  }
-
-  return root;
-}
-
-GameObject &ModelLoader::fromFile(Scene &scene, const std::string &filePath, bool reconstructWorldTransforms)
-{
-  Assimp::Importer importer;
-  auto aiScene = importer.ReadFile(filePath, aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_GenUVCoords);
-  ASSERT_TRUE(aiScene, "failed to load mode from " + filePath);
-
-  auto splitPath = String::split(filePath, '/');
-  splitPath.pop_back();
-  auto fileFolder = String::join(splitPath, '/');
-  return buildModel(scene, fileFolder, aiScene, reconstructWorldTransforms);
-}
+#include "ModelLoader.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "../Maths/Math.hpp"
+#include "../Core/Component.h"
+#include "../Core/Transform.h"
+#include "../Core/GameObject.h"
+#include "../Core/JobSystem.h"
+#include "../Core/UploadQueue.h"
+#include "../Geometry/MeshFactory.h"
+#include "../Geometry/MeshOptimizer.hpp"
+#include "../Geometry/TangentSpace.hpp"
+#include "../Image/ImageData.hpp"
+#include "../RenderApi/RenderDevice.hpp"
+#include "../Rendering/Drawable.h"
+#include "../Rendering/Material.h"
+#include "../Rendering/StaticMesh.h"
+#include "BakedModel.hpp"
+#include "CompressedTexture.hpp"
+#include "DerivedDataCache.hpp"
+#include "HotReload.hpp"
+#include "String.hpp"
+#include "TextureLoader.hpp"
+
+Vector3 toVector3(aiVector3D input)
+{
+  return Vector3(input.x, input.y, input.z);
+}
+
+void offsetVertices(std::vector<Vector3> &vertices, const Vector3 &midPoint)
+{
+  for (uint32 i = 0; i < vertices.size(); i++)
+  {
+    vertices[i] = vertices[i] - midPoint;
+  }
+}
+
+void buildIndexData(const aiFace *faces, uint32 indexCount, std::vector<uint32> &indicesOut)
+{
+  indicesOut.reserve(indexCount);
+  for (uint32 i = 0; i < indexCount; i++)
+  {
+    auto face = faces + i;
+    if (face->mNumIndices != 3)
+    {
+      throw std::runtime_error("Non-triangle face read");
+    }
+    indicesOut.push_back(face->mIndices[0]);
+    indicesOut.push_back(face->mIndices[1]);
+    indicesOut.push_back(face->mIndices[2]);
+  }
+}
+
+void buildTexCoordData(const aiVector3D *texCoords, uint32 texCoordCount, std::vector<Vector2> &texCoordsOut)
+{
+  texCoordsOut.reserve(texCoordCount);
+  for (uint32 i = 0; i < texCoordCount; i++)
+  {
+    texCoordsOut.emplace_back(texCoords[i].x, texCoords[i].y);
+  }
+}
+
+Vector3 buildVertexData(const aiVector3D *vertices, uint32 verexCount, std::vector<Vector3> &verticesOut)
+{
+  Vector3 avg(0);
+
+  verticesOut.reserve(verexCount);
+  for (uint32 i = 0; i < verexCount; i++)
+  {
+    Vector3 vertex(vertices[i].x, vertices[i].y, vertices[i].z);
+
+    avg.X = (avg.X + vertices[i].x) / 2.0f;
+    avg.Y = (avg.Y + vertices[i].y) / 2.0f;
+    avg.Z = (avg.Z + vertices[i].z) / 2.0f;
+
+    verticesOut.push_back(vertex);
+  }
+
+  return avg;
+}
+
+void buildNormalData(const aiVector3D *normals, uint32 normalCount, std::vector<Vector3> &normalsOut)
+{
+  normalsOut.reserve(normalCount);
+  for (uint32 i = 0; i < normalCount; i++)
+  {
+    normalsOut.emplace_back(normals[i].x, normals[i].y, normals[i].z);
+  }
+}
+
+const aiTextureType BAKED_TEXTURE_TYPES[] = {aiTextureType_DIFFUSE, aiTextureType_NORMALS, aiTextureType_SPECULAR, aiTextureType_SHININESS, aiTextureType_OPACITY};
+
+BakedModelSource::Material buildMaterialSource(const aiMaterial *aiMaterial)
+{
+  BakedModelSource::Material material;
+
+  aiColor3D diffuseColour;
+  aiMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, diffuseColour);
+  material.DiffuseColour = Vector3(diffuseColour.r, diffuseColour.g, diffuseColour.b);
+
+  for (uint32 slot = 0; slot < static_cast<uint32>(BakedTextureSlot::Count); slot++)
+  {
+    if (aiMaterial->GetTextureCount(BAKED_TEXTURE_TYPES[slot]) > 0)
+    {
+      aiString texturePath;
+      aiMaterial->GetTexture(BAKED_TEXTURE_TYPES[slot], 0, &texturePath);
+      material.TexturePaths[slot] = texturePath.C_Str();
+    }
+  }
+  return material;
+}
+
+bool generatesMips(BakedTextureSlot slot)
+{
+  return slot != BakedTextureSlot::Opacity;
+}
+
+TextureCompression getTextureCompression(BakedTextureSlot slot)
+{
+  return slot == BakedTextureSlot::Normal ? TextureCompression::NormalMap : TextureCompression::Colour;
+}
+
+void setMaterialTexture(Material &material, BakedTextureSlot slot, const std::shared_ptr<Texture> &texture)
+{
+  switch (slot)
+  {
+  case BakedTextureSlot::Diffuse:
+    material.setDiffuseTexture(texture);
+    break;
+  case BakedTextureSlot::Normal:
+    material.setNormalTexture(texture);
+    break;
+  case BakedTextureSlot::Metallic:
+    material.setMetallicTexture(texture);
+    break;
+  case BakedTextureSlot::Roughness:
+    material.setRoughnessTexture(texture);
+    break;
+  case BakedTextureSlot::Opacity:
+    material.setOpacityTexture(texture);
+    break;
+  default:
+    break;
+  }
+}
+
+std::shared_ptr<Material> buildMaterial(std::shared_ptr<RenderDevice> renderDevice, const std::string &filePath, const BakedModelSource::Material &source)
+{
+  std::shared_ptr<Material> material(new Material());
+  material->setDiffuseColour(source.DiffuseColour);
+
+  for (uint32 slot = 0; slot < static_cast<uint32>(BakedTextureSlot::Count); slot++)
+  {
+    if (source.TexturePaths[slot].empty())
+    {
+      continue;
+    }
+    auto textureSlot = static_cast<BakedTextureSlot>(slot);
+    auto texture = TextureLoader::loadFromFile2D(renderDevice, filePath + source.TexturePaths[slot], generatesMips(textureSlot), false, getTextureCompression(textureSlot));
+    setMaterialTexture(*material, textureSlot, texture);
+  }
+  return material;
+}
+
+Vector3 calculateCentroid(const aiMesh *mesh)
+{
+  float32 areaSum = 0.0f;
+  Vector3 centroid = Vector3::Zero;
+  for (int i = 0; i < mesh->mNumFaces; i++)
+  {
+    auto face = mesh->mFaces[i];
+    auto p0 = toVector3(mesh->mVertices[face.mIndices[0]]);
+    auto p1 = toVector3(mesh->mVertices[face.mIndices[1]]);
+    auto p2 = toVector3(mesh->mVertices[face.mIndices[2]]);
+
+    Vector3 center = (p0 + p1 + p2) / 3.0f;
+    float32 area = 0.5f * Vector3::Cross(p1 - p0, p2 - p0).Length();
+    centroid += area * center;
+    areaSum += area;
+  }
+  return centroid / areaSum;
+}
+
+bool isMeshBuildable(const aiMesh *aiMesh)
+{
+  return aiMesh->HasPositions() && aiMesh->HasNormals();
+}
+
+/// @brief The position of the game object owning a mesh, which buildMesh subtracts from its vertices.
+Vector3 getMeshOffset(const aiMesh *aiMesh, bool reconstructWorldTransforms)
+{
+  if (!reconstructWorldTransforms || !isMeshBuildable(aiMesh))
+  {
+    return Vector3::Zero;
+  }
+  return calculateCentroid(aiMesh);
+}
+
+/// @param jobs If given, normals and tangents are generated across its workers.
+std::shared_ptr<StaticMesh> buildMesh(const aiMesh *aiMesh, const Vector3 &offset, MeshOptimizationStats *optimizationStats = nullptr,
+                                      JobSystem *jobs = nullptr)
+{
+  if (!isMeshBuildable(aiMesh))
+  {
+    return nullptr;
+  }
+
+  std::shared_ptr<StaticMesh> mesh(new StaticMesh());
+
+  MeshOptimizerData meshData;
+  buildVertexData(aiMesh->mVertices, aiMesh->mNumVertices, meshData.Positions);
+  offsetVertices(meshData.Positions, offset);
+  if (aiMesh->HasNormals())
+  {
+    buildNormalData(aiMesh->mNormals, aiMesh->mNumVertices, meshData.Normals);
+  }
+
+  // Assume that mesh contains a single set of texture coordinate data.
+  if (aiMesh->HasTextureCoords(0))
+  {
+    buildTexCoordData(aiMesh->mTextureCoords[0], aiMesh->mNumVertices, meshData.TexCoords);
+  }
+  else
+  {
+    meshData.TexCoords.resize(aiMesh->mNumVertices);
+  }
+
+  if (aiMesh->HasFaces())
+  {
+    buildIndexData(aiMesh->mFaces, aiMesh->mNumFaces, meshData.Indices);
+    MeshOptimizationStats stats = MeshOptimizer::optimize(meshData);
+    if (optimizationStats)
+    {
+      *optimizationStats = stats;
+    }
+    mesh->setIndexData(meshData.Indices);
+  }
+
+  mesh->setPositionVertexData(meshData.Positions);
+  mesh->setTextureVertexData(meshData.TexCoords);
+  if (!meshData.Normals.empty())
+  {
+    mesh->setNormalVertexData(meshData.Normals);
+  }
+  else
+  {
+    mesh->generateNormals(jobs);
+  }
+
+  mesh->generateTangents(jobs);
+  mesh->generateLods();
+  return mesh;
+}
+
+const aiScene *importScene(Assimp::Importer &importer, const std::string &filePath)
+{
+  auto aiScene = importer.ReadFile(filePath, aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_GenUVCoords);
+  if (!aiScene)
+  {
+    throw std::runtime_error("Failed to load model from " + filePath + ": " + importer.GetErrorString());
+  }
+  return aiScene;
+}
+
+std::string getFileFolder(const std::string &filePath)
+{
+  auto splitPath = String::split(filePath, '/');
+  splitPath.pop_back();
+  return String::join(splitPath, '/');
+}
+
+BakedModelSource::Material readBakedMaterial(const BakedModel &bakedModel, uint32 materialIndex)
+{
+  const BakedMaterialRecord &record = bakedModel.getMaterial(materialIndex);
+  BakedModelSource::Material source;
+  source.DiffuseColour = Vector3(record.DiffuseColour[0], record.DiffuseColour[1], record.DiffuseColour[2]);
+  for (uint32 slot = 0; slot < static_cast<uint32>(BakedTextureSlot::Count); slot++)
+  {
+    source.TexturePaths[slot] = bakedModel.getString(record.TexturePathOffsets[slot]);
+  }
+  return source;
+}
+
+BakedModelSource::Node readBakedNode(const BakedModel &bakedModel, uint32 nodeIndex)
+{
+  const BakedNodeRecord &record = bakedModel.getNode(nodeIndex);
+  BakedModelSource::Node node;
+  node.Name = bakedModel.getString(record.NameOffset);
+  node.Parent = record.Parent;
+  node.MeshIndex = record.MeshIndex;
+  node.Position = Vector3(record.Position[0], record.Position[1], record.Position[2]);
+  node.Rotation = Quaternion(record.Rotation[3], record.Rotation[0], record.Rotation[1], record.Rotation[2]);
+  node.Scale = Vector3(record.Scale[0], record.Scale[1], record.Scale[2]);
+  return node;
+}
+
+std::shared_ptr<StaticMesh> createBakedMesh(const BakedModel &bakedModel, uint32 meshIndex)
+{
+  const BakedMeshRecord &record = bakedModel.getMesh(meshIndex);
+  std::shared_ptr<StaticMesh> mesh(new StaticMesh());
+  mesh->setInterleavedData(bakedModel.getVertexData(meshIndex), record.VertexCount, record.VertexStride,
+                           bakedModel.getIndexData(meshIndex), record.IndexCount,
+                           Aabb(Vector3(record.AabbMax[0], record.AabbMax[1], record.AabbMax[2]),
+                                Vector3(record.AabbMin[0], record.AabbMin[1], record.AabbMin[2])));
+
+  std::vector<MeshLod> lods(record.LodCount);
+  for (uint32 lod = 0; lod < record.LodCount; lod++)
+  {
+    lods[lod].IndexOffset = record.LodIndexOffsets[lod];
+    lods[lod].IndexCount = record.LodIndexCounts[lod];
+    lods[lod].Error = record.LodErrors[lod];
+  }
+  mesh->setLods(lods);
+  return mesh;
+}
+
+void applyNodeTransform(GameObject &gameObject, const BakedModelSource::Node &node)
+{
+  gameObject.transform().setPosition(node.Position);
+  gameObject.transform().setRotation(node.Rotation);
+  gameObject.transform().setScale(node.Scale);
+}
+
+/// @brief The drawables built from each mesh of a model file, whose meshes are rebuilt whenever the file changes.
+struct ModelWatch
+{
+  Scene *TargetScene;
+  std::string FilePath;
+  // Indexed by mesh. Meshes are rebuilt around the offset they were first built with, which their game objects
+  // already sit at, even if the file now has a different centroid.
+  std::vector<Vector3> Offsets;
+  std::vector<std::vector<std::weak_ptr<Drawable>>> MeshDrawables;
+
+  ModelWatch(Scene &scene, const std::string &filePath, uint32 meshCount) : TargetScene(&scene), FilePath(filePath), Offsets(meshCount),
+                                                                          MeshDrawables(meshCount)
+  {
+  }
+
+  void addDrawable(uint32 meshIndex, Drawable &drawable, const Vector3 &offset)
+  {
+    Offsets[meshIndex] = offset;
+    MeshDrawables[meshIndex].push_back(std::static_pointer_cast<Drawable>(drawable.shared_from_this()));
+  }
+};
+
+GameObject &buildModel(Scene &scene, const std::string &fileFolder, const aiScene *aiScene, bool reconstructWorldTransforms, ModelWatch &watch)
+{
+  GameObject &root = scene.createGameObject(aiScene->mRootNode->mName.C_Str());
+
+  std::vector<std::shared_ptr<Material>> materials(aiScene->mNumMaterials);
+  for (uint32 i = 0; i < aiScene->mNumMaterials; i++)
+  {
+    materials[i] = buildMaterial(scene.getRenderDevice(), fileFolder, buildMaterialSource(aiScene->mMaterials[i]));
+  }
+
+  for (uint32 i = 0; i < aiScene->mNumMeshes; i++)
+  {
+    auto aiMesh = aiScene->mMeshes[i];
+
+    GameObject &currentObject = scene.createGameObject(aiMesh->mName.C_Str());
+    Drawable &drawable = scene.createComponent<Drawable>();
+
+    currentObject.addComponent(drawable);
+    scene.addChildToNode(root, currentObject);
+
+    Vector3 offset = getMeshOffset(aiMesh, reconstructWorldTransforms);
+    drawable.setMaterial(materials[aiMesh->mMaterialIndex]);
+    drawable.setMesh(buildMesh(aiMesh, offset, nullptr, &scene.getLoadingJobSystem()));
+    currentObject.transform().setPosition(offset);
+    watch.addDrawable(i, drawable, offset);
+  }
+
+  return root;
+}
+
+GameObject &ModelLoader::fromFile(Scene &scene, const std::string &filePath, bool reconstructWorldTransforms)
+{
+  if (auto bakedModel = findBakedModel(filePath, reconstructWorldTransforms))
+  {
+    std::shared_ptr<ModelWatch> watch(new ModelWatch(scene, filePath, bakedModel->getHeader().MeshCount));
+    GameObject &root = fromBakedModel(scene, *bakedModel, getFileFolder(filePath), watch.get());
+    watchModel(watch);
+    return root;
+  }
+
+  Assimp::Importer importer;
+  auto aiScene = importScene(importer, filePath);
+  std::shared_ptr<ModelWatch> watch(new ModelWatch(scene, filePath, aiScene->mNumMeshes));
+  GameObject &root = buildModel(scene, getFileFolder(filePath), aiScene, reconstructWorldTransforms, *watch);
+  watchModel(watch);
+  return root;
+}
+
+GameObject &ModelLoader::fromBakedFile(Scene &scene, const std::string &bakedPath)
+{
+  BakedModel bakedModel(bakedPath);
+  return fromBakedModel(scene, bakedModel, getFileFolder(bakedPath));
+}
+
+GameObject &ModelLoader::fromBakedModel(Scene &scene, const BakedModel &bakedModel, const std::string &fileFolder, ModelWatch *watch)
+{
+  const BakedModelHeader &header = bakedModel.getHeader();
+  if (header.NodeCount == 0)
+  {
+    throw std::runtime_error("Baked model has no root node");
+  }
+
+  std::vector<std::shared_ptr<Material>> materials(header.MaterialCount);
+  for (uint32 i = 0; i < header.MaterialCount; i++)
+  {
+    materials[i] = buildMaterial(scene.getRenderDevice(), fileFolder, readBakedMaterial(bakedModel, i));
+  }
+
+  std::vector<GameObject *> nodes(header.NodeCount);
+  for (uint32 i = 0; i < header.NodeCount; i++)
+  {
+    BakedModelSource::Node node = readBakedNode(bakedModel, i);
+    GameObject &gameObject = scene.createGameObject(node.Name);
+    nodes[i] = &gameObject;
+    if (node.Parent != BAKED_MODEL_NONE)
+    {
+      scene.addChildToNode(*nodes[node.Parent], gameObject);
+    }
+    applyNodeTransform(gameObject, node);
+
+    if (node.MeshIndex != BAKED_MODEL_NONE)
+    {
+      Drawable &drawable = scene.createComponent<Drawable>();
+      gameObject.addComponent(drawable);
+      drawable.setMaterial(materials[bakedModel.getMesh(node.MeshIndex).MaterialIndex]);
+      drawable.setMesh(createBakedMesh(bakedModel, node.MeshIndex));
+      if (watch)
+      {
+        watch->addDrawable(node.MeshIndex, drawable, node.Position);
+      }
+    }
+  }
+
+  return *nodes[0];
+}
+
+/// @brief State shared by the jobs and uploads of one fromFileAsync call. The parse job fills in the description of
+/// the model before queueing anything else, after which it is only read. The remaining members belong to the main thread.
+struct AsyncModelLoad
+{
+  struct TextureRequest
+  {
+    std::string Path;
+    bool GenerateMips;
+    TextureCompression Compression;
+    std::vector<std::pair<uint32, BakedTextureSlot>> Users;
+  };
+
+  std::shared_ptr<ModelImport> Import;
+  Scene *TargetScene;
+  std::string FilePath;
+  std::string FileFolder;
+  bool ReconstructWorldTransforms;
+
+  Assimp::Importer Importer;
+  const aiScene *AiScene = nullptr;
+  std::shared_ptr<BakedModel> Baked;
+  std::vector<BakedModelSource::Material> Materials;
+  std::vector<BakedModelSource::Node> Nodes;
+  std::vector<uint32> MeshMaterials;
+  std::vector<TextureRequest> Textures;
+
+  std::vector<std::shared_ptr<Material>> MaterialPtrs;
+  std::vector<std::vector<Drawable *>> MeshDrawables;
+  std::shared_ptr<ModelWatch> Watch;
+};
+
+std::shared_ptr<ModelImport> ModelLoader::fromFileAsync(Scene &scene, const std::string &filePath, bool reconstructWorldTransforms)
+{
+  auto splitPath = String::split(filePath, '/');
+  GameObject &root = scene.createGameObject(splitPath.empty() ? filePath : splitPath.back());
+
+  std::shared_ptr<AsyncModelLoad> load(new AsyncModelLoad());
+  load->Import.reset(new ModelImport(root, filePath));
+  load->TargetScene = &scene;
+  load->FilePath = filePath;
+  load->FileFolder = getFileFolder(filePath);
+  load->ReconstructWorldTransforms = reconstructWorldTransforms;
+
+  scene.getLoadingJobSystem().schedule([load]()
+                                       { parseAsync(load); });
+  return load->Import;
+}
+
+void ModelLoader::parseAsync(const std::shared_ptr<AsyncModelLoad> &load)
+{
+  try
+  {
+    load->Baked = findBakedModel(load->FilePath, load->ReconstructWorldTransforms);
+    if (load->Baked)
+    {
+      const BakedModelHeader &header = load->Baked->getHeader();
+      for (uint32 i = 0; i < header.MaterialCount; i++)
+      {
+        load->Materials.push_back(readBakedMaterial(*load->Baked, i));
+      }
+      for (uint32 i = 0; i < header.NodeCount; i++)
+      {
+        load->Nodes.push_back(readBakedNode(*load->Baked, i));
+      }
+      for (uint32 i = 0; i < header.MeshCount; i++)
+      {
+        load->MeshMaterials.push_back(load->Baked->getMesh(i).MaterialIndex);
+      }
+    }
+    else
+    {
+      // Mirrors buildModel: a root node with one child per mesh.
+      load->AiScene = importScene(load->Importer, load->FilePath);
+      for (uint32 i = 0; i < load->AiScene->mNumMaterials; i++)
+      {
+        load->Materials.push_back(buildMaterialSource(load->AiScene->mMaterials[i]));
+      }
+
+      BakedModelSource::Node root;
+      root.Name = load->AiScene->mRootNode->mName.C_Str();
+      load->Nodes.push_back(root);
+      for (uint32 i = 0; i < load->AiScene->mNumMeshes; i++)
+      {
+        auto aiMesh = load->AiScene->mMeshes[i];
+        load->MeshMaterials.push_back(aiMesh->mMaterialIndex);
+
+        BakedModelSource::Node node;
+        node.Name = aiMesh->mName.C_Str();
+        node.Parent = 0;
+        node.Position = getMeshOffset(aiMesh, load->ReconstructWorldTransforms);
+        if (isMeshBuildable(aiMesh))
+        {
+          node.MeshIndex = i;
+        }
+        load->Nodes.push_back(node);
+      }
+    }
+  }
+  catch (const std::exception &exception)
+  {
+    load->Import->fail(exception.what());
+    return;
+  }
+
+  // Each texture is decoded once however many materials sample it.
+  std::unordered_map<std::string, uint32> textureIndices;
+  for (uint32 i = 0; i < load->Materials.size(); i++)
+  {
+    for (uint32 slot = 0; slot < static_cast<uint32>(BakedTextureSlot::Count); slot++)
+    {
+      const std::string &texturePath = load->Materials[i].TexturePaths[slot];
+      if (texturePath.empty())
+      {
+        continue;
+      }
+      auto result = textureIndices.insert({texturePath, static_cast<uint32>(load->Textures.size())});
+      if (result.second)
+      {
+        auto textureSlot = static_cast<BakedTextureSlot>(slot);
+        load->Textures.push_back({texturePath, generatesMips(textureSlot), getTextureCompression(textureSlot), {}});
+      }
+      load->Textures[result.first->second].Users.push_back({i, static_cast<BakedTextureSlot>(slot)});
+    }
+  }
+
+  std::vector<bool> meshUsed(load->MeshMaterials.size(), false);
+  for (const auto &node : load->Nodes)
+  {
+    if (node.MeshIndex != BAKED_MODEL_NONE)
+    {
+      meshUsed[node.MeshIndex] = true;
+    }
+  }
+  uint32 meshCount = static_cast<uint32>(std::count(meshUsed.begin(), meshUsed.end(), true));
+  load->Import->addPending(meshCount + static_cast<uint32>(load->Textures.size()));
+
+  // Queued ahead of every mesh upload, so the drawables exist by the time their meshes arrive.
+  load->TargetScene->getUploadQueue().push(0, [load]()
+                                           { createAsyncStructure(load); });
+
+  JobSystem &jobSystem = load->TargetScene->getLoadingJobSystem();
+  for (uint32 i = 0; i < meshUsed.size(); i++)
+  {
+    if (meshUsed[i])
+    {
+      jobSystem.schedule([load, i]()
+                         { streamMesh(load, i); });
+    }
+  }
+}
+
+void ModelLoader::createAsyncStructure(const std::shared_ptr<AsyncModelLoad> &load)
+{
+  Scene &scene = *load->TargetScene;
+  for (const auto &source : load->Materials)
+  {
+    std::shared_ptr<Material> material(new Material());
+    material->setDiffuseColour(source.DiffuseColour);
+    load->MaterialPtrs.push_back(material);
+  }
+
+  // The root already exists and may have been moved by the caller, so it keeps its transform.
+  auto placeholderMesh = MeshFactory::createCube();
+  load->MeshDrawables.resize(load->MeshMaterials.size());
+  load->Watch.reset(new ModelWatch(scene, load->FilePath, static_cast<uint32>(load->MeshMaterials.size())));
+  std::vector<GameObject *> nodes(load->Nodes.size());
+  nodes[0] = &load->Import->getRoot();
+  for (uint32 i = 0; i < load->Nodes.size(); i++)
+  {
+    const auto &node = load->Nodes[i];
+    if (i > 0)
+    {
+      nodes[i] = &scene.createGameObject(node.Name);
+      scene.addChildToNode(*nodes[node.Parent == BAKED_MODEL_NONE ? 0 : node.Parent], *nodes[i]);
+      applyNodeTransform(*nodes[i], node);
+    }
+
+    if (node.MeshIndex != BAKED_MODEL_NONE)
+    {
+      Drawable &drawable = scene.createComponent<Drawable>();
+      nodes[i]->addComponent(drawable);
+      drawable.setMaterial(load->MaterialPtrs[load->MeshMaterials[node.MeshIndex]]);
+      drawable.setMesh(placeholderMesh);
+      load->MeshDrawables[node.MeshIndex].push_back(&drawable);
+      load->Watch->addDrawable(node.MeshIndex, drawable, node.Position);
+    }
+  }
+  load->Import->setState(ModelImportState::Streaming);
+  watchModel(load->Watch);
+
+  // Textures already loaded by an earlier model are applied straight away rather than decoded again.
+  JobSystem &jobSystem = scene.getLoadingJobSystem();
+  for (uint32 i = 0; i < load->Textures.size(); i++)
+  {
+    const auto &request = load->Textures[i];
+    if (auto texture = TextureLoader::findCached(load->FileFolder + request.Path))
+    {
+      for (const auto &user : request.Users)
+      {
+        setMaterialTexture(*load->MaterialPtrs[user.first], user.second, texture);
+      }
+      load->Import->completePending();
+      continue;
+    }
+    jobSystem.schedule([load, i]()
+                       { streamTexture(load, i); });
+  }
+
+  if (load->Import->getPendingCount() == 0)
+  {
+    load->Import->setState(ModelImportState::Complete);
+  }
+}
+
+void ModelLoader::streamMesh(const std::shared_ptr<AsyncModelLoad> &load, uint32 meshIndex)
+{
+  std::shared_ptr<StaticMesh> mesh;
+  uint64 byteCount = 0;
+  try
+  {
+    if (load->Baked)
+    {
+      mesh = createBakedMesh(*load->Baked, meshIndex);
+      const BakedMeshRecord &record = load->Baked->getMesh(meshIndex);
+      byteCount = static_cast<uint64>(record.VertexCount) * record.VertexStride + static_cast<uint64>(record.IndexCount) * sizeof(uint32);
+    }
+    else
+    {
+      // Interleaved here rather than on first draw, leaving the upload as nothing but a buffer write.
+      auto aiMesh = load->AiScene->mMeshes[meshIndex];
+      auto builtMesh = buildMesh(aiMesh, getMeshOffset(aiMesh, load->ReconstructWorldTransforms), nullptr, &load->TargetScene->getLoadingJobSystem());
+      int32 stride = 0;
+      auto vertices = std::make_shared<std::vector<float32>>(builtMesh->createRestructuredVertexDataArray(stride));
+      auto indices = std::make_shared<std::vector<uint32>>(builtMesh->getIndices());
+
+      mesh.reset(new StaticMesh());
+      mesh->setInterleavedData(std::shared_ptr<const void>(vertices, vertices->data()), builtMesh->getVertexCount(), static_cast<uint32>(stride),
+                               std::shared_ptr<const uint32>(indices, indices->data()), static_cast<uint32>(indices->size()), builtMesh->getAabb());
+      mesh->setLods(builtMesh->getLods());
+      byteCount = vertices->size() * sizeof(float32) + indices->size() * sizeof(uint32);
+    }
+  }
+  catch (const std::exception &exception)
+  {
+    load->Import->fail("Failed to build mesh " + std::to_string(meshIndex) + " of " + load->FilePath + ": " + exception.what());
+    return;
+  }
+
+  load->TargetScene->getUploadQueue().push(byteCount, [load, meshIndex, mesh]()
+                                           {
+                                             auto renderDevice = load->TargetScene->getRenderDevice();
+                                             mesh->getVertexData(renderDevice);
+                                             if (mesh->isIndexed())
+                                             {
+                                               mesh->getIndexData(renderDevice);
+                                             }
+                                             for (auto drawable : load->MeshDrawables[meshIndex])
+                                             {
+                                               drawable->setMesh(mesh);
+                                             }
+                                             load->Import->completePending();
+                                           });
+}
+
+void ModelLoader::streamTexture(const std::shared_ptr<AsyncModelLoad> &load, uint32 textureIndex)
+{
+  const auto &request = load->Textures[textureIndex];
+  std::string path = load->FileFolder + request.Path;
+  bool compressed = TextureLoader::isCompressionEnabled();
+  std::shared_ptr<CompressedTexture> compressedTexture;
+  std::vector<std::shared_ptr<ImageData>> levels;
+  // Each texture is already its own job on this pool. Splitting its mip levels across it too keeps the workers busy
+  // once only a few large textures remain.
+  JobSystem *jobSystem = &load->TargetScene->getLoadingJobSystem();
+  try
+  {
+    if (compressed)
+    {
+      compressedTexture = TextureLoader::loadCompressed(path, request.Compression, request.GenerateMips, false, jobSystem);
+    }
+    else
+    {
+      levels = TextureLoader::decodeMipChain(path, request.GenerateMips, false, jobSystem);
+    }
+  }
+  catch (const std::exception &exception)
+  {
+    load->Import->fail(exception.what());
+    return;
+  }
+
+  uint64 byteCount = compressed ? compressedTexture->getDataSize() : 0;
+  for (const auto &level : levels)
+  {
+    byteCount += level->getPixelData().size();
+  }
+  load->TargetScene->getUploadQueue().push(byteCount, [load, textureIndex, path, compressedTexture, levels]()
+                                           {
+                                             const auto &request = load->Textures[textureIndex];
+                                             auto renderDevice = load->TargetScene->getRenderDevice();
+                                             auto texture = compressedTexture ? TextureLoader::createFromCompressed2D(renderDevice, path, *compressedTexture)
+                                                                              : TextureLoader::createFromMipChain2D(renderDevice, path, levels);
+                                             for (const auto &user : request.Users)
+                                             {
+                                               setMaterialTexture(*load->MaterialPtrs[user.first], user.second, texture);
+                                             }
+                                             load->Import->completePending();
+                                           });
+}
+
+void ModelLoader::bake(const std::string &filePath, const std::string &bakedPath, bool reconstructWorldTransforms, std::vector<BakedMeshStats> *meshStats)
+{
+  Assimp::Importer importer;
+  auto aiScene = importScene(importer, filePath);
+
+  // Mirrors buildModel: a root node with one child per mesh.
+  BakedModelSource source;
+  source.Flags = reconstructWorldTransforms ? static_cast<uint32>(BMF_ReconstructedWorldTransforms) : 0u;
+  for (uint32 i = 0; i < aiScene->mNumMaterials; i++)
+  {
+    source.Materials.push_back(buildMaterialSource(aiScene->mMaterials[i]));
+  }
+
+  BakedModelSource::Node root;
+  root.Name = aiScene->mRootNode->mName.C_Str();
+  source.Nodes.push_back(root);
+
+  for (uint32 i = 0; i < aiScene->mNumMeshes; i++)
+  {
+    auto aiMesh = aiScene->mMeshes[i];
+    Vector3 offset = getMeshOffset(aiMesh, reconstructWorldTransforms);
+    MeshOptimizationStats optimizationStats;
+    std::shared_ptr<StaticMesh> mesh = buildMesh(aiMesh, offset, &optimizationStats);
+    if (mesh && meshStats)
+    {
+      meshStats->push_back({aiMesh->mName.C_Str(), optimizationStats});
+    }
+
+    BakedModelSource::Node node;
+    node.Name = aiMesh->mName.C_Str();
+    node.Parent = 0;
+    node.Position = offset;
+    if (mesh)
+    {
+      BakedModelSource::Mesh bakedMesh;
+      int32 stride = 0;
+      bakedMesh.Name = node.Name;
+      bakedMesh.Vertices = mesh->createRestructuredVertexDataArray(stride);
+      bakedMesh.VertexStride = static_cast<uint32>(stride);
+      bakedMesh.Indices = mesh->getIndices();
+      bakedMesh.Lods = mesh->getLods();
+      bakedMesh.Bounds = mesh->getAabb();
+      bakedMesh.MaterialIndex = aiMesh->mMaterialIndex;
+
+      node.MeshIndex = static_cast<uint32>(source.Meshes.size());
+      source.Meshes.push_back(std::move(bakedMesh));
+    }
+    source.Nodes.push_back(node);
+  }
+
+  BakedModel::write(bakedPath, source);
+}
+
+std::shared_ptr<BakedModel> ModelLoader::findBakedModel(const std::string &filePath, bool reconstructWorldTransforms)
+{
+  auto isUsable = [reconstructWorldTransforms](const BakedModel &bakedModel)
+  {
+    bool bakedReconstructed = (bakedModel.getHeader().Flags & BMF_ReconstructedWorldTransforms) != 0;
+    return bakedReconstructed == reconstructWorldTransforms && bakedModel.getHeader().NodeCount > 0;
+  };
+
+  std::string bakedPath = getBakedPath(filePath);
+  if (std::ifstream(bakedPath).good())
+  {
+    std::shared_ptr<BakedModel> bakedModel(new BakedModel(bakedPath));
+    if (isUsable(*bakedModel))
+    {
+      return bakedModel;
+    }
+  }
+
+  // Only the model file itself is hashed, so edits to material libraries it references need the entry removing by hand.
+  try
+  {
+    DerivedDataCache &cache = DerivedDataCache::get();
+    uint32 settings[] = {BAKED_MODEL_VERSION, MESH_OPTIMIZER_VERSION, MESH_SIMPLIFIER_VERSION, TANGENT_SPACE_VERSION, reconstructWorldTransforms ? 1u : 0u};
+    uint64 key = DerivedDataCache::createKey(DerivedDataCache::hashFile(filePath), settings, sizeof(settings));
+    auto openEntry = [&isUsable](const std::string &cachePath)
+    {
+      std::shared_ptr<BakedModel> bakedModel(new BakedModel(cachePath));
+      if (!isUsable(*bakedModel))
+      {
+        throw std::runtime_error("Cache entry " + cachePath + " has no usable nodes");
+      }
+      return bakedModel;
+    };
+    if (auto bakedModel = cache.load<BakedModel>(key, BAKED_MODEL_EXTENSION, openEntry))
+    {
+      return bakedModel;
+    }
+
+    std::string cachePath = cache.store(key, BAKED_MODEL_EXTENSION, [&](const std::string &temporaryPath)
+                                        { bake(filePath, temporaryPath, reconstructWorldTransforms); });
+    return openEntry(cachePath);
+  }
+  catch (const std::exception &)
+  {
+    // Leaves the caller to import the model directly, which reports the error if the model itself is at fault.
+    return nullptr;
+  }
+}
+
+std::string ModelLoader::getBakedPath(const std::string &filePath)
+{
+  return filePath + BAKED_MODEL_EXTENSION;
+}
+
+void ModelLoader::watchModel(const std::shared_ptr<ModelWatch> &watch)
+{
+  HotReload::get().track({watch->FilePath}, [watch]()
+                         {
+                           bool inUse = false;
+                           for (const auto &drawables : watch->MeshDrawables)
+                           {
+                             for (const auto &drawable : drawables)
+                             {
+                               inUse |= !drawable.expired();
+                             }
+                           }
+                           if (inUse)
+                           {
+                             watch->TargetScene->getLoadingJobSystem().schedule([watch]()
+                                                                                { rebuildModel(watch); });
+                           }
+                           return inUse;
+                         });
+}
+
+void ModelLoader::rebuildModel(const std::shared_ptr<ModelWatch> &watch)
+{
+  // Rebuilt from the file itself rather than a bake, which is only refreshed the next time the model is loaded.
+  std::vector<std::shared_ptr<StaticMesh>> meshes(watch->MeshDrawables.size());
+  uint64 byteCount = 0;
+  try
+  {
+    Assimp::Importer importer;
+    auto aiScene = importScene(importer, watch->FilePath);
+    if (aiScene->mNumMeshes != meshes.size())
+    {
+      throw std::runtime_error("Could not reload " + watch->FilePath + ": meshes were added or removed, restart to pick it up");
+    }
+    for (uint32 i = 0; i < meshes.size(); i++)
+    {
+      if (!watch->MeshDrawables[i].empty())
+      {
+        meshes[i] = buildMesh(aiScene->mMeshes[i], watch->Offsets[i], nullptr, &watch->TargetScene->getLoadingJobSystem());
+      }
+      if (meshes[i])
+      {
+        byteCount += static_cast<uint64>(meshes[i]->getVertexCount()) * FULL_VERTEX_FLOATS * sizeof(float32) + meshes[i]->getIndices().size() * sizeof(uint32);
+      }
+    }
+  }
+  catch (const std::exception &exception)
+  {
+    HotReload::get().reportError(exception.what());
+    return;
+  }
+
+  // Swapped in between frames, leaving the drawables' transforms and materials as they were.
+  watch->TargetScene->getUploadQueue().push(byteCount, [watch, meshes]()
+                                            {
+                                              for (uint32 i = 0; i < meshes.size(); i++)
+                                              {
+                                                for (const auto &weakDrawable : watch->MeshDrawables[i])
+                                                {
+                                                  auto drawable = weakDrawable.lock();
+                                                  if (drawable && meshes[i])
+                                                  {
+                                                    drawable->setMesh(meshes[i]);
+                                                  }
+                                                }
+                                              }
+                                            });
+}
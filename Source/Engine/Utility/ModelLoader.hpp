@@ -1,13 +1,56 @@
-#pragma once
-#include <memory>
-#include <string>
-
-#include "../Core/Scene.h"
-
-class GameObject;
-
-class ModelLoader
-{
-public:
-  static GameObject &fromFile(Scene &scene, const std::string &filePath, bool reconstructWorldTransforms);
-};
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Core/Scene.h"
+#include "../Geometry/MeshOptimizer.hpp"
+#include "ModelImport.hpp"
+
+class BakedModel;
+class GameObject;
+struct AsyncModelLoad;
+struct ModelWatch;
+
+constexpr const char *BAKED_MODEL_EXTENSION = ".fmdl";
+
+struct BakedMeshStats
+{
+  std::string Name;
+  MeshOptimizationStats Optimization;
+};
+
+class ModelLoader
+{
+public:
+  /// @brief Loads a model baked with the same settings, either from next to it at getBakedPath(filePath) or from the
+  /// DerivedDataCache. On a miss the model is imported through Assimp and baked into the cache first.
+  static GameObject &fromFile(Scene &scene, const std::string &filePath, bool reconstructWorldTransforms);
+  /// @brief Maps a baked model and hands its vertex and index streams straight to the GPU buffers.
+  static GameObject &fromBakedFile(Scene &scene, const std::string &bakedPath);
+  /// @brief Returns as soon as the root game object exists. Parsing, mesh building and image decoding run on the
+  /// scene's loading jobs, with the results uploaded by Scene::update within its upload budget. Drawables show a
+  /// placeholder mesh and untextured material until their data arrives.
+  static std::shared_ptr<ModelImport> fromFileAsync(Scene &scene, const std::string &filePath, bool reconstructWorldTransforms);
+
+  /// @brief Imports a model through Assimp and writes the result, ready to upload, to bakedPath.
+  /// @param meshStats If given, receives how much the optimizer reduced the vertex work of each mesh.
+  static void bake(const std::string &filePath, const std::string &bakedPath, bool reconstructWorldTransforms, std::vector<BakedMeshStats> *meshStats = nullptr);
+  static std::string getBakedPath(const std::string &filePath);
+
+private:
+  /// @brief Returns null if neither a usable bake exists nor one can be written to the cache.
+  static std::shared_ptr<BakedModel> findBakedModel(const std::string &filePath, bool reconstructWorldTransforms);
+  /// @param watch If given, receives the drawables built from each mesh.
+  static GameObject &fromBakedModel(Scene &scene, const BakedModel &bakedModel, const std::string &fileFolder, ModelWatch *watch = nullptr);
+
+  static void parseAsync(const std::shared_ptr<AsyncModelLoad> &load);
+  static void createAsyncStructure(const std::shared_ptr<AsyncModelLoad> &load);
+  static void streamMesh(const std::shared_ptr<AsyncModelLoad> &load, uint32 meshIndex);
+  static void streamTexture(const std::shared_ptr<AsyncModelLoad> &load, uint32 textureIndex);
+
+  /// @brief Rebuilds the model's meshes on the loading jobs whenever its file changes, for as long as any of its
+  /// drawables exist. Textures are watched by the TextureLoader.
+  static void watchModel(const std::shared_ptr<ModelWatch> &watch);
+  static void rebuildModel(const std::shared_ptr<ModelWatch> &watch);
+};
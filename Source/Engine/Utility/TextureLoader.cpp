@@ -2,11 +2,18 @@
 
 #include <stdexcept>
 
+#include "../Image/BlockCompression.hpp"
 #include "../Image/ImageLoader.hpp"
+#include "../Image/MipChain.hpp"
 #include "../RenderApi/RenderDevice.hpp"
 #include "../RenderApi/Texture.hpp"
+#include "CompressedTexture.hpp"
+#include "DerivedDataCache.hpp"
+#include "HotReload.hpp"
 
-std::unordered_map<std::string, std::shared_ptr<Texture>> TextureLoader::_cachedTextures;
+std::unordered_map<std::string, std::weak_ptr<Texture>> TextureLoader::_cachedTextures;
+std::atomic<bool> TextureLoader::_compressionEnabled(true);
+std::atomic<MipFilter> TextureLoader::_mipFilter(MipFilter::Kaiser);
 
 TextureFormat toTextureFormat(ImageFormat imageFormat)
 {
@@ -24,34 +31,253 @@ TextureFormat toTextureFormat(ImageFormat imageFormat)
 	}
 }
 
-std::shared_ptr<Texture> TextureLoader::loadFromFile2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, bool generateMips, bool sRgb)
+bool hasTranslucency(const ImageData &imageData)
 {
-	auto iter = _cachedTextures.find(path);
-	if (iter != _cachedTextures.end())
+	if (imageData.getFormat() != ImageFormat::RGBA8)
 	{
-		return iter->second;
+		return false;
 	}
 
-	try
+	const auto &pixels = imageData.getPixelData();
+	for (uint64 i = 3; i < pixels.size(); i += 4)
 	{
-		auto imageData = ImageLoader::loadFromFile(path);
+		if (pixels[i] != 255)
+		{
+			return true;
+		}
+	}
+	return false;
+}
 
-		TextureDesc desc;
-		desc.Format = toTextureFormat(imageData->getFormat());
-		desc.Type = TextureType::Texture2D;
-		desc.Width = imageData->getWidth();
-		desc.Height = imageData->getHeight();
-		auto texture = renderDevice->createTexture(desc, sRgb);
-		texture->writeData(0, 0, imageData);
-		if (generateMips)
+TextureFormat toCompressedFormat(const ImageData &imageData, TextureCompression compression)
+{
+	switch (imageData.getFormat())
+	{
+	case ImageFormat::R8:
+		return TextureFormat::BC4;
+	case ImageFormat::RG8:
+		return TextureFormat::BC5;
+	default:
+		if (compression == TextureCompression::NormalMap)
 		{
-			texture->generateMips();
+			return TextureFormat::BC5;
 		}
-		_cachedTextures[path] = texture;
+		return hasTranslucency(imageData) ? TextureFormat::BC3 : TextureFormat::BC1;
+	}
+}
+
+MipChainDesc createMipChainDesc(bool sRgb, JobSystem *jobSystem)
+{
+	MipChainDesc desc;
+	desc.Filter = TextureLoader::getMipFilter();
+	desc.SRgb = sRgb;
+	desc.Jobs = jobSystem;
+	return desc;
+}
+
+/// @brief Cache keys cover every setting which changes the encoded result, alongside the source file's contents, so
+/// editing or re-exporting a texture never picks up a stale entry.
+uint64 getCompressedCacheKey(uint64 sourceHash, TextureCompression compression, bool generateMips, bool sRgb, MipFilter mipFilter)
+{
+	uint32 settings[] = {COMPRESSED_TEXTURE_VERSION, static_cast<uint32>(compression), generateMips ? 1u : 0u, sRgb ? 1u : 0u, static_cast<uint32>(mipFilter)};
+	return DerivedDataCache::createKey(sourceHash, settings, sizeof(settings));
+}
+
+std::shared_ptr<Texture> TextureLoader::loadFromFile2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, bool generateMips, bool sRgb, TextureCompression compression)
+{
+	if (auto texture = findCached(path))
+	{
+		return texture;
+	}
+	if (compression != TextureCompression::None && isCompressionEnabled())
+	{
+		return createFromCompressed2D(renderDevice, path, *loadCompressed(path, compression, generateMips, sRgb));
+	}
+	return createFromMipChain2D(renderDevice, path, decodeMipChain(path, generateMips, sRgb), sRgb);
+}
+
+std::shared_ptr<ImageData> TextureLoader::decodeFromFile(const std::string &path)
+{
+	try
+	{
+		return ImageLoader::loadFromFile(path);
+	}
+	catch (const std::exception &exception)
+	{
+		throw std::runtime_error("Could not load texture '" + path + "': " + exception.what());
+	}
+}
+
+std::vector<std::shared_ptr<ImageData>> TextureLoader::decodeMipChain(const std::string &path, bool generateMips, bool sRgb, JobSystem *jobSystem)
+{
+	auto imageData = decodeFromFile(path);
+	return generateMips ? MipChain::generate(imageData, createMipChainDesc(sRgb, jobSystem)) : std::vector<std::shared_ptr<ImageData>>{imageData};
+}
+
+std::shared_ptr<Texture> TextureLoader::createFromImage2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, const std::shared_ptr<ImageData> &imageData, bool generateMips, bool sRgb)
+{
+	if (auto texture = findCached(path))
+	{
 		return texture;
 	}
+	auto levels = generateMips ? MipChain::generate(imageData, createMipChainDesc(sRgb, nullptr)) : std::vector<std::shared_ptr<ImageData>>{imageData};
+	return createFromMipChain2D(renderDevice, path, levels, sRgb);
+}
+
+std::shared_ptr<Texture> TextureLoader::createFromMipChain2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, const std::vector<std::shared_ptr<ImageData>> &levels, bool sRgb)
+{
+	if (auto texture = findCached(path))
+	{
+		return texture;
+	}
+
+	TextureDesc desc;
+	desc.Format = toTextureFormat(levels[0]->getFormat());
+	desc.Type = TextureType::Texture2D;
+	desc.Width = levels[0]->getWidth();
+	desc.Height = levels[0]->getHeight();
+	desc.MipLevels = static_cast<uint32>(levels.size());
+	auto texture = renderDevice->createTexture(desc, sRgb);
+	for (uint32 i = 0; i < levels.size(); i++)
+	{
+		texture->writeData(i, 0, levels[i]);
+	}
+	_cachedTextures[path] = texture;
+	watch(path, texture, TextureCompression::None, levels.size() > 1, sRgb);
+	return texture;
+}
+
+std::shared_ptr<Texture> TextureLoader::findCached(const std::string &path)
+{
+	auto iter = _cachedTextures.find(path);
+	if (iter == _cachedTextures.end())
+	{
+		return nullptr;
+	}
+	auto texture = iter->second.lock();
+	if (!texture)
+	{
+		_cachedTextures.erase(iter);
+	}
+	return texture;
+}
+
+std::shared_ptr<CompressedTexture> TextureLoader::loadCompressed(const std::string &path, TextureCompression compression, bool generateMips, bool sRgb, JobSystem *jobSystem)
+{
+	uint64 sourceHash = 0;
+	try
+	{
+		sourceHash = DerivedDataCache::hashFile(path);
+	}
 	catch (const std::exception &exception)
 	{
 		throw std::runtime_error("Could not load texture '" + path + "': " + exception.what());
 	}
-}
\ No newline at end of file
+
+	DerivedDataCache &cache = DerivedDataCache::get();
+	uint64 key = getCompressedCacheKey(sourceHash, compression, generateMips, sRgb, getMipFilter());
+	auto openEntry = [sourceHash](const std::string &cachePath)
+	{
+		std::shared_ptr<CompressedTexture> texture(new CompressedTexture(cachePath));
+		if (texture->getHeader().SourceHash != sourceHash)
+		{
+			throw std::runtime_error("Cache entry " + cachePath + " was encoded from another image");
+		}
+		return texture;
+	};
+	auto cached = cache.load<CompressedTexture>(key, COMPRESSED_TEXTURE_EXTENSION, openEntry);
+	if (cached)
+	{
+		return cached;
+	}
+
+	auto levels = decodeMipChain(path, generateMips, sRgb, jobSystem);
+	const auto &imageData = levels[0];
+	CompressedTextureSource source;
+	source.Format = toCompressedFormat(*imageData, compression);
+	source.Flags = sRgb ? static_cast<uint32>(CTF_SRgb) : 0u;
+	source.Width = imageData->getWidth();
+	source.Height = imageData->getHeight();
+	source.SourceHash = sourceHash;
+	for (const auto &level : levels)
+	{
+		source.Mips.push_back(BlockCompression::compress(*level, source.Format));
+	}
+
+	std::string cachePath = cache.store(key, COMPRESSED_TEXTURE_EXTENSION, [&source](const std::string &temporaryPath)
+																			{ CompressedTexture::write(temporaryPath, source); });
+	return std::shared_ptr<CompressedTexture>(new CompressedTexture(cachePath));
+}
+
+std::shared_ptr<Texture> TextureLoader::createFromCompressed2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, const CompressedTexture &compressedTexture)
+{
+	if (auto texture = findCached(path))
+	{
+		return texture;
+	}
+
+	const CompressedTextureHeader &header = compressedTexture.getHeader();
+	TextureDesc desc;
+	desc.Format = compressedTexture.getFormat();
+	desc.Type = TextureType::Texture2D;
+	desc.Width = header.Width;
+	desc.Height = header.Height;
+	desc.MipLevels = header.MipCount;
+	auto texture = renderDevice->createTexture(desc, compressedTexture.isSRgb());
+	for (uint32 i = 0; i < header.MipCount; i++)
+	{
+		texture->writeCompressedData(i, compressedTexture.getMipData(i), compressedTexture.getMipSize(i));
+	}
+	_cachedTextures[path] = texture;
+	// Only normal maps are encoded to BC5 from images with more than two channels.
+	TextureCompression compression = desc.Format == TextureFormat::BC5 ? TextureCompression::NormalMap : TextureCompression::Colour;
+	watch(path, texture, compression, header.MipCount > 1, compressedTexture.isSRgb());
+	return texture;
+}
+
+void TextureLoader::reload(Texture &texture, const std::string &path, TextureCompression compression, bool generateMips, bool sRgb)
+{
+	// Materials hold the texture itself, so the new image has to fit the storage already allocated for it.
+	const TextureDesc &desc = texture.getDesc();
+	auto checkFits = [&](TextureFormat format, uint32 width, uint32 height, uint32 mipLevels)
+	{
+		if (format != desc.Format || width != desc.Width || height != desc.Height || mipLevels != desc.MipLevels)
+		{
+			throw std::runtime_error("Could not reload texture '" + path + "': its size or format changed, restart to pick it up");
+		}
+	};
+
+	if (compression != TextureCompression::None)
+	{
+		auto compressedTexture = loadCompressed(path, compression, generateMips, sRgb);
+		const CompressedTextureHeader &header = compressedTexture->getHeader();
+		checkFits(compressedTexture->getFormat(), header.Width, header.Height, header.MipCount);
+		for (uint32 i = 0; i < header.MipCount; i++)
+		{
+			texture.writeCompressedData(i, compressedTexture->getMipData(i), compressedTexture->getMipSize(i));
+		}
+		return;
+	}
+
+	auto levels = decodeMipChain(path, generateMips, sRgb);
+	checkFits(toTextureFormat(levels[0]->getFormat()), levels[0]->getWidth(), levels[0]->getHeight(), static_cast<uint32>(levels.size()));
+	for (uint32 i = 0; i < levels.size(); i++)
+	{
+		texture.writeData(i, 0, levels[i]);
+	}
+}
+
+void TextureLoader::watch(const std::string &path, const std::shared_ptr<Texture> &texture, TextureCompression compression, bool generateMips, bool sRgb)
+{
+	std::weak_ptr<Texture> weakTexture = texture;
+	HotReload::get().track({path}, [weakTexture, path, compression, generateMips, sRgb]()
+												 {
+													 auto texture = weakTexture.lock();
+													 if (!texture)
+													 {
+														 return false;
+													 }
+													 reload(*texture, path, compression, generateMips, sRgb);
+													 return true;
+												 });
+}
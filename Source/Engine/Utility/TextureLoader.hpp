@@ -1,16 +1,68 @@
 #pragma once
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
+#include "../Core/Types.hpp"
+#include "../Image/MipChain.hpp"
+
+class CompressedTexture;
+class ImageData;
+class JobSystem;
 class Texture;
 class RenderDevice;
 
+enum class TextureCompression
+{
+	/// Uploaded as decoded.
+	None,
+	/// BC4 for one channel images, BC5 for two, otherwise BC1, or BC3 if any pixel is translucent.
+	Colour,
+	/// BC5 holding the tangent space X and Y, with Z rebuilt in the shader.
+	NormalMap
+};
+
 class TextureLoader
 {
 public:
-	static std::shared_ptr<Texture> loadFromFile2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, bool generateMips = false, bool sRgb = false);
+	static std::shared_ptr<Texture> loadFromFile2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, bool generateMips = false, bool sRgb = false, TextureCompression compression = TextureCompression::None);
+
+	/// @brief Reads and decodes the image at path. Touches neither the render device nor the cache, so is safe to call from worker threads.
+	static std::shared_ptr<ImageData> decodeFromFile(const std::string &path);
+	/// @brief Decodes the image at path and, if asked, builds its mip chain on the CPU, splitting each level across jobSystem
+	/// when given. sRgb images are filtered in linear space. Safe to call from worker threads.
+	static std::vector<std::shared_ptr<ImageData>> decodeMipChain(const std::string &path, bool generateMips, bool sRgb, JobSystem *jobSystem = nullptr);
+	/// @brief Uploads an image decoded by decodeFromFile and caches it under path, generating any mips on the calling thread.
+	/// Must run on the render device's thread.
+	static std::shared_ptr<Texture> createFromImage2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, const std::shared_ptr<ImageData> &imageData, bool generateMips = false, bool sRgb = false);
+	/// @brief Uploads every level returned by decodeMipChain and caches the texture under path. Must run on the render device's thread.
+	static std::shared_ptr<Texture> createFromMipChain2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, const std::vector<std::shared_ptr<ImageData>> &levels, bool sRgb = false);
+	/// @brief Returns a texture loaded from path which is still in use, if there is one.
+	static std::shared_ptr<Texture> findCached(const std::string &path);
+
+	/// @brief Maps the block compressed mip chain of the image at path from the DerivedDataCache, first decoding, mipping and
+	/// encoding it if the cache has no entry for the file's current contents. Safe to call from worker threads.
+	static std::shared_ptr<CompressedTexture> loadCompressed(const std::string &path, TextureCompression compression, bool generateMips, bool sRgb, JobSystem *jobSystem = nullptr);
+	/// @brief Uploads every mip level of a texture returned by loadCompressed. Must run on the render device's thread.
+	static std::shared_ptr<Texture> createFromCompressed2D(std::shared_ptr<RenderDevice> renderDevice, const std::string &path, const CompressedTexture &compressedTexture);
+
+	/// @brief When disabled, loads requesting compression upload the decoded image instead.
+	static void setCompressionEnabled(bool enabled) { _compressionEnabled = enabled; }
+	static bool isCompressionEnabled() { return _compressionEnabled; }
+	/// @brief Filter used for every mip chain generated from then on.
+	static void setMipFilter(MipFilter filter) { _mipFilter = filter; }
+	static MipFilter getMipFilter() { return _mipFilter; }
 
 private:
-	static std::unordered_map<std::string, std::shared_ptr<Texture>> _cachedTextures;
-};
\ No newline at end of file
+	/// @brief Writes the current contents of the file at path into texture, which must still match in size and format.
+	static void reload(Texture &texture, const std::string &path, TextureCompression compression, bool generateMips, bool sRgb);
+	/// @brief Reloads texture whenever the file at path changes, for as long as it is in use.
+	static void watch(const std::string &path, const std::shared_ptr<Texture> &texture, TextureCompression compression, bool generateMips, bool sRgb);
+
+	// Weak so that textures are released once nothing uses them. The DerivedDataCache keeps reloading them cheap.
+	static std::unordered_map<std::string, std::weak_ptr<Texture>> _cachedTextures;
+	static std::atomic<bool> _compressionEnabled;
+	static std::atomic<MipFilter> _mipFilter;
+};
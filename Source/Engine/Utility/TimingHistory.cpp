@@ -0,0 +1,35 @@
+#include "TimingHistory.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+TimingHistory::TimingHistory() : _samples{}, _offset(0), _count(0)
+{
+}
+
+void TimingHistory::push(float32 sampleMs)
+{
+  _samples[_offset] = sampleMs;
+  _offset = (_offset + 1) % TIMING_HISTORY_FRAMES;
+  _count = std::min(_count + 1, TIMING_HISTORY_FRAMES);
+}
+
+float32 TimingHistory::getLatest() const
+{
+  return _count == 0 ? 0.0f : _samples[(_offset + TIMING_HISTORY_FRAMES - 1) % TIMING_HISTORY_FRAMES];
+}
+
+float32 TimingHistory::getMin() const
+{
+  return _count == 0 ? 0.0f : *std::min_element(_samples.begin(), _samples.begin() + _count);
+}
+
+float32 TimingHistory::getMax() const
+{
+  return _count == 0 ? 0.0f : *std::max_element(_samples.begin(), _samples.begin() + _count);
+}
+
+float32 TimingHistory::getAverage() const
+{
+  return _count == 0 ? 0.0f : std::accumulate(_samples.begin(), _samples.begin() + _count, 0.0f) / static_cast<float32>(_count);
+}
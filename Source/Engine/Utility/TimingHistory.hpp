@@ -0,0 +1,30 @@
+#pragma once
+#include <array>
+
+#include "../Core/Types.hpp"
+
+static const uint32 TIMING_HISTORY_FRAMES = 120;
+
+/// @brief Fixed size ring of frame timings in milliseconds.
+class TimingHistory
+{
+public:
+  TimingHistory();
+
+  void push(float32 sampleMs);
+
+  uint32 getCount() const { return _count; }
+  /// @brief Offset of the oldest sample, suitable for ImGui::PlotLines.
+  uint32 getOffset() const { return _count < TIMING_HISTORY_FRAMES ? 0 : _offset; }
+  const float32 *getSamples() const { return _samples.data(); }
+
+  float32 getLatest() const;
+  float32 getMin() const;
+  float32 getMax() const;
+  float32 getAverage() const;
+
+private:
+  std::array<float32, TIMING_HISTORY_FRAMES> _samples;
+  uint32 _offset;
+  uint32 _count;
+};
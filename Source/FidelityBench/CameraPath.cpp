@@ -0,0 +1,34 @@
+#include "CameraPath.h"
+
+#include <cmath>
+#include <stdexcept>
+
+CameraPath::CameraPath(const std::vector<Vector3> &controlPoints) : _controlPoints(controlPoints)
+{
+  if (_controlPoints.size() < 4)
+  {
+    throw std::runtime_error("A camera path needs at least four control points");
+  }
+}
+
+Vector3 CameraPath::evaluate(float32 t) const
+{
+  int32 count = static_cast<int32>(_controlPoints.size());
+  float32 wrapped = t - std::floor(t);
+  float32 segment = wrapped * count;
+  int32 i = static_cast<int32>(segment);
+  float32 u = segment - static_cast<float32>(i);
+
+  const Vector3 &p0 = _controlPoints[(i - 1 + count) % count];
+  const Vector3 &p1 = _controlPoints[i % count];
+  const Vector3 &p2 = _controlPoints[(i + 1) % count];
+  const Vector3 &p3 = _controlPoints[(i + 2) % count];
+
+  float32 u2 = u * u;
+  float32 u3 = u2 * u;
+  return ((p1 * 2.0f) +
+          (p2 - p0) * u +
+          (p0 * 2.0f - p1 * 5.0f + p2 * 4.0f - p3) * u2 +
+          (p1 * 3.0f - p0 - p2 * 3.0f + p3) * u3) *
+         0.5f;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+
+#include "../Engine/Core/Maths.h"
+
+/// @brief A closed Catmull-Rom spline used to drive the camera along a repeatable path.
+class CameraPath
+{
+public:
+  CameraPath(const std::vector<Vector3> &controlPoints);
+
+  /// @brief Evaluates the position on the path.
+  /// @param t Normalised path parameter where [0, 1) covers the entire loop.
+  Vector3 evaluate(float32 t) const;
+
+private:
+  std::vector<Vector3> _controlPoints;
+};
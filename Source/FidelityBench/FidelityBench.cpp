@@ -0,0 +1,545 @@
+#include "FidelityBench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <regex>
+#include <sstream>
+
+#include "../Engine/Core/BoundingVolumeHierarchy.h"
+#include "../Engine/Core/GameObject.h"
+#include "../Engine/Core/GameObjectBuilder.h"
+#include "../Engine/Core/InputHandler.h"
+#include "../Engine/Core/JobSystem.h"
+#include "../Engine/Core/Scene.h"
+#include "../Engine/Geometry/MeshFactory.h"
+#include "../Engine/Maths/AabbArray.hpp"
+#include "../Engine/Maths/Frustrum.hpp"
+#include "../Engine/Maths/Ray.hpp"
+#include "../Engine/RenderApi/Null/NullRenderDevice.hpp"
+#include "../Engine/Rendering/Camera.h"
+#include "../Engine/Rendering/Drawable.h"
+#include "../Engine/Rendering/Light.h"
+#include "../Engine/Rendering/Material.h"
+#include "../Engine/Rendering/Renderer.h"
+#include "../Engine/Utility/ModelLoader.hpp"
+#include "../Engine/Utility/TextureLoader.hpp"
+
+static const char *SPONZA_MODEL_PATH = "./Models/sponza_pbr/sponza.obj";
+static const float32 FRAME_DELTA_MS = 1000.0f / 60.0f;
+
+FidelityBench::FidelityBench(const FidelityBenchDesc &desc) : _desc(desc),
+                                                              _inputHandler(new InputHandler())
+{
+  RenderDeviceDesc renderDeviceDesc;
+  renderDeviceDesc.RenderWidth = desc.Width;
+  renderDeviceDesc.RenderHeight = desc.Height;
+  _renderDevice.reset(new NullRenderDevice(renderDeviceDesc));
+  // Only the counters are needed, appending every command would add allocation noise to the timings.
+  _renderDevice->setRecordingEnabled(false);
+}
+
+int32 FidelityBench::run()
+{
+  std::vector<SceneResult> results;
+  for (const auto &sceneName : _desc.Scenes)
+  {
+    std::cout << "Running '" << sceneName << "'..." << std::endl;
+    results.push_back(runScene(sceneName));
+    if (results.back().Skipped)
+    {
+      std::cout << "  skipped: " << results.back().SkipReason << std::endl;
+    }
+  }
+
+  writeResults(results);
+  std::cout << "Results written to " << _desc.OutputPath << std::endl;
+
+  if (_desc.BaselinePath.empty())
+  {
+    return 0;
+  }
+  return compareWithBaseline(results);
+}
+
+FidelityBench::SceneResult FidelityBench::runScene(const std::string &name)
+{
+  SceneResult result;
+  result.Name = name;
+
+  Scene scene(_inputHandler);
+  if (_desc.WorkerCount >= 0)
+  {
+    scene.setWorkerCount(static_cast<uint32>(_desc.WorkerCount));
+  }
+  if (!scene.init(Vector2I(_desc.Width, _desc.Height), _renderDevice))
+  {
+    result.Skipped = true;
+    result.SkipReason = "renderer failed to initialise";
+    return result;
+  }
+  scene.getRenderer()->setStateSortingEnabled(_desc.StateSortingEnabled);
+
+  GameObject &camera = addCamera(scene, name == "stress" || name == "culling" ? 200.0f : 500.0f);
+  addDirectionalLight(scene);
+
+  if (name == "bvh")
+  {
+    runBvhBenchmark(scene, camera, result);
+    return result;
+  }
+  else if (name == "culling")
+  {
+    populateCullingScene(scene);
+  }
+  else if (name == "sponza")
+  {
+    if (!populateSponzaScene(scene))
+    {
+      result.Skipped = true;
+      result.SkipReason = std::string("model not found at ") + SPONZA_MODEL_PATH;
+      return result;
+    }
+  }
+  else if (name == "stress")
+  {
+    populateStressScene(scene);
+  }
+  else
+  {
+    result.Skipped = true;
+    result.SkipReason = "unknown scene";
+    return result;
+  }
+  result.DrawableCount = scene.getComponentCount(ComponentType::Drawable);
+
+  CameraPath path(buildCameraPath(name));
+  std::map<std::string, std::vector<float64>> samples;
+  std::vector<std::string> seriesOrder = {"Frame", "Scene Prep"};
+  uint64 drawCalls = 0;
+  uint64 materialChanges = 0, meshChanges = 0, textureBinds = 0;
+
+  for (uint32 frame = 0; frame < _desc.WarmupFrameCount + _desc.FrameCount; frame++)
+  {
+    float32 t = static_cast<float32>(frame) / static_cast<float32>(_desc.WarmupFrameCount + _desc.FrameCount);
+    camera.transform().lookAt(path.evaluate(t), getCameraTarget(name, path, t));
+
+    _renderDevice->resetCommandLog();
+    auto start = std::chrono::high_resolution_clock::now();
+    scene.update(FRAME_DELTA_MS);
+    scene.drawFrame();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    if (frame < _desc.WarmupFrameCount)
+    {
+      continue;
+    }
+
+    samples["Frame"].push_back(std::chrono::duration<float64, std::milli>(end - start).count());
+    samples["Scene Prep"].push_back(static_cast<float64>(scene.getScenePrepDuration()) * 1e-6);
+    for (const auto &timing : scene.getRenderer()->getRenderPassTimings())
+    {
+      if (samples.find(timing.Name) == samples.end())
+      {
+        seriesOrder.push_back(timing.Name);
+      }
+      samples[timing.Name].push_back(static_cast<float64>(timing.Duration) * 1e-6);
+    }
+    drawCalls += _renderDevice->getCommandCount(NullCommandType::Draw) + _renderDevice->getCommandCount(NullCommandType::DrawIndexed);
+    const RenderStateStats &stateStats = scene.getRenderer()->getStateStats();
+    materialChanges += stateStats.MaterialChanges;
+    meshChanges += stateStats.MeshChanges;
+    textureBinds += stateStats.TextureBinds;
+  }
+
+  for (const auto &seriesName : seriesOrder)
+  {
+    result.Timings.push_back({seriesName, samples[seriesName]});
+  }
+  result.AverageDrawCalls = _desc.FrameCount > 0 ? static_cast<float64>(drawCalls) / _desc.FrameCount : 0.0;
+  result.AverageMaterialChanges = _desc.FrameCount > 0 ? static_cast<float64>(materialChanges) / _desc.FrameCount : 0.0;
+  result.AverageMeshChanges = _desc.FrameCount > 0 ? static_cast<float64>(meshChanges) / _desc.FrameCount : 0.0;
+  result.AverageTextureBinds = _desc.FrameCount > 0 ? static_cast<float64>(textureBinds) / _desc.FrameCount : 0.0;
+  return result;
+}
+
+/// @brief Times frustrum culling through the SIMD kernel and the BVH, and picking and refitting through the BVH,
+/// against plain linear scans over random boxes at increasing object counts.
+void FidelityBench::runBvhBenchmark(Scene &scene, GameObject &camera, SceneResult &result)
+{
+  const std::pair<uint32, std::string> objectCounts[] = {{1000, "1k"}, {10000, "10k"}, {100000, "100k"}};
+  std::vector<uint64> visible;
+  std::vector<uint32> simdVisible;
+  visible.reserve(100000);
+  simdVisible.reserve(100000);
+
+  for (const auto &objectCount : objectCounts)
+  {
+    std::mt19937 generator(1337);
+    float32 halfExtent = std::cbrt(static_cast<float32>(objectCount.first)) * 1.5f;
+    std::uniform_real_distribution<float32> position(-halfExtent, halfExtent);
+    std::uniform_real_distribution<float32> extent(0.25f, 1.0f);
+    std::uniform_real_distribution<float32> nudge(-0.05f, 0.05f);
+
+    std::vector<Aabb> boxes;
+    std::vector<int32> proxies;
+    AabbArray bounds;
+    BoundingVolumeHierarchy bvh;
+    for (uint32 i = 0; i < objectCount.first; i++)
+    {
+      boxes.push_back(Aabb(Vector3(position(generator), position(generator), position(generator)),
+                           extent(generator), extent(generator), extent(generator)));
+      proxies.push_back(bvh.insert(boxes.back(), i));
+      bounds.add(boxes.back());
+    }
+
+    std::vector<float64> linearCull, simdCull, bvhCull, linearPick, bvhPick, bvhRefit;
+    uint32 mismatches = 0;
+    for (uint32 frame = 0; frame < _desc.WarmupFrameCount + _desc.FrameCount; frame++)
+    {
+      float32 angle = Math::TwoPi * static_cast<float32>(frame) / static_cast<float32>(_desc.WarmupFrameCount + _desc.FrameCount);
+      float32 radius = halfExtent * (1.2f + 0.6f * std::sin(angle * 3.0f));
+      Vector3 eye(std::cos(angle) * radius, halfExtent * 0.3f, std::sin(angle) * radius);
+      camera.transform().lookAt(eye, Vector3::Zero);
+      scene.update(FRAME_DELTA_MS);
+
+      const Frustrum &frustrum = camera.getComponent<Camera>().getFustrum();
+      Ray ray(eye, Vector3::Normalize(Vector3(position(generator), position(generator), position(generator)) * 0.25f - eye));
+
+      auto start = std::chrono::high_resolution_clock::now();
+      uint64 linearVisible = 0;
+      for (const auto &box : boxes)
+      {
+        uint32 planeMask = FRUSTRUM_ALL_PLANES;
+        linearVisible += frustrum.intersects(box, planeMask) != FrustrumIntersection::Outside ? 1 : 0;
+      }
+      auto linearCullEnd = std::chrono::high_resolution_clock::now();
+
+      simdVisible.clear();
+      frustrum.cull(bounds, simdVisible);
+      auto simdCullEnd = std::chrono::high_resolution_clock::now();
+
+      visible.clear();
+      bvh.query(frustrum, visible);
+      auto bvhCullEnd = std::chrono::high_resolution_clock::now();
+
+      float32 nearest = std::numeric_limits<float32>::max();
+      for (const auto &box : boxes)
+      {
+        float32 distance = 0.0f;
+        if (ray.Intersects(box, distance) && distance < nearest)
+        {
+          nearest = distance;
+        }
+      }
+      auto linearPickEnd = std::chrono::high_resolution_clock::now();
+
+      uint64 picked = 0;
+      float32 bvhNearest = std::numeric_limits<float32>::max();
+      bvh.raycast(ray, picked, bvhNearest);
+      auto bvhPickEnd = std::chrono::high_resolution_clock::now();
+
+      // Roughly one in a hundred objects moves a little each frame, as they would in a mostly static scene.
+      for (uint32 i = frame % 100; i < boxes.size(); i += 100)
+      {
+        Vector3 boxExtents(boxes[i].getExtents());
+        boxes[i] = Aabb(boxes[i].getCenter() + Vector3(nudge(generator), nudge(generator), nudge(generator)), boxExtents.X, boxExtents.Y, boxExtents.Z);
+        bvh.move(proxies[i], boxes[i]);
+        bounds.set(i, boxes[i]);
+      }
+      auto bvhRefitEnd = std::chrono::high_resolution_clock::now();
+
+      if (linearVisible != visible.size() || linearVisible != simdVisible.size() || std::abs(nearest - bvhNearest) > 1e-3f)
+      {
+        mismatches++;
+      }
+      if (frame < _desc.WarmupFrameCount)
+      {
+        continue;
+      }
+
+      linearCull.push_back(std::chrono::duration<float64, std::milli>(linearCullEnd - start).count());
+      simdCull.push_back(std::chrono::duration<float64, std::milli>(simdCullEnd - linearCullEnd).count());
+      bvhCull.push_back(std::chrono::duration<float64, std::milli>(bvhCullEnd - simdCullEnd).count());
+      linearPick.push_back(std::chrono::duration<float64, std::milli>(linearPickEnd - bvhCullEnd).count());
+      bvhPick.push_back(std::chrono::duration<float64, std::milli>(bvhPickEnd - linearPickEnd).count());
+      bvhRefit.push_back(std::chrono::duration<float64, std::milli>(bvhRefitEnd - bvhPickEnd).count());
+    }
+
+    if (mismatches > 0)
+    {
+      std::cerr << "  BVH results differed from the linear scan on " << mismatches << " frames at " << objectCount.second << std::endl;
+    }
+
+    result.Timings.push_back({"Linear Cull " + objectCount.second, linearCull});
+    result.Timings.push_back({"SIMD Cull " + objectCount.second, simdCull});
+    result.Timings.push_back({"BVH Cull " + objectCount.second, bvhCull});
+    result.Timings.push_back({"Linear Pick " + objectCount.second, linearPick});
+    result.Timings.push_back({"BVH Pick " + objectCount.second, bvhPick});
+    result.Timings.push_back({"BVH Refit " + objectCount.second, bvhRefit});
+    result.DrawableCount = objectCount.first;
+  }
+}
+
+GameObject &FidelityBench::addCamera(Scene &scene, float32 farClip)
+{
+  GameObject &camera = GameObjectBuilder(scene)
+                           .withName("mainCamera")
+                           .withComponent(scene.createComponent<Camera>()
+                                              .setPerspective(Degree(67.67f), _desc.Width, _desc.Height, 0.1f, farClip))
+                           .build();
+  scene.addChildToNode(scene.getRoot(), camera);
+  return camera;
+}
+
+void FidelityBench::addDirectionalLight(Scene &scene)
+{
+  scene.addChildToNode(scene.getRoot(), GameObjectBuilder(scene)
+                                            .withName("directionalLight")
+                                            .withComponent(scene.createComponent<Light>()
+                                                               .setLightType(LightType::Directional)
+                                                               .setColour(Colour(244, 233, 155))
+                                                               .setIntensity(1.0f))
+                                            .withRotation(Quaternion(Degree(36.139), Degree(-72.174), Degree(-30.861f)))
+                                            .build());
+}
+
+/// @brief Mirrors the CullingTest sample: a 10x10x10 grid of textured cubes sharing a single material.
+void FidelityBench::populateCullingScene(Scene &scene)
+{
+  std::shared_ptr<Material> material(new Material());
+  material->setDiffuseTexture(TextureLoader::loadFromFile2D(_renderDevice, "./Textures/crate0_diffuse.png", true, true));
+  material->setNormalTexture(TextureLoader::loadFromFile2D(_renderDevice, "./Textures/crate0_normal.png", false, false));
+  material->setMetallicTexture(TextureLoader::loadFromFile2D(_renderDevice, "./Textures/crate0_bump.png", false, false));
+
+  auto mesh = MeshFactory::createCube();
+  uint32 count = 0;
+  for (int32 i = -5; i < 5; i++)
+  {
+    for (int32 j = -5; j < 5; j++)
+    {
+      for (int32 k = -5; k < 5; k++)
+      {
+        scene.addChildToNode(scene.getRoot(), GameObjectBuilder(scene)
+                                                  .withName("cube" + std::to_string(count++))
+                                                  .withComponent(scene.createComponent<Drawable>()
+                                                                     .setMesh(mesh)
+                                                                     .setMaterial(material))
+                                                  .withPosition(Vector3(3 * i, 3 * j, 3 * k))
+                                                  .build());
+      }
+    }
+  }
+}
+
+bool FidelityBench::populateSponzaScene(Scene &scene)
+{
+  if (!std::ifstream(SPONZA_MODEL_PATH).good())
+  {
+    return false;
+  }
+
+  auto &sponzaNode = ModelLoader::fromFile(scene, SPONZA_MODEL_PATH, true);
+  sponzaNode.transform().setScale(Vector3(0.1, 0.1, 0.1));
+  scene.addChildToNode(scene.getRoot(), sponzaNode);
+
+  const Vector3 lightPositions[] = {Vector3(95.0f, 8.0f, 0.0f), Vector3(-51.0f, 8.0f, 0.0f), Vector3(12.0f, 8.0f, 0.0f)};
+  for (uint32 i = 0; i < 3; i++)
+  {
+    scene.addChildToNode(scene.getRoot(), GameObjectBuilder(scene)
+                                              .withName("light" + std::to_string(i))
+                                              .withComponent(scene.createComponent<Light>()
+                                                                 .setColour(Colour(150, 150, 150))
+                                                                 .setRadius(70.0f)
+                                                                 .setCastShadows(true))
+                                              .withPosition(lightPositions[i])
+                                              .build());
+  }
+  return true;
+}
+
+/// @brief Scatters a configurable number of untextured meshes with a handful of materials through a cube volume.
+void FidelityBench::populateStressScene(Scene &scene)
+{
+  std::mt19937 generator(1337);
+  float32 halfExtent = std::cbrt(static_cast<float32>(_desc.StressObjectCount)) * 1.5f;
+  std::uniform_real_distribution<float32> position(-halfExtent, halfExtent);
+  std::uniform_real_distribution<float32> unit(0.0f, 1.0f);
+
+  std::vector<std::shared_ptr<StaticMesh>> meshes = {MeshFactory::createCube(), MeshFactory::createUvSphere(), MeshFactory::createIcosphere(2)};
+  std::vector<std::shared_ptr<Material>> materials;
+  for (uint32 i = 0; i < 8; i++)
+  {
+    std::shared_ptr<Material> material(new Material());
+    material->setDiffuseColour(Colour(unit(generator), unit(generator), unit(generator)));
+    material->setMetalness(unit(generator));
+    material->setRoughness(unit(generator));
+    materials.push_back(material);
+  }
+
+  for (uint32 i = 0; i < _desc.StressObjectCount; i++)
+  {
+    scene.addChildToNode(scene.getRoot(), GameObjectBuilder(scene)
+                                              .withName("object" + std::to_string(i))
+                                              .withComponent(scene.createComponent<Drawable>()
+                                                                 .setMesh(meshes[i % meshes.size()])
+                                                                 .setMaterial(materials[i % materials.size()]))
+                                              .withPosition(Vector3(position(generator), position(generator), position(generator)))
+                                              .build());
+  }
+
+  for (uint32 i = 0; i < 16; i++)
+  {
+    scene.addChildToNode(scene.getRoot(), GameObjectBuilder(scene)
+                                              .withName("light" + std::to_string(i))
+                                              .withComponent(scene.createComponent<Light>()
+                                                                 .setColour(Colour(unit(generator), unit(generator), unit(generator)))
+                                                                 .setRadius(halfExtent * 0.5f))
+                                              .withPosition(Vector3(position(generator), position(generator), position(generator)))
+                                              .build());
+  }
+}
+
+CameraPath FidelityBench::buildCameraPath(const std::string &name) const
+{
+  if (name == "sponza")
+  {
+    // Walks the length of the atrium at head height and back along the opposite colonnade.
+    return CameraPath({Vector3(-105.0f, 15.0f, 9.0f),
+                       Vector3(-40.0f, 12.0f, 20.0f),
+                       Vector3(40.0f, 12.0f, 20.0f),
+                       Vector3(105.0f, 15.0f, 0.0f),
+                       Vector3(40.0f, 30.0f, -20.0f),
+                       Vector3(-40.0f, 30.0f, -20.0f)});
+  }
+
+  // Orbits the origin while moving in and out so objects repeatedly enter and leave the frustum.
+  float32 radius = name == "stress" ? std::cbrt(static_cast<float32>(_desc.StressObjectCount)) * 2.5f : 25.0f;
+  std::vector<Vector3> controlPoints;
+  for (uint32 i = 0; i < 8; i++)
+  {
+    float32 angle = Math::TwoPi * static_cast<float32>(i) / 8.0f;
+    float32 r = radius * (i % 2 == 0 ? 1.0f : 0.4f);
+    controlPoints.push_back(Vector3(std::cos(angle) * r, radius * 0.3f * std::sin(angle * 2.0f), std::sin(angle) * r));
+  }
+  return CameraPath(controlPoints);
+}
+
+Vector3 FidelityBench::getCameraTarget(const std::string &name, const CameraPath &path, float32 t) const
+{
+  if (name == "sponza")
+  {
+    return path.evaluate(t + 0.01f);
+  }
+  return Vector3::Zero;
+}
+
+void FidelityBench::writeResults(const std::vector<SceneResult> &results) const
+{
+  std::ofstream out(_desc.OutputPath);
+  if (!out)
+  {
+    throw std::runtime_error("Could not open '" + _desc.OutputPath + "' for writing");
+  }
+
+  out << std::fixed << std::setprecision(4);
+  out << "{\n";
+  out << "  \"device\": \"null\",\n";
+  out << "  \"width\": " << _desc.Width << ",\n";
+  out << "  \"height\": " << _desc.Height << ",\n";
+  out << "  \"frames\": " << _desc.FrameCount << ",\n";
+  out << "  \"warmupFrames\": " << _desc.WarmupFrameCount << ",\n";
+  out << "  \"stateSorting\": " << (_desc.StateSortingEnabled ? "true" : "false") << ",\n";
+  out << "  \"workers\": " << (_desc.WorkerCount >= 0 ? static_cast<uint32>(_desc.WorkerCount) : JobSystem::defaultWorkerCount()) << ",\n";
+  out << "  \"scenes\": [\n";
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const auto &result = results[i];
+    out << "    {\n";
+    out << "      \"name\": \"" << result.Name << "\",\n";
+    out << "      \"skipped\": " << (result.Skipped ? "true" : "false") << ",\n";
+    out << "      \"drawables\": " << result.DrawableCount << ",\n";
+    out << "      \"averageDrawCalls\": " << result.AverageDrawCalls << ",\n";
+    out << "      \"averageMaterialChanges\": " << result.AverageMaterialChanges << ",\n";
+    out << "      \"averageMeshChanges\": " << result.AverageMeshChanges << ",\n";
+    out << "      \"averageTextureBinds\": " << result.AverageTextureBinds << ",\n";
+    out << "      \"timingsMs\": {\n";
+    for (size_t j = 0; j < result.Timings.size(); j++)
+    {
+      const auto &series = result.Timings[j];
+      // Each series is kept on a single line keyed by "scene/pass" so baselines can be compared without a JSON parser.
+      out << "        \"" << result.Name << "/" << series.Name << "\": {"
+          << "\"p50\": " << percentile(series.SamplesMs, 0.50) << ", "
+          << "\"p95\": " << percentile(series.SamplesMs, 0.95) << ", "
+          << "\"p99\": " << percentile(series.SamplesMs, 0.99) << "}"
+          << (j + 1 < result.Timings.size() ? "," : "") << "\n";
+    }
+    out << "      }\n";
+    out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n";
+  out << "}\n";
+}
+
+int32 FidelityBench::compareWithBaseline(const std::vector<SceneResult> &results) const
+{
+  std::ifstream in(_desc.BaselinePath);
+  if (!in)
+  {
+    std::cerr << "Could not open baseline '" << _desc.BaselinePath << "'" << std::endl;
+    return 2;
+  }
+
+  std::map<std::string, float64> baselineP95;
+  std::regex seriesPattern("\"([^\"]+)\": \\{\"p50\": ([-0-9.eE+]+), \"p95\": ([-0-9.eE+]+)");
+  std::string line;
+  while (std::getline(in, line))
+  {
+    std::smatch match;
+    if (std::regex_search(line, match, seriesPattern))
+    {
+      baselineP95[match[1].str()] = std::stod(match[3].str());
+    }
+  }
+
+  int32 regressions = 0;
+  for (const auto &result : results)
+  {
+    for (const auto &series : result.Timings)
+    {
+      auto iter = baselineP95.find(result.Name + "/" + series.Name);
+      if (iter == baselineP95.end() || iter->second <= 0.0)
+      {
+        continue;
+      }
+
+      float64 current = percentile(series.SamplesMs, 0.95);
+      if (current > iter->second * (1.0 + _desc.Tolerance))
+      {
+        std::cerr << "Regression in " << iter->first << ": p95 " << current << " ms vs baseline " << iter->second << " ms" << std::endl;
+        regressions++;
+      }
+    }
+  }
+  return regressions > 0 ? 1 : 0;
+}
+
+float64 FidelityBench::percentile(std::vector<float64> samples, float64 p)
+{
+  if (samples.empty())
+  {
+    return 0.0;
+  }
+
+  // Nearest-rank percentile.
+  size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+  size_t index = std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0);
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
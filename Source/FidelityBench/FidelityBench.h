@@ -0,0 +1,83 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Engine/Core/Types.hpp"
+#include "../Engine/Maths/Vector3.hpp"
+#include "CameraPath.h"
+
+class GameObject;
+class InputHandler;
+class NullRenderDevice;
+class Scene;
+
+struct FidelityBenchDesc
+{
+  uint32 Width = 1920;
+  uint32 Height = 1080;
+  uint32 FrameCount = 600;
+  uint32 WarmupFrameCount = 30;
+  uint32 StressObjectCount = 10000;
+  /// @brief Scene prep worker threads, -1 picks one fewer than the number of hardware threads.
+  int32 WorkerCount = -1;
+  /// @brief Submits opaque and shadow draws purely front to back, to compare state change counts against the default
+  /// state sorted order.
+  bool StateSortingEnabled = true;
+  /// @brief "bvh" is also available but not run by default, it times scene culling and picking in isolation.
+  std::vector<std::string> Scenes = {"culling", "sponza", "stress"};
+  std::string OutputPath = "FidelityBench.json";
+  /// @brief Optional results file from a previous run. Any p95 that regresses by more than Tolerance fails the run.
+  std::string BaselinePath;
+  float64 Tolerance = 0.1;
+};
+
+/// @brief Replays scripted camera paths through benchmark scenes on a headless device and reports per-pass CPU time percentiles.
+class FidelityBench
+{
+public:
+  FidelityBench(const FidelityBenchDesc &desc);
+
+  int32 run();
+
+private:
+  struct TimingSeries
+  {
+    std::string Name;
+    std::vector<float64> SamplesMs;
+  };
+
+  struct SceneResult
+  {
+    std::string Name;
+    bool Skipped = false;
+    std::string SkipReason;
+    uint64 DrawableCount = 0;
+    float64 AverageDrawCalls = 0.0;
+    float64 AverageMaterialChanges = 0.0;
+    float64 AverageMeshChanges = 0.0;
+    float64 AverageTextureBinds = 0.0;
+    std::vector<TimingSeries> Timings;
+  };
+
+  SceneResult runScene(const std::string &name);
+  void runBvhBenchmark(Scene &scene, GameObject &camera, SceneResult &result);
+
+  GameObject &addCamera(Scene &scene, float32 farClip);
+  void addDirectionalLight(Scene &scene);
+  void populateCullingScene(Scene &scene);
+  bool populateSponzaScene(Scene &scene);
+  void populateStressScene(Scene &scene);
+  CameraPath buildCameraPath(const std::string &name) const;
+  Vector3 getCameraTarget(const std::string &name, const CameraPath &path, float32 t) const;
+
+  void writeResults(const std::vector<SceneResult> &results) const;
+  int32 compareWithBaseline(const std::vector<SceneResult> &results) const;
+
+  static float64 percentile(std::vector<float64> samples, float64 p);
+
+private:
+  FidelityBenchDesc _desc;
+  std::shared_ptr<NullRenderDevice> _renderDevice;
+  std::shared_ptr<InputHandler> _inputHandler;
+};
@@ -0,0 +1,111 @@
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "FidelityBench.h"
+
+void printUsage()
+{
+  std::cout << "Usage: FidelityBench [options]\n"
+            << "  --scenes <a,b,..>   Scenes to run: culling, sponza, stress, bvh (default: all but bvh)\n"
+            << "  --frames <n>        Measured frames per scene (default: 600)\n"
+            << "  --warmup <n>        Unmeasured warmup frames per scene (default: 30)\n"
+            << "  --objects <n>       Object count for the stress scene (default: 10000)\n"
+            << "  --threads <n>       Scene prep worker threads, 0 runs single threaded (default: cores - 1)\n"
+            << "  --unsorted-draws    Submit draws front to back only, to compare state changes against the default\n"
+            << "  --width <n>         Render width (default: 1920)\n"
+            << "  --height <n>        Render height (default: 1080)\n"
+            << "  --output <path>     Results file (default: FidelityBench.json)\n"
+            << "  --baseline <path>   Fail when a p95 regresses against this results file\n"
+            << "  --tolerance <f>     Allowed relative p95 regression (default: 0.1)\n";
+}
+
+int main(int argc, char **argv)
+{
+  FidelityBenchDesc desc;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if (arg == "--help" || arg == "-h")
+    {
+      printUsage();
+      return 0;
+    }
+    if (arg == "--unsorted-draws")
+    {
+      desc.StateSortingEnabled = false;
+      continue;
+    }
+    if (i + 1 >= argc)
+    {
+      std::cerr << "Missing value for " << arg << std::endl;
+      printUsage();
+      return 2;
+    }
+
+    std::string value(argv[++i]);
+    if (arg == "--scenes")
+    {
+      desc.Scenes.clear();
+      std::stringstream stream(value);
+      std::string scene;
+      while (std::getline(stream, scene, ','))
+      {
+        desc.Scenes.push_back(scene);
+      }
+    }
+    else if (arg == "--frames")
+    {
+      desc.FrameCount = std::stoul(value);
+    }
+    else if (arg == "--warmup")
+    {
+      desc.WarmupFrameCount = std::stoul(value);
+    }
+    else if (arg == "--objects")
+    {
+      desc.StressObjectCount = std::stoul(value);
+    }
+    else if (arg == "--threads")
+    {
+      desc.WorkerCount = std::stoi(value);
+    }
+    else if (arg == "--width")
+    {
+      desc.Width = std::stoul(value);
+    }
+    else if (arg == "--height")
+    {
+      desc.Height = std::stoul(value);
+    }
+    else if (arg == "--output")
+    {
+      desc.OutputPath = value;
+    }
+    else if (arg == "--baseline")
+    {
+      desc.BaselinePath = value;
+    }
+    else if (arg == "--tolerance")
+    {
+      desc.Tolerance = std::stod(value);
+    }
+    else
+    {
+      std::cerr << "Unknown option " << arg << std::endl;
+      printUsage();
+      return 2;
+    }
+  }
+
+  try
+  {
+    FidelityBench bench(desc);
+    return bench.run();
+  }
+  catch (const std::exception &exception)
+  {
+    std::cerr << "FidelityBench failed: " << exception.what() << std::endl;
+    return 3;
+  }
+}
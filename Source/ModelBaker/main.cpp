@@ -0,0 +1,84 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Engine/Utility/ModelLoader.hpp"
+
+void printUsage()
+{
+  std::cout << "Usage: ModelBaker [options] <model> [<model> ..]\n"
+            << "  Writes each model to <model>" << BAKED_MODEL_EXTENSION << ", which ModelLoader::fromFile then loads instead.\n"
+            << "  --keep-transforms   Bake vertices as authored rather than recentred on each mesh's centroid\n"
+            << "  --stats             Print vertex cache efficiency of each mesh before and after optimization\n";
+}
+
+void printMeshStats(const std::vector<BakedMeshStats> &meshStats)
+{
+  std::cout << std::left << std::setw(32) << "Mesh" << std::right << std::setw(10) << "Triangles" << std::setw(18) << "Vertices"
+            << std::setw(16) << "ACMR" << std::setw(16) << "ATVR" << "\n";
+  for (const auto &mesh : meshStats)
+  {
+    const MeshOptimizationStats &stats = mesh.Optimization;
+    std::cout << std::left << std::setw(32) << mesh.Name.substr(0, 31) << std::right << std::setw(10) << stats.TriangleCount
+              << std::setw(8) << stats.VertexCountBefore << " -> " << std::setw(6) << stats.VertexCountAfter
+              << std::fixed << std::setprecision(3)
+              << std::setw(7) << stats.Before.Acmr << " -> " << std::setw(5) << stats.After.Acmr
+              << std::setw(7) << stats.Before.Atvr << " -> " << std::setw(5) << stats.After.Atvr << "\n";
+  }
+}
+
+int main(int argc, char **argv)
+{
+  bool reconstructWorldTransforms = true;
+  bool printStats = false;
+  int32 bakedCount = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if (arg == "--help" || arg == "-h")
+    {
+      printUsage();
+      return 0;
+    }
+    if (arg == "--keep-transforms")
+    {
+      reconstructWorldTransforms = false;
+      continue;
+    }
+    if (arg == "--stats")
+    {
+      printStats = true;
+      continue;
+    }
+
+    std::string bakedPath = ModelLoader::getBakedPath(arg);
+    try
+    {
+      auto start = std::chrono::high_resolution_clock::now();
+      std::vector<BakedMeshStats> meshStats;
+      ModelLoader::bake(arg, bakedPath, reconstructWorldTransforms, &meshStats);
+      auto end = std::chrono::high_resolution_clock::now();
+      std::cout << "Baked " << arg << " to " << bakedPath << " in "
+                << std::chrono::duration<float64, std::milli>(end - start).count() << " ms" << std::endl;
+      if (printStats)
+      {
+        printMeshStats(meshStats);
+      }
+      bakedCount++;
+    }
+    catch (const std::exception &exception)
+    {
+      std::cerr << "Failed to bake " << arg << ": " << exception.what() << std::endl;
+      return 3;
+    }
+  }
+
+  if (bakedCount == 0)
+  {
+    printUsage();
+    return 2;
+  }
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include "Sponza.h"
 
 #include <iomanip>
+#include <iostream>
 #include <random>
 #include <sstream>
 
@@ -52,13 +53,23 @@ void Sponza::onStart()
                                   .withPosition(Vector3(12.0f, 8.0f, 0.0f))
                                   .build());
 
-  auto &sponzaNode = ModelLoader::fromFile(_scene, "./Models/sponza_pbr/sponza.obj", true);
+  _sponzaImport = ModelLoader::fromFileAsync(_scene, "./Models/sponza_pbr/sponza.obj", true);
+  auto &sponzaNode = _sponzaImport->getRoot();
   sponzaNode.transform().setScale(Vector3(0.1, 0.1, 0.1));
   _scene.addChildToNode(root, sponzaNode);
 }
 
 void Sponza::onUpdate(uint32 dtMs)
 {
+  if (_sponzaImport && _sponzaImport->isFinished())
+  {
+    if (_sponzaImport->getState() == ModelImportState::Failed)
+    {
+      std::cerr << _sponzaImport->getError() << std::endl;
+    }
+    _sponzaImport.reset();
+  }
+
   Vector2I mousePosDelta = _lastMousePos - _currentMousePos;
 
   if (_inputHandler->isButtonPressed(Button::Key_W))
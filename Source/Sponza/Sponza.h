@@ -4,6 +4,7 @@
 #include "../Engine/Core/Fidelity.h"
 
 class GameObject;
+class ModelImport;
 
 class Sponza : public Application
 {
@@ -12,4 +13,7 @@ public:
 
   void onStart() override;
   void onUpdate(uint32 dtMs) override;
+
+private:
+  std::shared_ptr<ModelImport> _sponzaImport;
 };
@@ -0,0 +1,151 @@
+#include "catch.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "../Engine/Utility/BakedModel.hpp"
+
+namespace
+{
+  const std::string BAKED_MODEL_TEST_PATH = "BakedModelTest.fmdl";
+
+  BakedModelSource buildTestSource()
+  {
+    BakedModelSource source;
+    source.Flags = BMF_ReconstructedWorldTransforms;
+
+    BakedModelSource::Material material;
+    material.DiffuseColour = Vector3(0.5f, 0.25f, 1.0f);
+    material.TexturePaths[static_cast<uint32>(BakedTextureSlot::Diffuse)] = "/textures/diffuse.png";
+    material.TexturePaths[static_cast<uint32>(BakedTextureSlot::Opacity)] = "/textures/opacity.png";
+    source.Materials.push_back(material);
+
+    BakedModelSource::Mesh mesh;
+    mesh.Name = "triangle";
+    mesh.VertexStride = 5 * sizeof(float32);
+    mesh.Vertices = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+                     1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+                     0.0f, 1.0f, 0.0f, 0.0f, 1.0f};
+    mesh.Indices = {0, 1, 2};
+    mesh.Lods = {{0, 3, 0.0f}, {0, 3, 0.25f}};
+    mesh.Bounds = Aabb(Vector3(1.0f, 1.0f, 0.0f), Vector3(0.0f, 0.0f, 0.0f));
+    source.Meshes.push_back(mesh);
+
+    BakedModelSource::Node root;
+    root.Name = "root";
+    source.Nodes.push_back(root);
+
+    BakedModelSource::Node child;
+    child.Name = "triangle";
+    child.Parent = 0;
+    child.MeshIndex = 0;
+    child.Position = Vector3(1.0f, 2.0f, 3.0f);
+    source.Nodes.push_back(child);
+    return source;
+  }
+
+  std::vector<byte> readFile(const std::string &path)
+  {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<byte>(std::istreambuf_iterator<byte>(in), std::istreambuf_iterator<byte>());
+  }
+
+  void writeFile(const std::string &path, const std::vector<byte> &bytes)
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+  }
+}
+
+TEST_CASE("BAKED MODEL")
+{
+  BakedModel::write(BAKED_MODEL_TEST_PATH, buildTestSource());
+
+  SECTION("ROUND TRIP")
+  {
+    BakedModel model(BAKED_MODEL_TEST_PATH);
+    const BakedModelHeader &header = model.getHeader();
+    REQUIRE(header.Version == BAKED_MODEL_VERSION);
+    REQUIRE(header.Flags == BMF_ReconstructedWorldTransforms);
+    REQUIRE(header.MeshCount == 1);
+    REQUIRE(header.MaterialCount == 1);
+    REQUIRE(header.NodeCount == 2);
+
+    const BakedMeshRecord &mesh = model.getMesh(0);
+    REQUIRE(mesh.VertexCount == 3);
+    REQUIRE(mesh.VertexStride == 5 * sizeof(float32));
+    REQUIRE(mesh.IndexCount == 3);
+    REQUIRE(std::string(model.getString(mesh.NameOffset)) == "triangle");
+    REQUIRE(mesh.AabbMax[0] == Approx(1.0f));
+    REQUIRE(mesh.AabbMax[1] == Approx(1.0f));
+    REQUIRE(mesh.AabbMin[0] == Approx(0.0f));
+    REQUIRE(mesh.LodCount == 2);
+    REQUIRE(mesh.LodIndexCounts[1] == 3);
+    REQUIRE(mesh.LodErrors[1] == 0.25f);
+
+    auto vertices = std::static_pointer_cast<const float32>(model.getVertexData(0));
+    REQUIRE(reinterpret_cast<uintptr_t>(vertices.get()) % BAKED_MODEL_ALIGNMENT == 0);
+    REQUIRE(vertices.get()[5] == 1.0f);
+    REQUIRE(vertices.get()[14] == 1.0f);
+    auto indices = model.getIndexData(0);
+    REQUIRE(indices.get()[0] == 0);
+    REQUIRE(indices.get()[2] == 2);
+
+    const BakedMaterialRecord &material = model.getMaterial(0);
+    REQUIRE(material.DiffuseColour[1] == 0.25f);
+    REQUIRE(std::string(model.getString(material.TexturePathOffsets[static_cast<uint32>(BakedTextureSlot::Diffuse)])) == "/textures/diffuse.png");
+    REQUIRE(material.TexturePathOffsets[static_cast<uint32>(BakedTextureSlot::Normal)] == BAKED_MODEL_NONE);
+    REQUIRE(std::string(model.getString(material.TexturePathOffsets[static_cast<uint32>(BakedTextureSlot::Normal)])).empty());
+
+    const BakedNodeRecord &child = model.getNode(1);
+    REQUIRE(child.Parent == 0);
+    REQUIRE(child.MeshIndex == 0);
+    REQUIRE(child.Position[2] == 3.0f);
+    REQUIRE(child.Scale[0] == 1.0f);
+    REQUIRE(child.Rotation[3] == 1.0f);
+    REQUIRE(model.getNode(0).Parent == BAKED_MODEL_NONE);
+  }
+
+  SECTION("STREAMS OUTLIVE THE MODEL")
+  {
+    std::shared_ptr<const uint32> indices;
+    {
+      BakedModel model(BAKED_MODEL_TEST_PATH);
+      indices = model.getIndexData(0);
+    }
+    REQUIRE(indices.get()[1] == 1);
+  }
+
+  SECTION("REJECTS INVALID FILES")
+  {
+    std::vector<byte> bytes = readFile(BAKED_MODEL_TEST_PATH);
+    REQUIRE(bytes.size() % BAKED_MODEL_ALIGNMENT == 0);
+
+    std::vector<byte> truncated(bytes.begin(), bytes.end() - BAKED_MODEL_ALIGNMENT);
+    writeFile(BAKED_MODEL_TEST_PATH, truncated);
+    REQUIRE_THROWS_AS(BakedModel(BAKED_MODEL_TEST_PATH), std::runtime_error);
+
+    std::vector<byte> badVersion(bytes);
+    uint32 version = BAKED_MODEL_VERSION + 1;
+    std::memcpy(badVersion.data() + offsetof(BakedModelHeader, Version), &version, sizeof(version));
+    writeFile(BAKED_MODEL_TEST_PATH, badVersion);
+    REQUIRE_THROWS_AS(BakedModel(BAKED_MODEL_TEST_PATH), std::runtime_error);
+
+    std::vector<byte> badMagic(bytes);
+    badMagic[0] = 'X';
+    writeFile(BAKED_MODEL_TEST_PATH, badMagic);
+    REQUIRE_THROWS_AS(BakedModel(BAKED_MODEL_TEST_PATH), std::runtime_error);
+
+    REQUIRE_THROWS_AS(BakedModel("MissingBakedModel.fmdl"), std::runtime_error);
+
+    BakedModelSource badLods = buildTestSource();
+    badLods.Meshes[0].Lods[1].IndexOffset = 3;
+    BakedModel::write(BAKED_MODEL_TEST_PATH, badLods);
+    REQUIRE_THROWS_AS(BakedModel(BAKED_MODEL_TEST_PATH), std::runtime_error);
+  }
+
+  std::remove(BAKED_MODEL_TEST_PATH.c_str());
+}
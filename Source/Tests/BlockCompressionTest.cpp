@@ -0,0 +1,115 @@
+#include "catch.hpp"
+
+#include <cstdlib>
+
+#include "../Engine/Image/BlockCompression.hpp"
+
+namespace
+{
+  uint32 maxChannelError(const ubyte *expected, const ubyte *actual, uint32 stride, uint32 channels)
+  {
+    uint32 maxError = 0;
+    for (uint32 i = 0; i < 16; i++)
+    {
+      for (uint32 c = 0; c < channels; c++)
+      {
+        maxError = std::max<uint32>(maxError, std::abs(expected[i * stride + c] - actual[i * stride + c]));
+      }
+    }
+    return maxError;
+  }
+}
+
+TEST_CASE("BLOCK COMPRESSION")
+{
+  SECTION("BC1 SOLID BLOCK")
+  {
+    ubyte rgba[64];
+    for (uint32 i = 0; i < 16; i++)
+    {
+      rgba[i * 4] = 255;
+      rgba[i * 4 + 1] = 0;
+      rgba[i * 4 + 2] = 255;
+      rgba[i * 4 + 3] = 255;
+    }
+
+    ubyte block[8];
+    BlockCompression::encodeBC1(rgba, block);
+    ubyte decoded[64];
+    BlockCompression::decodeBC1(block, decoded);
+    REQUIRE(maxChannelError(rgba, decoded, 4, 4) == 0);
+  }
+
+  SECTION("BC1 GRADIENT")
+  {
+    ubyte rgba[64];
+    for (uint32 i = 0; i < 16; i++)
+    {
+      rgba[i * 4] = static_cast<ubyte>(i * 16);
+      rgba[i * 4 + 1] = static_cast<ubyte>(255 - i * 16);
+      rgba[i * 4 + 2] = 64;
+      rgba[i * 4 + 3] = 255;
+    }
+
+    ubyte block[8];
+    BlockCompression::encodeBC1(rgba, block);
+    uint16 colour0 = static_cast<uint16>(block[0] | (block[1] << 8));
+    uint16 colour1 = static_cast<uint16>(block[2] | (block[3] << 8));
+    REQUIRE(colour0 > colour1);
+
+    ubyte decoded[64];
+    BlockCompression::decodeBC1(block, decoded);
+    // Four palette entries over a 240 wide ramp, plus 565 quantization.
+    REQUIRE(maxChannelError(rgba, decoded, 4, 3) <= 48);
+    REQUIRE(decoded[3] == 255);
+  }
+
+  SECTION("BC4 TWO VALUES ARE EXACT")
+  {
+    ubyte values[16];
+    for (uint32 i = 0; i < 16; i++)
+    {
+      values[i] = i % 2 == 0 ? 10 : 200;
+    }
+
+    ubyte block[8];
+    BlockCompression::encodeBC4(values, block);
+    ubyte decoded[16];
+    BlockCompression::decodeBC4(block, decoded);
+    REQUIRE(maxChannelError(values, decoded, 1, 1) == 0);
+  }
+
+  SECTION("BC4 RAMP")
+  {
+    ubyte values[16];
+    for (uint32 i = 0; i < 16; i++)
+    {
+      values[i] = static_cast<ubyte>(i * 17);
+    }
+
+    ubyte block[8];
+    BlockCompression::encodeBC4(values, block);
+    ubyte decoded[16];
+    BlockCompression::decodeBC4(block, decoded);
+    // Eight entries across the full range are at most half a step, 255 / 14, away.
+    REQUIRE(maxChannelError(values, decoded, 1, 1) <= 19);
+  }
+
+  SECTION("COMPRESSES IMAGES WITH PARTIAL BLOCKS")
+  {
+    ImageData image(6, 5, 1, ImageFormat::RGBA8);
+    std::vector<ubyte> pixels(6 * 5 * 4, 128);
+    image.writeData(pixels);
+
+    REQUIRE(BlockCompression::compress(image, TextureFormat::BC1).size() == 4 * 8);
+    REQUIRE(BlockCompression::compress(image, TextureFormat::BC3).size() == 4 * 16);
+    REQUIRE(BlockCompression::compress(image, TextureFormat::BC4).size() == Texture::getCompressedSize(TextureFormat::BC4, 6, 5));
+    REQUIRE(BlockCompression::compress(image, TextureFormat::BC5).size() == Texture::getCompressedSize(TextureFormat::BC5, 6, 5));
+    REQUIRE_THROWS(BlockCompression::compress(image, TextureFormat::BC7));
+
+    auto bc3 = BlockCompression::compress(image, TextureFormat::BC3);
+    ubyte alpha[16];
+    BlockCompression::decodeBC4(bc3.data(), alpha);
+    REQUIRE(alpha[0] == 128);
+  }
+}
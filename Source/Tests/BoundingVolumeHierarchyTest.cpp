@@ -0,0 +1,164 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include "../Engine/Core/BoundingVolumeHierarchy.h"
+#include "../Engine/Maths/AABB.hpp"
+#include "../Engine/Maths/Frustrum.hpp"
+#include "../Engine/Maths/Plane.hpp"
+#include "../Engine/Maths/Ray.hpp"
+
+namespace
+{
+  std::vector<Aabb> buildRandomBoxes(uint32 count)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float32> position(-50.0f, 50.0f);
+    std::uniform_real_distribution<float32> extent(0.1f, 2.0f);
+
+    std::vector<Aabb> boxes;
+    for (uint32 i = 0; i < count; i++)
+    {
+      boxes.push_back(Aabb(Vector3(position(generator), position(generator), position(generator)),
+                           extent(generator), extent(generator), extent(generator)));
+    }
+    return boxes;
+  }
+
+  // An axis aligned box shaped frustrum covering -10..10 on x and y and 0..20 on z.
+  Frustrum buildBoxFrustrum()
+  {
+    return Frustrum(Plane(Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f)),
+                    Plane(Vector3(0.0f, 0.0f, -1.0f), Vector3(0.0f, 0.0f, 20.0f)),
+                    Plane(Vector3(1.0f, 0.0f, 0.0f), Vector3(-10.0f, 0.0f, 0.0f)),
+                    Plane(Vector3(-1.0f, 0.0f, 0.0f), Vector3(10.0f, 0.0f, 0.0f)),
+                    Plane(Vector3(0.0f, -1.0f, 0.0f), Vector3(0.0f, 10.0f, 0.0f)),
+                    Plane(Vector3(0.0f, 1.0f, 0.0f), Vector3(0.0f, -10.0f, 0.0f)));
+  }
+
+  std::vector<uint64> linearQuery(const Frustrum &frustrum, const std::vector<Aabb> &boxes)
+  {
+    std::vector<uint64> visible;
+    for (uint64 i = 0; i < boxes.size(); i++)
+    {
+      uint32 planeMask = FRUSTRUM_ALL_PLANES;
+      if (frustrum.intersects(boxes[i], planeMask) != FrustrumIntersection::Outside)
+      {
+        visible.push_back(i);
+      }
+    }
+    return visible;
+  }
+}
+
+TEST_CASE("BOUNDING VOLUME HIERARCHY")
+{
+  SECTION("INSERT AND REMOVE")
+  {
+    BoundingVolumeHierarchy bvh;
+    REQUIRE(bvh.getProxyCount() == 0);
+    REQUIRE(bvh.getHeight() == 0);
+
+    std::vector<int32> proxies;
+    for (const auto &box : buildRandomBoxes(256))
+    {
+      proxies.push_back(bvh.insert(box, proxies.size()));
+    }
+    REQUIRE(bvh.getProxyCount() == 256);
+    REQUIRE(bvh.getUserData(proxies[17]) == 17);
+    // A balanced tree over 256 leaves stays well below a linked list.
+    REQUIRE(bvh.getHeight() <= 16);
+
+    for (uint32 i = 0; i < proxies.size(); i += 2)
+    {
+      bvh.remove(proxies[i]);
+    }
+    REQUIRE(bvh.getProxyCount() == 128);
+    REQUIRE_THROWS(bvh.remove(proxies[0]));
+  }
+
+  SECTION("FRUSTRUM TEST")
+  {
+    Frustrum frustrum(buildBoxFrustrum());
+
+    uint32 planeMask = FRUSTRUM_ALL_PLANES;
+    REQUIRE(frustrum.intersects(Aabb(Vector3(0.0f, 0.0f, 10.0f), 1.0f, 1.0f, 1.0f), planeMask) == FrustrumIntersection::Inside);
+    REQUIRE(planeMask == 0);
+
+    planeMask = FRUSTRUM_ALL_PLANES;
+    REQUIRE(frustrum.intersects(Aabb(Vector3(10.0f, 0.0f, 10.0f), 1.0f, 1.0f, 1.0f), planeMask) == FrustrumIntersection::Intersecting);
+    REQUIRE(planeMask != 0);
+
+    planeMask = FRUSTRUM_ALL_PLANES;
+    REQUIRE(frustrum.intersects(Aabb(Vector3(0.0f, 0.0f, -5.0f), 1.0f, 1.0f, 1.0f), planeMask) == FrustrumIntersection::Outside);
+  }
+
+  SECTION("QUERY MATCHES LINEAR SCAN")
+  {
+    std::vector<Aabb> boxes(buildRandomBoxes(2000));
+    BoundingVolumeHierarchy bvh;
+    for (uint64 i = 0; i < boxes.size(); i++)
+    {
+      bvh.insert(boxes[i], i);
+    }
+
+    Frustrum frustrum(buildBoxFrustrum());
+    std::vector<uint64> visible;
+    bvh.query(frustrum, visible);
+    std::sort(visible.begin(), visible.end());
+
+    std::vector<uint64> expected(linearQuery(frustrum, boxes));
+    REQUIRE(!expected.empty());
+    REQUIRE(visible == expected);
+  }
+
+  SECTION("MOVE REFITS")
+  {
+    std::vector<Aabb> boxes(buildRandomBoxes(500));
+    BoundingVolumeHierarchy bvh(0.5f);
+    std::vector<int32> proxies;
+    for (uint64 i = 0; i < boxes.size(); i++)
+    {
+      proxies.push_back(bvh.insert(boxes[i], i));
+    }
+
+    // Nudging within the fat margin does not reinsert, moving far does.
+    Vector3 extents(boxes[0].getExtents());
+    boxes[0] = Aabb(boxes[0].getCenter() + Vector3(0.1f, 0.0f, 0.0f), extents.X, extents.Y, extents.Z);
+    REQUIRE(bvh.move(proxies[0], boxes[0]) == false);
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float32> offset(-20.0f, 20.0f);
+    for (uint64 i = 0; i < boxes.size(); i += 3)
+    {
+      extents = boxes[i].getExtents();
+      boxes[i] = Aabb(boxes[i].getCenter() + Vector3(offset(generator), offset(generator), offset(generator)), extents.X, extents.Y, extents.Z);
+      bvh.move(proxies[i], boxes[i]);
+    }
+    REQUIRE(bvh.getProxyCount() == 500);
+
+    Frustrum frustrum(buildBoxFrustrum());
+    std::vector<uint64> visible;
+    bvh.query(frustrum, visible);
+    std::sort(visible.begin(), visible.end());
+    REQUIRE(visible == linearQuery(frustrum, boxes));
+  }
+
+  SECTION("RAYCAST RETURNS NEAREST HIT")
+  {
+    BoundingVolumeHierarchy bvh;
+    bvh.insert(Aabb(Vector3(0.0f, 0.0f, 20.0f), 1.0f, 1.0f, 1.0f), 0);
+    bvh.insert(Aabb(Vector3(0.0f, 0.0f, 5.0f), 1.0f, 1.0f, 1.0f), 1);
+    bvh.insert(Aabb(Vector3(0.0f, 0.0f, 10.0f), 1.0f, 1.0f, 1.0f), 2);
+    bvh.insert(Aabb(Vector3(10.0f, 0.0f, 2.0f), 1.0f, 1.0f, 1.0f), 3);
+
+    uint64 userData = 0;
+    float32 distance = 0.0f;
+    REQUIRE(bvh.raycast(Ray(Vector3::Zero, Vector3(0.0f, 0.0f, 1.0f)), userData, distance));
+    REQUIRE(userData == 1);
+    REQUIRE(distance == Approx(4.0f));
+
+    REQUIRE(bvh.raycast(Ray(Vector3::Zero, Vector3(0.0f, 1.0f, 0.0f)), userData, distance) == false);
+  }
+}
@@ -0,0 +1,74 @@
+#include "catch.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+#include "../Engine/Image/MipChain.hpp"
+#include "../Engine/Utility/CompressedTexture.hpp"
+
+namespace
+{
+  const std::string COMPRESSED_TEXTURE_TEST_PATH = "CompressedTextureTest.ftex";
+}
+
+TEST_CASE("COMPRESSED TEXTURE")
+{
+  SECTION("MIP CHAIN")
+  {
+    std::shared_ptr<ImageData> image(new ImageData(5, 2, 1, ImageFormat::RG8));
+    std::vector<ubyte> pixels(5 * 2 * 2, 0);
+    pixels[0] = 200;
+    pixels[2] = 100;
+    image->writeData(pixels);
+
+    auto levels = MipChain::generate(image);
+    REQUIRE(levels.size() == 3);
+    REQUIRE(levels[1]->getWidth() == 2);
+    REQUIRE(levels[1]->getHeight() == 1);
+    REQUIRE(levels[2]->getWidth() == 1);
+    REQUIRE(levels[2]->getHeight() == 1);
+    // The top left 2x2 of the first channel averages 200, 100, 0 and 0.
+    REQUIRE(levels[1]->getPixelData()[0] == 75);
+  }
+
+  SECTION("ROUND TRIP")
+  {
+    CompressedTextureSource source;
+    source.Format = TextureFormat::BC5;
+    source.Flags = CTF_SRgb;
+    source.Width = 8;
+    source.Height = 4;
+    source.SourceHash = 0x1234;
+    source.Mips.push_back(std::vector<ubyte>(Texture::getCompressedSize(TextureFormat::BC5, 8, 4), 7));
+    source.Mips.push_back(std::vector<ubyte>(Texture::getCompressedSize(TextureFormat::BC5, 4, 2), 9));
+    CompressedTexture::write(COMPRESSED_TEXTURE_TEST_PATH, source);
+
+    CompressedTexture texture(COMPRESSED_TEXTURE_TEST_PATH);
+    REQUIRE(texture.getFormat() == TextureFormat::BC5);
+    REQUIRE(texture.isSRgb());
+    REQUIRE(texture.getMipCount() == 2);
+    REQUIRE(texture.getHeader().SourceHash == 0x1234);
+    REQUIRE(texture.getMipSize(0) == 32);
+    REQUIRE(texture.getMipSize(1) == 16);
+    REQUIRE(texture.getDataSize() == 48);
+    REQUIRE(reinterpret_cast<uintptr_t>(texture.getMipData(1)) % COMPRESSED_TEXTURE_ALIGNMENT == 0);
+    REQUIRE(texture.getMipData(0)[31] == 7);
+    REQUIRE(texture.getMipData(1)[0] == 9);
+  }
+
+  SECTION("REJECTS MISMATCHED MIPS")
+  {
+    CompressedTextureSource source;
+    source.Format = TextureFormat::BC1;
+    source.Width = 8;
+    source.Height = 8;
+    source.Mips.push_back(std::vector<ubyte>(8));
+    REQUIRE_THROWS_AS(CompressedTexture::write(COMPRESSED_TEXTURE_TEST_PATH, source), std::runtime_error);
+
+    source.Format = TextureFormat::RGBA8;
+    REQUIRE_THROWS_AS(CompressedTexture::write(COMPRESSED_TEXTURE_TEST_PATH, source), std::runtime_error);
+    REQUIRE_THROWS_AS(CompressedTexture("MissingCompressedTexture.ftex"), std::runtime_error);
+  }
+
+  std::remove(COMPRESSED_TEXTURE_TEST_PATH.c_str());
+}
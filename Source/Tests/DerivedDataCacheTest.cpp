@@ -0,0 +1,95 @@
+#include "catch.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "../Engine/Utility/DerivedDataCache.hpp"
+
+namespace
+{
+  const std::string DERIVED_DATA_CACHE_TEST_DIRECTORY = "DerivedDataCacheTest";
+
+  void writeBytes(const std::string &path, uint64 size)
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << std::string(size, 'x');
+  }
+
+  std::shared_ptr<uint64> openSize(const std::string &path)
+  {
+    return std::make_shared<uint64>(std::filesystem::file_size(path));
+  }
+}
+
+TEST_CASE("DERIVED DATA CACHE")
+{
+  std::filesystem::remove_all(DERIVED_DATA_CACHE_TEST_DIRECTORY);
+  DerivedDataCache cache(DERIVED_DATA_CACHE_TEST_DIRECTORY, 1024);
+
+  SECTION("STORES AND LOADS ENTRIES")
+  {
+    uint64 key = DerivedDataCache::createKey(42, "settings", 8);
+    REQUIRE(key != DerivedDataCache::createKey(43, "settings", 8));
+    REQUIRE(cache.load<uint64>(key, ".bin", openSize) == nullptr);
+
+    std::string path = cache.store(key, ".bin", [](const std::string &temporaryPath)
+                                   { writeBytes(temporaryPath, 100); });
+    REQUIRE(path == cache.getEntryPath(key, ".bin"));
+
+    auto entry = cache.load<uint64>(key, ".bin", openSize);
+    REQUIRE(entry != nullptr);
+    REQUIRE(*entry == 100);
+
+    DerivedDataCacheStats stats = cache.getStats();
+    REQUIRE(stats.Hits == 1);
+    REQUIRE(stats.Misses == 1);
+    REQUIRE(stats.BytesSaved == 100);
+    REQUIRE(stats.BytesWritten == 100);
+  }
+
+  SECTION("REMOVES ENTRIES WHICH FAIL TO OPEN")
+  {
+    std::string path = cache.store(1, ".bin", [](const std::string &temporaryPath)
+                                   { writeBytes(temporaryPath, 10); });
+    auto entry = cache.load<uint64>(1, ".bin", [](const std::string &) -> std::shared_ptr<uint64>
+                                    { throw std::runtime_error("Outdated"); });
+    REQUIRE(entry == nullptr);
+    REQUIRE(!std::filesystem::exists(path));
+    REQUIRE(cache.getStats().Misses == 1);
+  }
+
+  SECTION("FAILED WRITES LEAVE NO ENTRY")
+  {
+    REQUIRE_THROWS(cache.store(2, ".bin", [](const std::string &temporaryPath)
+                               {
+                                 writeBytes(temporaryPath, 10);
+                                 throw std::runtime_error("Encoding failed"); }));
+    REQUIRE(std::filesystem::is_empty(DERIVED_DATA_CACHE_TEST_DIRECTORY));
+  }
+
+  SECTION("EVICTS THE LEAST RECENTLY USED ENTRIES")
+  {
+    auto now = std::filesystem::file_time_type::clock::now();
+    for (uint64 key = 0; key < 3; key++)
+    {
+      std::string path = cache.store(key, ".bin", [](const std::string &temporaryPath)
+                                     { writeBytes(temporaryPath, 400); });
+      std::filesystem::last_write_time(path, now - std::chrono::hours(3 - key));
+    }
+
+    // The third entry takes the cache over capacity, so the oldest is evicted when it is written.
+    REQUIRE(cache.getStats().Evictions == 1);
+    REQUIRE(!std::filesystem::exists(cache.getEntryPath(0, ".bin")));
+
+    // Using the older of the two remaining entries makes the other one the next to go.
+    REQUIRE(cache.load<uint64>(1, ".bin", openSize) != nullptr);
+    cache.store(3, ".bin", [](const std::string &temporaryPath)
+                { writeBytes(temporaryPath, 400); });
+    REQUIRE(std::filesystem::exists(cache.getEntryPath(1, ".bin")));
+    REQUIRE(!std::filesystem::exists(cache.getEntryPath(2, ".bin")));
+    REQUIRE(std::filesystem::exists(cache.getEntryPath(3, ".bin")));
+  }
+
+  std::filesystem::remove_all(DERIVED_DATA_CACHE_TEST_DIRECTORY);
+}
@@ -0,0 +1,99 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "../Engine/Utility/FileWatcher.hpp"
+
+namespace
+{
+  const std::string FILE_WATCHER_TEST_DIRECTORY = "FileWatcherTest";
+
+  void writeText(const std::string &path, const std::string &text)
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+  }
+
+  /// @brief Polls for a while, as watchers comparing write times only look every so often.
+  std::vector<std::string> waitForChanges(FileWatcher &watcher)
+  {
+    for (uint32 attempt = 0; attempt < 40; attempt++)
+    {
+      std::vector<std::string> changes = watcher.poll();
+      if (!changes.empty())
+      {
+        return changes;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    }
+    return {};
+  }
+
+  /// @brief Moves the write time well clear of the last one, which coarse file system clocks may not otherwise do.
+  void touch(const std::string &path)
+  {
+    auto writeTime = std::filesystem::last_write_time(path);
+    std::filesystem::last_write_time(path, writeTime + std::chrono::seconds(2));
+  }
+}
+
+TEST_CASE("FILE WATCHER")
+{
+  std::filesystem::remove_all(FILE_WATCHER_TEST_DIRECTORY);
+  std::filesystem::create_directories(FILE_WATCHER_TEST_DIRECTORY);
+  std::string watchedPath = FILE_WATCHER_TEST_DIRECTORY + "/Watched.glsl";
+  std::string otherPath = FILE_WATCHER_TEST_DIRECTORY + "/Other.glsl";
+  writeText(watchedPath, "a");
+  writeText(otherPath, "a");
+
+  FileWatcher watcher;
+  watcher.watch(watchedPath);
+  REQUIRE(watcher.isWatching("./" + watchedPath));
+  REQUIRE(!watcher.isWatching(otherPath));
+
+  SECTION("NORMALIZES PATHS")
+  {
+    REQUIRE(FileWatcher::normalize(watchedPath) == FileWatcher::normalize(FILE_WATCHER_TEST_DIRECTORY + "/../" + watchedPath));
+    REQUIRE(std::filesystem::path(FileWatcher::normalize(watchedPath)).is_absolute());
+  }
+
+  SECTION("REPORTS WRITES TO WATCHED FILES ONLY")
+  {
+    REQUIRE(watcher.poll().empty());
+    writeText(otherPath, "b");
+    writeText(watchedPath, "b");
+    touch(otherPath);
+    touch(watchedPath);
+
+    std::vector<std::string> changes = waitForChanges(watcher);
+    REQUIRE(changes.size() == 1);
+    REQUIRE(changes[0] == FileWatcher::normalize(watchedPath));
+    REQUIRE(watcher.poll().empty());
+  }
+
+  SECTION("REPORTS FILES RENAMED INTO PLACE")
+  {
+    std::string temporaryPath = FILE_WATCHER_TEST_DIRECTORY + "/Watched.glsl.tmp";
+    writeText(temporaryPath, "c");
+    touch(temporaryPath);
+    std::filesystem::rename(temporaryPath, watchedPath);
+
+    std::vector<std::string> changes = waitForChanges(watcher);
+    REQUIRE(changes.size() == 1);
+    REQUIRE(changes[0] == FileWatcher::normalize(watchedPath));
+  }
+
+  SECTION("STOPS REPORTING UNWATCHED FILES")
+  {
+    watcher.unwatch(watchedPath);
+    REQUIRE(!watcher.isWatching(watchedPath));
+    writeText(watchedPath, "d");
+    touch(watchedPath);
+    REQUIRE(waitForChanges(watcher).empty());
+  }
+
+  std::filesystem::remove_all(FILE_WATCHER_TEST_DIRECTORY);
+}
@@ -0,0 +1,73 @@
+#include "catch.hpp"
+
+#include <random>
+
+#include "../Engine/Maths/AABB.hpp"
+#include "../Engine/Maths/AabbArray.hpp"
+#include "../Engine/Maths/Frustrum.hpp"
+#include "../Engine/Maths/Plane.hpp"
+
+TEST_CASE("FRUSTRUM CULLING")
+{
+  // An axis aligned box shaped frustrum covering -10..10 on x and y and 0..20 on z.
+  Frustrum frustrum(Plane(Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f)),
+                    Plane(Vector3(0.0f, 0.0f, -1.0f), Vector3(0.0f, 0.0f, 20.0f)),
+                    Plane(Vector3(1.0f, 0.0f, 0.0f), Vector3(-10.0f, 0.0f, 0.0f)),
+                    Plane(Vector3(-1.0f, 0.0f, 0.0f), Vector3(10.0f, 0.0f, 0.0f)),
+                    Plane(Vector3(0.0f, -1.0f, 0.0f), Vector3(0.0f, 10.0f, 0.0f)),
+                    Plane(Vector3(0.0f, 1.0f, 0.0f), Vector3(0.0f, -10.0f, 0.0f)));
+
+  SECTION("EMPTY")
+  {
+    AabbArray bounds;
+    std::vector<uint32> visible;
+    frustrum.cull(bounds, visible);
+    REQUIRE(visible.empty());
+  }
+
+  SECTION("KNOWN BOXES")
+  {
+    AabbArray bounds;
+    bounds.add(Aabb(Vector3(0.0f, 0.0f, 10.0f), 1.0f, 1.0f, 1.0f));
+    bounds.add(Aabb(Vector3(0.0f, 0.0f, -5.0f), 1.0f, 1.0f, 1.0f));
+    bounds.add(Aabb(Vector3(10.5f, 0.0f, 10.0f), 1.0f, 1.0f, 1.0f));
+    bounds.add(Aabb(Vector3(0.0f, 30.0f, 10.0f), 1.0f, 1.0f, 1.0f));
+
+    // Existing entries are kept and new ones are appended after them.
+    std::vector<uint32> visible = {99};
+    frustrum.cull(bounds, visible);
+    REQUIRE(visible == std::vector<uint32>{99, 0, 2});
+
+    bounds.set(1, Aabb(Vector3(0.0f, 0.0f, 5.0f), 1.0f, 1.0f, 1.0f));
+    visible.clear();
+    frustrum.cull(bounds, visible);
+    REQUIRE(visible == std::vector<uint32>{0, 1, 2});
+  }
+
+  SECTION("BATCHED MATCHES SCALAR")
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float32> position(-30.0f, 30.0f);
+    std::uniform_real_distribution<float32> extent(0.1f, 2.0f);
+
+    // Not a multiple of the SIMD width, so the scalar tail is covered too.
+    AabbArray bounds;
+    std::vector<uint32> expected;
+    for (uint32 i = 0; i < 1003; i++)
+    {
+      Aabb aabb(Vector3(position(generator), position(generator), position(generator)), extent(generator), extent(generator), extent(generator));
+      bounds.add(aabb);
+
+      uint32 planeMask = FRUSTRUM_ALL_PLANES;
+      if (frustrum.intersects(aabb, planeMask) != FrustrumIntersection::Outside)
+      {
+        expected.push_back(i);
+      }
+    }
+
+    std::vector<uint32> visible;
+    frustrum.cull(bounds, visible);
+    REQUIRE(!expected.empty());
+    REQUIRE(visible == expected);
+  }
+}
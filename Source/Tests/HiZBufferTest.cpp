@@ -0,0 +1,106 @@
+#include "catch.hpp"
+
+#include <vector>
+
+#include "../Engine/Maths/AabbArray.hpp"
+#include "../Engine/Rendering/HiZBuffer.h"
+
+namespace
+{
+  const uint32 WIDTH = 64;
+  const uint32 HEIGHT = 36;
+  const float32 NEAR_PLANE = 0.1f;
+  const float32 FAR_PLANE = 100.0f;
+
+  Matrix4 createViewProjection(const Vector3 &eye)
+  {
+    Matrix4 projection = Matrix4::Perspective(Degree(60.0f), static_cast<float32>(WIDTH) / HEIGHT, NEAR_PLANE, FAR_PLANE);
+    return projection * Matrix4::LookAt(eye, eye + Vector3(0.0f, 0.0f, -1.0f), Vector3(0.0f, 1.0f, 0.0f));
+  }
+
+  float32 toWindowDepth(float32 distance)
+  {
+    // Depth of a point straight ahead, distance along the view direction.
+    float32 ndc = (FAR_PLANE + NEAR_PLANE) / (FAR_PLANE - NEAR_PLANE) - 2.0f * FAR_PLANE * NEAR_PLANE / ((FAR_PLANE - NEAR_PLANE) * distance);
+    return ndc * 0.5f + 0.5f;
+  }
+
+  /// @brief A wall at the given distance across the left half of the screen, with nothing drawn behind the right half.
+  std::vector<float32> createHalfWall(float32 distance)
+  {
+    std::vector<float32> depths(WIDTH * HEIGHT, 1.0f);
+    for (uint32 y = 0; y < HEIGHT; y++)
+    {
+      for (uint32 x = 0; x < WIDTH / 2; x++)
+      {
+        depths[y * WIDTH + x] = toWindowDepth(distance);
+      }
+    }
+    return depths;
+  }
+}
+
+TEST_CASE("HI-Z BUFFER")
+{
+  HiZBuffer buffer;
+  REQUIRE_FALSE(buffer.isOccluded(Aabb(Vector3(0.0f, 0.0f, -20.0f), 1.0f, 1.0f, 1.0f)));
+
+  Matrix4 viewProjection = createViewProjection(Vector3(0.0f, 0.0f, 0.0f));
+  std::vector<float32> depths = createHalfWall(10.0f);
+  buffer.setDepth(depths.data(), WIDTH, HEIGHT, viewProjection);
+
+  SECTION("KEEPS THE FURTHEST DEPTH AT EACH LEVEL")
+  {
+    REQUIRE(buffer.getLevelCount() == 7);
+    REQUIRE(buffer.getDepth(buffer.getLevelCount() - 1, 0, 0) == 1.0f);
+    // Odd sizes round up, the last column covering a single column beneath it.
+    REQUIRE(buffer.getDepth(2, 7, 8) == Approx(toWindowDepth(10.0f)));
+    REQUIRE(buffer.getDepth(2, 8, 8) == 1.0f);
+    REQUIRE(buffer.getDepth(3, 3, 4) == Approx(toWindowDepth(10.0f)));
+    REQUIRE(buffer.getDepth(3, 4, 4) == 1.0f);
+  }
+
+  SECTION("CULLS ONLY BOXES ENTIRELY BEHIND THE DEPTH")
+  {
+    // Boxes straight ahead of the left half of the screen, in front of and behind the wall.
+    Vector3 left(-5.0f, 0.0f, -20.0f);
+    REQUIRE(buffer.isOccluded(Aabb(left, 1.0f, 1.0f, 1.0f)));
+    REQUIRE_FALSE(buffer.isOccluded(Aabb(left * 0.25f, 0.2f, 0.2f, 0.2f)));
+    // Reaching in front of the wall.
+    REQUIRE_FALSE(buffer.isOccluded(Aabb(Vector3(-5.0f, 0.0f, -14.0f), 1.0f, 1.0f, 5.0f)));
+    // Behind the wall but reaching past it into the open half.
+    REQUIRE_FALSE(buffer.isOccluded(Aabb(Vector3(0.0f, 0.0f, -20.0f), 2.0f, 1.0f, 1.0f)));
+    REQUIRE_FALSE(buffer.isOccluded(Aabb(Vector3(5.0f, 0.0f, -20.0f), 1.0f, 1.0f, 1.0f)));
+    // Crossing the near plane.
+    REQUIRE_FALSE(buffer.isOccluded(Aabb(Vector3(0.0f, 0.0f, 0.0f), 1.0f, 1.0f, 1.0f)));
+
+    AabbArray bounds;
+    bounds.add(Aabb(left, 1.0f, 1.0f, 1.0f));
+    bounds.add(Aabb(Vector3(5.0f, 0.0f, -20.0f), 1.0f, 1.0f, 1.0f));
+    REQUIRE(buffer.isOccluded(bounds, 0));
+    REQUIRE_FALSE(buffer.isOccluded(bounds, 1));
+  }
+
+  SECTION("REPROJECTS INTO A NEW VIEW")
+  {
+    // Stepping back keeps the wall in front of the box behind it.
+    HiZBuffer reprojected;
+    reprojected.reproject(buffer, createViewProjection(Vector3(0.0f, 0.0f, 2.0f)));
+    REQUIRE(reprojected.getWidth() == WIDTH);
+    REQUIRE(reprojected.isOccluded(Aabb(Vector3(-5.0f, 0.0f, -20.0f), 1.0f, 1.0f, 1.0f)));
+
+    // Stepping to the side of the wall reveals the box, as nothing was drawn where it now is.
+    reprojected.reproject(buffer, createViewProjection(Vector3(-20.0f, 0.0f, 0.0f)));
+    REQUIRE_FALSE(reprojected.isOccluded(Aabb(Vector3(-5.0f, 0.0f, -20.0f), 1.0f, 1.0f, 1.0f)));
+
+    // Moving the wall nearer in the new view may only leave it as far or further than it was.
+    reprojected.reproject(buffer, createViewProjection(Vector3(0.0f, 0.0f, -5.0f)));
+    for (uint32 y = 0; y < HEIGHT; y++)
+    {
+      for (uint32 x = 0; x < WIDTH; x++)
+      {
+        REQUIRE(reprojected.getDepth(0, x, y) >= Approx(toWindowDepth(5.0f)));
+      }
+    }
+  }
+}
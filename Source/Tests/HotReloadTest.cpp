@@ -0,0 +1,131 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include "../Engine/Utility/HotReload.hpp"
+
+namespace
+{
+  const std::string HOT_RELOAD_TEST_DIRECTORY = "HotReloadTest";
+
+  void writeText(const std::string &path, const std::string &text)
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+  }
+
+  void change(const std::string &path)
+  {
+    writeText(path, "changed");
+    auto writeTime = std::filesystem::last_write_time(path);
+    std::filesystem::last_write_time(path, writeTime + std::chrono::seconds(2));
+  }
+
+  /// @brief Updates until reloadCount reaches expected, or gives up after a while.
+  void updateUntil(HotReload &hotReload, const uint32 &reloadCount, uint32 expected)
+  {
+    for (uint32 attempt = 0; attempt < 40 && reloadCount < expected; attempt++)
+    {
+      hotReload.update();
+      std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    }
+    // One more to catch any reload over the count.
+    hotReload.update();
+  }
+}
+
+TEST_CASE("HOT RELOAD")
+{
+  std::filesystem::remove_all(HOT_RELOAD_TEST_DIRECTORY);
+  std::filesystem::create_directories(HOT_RELOAD_TEST_DIRECTORY);
+  std::string headerPath = HOT_RELOAD_TEST_DIRECTORY + "/Common.glsl";
+  std::string firstPath = HOT_RELOAD_TEST_DIRECTORY + "/First.frag";
+  std::string secondPath = HOT_RELOAD_TEST_DIRECTORY + "/Second.frag";
+  writeText(headerPath, "header");
+  writeText(firstPath, "first");
+  writeText(secondPath, "second");
+
+  HotReload hotReload;
+  uint32 firstReloads = 0;
+  uint32 secondReloads = 0;
+  uint64 first = hotReload.track({firstPath, headerPath}, [&]()
+                                 { firstReloads++; return true; });
+  hotReload.track({secondPath, headerPath}, [&]()
+                  { secondReloads++; return true; });
+  REQUIRE(hotReload.getTrackedCount() == 2);
+
+  SECTION("RELOADS ONLY THE ASSETS DEPENDING ON A FILE")
+  {
+    change(firstPath);
+    updateUntil(hotReload, firstReloads, 1);
+    REQUIRE(firstReloads == 1);
+    REQUIRE(secondReloads == 0);
+
+    // A shared header reloads both, once each.
+    change(headerPath);
+    updateUntil(hotReload, secondReloads, 1);
+    REQUIRE(firstReloads == 2);
+    REQUIRE(secondReloads == 1);
+    REQUIRE(hotReload.getReloadCount() == 3);
+  }
+
+  SECTION("RETARGETS AND UNTRACKS ASSETS")
+  {
+    hotReload.setFiles(first, {firstPath});
+    change(headerPath);
+    updateUntil(hotReload, secondReloads, 1);
+    REQUIRE(firstReloads == 0);
+    REQUIRE(secondReloads == 1);
+
+    hotReload.untrack(first);
+    REQUIRE(hotReload.getTrackedCount() == 1);
+    change(firstPath);
+    updateUntil(hotReload, firstReloads, 1);
+    REQUIRE(firstReloads == 0);
+  }
+
+  SECTION("DROPS ASSETS WHICH NO LONGER EXIST")
+  {
+    uint32 goneReloads = 0;
+    hotReload.track({firstPath}, [&]()
+                    { goneReloads++; return false; });
+    change(firstPath);
+    updateUntil(hotReload, goneReloads, 1);
+    REQUIRE(goneReloads == 1);
+    REQUIRE(hotReload.getTrackedCount() == 2);
+  }
+
+  SECTION("KEEPS ERRORS AND THE FAILED ASSET")
+  {
+    uint32 attempts = 0;
+    hotReload.track({firstPath}, [&]() -> bool
+                    { attempts++; throw std::runtime_error("Unable to compile shader"); });
+    change(firstPath);
+    updateUntil(hotReload, attempts, 1);
+    REQUIRE(attempts == 1);
+    REQUIRE(firstReloads == 1);
+    REQUIRE(hotReload.getTrackedCount() == 3);
+    REQUIRE(hotReload.getErrors() == std::vector<std::string>{"Unable to compile shader"});
+
+    hotReload.clearErrors();
+    REQUIRE(hotReload.getErrors().empty());
+  }
+
+  SECTION("IGNORES CHANGES WHILE DISABLED")
+  {
+    hotReload.setEnabled(false);
+    change(firstPath);
+    updateUntil(hotReload, firstReloads, 1);
+    REQUIRE(firstReloads == 0);
+
+    hotReload.setEnabled(true);
+    hotReload.update();
+    REQUIRE(firstReloads == 0);
+  }
+
+  std::filesystem::remove_all(HOT_RELOAD_TEST_DIRECTORY);
+}
@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <random>
+
+#include "../Engine/Core/JobSystem.h"
+
+TEST_CASE("JOB SYSTEM")
+{
+  SECTION("PARALLEL FOR VISITS EVERY INDEX ONCE")
+  {
+    for (uint32 workerCount : {0u, 1u, 4u})
+    {
+      JobSystem jobSystem(workerCount);
+      std::vector<std::atomic<uint32>> visits(10007);
+      jobSystem.parallelFor(visits.size(), 64, [&](uint32 begin, uint32 end)
+                            {
+                              for (uint32 i = begin; i < end; i++)
+                              {
+                                visits[i]++;
+                              }
+                            });
+
+      bool allVisitedOnce = true;
+      for (const auto &visit : visits)
+      {
+        allVisitedOnce &= visit.load() == 1;
+      }
+      REQUIRE(allVisitedOnce);
+    }
+  }
+
+  SECTION("DEPENDENCIES RUN FIRST")
+  {
+    JobSystem jobSystem(3);
+    std::atomic<uint32> counter(0);
+    uint32 firstOrder = 0, secondOrder = 0, lastOrder = 0;
+
+    JobHandle first = jobSystem.schedule([&]()
+                                         { firstOrder = ++counter; });
+    JobHandle second = jobSystem.schedule([&]()
+                                          { secondOrder = ++counter; });
+    JobHandle last = jobSystem.schedule([&]()
+                                        { lastOrder = ++counter; },
+                                        {first, second});
+    jobSystem.wait(last);
+
+    REQUIRE(first->isFinished());
+    REQUIRE(second->isFinished());
+    REQUIRE(lastOrder == 3);
+    REQUIRE(firstOrder < lastOrder);
+    REQUIRE(secondOrder < lastOrder);
+  }
+
+  SECTION("NESTED JOBS DO NOT DEADLOCK")
+  {
+    JobSystem jobSystem(2);
+    std::atomic<uint32> sum(0);
+    jobSystem.parallelFor(16, 1, [&](uint32 begin, uint32 end)
+                          {
+                            for (uint32 i = begin; i < end; i++)
+                            {
+                              jobSystem.parallelFor(100, 10, [&](uint32 innerBegin, uint32 innerEnd)
+                                                    { sum += innerEnd - innerBegin; });
+                            }
+                          });
+    REQUIRE(sum.load() == 1600);
+  }
+
+  SECTION("PARALLEL SORT")
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float32> distribution(0.0f, 1000.0f);
+    std::vector<float32> values(50001);
+    for (auto &value : values)
+    {
+      value = distribution(generator);
+    }
+    std::vector<float32> expected(values);
+    std::sort(expected.begin(), expected.end());
+
+    JobSystem jobSystem(4);
+    jobSystem.parallelSort(values, 1000, [](float32 a, float32 b)
+                           { return a < b; });
+    REQUIRE(values == expected);
+  }
+}
@@ -0,0 +1,150 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "../Engine/Core/JobSystem.h"
+#include "../Engine/Rendering/LightClusters.h"
+
+namespace
+{
+  const float32 NEAR_CLIP = 0.1f;
+  const float32 FAR_CLIP = 100.0f;
+  const float32 ASPECT = 16.0f / 9.0f;
+
+  std::vector<ClusterLight> createRandomLights(uint32 count, uint32 seed)
+  {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float32> lateral(-40.0f, 40.0f);
+    std::uniform_real_distribution<float32> depth(-110.0f, 5.0f);
+    std::uniform_real_distribution<float32> radius(0.5f, 8.0f);
+    std::vector<ClusterLight> lights(count);
+    for (auto &light : lights)
+    {
+      light.Position = Vector3(lateral(generator), lateral(generator) * 0.6f, depth(generator));
+      light.Radius = radius(generator);
+    }
+    return lights;
+  }
+
+  /// @brief The cluster the lighting shader would look up for a view space point.
+  uint32 findCluster(const Vector3 &position, float32 tanHalfFovY)
+  {
+    float32 depth = -position.Z;
+    float32 ndcX = position.X / (depth * tanHalfFovY * ASPECT);
+    float32 ndcY = position.Y / (depth * tanHalfFovY);
+    uint32 x = std::min(static_cast<uint32>((ndcX + 1.0f) * 0.5f * LightClusters::TILES_X), LightClusters::TILES_X - 1);
+    uint32 y = std::min(static_cast<uint32>((ndcY + 1.0f) * 0.5f * LightClusters::TILES_Y), LightClusters::TILES_Y - 1);
+    return LightClusters::getClusterIndex(x, y, LightClusters::getSlice(depth, NEAR_CLIP, FAR_CLIP));
+  }
+
+  bool clusterHasLight(const LightClusters &clusters, uint32 clusterIndex, uint32 light)
+  {
+    uint32 cluster = clusters.getClusters()[clusterIndex];
+    auto begin = clusters.getLightIndices().begin() + LightClusters::getClusterOffset(cluster);
+    auto end = begin + LightClusters::getClusterLightCount(cluster);
+    return std::binary_search(begin, end, light);
+  }
+}
+
+TEST_CASE("LIGHT CLUSTERS")
+{
+  Degree fovY(60.0f);
+  float32 tanHalfFovY = std::tan(Radian(fovY).InRadians() * 0.5f);
+
+  SECTION("SLICES DEPTH EXPONENTIALLY")
+  {
+    REQUIRE(LightClusters::getSlice(NEAR_CLIP, NEAR_CLIP, FAR_CLIP) == 0);
+    REQUIRE(LightClusters::getSlice(0.0f, NEAR_CLIP, FAR_CLIP) == 0);
+    REQUIRE(LightClusters::getSlice(FAR_CLIP * 0.999f, NEAR_CLIP, FAR_CLIP) == LightClusters::SLICES - 1);
+    REQUIRE(LightClusters::getSlice(FAR_CLIP * 2.0f, NEAR_CLIP, FAR_CLIP) == LightClusters::SLICES - 1);
+    // Halfway through the slices is the geometric mean of the clip planes.
+    float32 middle = std::sqrt(NEAR_CLIP * FAR_CLIP);
+    REQUIRE(LightClusters::getSlice(middle * 1.01f, NEAR_CLIP, FAR_CLIP) == LightClusters::SLICES / 2);
+    REQUIRE(LightClusters::getSlice(middle * 0.99f, NEAR_CLIP, FAR_CLIP) == LightClusters::SLICES / 2 - 1);
+  }
+
+  SECTION("EVERY POINT A LIGHT REACHES FINDS IT IN ITS CLUSTER")
+  {
+    std::vector<ClusterLight> lights = createRandomLights(2000, 7);
+    LightClusters clusters;
+    clusters.build(lights, fovY, ASPECT, NEAR_CLIP, FAR_CLIP);
+
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float32> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float32> depth(NEAR_CLIP, FAR_CLIP);
+    bool allFound = true;
+    for (uint32 sample = 0; sample < 20000; sample++)
+    {
+      float32 d = depth(generator);
+      Vector3 position(unit(generator) * d * tanHalfFovY * ASPECT, unit(generator) * d * tanHalfFovY, -d);
+      uint32 clusterIndex = findCluster(position, tanHalfFovY);
+      for (uint32 i = 0; i < lights.size(); i++)
+      {
+        if ((position - lights[i].Position).Length() < lights[i].Radius * 0.999f)
+        {
+          allFound &= clusterHasLight(clusters, clusterIndex, i);
+        }
+      }
+    }
+    REQUIRE(allFound);
+    REQUIRE(clusters.getDroppedCount() == 0);
+
+    // Clusters only list the lights near them, rather than every light in the scene.
+    REQUIRE(clusters.getMaxClusterLightCount() < lights.size() / 10);
+  }
+
+  SECTION("SKIPS LIGHTS OUTSIDE THE FRUSTUM")
+  {
+    std::vector<ClusterLight> lights = {
+        {Vector3(0.0f, 0.0f, -10.0f), 1.0f},
+        {Vector3(0.0f, 0.0f, 5.0f), 1.0f},
+        {Vector3(100.0f, 0.0f, -10.0f), 1.0f},
+        {Vector3(0.0f, 0.0f, -200.0f), 1.0f},
+        {Vector3(0.0f, 0.0f, -10.0f), 0.0f},
+    };
+    LightClusters clusters;
+    clusters.build(lights, fovY, ASPECT, NEAR_CLIP, FAR_CLIP);
+
+    REQUIRE(clusters.getVisibleLightCount() == 1);
+    bool onlyFirstLight = std::all_of(clusters.getLightIndices().begin(), clusters.getLightIndices().end(), [](uint32 light)
+                                      { return light == 0; });
+    REQUIRE(onlyFirstLight);
+    REQUIRE(clusterHasLight(clusters, findCluster(Vector3(0.0f, 0.0f, -10.0f), tanHalfFovY), 0));
+    // A light in front of the camera spans only a few of the clusters.
+    REQUIRE(clusters.getLightIndices().size() < 16);
+  }
+
+  SECTION("MATCHES ACROSS JOBS")
+  {
+    std::vector<ClusterLight> lights = createRandomLights(4000, 3);
+    LightClusters serial;
+    serial.build(lights, fovY, ASPECT, NEAR_CLIP, FAR_CLIP);
+
+    JobSystem jobSystem(4);
+    LightClusters parallel;
+    parallel.build(lights, fovY, ASPECT, NEAR_CLIP, FAR_CLIP, &jobSystem);
+    REQUIRE(parallel.getClusters() == serial.getClusters());
+    REQUIRE(parallel.getLightIndices() == serial.getLightIndices());
+
+    // Rebuilding reuses the previous frame's storage without keeping any of its lights.
+    parallel.build({}, fovY, ASPECT, NEAR_CLIP, FAR_CLIP, &jobSystem);
+    REQUIRE(parallel.getLightIndices().empty());
+    REQUIRE(parallel.getVisibleLightCount() == 0);
+  }
+
+  SECTION("DROPS LIGHTS PAST A FULL CLUSTER")
+  {
+    std::vector<ClusterLight> lights(LightClusters::MAX_LIGHTS_PER_CLUSTER + 10, {Vector3(0.0f, 0.0f, -10.0f), 0.5f});
+    LightClusters clusters;
+    clusters.build(lights, fovY, ASPECT, NEAR_CLIP, FAR_CLIP);
+
+    uint32 cluster = clusters.getClusters()[findCluster(Vector3(0.0f, 0.0f, -10.0f), tanHalfFovY)];
+    REQUIRE(LightClusters::getClusterLightCount(cluster) == LightClusters::MAX_LIGHTS_PER_CLUSTER);
+    REQUIRE(clusters.getMaxClusterLightCount() == LightClusters::MAX_LIGHTS_PER_CLUSTER);
+    REQUIRE(clusters.getDroppedCount() >= 10);
+    // The lights kept are the first ones given.
+    REQUIRE(clusters.getLightIndices()[LightClusters::getClusterOffset(cluster) + LightClusters::MAX_LIGHTS_PER_CLUSTER - 1] == LightClusters::MAX_LIGHTS_PER_CLUSTER - 1);
+  }
+}
@@ -0,0 +1,39 @@
+#include "catch.hpp"
+
+#include "../Engine/Rendering/LodSelector.h"
+
+TEST_CASE("LOD SELECTOR")
+{
+  std::vector<MeshLod> lods = {{0, 300, 0.0f}, {300, 150, 0.01f}, {450, 75, 0.02f}, {525, 36, 0.04f}};
+
+  SECTION("PROJECTS SIZES")
+  {
+    // A 90 degree field of view spans twice the distance across the screen's height.
+    REQUIRE(LodSelector::getProjectedSize(1.0f, 10.0f, Degree(90.0f), 1000) == Approx(50.0f));
+    REQUIRE(LodSelector::getProjectedSize(1.0f, 20.0f, Degree(90.0f), 1000) == Approx(25.0f));
+    REQUIRE(LodSelector::getProjectedSize(1.0f, 0.0f, Degree(90.0f), 1000) > 1.0e30f);
+  }
+
+  SECTION("PICKS THE COARSEST LEVEL UNDER THE THRESHOLD")
+  {
+    REQUIRE(LodSelector::selectLod(lods, 0, 1000.0f, 1.0f, 0.0f) == 0);
+    REQUIRE(LodSelector::selectLod(lods, 0, 100.0f, 1.0f, 0.0f) == 1);
+    REQUIRE(LodSelector::selectLod(lods, 0, 50.0f, 1.0f, 0.0f) == 2);
+    REQUIRE(LodSelector::selectLod(lods, 0, 10.0f, 1.0f, 0.0f) == 3);
+    REQUIRE(LodSelector::selectLod(lods, 3, 1000.0f, 1.0f, 0.0f) == 0);
+    REQUIRE(LodSelector::selectLod({}, 2, 10.0f, 1.0f, 0.0f) == 0);
+    REQUIRE(LodSelector::selectLod(lods, 7, 10.0f, 1.0f, 0.0f) == 3);
+  }
+
+  SECTION("HOLDS THE CURRENT LEVEL WITHIN THE HYSTERESIS BAND")
+  {
+    // Level 1 projects to 0.9 pixels, under the threshold but not under the band below it.
+    REQUIRE(LodSelector::selectLod(lods, 0, 90.0f, 1.0f, 0.25f) == 0);
+    REQUIRE(LodSelector::selectLod(lods, 0, 70.0f, 1.0f, 0.25f) == 1);
+    // Once coarser, the level is kept until its error passes the threshold itself.
+    REQUIRE(LodSelector::selectLod(lods, 1, 90.0f, 1.0f, 0.25f) == 1);
+    REQUIRE(LodSelector::selectLod(lods, 1, 110.0f, 1.0f, 0.25f) == 0);
+    // Level 3 projects to 0.96 pixels, so only level 2 clears the band.
+    REQUIRE(LodSelector::selectLod(lods, 1, 24.0f, 1.0f, 0.25f) == 2);
+  }
+}
@@ -0,0 +1,132 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "../Engine/Geometry/MeshOptimizer.hpp"
+
+namespace
+{
+  /// @brief A size x size grid of quads with every triangle's corners stored separately, as an unindexed import would
+  /// produce, and the triangles shuffled.
+  MeshOptimizerData createShuffledGrid(uint32 size)
+  {
+    std::vector<std::array<uint32, 3>> triangles;
+    for (uint32 y = 0; y < size; y++)
+    {
+      for (uint32 x = 0; x < size; x++)
+      {
+        uint32 corner = y * (size + 1) + x;
+        triangles.push_back({corner, corner + 1, corner + size + 1});
+        triangles.push_back({corner + 1, corner + size + 2, corner + size + 1});
+      }
+    }
+    uint32 state = 7;
+    for (uint32 i = static_cast<uint32>(triangles.size()) - 1; i > 0; i--)
+    {
+      state = state * 1664525u + 1013904223u;
+      std::swap(triangles[i], triangles[state % (i + 1)]);
+    }
+
+    MeshOptimizerData mesh;
+    for (const auto &triangle : triangles)
+    {
+      for (uint32 corner : triangle)
+      {
+        mesh.Indices.push_back(static_cast<uint32>(mesh.Positions.size()));
+        mesh.Positions.push_back(Vector3(static_cast<float32>(corner % (size + 1)), static_cast<float32>(corner / (size + 1)), 0.0f));
+        mesh.Normals.push_back(Vector3(0.0f, 0.0f, 1.0f));
+      }
+    }
+    return mesh;
+  }
+
+  /// @brief Each triangle as its corner positions, rotated to start at the smallest so winding is kept, sorted.
+  std::vector<std::array<float32, 6>> getTriangleSet(const MeshOptimizerData &mesh)
+  {
+    std::vector<std::array<float32, 6>> triangles;
+    for (uint64 i = 0; i < mesh.Indices.size(); i += 3)
+    {
+      std::array<std::pair<float32, float32>, 3> corners;
+      for (uint32 c = 0; c < 3; c++)
+      {
+        const Vector3 &position = mesh.Positions[mesh.Indices[i + c]];
+        corners[c] = {position.X, position.Y};
+      }
+      std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+      triangles.push_back({corners[0].first, corners[0].second, corners[1].first, corners[1].second, corners[2].first, corners[2].second});
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+  }
+}
+
+TEST_CASE("MESH OPTIMIZER")
+{
+  SECTION("ANALYZES A SINGLE TRIANGLE")
+  {
+    VertexCacheStats stats = MeshOptimizer::analyzeVertexCache({0, 1, 2}, 3);
+    REQUIRE(stats.Acmr == Approx(3.0f));
+    REQUIRE(stats.Atvr == Approx(1.0f));
+  }
+
+  SECTION("WELDS IDENTICAL VERTICES")
+  {
+    MeshOptimizerData mesh = createShuffledGrid(1);
+    REQUIRE(mesh.Positions.size() == 6);
+    auto triangles = getTriangleSet(mesh);
+
+    REQUIRE(MeshOptimizer::weldVertices(mesh) == 4);
+    REQUIRE(mesh.Positions.size() == 4);
+    REQUIRE(mesh.Normals.size() == 4);
+    REQUIRE(getTriangleSet(mesh) == triangles);
+  }
+
+  SECTION("KEEPS VERTICES WITH DIFFERENT ATTRIBUTES")
+  {
+    MeshOptimizerData mesh = createShuffledGrid(1);
+    mesh.Normals[0] = Vector3(1.0f, 0.0f, 0.0f);
+    REQUIRE(MeshOptimizer::weldVertices(mesh) == 5);
+  }
+
+  SECTION("OPTIMIZES A SHUFFLED GRID")
+  {
+    MeshOptimizerData mesh = createShuffledGrid(32);
+    auto triangles = getTriangleSet(mesh);
+    MeshOptimizationStats stats = MeshOptimizer::optimize(mesh);
+
+    REQUIRE(stats.TriangleCount == 32 * 32 * 2);
+    REQUIRE(stats.VertexCountBefore == 32 * 32 * 6);
+    REQUIRE(stats.VertexCountAfter == 33 * 33);
+    REQUIRE(stats.Before.Acmr == Approx(3.0f));
+    REQUIRE(stats.After.Acmr < 0.8f);
+    REQUIRE(stats.After.Atvr < 1.6f);
+    REQUIRE(getTriangleSet(mesh) == triangles);
+
+    // Vertices are numbered in the order they are first used.
+    uint32 nextVertex = 0;
+    for (uint32 index : mesh.Indices)
+    {
+      REQUIRE(index <= nextVertex);
+      nextVertex = std::max(nextVertex, index + 1);
+    }
+  }
+
+  SECTION("RECORDS CLUSTERS FOR OVERDRAW")
+  {
+    MeshOptimizerData mesh = createShuffledGrid(8);
+    uint32 vertexCount = MeshOptimizer::weldVertices(mesh);
+    std::vector<uint32> clusters;
+    MeshOptimizer::optimizeVertexCache(mesh.Indices, vertexCount, &clusters);
+    REQUIRE(!clusters.empty());
+    REQUIRE(clusters[0] == 0);
+    REQUIRE(std::is_sorted(clusters.begin(), clusters.end()));
+
+    float32 acmr = MeshOptimizer::analyzeVertexCache(mesh.Indices, vertexCount).Acmr;
+    auto triangles = getTriangleSet(mesh);
+    MeshOptimizer::optimizeOverdraw(mesh.Indices, mesh.Positions, clusters);
+    REQUIRE(getTriangleSet(mesh) == triangles);
+    // Every cluster restarts with an empty cache, which is where the loss over the threshold comes from.
+    REQUIRE(MeshOptimizer::analyzeVertexCache(mesh.Indices, vertexCount).Acmr < acmr * 1.5f);
+  }
+}
@@ -0,0 +1,180 @@
+#include "catch.hpp"
+
+#include <cmath>
+#include <set>
+
+#include "../Engine/Geometry/MeshSimplifier.hpp"
+
+namespace
+{
+  /// @brief A flat size x size grid of quads in the XY plane facing +Z, with an open border all the way round.
+  MeshOptimizerData createGrid(uint32 size)
+  {
+    MeshOptimizerData mesh;
+    for (uint32 y = 0; y <= size; y++)
+    {
+      for (uint32 x = 0; x <= size; x++)
+      {
+        mesh.Positions.push_back(Vector3(static_cast<float32>(x), static_cast<float32>(y), 0.0f));
+        mesh.Normals.push_back(Vector3(0.0f, 0.0f, 1.0f));
+        mesh.TexCoords.push_back(Vector2(x / static_cast<float32>(size), y / static_cast<float32>(size)));
+      }
+    }
+    for (uint32 y = 0; y < size; y++)
+    {
+      for (uint32 x = 0; x < size; x++)
+      {
+        uint32 corner = y * (size + 1) + x;
+        mesh.Indices.insert(mesh.Indices.end(), {corner, corner + 1, corner + size + 1, corner + 1, corner + size + 2, corner + size + 1});
+      }
+    }
+    return mesh;
+  }
+
+  /// @brief A closed unit sphere of rings around the Y axis, with a single vertex at each pole.
+  MeshOptimizerData createSphere(uint32 rings, uint32 segments)
+  {
+    MeshOptimizerData mesh;
+    mesh.Positions.push_back(Vector3(0.0f, 1.0f, 0.0f));
+    for (uint32 ring = 1; ring < rings; ring++)
+    {
+      float32 theta = 3.14159265f * ring / rings;
+      for (uint32 segment = 0; segment < segments; segment++)
+      {
+        float32 phi = 2.0f * 3.14159265f * segment / segments;
+        mesh.Positions.push_back(Vector3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+      }
+    }
+    mesh.Positions.push_back(Vector3(0.0f, -1.0f, 0.0f));
+    mesh.Normals = mesh.Positions;
+
+    uint32 bottom = static_cast<uint32>(mesh.Positions.size()) - 1;
+    for (uint32 segment = 0; segment < segments; segment++)
+    {
+      uint32 next = (segment + 1) % segments;
+      mesh.Indices.insert(mesh.Indices.end(), {0, 1 + next, 1 + segment});
+      uint32 last = 1 + (rings - 2) * segments;
+      mesh.Indices.insert(mesh.Indices.end(), {bottom, last + segment, last + next});
+      for (uint32 ring = 0; ring + 2 < rings; ring++)
+      {
+        uint32 upper = 1 + ring * segments;
+        uint32 lower = upper + segments;
+        mesh.Indices.insert(mesh.Indices.end(), {upper + segment, upper + next, lower + segment, upper + next, lower + next, lower + segment});
+      }
+    }
+    return mesh;
+  }
+
+  float32 getTotalArea(const MeshOptimizerData &mesh, const std::vector<uint32> &indices)
+  {
+    float32 area = 0.0f;
+    for (uint64 i = 0; i < indices.size(); i += 3)
+    {
+      const Vector3 &a = mesh.Positions[indices[i]];
+      Vector3 normal = Vector3::Cross(mesh.Positions[indices[i + 1]] - a, mesh.Positions[indices[i + 2]] - a);
+      REQUIRE(normal.Z >= 0.0f);
+      area += normal.Length() * 0.5f;
+    }
+    return area;
+  }
+}
+
+TEST_CASE("MESH SIMPLIFIER")
+{
+  SECTION("LEAVES MESHES UNDER THE TARGET ALONE")
+  {
+    MeshOptimizerData mesh = createGrid(2);
+    float32 error = 1.0f;
+    REQUIRE(MeshSimplifier::simplify(mesh, static_cast<uint32>(mesh.Indices.size()), 1.0f, &error) == mesh.Indices);
+    REQUIRE(error == 0.0f);
+  }
+
+  SECTION("SIMPLIFIES A FLAT GRID WITHOUT MOVING ITS BORDER")
+  {
+    MeshOptimizerData mesh = createGrid(16);
+    uint32 target = static_cast<uint32>(mesh.Indices.size()) / 4;
+    float32 error;
+    std::vector<uint32> indices = MeshSimplifier::simplify(mesh, target, 1.0f, &error);
+
+    REQUIRE(indices.size() <= target);
+    REQUIRE(indices.size() % 3 == 0);
+    REQUIRE(error < 1.0e-3f);
+    // No triangle is flipped over and none of the grid's area is lost, so the border stayed where it was.
+    REQUIRE(getTotalArea(mesh, indices) == Approx(16.0f * 16.0f));
+  }
+
+  SECTION("KEEPS SEAM VERTICES")
+  {
+    // Split the grid down its middle column, as a texture seam would.
+    MeshOptimizerData mesh = createGrid(8);
+    std::set<uint32> seam;
+    for (uint32 y = 0; y <= 8; y++)
+    {
+      uint32 vertex = y * 9 + 4;
+      uint32 duplicate = static_cast<uint32>(mesh.Positions.size());
+      mesh.Positions.push_back(mesh.Positions[vertex]);
+      mesh.Normals.push_back(mesh.Normals[vertex]);
+      mesh.TexCoords.push_back(mesh.TexCoords[vertex] + Vector2(0.5f, 0.0f));
+      for (uint64 i = 0; i < mesh.Indices.size(); i += 3)
+      {
+        bool rightHalf = false;
+        for (uint32 c = 0; c < 3; c++)
+        {
+          rightHalf |= mesh.Indices[i + c] < 81 && mesh.Indices[i + c] % 9 > 4;
+        }
+        for (uint32 c = 0; c < 3 && rightHalf; c++)
+        {
+          if (mesh.Indices[i + c] == vertex)
+          {
+            mesh.Indices[i + c] = duplicate;
+          }
+        }
+      }
+      seam.insert(vertex);
+      seam.insert(duplicate);
+    }
+
+    std::vector<uint32> indices = MeshSimplifier::simplify(mesh, 0);
+    REQUIRE(indices.size() < mesh.Indices.size());
+    std::set<uint32> used(indices.begin(), indices.end());
+    for (uint32 vertex : seam)
+    {
+      REQUIRE(used.count(vertex) == 1);
+    }
+  }
+
+  SECTION("STOPS AT THE TARGET ERROR")
+  {
+    MeshOptimizerData mesh = createSphere(16, 32);
+    REQUIRE(MeshSimplifier::simplify(mesh, 0, 1.0e-6f).size() == mesh.Indices.size());
+
+    float32 error;
+    std::vector<uint32> indices = MeshSimplifier::simplify(mesh, 0, 0.05f, &error);
+    REQUIRE(indices.size() < mesh.Indices.size());
+    REQUIRE(error <= 0.05f);
+  }
+
+  SECTION("GENERATES A CHAIN OF LEVELS")
+  {
+    MeshOptimizerData mesh = createSphere(32, 64);
+    std::vector<uint32> indices;
+    std::vector<MeshLod> lods = MeshSimplifier::generateLods(mesh, indices);
+
+    REQUIRE(lods.size() == MAX_MESH_LODS);
+    REQUIRE(lods[0].IndexOffset == 0);
+    REQUIRE(lods[0].IndexCount == mesh.Indices.size());
+    REQUIRE(lods[0].Error == 0.0f);
+    REQUIRE(std::equal(mesh.Indices.begin(), mesh.Indices.end(), indices.begin()));
+    for (uint32 lod = 1; lod < lods.size(); lod++)
+    {
+      REQUIRE(lods[lod].IndexOffset == lods[lod - 1].IndexOffset + lods[lod - 1].IndexCount);
+      REQUIRE(lods[lod].IndexCount <= lods[lod - 1].IndexCount * 0.8f);
+      REQUIRE(lods[lod].Error >= lods[lod - 1].Error);
+      REQUIRE(lods[lod].Error < 0.1f);
+    }
+    REQUIRE(indices.size() == lods.back().IndexOffset + lods.back().IndexCount);
+
+    // Too few triangles for a single level worth having.
+    REQUIRE(MeshSimplifier::generateLods(createGrid(2), indices).size() == 1);
+  }
+}
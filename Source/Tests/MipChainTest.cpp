@@ -0,0 +1,85 @@
+#include "catch.hpp"
+
+#include "../Engine/Core/JobSystem.h"
+#include "../Engine/Image/MipChain.hpp"
+
+namespace
+{
+  std::shared_ptr<ImageData> createImage(uint32 width, uint32 height, ImageFormat format, const std::vector<ubyte> &pixels)
+  {
+    std::shared_ptr<ImageData> image(new ImageData(width, height, 1, format));
+    image->writeData(pixels);
+    return image;
+  }
+}
+
+TEST_CASE("MIP CHAIN")
+{
+  SECTION("BOX AVERAGES QUADS")
+  {
+    auto image = createImage(2, 2, ImageFormat::RGBA8, {0, 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 0});
+    auto mip = MipChain::downsample(*image);
+    REQUIRE(mip->getWidth() == 1);
+    REQUIRE(mip->getHeight() == 1);
+    REQUIRE(mip->getPixelData()[0] == 128);
+    REQUIRE(mip->getPixelData()[3] == 128);
+  }
+
+  SECTION("SRGB FILTERS IN LINEAR SPACE")
+  {
+    auto image = createImage(2, 2, ImageFormat::RGBA8, {0, 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 0});
+    MipChainDesc desc;
+    desc.SRgb = true;
+    auto mip = MipChain::downsample(*image, desc);
+    // Half of full intensity in linear space is 188 once encoded as sRGB. Alpha is averaged as stored.
+    REQUIRE(mip->getPixelData()[0] == 188);
+    REQUIRE(mip->getPixelData()[2] == 188);
+    REQUIRE(mip->getPixelData()[3] == 128);
+  }
+
+  SECTION("KAISER KEEPS FLAT IMAGES FLAT")
+  {
+    auto image = createImage(8, 6, ImageFormat::RGB8, std::vector<ubyte>(8 * 6 * 3, 100));
+    MipChainDesc desc;
+    desc.Filter = MipFilter::Kaiser;
+    auto levels = MipChain::generate(image, desc);
+    REQUIRE(levels.size() == 4);
+    for (const auto &level : levels)
+    {
+      for (ubyte value : level->getPixelData())
+      {
+        REQUIRE(value == 100);
+      }
+    }
+  }
+
+  SECTION("JOBS MATCH A SINGLE THREAD")
+  {
+    std::vector<ubyte> pixels(67 * 45 * 4);
+    uint32 state = 12345;
+    for (auto &value : pixels)
+    {
+      state = state * 1664525u + 1013904223u;
+      value = static_cast<ubyte>(state >> 24);
+    }
+    auto image = createImage(67, 45, ImageFormat::RGBA8, pixels);
+
+    MipChainDesc desc;
+    desc.Filter = MipFilter::Kaiser;
+    desc.SRgb = true;
+    auto serial = MipChain::generate(image, desc);
+
+    JobSystem jobSystem(3);
+    desc.Jobs = &jobSystem;
+    auto parallel = MipChain::generate(image, desc);
+
+    REQUIRE(serial.size() == 7);
+    REQUIRE(parallel.size() == serial.size());
+    for (uint32 i = 0; i < serial.size(); i++)
+    {
+      REQUIRE(parallel[i]->getWidth() == serial[i]->getWidth());
+      REQUIRE(parallel[i]->getHeight() == serial[i]->getHeight());
+      REQUIRE(parallel[i]->getPixelData() == serial[i]->getPixelData());
+    }
+  }
+}
@@ -0,0 +1,170 @@
+#include "catch.hpp"
+
+#include "../Engine/RenderApi/Null/NullRenderDevice.hpp"
+#include "../Engine/RenderApi/Null/NullTexture.hpp"
+
+TEST_CASE("NULL RENDER DEVICE")
+{
+  RenderDeviceDesc desc;
+  desc.RenderWidth = 1280;
+  desc.RenderHeight = 720;
+  NullRenderDevice device(desc);
+
+  SECTION("BUFFERS KEEP HOST DATA")
+  {
+    GpuBufferDesc bufferDesc;
+    bufferDesc.BufferType = BufferType::Constant;
+    bufferDesc.BufferUsage = BufferUsage::Dynamic;
+    bufferDesc.ByteCount = 16;
+    auto buffer = device.createGpuBuffer(bufferDesc);
+
+    float32 src[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    buffer->writeData(0, sizeof(src), src, AccessType::WriteOnlyDiscard);
+
+    float32 dst[4] = {};
+    buffer->readData(0, sizeof(dst), dst);
+    REQUIRE(dst[0] == 1.0f);
+    REQUIRE(dst[3] == 4.0f);
+    REQUIRE_THROWS(buffer->writeData(8, sizeof(src), src));
+  }
+
+  SECTION("RECORDS STATE AND DRAWS")
+  {
+    auto vs = device.createShader(ShaderDesc{ShaderType::Vertex, "", ""});
+    auto fs = device.createShader(ShaderDesc{ShaderType::Fragment, "", ""});
+    REQUIRE(vs->isCompiled());
+
+    PipelineStateDesc pipelineDesc;
+    pipelineDesc.VS = vs;
+    pipelineDesc.FS = fs;
+    auto pipeline = device.createPipelineState(pipelineDesc);
+
+    auto vertexBuffer = device.createVertexBuffer(VertexBufferDesc{12, 3});
+    auto indexBuffer = device.createIndexBuffer(IndexBufferDesc{3});
+
+    REQUIRE_THROWS(device.drawIndexed(3, 0, 0));
+
+    device.setPipelineState(pipeline);
+    device.setVertexBuffer(vertexBuffer);
+    device.setIndexBuffer(indexBuffer);
+    device.drawIndexed(3, 0, 0);
+    device.drawIndexed(3, 0, 0);
+
+    REQUIRE(device.getCommandCount(NullCommandType::SetPipelineState) == 1);
+    REQUIRE(device.getCommandCount(NullCommandType::DrawIndexed) == 2);
+    REQUIRE(device.getIndexCount() == 6);
+    REQUIRE(device.getCommandLog().back().Type == NullCommandType::DrawIndexed);
+    REQUIRE(device.getCommandLog().back().Resource == indexBuffer.get());
+    REQUIRE_THROWS(device.drawIndexed(4, 0, 0));
+
+    device.clearBuffers(RTT_Colour | RTT_Stencil, Colour::White, 0.5f, 3);
+    const NullCommand &clear = device.getCommandLog().back();
+    REQUIRE(clear.Type == NullCommandType::ClearBuffers);
+    REQUIRE(clear.Slot == (RTT_Colour | RTT_Stencil));
+    REQUIRE(clear.ClearColour == Colour::White);
+    REQUIRE(clear.ClearDepth == 0.5f);
+    REQUIRE(clear.ClearStencil == 3);
+
+    device.resetCommandLog();
+    REQUIRE(device.getCommandLog().empty());
+    REQUIRE(device.getTotalCommandCount() == 0);
+  }
+
+  SECTION("INSTANCED DRAWS")
+  {
+    std::vector<VertexLayoutDesc> layoutDesc{
+        VertexLayoutDesc(SemanticType::Position, SemanticFormat::Float3),
+        VertexLayoutDesc(SemanticType::Instance0, SemanticFormat::Float4, false, VertexInputRate::PerInstance)};
+
+    PipelineStateDesc pipelineDesc;
+    pipelineDesc.VS = device.createShader(ShaderDesc{ShaderType::Vertex, "", ""});
+    pipelineDesc.FS = device.createShader(ShaderDesc{ShaderType::Fragment, "", ""});
+    pipelineDesc.VertexLayout = device.createVertexLayout(layoutDesc);
+    REQUIRE(pipelineDesc.VertexLayout->hasInstanceAttributes());
+
+    auto vertexBuffer = device.createVertexBuffer(VertexBufferDesc{12, 3});
+    auto indexBuffer = device.createIndexBuffer(IndexBufferDesc{3});
+
+    device.setPipelineState(device.createPipelineState(pipelineDesc));
+    device.setVertexBuffer(vertexBuffer);
+    device.setIndexBuffer(indexBuffer);
+    REQUIRE_THROWS(device.drawIndexedInstanced(3, 0, 0, 4));
+
+    device.setInstanceBuffer(device.createVertexBuffer(VertexBufferDesc{16, 4}));
+    device.drawIndexedInstanced(3, 0, 0, 4);
+    device.drawInstanced(3, 0, 2);
+
+    REQUIRE(device.getCommandCount(NullCommandType::DrawIndexedInstanced) == 1);
+    REQUIRE(device.getCommandCount(NullCommandType::DrawInstanced) == 1);
+    REQUIRE(device.getIndexCount() == 12);
+    REQUIRE(device.getVertexCount() == 6);
+    REQUIRE(device.getInstanceCount() == 6);
+    REQUIRE(device.getCommandLog().back().InstanceCount == 2);
+  }
+
+  SECTION("TEXTURE REGION WRITES")
+  {
+    TextureDesc textureDesc;
+    textureDesc.Format = TextureFormat::RGBA8;
+    textureDesc.Type = TextureType::Texture2D;
+    textureDesc.Width = 4;
+    textureDesc.Height = 4;
+    textureDesc.MipLevels = 3;
+    auto texture = std::static_pointer_cast<NullTexture>(device.createTexture(textureDesc));
+
+    REQUIRE(texture->getHostData(0).size() == 64);
+    REQUIRE(texture->getHostData(2).size() == 4);
+
+    ubyte texel[4] = {10, 20, 30, 40};
+    texture->writeData(0, 0, 1, 1, 2, 1, 0, 1, texel);
+    REQUIRE(texture->getHostData(0)[(2 * 4 + 1) * 4] == 10);
+    REQUIRE_THROWS(texture->writeData(2, 0, 1, 1, 0, 1, 0, 1, texel));
+  }
+
+  SECTION("COMPRESSED TEXTURE WRITES")
+  {
+    TextureDesc textureDesc;
+    textureDesc.Format = TextureFormat::BC1;
+    textureDesc.Type = TextureType::Texture2D;
+    textureDesc.Width = 8;
+    textureDesc.Height = 8;
+    textureDesc.MipLevels = 3;
+    auto texture = std::static_pointer_cast<NullTexture>(device.createTexture(textureDesc));
+
+    // Mips smaller than a block still occupy a whole one.
+    REQUIRE(texture->getHostData(0).size() == 32);
+    REQUIRE(texture->getHostData(2).size() == 8);
+
+    std::vector<ubyte> blocks(32, 7);
+    texture->writeCompressedData(0, blocks.data(), blocks.size());
+    REQUIRE(texture->getHostData(0) == blocks);
+    REQUIRE_THROWS(texture->writeCompressedData(1, blocks.data(), blocks.size()));
+  }
+
+  SECTION("TEXTURE READBACK")
+  {
+    TextureDesc textureDesc;
+    textureDesc.Format = TextureFormat::R32F;
+    textureDesc.Type = TextureType::Texture2D;
+    textureDesc.Width = 2;
+    textureDesc.Height = 2;
+    auto texture = device.createTexture(textureDesc);
+    float32 depths[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+    texture->writeData(0, 0, 0, 2, 0, 2, 0, 1, depths);
+
+    auto readback = device.createTextureReadback();
+    REQUIRE_FALSE(readback->hasResult());
+    uint64 id = readback->copy(texture);
+    REQUIRE(readback->hasResult());
+    REQUIRE(readback->getResultId() == id);
+    REQUIRE(readback->getResultWidth() == 2);
+    REQUIRE(readback->getData().size() == sizeof(depths));
+    REQUIRE(reinterpret_cast<const float32 *>(readback->getData().data())[2] == 0.75f);
+
+    // Render targets are never drawn into, so their copies never arrive.
+    textureDesc.Usage = TextureUsage::RenderTarget;
+    uint64 targetId = readback->copy(device.createTexture(textureDesc));
+    REQUIRE(targetId == id + 1);
+    REQUIRE(readback->getResultId() == id);
+  }
+}
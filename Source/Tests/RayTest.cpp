@@ -26,4 +26,17 @@ TEST_CASE("RAY-AABB INTERSECTION")
 
     REQUIRE(ray.Intersects(aabb) == false);
   }
+
+  SECTION("RAY REPORTS ENTRY DISTANCE")
+  {
+    Vector3 center(5.0f, 0.0f, 0.0f);
+    Vector3 extents(Vector3::Identity);
+    Aabb aabb(center, extents.X, extents.Y, extents.Z);
+
+    Ray ray(Vector3::Zero, Vector3(1.0f, 0.0f, 0.0f));
+
+    float32 distance = 0.0f;
+    REQUIRE(ray.Intersects(aabb, distance) == true);
+    REQUIRE(distance == Approx(4.0f));
+  }
 }
\ No newline at end of file
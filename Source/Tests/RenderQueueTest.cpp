@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include "../Engine/Rendering/RenderQueue.h"
+
+TEST_CASE("RENDER QUEUE")
+{
+  SECTION("KEY ORDERS STATE BEFORE DEPTH")
+  {
+    uint64 nearOtherMaterial = RenderQueue::makeKey(0, 2, 1, 0.0f);
+    uint64 farSameMaterial = RenderQueue::makeKey(0, 1, 7, 1.0f);
+    REQUIRE(farSameMaterial < nearOtherMaterial);
+
+    uint64 farOtherMesh = RenderQueue::makeKey(0, 1, 3, 0.9f);
+    uint64 nearSameMesh = RenderQueue::makeKey(0, 1, 2, 0.1f);
+    REQUIRE(nearSameMesh < farOtherMesh);
+
+    REQUIRE(RenderQueue::makeKey(0, 1, 2, 0.25f) < RenderQueue::makeKey(0, 1, 2, 0.75f));
+    REQUIRE(RenderQueue::makeKey(0, 100, 100, 1.0f) < RenderQueue::makeKey(1, 0, 0, 0.0f));
+  }
+
+  SECTION("DEPTH QUANTIZATION")
+  {
+    uint32 maxDepth = (1u << RenderQueue::DepthBits) - 1;
+    REQUIRE(RenderQueue::quantizeDepth(-1.0f) == 0);
+    REQUIRE(RenderQueue::quantizeDepth(0.0f) == 0);
+    REQUIRE(RenderQueue::quantizeDepth(1.0f) == maxDepth);
+    REQUIRE(RenderQueue::quantizeDepth(10.0f) == maxDepth);
+    REQUIRE(RenderQueue::quantizeDepth(0.5f) < RenderQueue::quantizeDepth(0.5001f));
+    REQUIRE(RenderQueue::makeDepthKey(0.25f) < RenderQueue::makeDepthKey(0.5f));
+  }
+
+  SECTION("SORT")
+  {
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<uint32> ids(0, 63);
+    std::uniform_real_distribution<float32> depths(0.0f, 1.0f);
+
+    RenderQueue queue;
+    std::vector<uint64> keys;
+    for (uint32 i = 0; i < 5000; i++)
+    {
+      uint64 key = RenderQueue::makeKey(ids(generator) % 2, ids(generator), ids(generator), depths(generator));
+      keys.push_back(key);
+      queue.push(key, i);
+    }
+    queue.sort();
+
+    const auto &entries = queue.getEntries();
+    REQUIRE(entries.size() == keys.size());
+    for (uint32 i = 0; i < entries.size(); i++)
+    {
+      REQUIRE(keys[entries[i].Index] == entries[i].Key);
+      if (i > 0)
+      {
+        REQUIRE(entries[i - 1].Key <= entries[i].Key);
+      }
+    }
+  }
+
+  SECTION("SORT IS STABLE")
+  {
+    RenderQueue queue;
+    queue.push(RenderQueue::makeKey(0, 3, 1, 0.5f), 0);
+    queue.push(RenderQueue::makeKey(0, 1, 1, 0.5f), 1);
+    queue.push(RenderQueue::makeKey(0, 3, 1, 0.5f), 2);
+    queue.push(RenderQueue::makeKey(0, 1, 1, 0.5f), 3);
+    queue.sort();
+
+    const auto &entries = queue.getEntries();
+    REQUIRE(entries[0].Index == 1);
+    REQUIRE(entries[1].Index == 3);
+    REQUIRE(entries[2].Index == 0);
+    REQUIRE(entries[3].Index == 2);
+  }
+
+  SECTION("CLEAR")
+  {
+    RenderQueue queue;
+    queue.push(1, 0);
+    queue.clear();
+    queue.sort();
+    REQUIRE(queue.size() == 0);
+  }
+}
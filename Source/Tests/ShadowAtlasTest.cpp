@@ -0,0 +1,228 @@
+#include "catch.hpp"
+
+#include "../Engine/Rendering/ShadowAtlas.h"
+
+namespace
+{
+  const uint32 ATLAS_SIZE = 1024;
+  const uint32 MAX_TILE_SIZE = 512;
+
+  ShadowAtlasRequest makeRequest(uint64 id, uint32 tileCount, float32 size, uint64 signature = 0)
+  {
+    ShadowAtlasRequest request;
+    request.Id = id;
+    request.TileCount = tileCount;
+    request.Size = size;
+    request.Signature = signature;
+    for (uint32 i = 0; i < tileCount; i++)
+    {
+      request.Transforms[i] = Matrix4::Translation(Vector3(static_cast<float32>(id), static_cast<float32>(signature), static_cast<float32>(i)));
+    }
+    return request;
+  }
+
+  bool overlaps(const ShadowAtlasTile &a, uint32 sizeA, const ShadowAtlasTile &b, uint32 sizeB)
+  {
+    return a.X < b.X + sizeB && b.X < a.X + sizeA && a.Y < b.Y + sizeB && b.Y < a.Y + sizeA;
+  }
+
+  bool tilesAreDisjoint(const std::vector<ShadowAtlasRequest> &requests, const ShadowAtlas &atlas)
+  {
+    const std::vector<ShadowAtlasAllocation> &allocations = atlas.getAllocations();
+    for (uint32 a = 0; a < allocations.size(); a++)
+    {
+      for (uint32 i = 0; i < requests[a].TileCount && allocations[a].TileSize > 0; i++)
+      {
+        const ShadowAtlasTile &tile = allocations[a].Tiles[i];
+        if (tile.X + allocations[a].TileSize > atlas.getSize() || tile.Y + allocations[a].TileSize > atlas.getSize())
+        {
+          return false;
+        }
+        for (uint32 b = a; b < allocations.size(); b++)
+        {
+          for (uint32 j = (a == b ? i + 1 : 0); j < requests[b].TileCount && allocations[b].TileSize > 0; j++)
+          {
+            if (overlaps(tile, allocations[a].TileSize, allocations[b].Tiles[j], allocations[b].TileSize))
+            {
+              return false;
+            }
+          }
+        }
+      }
+    }
+    return true;
+  }
+}
+
+TEST_CASE("SHADOW ATLAS")
+{
+  ShadowAtlas atlas;
+  atlas.reset(ATLAS_SIZE, MAX_TILE_SIZE);
+
+  SECTION("PLACES TILES WITHOUT OVERLAP")
+  {
+    std::vector<ShadowAtlasRequest> requests = {
+        makeRequest(1, 1, 300.0f),
+        makeRequest(2, 6, 100.0f),
+        makeRequest(3, 1, 900.0f),
+        makeRequest(4, 6, 20.0f),
+    };
+    atlas.update(requests, 100);
+
+    const std::vector<ShadowAtlasAllocation> &allocations = atlas.getAllocations();
+    REQUIRE(allocations.size() == requests.size());
+    // Sizes round up to a power of two, within the smallest and largest tiles.
+    REQUIRE(allocations[0].TileSize == 512);
+    REQUIRE(allocations[1].TileSize == 128);
+    REQUIRE(allocations[2].TileSize == MAX_TILE_SIZE);
+    REQUIRE(allocations[3].TileSize == ShadowAtlas::MIN_TILE_SIZE);
+    REQUIRE(tilesAreDisjoint(requests, atlas));
+    REQUIRE(atlas.getUnplacedCount() == 0);
+    REQUIRE(atlas.getRenderedTileCount() == 14);
+    REQUIRE(atlas.getOccupancy() == Approx((2.0f * 512 * 512 + 6.0f * 128 * 128 + 6.0f * 64 * 64) / (ATLAS_SIZE * ATLAS_SIZE)));
+    for (const ShadowAtlasAllocation &allocation : allocations)
+    {
+      REQUIRE(allocation.Rendered);
+      REQUIRE(allocation.Valid);
+    }
+    REQUIRE(allocations[1].Transforms[5] == requests[1].Transforms[5]);
+  }
+
+  SECTION("SHRINKS LIGHTS WHICH DO NOT FIT")
+  {
+    std::vector<ShadowAtlasRequest> requests = {
+        makeRequest(1, 1, 512.0f),
+        makeRequest(2, 1, 512.0f),
+        makeRequest(3, 1, 512.0f),
+        makeRequest(4, 6, 512.0f),
+    };
+    atlas.update(requests, 100);
+
+    // Three quarters of the atlas are taken, leaving six 128 tiles to fit in the last 512.
+    const std::vector<ShadowAtlasAllocation> &allocations = atlas.getAllocations();
+    REQUIRE(allocations[3].TileSize == 128);
+    REQUIRE(tilesAreDisjoint(requests, atlas));
+
+    // The forty smallest tiles left hold six more point lights. With no room left at all the seventh is given no
+    // tiles and is not rendered.
+    for (uint32 i = 5; i < 12; i++)
+    {
+      requests.push_back(makeRequest(i, 6, 64.0f));
+    }
+    atlas.update(requests, 100);
+    REQUIRE(atlas.getUnplacedCount() == 1);
+    REQUIRE(atlas.getAllocations()[9].TileSize == ShadowAtlas::MIN_TILE_SIZE);
+    REQUIRE(atlas.getAllocations()[10].TileSize == 0);
+    REQUIRE_FALSE(atlas.getAllocations()[10].Rendered);
+    REQUIRE_FALSE(atlas.getAllocations()[10].Valid);
+    REQUIRE(tilesAreDisjoint(requests, atlas));
+  }
+
+  SECTION("REUSES TILES UNTIL THE SIGNATURE CHANGES")
+  {
+    std::vector<ShadowAtlasRequest> requests = {
+        makeRequest(1, 1, 256.0f, 10),
+        makeRequest(2, 6, 128.0f, 20),
+    };
+    atlas.update(requests, 100);
+    ShadowAtlasTile tile = atlas.getAllocations()[1].Tiles[0];
+
+    atlas.update(requests, 100);
+    REQUIRE(atlas.getRenderedTileCount() == 0);
+    REQUIRE(atlas.getCachedTileCount() == 7);
+    REQUIRE(atlas.getAllocations()[1].Valid);
+    REQUIRE_FALSE(atlas.getAllocations()[1].Rendered);
+
+    // A changed light is drawn again in the same place, with its new transforms.
+    requests[1] = makeRequest(2, 6, 128.0f, 21);
+    atlas.update(requests, 100);
+    REQUIRE(atlas.getRenderedTileCount() == 6);
+    REQUIRE(atlas.getCachedTileCount() == 1);
+    REQUIRE(atlas.getAllocations()[1].Rendered);
+    REQUIRE(atlas.getAllocations()[1].Tiles[0].X == tile.X);
+    REQUIRE(atlas.getAllocations()[1].Tiles[0].Y == tile.Y);
+    REQUIRE(atlas.getAllocations()[1].Transforms[0] == requests[1].Transforms[0]);
+  }
+
+  SECTION("RENDERS NO MORE THAN THE BUDGET")
+  {
+    std::vector<ShadowAtlasRequest> requests = {
+        makeRequest(1, 6, 64.0f, 1),
+        makeRequest(2, 1, 256.0f, 1),
+        makeRequest(3, 6, 128.0f, 1),
+    };
+    atlas.update(requests, 7);
+
+    // The largest lights go first, and a point light is never drawn in part.
+    REQUIRE(atlas.getRenderedTileCount() == 7);
+    REQUIRE(atlas.getDeferredTileCount() == 6);
+    REQUIRE(atlas.getAllocations()[1].Rendered);
+    REQUIRE(atlas.getAllocations()[2].Rendered);
+    REQUIRE_FALSE(atlas.getAllocations()[0].Valid);
+
+    // Lights never drawn take priority over stale ones.
+    requests[1].Signature = 2;
+    requests[2].Signature = 2;
+    atlas.update(requests, 7);
+    REQUIRE(atlas.getAllocations()[0].Rendered);
+    REQUIRE(atlas.getAllocations()[1].Rendered);
+    REQUIRE_FALSE(atlas.getAllocations()[2].Rendered);
+    // Stale tiles are still looked up with the transforms they were drawn with.
+    REQUIRE(atlas.getAllocations()[2].Valid);
+    REQUIRE(atlas.getAllocations()[2].Transforms[0] == makeRequest(3, 6, 128.0f, 1).Transforms[0]);
+
+    atlas.update(requests, 7);
+    REQUIRE(atlas.getAllocations()[2].Rendered);
+    REQUIRE(atlas.getDeferredTileCount() == 0);
+  }
+
+  SECTION("RESIZES ONLY PAST THE HYSTERESIS")
+  {
+    std::vector<ShadowAtlasRequest> requests = {makeRequest(1, 1, 256.0f)};
+    atlas.update(requests, 100);
+    REQUIRE(atlas.getAllocations()[0].TileSize == 256);
+
+    // Shrinking a little keeps the tile and its contents.
+    requests[0].Size = 120.0f;
+    atlas.update(requests, 100);
+    REQUIRE(atlas.getAllocations()[0].TileSize == 256);
+    REQUIRE_FALSE(atlas.getAllocations()[0].Rendered);
+
+    requests[0].Size = 80.0f;
+    atlas.update(requests, 100);
+    REQUIRE(atlas.getAllocations()[0].TileSize == 128);
+    REQUIRE(atlas.getAllocations()[0].Rendered);
+
+    // Growing past the tile takes effect straight away.
+    requests[0].Size = 130.0f;
+    atlas.update(requests, 100);
+    REQUIRE(atlas.getAllocations()[0].TileSize == 256);
+    REQUIRE(atlas.getAllocations()[0].Rendered);
+  }
+
+  SECTION("MERGES FREED TILES")
+  {
+    std::vector<ShadowAtlasRequest> requests;
+    for (uint32 i = 0; i < 4; i++)
+    {
+      requests.push_back(makeRequest(i, 6, 64.0f));
+    }
+    atlas.update(requests, 100);
+    REQUIRE(tilesAreDisjoint(requests, atlas));
+
+    // Once the small tiles are freed the whole atlas is free for the largest tiles again.
+    requests.clear();
+    for (uint32 i = 10; i < 14; i++)
+    {
+      requests.push_back(makeRequest(i, 1, 512.0f));
+    }
+    atlas.update(requests, 100);
+    REQUIRE(atlas.getUnplacedCount() == 0);
+    REQUIRE(atlas.getOccupancy() == Approx(1.0f));
+    for (const ShadowAtlasAllocation &allocation : atlas.getAllocations())
+    {
+      REQUIRE(allocation.TileSize == 512);
+    }
+    REQUIRE(tilesAreDisjoint(requests, atlas));
+  }
+}
@@ -0,0 +1,143 @@
+#include "catch.hpp"
+
+#include <algorithm>
+
+#include "../Engine/Core/JobSystem.h"
+#include "../Engine/Maths/AabbArray.hpp"
+#include "../Engine/Rendering/ShadowCascades.h"
+
+namespace
+{
+  const uint32 RESOLUTION = 1024;
+  // Straight down, tilted slightly so the light is never parallel to its view's up vector.
+  const Vector3 LIGHT_DIRECTION = Vector3::Normalize(Vector3(0.1f, -1.0f, 0.0f));
+
+  bool hasCaster(const ShadowCascades &cascades, uint32 cascade, uint32 caster)
+  {
+    const std::vector<uint32> &casters = cascades.getCasters(cascade);
+    return std::find(casters.begin(), casters.end(), caster) != casters.end();
+  }
+
+  Vector4 project(const ShadowCascades &cascades, uint32 cascade, const Vector3 &position)
+  {
+    return cascades.getTransform(cascade) * Vector4(position, 1.0f);
+  }
+}
+
+TEST_CASE("SHADOW CASCADES")
+{
+  ShadowCascades cascades;
+  cascades.reset(4, RESOLUTION);
+  std::vector<CascadeBounds> bounds = {
+      {Vector3(0.0f, 0.0f, -5.0f), 5.0f},
+      {Vector3(0.0f, 0.0f, -20.0f), 12.0f},
+      {Vector3(0.0f, 0.0f, -50.0f), 30.0f},
+      {Vector3(0.0f, 0.0f, -120.0f), 70.0f},
+  };
+
+  SECTION("FITS EACH CASCADE AROUND ITS BOUNDS")
+  {
+    AabbArray casterBounds;
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+    REQUIRE(cascades.getRenderedCount() == 4);
+    for (uint32 i = 0; i < bounds.size(); i++)
+    {
+      Vector4 center = project(cascades, i, bounds[i].Center);
+      REQUIRE(std::abs(center.X) <= 2.0f / RESOLUTION);
+      REQUIRE(std::abs(center.Y) <= 2.0f / RESOLUTION);
+      REQUIRE(std::abs(center.Z) < 1.0f);
+      // The edge of the sphere is at the edge of the layer.
+      Vector4 edge = project(cascades, i, bounds[i].Center + Vector3(0.0f, 0.0f, bounds[i].Radius));
+      REQUIRE(std::abs(std::abs(edge.X) + std::abs(edge.Y) - 1.0f) <= 2.0f / RESOLUTION);
+    }
+  }
+
+  SECTION("KEEPS ONLY THE CASTERS ABLE TO SHADOW A CASCADE")
+  {
+    AabbArray casterBounds;
+    uint32 inside = casterBounds.add(Aabb(Vector3(0.0f, 0.0f, -5.0f), 1.0f, 1.0f, 1.0f));
+    uint32 beside = casterBounds.add(Aabb(Vector3(0.0f, 0.0f, -16.0f), 1.0f, 1.0f, 1.0f));
+    uint32 below = casterBounds.add(Aabb(Vector3(0.0f, -30.0f, -5.0f), 1.0f, 1.0f, 1.0f));
+    uint32 overhead = casterBounds.add(Aabb(Vector3(-8.0f, 80.0f, -5.0f), 2.0f, 2.0f, 2.0f));
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+
+    REQUIRE(hasCaster(cascades, 0, inside));
+    REQUIRE_FALSE(hasCaster(cascades, 0, beside));
+    REQUIRE_FALSE(hasCaster(cascades, 0, below));
+    // Far outside the volume but between it and the light.
+    REQUIRE(hasCaster(cascades, 0, overhead));
+    REQUIRE(hasCaster(cascades, 1, beside));
+
+    // The near plane is pulled back so the caster overhead is not clipped.
+    REQUIRE(project(cascades, 0, Vector3(-8.0f, 82.0f, -5.0f)).Z >= -1.0f);
+  }
+
+  SECTION("REUSES DISTANT CASCADES UNTIL THEY MOVE OR EXPIRE")
+  {
+    AabbArray casterBounds;
+    casterBounds.add(Aabb(Vector3(0.0f, 0.0f, -50.0f), 1.0f, 1.0f, 1.0f));
+    cascades.setRefreshInterval(3);
+    cascades.setTexelThreshold(2.0f);
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+    Matrix4 renderedTransform = cascades.getTransform(2);
+
+    // Moving less than the threshold keeps the distant cascades' layers and the transforms they were rendered with.
+    bounds[2].Center.X += 2.0f * bounds[2].Radius / RESOLUTION;
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+    REQUIRE(cascades.isRendered(0));
+    REQUIRE(cascades.isRendered(1));
+    REQUIRE_FALSE(cascades.isRendered(2));
+    REQUIRE_FALSE(cascades.isRendered(3));
+    REQUIRE(cascades.getTransform(2) == renderedTransform);
+    REQUIRE(cascades.getRenderedCount() == 2);
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+    REQUIRE(cascades.getRenderedCount() == 2);
+
+    // Then once every refresh interval they are drawn again.
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+    REQUIRE(cascades.getRenderedCount() == 4);
+    REQUIRE(hasCaster(cascades, 2, 0));
+
+    // Moving past the threshold draws the cascade straight away.
+    bounds[3].Center.X += 8.0f * bounds[3].Radius / RESOLUTION;
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+    REQUIRE_FALSE(cascades.isRendered(2));
+    REQUIRE(cascades.isRendered(3));
+
+    // As does turning the light.
+    cascades.update(bounds, Vector3::Normalize(Vector3(0.3f, -1.0f, 0.0f)), casterBounds);
+    REQUIRE(cascades.isRendered(2));
+
+    cascades.reset(4, RESOLUTION);
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+    REQUIRE(cascades.getRenderedCount() == 4);
+
+    // Caching is disabled from a cascade past the last.
+    cascades.setFirstCachedCascade(4);
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+    REQUIRE(cascades.getRenderedCount() == 4);
+  }
+
+  SECTION("MATCHES ACROSS JOBS")
+  {
+    AabbArray casterBounds;
+    for (uint32 i = 0; i < 500; i++)
+    {
+      float32 x = static_cast<float32>(i % 25) * 8.0f - 100.0f;
+      float32 z = static_cast<float32>(i / 25) * -10.0f;
+      casterBounds.add(Aabb(Vector3(x, static_cast<float32>(i % 7), z), 1.0f, 2.0f + i % 3, 1.0f));
+    }
+    cascades.update(bounds, LIGHT_DIRECTION, casterBounds);
+
+    JobSystem jobSystem(4);
+    ShadowCascades parallel;
+    parallel.reset(4, RESOLUTION);
+    parallel.update(bounds, LIGHT_DIRECTION, casterBounds, &jobSystem);
+    for (uint32 i = 0; i < bounds.size(); i++)
+    {
+      REQUIRE(parallel.getCasters(i) == cascades.getCasters(i));
+      REQUIRE(parallel.getTransform(i) == cascades.getTransform(i));
+    }
+    REQUIRE(cascades.getCasters(0).size() < cascades.getCasters(3).size());
+  }
+}
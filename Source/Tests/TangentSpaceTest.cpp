@@ -0,0 +1,156 @@
+#include "catch.hpp"
+
+#include <cmath>
+
+#include "../Engine/Core/JobSystem.h"
+#include "../Engine/Geometry/TangentSpace.hpp"
+
+namespace
+{
+  struct TestMesh
+  {
+    std::vector<Vector3> Positions;
+    std::vector<Vector3> Normals;
+    std::vector<Vector2> TexCoords;
+    std::vector<uint32> Indices;
+  };
+
+  /// @brief A unit quad in the XY plane facing +Z, textured with u along X and v along Y unless mirrored.
+  TestMesh createQuad(bool mirrored)
+  {
+    TestMesh mesh;
+    mesh.Positions = {Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f)};
+    mesh.Normals.assign(4, Vector3(0.0f, 0.0f, 1.0f));
+    for (const Vector3 &position : mesh.Positions)
+    {
+      mesh.TexCoords.push_back(Vector2(mirrored ? 1.0f - position.X : position.X, position.Y));
+    }
+    mesh.Indices = {0, 1, 2, 0, 2, 3};
+    return mesh;
+  }
+
+  /// @brief A unit sphere of rings around the Y axis with a texture seam and a duplicated vertex per ring at each pole.
+  TestMesh createSphere(uint32 rings, uint32 segments)
+  {
+    TestMesh mesh;
+    for (uint32 ring = 0; ring <= rings; ring++)
+    {
+      float32 theta = 3.14159265f * ring / rings;
+      for (uint32 segment = 0; segment <= segments; segment++)
+      {
+        float32 phi = 2.0f * 3.14159265f * segment / segments;
+        Vector3 position(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        mesh.Positions.push_back(position);
+        mesh.Normals.push_back(position);
+        mesh.TexCoords.push_back(Vector2(segment / static_cast<float32>(segments), ring / static_cast<float32>(rings)));
+      }
+    }
+    for (uint32 ring = 0; ring < rings; ring++)
+    {
+      for (uint32 segment = 0; segment < segments; segment++)
+      {
+        uint32 upper = ring * (segments + 1) + segment;
+        uint32 lower = upper + segments + 1;
+        mesh.Indices.insert(mesh.Indices.end(), {upper, upper + 1, lower, upper + 1, lower + 1, lower});
+      }
+    }
+    return mesh;
+  }
+
+  std::vector<Vector4> generateTangents(const TestMesh &mesh, JobSystem *jobs = nullptr)
+  {
+    return TangentSpace::generateTangents(mesh.Positions, mesh.Normals, mesh.TexCoords, mesh.Indices.data(),
+                                          static_cast<uint32>(mesh.Indices.size()), jobs);
+  }
+}
+
+TEST_CASE("TANGENT SPACE")
+{
+  SECTION("GENERATES AREA WEIGHTED NORMALS")
+  {
+    TestMesh mesh = createQuad(false);
+    // An extra vertex no triangle uses.
+    mesh.Positions.push_back(Vector3(5.0f, 5.0f, 5.0f));
+    std::vector<Vector3> normals = TangentSpace::generateNormals(mesh.Positions, mesh.Indices.data(), static_cast<uint32>(mesh.Indices.size()));
+
+    REQUIRE(normals.size() == 5);
+    for (uint32 i = 0; i < 4; i++)
+    {
+      REQUIRE(normals[i] == Vector3(0.0f, 0.0f, 1.0f));
+    }
+    REQUIRE(normals[4] == Vector3(0.0f, 0.0f, 0.0f));
+  }
+
+  SECTION("FOLLOWS THE TEXTURE'S U DIRECTION")
+  {
+    std::vector<Vector4> tangents = generateTangents(createQuad(false));
+    for (const Vector4 &tangent : tangents)
+    {
+      REQUIRE(tangent.X == Approx(1.0f));
+      REQUIRE(tangent.Y == Approx(0.0f).margin(1.0e-6f));
+      REQUIRE(tangent.Z == Approx(0.0f).margin(1.0e-6f));
+      REQUIRE(tangent.W == 1.0f);
+    }
+  }
+
+  SECTION("FLIPS HANDEDNESS FOR MIRRORED TEXTURES")
+  {
+    TestMesh mesh = createQuad(true);
+    std::vector<Vector4> tangents = generateTangents(mesh);
+    for (uint32 i = 0; i < tangents.size(); i++)
+    {
+      REQUIRE(tangents[i].X == Approx(-1.0f));
+      REQUIRE(tangents[i].W == -1.0f);
+      // The bitangent still points along +v.
+      Vector3 bitangent = Vector3::Cross(mesh.Normals[i], Vector3(tangents[i])) * tangents[i].W;
+      REQUIRE(bitangent.Y == Approx(1.0f));
+    }
+  }
+
+  SECTION("FALLS BACK FOR DEGENERATE TEXTURE COORDINATES")
+  {
+    TestMesh mesh = createQuad(false);
+    mesh.TexCoords.assign(4, Vector2(0.5f, 0.5f));
+    std::vector<Vector4> tangents = generateTangents(mesh);
+    for (const Vector4 &tangent : tangents)
+    {
+      Vector3 direction(tangent);
+      REQUIRE(direction.Length() == Approx(1.0f));
+      REQUIRE(direction.Z == Approx(0.0f).margin(1.0e-6f));
+      REQUIRE(std::fabs(tangent.W) == 1.0f);
+    }
+  }
+
+  SECTION("KEEPS TANGENTS PERPENDICULAR TO CURVED SURFACES")
+  {
+    TestMesh mesh = createSphere(24, 48);
+    std::vector<Vector4> tangents = generateTangents(mesh);
+    REQUIRE(tangents.size() == mesh.Positions.size());
+    for (uint32 i = 0; i < tangents.size(); i++)
+    {
+      Vector3 direction(tangents[i]);
+      REQUIRE(direction.Length() == Approx(1.0f));
+      REQUIRE(Vector3::Dot(direction, mesh.Normals[i]) == Approx(0.0f).margin(1.0e-5f));
+      REQUIRE(tangents[i].W == 1.0f);
+    }
+  }
+
+  SECTION("MATCHES THE SERIAL RESULT WHEN SPLIT ACROSS WORKERS")
+  {
+    TestMesh mesh = createSphere(128, 256);
+    JobSystem jobs(3);
+    uint32 indexCount = static_cast<uint32>(mesh.Indices.size());
+    REQUIRE(TangentSpace::generateNormals(mesh.Positions, mesh.Indices.data(), indexCount, &jobs) ==
+            TangentSpace::generateNormals(mesh.Positions, mesh.Indices.data(), indexCount));
+
+    std::vector<Vector4> serial = generateTangents(mesh);
+    std::vector<Vector4> parallel = generateTangents(mesh, &jobs);
+    REQUIRE(serial.size() == parallel.size());
+    bool identical = true;
+    for (uint32 i = 0; i < serial.size(); i++)
+    {
+      identical &= serial[i].X == parallel[i].X && serial[i].Y == parallel[i].Y && serial[i].Z == parallel[i].Z && serial[i].W == parallel[i].W;
+    }
+    REQUIRE(identical);
+  }
+}
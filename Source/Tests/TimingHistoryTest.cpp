@@ -0,0 +1,46 @@
+#include "catch.hpp"
+
+#include "../Engine/Utility/TimingHistory.hpp"
+
+TEST_CASE("TIMING HISTORY")
+{
+  SECTION("EMPTY")
+  {
+    TimingHistory history;
+    REQUIRE(history.getCount() == 0);
+    REQUIRE(history.getMin() == 0.0f);
+    REQUIRE(history.getMax() == 0.0f);
+    REQUIRE(history.getAverage() == 0.0f);
+  }
+
+  SECTION("STATISTICS")
+  {
+    TimingHistory history;
+    history.push(2.0f);
+    history.push(4.0f);
+    history.push(6.0f);
+
+    REQUIRE(history.getCount() == 3);
+    REQUIRE(history.getOffset() == 0);
+    REQUIRE(history.getLatest() == 6.0f);
+    REQUIRE(history.getMin() == 2.0f);
+    REQUIRE(history.getMax() == 6.0f);
+    REQUIRE(history.getAverage() == Approx(4.0f));
+  }
+
+  SECTION("WRAPS AROUND")
+  {
+    TimingHistory history;
+    for (uint32 i = 0; i < TIMING_HISTORY_FRAMES + 10; i++)
+    {
+      history.push(static_cast<float32>(i));
+    }
+
+    REQUIRE(history.getCount() == TIMING_HISTORY_FRAMES);
+    REQUIRE(history.getOffset() == 10);
+    REQUIRE(history.getSamples()[history.getOffset()] == 10.0f);
+    REQUIRE(history.getMin() == 10.0f);
+    REQUIRE(history.getMax() == static_cast<float32>(TIMING_HISTORY_FRAMES + 9));
+    REQUIRE(history.getLatest() == static_cast<float32>(TIMING_HISTORY_FRAMES + 9));
+  }
+}
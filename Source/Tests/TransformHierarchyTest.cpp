@@ -0,0 +1,81 @@
+#include "catch.hpp"
+
+#include "../Engine/Core/TransformHierarchy.h"
+
+namespace
+{
+  Vector3 getTranslation(const Matrix4 &matrix)
+  {
+    return Vector3(matrix[3][0], matrix[3][1], matrix[3][2]);
+  }
+}
+
+TEST_CASE("TRANSFORM HIERARCHY")
+{
+  SECTION("PROPAGATES TO ANY DEPTH")
+  {
+    TransformHierarchy hierarchy;
+    uint32 parent = TransformHierarchy::NoParent;
+    std::vector<uint32> chain;
+    for (uint32 i = 0; i < 10; i++)
+    {
+      uint32 node = hierarchy.add();
+      hierarchy.setParent(node, parent);
+      hierarchy.getLocalTransform(node).setPosition(Vector3(1.0f, 0.0f, 0.0f));
+      chain.push_back(node);
+      parent = node;
+    }
+
+    hierarchy.update();
+    REQUIRE(hierarchy.getUpdatedNodes().size() == 10);
+    REQUIRE(getTranslation(hierarchy.getWorldMatrix(chain.back())).X == Approx(10.0f));
+
+    hierarchy.getLocalTransform(chain[0]).setScale(Vector3(2.0f, 2.0f, 2.0f));
+    hierarchy.update();
+    REQUIRE(getTranslation(hierarchy.getWorldMatrix(chain.back())).X == Approx(19.0f));
+  }
+
+  SECTION("ONLY DIRTY SUBTREES UPDATE")
+  {
+    TransformHierarchy hierarchy;
+    uint32 root = hierarchy.add();
+    uint32 left = hierarchy.add();
+    uint32 right = hierarchy.add();
+    uint32 leftChild = hierarchy.add();
+    hierarchy.setParent(left, root);
+    hierarchy.setParent(right, root);
+    hierarchy.setParent(leftChild, left);
+    hierarchy.update();
+
+    hierarchy.update();
+    REQUIRE(hierarchy.getUpdatedNodes().empty());
+
+    hierarchy.getLocalTransform(left).setPosition(Vector3(0.0f, 5.0f, 0.0f));
+    hierarchy.update();
+    REQUIRE(hierarchy.getUpdatedNodes() == std::vector<uint32>{left, leftChild});
+    REQUIRE(getTranslation(hierarchy.getWorldMatrix(leftChild)).Y == Approx(5.0f));
+    REQUIRE(getTranslation(hierarchy.getWorldMatrix(right)).Y == Approx(0.0f));
+  }
+
+  SECTION("REPARENTING REORDERS")
+  {
+    TransformHierarchy hierarchy;
+    uint32 child = hierarchy.add();
+    uint32 grandChild = hierarchy.add();
+    hierarchy.setParent(grandChild, child);
+    hierarchy.getLocalTransform(child).setPosition(Vector3(0.0f, 0.0f, 1.0f));
+    hierarchy.getLocalTransform(grandChild).setPosition(Vector3(0.0f, 0.0f, 1.0f));
+    hierarchy.update();
+
+    // The new parent is created after its children, so it has to be moved ahead of them.
+    uint32 parent = hierarchy.add();
+    hierarchy.getLocalTransform(parent).setPosition(Vector3(0.0f, 0.0f, 3.0f));
+    hierarchy.setParent(child, parent);
+    hierarchy.update();
+
+    REQUIRE(hierarchy.getParent(child) == parent);
+    REQUIRE(hierarchy.getUpdatedNodes().front() == parent);
+    REQUIRE(getTranslation(hierarchy.getWorldMatrix(child)).Z == Approx(4.0f));
+    REQUIRE(getTranslation(hierarchy.getWorldMatrix(grandChild)).Z == Approx(5.0f));
+  }
+}
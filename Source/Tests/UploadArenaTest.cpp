@@ -0,0 +1,77 @@
+#include "catch.hpp"
+
+#include "../Engine/RenderApi/Null/NullGpuBuffer.hpp"
+#include "../Engine/RenderApi/Null/NullRenderDevice.hpp"
+
+TEST_CASE("UPLOAD ARENA")
+{
+  RenderDeviceDesc desc;
+  desc.FrameCount = 2;
+  desc.RenderWidth = 1280;
+  desc.RenderHeight = 720;
+  NullRenderDevice device(desc);
+
+  UploadArenaDesc arenaDesc;
+  arenaDesc.ByteCount = 1000;
+  auto arena = device.createUploadArena(arenaDesc);
+
+  SECTION("SLICES ARE ALIGNED")
+  {
+    REQUIRE(arena->getDesc().ByteCount % arena->getAlignment() == 0);
+    REQUIRE(arena->getBuffer()->getSizeBytes() == arena->getDesc().ByteCount * desc.FrameCount);
+  }
+
+  SECTION("ALLOCATIONS ARE ALIGNED")
+  {
+    float32 data[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    arena->beginFrame();
+    uint64 first = arena->write(data, sizeof(data));
+    uint64 second = arena->write(data, sizeof(data));
+    REQUIRE(second - first == arena->getAlignment());
+    REQUIRE(second % arena->getAlignment() == 0);
+  }
+
+  SECTION("FLUSH UPLOADS ONCE PER FRAME")
+  {
+    auto buffer = std::static_pointer_cast<NullGpuBuffer>(arena->getBuffer());
+    float32 data[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    arena->beginFrame();
+    arena->write(data, sizeof(data));
+    uint64 offset = arena->write(data, sizeof(data));
+    arena->flush();
+    arena->flush();
+    REQUIRE(buffer->getWriteCount() == 1);
+
+    float32 dst[4] = {};
+    buffer->readData(offset, sizeof(dst), dst);
+    REQUIRE(dst[3] == 4.0f);
+  }
+
+  SECTION("FRAMES USE SEPARATE SLICES")
+  {
+    float32 data[4] = {};
+    arena->beginFrame();
+    uint64 first = arena->write(data, sizeof(data));
+    arena->flush();
+    arena->beginFrame();
+    uint64 second = arena->write(data, sizeof(data));
+    REQUIRE(second - first == arena->getDesc().ByteCount);
+  }
+
+  SECTION("OVERFLOW THROWS")
+  {
+    std::vector<ubyte> data(arena->getDesc().ByteCount + 1);
+    arena->beginFrame();
+    REQUIRE_THROWS(arena->write(data.data(), data.size()));
+  }
+
+  SECTION("RANGED BIND IS VALIDATED")
+  {
+    arena->beginFrame();
+    float32 data[4] = {};
+    uint64 offset = arena->write(data, sizeof(data));
+    REQUIRE_NOTHROW(device.setConstantBuffer(0, arena->getBuffer(), offset, sizeof(data)));
+    REQUIRE_THROWS(device.setConstantBuffer(0, arena->getBuffer(), offset + 4, sizeof(data)));
+    REQUIRE_THROWS(device.setConstantBuffer(0, arena->getBuffer(), arena->getBuffer()->getSizeBytes(), sizeof(data)));
+  }
+}
@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../Engine/Core/UploadQueue.h"
+
+TEST_CASE("UPLOAD QUEUE")
+{
+  UploadQueue queue;
+  std::vector<uint32> order;
+
+  SECTION("RUNS IN ORDER WITHIN THE BYTE BUDGET")
+  {
+    for (uint32 i = 0; i < 4; i++)
+    {
+      queue.push(100, [&order, i]()
+                 { order.push_back(i); });
+    }
+    REQUIRE(queue.getPendingCount() == 4);
+    REQUIRE(queue.getPendingBytes() == 400);
+
+    REQUIRE(queue.process(250, 1000.0f) == 2);
+    REQUIRE(order == std::vector<uint32>{0, 1});
+    REQUIRE(queue.getPendingBytes() == 200);
+
+    REQUIRE(queue.process(1000, 1000.0f) == 2);
+    REQUIRE(order == std::vector<uint32>{0, 1, 2, 3});
+    REQUIRE(queue.getPendingCount() == 0);
+    REQUIRE(queue.process(1000, 1000.0f) == 0);
+  }
+
+  SECTION("AN OVERSIZED UPLOAD STILL RUNS")
+  {
+    queue.push(1000, [&order]()
+               { order.push_back(0); });
+    queue.push(1, [&order]()
+               { order.push_back(1); });
+
+    REQUIRE(queue.process(10, 1000.0f) == 1);
+    REQUIRE(order == std::vector<uint32>{0});
+    REQUIRE(queue.process(10, 1000.0f) == 1);
+  }
+
+  SECTION("STOPS ONCE THE TIME BUDGET IS SPENT")
+  {
+    for (uint32 i = 0; i < 3; i++)
+    {
+      queue.push(0, [&order, i]()
+                 {
+                   order.push_back(i);
+                   std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                 });
+    }
+    REQUIRE(queue.process(1000, 1.0f) == 1);
+    REQUIRE(queue.getPendingCount() == 2);
+  }
+
+  SECTION("UPLOADS MAY QUEUE MORE UPLOADS")
+  {
+    queue.push(0, [&]()
+               { queue.push(0, [&order]()
+                            { order.push_back(1); }); });
+    REQUIRE(queue.process(1000, 1000.0f) == 2);
+    REQUIRE(order == std::vector<uint32>{1});
+  }
+
+  SECTION("PUSHES FROM MANY THREADS")
+  {
+    std::vector<std::thread> threads;
+    for (uint32 t = 0; t < 4; t++)
+    {
+      threads.emplace_back([&queue]()
+                           {
+                             for (uint32 i = 0; i < 100; i++)
+                             {
+                               queue.push(1, []() {});
+                             }
+                           });
+    }
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+    REQUIRE(queue.getPendingBytes() == 400);
+    REQUIRE(queue.process(1000, 1000.0f) == 400);
+  }
+}
@@ -0,0 +1,130 @@
+#include "catch.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "../Engine/Rendering/VertexCompression.h"
+
+namespace
+{
+  template <typename T>
+  T read(const std::vector<uint8> &data, uint64 offset)
+  {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+  }
+
+  std::vector<float32> createVertex(const Vector3 &position, const Vector3 &normal, const Vector2 &texCoord,
+                                    const Vector3 &tangent, const Vector3 &bitangent)
+  {
+    return {position.X, position.Y, position.Z, normal.X, normal.Y, normal.Z, texCoord.X, texCoord.Y,
+            tangent.X, tangent.Y, tangent.Z, bitangent.X, bitangent.Y, bitangent.Z};
+  }
+}
+
+TEST_CASE("VERTEX COMPRESSION")
+{
+  SECTION("STRIDES")
+  {
+    REQUIRE(VertexCompression::getStride(VertexFormat::Full) == 56);
+    REQUIRE(VertexCompression::getStride(VertexFormat::Compact) == 28);
+    REQUIRE(VertexCompression::getStride(VertexFormat::CompactQuantized) == 24);
+  }
+
+  SECTION("CONVERTS HALF FLOATS")
+  {
+    REQUIRE(VertexCompression::toHalf(0.0f) == 0x0000);
+    REQUIRE(VertexCompression::toHalf(1.0f) == 0x3c00);
+    REQUIRE(VertexCompression::toHalf(-2.5f) == 0xc100);
+    REQUIRE(VertexCompression::toHalf(65504.0f) == 0x7bff);
+    REQUIRE(VertexCompression::toHalf(1.0e6f) == 0x7c00);
+    REQUIRE(VertexCompression::toHalf(std::ldexp(1.0f, -24)) == 0x0001);
+    // Halfway between 1 and the next half, which rounds to the even mantissa.
+    REQUIRE(VertexCompression::toHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3c00);
+    REQUIRE(VertexCompression::toHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02);
+
+    for (float32 value : {0.0f, 1.0f, -2.5f, 0.3330078125f, 65504.0f, std::ldexp(1.0f, -24)})
+    {
+      REQUIRE(VertexCompression::fromHalf(VertexCompression::toHalf(value)) == value);
+    }
+    REQUIRE(std::isinf(VertexCompression::fromHalf(0x7c00)));
+  }
+
+  SECTION("ENCODES UNIT VECTORS AS OCTAHEDRA")
+  {
+    uint32 state = 11;
+    auto random = [&state]()
+    {
+      state = state * 1664525u + 1013904223u;
+      return static_cast<float32>(state >> 8) / static_cast<float32>(1 << 24) * 2.0f - 1.0f;
+    };
+
+    std::vector<Vector3> vectors = {Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f), Vector3(1.0f, 0.0f, 0.0f),
+                                    Vector3(0.0f, -1.0f, 0.0f)};
+    for (uint32 i = 0; i < 1000; i++)
+    {
+      vectors.push_back(Vector3::Normalize(Vector3(random(), random(), random())));
+    }
+
+    for (const Vector3 &vector : vectors)
+    {
+      int16 x, y;
+      VertexCompression::encodeOctahedral(vector, x, y);
+      Vector3 decoded = VertexCompression::decodeOctahedral(x, y);
+      // The sine of the angle between them, which unlike the cosine is still precise for tiny angles.
+      REQUIRE(Vector3::Cross(decoded, vector).Length() < 5.0e-5f);
+      REQUIRE(Vector3::Dot(decoded, vector) > 0.0f);
+    }
+  }
+
+  SECTION("COMPRESSES VERTICES")
+  {
+    Vector3 normal(0.0f, 1.0f, 0.0f);
+    Vector3 tangent(1.0f, 0.0f, 0.0f);
+    std::vector<float32> vertices = createVertex(Vector3(-1.0f, 2.0f, 3.0f), normal, Vector2(0.25f, 0.75f), tangent, Vector3(0.0f, 0.0f, 1.0f));
+    std::vector<float32> mirrored = createVertex(Vector3(1.0f, 4.0f, 3.5f), normal, Vector2(0.5f, 1.0f), tangent, Vector3(0.0f, 0.0f, -1.0f));
+    vertices.insert(vertices.end(), mirrored.begin(), mirrored.end());
+    Aabb bounds(Vector3(1.0f, 4.0f, 3.5f), Vector3(-1.0f, 2.0f, 3.0f));
+
+    std::vector<uint8> full = VertexCompression::compress(vertices.data(), 2, VertexFormat::Full, bounds);
+    REQUIRE(full.size() == vertices.size() * sizeof(float32));
+    REQUIRE(std::memcmp(full.data(), vertices.data(), full.size()) == 0);
+
+    std::vector<uint8> compact = VertexCompression::compress(vertices.data(), 2, VertexFormat::Compact, bounds);
+    REQUIRE(compact.size() == 2 * 28);
+    REQUIRE(read<float32>(compact, 0) == -1.0f);
+    REQUIRE(Vector3::Dot(VertexCompression::decodeOctahedral(read<int16>(compact, 12), read<int16>(compact, 14)), normal) > 0.99999f);
+    REQUIRE(VertexCompression::fromHalf(read<uint16>(compact, 16)) == 0.25f);
+    REQUIRE(VertexCompression::fromHalf(read<uint16>(compact, 18)) == 0.75f);
+    REQUIRE(Vector3::Dot(VertexCompression::decodeOctahedral(read<int16>(compact, 20), read<int16>(compact, 22)), tangent) > 0.99999f);
+    // cross(normal, tangent) is -Z, so the first bitangent is flipped relative to it and the second is not.
+    REQUIRE(read<int16>(compact, 24) == -32767);
+    REQUIRE(read<int16>(compact, 28 + 24) == 32767);
+
+    std::vector<uint8> quantized = VertexCompression::compress(vertices.data(), 2, VertexFormat::CompactQuantized, bounds);
+    REQUIRE(quantized.size() == 2 * 24);
+    Vector3 scale, offset;
+    VertexCompression::getPositionTransform(VertexFormat::CompactQuantized, bounds, scale, offset);
+    for (uint32 v = 0; v < 2; v++)
+    {
+      for (uint32 c = 0; c < 3; c++)
+      {
+        float32 decoded = read<uint16>(quantized, v * 24 + c * sizeof(uint16)) / 65535.0f * scale[c] + offset[c];
+        REQUIRE(decoded == Approx(vertices[v * FULL_VERTEX_FLOATS + c]).margin(scale[c] / 65535.0f));
+      }
+    }
+    REQUIRE(read<int16>(quantized, 20) == -32767);
+  }
+
+  SECTION("DESCRIBES EACH LAYOUT")
+  {
+    REQUIRE(VertexCompression::getVertexLayout(VertexFormat::Full).size() == 5);
+    auto quantizedLayout = VertexCompression::getVertexLayout(VertexFormat::CompactQuantized);
+    REQUIRE(quantizedLayout.size() == 4);
+    REQUIRE(quantizedLayout[0].Format == SemanticFormat::Ushort4);
+    REQUIRE(quantizedLayout[0].Normalised);
+    REQUIRE(quantizedLayout[3].Type == SemanticType::Tangent);
+  }
+}